@@ -0,0 +1,154 @@
+/// @file list_head_bench.c
+/// @brief Host-side benchmark of the list_head algorithms.
+/// @details
+/// This program is compiled with the host compiler, not with the MentOS
+/// toolchain. From the root of the repository:
+///     cc -O2 -std=c11 -iquote libc/inc -DMENTOS_ROOT=\"$PWD\" -o list_head_bench benchmarks/list_head_bench.c
+///     ./list_head_bench
+/// It compares the previous swap-based sort with the merge sort, and the
+/// "append then sort" pattern previously used by create_vm_area with sorted
+/// insertion. A negative time means the case was skipped, because the old
+/// algorithm takes too long on that size.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+// The MentOS headers come first, and only use the basic types we share with
+// the host C library. We drop their BUFSIZ, so the host one is used.
+#include "list_head.h"
+#include "list_head_algorithm.h"
+#undef BUFSIZ
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/// @brief The MentOS assert macro calls this function, provide it on the host.
+void __assert_fail(const char *assertion, const char *file, const char *function, unsigned int line)
+{
+    fprintf(stderr, "%s:%u: %s: Assertion `%s' failed.\n", file, line, function, assertion);
+    abort();
+}
+
+/// @brief An entry resembling a virtual memory area.
+typedef struct area {
+    unsigned long start; ///< The key we sort on.
+    list_head list;      ///< The list link.
+} area_t;
+
+static int area_compare(const list_head *a, const list_head *b)
+{
+    return list_entry(a, area_t, list)->start > list_entry(b, area_t, list)->start;
+}
+
+/// @brief The swap-based selection sort that list_head_sort used to implement.
+static void selection_sort(list_head *list, list_head_compare compare)
+{
+    list_head *current, *index, *next;
+    int restart;
+    if (list_head_empty(list)) {
+        return;
+    }
+    for (current = list->next; current->next != list;) {
+        next    = current->next;
+        restart = 0;
+        for (index = current->next; index != list; index = index->next) {
+            if (compare(current, index)) {
+                list_head_swap(index, current);
+                restart = 1;
+            }
+        }
+        current = restart ? list->next : next;
+    }
+}
+
+/// @brief Returns the elapsed time in milliseconds.
+static double elapsed_ms(clock_t start) { return 1000.0 * (double)(clock() - start) / CLOCKS_PER_SEC; }
+
+/// @brief Fills the list with `n` entries with random keys.
+static void fill_random(list_head *list, area_t *areas, size_t n)
+{
+    list_head_init(list);
+    for (size_t i = 0; i < n; ++i) {
+        areas[i].start = ((unsigned long)rand() << 12U);
+        list_head_insert_before(&areas[i].list, list);
+    }
+}
+
+/// @brief Checks the list is sorted, and aborts otherwise.
+static void check(list_head *list, const char *what)
+{
+    if (!list_head_is_sorted(list, area_compare)) {
+        fprintf(stderr, "%s produced an unsorted list.\n", what);
+        exit(EXIT_FAILURE);
+    }
+}
+
+int main(void)
+{
+    static const size_t sizes[] = {16, 64, 256, 1024, 4096};
+    size_t max_size             = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+    area_t *areas               = malloc(max_size * sizeof(area_t));
+    list_head list;
+    clock_t start;
+    double t_old, t_new;
+
+    if (!areas) {
+        return EXIT_FAILURE;
+    }
+
+    printf("%8s | %14s %15s | %16s %16s\n", "entries", "swap sort (ms)", "merge sort (ms)", "append+sort (ms)",
+           "insert sort (ms)");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        size_t n = sizes[s];
+
+        // Sorting a randomly ordered list, the old sort is way too slow on big lists.
+        t_old = -1;
+        if (n <= 1024) {
+            srand(42);
+            fill_random(&list, areas, n);
+            start = clock();
+            selection_sort(&list, area_compare);
+            t_old = elapsed_ms(start);
+            check(&list, "selection_sort");
+        }
+
+        srand(42);
+        fill_random(&list, areas, n);
+        start = clock();
+        list_head_sort(&list, area_compare);
+        t_new = elapsed_ms(start);
+        check(&list, "list_head_sort");
+
+        printf("%8zu | %14.3f %15.3f |", n, t_old, t_new);
+
+        // Building the list one entry at a time, like create_vm_area does.
+        t_old = -1;
+        if (n <= 256) {
+            srand(7);
+            list_head_init(&list);
+            start = clock();
+            for (size_t i = 0; i < n; ++i) {
+                areas[i].start = ((unsigned long)rand() << 12U);
+                list_head_insert_after(&areas[i].list, &list);
+                selection_sort(&list, area_compare);
+            }
+            t_old = elapsed_ms(start);
+            check(&list, "append+sort");
+        }
+
+        srand(7);
+        list_head_init(&list);
+        start = clock();
+        for (size_t i = 0; i < n; ++i) {
+            areas[i].start = ((unsigned long)rand() << 12U);
+            list_head_insert_sorted(&areas[i].list, &list, area_compare);
+        }
+        t_new = elapsed_ms(start);
+        check(&list, "list_head_insert_sorted");
+
+        printf(" %16.3f %16.3f\n", t_old, t_new);
+    }
+
+    free(areas);
+    return EXIT_SUCCESS;
+}
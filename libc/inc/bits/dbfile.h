@@ -0,0 +1,46 @@
+/// @file dbfile.h
+/// @brief Support functions for the databases of the system kept in memory,
+/// like `/etc/passwd` and `/etc/group`, shared by pwd.c and grp.c.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#pragma once
+
+#include "stddef.h"
+#include "sys/types.h"
+#include "time.h"
+
+/// @brief The content of a database file, and what identifies its version.
+typedef struct dbfile {
+    char *data;   ///< The content of the file, NULL if not loaded.
+    ino_t ino;    ///< The inode of the file we have read.
+    off_t size;   ///< The size of the file we have read.
+    time_t mtime; ///< The modification time of the file we have read.
+} dbfile_t;
+
+/// @brief Reads the whole file in memory, unless the content in memory is up
+/// to date.
+/// @param db the database file.
+/// @param path the path of the file.
+/// @param lines where the number of lines of the new content is stored, an
+/// upper bound for the number of entries.
+/// @return 1 if the file has been read, 0 if the content in memory is up to
+/// date, -1 on failure, and the content is freed.
+int dbfile_load(dbfile_t *db, const char *path, int *lines);
+
+/// @brief Frees the content of the file.
+/// @param db the database file.
+void dbfile_free(dbfile_t *db);
+
+/// @brief Returns the next non-empty line, and terminates it in place.
+/// @param it the position inside the content, it is advanced past the line.
+/// @return the line, NULL if there are no more lines.
+char *dbfile_next_line(char **it);
+
+/// @brief Copies a string inside the buffer of the caller.
+/// @param dest where the copy is referenced.
+/// @param src the string.
+/// @param buf the position inside the buffer, it is advanced.
+/// @param buflen the space left in the buffer, it is decreased.
+/// @return 1 on success, 0 if there is not enough space.
+int dbfile_copy_field(char **dest, const char *src, char **buf, size_t *buflen);
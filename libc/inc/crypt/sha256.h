@@ -9,6 +9,11 @@
 /// Algorithm specification can be found here:
 ///     http://csrc.nist.gov/publications/fips/fips180-2/fips180-2withchangenotice.pdf
 /// This implementation uses little endian byte order.
+///
+/// The C library selects at runtime the fastest transform supported by the
+/// processor: the SHA extensions (SHA-NI), or an unrolled scalar version.
+/// Independent messages can also be hashed together with sha256_multi, which
+/// processes four of them at a time with SSE2.
 
 #pragma once
 
@@ -48,3 +53,37 @@ void sha256_final(SHA256_ctx_t *ctx, uint8_t hash[]);
 /// @param out_length Length of the output buffer (must be at least 2 * src_length + 1).
 /// @details The output string will be null-terminated if the buffer is large enough.
 void sha256_bytes_to_hex(uint8_t *src, size_t src_length, char *out, size_t out_length);
+
+#ifndef __KERNEL__
+
+/// @brief The implementations of the SHA-256 transform.
+typedef enum {
+    SHA256_IMPL_AUTO,    ///< The fastest implementation supported by the processor.
+    SHA256_IMPL_GENERIC, ///< The unrolled scalar implementation.
+    SHA256_IMPL_SSE2,    ///< Four messages at a time with SSE2, scalar for a single stream.
+    SHA256_IMPL_SHANI,   ///< The SHA extensions of the processor.
+} sha256_impl_t;
+
+/// @brief Hashes independent messages, several of them at a time if the
+/// implementation allows it.
+/// @param data The messages.
+/// @param len The lengths of the messages, in bytes.
+/// @param hash The buffers where the digests are stored (each at least 32 bytes long).
+/// @param count The number of messages.
+void sha256_multi(const uint8_t *const data[], const size_t len[], uint8_t *const hash[], size_t count);
+
+/// @brief Selects the implementation of the transform.
+/// @param impl The implementation, SHA256_IMPL_AUTO for the fastest one.
+/// @return 0 on success, -1 if the processor does not support it.
+int sha256_set_impl(sha256_impl_t impl);
+
+/// @brief Returns the implementation in use.
+/// @return The implementation, never SHA256_IMPL_AUTO.
+sha256_impl_t sha256_get_impl(void);
+
+/// @brief Returns the name of an implementation.
+/// @param impl The implementation.
+/// @return The name, or NULL if the implementation is not valid.
+const char *sha256_impl_name(sha256_impl_t impl);
+
+#endif
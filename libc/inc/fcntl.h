@@ -49,9 +49,23 @@
 #define F_UNLCK 3 ///< Unlock.
 /// @}
 
+#include "stddef.h"
+#include "sys/types.h"
+
+/// @brief Describes a record lock, used by the F_GETLK, F_SETLK and F_SETLKW
+/// commands.
+typedef struct flock {
+    short l_type;   ///< The type of lock: F_RDLCK, F_WRLCK, or F_UNLCK.
+    short l_whence; ///< How `l_start` is interpreted: SEEK_SET, SEEK_CUR, or SEEK_END.
+    off_t l_start;  ///< The starting offset of the lock.
+    off_t l_len;    ///< The number of bytes to lock, 0 means until the end of the file.
+    pid_t l_pid;    ///< The process holding a conflicting lock (F_GETLK only).
+} flock_t;
+
 /// @brief Provides control operations on an open file descriptor.
 /// @param fd The file descriptor on which to perform the operation.
 /// @param request The `fcntl` command, defining the operation (e.g., `F_GETFL`, `F_SETFL`).
 /// @param data Additional data required by certain `fcntl` commands (e.g., flags or pointer).
 /// @return Returns 0 on success; on error, returns a negative error code.
+/// @details With F_SETLKW, the call sleeps until the lock can be acquired.
 long fcntl(int fd, unsigned int request, unsigned long data);
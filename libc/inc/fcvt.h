@@ -5,6 +5,49 @@
 
 #pragma once
 
+#include "stdint.h"
+
+/// The number of 32-bit limbs of the integer and of the fractional part of a
+/// double: 2^1024 has 309 decimal digits, the smallest subnormal 1074 bits.
+#define CVT_LIMBS 36
+
+/// @brief The exact decimal expansion of a non-negative double, produced one
+/// digit at a time.
+typedef struct cvt_gen {
+    uint32_t ipart[CVT_LIMBS]; ///< The integer part, in base 10^9, least significant limb first.
+    uint32_t fpart[CVT_LIMBS]; ///< The fractional part, as the numerator of a power of 2^32.
+    int ilen;                  ///< The number of limbs of the integer part left.
+    int flen;                  ///< The number of limbs of the fractional part.
+    int fbot;                  ///< The index of the lowest non-zero limb of the fractional part.
+    char idigits[9];           ///< The digits of the limb of the integer part being printed.
+    int ipos;                  ///< The index of the next digit in idigits, 9 if none.
+    int pending;               ///< A digit read ahead to skip the leading zeros, -1 if none.
+} cvt_gen_t;
+
+/// @brief The digits of a double, rounded to a given number of digits.
+typedef struct cvt {
+    cvt_gen_t gen; ///< The generator of the exact digits.
+    int decpt;     ///< The position of the decimal point, relative to the first digit.
+    int ndigits;   ///< The number of significant digits, after which there are only zeros.
+    int nonzero;   ///< The number of digits up to the last non-zero one.
+    int carry;     ///< The index of the digit incremented by the rounding, -1 if none, -2 if
+                   ///< the rounding carried out of the first digit, which is now a 1.
+    int pos;       ///< The index of the next digit.
+} cvt_t;
+
+/// @brief Prepares the digits of a value, correctly rounded (ties to even).
+/// @param cvt the state of the conversion.
+/// @param value the value, non-negative and finite.
+/// @param ndigits the number of digits: significant ones if fixed is 0,
+/// after the decimal point otherwise.
+/// @param fixed selects the meaning of ndigits.
+void cvt_init(cvt_t *cvt, double value, int ndigits, int fixed);
+
+/// @brief Returns the next digit of a conversion.
+/// @param cvt the state of the conversion.
+/// @return the digit, as a character; '0' after the last significant digit.
+char cvt_digit(cvt_t *cvt);
+
 /// @brief Thif function transforms `value` into a string of digits inside `buf`,
 ///         representing the whole part followed by the decimal part.
 /// @details
@@ -34,3 +77,19 @@ void ecvtbuf(double arg, int chars, int *decpt, int *sign, char *buf, unsigned b
 /// @param buf      Buffer where the digits should be placed.
 /// @param buf_size Dimension of the buffer.
 void fcvtbuf(double arg, int decimals, int *decpt, int *sign, char *buf, unsigned buf_size);
+
+/// @brief Transforms `value` into a short string of digits which reads back
+///         as the same double (Grisu2).
+/// @details
+/// The digits are the shortest ones in almost all cases, and in the others
+/// still read back exactly. For instance, 0.1 will result in:
+///     decpt = 0
+///     sign  = 0
+///     buf   = "1"
+/// @param arg      The argument to turn into string, finite.
+/// @param decpt    The position of the decimal point.
+/// @param sign     The sign of the number.
+/// @param buf      Buffer where the digits should be placed, 18 bytes are enough.
+/// @param buf_size Dimension of the buffer.
+/// @return the number of digits.
+int scvtbuf(double arg, int *decpt, int *sign, char *buf, unsigned buf_size);
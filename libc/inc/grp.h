@@ -18,7 +18,7 @@ typedef struct group {
     char *gr_passwd;
     /// Group ID.
     gid_t gr_gid;
-    /// List of group members.
+    /// List of group members, terminated by NULL.
     char *gr_mem[MAX_MEMBERS_PER_GROUP + 1];
 } group_t;
 
@@ -65,8 +65,8 @@ int getgrnam_r(const char *name, group_t *group, char *buf, size_t buflen, group
 /// so successive calls may be used to search the entire database.
 group_t *getgrent(void);
 
-/// @brief Rewinds the group database to allow repeated searches.
+/// @brief May be called to close the group database when processing is complete.
 void endgrent(void);
 
-/// @brief May be called to close the group database when processing is complete.
+/// @brief Rewinds the group database to allow repeated searches.
 void setgrent(void);
@@ -8,41 +8,209 @@
 #include "list_head.h"
 
 /// @brief list_head comparison function.
+/// @details It must return a non-zero value if the first entry must be placed
+/// after the second one (i.e., first > second), and 0 otherwise. Entries that
+/// compare as equal keep their relative order in all the algorithms below.
 typedef int (*list_head_compare)(const list_head *, const list_head *);
 
-/// @brief -
-/// @param list
-/// @param compare
+/// @brief Maximum number of pending runs used by the merge sort, a list with
+/// 2^32 entries would need exactly 32 of them.
+#define LIST_HEAD_SORT_MAX_RUNS 32
+
+/// @brief Merges two NULL-terminated chains (linked only through `next`).
+/// @param a the first sorted chain, its entries come first on ties.
+/// @param b the second sorted chain.
+/// @param compare the comparison function.
+/// @return the head of the merged chain.
+static inline list_head *__list_head_merge_chains(list_head *a, list_head *b, list_head_compare compare)
+{
+    list_head head;
+    list_head *tail = &head;
+    while (a && b) {
+        // Take from `b` only when it is strictly smaller, this keeps the sort stable.
+        if (compare(a, b)) {
+            tail->next = b;
+            b          = b->next;
+        } else {
+            tail->next = a;
+            a          = a->next;
+        }
+        tail = tail->next;
+    }
+    // Attach whatever is left.
+    tail->next = a ? a : b;
+    return head.next;
+}
+
+/// @brief Rebuilds the `prev` links of a NULL-terminated chain, and closes it
+/// back into the circular list pointed by `list`.
+/// @param list the head of the list.
+/// @param chain the first entry of the chain.
+static inline void __list_head_restore_links(list_head *list, list_head *chain)
+{
+    list_head *prev = list;
+    for (list_head *it = chain; it; it = it->next) {
+        it->prev   = prev;
+        prev->next = it;
+        prev       = it;
+    }
+    prev->next = list;
+    list->prev = prev;
+}
+
+/// @brief Sorts the list using a stable bottom-up merge sort.
+/// @details
+/// The entries are detached into a NULL-terminated chain, then merged in runs
+/// of doubling length (like a binary counter, `runs[i]` holds either nothing or
+/// a sorted run of 2^i entries). It requires O(n log n) comparisons, no
+/// allocation, and a fixed amount of stack.
+/// @param list the list to sort.
+/// @param compare the comparison function.
 static inline void list_head_sort(list_head *list, list_head_compare compare)
 {
-    list_head *current = NULL;
-    list_head *index   = NULL;
-    list_head *next    = NULL;
-    // Check whether list is empty
-    if (!list_head_empty(list)) {
-        // Keeps track if we need to restart the outer loop.
-        int restart = 0;
-        // Current will point to head
-        for (current = list->next; current->next != list;) {
-            // Save pointer to next.
-            next    = current->next;
-            // Reset restart flag.
-            restart = 0;
-            // Index will point to node next to current
-            for (index = current->next; index != list; index = index->next) {
-                // If current's data is greater than index's data, swap the data of
-                // current and index
-                if (compare(current, index)) {
-                    list_head_swap(index, current);
-                    restart = 1;
-                }
-            }
-            // Check if we need to restart.
-            if (restart) {
-                current = list->next;
-            } else {
-                current = next;
-            }
+    assert(list && "Variable list is NULL.");
+    assert(compare && "Variable compare is NULL.");
+
+    list_head *runs[LIST_HEAD_SORT_MAX_RUNS] = {NULL};
+    list_head *entry;
+    list_head *carry;
+    unsigned max_run = 0;
+    unsigned i;
+
+    // Nothing to do with zero or one entries.
+    if (list_head_empty(list) || (list->next == list->prev)) {
+        return;
+    }
+    // Break the circular list into a NULL-terminated chain.
+    list->prev->next = NULL;
+    entry            = list->next;
+    while (entry) {
+        // Detach the entry, which becomes a run of length one.
+        carry       = entry;
+        entry       = entry->next;
+        carry->next = NULL;
+        // Merge it with the pending runs, older runs come first on ties.
+        for (i = 0; (i < LIST_HEAD_SORT_MAX_RUNS - 1) && runs[i]; ++i) {
+            carry   = __list_head_merge_chains(runs[i], carry, compare);
+            runs[i] = NULL;
+        }
+        runs[i] = runs[i] ? __list_head_merge_chains(runs[i], carry, compare) : carry;
+        if (i > max_run) {
+            max_run = i;
+        }
+    }
+    // Merge all the remaining runs, from the smallest (newest) to the largest (oldest).
+    carry = NULL;
+    for (i = 0; i <= max_run; ++i) {
+        if (runs[i]) {
+            carry = carry ? __list_head_merge_chains(runs[i], carry, compare) : runs[i];
+        }
+    }
+    // Fix the `prev` links and close the list.
+    __list_head_restore_links(list, carry);
+}
+
+/// @brief Checks if the list is sorted according to the comparison function.
+/// @param list the list to check.
+/// @param compare the comparison function.
+/// @return 1 if sorted, 0 otherwise.
+static inline int list_head_is_sorted(const list_head *list, list_head_compare compare)
+{
+    assert(list && "Variable list is NULL.");
+    assert(compare && "Variable compare is NULL.");
+
+    for (const list_head *it = list->next; (it != list) && (it->next != list); it = it->next) {
+        if (compare(it, it->next)) {
+            return 0;
         }
     }
+    return 1;
+}
+
+/// @brief Inserts the entry inside an already sorted list, keeping it sorted.
+/// @details
+/// The search starts from the tail, after the last entry which is not greater
+/// than the new one. Thus, equal entries keep their insertion order, and
+/// appending entries which are already in order costs O(1).
+/// @param new_entry the entry to insert.
+/// @param list the sorted list.
+/// @param compare the comparison function.
+static inline void list_head_insert_sorted(list_head *new_entry, list_head *list, list_head_compare compare)
+{
+    assert(new_entry && "Variable new_entry is NULL.");
+    assert(list && "Variable list is NULL.");
+    assert(compare && "Variable compare is NULL.");
+
+    list_head *location = list->prev;
+    // Move backward while the current entry is greater than the new one.
+    while ((location != list) && compare(location, new_entry)) {
+        location = location->prev;
+    }
+    list_head_insert_after(new_entry, location);
+}
+
+/// @brief Moves all the entries of `list` right after `location`.
+/// @param list the list to move, which gets re-initialized as empty.
+/// @param location the entry after which we insert the entries.
+static inline void list_head_splice(list_head *list, list_head *location)
+{
+    assert(list && "Variable list is NULL.");
+    assert(location && "Variable location is NULL.");
+
+    if (!list_head_empty(list)) {
+        list_head *first = list->next;
+        list_head *last  = list->prev;
+        list_head *next  = location->next;
+        // Link the first entry to the location.
+        location->next   = first;
+        first->prev      = location;
+        // Link the last entry to what followed the location.
+        last->next       = next;
+        next->prev       = last;
+        // Re-initialize the moved list.
+        list_head_init(list);
+    }
+}
+
+/// @brief Moves all the entries of `list` right before `location`. When
+/// `location` is the head of another list, the entries are appended to it.
+/// @param list the list to move, which gets re-initialized as empty.
+/// @param location the entry before which we insert the entries.
+static inline void list_head_splice_tail(list_head *list, list_head *location)
+{
+    assert(location && "Variable location is NULL.");
+
+    list_head_splice(list, location->prev);
+}
+
+/// @brief Merges the sorted `secondary` list inside the sorted `main` list.
+/// @details The merge is stable, on ties the entries of `main` come first.
+/// @param main the main sorted list, which will contain all the entries.
+/// @param secondary the secondary sorted list, which gets re-initialized as empty.
+/// @param compare the comparison function.
+static inline void list_head_merge(list_head *main, list_head *secondary, list_head_compare compare)
+{
+    assert(main && "Variable main is NULL.");
+    assert(secondary && "Variable secondary is NULL.");
+    assert(compare && "Variable compare is NULL.");
+
+    list_head *a;
+    list_head *b;
+
+    if (list_head_empty(secondary)) {
+        return;
+    }
+    if (list_head_empty(main)) {
+        list_head_splice(secondary, main);
+        return;
+    }
+    // Turn both lists into NULL-terminated chains.
+    main->prev->next      = NULL;
+    secondary->prev->next = NULL;
+    a                     = main->next;
+    b                     = secondary->next;
+    // Merge the chains, and close the result into the main list.
+    __list_head_restore_links(main, __list_head_merge_chains(a, b, compare));
+    // Re-initialize the secondary list.
+    list_head_init(secondary);
 }
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "stddef.h"
+
 /// @brief The absolute value.
 #define abs(a) (((a) < 0) ? -(a) : (a))
 
@@ -59,6 +61,18 @@
 /// @brief  1 / sqrt(2)
 #define M_SQRT1_2 0.70710678118654752440
 
+/// @brief The value returned on overflow.
+#define HUGE_VAL (__builtin_huge_val())
+
+/// @brief The value returned on overflow, by the float functions.
+#define HUGE_VALF (__builtin_huge_valf())
+
+/// @brief Positive infinity.
+#define INFINITY (__builtin_inff())
+
+/// @brief A quiet NaN.
+#define NAN (__builtin_nanf(""))
+
 /// @brief Returns the integral value that is nearest to x, with
 ///        halfway cases rounded away from zero.
 /// @param x Value to round.
@@ -105,6 +119,11 @@ double pow(double base, double exponent);
 ///  the global variable errno is set to ERANGE.
 double exp(double x);
 
+/// @brief Returns the base-2 exponential function of x: 2^x.
+/// @param x Value of the exponent.
+/// @return Exponential value of x.
+double exp2(double x);
+
 /// @brief Returns the absolute value of x: |x|.
 /// @param x Value whose absolute value is returned.
 /// @result The absolute value of x.
@@ -137,6 +156,18 @@ int isinf(double x);
 /// @return 1 if NAN, 0 otherwise.
 int isnan(double x);
 
+/// @brief Natural logarithm function.
+/// @param x Topic of the logarithm function.
+/// @return The logarithm of x. If x is negative, the global variable errno is
+///         set to EDOM and NaN is returned. If x is zero, the global variable
+///         errno is set to ERANGE and -HUGE_VAL is returned.
+double log(double x);
+
+/// @brief Logarithm function in base 2.
+/// @param x Topic of the logarithm function.
+/// @return Return the result.
+double log2(double x);
+
 /// @brief Logarithm function in base 10.
 /// @param x Topic of the logarithm function.
 /// @return Return the result.
@@ -158,3 +189,123 @@ double logx(double x, double y);
 /// @param intpart Where we store the integer part.
 /// @return the fractional part.
 double modf(double x, double *intpart);
+
+/// @brief Returns the sine of x.
+/// @param x Angle, in radians.
+/// @return The sine of x.
+double sin(double x);
+
+/// @brief Returns the cosine of x.
+/// @param x Angle, in radians.
+/// @return The cosine of x.
+double cos(double x);
+
+/// @brief Returns the tangent of x.
+/// @param x Angle, in radians.
+/// @return The tangent of x.
+double tan(double x);
+
+/// @brief Returns the arc tangent of x.
+/// @param x Value whose arc tangent is computed.
+/// @return The arc tangent of x, in [-pi/2, pi/2] radians.
+double atan(double x);
+
+/// @brief Returns the arc tangent of y/x, using the signs of the arguments to
+///        determine the quadrant.
+/// @param y Value representing the proportion of the y-coordinate.
+/// @param x Value representing the proportion of the x-coordinate.
+/// @return The arc tangent of y/x, in [-pi, pi] radians.
+double atan2(double y, double x);
+
+/// @brief Returns the base-e exponential function of x.
+/// @param x Value of the exponent.
+/// @return Exponential value of x.
+float expf(float x);
+
+/// @brief Natural logarithm function.
+/// @param x Topic of the logarithm function.
+/// @return The logarithm of x.
+float logf(float x);
+
+/// @brief Returns base raised to the power exponent.
+/// @param base     Base value.
+/// @param exponent Exponent value.
+/// @return The result of raising base to the power exponent.
+float powf(float base, float exponent);
+
+/// @brief Returns the sine of x.
+/// @param x Angle, in radians.
+/// @return The sine of x.
+float sinf(float x);
+
+/// @brief Returns the cosine of x.
+/// @param x Angle, in radians.
+/// @return The cosine of x.
+float cosf(float x);
+
+/// @brief Returns the tangent of x.
+/// @param x Angle, in radians.
+/// @return The tangent of x.
+float tanf(float x);
+
+/// @brief Returns the arc tangent of x.
+/// @param x Value whose arc tangent is computed.
+/// @return The arc tangent of x, in [-pi/2, pi/2] radians.
+float atanf(float x);
+
+/// @brief Returns the arc tangent of y/x, using the signs of the arguments to
+///        determine the quadrant.
+/// @param y Value representing the proportion of the y-coordinate.
+/// @param x Value representing the proportion of the x-coordinate.
+/// @return The arc tangent of y/x, in [-pi, pi] radians.
+float atan2f(float y, float x);
+
+/// @brief Computes the exponential of an array of values.
+/// @details The batch functions use SSE2, when the processor supports it, and
+/// give the same results as the scalar functions within 1 ulp.
+/// @param dst Where the results are stored, it can be the same as src.
+/// @param src The arguments.
+/// @param count The number of values.
+void vexp(double *dst, const double *src, size_t count);
+
+/// @brief Computes the natural logarithm of an array of values.
+/// @param dst Where the results are stored, it can be the same as src.
+/// @param src The arguments.
+/// @param count The number of values.
+void vlog(double *dst, const double *src, size_t count);
+
+/// @brief Computes the sine of an array of values.
+/// @param dst Where the results are stored, it can be the same as src.
+/// @param src The arguments.
+/// @param count The number of values.
+void vsin(double *dst, const double *src, size_t count);
+
+/// @brief Computes the cosine of an array of values.
+/// @param dst Where the results are stored, it can be the same as src.
+/// @param src The arguments.
+/// @param count The number of values.
+void vcos(double *dst, const double *src, size_t count);
+
+/// @brief Computes the exponential of an array of values.
+/// @param dst Where the results are stored, it can be the same as src.
+/// @param src The arguments.
+/// @param count The number of values.
+void vexpf(float *dst, const float *src, size_t count);
+
+/// @brief Computes the natural logarithm of an array of values.
+/// @param dst Where the results are stored, it can be the same as src.
+/// @param src The arguments.
+/// @param count The number of values.
+void vlogf(float *dst, const float *src, size_t count);
+
+/// @brief Computes the sine of an array of values.
+/// @param dst Where the results are stored, it can be the same as src.
+/// @param src The arguments.
+/// @param count The number of values.
+void vsinf(float *dst, const float *src, size_t count);
+
+/// @brief Computes the cosine of an array of values.
+/// @param dst Where the results are stored, it can be the same as src.
+/// @param src The arguments.
+/// @param count The number of values.
+void vcosf(float *dst, const float *src, size_t count);
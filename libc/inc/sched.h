@@ -7,6 +7,17 @@
 #include "sys/types.h"
 #include "time.h"
 
+/// @name Scheduling policies
+/// @{
+#define SCHED_NORMAL   0            ///< Time-sharing, the default policy.
+#define SCHED_OTHER    SCHED_NORMAL ///< Alias of SCHED_NORMAL.
+#define SCHED_FIFO     1            ///< Fixed-priority real-time, without time slices.
+#define SCHED_RR       2            ///< Fixed-priority real-time, with time slices.
+#define SCHED_BATCH    3            ///< Time-sharing for CPU-bound jobs.
+#define SCHED_IDLE     5            ///< Runs only when nothing else can run.
+#define SCHED_DEADLINE 6            ///< Periodic tasks, served by Earliest Deadline First.
+/// @}
+
 /// @brief Structure that describes scheduling parameters.
 typedef struct sched_param {
     /// Static execution priority.
@@ -37,6 +48,22 @@ int sched_setparam(pid_t pid, const sched_param_t *param);
 /// @return 0 on success, -1 on failure and errno is set to indicate the error.
 int sched_getparam(pid_t pid, sched_param_t *param);
 
+/// @brief Sets the scheduling policy and parameters.
+/// @param pid pid of the process we want to change. If zero, then the policy
+/// of the calling process is set.
+/// @param policy the new policy (SCHED_*).
+/// @param param the new parameters; `sched_priority` must be within 1 and 99
+/// for SCHED_FIFO and SCHED_RR, and 0 for the other policies.
+/// @return 0 on success, -1 on failure and errno is set to indicate the error.
+int sched_setscheduler(pid_t pid, int policy, const sched_param_t *param);
+
+/// @brief Gets the scheduling policy.
+/// @param pid pid of the process we want to retrieve the policy. If zero, then
+/// the policy of the calling process is returned.
+/// @return the policy on success, -1 on failure and errno is set to indicate
+/// the error.
+int sched_getscheduler(pid_t pid);
+
 /// @brief Placed at the end of an infinite while loop, stops the process until,
 /// its next period starts. The calling process must be a periodic one.
 /// @return 0 on success, -1 on failure and errno is set to indicate the error.
@@ -0,0 +1,153 @@
+/// @file shm_ring.h
+/// @brief Lock-free ring buffers living in shared memory segments, to stream
+/// data between processes without a system call per message.
+/// @details
+/// The ring holds `capacity` elements of `size` bytes, with `capacity` a
+/// power of two, and it is placed in a System V shared memory segment
+/// together with its indices. Producers and consumers each own a pair of
+/// indices, on their own cache line:
+/// - `head` is the next position to reserve, and it is moved first;
+/// - `tail` is the position up to which the reserved elements are complete.
+///
+/// An enqueue reserves room by moving `prod.head`, copies the elements, and
+/// then publishes them by moving `prod.tail`; a dequeue does the same on the
+/// `cons` indices. With SHM_RING_MPMC the heads are moved with a
+/// compare-and-swap, and each process publishes its elements in the order in
+/// which it reserved them. Without it, the ring supports a single producer
+/// and a single consumer, and no atomic read-modify-write is needed.
+///
+/// Operations transfer several elements at once:
+/// - `bulk` ones transfer either all the elements or none;
+/// - `burst` ones transfer as many as possible;
+/// - `wait` ones transfer all of them, waiting when the ring is full (or
+///   empty). With SHM_RING_BLOCK the processes sleep on a semaphore set,
+///   which is touched only when someone is actually waiting, otherwise they
+///   poll, leaving the CPU to the other processes.
+///
+/// Usage example:
+/// ```c
+/// shm_ring_t *ring = shm_ring_create(key, 1024, sizeof(int), SHM_RING_BLOCK);
+/// if (fork() == 0) {
+///     // The mapping is not inherited, attach again.
+///     ring = shm_ring_attach(key);
+///     shm_ring_dequeue_wait(ring, values, 16);
+///     ...
+/// }
+/// shm_ring_enqueue_wait(ring, values, 16);
+/// ```
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#pragma once
+
+#include "stddef.h"
+#include "stdint.h"
+#include "sys/types.h"
+
+/// The size of a cache line, the indices of each side live on their own.
+#define SHM_RING_CACHELINE 64
+
+/// @name Flags of shm_ring_create
+/// @{
+#define SHM_RING_MPMC  0x1 ///< Multiple producers and consumers, otherwise a single one each.
+#define SHM_RING_BLOCK 0x2 ///< Sleep on a semaphore when the ring is full or empty, otherwise poll.
+/// @}
+
+/// @brief The indices of one side of the ring, producers or consumers.
+typedef struct shm_ring_side {
+    volatile uint32_t head;    ///< The next position to reserve.
+    volatile uint32_t tail;    ///< The positions before this one are complete.
+    volatile uint32_t waiters; ///< Processes waiting to transfer, with SHM_RING_BLOCK.
+} __attribute__((aligned(SHM_RING_CACHELINE))) shm_ring_side_t;
+
+/// @brief A ring buffer in a shared memory segment, followed by its elements.
+typedef struct shm_ring {
+    uint32_t magic;       ///< Tells that the ring has been initialized.
+    uint32_t flags;       ///< The flags (SHM_RING_*).
+    uint32_t capacity;    ///< The number of elements, a power of two.
+    uint32_t mask;        ///< The mask turning a position into an index.
+    uint32_t size;        ///< The size of an element.
+    int shmid;            ///< The shared memory segment.
+    int semid;            ///< The semaphores of the waiting producers and consumers, -1 if none.
+    shm_ring_side_t prod; ///< The indices of the producers.
+    shm_ring_side_t cons; ///< The indices of the consumers.
+    /// The elements.
+    uint8_t data[] __attribute__((aligned(SHM_RING_CACHELINE)));
+} shm_ring_t;
+
+/// @brief Creates a ring in a new shared memory segment, and attaches it.
+/// @param key the key of the segment, IPC_PRIVATE to get a new one.
+/// @param capacity the number of elements, a power of two.
+/// @param size the size of an element.
+/// @param flags SHM_RING_MPMC and SHM_RING_BLOCK.
+/// @return the ring, NULL on failure and errno is set to indicate the error.
+shm_ring_t *shm_ring_create(key_t key, unsigned capacity, size_t size, int flags);
+
+/// @brief Attaches an existing ring, the segment mappings are not inherited
+/// by the children, which must call this after fork.
+/// @param key the key of the segment.
+/// @return the ring, NULL on failure and errno is set to indicate the error.
+shm_ring_t *shm_ring_attach(key_t key);
+
+/// @brief Detaches the ring from the calling process.
+/// @param ring the ring.
+/// @return 0 on success, -1 on failure and errno is set to indicate the error.
+int shm_ring_detach(shm_ring_t *ring);
+
+/// @brief Detaches the ring, and removes it together with its semaphores.
+/// It must be called once the other processes stopped using it.
+/// @param ring the ring.
+/// @return 0 on success, -1 on failure and errno is set to indicate the error.
+int shm_ring_destroy(shm_ring_t *ring);
+
+/// @brief Returns the number of elements in the ring.
+/// @param ring the ring.
+/// @return the number of elements.
+unsigned shm_ring_count(const shm_ring_t *ring);
+
+/// @brief Returns the number of elements that can be added to the ring.
+/// @param ring the ring.
+/// @return the number of free slots.
+unsigned shm_ring_free_count(const shm_ring_t *ring);
+
+/// @brief Adds either all the elements to the ring or none.
+/// @param ring the ring.
+/// @param elems the elements.
+/// @param n the number of elements.
+/// @return n on success, 0 if there is not enough room.
+unsigned shm_ring_enqueue_bulk(shm_ring_t *ring, const void *elems, unsigned n);
+
+/// @brief Adds as many elements as possible to the ring.
+/// @param ring the ring.
+/// @param elems the elements.
+/// @param n the number of elements.
+/// @return the number of elements added.
+unsigned shm_ring_enqueue_burst(shm_ring_t *ring, const void *elems, unsigned n);
+
+/// @brief Adds all the elements to the ring, waiting for room when it is full.
+/// @param ring the ring.
+/// @param elems the elements.
+/// @param n the number of elements.
+/// @return n on success, -1 on failure and errno is set to indicate the error.
+int shm_ring_enqueue_wait(shm_ring_t *ring, const void *elems, unsigned n);
+
+/// @brief Removes either n elements from the ring or none.
+/// @param ring the ring.
+/// @param elems where the elements are stored.
+/// @param n the number of elements.
+/// @return n on success, 0 if there are not enough elements.
+unsigned shm_ring_dequeue_bulk(shm_ring_t *ring, void *elems, unsigned n);
+
+/// @brief Removes up to n elements from the ring.
+/// @param ring the ring.
+/// @param elems where the elements are stored.
+/// @param n the maximum number of elements.
+/// @return the number of elements removed.
+unsigned shm_ring_dequeue_burst(shm_ring_t *ring, void *elems, unsigned n);
+
+/// @brief Removes n elements from the ring, waiting for them when it is empty.
+/// @param ring the ring.
+/// @param elems where the elements are stored.
+/// @param n the number of elements.
+/// @return n on success, -1 on failure and errno is set to indicate the error.
+int shm_ring_dequeue_wait(shm_ring_t *ring, void *elems, unsigned n);
@@ -6,10 +6,10 @@
 #pragma once
 
 /// @brief Define the signed 64-bit integer.
-typedef int int64_t;
+typedef long long int64_t;
 
 /// @brief Define the unsigned 64-bit integer.
-typedef unsigned int uint64_t;
+typedef unsigned long long uint64_t;
 
 /// @brief Define the signed 32-bit integer.
 typedef int int32_t;
@@ -62,5 +62,14 @@ typedef unsigned uintptr_t;
 /// @brief Maximum value of an unsigned 32-bit integer.
 #define UINT32_MAX (+4294967295U)
 
+/// @brief Minimum value of a signed 64-bit integer.
+#define INT64_MIN (-9223372036854775807LL - 1)
+
+/// @brief Maximum value of a signed 64-bit integer.
+#define INT64_MAX (+9223372036854775807LL)
+
+/// @brief Maximum value of an unsigned 64-bit integer.
+#define UINT64_MAX (+18446744073709551615ULL)
+
 /// @brief Maximum value representable by size_t.
 #define SIZE_MAX (+4294967295U)
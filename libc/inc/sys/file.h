@@ -0,0 +1,22 @@
+/// @file file.h
+/// @brief Advisory locks on whole files.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#pragma once
+
+/// @name flock Operations
+/// @brief Operations for the flock() function.
+/// @{
+#define LOCK_SH 1 ///< Place a shared lock.
+#define LOCK_EX 2 ///< Place an exclusive lock.
+#define LOCK_NB 4 ///< Do not block when the lock is held by someone else.
+#define LOCK_UN 8 ///< Remove the lock.
+/// @}
+
+/// @brief Applies or removes an advisory lock on the whole file.
+/// @param fd The file descriptor of the file.
+/// @param operation One of LOCK_SH, LOCK_EX, or LOCK_UN, optionally with LOCK_NB.
+/// @return 0 on success, -1 on failure and errno is set (EWOULDBLOCK if
+/// LOCK_NB was given and the lock is held by someone else).
+int flock(int fd, int operation);
@@ -14,6 +14,32 @@
 #define MAP_SHARED  0x01 ///< The memory is shared.
 #define MAP_PRIVATE 0x02 ///< The memory is private.
 
+#define MADV_NORMAL     0 ///< No special treatment.
+#define MADV_RANDOM     1 ///< Expect random page references.
+#define MADV_SEQUENTIAL 2 ///< Expect sequential page references.
+#define MADV_WILLNEED   3 ///< Expect access in the near future.
+#define MADV_DONTNEED   4 ///< Do not expect access in the near future.
+#define MADV_FREE       8 ///< The pages can be freed, unless they are written again.
+
+/// @brief gives advice about the use of memory in the given range.
+/// @param addr the starting address, which must be page-aligned.
+/// @param length the length of the range.
+/// @param advice one of the MADV_* values.
+/// @return 0 on success, -1 on failure and errno is set.
+int madvise(void *addr, size_t length, int advice);
+
+/// @brief locks the pages of the given range in memory.
+/// @param addr the starting address.
+/// @param length the length of the range.
+/// @return 0 on success, -1 on failure and errno is set.
+int mlock(const void *addr, size_t length);
+
+/// @brief unlocks the pages of the given range.
+/// @param addr the starting address.
+/// @param length the length of the range.
+/// @return 0 on success, -1 on failure and errno is set.
+int munlock(const void *addr, size_t length);
+
 #if 0
 
 /// @brief creates a new mapping in the virtual address space of the calling process.
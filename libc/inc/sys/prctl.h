@@ -0,0 +1,23 @@
+/// @file prctl.h
+/// @brief Operations on the calling process.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#pragma once
+
+/// Sets the timer slack of the calling process, in nanoseconds, 0 restores
+/// the default one.
+#define PR_SET_TIMERSLACK 29
+/// Returns the timer slack of the calling process, in nanoseconds.
+#define PR_GET_TIMERSLACK 30
+
+/// @brief Performs an operation on the calling process.
+/// @param option the operation (PR_*).
+/// @param arg2 the argument of the operation.
+/// @return the result of PR_GET_* operations, 0 for the other ones, -1 on
+/// error and errno is set.
+/// @details The timer slack tells how late the timers of the process (e.g.,
+/// the ones of `nanosleep`, `alarm` and `setitimer`) may expire, so that the
+/// kernel can handle timers expiring close to each other with a single
+/// wakeup. Real-time processes have no slack.
+int prctl(int option, unsigned long arg2);
@@ -18,9 +18,17 @@
 /// generated.
 #define ITIMER_PROF    2
 
+/// @brief The wall clock, it can be set and slewed.
+#define CLOCK_REALTIME  0
+/// @brief The time since boot, it cannot be set and never goes back.
+#define CLOCK_MONOTONIC 1
+
 /// Used to store time values.
 typedef unsigned int time_t;
 
+/// Used to identify a clock.
+typedef int clockid_t;
+
 /// Used to get information about the current time.
 typedef struct tm {
     /// Seconds [0 to 59]
@@ -61,6 +69,10 @@ typedef struct timespec {
     long tv_nsec;  ///< Nanoseconds.
 } timespec_t;
 
+/// @brief The difference in seconds between UTC and the local time, positive
+/// west of Greenwich. It is set by `tzset` from the `TZ` environment variable.
+extern long timezone;
+
 /// @brief Retrieves the current time.
 /// @param t Pointer to a `time_t` variable to store the current time, or NULL if not needed.
 /// @return The current time as `time_t`, or (time_t)-1 on failure.
@@ -82,11 +94,47 @@ char *ctime(const time_t *timer);
 /// @return The difference in terms of seconds.
 time_t difftime(time_t time1, time_t time2);
 
-/// @brief The current time broken down into a tm_t structure.
+/// @brief The given time broken down into a tm_t structure, in the local timezone.
 /// @param timep A pointer to a variable holding the current time.
 /// @return The time broken down.
 tm_t *localtime(const time_t *timep);
 
+/// @brief The given time broken down into a tm_t structure, in UTC.
+/// @param timep A pointer to a variable holding the current time.
+/// @return The time broken down.
+tm_t *gmtime(const time_t *timep);
+
+/// @brief Sets `timezone` from the `TZ` environment variable, in the POSIX
+/// form `NAME[+-]hh[:mm]` (e.g., `CET-1`). Without it, the local time is UTC.
+void tzset(void);
+
+/// @brief Retrieves the time of the given clock, with the resolution of the
+/// system timer (under a microsecond).
+/// @param clockid The clock (i.e., CLOCK_REALTIME, CLOCK_MONOTONIC).
+/// @param tp Where the time is stored.
+/// @return 0 on success, -1 on failure and errno is set to indicate the error.
+int clock_gettime(clockid_t clockid, struct timespec *tp);
+
+/// @brief Retrieves the wall clock time, with microsecond resolution.
+/// @param tv Where the time is stored.
+/// @param tz Ignored, use `tzset` and `timezone` instead.
+/// @return 0 on success, -1 on failure and errno is set to indicate the error.
+int gettimeofday(struct timeval *tv, void *tz);
+
+/// @brief Sets the wall clock time, only root can do it.
+/// @param tv The new time, in UTC.
+/// @param tz Ignored, the timezone is not kept by the kernel.
+/// @return 0 on success, -1 on failure and errno is set to indicate the error.
+int settimeofday(const struct timeval *tv, const void *tz);
+
+/// @brief Gradually corrects the wall clock, by slewing it at 500 ppm until
+/// the given correction has been applied, instead of stepping it.
+/// @param delta The correction, negative fields slow the clock down. If NULL,
+/// the pending correction is left untouched.
+/// @param olddelta Where the correction still pending is stored, can be NULL.
+/// @return 0 on success, -1 on failure and errno is set to indicate the error.
+int adjtime(const struct timeval *delta, struct timeval *olddelta);
+
 /// @brief Formats the time tm according to the format specification format
 ///        and places the result in the character array s of size max.
 /// @param str The destination buffer.
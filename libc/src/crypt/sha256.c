@@ -9,6 +9,12 @@
 /// Algorithm specification can be found here:
 ///     http://csrc.nist.gov/publications/fips/fips180-2/fips180-2withchangenotice.pdf
 /// This implementation uses little endian byte order.
+///
+/// There are three transforms, selected at runtime with cpuid: the SHA
+/// extensions, an unrolled scalar version, and a multi-buffer version which
+/// runs the rounds of four independent messages in the lanes of the SSE2
+/// registers. The input is consumed a block at a time, straight from the
+/// buffer of the caller, and only the partial blocks are copied in the context.
 
 #include "crypt/sha256.h"
 
@@ -31,12 +37,12 @@
 /// @brief Chooses bits from y if x is set, otherwise from z.
 /// @param x, y, z Input values.
 /// @return Result of CH function.
-#define CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define CH(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
 
 /// @brief Majority function used in SHA-256.
 /// @param x, y, z Input values.
 /// @return Result of the majority function.
-#define MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define MAJ(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
 
 /// @brief First expansion function for the working variables.
 /// @param x Input value.
@@ -58,13 +64,56 @@
 /// @return Result of SIG1.
 #define SIG1(x) (ROTRIGHT(x, 17) ^ ROTRIGHT(x, 19) ^ ((x) >> 10))
 
+/// @brief Reads a big endian 32-bit word, the compiler turns it into bswap.
+/// @param p Pointer to the first byte.
+/// @return The word.
+#define LOAD_BE32(p)                                                                                                   \
+    (((uint32_t)(p)[0] << 24U) | ((uint32_t)(p)[1] << 16U) | ((uint32_t)(p)[2] << 8U) | (uint32_t)(p)[3])
+
+/// @brief Computes the next word of the message schedule, in a window of 16.
+/// @param w The window.
+/// @param i The index of the word.
+#define SCHEDULE(w, i)                                                                                                 \
+    ((w)[(i) & 15] += SIG1((w)[((i) - 2) & 15]) + (w)[((i) - 7) & 15] + SIG0((w)[((i) - 15) & 15]))
+
+/// @brief One round of the compression function, on words or on vectors of
+/// words. Instead of moving the working variables, the callers rotate the
+/// arguments.
+/// @param a, b, c, d, e, f, g, h The working variables.
+/// @param ki The round constant.
+/// @param wi The word of the message schedule.
+#define ROUND(a, b, c, d, e, f, g, h, ki, wi)                                                                          \
+    do {                                                                                                               \
+        __typeof__(h) __t1 = (h) + EP1(e) + CH(e, f, g) + (ki) + (wi);                                                 \
+        (d) += __t1;                                                                                                   \
+        (h) = __t1 + EP0(a) + MAJ(a, b, c);                                                                            \
+    } while (0)
+
 /// Max data length for message scheduling expansion.
 #define SHA256_MAX_DATA_LENGTH (SHA256_BLOCK_SIZE * 2)
 
+/// The number of messages hashed together by the multi-buffer transform.
+#define SHA256_LANES 4
+
+/// Functions which use the SSE2 instructions.
+#define SSE2 __attribute__((target("sse2")))
+
+/// Functions which use the SHA extensions.
+#define SHANI __attribute__((target("sha,sse4.1")))
+
+/// Four 32-bit words, in an SSE register.
+typedef uint32_t v4su_t __attribute__((vector_size(16)));
+/// Four 32-bit words, which can be loaded from any address.
+typedef uint32_t v4su_u_t __attribute__((vector_size(16), aligned(1), may_alias));
+/// Four 32-bit signed words, the type of the SHA builtins.
+typedef int v4si_t __attribute__((vector_size(16)));
+/// Sixteen bytes, in an SSE register.
+typedef uint8_t v16qu_t __attribute__((vector_size(16)));
+
 /// @brief The constants used in the SHA-256 algorithm, as defined by the
 /// specification. These are the first 32 bits of the fractional parts of the
 /// cube roots of the first 64 primes (2..311).
-static const uint32_t k[SHA256_MAX_DATA_LENGTH] = {
+static const uint32_t k[SHA256_MAX_DATA_LENGTH] __attribute__((aligned(16))) = {
     0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
     0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
     0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
@@ -74,76 +123,323 @@ static const uint32_t k[SHA256_MAX_DATA_LENGTH] = {
     0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
     0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
 
-/// @brief Transforms the state of the SHA-256 context based on a block of input data.
-/// @param ctx Pointer to the SHA-256 context. Must not be NULL.
-/// @param data Input data block to process (64 bytes). Must not be NULL.
-static inline void __sha256_transform(SHA256_ctx_t *ctx, const uint8_t data[])
+/// @brief The initial hash values, the first 32 bits of the fractional parts
+/// of the square roots of the first 8 primes (2..19).
+static const uint32_t iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+/// @brief A transform of a sequence of blocks.
+typedef void (*sha256_blocks_t)(uint32_t state[8], const uint8_t *data, size_t nblocks);
+
+/// @brief A message assigned to a lane of the multi-buffer transform.
+typedef struct {
+    const uint8_t *data;                      ///< The full blocks of the message.
+    size_t nblocks;                           ///< The number of full blocks.
+    size_t total;                             ///< The number of blocks, with the padding.
+    size_t next;                              ///< The next block to process.
+    size_t index;                             ///< The index of the message.
+    uint8_t tail[2 * SHA256_MAX_DATA_LENGTH]; ///< The padded last blocks.
+} sha256_lane_t;
+
+/// @brief Transforms the state with a sequence of blocks, in portable C.
+/// @param state The hash state.
+/// @param data The blocks.
+/// @param nblocks The number of blocks.
+static void __sha256_blocks_generic(uint32_t state[8], const uint8_t *data, size_t nblocks)
 {
-    // Error checks: Ensure the input parameters are not NULL.
-    if (!ctx) {
-        perror("SHA256 context is NULL.\n");
-        return;
+    uint32_t a, b, c, d, e, f, g, h, i;
+    uint32_t w[16]; // Rolling window of the message schedule.
+
+    for (; nblocks; --nblocks, data += SHA256_MAX_DATA_LENGTH) {
+        a = state[0];
+        b = state[1];
+        c = state[2];
+        d = state[3];
+        e = state[4];
+        f = state[5];
+        g = state[6];
+        h = state[7];
+
+        // The first 16 rounds take the words straight from the input.
+        for (i = 0; i < 16; i += 8) {
+            ROUND(a, b, c, d, e, f, g, h, k[i + 0], w[i + 0] = LOAD_BE32(data + 4 * (i + 0)));
+            ROUND(h, a, b, c, d, e, f, g, k[i + 1], w[i + 1] = LOAD_BE32(data + 4 * (i + 1)));
+            ROUND(g, h, a, b, c, d, e, f, k[i + 2], w[i + 2] = LOAD_BE32(data + 4 * (i + 2)));
+            ROUND(f, g, h, a, b, c, d, e, k[i + 3], w[i + 3] = LOAD_BE32(data + 4 * (i + 3)));
+            ROUND(e, f, g, h, a, b, c, d, k[i + 4], w[i + 4] = LOAD_BE32(data + 4 * (i + 4)));
+            ROUND(d, e, f, g, h, a, b, c, k[i + 5], w[i + 5] = LOAD_BE32(data + 4 * (i + 5)));
+            ROUND(c, d, e, f, g, h, a, b, k[i + 6], w[i + 6] = LOAD_BE32(data + 4 * (i + 6)));
+            ROUND(b, c, d, e, f, g, h, a, k[i + 7], w[i + 7] = LOAD_BE32(data + 4 * (i + 7)));
+        }
+        // The other 48 extend the schedule in place.
+        for (; i < SHA256_MAX_DATA_LENGTH; i += 8) {
+            ROUND(a, b, c, d, e, f, g, h, k[i + 0], SCHEDULE(w, i + 0));
+            ROUND(h, a, b, c, d, e, f, g, k[i + 1], SCHEDULE(w, i + 1));
+            ROUND(g, h, a, b, c, d, e, f, k[i + 2], SCHEDULE(w, i + 2));
+            ROUND(f, g, h, a, b, c, d, e, k[i + 3], SCHEDULE(w, i + 3));
+            ROUND(e, f, g, h, a, b, c, d, k[i + 4], SCHEDULE(w, i + 4));
+            ROUND(d, e, f, g, h, a, b, c, k[i + 5], SCHEDULE(w, i + 5));
+            ROUND(c, d, e, f, g, h, a, b, k[i + 6], SCHEDULE(w, i + 6));
+            ROUND(b, c, d, e, f, g, h, a, k[i + 7], SCHEDULE(w, i + 7));
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
     }
-    if (!data) {
-        perror("Input data is NULL.\n");
-        return;
+}
+
+/// @brief Four rounds with the SHA extensions, and the message schedule of
+/// the following ones.
+/// @param i The index of the group of four rounds.
+/// @param cur The words of these rounds.
+/// @param next The words of the group after this one, completed here.
+/// @param prev The words of the group before this one, which start the
+/// schedule of the group after the next one.
+#define SHANI_ROUNDS(i, cur, next, prev)                                                                               \
+    do {                                                                                                               \
+        if ((i) < 4) {                                                                                                 \
+            (cur) = (v4si_t)__builtin_shuffle((v16qu_t) * (const v4su_u_t *)(data + 16 * (i)), bswap);                 \
+        }                                                                                                              \
+        msg    = (cur) + *(const v4si_t *)&k[4 * (i)];                                                                 \
+        state1 = __builtin_ia32_sha256rnds2(state1, state0, msg);                                                      \
+        if (((i) >= 3) && ((i) <= 14)) {                                                                               \
+            (next) = __builtin_ia32_sha256msg2((next) + __builtin_shuffle((prev), (cur), shift), (cur));               \
+        }                                                                                                              \
+        msg    = __builtin_shuffle(msg, high);                                                                         \
+        state0 = __builtin_ia32_sha256rnds2(state0, state1, msg);                                                      \
+        if (((i) >= 1) && ((i) <= 12)) {                                                                               \
+            (prev) = __builtin_ia32_sha256msg1((prev), (cur));                                                         \
+        }                                                                                                              \
+    } while (0)
+
+/// @brief Transforms the state with a sequence of blocks, with the SHA
+/// extensions.
+/// @param state The hash state.
+/// @param data The blocks.
+/// @param nblocks The number of blocks.
+SHANI static void __sha256_blocks_shani(uint32_t state[8], const uint8_t *data, size_t nblocks)
+{
+    // Swaps the bytes of each word.
+    const v16qu_t bswap = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+    // Moves the upper two words to the lower half, for the second rnds2.
+    const v4si_t high   = {2, 3, 0, 0};
+    // Picks the last three words of the first vector and the first of the second.
+    const v4si_t shift  = {1, 2, 3, 4};
+    v4si_t state0, state1, save0, save1, msg, m0, m1, m2, m3;
+
+    // The instructions want the state as ABEF and CDGH, from the high word.
+    v4si_t abcd = (v4si_t) * (const v4su_u_t *)&state[0];
+    v4si_t efgh = (v4si_t) * (const v4su_u_t *)&state[4];
+    state0      = __builtin_shuffle(abcd, efgh, (v4si_t){5, 4, 1, 0});
+    state1      = __builtin_shuffle(abcd, efgh, (v4si_t){7, 6, 3, 2});
+
+    for (; nblocks; --nblocks, data += SHA256_MAX_DATA_LENGTH) {
+        save0 = state0;
+        save1 = state1;
+        SHANI_ROUNDS(0, m0, m1, m3);
+        SHANI_ROUNDS(1, m1, m2, m0);
+        SHANI_ROUNDS(2, m2, m3, m1);
+        SHANI_ROUNDS(3, m3, m0, m2);
+        SHANI_ROUNDS(4, m0, m1, m3);
+        SHANI_ROUNDS(5, m1, m2, m0);
+        SHANI_ROUNDS(6, m2, m3, m1);
+        SHANI_ROUNDS(7, m3, m0, m2);
+        SHANI_ROUNDS(8, m0, m1, m3);
+        SHANI_ROUNDS(9, m1, m2, m0);
+        SHANI_ROUNDS(10, m2, m3, m1);
+        SHANI_ROUNDS(11, m3, m0, m2);
+        SHANI_ROUNDS(12, m0, m1, m3);
+        SHANI_ROUNDS(13, m1, m2, m0);
+        SHANI_ROUNDS(14, m2, m3, m1);
+        SHANI_ROUNDS(15, m3, m0, m2);
+        state0 += save0;
+        state1 += save1;
     }
 
-    uint32_t a, b, c, d, e, f, g, h, i, j, t1, t2;
-    uint32_t m[SHA256_MAX_DATA_LENGTH]; // Message schedule array.
+    abcd = __builtin_shuffle(state0, state1, (v4si_t){3, 2, 7, 6});
+    efgh = __builtin_shuffle(state0, state1, (v4si_t){1, 0, 5, 4});
+    *(v4su_u_t *)&state[0] = (v4su_t)abcd;
+    *(v4su_u_t *)&state[4] = (v4su_t)efgh;
+}
 
-    // Step 1: Prepare the message schedule (first 16 words are directly from
-    // the input data).
-    for (i = 0, j = 0; i < 16; ++i, j += 4) {
-        // Each 32-bit word is constructed from 4 consecutive 8-bit bytes from
-        // the input data.
-        m[i] = (uint32_t)(data[j] << 24) | (uint32_t)(data[j + 1] << 16) | (uint32_t)(data[j + 2] << 8) |
-               (uint32_t)(data[j + 3]);
+/// @brief Transforms the states of four messages with a block of each, in the
+/// lanes of the SSE2 registers.
+/// @param state The hash states, word by word, one message per lane.
+/// @param blocks The blocks of the messages.
+SSE2 static void __sha256_blocks_x4(v4su_t state[8], const uint8_t *const blocks[SHA256_LANES])
+{
+    v4su_t a = state[0], b = state[1], c = state[2], d = state[3];
+    v4su_t e = state[4], f = state[5], g = state[6], h = state[7];
+    v4su_t w[16];
+    uint32_t i;
+
+    // Transpose the blocks, so that each vector holds a word of each message.
+    for (i = 0; i < 16; ++i) {
+        w[i] = (v4su_t){LOAD_BE32(blocks[0] + 4 * i), LOAD_BE32(blocks[1] + 4 * i), LOAD_BE32(blocks[2] + 4 * i),
+                        LOAD_BE32(blocks[3] + 4 * i)};
+    }
+    for (i = 0; i < 16; i += 8) {
+        ROUND(a, b, c, d, e, f, g, h, k[i + 0], w[i + 0]);
+        ROUND(h, a, b, c, d, e, f, g, k[i + 1], w[i + 1]);
+        ROUND(g, h, a, b, c, d, e, f, k[i + 2], w[i + 2]);
+        ROUND(f, g, h, a, b, c, d, e, k[i + 3], w[i + 3]);
+        ROUND(e, f, g, h, a, b, c, d, k[i + 4], w[i + 4]);
+        ROUND(d, e, f, g, h, a, b, c, k[i + 5], w[i + 5]);
+        ROUND(c, d, e, f, g, h, a, b, k[i + 6], w[i + 6]);
+        ROUND(b, c, d, e, f, g, h, a, k[i + 7], w[i + 7]);
+    }
+    for (; i < SHA256_MAX_DATA_LENGTH; i += 8) {
+        ROUND(a, b, c, d, e, f, g, h, k[i + 0], SCHEDULE(w, i + 0));
+        ROUND(h, a, b, c, d, e, f, g, k[i + 1], SCHEDULE(w, i + 1));
+        ROUND(g, h, a, b, c, d, e, f, k[i + 2], SCHEDULE(w, i + 2));
+        ROUND(f, g, h, a, b, c, d, e, k[i + 3], SCHEDULE(w, i + 3));
+        ROUND(e, f, g, h, a, b, c, d, k[i + 4], SCHEDULE(w, i + 4));
+        ROUND(d, e, f, g, h, a, b, c, k[i + 5], SCHEDULE(w, i + 5));
+        ROUND(c, d, e, f, g, h, a, b, k[i + 6], SCHEDULE(w, i + 6));
+        ROUND(b, c, d, e, f, g, h, a, k[i + 7], SCHEDULE(w, i + 7));
     }
 
-    // Step 2: Extend the first 16 words into the remaining 48 words of the
-    // message schedule. Each word is computed based on the previous words using
-    // the SIG1 and SIG0 functions.
-    for (; i < SHA256_MAX_DATA_LENGTH; ++i) {
-        m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+/// @brief Runs cpuid.
+/// @param leaf The leaf.
+/// @param regs Where eax, ebx, ecx and edx are stored.
+static inline void __cpuid(uint32_t leaf, uint32_t regs[4])
+{
+    __asm__ __volatile__("cpuid"
+                         : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3])
+                         : "a"(leaf), "c"(0));
+}
+
+/// @brief Checks if the processor supports an implementation.
+/// @param impl The implementation.
+/// @return 1 if it does, 0 otherwise.
+static int __sha256_supported(sha256_impl_t impl)
+{
+    uint32_t regs[4];
+    if (impl == SHA256_IMPL_GENERIC) {
+        return 1;
     }
+    __cpuid(0, regs);
+    uint32_t max_leaf = regs[0];
+    __cpuid(1, regs);
+    if (impl == SHA256_IMPL_SSE2) {
+        return (int)((regs[3] >> 26U) & 1U);
+    }
+    if ((impl == SHA256_IMPL_SHANI) && (max_leaf >= 7)) {
+        // SSSE3 and SSE4.1 are needed to shuffle the words.
+        if (!((regs[2] >> 9U) & 1U) || !((regs[2] >> 19U) & 1U)) {
+            return 0;
+        }
+        __cpuid(7, regs);
+        return (int)((regs[1] >> 29U) & 1U);
+    }
+    return 0;
+}
+
+/// The implementation in use, SHA256_IMPL_AUTO until the first call.
+static sha256_impl_t sha256_impl = SHA256_IMPL_AUTO;
 
-    // Step 3: Initialize the working variables with the current state values.
-    a = ctx->state[0];
-    b = ctx->state[1];
-    c = ctx->state[2];
-    d = ctx->state[3];
-    e = ctx->state[4];
-    f = ctx->state[5];
-    g = ctx->state[6];
-    h = ctx->state[7];
-
-    // Step 4: Perform the main hash computation (64 rounds).
-    for (i = 0; i < SHA256_MAX_DATA_LENGTH; ++i) {
-        // Calculate the temporary values.
-        t1 = h + EP1(e) + CH(e, f, g) + k[i] + m[i];
-        t2 = EP0(a) + MAJ(a, b, c);
-
-        // Rotate the working variables for the next round.
-        h = g;
-        g = f;
-        f = e;
-        e = d + t1;
-        d = c;
-        c = b;
-        b = a;
-        a = t1 + t2;
+/// The transform of a single stream, which goes with sha256_impl.
+static sha256_blocks_t sha256_blocks = __sha256_blocks_generic;
+
+/// @brief Returns the transform of a single stream, selecting the fastest
+/// implementation the first time it is called.
+/// @return The transform.
+static inline sha256_blocks_t __sha256_get_blocks(void)
+{
+    if (sha256_impl == SHA256_IMPL_AUTO) {
+        sha256_set_impl(SHA256_IMPL_AUTO);
+    }
+    return sha256_blocks;
+}
+
+int sha256_set_impl(sha256_impl_t impl)
+{
+    if (impl == SHA256_IMPL_AUTO) {
+        if (__sha256_supported(SHA256_IMPL_SHANI)) {
+            impl = SHA256_IMPL_SHANI;
+        } else if (__sha256_supported(SHA256_IMPL_SSE2)) {
+            impl = SHA256_IMPL_SSE2;
+        } else {
+            impl = SHA256_IMPL_GENERIC;
+        }
+    } else if (!sha256_impl_name(impl) || !__sha256_supported(impl)) {
+        return -1;
     }
+    sha256_impl   = impl;
+    sha256_blocks = (impl == SHA256_IMPL_SHANI) ? __sha256_blocks_shani : __sha256_blocks_generic;
+    return 0;
+}
 
-    // Step 5: Add the resulting values back into the current state.
-    ctx->state[0] += a;
-    ctx->state[1] += b;
-    ctx->state[2] += c;
-    ctx->state[3] += d;
-    ctx->state[4] += e;
-    ctx->state[5] += f;
-    ctx->state[6] += g;
-    ctx->state[7] += h;
+sha256_impl_t sha256_get_impl(void)
+{
+    __sha256_get_blocks();
+    return sha256_impl;
+}
+
+const char *sha256_impl_name(sha256_impl_t impl)
+{
+    switch (impl) {
+    case SHA256_IMPL_AUTO:
+        return "auto";
+    case SHA256_IMPL_GENERIC:
+        return "generic";
+    case SHA256_IMPL_SSE2:
+        return "sse2";
+    case SHA256_IMPL_SHANI:
+        return "sha-ni";
+    default:
+        return NULL;
+    }
+}
+
+/// @brief Pads the end of a message.
+/// @param tail Where the padded blocks are stored (128 bytes).
+/// @param rest The bytes of the message after the last full block.
+/// @param rest_length The number of these bytes, less than 64.
+/// @param bitlen The length of the whole message, in bits.
+/// @return The number of padded blocks, 1 or 2.
+static size_t __sha256_pad(uint8_t tail[], const uint8_t rest[], size_t rest_length, unsigned long long bitlen)
+{
+    // The length needs 8 bytes after the 0x80, otherwise it goes in a second block.
+    size_t nblocks = (rest_length < 56) ? 1 : 2;
+    size_t end     = nblocks * SHA256_MAX_DATA_LENGTH;
+
+    memmove(tail, rest, rest_length);
+    tail[rest_length] = 0x80;
+    memset(tail + rest_length + 1, 0, end - rest_length - 1);
+    for (size_t i = 1; i <= 8; ++i, bitlen >>= 8U) {
+        tail[end - i] = (uint8_t)bitlen;
+    }
+    return nblocks;
+}
+
+/// @brief Stores the hash state as the big endian digest.
+/// @param state The hash state.
+/// @param hash Where the digest is stored.
+static inline void __sha256_store(const uint32_t state[8], uint8_t hash[])
+{
+    for (uint32_t i = 0; i < 8; ++i) {
+        hash[4 * i]     = (uint8_t)(state[i] >> 24U);
+        hash[4 * i + 1] = (uint8_t)(state[i] >> 16U);
+        hash[4 * i + 2] = (uint8_t)(state[i] >> 8U);
+        hash[4 * i + 3] = (uint8_t)state[i];
+    }
 }
 
 void sha256_bytes_to_hex(uint8_t *src, size_t src_length, char *out, size_t out_length)
@@ -181,14 +477,7 @@ void sha256_init(SHA256_ctx_t *ctx)
     ctx->bitlen = 0;
 
     // Initialize the state variables (hash values) to the SHA-256 initial constants.
-    ctx->state[0] = 0x6a09e667;
-    ctx->state[1] = 0xbb67ae85;
-    ctx->state[2] = 0x3c6ef372;
-    ctx->state[3] = 0xa54ff53a;
-    ctx->state[4] = 0x510e527f;
-    ctx->state[5] = 0x9b05688c;
-    ctx->state[6] = 0x1f83d9ab;
-    ctx->state[7] = 0x5be0cd19;
+    memcpy(ctx->state, iv, sizeof(iv));
 }
 
 void sha256_update(SHA256_ctx_t *ctx, const uint8_t data[], size_t len)
@@ -204,24 +493,36 @@ void sha256_update(SHA256_ctx_t *ctx, const uint8_t data[], size_t len)
         return; // Return early if the data is NULL to prevent errors.
     }
 
-    // Iterate over the input data, processing it in chunks.
-    for (uint32_t i = 0; i < len; ++i) {
-        // Add data to the context's buffer.
-        ctx->data[ctx->datalen] = data[i];
-        ctx->datalen++;
+    sha256_blocks_t blocks = __sha256_get_blocks();
 
-        // If the buffer is full, process the data and reset the buffer.
-        if (ctx->datalen == SHA256_MAX_DATA_LENGTH) {
-            // Perform the SHA-256 transformation on the full data block.
-            __sha256_transform(ctx, ctx->data);
-
-            // Update the total length of the data processed so far in bits.
-            ctx->bitlen += 512;
-
-            // Reset the buffer length to 0 for the next chunk of data.
-            ctx->datalen = 0;
+    // Complete the block left in the buffer by the previous call.
+    if (ctx->datalen) {
+        size_t fill = SHA256_MAX_DATA_LENGTH - ctx->datalen;
+        if (len < fill) {
+            memcpy(ctx->data + ctx->datalen, data, len);
+            ctx->datalen += len;
+            return;
         }
+        memcpy(ctx->data + ctx->datalen, data, fill);
+        blocks(ctx->state, ctx->data, 1);
+        ctx->bitlen += 512;
+        ctx->datalen = 0;
+        data += fill;
+        len -= fill;
     }
+
+    // Hash the full blocks straight from the input.
+    size_t nblocks = len / SHA256_MAX_DATA_LENGTH;
+    if (nblocks) {
+        blocks(ctx->state, data, nblocks);
+        ctx->bitlen += 512ULL * nblocks;
+        data += nblocks * SHA256_MAX_DATA_LENGTH;
+        len -= nblocks * SHA256_MAX_DATA_LENGTH;
+    }
+
+    // Keep the rest for the next call.
+    memcpy(ctx->data, data, len);
+    ctx->datalen = (uint32_t)len;
 }
 
 void sha256_final(SHA256_ctx_t *ctx, uint8_t hash[])
@@ -236,69 +537,124 @@ void sha256_final(SHA256_ctx_t *ctx, uint8_t hash[])
         return; // Return early if the output buffer is NULL to prevent errors.
     }
 
-    // Get the current length of the data buffer.
-    uint32_t i = ctx->datalen;
+    uint8_t tail[2 * SHA256_MAX_DATA_LENGTH];
 
-    // Step 1: Pad whatever data is left in the buffer.
+    // Pad the data left in the buffer, and append the total length in bits.
+    ctx->bitlen += ctx->datalen * 8;
+    size_t nblocks = __sha256_pad(tail, ctx->data, ctx->datalen, ctx->bitlen);
+
+    // Process the final blocks.
+    __sha256_get_blocks()(ctx->state, tail, nblocks);
+
+    // SHA-256 uses big-endian byte order, so we reverse the byte order when
+    // copying.
+    __sha256_store(ctx->state, hash);
+}
 
-    // If there's enough space in the buffer (less than 56 bytes used), pad
-    // with 0x80 followed by zeros.
-    if (ctx->datalen < 56) {
-        // Append the padding byte (0x80).
-        ctx->data[i++] = 0x80;
+/// @brief Assigns a message to a lane of the multi-buffer transform.
+/// @param lane The lane.
+/// @param state The hash states of the lanes.
+/// @param slot The index of the lane.
+/// @param data The message.
+/// @param len The length of the message, in bytes.
+/// @param index The index of the message.
+static void __sha256_lane_load(
+    sha256_lane_t *lane, v4su_t state[8], size_t slot, const uint8_t *data, size_t len, size_t index)
+{
+    lane->data    = data;
+    lane->nblocks = len / SHA256_MAX_DATA_LENGTH;
+    lane->total   = lane->nblocks + __sha256_pad(lane->tail, data + lane->nblocks * SHA256_MAX_DATA_LENGTH,
+                                                 len % SHA256_MAX_DATA_LENGTH, 8ULL * len);
+    lane->next    = 0;
+    lane->index   = index;
+    for (uint32_t i = 0; i < 8; ++i) {
+        state[i][slot] = iv[i];
+    }
+}
 
-        // Pad the buffer with zeros until we reach 56 bytes.
-        while (i < 56) {
-            ctx->data[i++] = 0x00;
+/// @brief Hashes independent messages four at a time, with SSE2. A lane is
+/// given the next message as soon as it is done with its own, so messages of
+/// different lengths keep all the lanes busy.
+/// @param data The messages.
+/// @param len The lengths of the messages, in bytes.
+/// @param hash The buffers where the digests are stored.
+/// @param count The number of messages.
+SSE2 static void __sha256_multi_x4(
+    const uint8_t *const data[], const size_t len[], uint8_t *const hash[], size_t count)
+{
+    static const uint8_t zero[SHA256_MAX_DATA_LENGTH];
+    sha256_lane_t lanes[SHA256_LANES];
+    const uint8_t *blocks[SHA256_LANES];
+    v4su_t state[8];
+    uint32_t digest[8];
+    size_t next = 0, active = 0, slot;
+
+    for (slot = 0; slot < SHA256_LANES; ++slot) {
+        if (next < count) {
+            __sha256_lane_load(&lanes[slot], state, slot, data[next], len[next], next);
+            ++next;
+            ++active;
+        } else {
+            lanes[slot].data = NULL;
         }
     }
-    // If there's not enough space, pad the remaining buffer and process it.
-    else {
-        // Append the padding byte (0x80).
-        ctx->data[i++] = 0x80;
-
-        // Fill the rest of the buffer with zeros.
-        while (i < SHA256_MAX_DATA_LENGTH) {
-            ctx->data[i++] = 0x00;
+    while (active) {
+        // Idle lanes hash a block of zeros, and their result is ignored.
+        for (slot = 0; slot < SHA256_LANES; ++slot) {
+            sha256_lane_t *lane = &lanes[slot];
+            if (!lane->data) {
+                blocks[slot] = zero;
+            } else if (lane->next < lane->nblocks) {
+                blocks[slot] = lane->data + lane->next * SHA256_MAX_DATA_LENGTH;
+            } else {
+                blocks[slot] = lane->tail + (lane->next - lane->nblocks) * SHA256_MAX_DATA_LENGTH;
+            }
+        }
+        __sha256_blocks_x4(state, blocks);
+        for (slot = 0; slot < SHA256_LANES; ++slot) {
+            sha256_lane_t *lane = &lanes[slot];
+            if (!lane->data || (++lane->next < lane->total)) {
+                continue;
+            }
+            for (uint32_t i = 0; i < 8; ++i) {
+                digest[i] = state[i][slot];
+            }
+            __sha256_store(digest, hash[lane->index]);
+            if (next < count) {
+                __sha256_lane_load(lane, state, slot, data[next], len[next], next);
+                ++next;
+            } else {
+                lane->data = NULL;
+                --active;
+            }
         }
-
-        // Process the full buffer.
-        __sha256_transform(ctx, ctx->data);
-
-        // Reset the buffer for the next padding.
-        memset(ctx->data, 0, 56);
     }
+}
 
-    // Step 2: Append the total message length in bits and process the final block.
-
-    // Convert the total length from bytes to bits.
-    ctx->bitlen += ctx->datalen * 8;
-
-    // Append the lower 8 bits of the length.
-    ctx->data[63] = ctx->bitlen;
-    ctx->data[62] = ctx->bitlen >> 8;
-    ctx->data[61] = ctx->bitlen >> 16;
-    ctx->data[60] = ctx->bitlen >> 24;
-    ctx->data[59] = ctx->bitlen >> 32;
-    ctx->data[58] = ctx->bitlen >> 40;
-    ctx->data[57] = ctx->bitlen >> 48;
-    ctx->data[56] = ctx->bitlen >> 56;
-
-    // Process the final block.
-    __sha256_transform(ctx, ctx->data);
+void sha256_multi(const uint8_t *const data[], const size_t len[], uint8_t *const hash[], size_t count)
+{
+    if (!data || !len || !hash) {
+        perror("Input data is NULL.\n");
+        return;
+    }
 
-    // Step 3: Copy the final state (hash) to the output buffer.
+    sha256_blocks_t blocks = __sha256_get_blocks();
 
-    // SHA-256 uses big-endian byte order, so we reverse the byte order when
-    // copying.
-    for (i = 0; i < 4; ++i) {
-        hash[i]      = (ctx->state[0] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 4]  = (ctx->state[1] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 8]  = (ctx->state[2] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 12] = (ctx->state[3] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 16] = (ctx->state[4] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 20] = (ctx->state[5] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 24] = (ctx->state[6] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 28] = (ctx->state[7] >> (24 - i * 8)) & 0x000000ff;
+    // A single message gains nothing from the lanes.
+    if ((sha256_impl == SHA256_IMPL_SSE2) && (count > 1)) {
+        __sha256_multi_x4(data, len, hash, count);
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t state[8];
+        uint8_t tail[2 * SHA256_MAX_DATA_LENGTH];
+        size_t nblocks = len[i] / SHA256_MAX_DATA_LENGTH;
+
+        memcpy(state, iv, sizeof(iv));
+        blocks(state, data[i], nblocks);
+        blocks(state, tail,
+               __sha256_pad(tail, data[i] + nblocks * SHA256_MAX_DATA_LENGTH, len[i] % SHA256_MAX_DATA_LENGTH,
+                            8ULL * len[i]));
+        __sha256_store(state, hash[i]);
     }
 }
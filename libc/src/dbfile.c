@@ -0,0 +1,85 @@
+/// @file dbfile.c
+/// @brief Support functions for the databases of the system kept in memory.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "bits/dbfile.h"
+#include "fcntl.h"
+#include "stdlib.h"
+#include "string.h"
+#include "sys/stat.h"
+#include "unistd.h"
+
+int dbfile_load(dbfile_t *db, const char *path, int *lines)
+{
+    stat_t st;
+    if (stat(path, &st) < 0) {
+        dbfile_free(db);
+        return -1;
+    }
+    if (db->data && (db->ino == st.st_ino) && (db->size == st.st_size) && (db->mtime == st.st_mtime)) {
+        return 0;
+    }
+    dbfile_free(db);
+    int fd = open(path, O_RDONLY, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    // Read the whole file at once.
+    char *data     = malloc(st.st_size + 1);
+    ssize_t length = 0, ret;
+    while (data && (length < st.st_size) && ((ret = read(fd, data + length, st.st_size - length)) > 0)) {
+        length += ret;
+    }
+    close(fd);
+    if (!data) {
+        return -1;
+    }
+    data[length] = 0;
+    // Count the lines, to size the entries.
+    *lines = 1;
+    for (ssize_t i = 0; i < length; ++i) {
+        *lines += (data[i] == '\n');
+    }
+    db->data  = data;
+    db->ino   = st.st_ino;
+    db->size  = st.st_size;
+    db->mtime = st.st_mtime;
+    return 1;
+}
+
+void dbfile_free(dbfile_t *db)
+{
+    free(db->data);
+    db->data = NULL;
+}
+
+char *dbfile_next_line(char **it)
+{
+    while (**it) {
+        char *line = *it;
+        char *end  = line + strcspn(line, "\r\n");
+        if (*end) {
+            *end++ = 0;
+            end += strspn(end, "\r\n");
+        }
+        *it = end;
+        if (*line) {
+            return line;
+        }
+    }
+    return NULL;
+}
+
+int dbfile_copy_field(char **dest, const char *src, char **buf, size_t *buflen)
+{
+    size_t length = strlen(src) + 1;
+    if (length > *buflen) {
+        return 0;
+    }
+    memcpy(*buf, src, length);
+    *dest = *buf;
+    *buf += length;
+    *buflen -= length;
+    return 1;
+}
@@ -1,109 +1,519 @@
 /// @file fcvt.c
 /// @brief Define the functions required to turn double values into a string.
+/// @details The digits of a double are produced exactly, one at a time: the
+/// integer part is kept in base 10^9, and the fractional part as a fraction
+/// with a power of two as denominator, multiplied by ten for every digit. The
+/// rounding is decided by reading ahead on a copy of the state, so that the
+/// callers can print the digits as they come, without a buffer.
 /// @copyright (c) 2014-2024 This file is distributed under the MIT License.
 /// See LICENSE.md for details.
-//! @cond Doxygen_Suppress
 
 #include "fcvt.h"
-#include "math.h"
 
-static void cvt(double arg, int ndigits, int *decpt, int *sign, char *buf, unsigned buf_size, int eflag)
+/// The base of the limbs of the integer part.
+#define CVT_BASE 1000000000U
+
+/// @brief Divides a 64-bit value by a 32-bit one, with a single divl.
+/// @param dividend the dividend, whose upper half must be less than the divisor.
+/// @param divisor the divisor.
+/// @param remainder where the remainder is stored.
+/// @return the quotient.
+static inline uint32_t __divl(uint64_t dividend, uint32_t divisor, uint32_t *remainder)
 {
-    int r2;
-    double fi;
-    double fj;
-    char *p;
-    char *p1;
+    uint32_t quotient;
+    __asm__("divl %4"
+            : "=a"(quotient), "=d"(*remainder)
+            : "a"((uint32_t)dividend), "d"((uint32_t)(dividend >> 32U)), "rm"(divisor));
+    return quotient;
+}
 
-    char *buf_end = (buf + buf_size);
+/// @brief Loads the digits of a limb of the integer part.
+/// @param gen the generator.
+/// @param limb the limb.
+static inline void __gen_load(cvt_gen_t *gen, uint32_t limb)
+{
+    for (int i = 8; i >= 0; --i) {
+        gen->idigits[i] = (char)(limb % 10U);
+        limb /= 10U;
+    }
+    gen->ipos = 0;
+}
 
-    if (ndigits < 0) {
-        ndigits = 0;
+/// @brief Returns the exact next digit of a generator.
+/// @param gen the generator.
+/// @return the digit, 0 after the last non-zero one.
+static int __gen_next(cvt_gen_t *gen)
+{
+    uint32_t carry = 0;
+    if (gen->pending >= 0) {
+        int digit    = gen->pending;
+        gen->pending = -1;
+        return digit;
+    }
+    // The digits of the integer part, from the most significant one.
+    if (gen->ipos < 9) {
+        int digit = gen->idigits[gen->ipos++];
+        if ((gen->ipos == 9) && gen->ilen) {
+            __gen_load(gen, gen->ipart[--gen->ilen]);
+        }
+        return digit;
     }
+    // The digits of the fractional part: the next one is what overflows when
+    // multiplying it by ten.
+    for (int i = gen->fbot; i < gen->flen; ++i) {
+        uint64_t t    = (uint64_t)gen->fpart[i] * 10U + carry;
+        gen->fpart[i] = (uint32_t)t;
+        carry         = (uint32_t)(t >> 32U);
+    }
+    while ((gen->fbot < gen->flen) && !gen->fpart[gen->fbot]) {
+        ++gen->fbot;
+    }
+    return (int)carry;
+}
 
-    if (ndigits >= buf_size - 1) {
-        ndigits = buf_size - 2;
+/// @brief Checks if any of the remaining digits of a generator is not zero.
+/// @param gen the generator.
+/// @return 1 if there is one, 0 otherwise.
+static int __gen_sticky(const cvt_gen_t *gen)
+{
+    if (gen->fbot < gen->flen) {
+        return 1;
+    }
+    for (int i = gen->ipos; i < 9; ++i) {
+        if (gen->idigits[i]) {
+            return 1;
+        }
     }
+    for (int i = 0; i < gen->ilen; ++i) {
+        if (gen->ipart[i]) {
+            return 1;
+        }
+    }
+    return 0;
+}
 
-    r2    = 0;
-    *sign = 0;
-    p     = &buf[0];
+/// @brief Copies the state of a generator, without its unused limbs.
+/// @param dst the copy.
+/// @param src the generator.
+static inline void __gen_copy(cvt_gen_t *dst, const cvt_gen_t *src)
+{
+    for (int i = 0; i < src->ilen; ++i) {
+        dst->ipart[i] = src->ipart[i];
+    }
+    for (int i = src->fbot; i < src->flen; ++i) {
+        dst->fpart[i] = src->fpart[i];
+    }
+    for (int i = 0; i < 9; ++i) {
+        dst->idigits[i] = src->idigits[i];
+    }
+    dst->ilen    = src->ilen;
+    dst->flen    = src->flen;
+    dst->fbot    = src->fbot;
+    dst->ipos    = src->ipos;
+    dst->pending = src->pending;
+}
 
-    if (arg < 0) {
-        *sign = 1;
-        arg   = -arg;
+/// @brief Prepares the generator of the digits of mant * 2^exp.
+/// @param gen the generator.
+/// @param mant the significand, not zero.
+/// @param exp the exponent.
+/// @return the position of the decimal point, relative to the first digit.
+static int __gen_init(cvt_gen_t *gen, uint64_t mant, int exp)
+{
+    uint64_t ipart = 0, fbits = 0;
+    uint32_t rem, carry;
+    int decpt = 0;
+
+    gen->ilen    = 0;
+    gen->flen    = 0;
+    gen->fbot    = 0;
+    gen->ipos    = 9;
+    gen->pending = -1;
+    if (exp >= 0) {
+        ipart = mant;
+    } else if (exp > -64) {
+        ipart = mant >> (unsigned)-exp;
+        fbits = mant & ((1ULL << (unsigned)-exp) - 1U);
+    } else {
+        fbits = mant;
     }
 
-    arg = modf(arg, &fi);
-    p1  = buf_end;
+    // The integer part, less than 2^53 before the shift.
+    if (ipart) {
+        uint32_t high        = __divl(ipart, CVT_BASE, &rem);
+        gen->ipart[gen->ilen++] = rem;
+        if (high) {
+            gen->ipart[gen->ilen++] = high;
+        }
+        // Multiply by 2^exp, 28 bits at a time, so that the carries fit a limb.
+        for (int shift = exp; shift > 0; shift -= 28) {
+            unsigned step = (shift < 28) ? (unsigned)shift : 28U;
+            carry         = 0;
+            for (int i = 0; i < gen->ilen; ++i) {
+                carry         = __divl(((uint64_t)gen->ipart[i] << step) + carry, CVT_BASE, &rem);
+                gen->ipart[i] = rem;
+            }
+            if (carry) {
+                gen->ipart[gen->ilen++] = carry;
+            }
+        }
+        // Start from the most significant limb, without its leading zeros.
+        __gen_load(gen, gen->ipart[--gen->ilen]);
+        while (!gen->idigits[gen->ipos]) {
+            ++gen->ipos;
+        }
+        decpt = 9 * (gen->ilen + 1) - gen->ipos;
+    }
 
-    if (fi != 0) {
-        p1 = buf_end;
-        while (fi != 0) {
-            fj    = modf(fi / 10, &fi);
-            *--p1 = (int)((fj + .03) * 10) + '0';
-            r2++;
+    // The fractional part, fbits / 2^-exp, aligned to the top of the limbs.
+    if (fbits) {
+        unsigned shift = (unsigned)-exp;
+        unsigned align;
+        gen->flen      = (int)((shift + 31U) / 32U);
+        align          = 32U * (unsigned)gen->flen - shift;
+        for (int i = 0; i < gen->flen; ++i) {
+            gen->fpart[i] = 0;
+        }
+        gen->fpart[0] = (uint32_t)(fbits << align);
+        if (gen->flen > 1) {
+            gen->fpart[1] = (uint32_t)((fbits << align) >> 32U);
         }
-        while (p1 < buf_end) {
-            *p++ = *p1++;
+        if ((gen->flen > 2) && align) {
+            gen->fpart[2] = (uint32_t)(fbits >> (64U - align));
         }
-    } else if (arg > 0) {
-        while ((fj = arg * 10) < 1) {
-            arg = fj;
-            r2--;
+        while (!gen->fpart[gen->fbot]) {
+            ++gen->fbot;
         }
     }
 
-    p1 = &buf[ndigits];
-    if (eflag == 0) {
-        p1 += r2;
+    // Without an integer part, skip the leading zeros of the fractional one.
+    if (!ipart) {
+        int digit;
+        while ((digit = __gen_next(gen)) == 0) {
+            --decpt;
+        }
+        gen->pending = digit;
     }
+    return decpt;
+}
+
+void cvt_init(cvt_t *cvt, double value, int ndigits, int fixed)
+{
+    union {
+        double d;
+        uint64_t u;
+    } bits         = { value };
+    uint64_t mant  = bits.u & ((1ULL << 52U) - 1U);
+    unsigned bexp  = (unsigned)(bits.u >> 52U) & 0x7ffU;
+    int exp        = -1074;
+    int last       = 0, nonzero = 0, nonnine = -1, round, i;
+    cvt_gen_t ahead;
 
-    *decpt = r2;
-    if (p1 < &buf[0]) {
-        buf[0] = '\0';
+    cvt->carry = -1;
+    cvt->pos   = 0;
+    if (bexp) {
+        mant |= 1ULL << 52U;
+        exp = (int)bexp - 1075;
+    }
+    if (!mant) {
+        // Zero, which has no digits at all.
+        cvt->gen.pending = -1;
+        cvt->decpt       = 1;
+        cvt->ndigits     = 0;
+        cvt->nonzero     = 0;
         return;
     }
+    cvt->decpt   = __gen_init(&cvt->gen, mant, exp);
+    cvt->ndigits = fixed ? cvt->decpt + ndigits : ndigits;
 
-    while (p <= p1 && p < buf_end) {
-        arg *= 10;
-        arg  = modf(arg, &fj);
-        *p++ = (int)fj + '0';
+    // Read ahead the digits to keep, and the first one to drop.
+    __gen_copy(&ahead, &cvt->gen);
+    for (i = 0; i < cvt->ndigits; ++i) {
+        last = __gen_next(&ahead);
+        if (last != 9) {
+            nonnine = i;
+        }
+        if (last) {
+            nonzero = i + 1;
+        }
     }
-
-    if (p1 >= buf_end) {
-        buf[buf_size - 1] = '\0';
+    cvt->nonzero = nonzero;
+    if (cvt->ndigits < 0) {
+        // The value is less than a tenth of the last digit, it rounds to zero.
+        cvt->ndigits = 0;
+        return;
+    }
+    round = __gen_next(&ahead);
+    if ((round < 5) || ((round == 5) && !__gen_sticky(&ahead) && !(last & 1))) {
         return;
     }
+    if (nonnine >= 0) {
+        // The carry stops at the last digit which is not a nine.
+        cvt->carry   = nonnine;
+        cvt->nonzero = nonnine + 1;
+    } else {
+        // All nines: the result is a power of ten, one digit longer.
+        cvt->carry   = -2;
+        cvt->nonzero = 1;
+        cvt->ndigits += fixed ? 1 : (cvt->ndigits == 0);
+        ++cvt->decpt;
+    }
+}
 
-    p = p1;
-    *p1 += 5;
-    while (*p1 > '9') {
-        *p1 = '0';
-        if (p1 > buf) {
-            ++*--p1;
-        } else {
-            *p1 = '1';
-            (*decpt)++;
-            if (eflag == 0) {
-                if (p > buf) {
-                    *p = '0';
-                }
-                p++;
-            }
-        }
+char cvt_digit(cvt_t *cvt)
+{
+    int i = cvt->pos++;
+    if (i >= cvt->ndigits) {
+        return '0';
+    }
+    if (cvt->carry == -2) {
+        return i ? '0' : '1';
     }
-    *p = '\0';
+    if ((cvt->carry >= 0) && (i > cvt->carry)) {
+        return '0';
+    }
+    return (char)('0' + __gen_next(&cvt->gen) + (i == cvt->carry));
+}
+
+/// @brief Converts a floating-point number into a string of digits.
+/// @param arg The floating-point number to convert.
+/// @param ndigits The number of digits, significant ones or after the decimal point.
+/// @param decpt A pointer to an integer that will store the position of the decimal point.
+/// @param sign A pointer to an integer that will store the sign of the number (1 if negative, 0 otherwise).
+/// @param buf A character buffer where the resulting string will be stored.
+/// @param buf_size The size of the buffer.
+/// @param fixed A flag indicating whether ndigits counts the digits after the decimal point.
+static void cvt(double arg, int ndigits, int *decpt, int *sign, char *buf, unsigned buf_size, int fixed)
+{
+    cvt_t state;
+    unsigned i;
+    int count;
+
+    if (!buf || buf_size == 0) {
+        return;
+    }
+    *sign = (arg < 0) || ((arg == 0) && (1 / arg < 0));
+    if (ndigits < 0) {
+        ndigits = 0;
+    }
+    cvt_init(&state, *sign ? -arg : arg, ndigits, fixed);
+    // Zero has its decimal point before the zeros, which fill the buffer too.
+    *decpt = (arg == 0) ? 0 : state.decpt;
+    count  = fixed ? *decpt + ndigits : ndigits;
+    for (i = 0; ((int)i < count) && (i < buf_size - 1); ++i) {
+        buf[i] = cvt_digit(&state);
+    }
+    buf[i] = '\0';
 }
 
 void ecvtbuf(double arg, int chars, int *decpt, int *sign, char *buf, unsigned buf_size)
 {
-    cvt(arg, chars, decpt, sign, buf, buf_size, 1);
+    cvt(arg, chars, decpt, sign, buf, buf_size, 0);
 }
 
 void fcvtbuf(double arg, int decimals, int *decpt, int *sign, char *buf, unsigned buf_size)
 {
-    cvt(arg, decimals, decpt, sign, buf, buf_size, 0);
+    cvt(arg, decimals, decpt, sign, buf, buf_size, 1);
 }
 
-/// @endcond
+/// @brief A floating point number with a 64-bit significand, f * 2^e.
+typedef struct diyfp {
+    uint64_t f; ///< The significand.
+    int e;      ///< The exponent.
+} diyfp_t;
+
+/// The significands of the powers of ten 10^-348, 10^-340, ..., 10^340.
+static const uint64_t cached_powers_f[] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL, 0xcf42894a5dce35eaULL,
+    0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL, 0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL,
+    0xbe5691ef416bd60cULL, 0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL, 0xc21094364dfb5637ULL,
+    0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL, 0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL,
+    0xb23867fb2a35b28eULL, 0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL, 0xb5b5ada8aaff80b8ULL,
+    0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL, 0x964e858c91ba2655ULL, 0xdff9772470297ebdULL,
+    0xa6dfbd9fb8e5b88fULL, 0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL, 0xaa242499697392d3ULL,
+    0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL, 0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL,
+    0x9c40000000000000ULL, 0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL, 0x9f4f2726179a2245ULL,
+    0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL, 0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL,
+    0x924d692ca61be758ULL, 0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL, 0x952ab45cfa97a0b3ULL,
+    0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL, 0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL,
+    0x88fcf317f22241e2ULL, 0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL, 0x8bab8eefb6409c1aULL,
+    0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL, 0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL,
+    0x80444b5e7aa7cf85ULL, 0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+};
+
+/// The binary exponents of the cached powers of ten.
+static const int16_t cached_powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927, -901, -874, -847, -821, -794, -768,
+    -741, -715, -688, -661, -635, -608, -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289, -263,
+    -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30, 56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667, 694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960,
+    986, 1013, 1039, 1066
+};
+
+/// The powers of ten which fit 32 bits.
+static const uint32_t pow10_32[] = { 1U,      10U,      100U,      1000U,      10000U,
+                                     100000U, 1000000U, 10000000U, 100000000U, 1000000000U };
+
+/// @brief Multiplies two numbers, rounding the product to 64 bits.
+/// @param x the first number.
+/// @param y the second number.
+/// @return the product.
+static inline diyfp_t __diy_mul(diyfp_t x, diyfp_t y)
+{
+    uint32_t a = (uint32_t)(x.f >> 32U), b = (uint32_t)x.f;
+    uint32_t c = (uint32_t)(y.f >> 32U), d = (uint32_t)y.f;
+    uint64_t ac = (uint64_t)a * c, bc = (uint64_t)b * c, ad = (uint64_t)a * d, bd = (uint64_t)b * d;
+    uint64_t mid = (bd >> 32U) + (uint32_t)ad + (uint32_t)bc + (1U << 31U);
+    diyfp_t r    = { ac + (ad >> 32U) + (bc >> 32U) + (mid >> 32U), x.e + y.e + 64 };
+    return r;
+}
+
+/// @brief Shifts a number left until the most significant bit of the
+/// significand is set.
+/// @param x the number.
+/// @return the normalized number.
+static inline diyfp_t __diy_normalize(diyfp_t x)
+{
+    while (!(x.f >> 63U)) {
+        x.f <<= 1U;
+        --x.e;
+    }
+    return x;
+}
+
+/// @brief Removes the last digit while the number gets closer to the value,
+/// and stays in the interval of the numbers which read back as it.
+/// @param buf the digits.
+/// @param len the number of digits.
+/// @param delta the width of the interval.
+/// @param rest the distance of the digits from the upper end of the interval.
+/// @param ten_kappa the weight of the last digit.
+/// @param wp_w the distance of the value from the upper end of the interval.
+static inline void __grisu_round(char *buf, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+{
+    while ((rest < wp_w) && (delta - rest >= ten_kappa) &&
+           ((rest + ten_kappa < wp_w) || (wp_w - rest > rest + ten_kappa - wp_w))) {
+        buf[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+/// @brief Produces the shortest digits of a positive double (Grisu2).
+/// @param value the value.
+/// @param buf where the digits are stored, at least 18 bytes.
+/// @param k where the decimal exponent of the last digit is stored.
+/// @return the number of digits.
+static int __grisu2(double value, char *buf, int *k)
+{
+    union {
+        double d;
+        uint64_t u;
+    } bits = { value };
+    unsigned bexp = (unsigned)(bits.u >> 52U) & 0x7ffU;
+    diyfp_t v     = { bits.u & ((1ULL << 52U) - 1U), -1074 };
+    diyfp_t plus, minus, c, w, wp, wm, one, wp_w;
+    int len = 0, kappa, index;
+
+    if (bexp) {
+        v.f |= 1ULL << 52U;
+        v.e = (int)bexp - 1075;
+    }
+    // The boundaries of the interval of the numbers which read back as v.
+    plus.f = (v.f << 1U) + 1U;
+    plus.e = v.e - 1;
+    plus   = __diy_normalize(plus);
+    if (v.f == (1ULL << 52U)) {
+        minus.f = (v.f << 2U) - 1U;
+        minus.e = v.e - 2;
+    } else {
+        minus.f = (v.f << 1U) - 1U;
+        minus.e = v.e - 1;
+    }
+    minus.f <<= (unsigned)(minus.e - plus.e);
+    minus.e = plus.e;
+
+    // A power of ten 10^-k which brings the upper boundary between 2^-59 and 2^-32.
+    int x  = -61 - plus.e;
+    index  = ((((x * 78913) >> 18) + (x != 0) + 347) >> 3) + 1;
+    *k     = -(-348 + (index << 3));
+    c.f    = cached_powers_f[index];
+    c.e    = cached_powers_e[index];
+
+    w  = __diy_mul(__diy_normalize(v), c);
+    wp = __diy_mul(plus, c);
+    wm = __diy_mul(minus, c);
+    wm.f++;
+    wp.f--;
+
+    uint64_t delta = wp.f - wm.f;
+    one.f          = 1ULL << (unsigned)-wp.e;
+    one.e          = wp.e;
+    wp_w.f         = wp.f - w.f;
+    uint32_t p1    = (uint32_t)(wp.f >> (unsigned)-one.e);
+    uint64_t p2    = wp.f & (one.f - 1U);
+
+    // The digits of the integer part of wp.
+    for (kappa = 1; (kappa < 10) && (p1 >= pow10_32[kappa]); ++kappa) {
+    }
+    while (kappa > 0) {
+        uint32_t digit = p1 / pow10_32[kappa - 1];
+        p1 %= pow10_32[kappa - 1];
+        if (digit || len) {
+            buf[len++] = (char)('0' + digit);
+        }
+        --kappa;
+        uint64_t rest = ((uint64_t)p1 << (unsigned)-one.e) + p2;
+        if (rest <= delta) {
+            *k += kappa;
+            __grisu_round(buf, len, delta, rest, (uint64_t)pow10_32[kappa] << (unsigned)-one.e, wp_w.f);
+            return len;
+        }
+    }
+    // The digits of the fractional part.
+    for (;;) {
+        p2 *= 10U;
+        delta *= 10U;
+        char digit = (char)(p2 >> (unsigned)-one.e);
+        if (digit || len) {
+            buf[len++] = (char)('0' + digit);
+        }
+        p2 &= one.f - 1U;
+        --kappa;
+        if (p2 < delta) {
+            *k += kappa;
+            __grisu_round(buf, len, delta, p2, one.f, (-kappa < 10) ? wp_w.f * pow10_32[-kappa] : 0);
+            return len;
+        }
+    }
+}
+
+int scvtbuf(double arg, int *decpt, int *sign, char *buf, unsigned buf_size)
+{
+    char digits[20];
+    int len, k, i;
+
+    if (!buf || buf_size == 0) {
+        return 0;
+    }
+    *sign = (arg < 0) || ((arg == 0) && (1 / arg < 0));
+    if (arg == 0) {
+        digits[0] = '0';
+        len       = 1;
+        *decpt    = 1;
+    } else {
+        len    = __grisu2(*sign ? -arg : arg, digits, &k);
+        *decpt = len + k;
+    }
+    for (i = 0; (i < len) && ((unsigned)i < buf_size - 1); ++i) {
+        buf[i] = digits[i];
+    }
+    buf[i] = '\0';
+    return i;
+}
@@ -1,125 +1,196 @@
 /// @file grp.c
-/// @brief
+/// @brief Functions to access the group database.
+/// @details The database is read once, and kept in memory together with two
+/// hash indices, by name and by group ID. It is read again only when
+/// `/etc/group` changes.
 /// @copyright (c) 2014-2024 This file is distributed under the MIT License.
 /// See LICENSE.md for details.
 
 #include "grp.h"
 #include "assert.h"
+#include "bits/dbfile.h"
 #include "errno.h"
-#include "fcntl.h"
+#include "hashmap.h"
 #include "stdio.h"
+#include "stdlib.h"
 #include "string.h"
-#include "unistd.h"
 
-/// Holds the file descriptor while we are working with `/etc/group`.
-static int __fd = -1;
+/// The number of buckets of the indices, a divisor of HASHMAP_SIZE.
+#define GRP_BUCKETS 64
+
+/// @brief An entry of the database, linked in the chains of the indices.
+typedef struct grp_record {
+    group_t grp;   ///< The entry, its strings point inside the content of the file.
+    int next_name; ///< The next entry in the same bucket of the index by name, -1 if none.
+    int next_gid;  ///< The next entry in the same bucket of the index by group ID, -1 if none.
+} grp_record_t;
+
+/// @brief The database in memory.
+static struct {
+    dbfile_t file;            ///< The content of the file, with the fields terminated in place.
+    grp_record_t *records;    ///< The entries.
+    int count;                ///< The number of entries.
+    int by_name[GRP_BUCKETS]; ///< The first entry of each bucket of the index by name, -1 if empty.
+    int by_gid[GRP_BUCKETS];  ///< The first entry of each bucket of the index by group ID, -1 if empty.
+} grp_cache = { .file = { .data = NULL }, .records = NULL, .count = 0 };
+
+/// The index of the next entry returned by getgrent.
+static int __next_entry = 0;
 
 /// @brief It parses the line (as string) and saves its content inside the
 /// group_t structure.
 /// @param grp the struct where we store the information.
-/// @param buf the line from which we extract the information.
-static inline void __parse_line(group_t *grp, char *buf)
+/// @param buf the line from which we extract the information, it is modified.
+/// @return 1 if the entry is complete, 0 otherwise.
+static inline int __parse_line(group_t *grp, char *buf)
 {
     assert(grp && "Received null grp!");
-    char *token;
-    // Parse the group name.
-    token = strtok(buf, ":");
-    if (token != NULL) {
-        grp->gr_name = token;
-    }
-    // Parse the group passwd.
-    token = strtok(NULL, ":");
-    if (token != NULL) {
-        grp->gr_passwd = token;
-    }
-    // Parse the group id.
-    token = strtok(NULL, ":");
-    if (token != NULL) {
-        grp->gr_gid = atoi(token);
+    char *fields[3];
+    // Split the line at the colons, the fields can be empty.
+    for (int i = 0; i < 3; ++i) {
+        fields[i] = buf;
+        buf       = strchr(buf, ':');
+        if (buf == NULL) {
+            return 0;
+        }
+        *buf++ = 0;
     }
+    grp->gr_name   = fields[0];
+    grp->gr_passwd = fields[1];
+    grp->gr_gid    = atoi(fields[2]);
+    // Split the members at the commas.
     size_t found_users = 0;
-    while ((token = strtok(NULL, ",\n\0")) != NULL && found_users < MAX_MEMBERS_PER_GROUP) {
-        grp->gr_mem[found_users] = token;
-        found_users += 1;
+    while (*buf && (found_users < MAX_MEMBERS_PER_GROUP)) {
+        grp->gr_mem[found_users++] = buf;
+        buf += strcspn(buf, ",");
+        if (*buf) {
+            *buf++ = 0;
+        }
     }
     // Null terminate array
-    grp->gr_mem[found_users] = "\0";
+    grp->gr_mem[found_users] = NULL;
+    return 1;
 }
 
-/// @brief Searches an entry in `/etc/group`.
-/// @param fd the file descriptor pointing to `/etc/group`.
-/// @param buf the buffer we are going to use to search the entry.
-/// @param buflen the length of the buffer.
-/// @param name the name we are looking for.
-/// @param gid the group id we must match.
+/// @brief Frees the database in memory.
+static inline void __grp_cache_free(void)
+{
+    dbfile_free(&grp_cache.file);
+    free(grp_cache.records);
+    grp_cache.records = NULL;
+    grp_cache.count   = 0;
+}
+
+/// @brief Reads the database, unless the one in memory is up to date.
 /// @return 1 on success, 0 on failure.
-static inline int __search_entry(int fd, char *buf, size_t buflen, const char *name, gid_t gid)
+static int __grp_cache_load(void)
 {
-    int ret;
-    char c;
-    int pos = 0;
-    while ((ret = read(fd, &c, 1U))) {
-        // Skip carriage return.
-        if (c == '\r') {
-            continue;
-        }
-        if (pos >= buflen) {
-            errno = ERANGE;
-            return 0;
+    int lines;
+    int ret = dbfile_load(&grp_cache.file, "/etc/group", &lines);
+    if (ret < 0) {
+        __grp_cache_free();
+        return 0;
+    }
+    if (ret == 0) {
+        return 1;
+    }
+    // The file has changed, the entries are parsed again.
+    free(grp_cache.records);
+    grp_record_t *records = malloc(sizeof(grp_record_t) * lines);
+    grp_cache.records = records;
+    grp_cache.count   = 0;
+    if (!records) {
+        dbfile_free(&grp_cache.file);
+        return 0;
+    }
+    for (int i = 0; i < GRP_BUCKETS; ++i) {
+        grp_cache.by_name[i] = grp_cache.by_gid[i] = -1;
+    }
+    // Parse the lines.
+    char *it = grp_cache.file.data, *line;
+    while ((line = dbfile_next_line(&it))) {
+        grp_record_t *record = &records[grp_cache.count];
+        if (__parse_line(&record->grp, line)) {
+            ++grp_cache.count;
         }
-        // If we have found a newline or the EOF, parse the entry.
-        if ((c == '\n') || (ret == EOF)) {
-            // Close the buffer.
-            buf[pos] = 0;
-            // Check the entry.
-            if (name) {
-                if (strncmp(buf, name, strlen(name)) == 0 && buf[strlen(name)] == ':') {
-                    return 1;
-                }
-            } else {
-                int gid_start = -1;
-                int col_count = 0;
-                for (int i = 0; i < pos; ++i) {
-                    if (buf[i] == ':') {
-                        if (++col_count == 2) {
-                            gid_start = i + 1;
-                            break;
-                        }
-                    }
-                }
-                if ((gid_start != -1) && (gid_start < pos)) {
-                    // Parse the gid.
-                    int found_gid = atoi(&buf[gid_start]);
-                    // Check the gid.
-                    if (found_gid == gid) {
-                        return 1;
-                    }
-                }
+    }
+    // Index the entries. They are inserted at the head of the chains, so we go
+    // backward to find the first entry of the file first.
+    for (int i = grp_cache.count - 1; i >= 0; --i) {
+        unsigned name_bucket           = hash(records[i].grp.gr_name) % GRP_BUCKETS;
+        unsigned gid_bucket            = (unsigned)records[i].grp.gr_gid % GRP_BUCKETS;
+        records[i].next_name           = grp_cache.by_name[name_bucket];
+        records[i].next_gid            = grp_cache.by_gid[gid_bucket];
+        grp_cache.by_name[name_bucket] = i;
+        grp_cache.by_gid[gid_bucket]   = i;
+    }
+    return 1;
+}
+
+/// @brief Searches for the given entry inside the database.
+/// @param name the name we are looking for, or NULL to search by gid.
+/// @param gid the group id we must match.
+/// @return the entry, NULL if it is not there.
+static inline group_t *__search_entry(const char *name, gid_t gid)
+{
+    if (!__grp_cache_load()) {
+        return NULL;
+    }
+    if (name != NULL) {
+        for (int i = grp_cache.by_name[hash(name) % GRP_BUCKETS]; i != -1; i = grp_cache.records[i].next_name) {
+            if (strcmp(grp_cache.records[i].grp.gr_name, name) == 0) {
+                return &grp_cache.records[i].grp;
             }
-            // Reset the index.
-            pos = 0;
-            // If we have reached the EOF stop.
-            if (ret == EOF) {
-                break;
+        }
+    } else {
+        for (int i = grp_cache.by_gid[(unsigned)gid % GRP_BUCKETS]; i != -1; i = grp_cache.records[i].next_gid) {
+            if (grp_cache.records[i].grp.gr_gid == gid) {
+                return &grp_cache.records[i].grp;
             }
-        } else {
-            buf[pos++] = c;
         }
     }
-    errno = ENOENT;
+    return NULL;
+}
+
+/// @brief Copies the entry of the database inside the structure of the caller.
+/// @param entry the entry, NULL if not found.
+/// @param group the structure of the caller.
+/// @param buf the buffer where the strings are stored.
+/// @param buflen the length of the buffer.
+/// @param result where we place group, or NULL.
+/// @return 0 on success or if not found, ERANGE if the buffer is too small.
+static inline int __copy_entry(group_t *entry, group_t *group, char *buf, size_t buflen, group_t **result)
+{
+    *result = NULL;
+    if (entry == NULL) {
+        return 0;
+    }
+    group->gr_gid = entry->gr_gid;
+    if (!dbfile_copy_field(&group->gr_name, entry->gr_name, &buf, &buflen) ||
+        !dbfile_copy_field(&group->gr_passwd, entry->gr_passwd, &buf, &buflen)) {
+        return ERANGE;
+    }
+    size_t i;
+    for (i = 0; entry->gr_mem[i] != NULL; ++i) {
+        if (!dbfile_copy_field(&group->gr_mem[i], entry->gr_mem[i], &buf, &buflen)) {
+            return ERANGE;
+        }
+    }
+    group->gr_mem[i] = NULL;
+    *result          = group;
     return 0;
 }
 
 group_t *getgrgid(gid_t gid)
 {
     static group_t grp;
-    static char buffer[BUFSIZ];
-
-    group_t *result;
-    if (!getgrgid_r(gid, &grp, buffer, BUFSIZ, &result)) {
+    group_t *entry = __search_entry(NULL, gid);
+    if (entry == NULL) {
+        errno = ENOENT;
         return NULL;
     }
-
+    // The caller gets its own copy of the pointers, the strings stay in the cache.
+    grp = *entry;
     return &grp;
 }
 
@@ -128,130 +199,48 @@ group_t *getgrnam(const char *name)
     if (name == NULL) {
         return NULL;
     }
-
     static group_t grp;
-    static char buffer[BUFSIZ];
-
-    group_t *result;
-    if (!getgrnam_r(name, &grp, buffer, BUFSIZ, &result)) {
+    group_t *entry = __search_entry(name, 0);
+    if (entry == NULL) {
+        errno = ENOENT;
         return NULL;
     }
-
+    // The caller gets its own copy of the pointers, the strings stay in the cache.
+    grp = *entry;
     return &grp;
 }
 
 int getgrgid_r(gid_t gid, group_t *group, char *buf, size_t buflen, group_t **result)
 {
-    int fd = open("/etc/group", O_RDONLY, 0);
-    if (fd == -1) {
-        errno   = ENOENT;
-        *result = NULL;
-        return 0;
-    }
-
-    if (__search_entry(fd, buf, buflen, NULL, gid)) {
-        // Close the file.
-        close(fd);
-        // Parse the line.
-        __parse_line(group, buf);
-        // Return success.
-        return 1;
-    }
-
-    // Close the file.
-    close(fd);
-    // Return fail.
-    return 0;
+    return __copy_entry(__search_entry(NULL, gid), group, buf, buflen, result);
 }
 
 int getgrnam_r(const char *name, group_t *group, char *buf, size_t buflen, group_t **result)
 {
-    int fd = open("/etc/group", O_RDONLY, 0);
-    if (fd == -1) {
-        errno   = ENOENT;
+    if (name == NULL) {
         *result = NULL;
-        return 0;
-    }
-
-    if (__search_entry(fd, buf, buflen, name, 0)) {
-        // Close the file.
-        close(fd);
-        // Parse the line.
-        __parse_line(group, buf);
-        // Return success.
-        return 1;
+        return EINVAL;
     }
-
-    // Close the file.
-    close(fd);
-    // Return fail.
-    return 0;
+    return __copy_entry(__search_entry(name, 0), group, buf, buflen, result);
 }
 
 group_t *getgrent(void)
 {
-    static group_t result;
-
-    if (__fd == -1) {
-        //pr_debug("Opening group file\n");
-        __fd = open("/etc/group", O_RDONLY, 0);
-        if (__fd == -1) {
-            errno = ENOENT;
-            return 0;
-        }
-    }
-
-    int ret;
-    char c;
-    int pos = 0;
-
-    static char buffer[BUFSIZ];
-    while ((ret = read(__fd, &c, 1U))) {
-        // Skip carriage return.
-        if (c == '\r') {
-            continue;
-        }
-
-        if (pos >= BUFSIZ) {
-            errno = ERANGE;
-            return NULL;
-        }
-
-        // If we have found a newline or the EOF, parse the entry.
-        if ((c == '\n') || (ret == EOF)) {
-            // Close the buffer.
-            buffer[pos] = 0;
-
-            // Check the entry.
-            if (strlen(buffer) != 0) {
-                //pr_debug("Found entry in group file: %s\n", buffer);
-                __parse_line(&result, buffer);
-                return &result;
-            }
-
-            // If we have reached the EOF stop.
-            if (ret == EOF) {
-                break;
-            }
-
-        } else {
-            buffer[pos++] = c;
-        }
+    static group_t grp;
+    if (!__grp_cache_load() || (__next_entry >= grp_cache.count)) {
+        errno = ENOENT;
+        return NULL;
     }
-
-    errno = ENOENT;
-    return NULL;
+    grp = grp_cache.records[__next_entry++].grp;
+    return &grp;
 }
 
 void endgrent(void)
 {
-    //pr_debug("Closing group file\n");
-    close(__fd);
-    __fd = -1;
+    __next_entry = 0;
 }
 
 void setgrent(void)
 {
-    //pr_debug("Resetting pointer to beginning of group file\n");
-    lseek(__fd, 0, SEEK_SET);
+    __next_entry = 0;
 }
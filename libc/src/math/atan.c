@@ -0,0 +1,208 @@
+/// @file atan.c
+/// @brief Arc tangent functions.
+/// @details The argument is reduced around one of the breakpoints 0.5, 1, 1.5
+/// and infinity, whose arc tangent is in the table, and the arc tangent of
+/// the remaining part is computed with the minimax polynomial of fdlibm. The
+/// error is below 1 ulp.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "math.h"
+#include "libm.h"
+
+/// The value of pi, rounded to double.
+#define PI_HI 3.141592653589793
+/// The rounding error of PI_HI.
+#define PI_LO 1.2246467991473532e-16
+
+/// The arc tangent of the breakpoints, rounded to double.
+static const double atan_hi[] = {
+    0.4636476090008061,
+    0.7853981633974483,
+    0.982793723247329,
+    1.5707963267948966,
+};
+
+/// The rounding errors of atan_hi.
+static const double atan_lo[] = {
+    2.2698777452961687e-17,
+    3.061616997868383e-17,
+    1.3903311031230998e-17,
+    6.123233995736766e-17,
+};
+
+/// @brief Computes the arc tangent, with a correction of the argument.
+/// @param x the argument.
+/// @param tail the correction of the argument, much smaller than it.
+/// @param lo where the correction of the result is stored.
+/// @return the result, such that the arc tangent is close to it plus lo.
+static double __atan(double x, double tail, double *lo)
+{
+    const double at[] = {
+        3.33333333333329318027e-01,  -1.99999999998764832476e-01, 1.42857142725034663711e-01,
+        -1.11111104054623557880e-01, 9.09088713343650656196e-02,  -7.69187620504482999495e-02,
+        6.66107313738753120669e-02,  -5.83357013379057348645e-02, 4.97687799461593236017e-02,
+        -3.65315727442169155270e-02, 1.62858201153657823623e-02,
+    };
+    uint64_t ax = __asuint64(x) & 0x7fffffffffffffffULL;
+    int negative = (int)(__asuint64(x) >> 63U);
+    int id;
+    double dx;
+    *lo = 0.0;
+    // |x| >= 2^66, the result rounds to pi/2.
+    if (ax >= 0x4410000000000000ULL) {
+        if (ax > 0x7ff0000000000000ULL) {
+            return x + x;
+        }
+        *lo = negative ? -atan_lo[3] : atan_lo[3];
+        return negative ? -atan_hi[3] : atan_hi[3];
+    }
+    if (ax < 0x3fdc000000000000ULL) {
+        // |x| < 7/16, no reduction. For |x| < 2^-27, the result rounds to x.
+        if (ax < 0x3e40000000000000ULL) {
+            *lo = tail;
+            return x;
+        }
+        id = -1;
+    } else {
+        x    = fabs(x);
+        tail = negative ? -tail : tail;
+        // The tail is multiplied by the derivative of each reduction.
+        if (ax < 0x3ff3000000000000ULL) {
+            if (ax < 0x3fe6000000000000ULL) {
+                // 7/16 <= |x| < 11/16, reduce around 0.5.
+                id   = 0;
+                dx   = 2.0 + x;
+                tail = tail * 5.0 / (dx * dx);
+                x    = (2.0 * x - 1.0) / dx;
+            } else {
+                // 11/16 <= |x| < 19/16, reduce around 1.
+                id   = 1;
+                dx   = x + 1.0;
+                tail = tail * 2.0 / (dx * dx);
+                x    = (x - 1.0) / dx;
+            }
+        } else {
+            if (ax < 0x4003800000000000ULL) {
+                // 19/16 <= |x| < 39/16, reduce around 1.5.
+                id   = 2;
+                dx   = 1.0 + 1.5 * x;
+                tail = tail * 3.25 / (dx * dx);
+                x    = (x - 1.5) / dx;
+            } else {
+                // 39/16 <= |x| < 2^66, reduce around infinity.
+                id   = 3;
+                tail = tail / (x * x);
+                x    = -1.0 / x;
+            }
+        }
+    }
+    double z = x * x;
+    double w = z * z;
+    if (tail != 0.0) {
+        tail /= 1.0 + z;
+    }
+    // The odd and even terms are evaluated separately.
+    double s1 = z * (at[0] + w * (at[2] + w * (at[4] + w * (at[6] + w * (at[8] + w * at[10])))));
+    double s2 = w * (at[1] + w * (at[3] + w * (at[5] + w * (at[7] + w * at[9]))));
+    if (id < 0) {
+        return x - (x * (s1 + s2) - tail);
+    }
+    // The result is atan_hi - (c - x), both differences are rounded and
+    // their rounding errors kept in lo, for the callers which add a multiple
+    // of pi to it.
+    double c = x * (s1 + s2) - atan_lo[id] - tail;
+    double d = __narrow(c - x);
+    double e = c - (d + x);
+    z        = __narrow(atan_hi[id] - d);
+    *lo      = ((atan_hi[id] - z) - d) - e;
+    if (negative) {
+        *lo = -*lo;
+        return -z;
+    }
+    return z;
+}
+
+double atan(double x)
+{
+    double lo, hi = __atan(x, 0.0, &lo);
+    return hi + lo;
+}
+
+double atan2(double y, double x)
+{
+    uint64_t ix = __asuint64(x), iy = __asuint64(y);
+    uint64_t ax = ix & 0x7fffffffffffffffULL, ay = iy & 0x7fffffffffffffffULL;
+    if ((ax > 0x7ff0000000000000ULL) || (ay > 0x7ff0000000000000ULL)) {
+        return x + y;
+    }
+    if (ix == 0x3ff0000000000000ULL) {
+        return atan(y);
+    }
+    // The quadrant, 2 * sign(x) + sign(y).
+    int m = (int)(((iy >> 63U) & 1U) | ((ix >> 62U) & 2U));
+    if (ay == 0) {
+        switch (m) {
+        case 0:
+        case 1:
+            return y;
+        case 2:
+            return PI_HI + PI_LO;
+        default:
+            return -PI_HI - PI_LO;
+        }
+    }
+    if (ax == 0) {
+        return (m & 1) ? -atan_hi[3] - atan_lo[3] : atan_hi[3] + atan_lo[3];
+    }
+    if (ax == 0x7ff0000000000000ULL) {
+        if (ay == 0x7ff0000000000000ULL) {
+            switch (m) {
+            case 0:
+                return atan_hi[1] + atan_lo[1];
+            case 1:
+                return -atan_hi[1] - atan_lo[1];
+            case 2:
+                return 3.0 * atan_hi[1] + 3.0 * atan_lo[1];
+            default:
+                return -3.0 * atan_hi[1] - 3.0 * atan_lo[1];
+            }
+        }
+        switch (m) {
+        case 0:
+            return 0.0;
+        case 1:
+            return -0.0;
+        case 2:
+            return PI_HI + PI_LO;
+        default:
+            return -PI_HI - PI_LO;
+        }
+    }
+    // |y/x| > 2^64, or y is infinite.
+    if ((ax + (64ULL << 52U) < ay) || (ay == 0x7ff0000000000000ULL)) {
+        return (m & 1) ? -atan_hi[3] - atan_lo[3] : atan_hi[3] + atan_lo[3];
+    }
+    double z, lo = 0.0;
+    if ((m & 2) && (ay + (64ULL << 52U) < ax)) {
+        // |y/x| < 2^-64 and x < 0.
+        z = 0.0;
+    } else {
+        // The quotient, and its rounding error, computed with the product of
+        // the first 26 bits of the quotient with x, which is exact.
+        double ay_d = fabs(y), ax_d = fabs(x);
+        double q    = __narrow(ay_d / ax_d);
+        double qh   = __asdouble(__asuint64(q) & (~0ULL << 27U));
+        double xh   = __asdouble(__asuint64(ax_d) & (~0ULL << 27U));
+        double err  = ((ay_d - qh * xh) - qh * (ax_d - xh)) - (q - qh) * ax_d;
+        z           = __atan(q, err / ax_d, &lo);
+    }
+    if (m & 2) {
+        // pi - z, with z in [0, pi/2], keeping the rounding error.
+        double d = __narrow(PI_HI - z);
+        lo       = (((PI_HI - d) - z) + PI_LO) - lo;
+        z        = d;
+    }
+    z = z + lo;
+    return (m & 1) ? -z : z;
+}
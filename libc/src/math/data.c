@@ -0,0 +1,281 @@
+/// @file data.c
+/// @brief Tables of the math functions.
+/// @details The values were computed with 60 significant digits, and rounded
+/// to the nearest double.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "libm.h"
+
+const exp_entry_t __exp_table[LIBM_TABLE_SIZE] = {
+    {1.0, 0.0},
+    {1.0054299011128027, 9.499186535455032e-17},
+    {1.0108892860517005, -1.5234778603368577e-17},
+    {1.016378314910953, -5.77217007319966e-17},
+    {1.0218971486541166, 5.109225028973444e-17},
+    {1.0274459491187637, -4.9560741746453704e-17},
+    {1.0330248790212284, 7.600838874027088e-18},
+    {1.0386341019613787, 5.996273788852511e-17},
+    {1.0442737824274138, 8.551889705537965e-17},
+    {1.0499440858006872, 5.592937848127003e-17},
+    {1.0556451783605572, 1.759325738772092e-18},
+    {1.061377227289262, -1.1973537085365658e-17},
+    {1.0671404006768237, -7.899853966841582e-17},
+    {1.0729348675259756, -3.839668843358824e-18},
+    {1.0787607977571199, -6.656660436056593e-17},
+    {1.0846183622133092, 3.166152845816346e-17},
+    {1.0905077326652577, -3.046782079812471e-17},
+    {1.0964290818163769, -5.919933484449316e-17},
+    {1.102382583307841, 5.2660368715706944e-17},
+    {1.1083684117236787, -8.786813845180527e-17},
+    {1.1143867425958924, 1.0410278456845571e-16},
+    {1.1204377524096067, -6.201085906554179e-17},
+    {1.1265216186082418, 5.165856758795457e-17},
+    {1.1326385195987192, 3.237356166738e-17},
+    {1.1387886347566916, 8.912812676025408e-17},
+    {1.1449721444318042, 4.6412898921700107e-17},
+    {1.1511892299529827, 3.250710218863827e-17},
+    {1.1574400736337511, -9.1238712311344e-17},
+    {1.1637248587775775, 3.8292048369240935e-17},
+    {1.1700437696832502, -1.8477442017900047e-18},
+    {1.1763969916502812, 5.554203254218079e-17},
+    {1.182784710984341, 1.542975430079076e-17},
+    {1.189207115002721, 3.982015231465646e-17},
+    {1.1956643920398273, 4.6166036704814814e-17},
+    {1.202156731452703, 6.644981499252301e-17},
+    {1.2086843236265816, -4.746725945228984e-17},
+    {1.215247359980469, -7.712630692681488e-17},
+    {1.2218460329727576, -1.0611021211402691e-16},
+    {1.22848053610687, -1.89878163130253e-17},
+    {1.2351510639369334, -1.0755244344307841e-16},
+    {1.241857812073484, 4.658027591836937e-17},
+    {1.2486009771892048, -8.261810999021964e-17},
+    {1.255380757024691, -6.7113898212968784e-18},
+    {1.2621973503942507, -3.0844648874738465e-17},
+    {1.2690509571917332, 2.667932131342186e-18},
+    {1.275941778396392, 9.91543024421429e-17},
+    {1.2828700160787783, 1.713594918243561e-17},
+    {1.2898358734066657, 8.949257530897592e-17},
+    {1.2968395546510096, 2.5382502794888315e-17},
+    {1.3038812651919358, 8.647675598267871e-17},
+    {1.3109612115247644, -7.181536135519454e-17},
+    {1.318079601266064, -5.4579558271491535e-17},
+    {1.3252366431597413, -2.8587312100388614e-17},
+    {1.3324325470831615, -5.101586630916744e-17},
+    {1.339667524053303, 8.927282594831732e-17},
+    {1.3469417862329458, 3.224065101254679e-17},
+    {1.3542555469368927, 7.70094837980299e-17},
+    {1.3616090206382248, 1.533787661270668e-18},
+    {1.3690024229745905, 9.593797919118849e-17},
+    {1.3764359707545302, -6.898588935871801e-17},
+    {1.383909881963832, -6.770511658794786e-17},
+    {1.3914243757719262, -4.9061748652889893e-17},
+    {1.3989796725383112, -9.614213209051323e-17},
+    {1.4065759938190154, 7.034914812136422e-18},
+    {1.4142135623730951, -9.667293313452913e-17},
+    {1.4218926021691656, -1.6077828915890244e-17},
+    {1.42961333839197, -1.2031642489053655e-17},
+    {1.4373759974489824, -4.2040340164675566e-17},
+    {1.4451808069770467, -3.0237581349939873e-17},
+    {1.4530279958490526, -5.779948609396106e-17},
+    {1.460917794180647, -5.600377186075216e-17},
+    {1.4688504333369818, 8.465882756533628e-17},
+    {1.4768261459394993, -3.483994556892796e-17},
+    {1.4848451658727524, 1.0780086764407481e-16},
+    {1.4929077282912648, 1.4192920154284036e-17},
+    {1.5010140696264256, -6.413767275790235e-17},
+    {1.5091644275934228, -1.016455327754295e-16},
+    {1.5173590411982147, -4.308699472043341e-17},
+    {1.5255981507445384, -1.1024941712342561e-16},
+    {1.533881997840956, 8.875226844438446e-17},
+    {1.5422108254079407, 7.949834809697621e-17},
+    {1.550584877685, -1.4600706590689385e-17},
+    {1.559004400237837, 3.7812070533575275e-17},
+    {1.567469639965553, -1.0352061768849722e-16},
+    {1.5759808451078865, -1.0136916471278304e-17},
+    {1.5845382652524937, -1.9337717034585703e-17},
+    {1.593142151342267, -1.0094406542311964e-16},
+    {1.6017927556826934, -6.054917453527784e-17},
+    {1.6104903319492543, 2.4707192569797888e-17},
+    {1.6192351351948637, 2.0941334154229092e-17},
+    {1.6280274218573478, -6.712955084707084e-17},
+    {1.6368674497669644, 7.698325071319876e-17},
+    {1.645755478153965, -1.0125679913674773e-16},
+    {1.6546917676561943, 9.643294303196029e-17},
+    {1.6636765803267364, 5.8909926967131e-17},
+    {1.6727101796415966, -5.476715964599563e-17},
+    {1.681792830507429, 8.199010020581497e-17},
+    {1.6909247992693053, -9.66967147439488e-17},
+    {1.7001063537185235, -8.0237193703977e-18},
+    {1.709337763100463, -9.868779456632931e-17},
+    {1.718619298122478, -1.851380418263111e-17},
+    {1.7279512309618377, -1.0750981861204642e-16},
+    {1.7373338352737062, 3.164389299292957e-17},
+    {1.746767386199169, -1.0752290483507515e-16},
+    {1.7562521603732995, 2.960140695448873e-17},
+    {1.7657884359332727, 9.461315018083268e-17},
+    {1.7753764925265212, 6.429731796556572e-17},
+    {1.785016611318935, 1.5330400121031314e-17},
+    {1.7947090750031072, 1.8227458427912087e-17},
+    {1.804454167806624, -5.177222408793318e-17},
+    {1.8142521755003989, -9.969531538920349e-17},
+    {1.8241033854070534, -1.0159627862277083e-16},
+    {1.8340080864093424, 3.283107224245627e-17},
+    {1.843966568958626, -5.939742026949965e-17},
+    {1.8539791250833855, 9.761887490727594e-17},
+    {1.864046048397789, 6.540912680620572e-17},
+    {1.8741676341103, -6.122763413004143e-17},
+    {1.8843441790323345, -8.226593125533711e-17},
+    {1.8945759815869656, 3.4034035352165297e-17},
+    {1.9048633418176741, 6.533857514718279e-17},
+    {1.9152065613971474, -1.0619946056195963e-16},
+    {1.925605943636125, -9.914963769693741e-17},
+    {1.9360617934922943, 1.0332385960676326e-16},
+    {1.9465744175792332, 6.811022349533877e-17},
+    {1.9571441241754002, 8.960767791036668e-17},
+    {1.9677712232331759, -1.0314928011531132e-16},
+    {1.978456026387951, 4.0388753109278167e-17},
+    {1.9891988469672663, 8.2051326383692e-18},
+};
+
+const log_entry_t __log_table[LIBM_TABLE_SIZE] = {
+    {1.450425148010254, -0.3718567189805526, 9.589053713753122e-14},
+    {1.4422531127929688, -0.3662065524420086, 1.9388228693397938e-14},
+    {1.434173583984375, -0.36058878365520286, -1.929601194037509e-14},
+    {1.4261837005615234, -0.3550021359683342, -5.1607726314752604e-14},
+    {1.4182825088500977, -0.34944663876694904, -2.0003409872814017e-16},
+    {1.4104681015014648, -0.3439216361750823, -1.5356007663647093e-14},
+    {1.4027395248413086, -0.33842712803334507, 1.556533267722078e-14},
+    {1.3950958251953125, -0.3329631048104602, 3.016568089681138e-14},
+    {1.3875341415405273, -0.3275281728513164, -9.615264583359945e-14},
+    {1.3800535202026367, -0.32212228117259656, -1.8999730534828956e-14},
+    {1.3726539611816406, -0.3167460638346711, 2.0194517120355e-14},
+    {1.3653335571289062, -0.31139876298175295, -1.037158567028229e-13},
+    {1.3580904006958008, -0.30607959591634426, 2.208755735703714e-14},
+    {1.3509235382080078, -0.30078846093533684, 6.296283662027788e-14},
+    {1.343832015991211, -0.29552524618748066, -3.58535920263116e-14},
+    {1.3368148803710938, -0.2902898295740215, 8.294421306967891e-14},
+    {1.3298702239990234, -0.28508136153232044, 8.371625233073525e-14},
+    {1.3229970932006836, -0.27989968800306997, -1.1169109709305853e-13},
+    {1.3161954879760742, -0.2747453689653412, -3.848807226735942e-14},
+    {1.309462547302246, -0.26961678379461773, -6.719491348902007e-14},
+    {1.3027992248535156, -0.2645151994347543, 1.0197209452633791e-14},
+    {1.2962026596069336, -0.2594389588584818, -9.216942999735305e-14},
+    {1.2896728515625, -0.25438858277084364, -2.441062809584794e-14},
+    {1.283207893371582, -0.249363109429396, -5.055571996639986e-14},
+    {1.2768077850341797, -0.2443630449961347, 1.1000629480287669e-13},
+    {1.2704715728759766, -0.23938814877442383, -7.417105083025475e-14},
+    {1.2641973495483398, -0.23443741450932976, 4.7887060931399214e-14},
+    {1.2579851150512695, -0.22951132597563628, 8.404390711874789e-14},
+    {1.2518339157104492, -0.22460960869511837, 3.589436009657052e-14},
+    {1.245741844177246, -0.21973121124028694, 6.458936557525694e-14},
+    {1.2397098541259766, -0.21487736362928445, 2.7816600893393803e-14},
+    {1.2337350845336914, -0.21004622215536983, -7.717034969594865e-14},
+    {1.2278175354003906, -0.2052382318772743, -6.362227101421963e-14},
+    {1.2219572067260742, -0.20045384109039333, -6.337781111189509e-14},
+    {1.2161521911621094, -0.1956919329181801, 3.241142970669169e-14},
+    {1.2104015350341797, -0.19095215169522817, -2.4763779616834157e-14},
+    {1.2047061920166016, -0.1862357131601584, 6.98983753895704e-14},
+    {1.1990633010864258, -0.1815406695529873, 1.0612046449908488e-13},
+    {1.1934728622436523, -0.17686742857722493, -1.0013750725421118e-13},
+    {1.1879348754882812, -0.17221640082539125, 9.098748241809664e-14},
+    {1.182448387145996, -0.16758719319750526, -4.7552663357598105e-14},
+    {1.177011489868164, -0.16297859022552075, -1.2638694090510277e-14},
+    {1.1716251373291016, -0.15839179129693548, -7.581650354820295e-14},
+    {1.1662874221801758, -0.15382556027884675, -7.19281032460372e-14},
+    {1.1609973907470703, -0.14927945529461795, -6.696112482334793e-14},
+    {1.1557559967041016, -0.1447546724550648, -6.606944656492769e-14},
+    {1.1505613327026367, -0.1402499386792897, 1.0119618128699506e-13},
+    {1.1454133987426758, -0.13576561878130633, 3.00830919868233e-14},
+    {1.1403121948242188, -0.13130208002394284, 4.061618307826157e-14},
+    {1.1352548599243164, -0.1268571719153897, -7.917955212951185e-14},
+    {1.1302433013916016, -0.1224329205142567, 6.78053742913799e-14},
+    {1.125274658203125, -0.11802714648388246, -2.835592268912139e-14},
+    {1.1203498840332031, -0.11364103297955808, -4.8658324582724864e-14},
+    {1.1154680252075195, -0.10927407038957426, 2.3610994627098057e-14},
+    {1.1106290817260742, -0.10492659508145152, 7.62975857688335e-14},
+    {1.1058311462402344, -0.1005972207758532, -7.114096186981328e-14},
+    {1.1010751724243164, -0.09628713190772942, -9.620953566410161e-14},
+    {1.096360206604004, -0.09199579019104931, 7.934910256992183e-14},
+    {1.091684341430664, -0.0877217709114575, -9.038740325899626e-14},
+    {1.0870485305786133, -0.08346625348895031, 2.60270117863891e-14},
+    {1.0824527740478516, -0.07922955319713765, -6.240532747057536e-14},
+    {1.077895164489746, -0.07501021774828587, 8.120876605857105e-14},
+    {1.0733757019042969, -0.07080854393302616, 1.071986424625518e-14},
+    {1.0688934326171875, -0.06662393822170998, 8.858762040862339e-14},
+    {1.0644493103027344, -0.062457585901711354, -7.08148671350793e-15},
+    {1.0600414276123047, -0.05830799001341802, 3.160439558361067e-14},
+    {1.0556697845458984, -0.054175432353531505, 6.661868354315913e-14},
+    {1.0513343811035156, -0.05006019648317306, 1.0619535215205215e-13},
+    {1.0470352172851562, -0.045962567698325074, 1.0806301393231483e-13},
+    {1.042769432067871, -0.04188008932555931, -5.701438174324373e-14},
+    {1.0385398864746094, -0.03781577137169734, -3.468739906841412e-14},
+    {1.0343437194824219, -0.03376713814236609, 1.0452112665732012e-13},
+    {1.0301809310913086, -0.029734448068666097, 5.55081514935327e-14},
+    {1.026052474975586, -0.02571889064097377, -1.0901392523283114e-13},
+    {1.021956443786621, -0.02171887226927538, 5.0149191336637645e-14},
+    {1.017892837524414, -0.017734644929532806, -2.294614264520384e-14},
+    {1.0138616561889648, -0.013766462122475787, 1.069606573361343e-13},
+    {1.009861946105957, -0.009813634486818046, -2.2535024725997268e-14},
+    {1.0058937072753906, -0.005876407323285093, -3.597861346610736e-15},
+    {1.0, 0.0, 0.0},
+    {1.0, 0.0, 0.0},
+    {0.9884171485900879, 0.01165045516995633, -9.590962914618266e-14},
+    {0.9808430671691895, 0.01934280451837367, -6.788516271418987e-14},
+    {0.973383903503418, 0.026976718083460582, -8.956035939728348e-14},
+    {0.9660377502441406, 0.03455236660556693, -6.828037512192816e-14},
+    {0.95880126953125, 0.04207145233931442, -1.9841426057597413e-14},
+    {0.9516730308532715, 0.049533758171037334, -3.4224431584175856e-14},
+    {0.9446492195129395, 0.056941616681342566, 4.897693742351334e-14},
+    {0.9377288818359375, 0.06429441031013994, -9.612882820991584e-14},
+    {0.9309091567993164, 0.07159358240642177, 7.387802283454163e-14},
+    {0.9241876602172852, 0.07884013248826705, 2.7155129879277297e-14},
+    {0.9175629615783691, 0.08603407843406785, 9.30758163704701e-14},
+    {0.9110321998596191, 0.09317703672695643, 8.448299713068065e-14},
+    {0.9045934677124023, 0.10026964315352416, -2.573831084075563e-14},
+    {0.8982458114624023, 0.10731151599702571, -4.1112501887090874e-14},
+    {0.8919858932495117, 0.11430496126990874, -2.6841468192358648e-14},
+    {0.8858132362365723, 0.12124914491278105, -9.939957485940957e-14},
+    {0.8797249794006348, 0.12814594376391142, -3.935110676188174e-14},
+    {0.8737201690673828, 0.13499512728458285, 1.9690047414736562e-14},
+    {0.8677964210510254, 0.1417981297897768, -1.3237961954263418e-14},
+    {0.8619527816772461, 0.14855478745539585, 3.087654061131399e-15},
+    {0.8561873435974121, 0.15526606744379023, 4.568162208033233e-14},
+    {0.8504981994628906, 0.16193298418215818, -5.836020012702234e-14},
+    {0.8448843955993652, 0.16855547092586676, 9.752970616456001e-15},
+    {0.8393440246582031, 0.1751346152500446, -9.267945088276905e-14},
+    {0.8338761329650879, 0.18167040927846756, -5.37389463614711e-14},
+    {0.8284788131713867, 0.18816401495746504, -4.0770497641289117e-14},
+    {0.8231511116027832, 0.19461548446338384, 9.430589406030698e-14},
+    {0.8178915977478027, 0.2010254722517857, 5.603783374346906e-15},
+    {0.8126983642578125, 0.2073952539506081, 1.0904503268288366e-13},
+    {0.8075709342956543, 0.21372438341450106, -7.21368993685719e-14},
+    {0.8025078773498535, 0.22001360801391456, -5.023205896982645e-14},
+    {0.7975077629089355, 0.22626371031537929, 4.2142602398012736e-14},
+    {0.792569637298584, 0.23247490668268256, 8.913538576911124e-14},
+    {0.7876920700073242, 0.23864803959872916, 5.555582966521304e-15},
+    {0.782874584197998, 0.24478276925856335, -3.308214233861747e-14},
+    {0.7781152725219727, 0.2508806005837414, 4.490301169715567e-14},
+    {0.773414134979248, 0.25694062356114955, -5.152019320275225e-14},
+    {0.7687687873840332, 0.26296502128639077, 1.0393953286167411e-13},
+    {0.7641792297363281, 0.2689529234328347, -9.046261071003516e-14},
+    {0.7596440315246582, 0.27490533499849334, 6.019822322786829e-14},
+    {0.755162239074707, 0.2808226666261362, 4.189303027255815e-14},
+    {0.7507333755493164, 0.28670471615441784, -8.87590815306044e-14},
+    {0.7463555335998535, 0.2925532057147393, -1.9989726452427494e-14},
+    {0.7420291900634766, 0.2983666968802936, 5.959006977657432e-14},
+    {0.7377519607543945, 0.30414760741359714, -7.166091447925363e-14},
+    {0.7335243225097656, 0.30989452242624793, 1.0133717057233328e-13},
+    {0.7293448448181152, 0.31560862066157824, -1.000593704557723e-13},
+};
+
+const uint32_t __two_over_pi[40] = {
+    0xa2f9836e, 0x4e441529, 0xfc2757d1, 0xf534ddc0, 0xdb629599,
+    0x3c439041, 0xfe5163ab, 0xdebbc561, 0xb7246e3a, 0x424dd2e0,
+    0x06492eea, 0x09d1921c, 0xfe1deb1c, 0xb129a73e, 0xe88235f5,
+    0x2ebb4484, 0xe99c7026, 0xb45f7e41, 0x3991d639, 0x835339f4,
+    0x9c845f8b, 0xbdf9283b, 0x1ff897ff, 0xde05980f, 0xef2f118b,
+    0x5a0a6d1f, 0x6d367ecf, 0x27cb09b7, 0x4f463f66, 0x9e5fea2d,
+    0x7527bac7, 0xebe5f17b, 0x3d0739f7, 0x8a5292ea, 0x6bfb5fb1,
+    0x1f8d5d08, 0x56033046, 0xfc7b6bab, 0xf0cfbc20, 0x9af4361d,
+};
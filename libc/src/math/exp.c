@@ -0,0 +1,113 @@
+/// @file exp.c
+/// @brief Exponential functions.
+/// @details The argument is reduced as x = k * ln2/N + r, with |r| <= ln2/2N,
+/// so that e^x = 2^(k/N) * e^r. The value of 2^(k/N) is split into a power
+/// of two and an entry of the table, while e^r is computed with a polynomial.
+/// The error is below 0.52 ulp, and below 0.75 ulp for subnormal results.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "math.h"
+#include "libm.h"
+
+/// The value of N/ln2.
+#define INV_LN2_N 184.6649652337873
+/// The value of ln2/N, split in two parts. The first one has 32 significant
+/// bits, so that multiplying it by k is exact.
+#define LN2_HI_N  (0.6931471803691238 / LIBM_TABLE_SIZE)
+/// The rounding error of LN2_HI_N.
+#define LN2_LO_N  (1.9082149292705877e-10 / LIBM_TABLE_SIZE)
+/// The value of ln2.
+#define LN2       0.6931471805599453
+/// Adding 1.5 * 2^52 rounds a value to an integer, found in the low bits.
+#define SHIFT     6755399441055744.0
+
+/// @brief Computes 2^(k/N) * e^r, with the sign, for |r| <= ln2/2N.
+/// @param r the reduced argument.
+/// @param k the multiple of ln2/N.
+/// @param sign if the result is negative.
+/// @return the result.
+static inline double __exp_finish(double r, int32_t k, uint32_t sign)
+{
+    const exp_entry_t *t = &__exp_table[k & (LIBM_TABLE_SIZE - 1)];
+    int32_t e            = k >> 7;
+    // e^r - 1, the truncation error is below 2^-60.
+    double r2            = r * r;
+    double p             = r + r2 * (0.5 + r * (1.0 / 6)) + r2 * r2 * ((1.0 / 24) + r * (1.0 / 120));
+    double tmp           = t->hi + (t->lo + t->hi * p);
+    double y;
+    if (e > 1023) {
+        // The table entry is smaller than 2, scale it in two steps.
+        y = __narrow(tmp * __asdouble((uint64_t)(e - 1 + 0x3ff) << 52U) * 2.0);
+        if (isinf(y)) {
+            return __math_oflow(sign);
+        }
+    } else if (e < -1021) {
+        // The result is subnormal, and must be rounded only once.
+        y = __narrow(tmp * __asdouble((uint64_t)(e + 1000 + 0x3ff) << 52U) * 0x1p-1000);
+        if (y == 0) {
+            return __math_uflow(sign);
+        }
+    } else {
+        y = tmp * __asdouble((uint64_t)(e + 0x3ff) << 52U);
+    }
+    return sign ? -y : y;
+}
+
+double __exp_core(double x, double xtail, uint32_t sign)
+{
+    uint32_t abstop = __top12(x) & 0x7ffU;
+    // Arguments smaller than 2^-54, or larger than 512, infinities and NaNs.
+    if (abstop - 0x3c9U >= 0x408U - 0x3c9U) {
+        if ((int32_t)(abstop - 0x3c9U) < 0) {
+            return sign ? -1.0 - (x + xtail) : 1.0 + (x + xtail);
+        }
+        if (abstop >= 0x7ffU) {
+            if (x == -INFINITY) {
+                return sign ? -0.0 : 0.0;
+            }
+            return sign ? -(1.0 + x) : 1.0 + x;
+        }
+        if (x > 710.0) {
+            return __math_oflow(sign);
+        }
+        if (x < -746.0) {
+            return __math_uflow(sign);
+        }
+    }
+    // k = round(x * N/ln2), taken from the bits of the sum, which must be
+    // rounded to double before both uses.
+    double z    = __narrow(INV_LN2_N * x + SHIFT);
+    uint64_t ki = __asuint64(z);
+    double kd   = z - SHIFT;
+    // Both x - kd * LN2_HI_N and the product are exact.
+    double r    = x - kd * LN2_HI_N - kd * LN2_LO_N + xtail;
+    return __exp_finish(r, (int32_t)ki, sign);
+}
+
+double exp(double x) { return __exp_core(x, 0.0, 0); }
+
+double exp2(double x)
+{
+    uint32_t abstop = __top12(x) & 0x7ffU;
+    if (abstop - 0x3c9U >= 0x409U - 0x3c9U) {
+        if ((int32_t)(abstop - 0x3c9U) < 0) {
+            return 1.0 + x;
+        }
+        if (abstop >= 0x7ffU) {
+            return (x == -INFINITY) ? 0.0 : 1.0 + x;
+        }
+        if (x >= 1024.0) {
+            return __math_oflow(0);
+        }
+        if (x <= -1075.0) {
+            return __math_uflow(0);
+        }
+    }
+    double z    = __narrow(LIBM_TABLE_SIZE * x + SHIFT);
+    uint64_t ki = __asuint64(z);
+    double kd   = z - SHIFT;
+    // The difference is exact.
+    double r    = (x - kd * (1.0 / LIBM_TABLE_SIZE)) * LN2;
+    return __exp_finish(r, (int32_t)ki, 0);
+}
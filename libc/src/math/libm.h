@@ -0,0 +1,166 @@
+/// @file libm.h
+/// @brief Internal helpers, tables and kernels shared by the math functions.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#pragma once
+
+#include "stdint.h"
+
+/// The number of entries of the exponential and logarithm tables.
+#define LIBM_TABLE_SIZE 128
+
+/// @brief An entry of the exponential table, 2^(i/N) = hi + lo.
+typedef struct exp_entry {
+    double hi; ///< The value rounded to double.
+    double lo; ///< The rounding error of the value.
+} exp_entry_t;
+
+/// @brief An entry of the logarithm table.
+/// @details The table covers [0x1.6p-1, 0x1.6p0), split in N subintervals.
+/// For each of them, invc is close to 1/c, where c is the center of the
+/// subinterval, and has at most 21 significant bits, so that z * invc - 1 can
+/// be computed exactly. The two subintervals around 1 use invc = 1.
+typedef struct log_entry {
+    double invc; ///< The approximation of 1/c.
+    double logc; ///< The value of -log(invc), rounded to a multiple of 2^-42.
+    double tail; ///< The rounding error of logc.
+} log_entry_t;
+
+/// The values of 2^(i/N), for i in [0, N).
+extern const exp_entry_t __exp_table[LIBM_TABLE_SIZE];
+/// The logarithm table.
+extern const log_entry_t __log_table[LIBM_TABLE_SIZE];
+/// The bits of 2/pi, 32 at a time, starting from the most significant one.
+extern const uint32_t __two_over_pi[40];
+
+/// @brief Reinterprets the bits of a double as an integer.
+/// @param x the value.
+/// @return its bits.
+static inline uint64_t __asuint64(double x)
+{
+    union {
+        double f;
+        uint64_t i;
+    } u = { x };
+    return u.i;
+}
+
+/// @brief Reinterprets an integer as the bits of a double.
+/// @param i the bits.
+/// @return the value.
+static inline double __asdouble(uint64_t i)
+{
+    union {
+        uint64_t i;
+        double f;
+    } u = { i };
+    return u.f;
+}
+
+/// @brief Reinterprets the bits of a float as an integer.
+/// @param x the value.
+/// @return its bits.
+static inline uint32_t __asuint(float x)
+{
+    union {
+        float f;
+        uint32_t i;
+    } u = { x };
+    return u.i;
+}
+
+/// @brief Reinterprets an integer as the bits of a float.
+/// @param i the bits.
+/// @return the value.
+static inline float __asfloat(uint32_t i)
+{
+    union {
+        uint32_t i;
+        float f;
+    } u = { i };
+    return u.f;
+}
+
+/// @brief Returns the sign and the exponent bits of a double.
+/// @param x the value.
+/// @return the 12 most significant bits.
+static inline uint32_t __top12(double x) { return (uint32_t)(__asuint64(x) >> 52U); }
+
+/// @brief Rounds a value to double precision.
+/// @details The x87 unit keeps intermediate results in extended precision,
+/// and spills them to memory at arbitrary points; the compiler may even skip
+/// the rounding when a value goes through a union. The algorithms which track
+/// the rounding error of a sum, or which round to an integer by adding SHIFT,
+/// need the sum to be rounded exactly once, so they store it explicitly.
+/// @param x the value.
+/// @return the value rounded to double.
+static inline double __narrow(double x)
+{
+#if __FLT_EVAL_METHOD__ != 0
+    volatile double y = x;
+    return y;
+#else
+    return x;
+#endif
+}
+
+/// @brief Sets errno and returns the value of an overflowing result.
+/// @param sign if the result is negative.
+/// @return the infinity with the given sign.
+double __math_oflow(uint32_t sign);
+
+/// @brief Sets errno and returns the value of an underflowing result.
+/// @param sign if the result is negative.
+/// @return the zero with the given sign.
+double __math_uflow(uint32_t sign);
+
+/// @brief Sets errno and returns the value of a domain error.
+/// @param x the argument, returned if it is already a NaN.
+/// @return a NaN.
+double __math_invalid(double x);
+
+/// @brief Sets errno and returns the value of a pole error.
+/// @param sign if the result is negative.
+/// @return the infinity with the given sign.
+double __math_divzero(uint32_t sign);
+
+/// @brief Computes e^(x + xtail) * (-1)^sign, for arguments which may be out
+/// of range.
+/// @param x the argument.
+/// @param xtail a correction of the argument, much smaller than it.
+/// @param sign if the result is negative.
+/// @return the result.
+double __exp_core(double x, double xtail, uint32_t sign);
+
+/// @brief Computes the natural logarithm of a positive, finite, non-zero
+/// value, with about 68 bits of precision.
+/// @param ix the bits of the value.
+/// @param tail where the correction of the result is stored.
+/// @return the result, such that log(x) is close to the result plus tail.
+double __log_core(uint64_t ix, double *tail);
+
+/// @brief Reduces an argument to [-pi/4, pi/4], with respect to pi/2.
+/// @param x the argument.
+/// @param y where the reduced argument is stored, as y[0] + y[1].
+/// @return the quadrant of the argument, modulo 4.
+int __rem_pio2(double x, double *y);
+
+/// @brief Computes the sine on [-pi/4, pi/4].
+/// @param x the argument.
+/// @param y the correction of the argument.
+/// @return the result.
+double __sin_kernel(double x, double y);
+
+/// @brief Computes the cosine on [-pi/4, pi/4].
+/// @param x the argument.
+/// @param y the correction of the argument.
+/// @return the result.
+double __cos_kernel(double x, double y);
+
+/// @brief Computes the tangent on [-pi/4, pi/4].
+/// @param x the argument.
+/// @param y the correction of the argument.
+/// @param odd if the result is -1/tan(x + y), instead of tan(x + y).
+/// @return the result.
+double __tan_kernel(double x, double y, int odd);
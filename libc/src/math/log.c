@@ -0,0 +1,152 @@
+/// @file log.c
+/// @brief Logarithm functions.
+/// @details The argument is written as x = 2^k * z, with z in [0x1.6p-1,
+/// 0x1.6p0), so that log(x) = k * ln2 + log(c) + log(1 + r), where c is the
+/// center of the subinterval of z in the table and r = z/c - 1. The table
+/// provides log(c), and 1/c with few bits, so that r is computed exactly.
+/// The result is kept as the sum of two doubles until the end, the error of
+/// log is below 0.52 ulp.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "math.h"
+#include "libm.h"
+
+/// The bits of 0x1.6p-1, the start of the range of the table.
+#define LOG_OFF     0x3fe6000000000000ULL
+/// The value of ln2, split in two parts. The first one is a multiple of
+/// 2^-42, so that adding k * LN2_HI to the entries of the table is exact.
+#define LN2_HI      0.6931471805598903
+/// The rounding error of LN2_HI.
+#define LN2_LO      5.497923018708371e-14
+/// The value of 1/ln2, split in two parts. The first one has 26 bits.
+#define INV_LN2_HI  1.4426950514316559
+/// The rounding error of INV_LN2_HI.
+#define INV_LN2_LO  -1.0542692476429138e-08
+/// The value of 1/ln10, split in two parts. The first one has 26 bits.
+#define INV_LN10_HI 0.4342944845557213
+/// The rounding error of INV_LN10_HI.
+#define INV_LN10_LO -2.6524694553078553e-09
+
+double __log_core(uint64_t ix, double *tail)
+{
+    uint64_t tmp         = ix - LOG_OFF;
+    const log_entry_t *t = &__log_table[(tmp >> 45U) & (LIBM_TABLE_SIZE - 1)];
+    double kd            = (double)((int64_t)tmp >> 52);
+    uint64_t iz          = ix - (tmp & (0xfffULL << 52U));
+    // r = z * invc - 1, exactly, as rhi + rlo. Both products are exact,
+    // because invc has 21 bits, zhi 21 bits, and zlo 32 bits.
+    double zhi           = __asdouble((iz + (1ULL << 31U)) & (~0ULL << 32U));
+    double zlo           = __asdouble(iz) - zhi;
+    double rh0           = zhi * t->invc - 1.0;
+    double rl0           = zlo * t->invc;
+    // Close to 1, zhi * invc - 1 may be zero, so renormalize the sum.
+    double rhi           = __narrow(rh0 + rl0);
+    double bb            = __narrow(rhi - rh0);
+    double rlo           = (rh0 - (rhi - bb)) + (rl0 - bb);
+    double r             = rhi + rlo;
+    // The sum of k * ln2 and log(c), exact, plus rhi. Either w is zero, or
+    // it is larger than rhi, so we can track the rounding error.
+    double w             = kd * LN2_HI + t->logc;
+    double hi            = __narrow(w + rhi);
+    double lo            = (w - hi) + rhi;
+    // Add -r^2/2. The square of the first 26 bits of r is exact.
+    double shi           = __asdouble(__asuint64(rhi) & (~0ULL << 27U));
+    double slo           = (rhi - shi) + rlo;
+    double sq            = -0.5 * shi * shi;
+    double sum           = __narrow(hi + sq);
+    lo += (hi - sum) + sq;
+    hi = sum;
+    // The remaining terms of log(1 + r), with |r| < 2^-7, are small enough
+    // to be rounded.
+    double r2 = r * r;
+    double p  = r2 * r *
+               ((1.0 / 3) - r * (1.0 / 4) + r2 * ((1.0 / 5) - r * (1.0 / 6)) +
+                r2 * r2 * ((1.0 / 7) - r * (1.0 / 8) + r2 * ((1.0 / 9) - r * (1.0 / 10))));
+    *tail = lo + (kd * LN2_LO + t->tail + rlo - 0.5 * slo * (shi + r) + p);
+    return hi;
+}
+
+/// @brief Handles the arguments of the logarithms which are not positive
+/// normal numbers.
+/// @param x the argument.
+/// @param ix where the bits of the normalized argument are stored.
+/// @param res where the result is stored.
+/// @return 0 if the argument was normalized, 1 if the result is in res.
+static inline int __log_special(double x, uint64_t *ix, double *res)
+{
+    *ix = __asuint64(x);
+    if (((*ix >> 52U) - 0x001U) < (0x7ffU - 0x001U)) {
+        return 0;
+    }
+    if ((*ix << 1U) == 0) {
+        *res = __math_divzero(1);
+    } else if (*ix == 0x7ff0000000000000ULL) {
+        *res = x;
+    } else if ((*ix >> 63U) || ((*ix >> 52U) == 0x7ffU)) {
+        *res = __math_invalid(x);
+    } else {
+        // Subnormal, normalize it.
+        *ix = __asuint64(x * 0x1p52) - (52ULL << 52U);
+        return 0;
+    }
+    return 1;
+}
+
+double log(double x)
+{
+    uint64_t ix;
+    double hi, lo, res;
+    if (__log_special(x, &ix, &res)) {
+        return res;
+    }
+    hi = __log_core(ix, &lo);
+    return hi + lo;
+}
+
+/// @brief Multiplies the sum of two doubles by a constant, split in two parts.
+/// @param hi the first part of the value.
+/// @param lo the second part of the value.
+/// @param chi the first part of the constant, with 26 bits.
+/// @param clo the second part of the constant.
+/// @return the product.
+static inline double __log_scale(double hi, double lo, double chi, double clo)
+{
+    // The product of the first 27 bits of hi with chi is exact.
+    double hh = __asdouble(__asuint64(hi) & (~0ULL << 26U));
+    double hl = (hi - hh) + lo;
+    return hh * chi + (hl * (chi + clo) + hh * clo);
+}
+
+double log2(double x)
+{
+    uint64_t ix;
+    double hi, lo, res;
+    if (__log_special(x, &ix, &res)) {
+        return res;
+    }
+    hi = __log_core(ix, &lo);
+    return __log_scale(hi, lo, INV_LN2_HI, INV_LN2_LO);
+}
+
+double log10(double x)
+{
+    uint64_t ix;
+    double hi, lo, res;
+    if (__log_special(x, &ix, &res)) {
+        return res;
+    }
+    hi = __log_core(ix, &lo);
+    return __log_scale(hi, lo, INV_LN10_HI, INV_LN10_LO);
+}
+
+double ln(double x) { return log(x); }
+
+double logx(double x, double y)
+{
+    // Base may not equal 1 or be negative.
+    if (y == 1.F || y < 0.F || log(y) == 0.F) {
+        return 0.F;
+    }
+    return log(x) / log(y);
+}
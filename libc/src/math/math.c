@@ -0,0 +1,152 @@
+/// @file math.c
+/// @brief Rounding, absolute value, square root and classification functions.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "math.h"
+#include "errno.h"
+#include "libm.h"
+
+double __math_oflow(uint32_t sign)
+{
+    errno = ERANGE;
+    return sign ? -HUGE_VAL : HUGE_VAL;
+}
+
+double __math_uflow(uint32_t sign)
+{
+    errno = ERANGE;
+    return sign ? -0.0 : 0.0;
+}
+
+double __math_invalid(double x)
+{
+    if (isnan(x)) {
+        return x;
+    }
+    errno = EDOM;
+    return NAN;
+}
+
+double __math_divzero(uint32_t sign)
+{
+    errno = ERANGE;
+    return sign ? -HUGE_VAL : HUGE_VAL;
+}
+
+double round(double x)
+{
+    uint64_t ix = __asuint64(x);
+    int e       = (int)((ix >> 52U) & 0x7ffU) - 0x3ff;
+    // Integers, infinities and NaNs.
+    if (e >= 52) {
+        return x;
+    }
+    // Values smaller than 1, which round to zero or one.
+    if (e < 0) {
+        ix &= 0x8000000000000000ULL;
+        if (e == -1) {
+            ix |= 0x3ff0000000000000ULL;
+        }
+        return __asdouble(ix);
+    }
+    uint64_t fraction = 0x000fffffffffffffULL >> e;
+    if ((ix & fraction) == 0) {
+        return x;
+    }
+    // Add one half, the carry may increment the exponent, then truncate.
+    ix += 0x0008000000000000ULL >> e;
+    ix &= ~fraction;
+    return __asdouble(ix);
+}
+
+/// @brief Rounds a value towards zero.
+/// @param x the value.
+/// @param fraction where the bits of the fraction are stored, zero if the
+/// value is already integral.
+/// @return the truncated value.
+static inline double __trunc(double x, uint64_t *fraction)
+{
+    uint64_t ix = __asuint64(x);
+    int e       = (int)((ix >> 52U) & 0x7ffU) - 0x3ff;
+    if (e >= 52) {
+        *fraction = 0;
+        return x;
+    }
+    if (e < 0) {
+        *fraction = ix & 0x7fffffffffffffffULL;
+        return __asdouble(ix & 0x8000000000000000ULL);
+    }
+    *fraction = ix & (0x000fffffffffffffULL >> e);
+    return __asdouble(ix & ~(0x000fffffffffffffULL >> e));
+}
+
+double floor(double x)
+{
+    uint64_t fraction;
+    double t = __trunc(x, &fraction);
+    return (fraction && (x < 0)) ? t - 1.0 : t;
+}
+
+double ceil(double x)
+{
+    uint64_t fraction;
+    double t = __trunc(x, &fraction);
+    return (fraction && (x > 0)) ? t + 1.0 : t;
+}
+
+double fabs(double x) { return __asdouble(__asuint64(x) & 0x7fffffffffffffffULL); }
+
+float fabsf(float x) { return __asfloat(__asuint(x) & 0x7fffffffU); }
+
+double sqrt(double x)
+{
+    if (x < 0) {
+        return __math_invalid(x);
+    }
+    double out;
+    __asm__ __volatile__("fsqrt" : "=t"(out) : "0"(x));
+    return out;
+}
+
+float sqrtf(float x)
+{
+    if (x < 0) {
+        return (float)__math_invalid(x);
+    }
+    float out;
+    __asm__ __volatile__("fsqrt" : "=t"(out) : "0"(x));
+    return out;
+}
+
+int isinf(double x) { return (__asuint64(x) & 0x7fffffffffffffffULL) == 0x7ff0000000000000ULL; }
+
+int isnan(double x) { return (__asuint64(x) & 0x7fffffffffffffffULL) > 0x7ff0000000000000ULL; }
+
+/// Max power for forward and reverse projections.
+#define MAXPOWTWO 4.503599627370496000E+15
+
+double modf(double x, double *intpart)
+{
+    register double absvalue;
+    if ((absvalue = (x >= 0.0) ? x : -x) >= MAXPOWTWO) {
+        // It must be an integer.
+        (*intpart) = x;
+    } else {
+        // Shift fraction off right.
+        (*intpart) = absvalue + MAXPOWTWO;
+        // Shift back without fraction.
+        (*intpart) -= MAXPOWTWO;
+
+        // Above arithmetic might round.
+        while ((*intpart) > absvalue) {
+            // Test again just to be sure.
+            (*intpart) -= 1.0;
+        }
+        if (x < 0.0) {
+            (*intpart) = -(*intpart);
+        }
+    }
+    // Signed fractional part.
+    return (x - (*intpart));
+}
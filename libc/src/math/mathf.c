@@ -0,0 +1,206 @@
+/// @file mathf.c
+/// @brief Single precision math functions.
+/// @details The functions are evaluated in double precision, with shorter
+/// polynomials and the same tables of the double precision ones, so the only
+/// significant error is the final rounding to float.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "math.h"
+#include "libm.h"
+
+/// The bits of 0x1.6p-1, the start of the range of the logarithm table.
+#define LOG_OFF   0x3fe6000000000000ULL
+/// The value of ln2.
+#define LN2       0.6931471805599453
+/// The value of N/ln2.
+#define INV_LN2_N 184.6649652337873
+/// The value of ln2/N.
+#define LN2_N     (LN2 / LIBM_TABLE_SIZE)
+/// Adding 1.5 * 2^52 rounds a value to an integer, found in the low bits.
+#define SHIFT     6755399441055744.0
+/// The largest argument of expf with a finite result.
+#define EXPF_MAX  88.72283172607421875
+/// The smallest argument of expf with a non-zero result.
+#define EXPF_MIN  -103.97207708399179
+
+/// @brief Computes the logarithm of a positive normal double, with a relative
+/// error of about 2^-50.
+/// @param x the argument.
+/// @return the result.
+static inline double __logf_core(double x)
+{
+    uint64_t ix          = __asuint64(x);
+    uint64_t tmp         = ix - LOG_OFF;
+    const log_entry_t *t = &__log_table[(tmp >> 45U) & (LIBM_TABLE_SIZE - 1)];
+    double kd            = (double)((int64_t)tmp >> 52);
+    double z             = __asdouble(ix - (tmp & (0xfffULL << 52U)));
+    // The product is exact for arguments which come from a float.
+    double r             = z * t->invc - 1.0;
+    double r2            = r * r;
+    double p             = r2 * (-0.5 + r * (1.0 / 3)) + r2 * r2 * (-0.25 + r * (0.2 - r * (1.0 / 6)));
+    return (kd * LN2 + t->logc) + (r + p);
+}
+
+/// @brief Computes the exponential, for EXPF_MIN <= x <= EXPF_MAX.
+/// @param x the argument.
+/// @return the result, with a relative error of about 2^-50.
+static inline double __expf_core(double x)
+{
+    double z    = __narrow(INV_LN2_N * x + SHIFT);
+    uint64_t ki = __asuint64(z);
+    double kd   = z - SHIFT;
+    double r    = x - kd * LN2_N;
+    double r2   = r * r;
+    double p    = 1.0 + r + r2 * (0.5 + r * (1.0 / 6)) + r2 * r2 * (1.0 / 24);
+    int32_t e   = (int32_t)ki >> 7;
+    return __exp_table[ki & (LIBM_TABLE_SIZE - 1)].hi * p * __asdouble((uint64_t)(e + 0x3ff) << 52U);
+}
+
+float expf(float x)
+{
+    if (isnan(x)) {
+        return x + x;
+    }
+    if (x > EXPF_MAX) {
+        return (float)__math_oflow(0);
+    }
+    if (x < EXPF_MIN) {
+        return (x == -INFINITY) ? 0.0F : (float)__math_uflow(0);
+    }
+    return (float)__expf_core(x);
+}
+
+float logf(float x)
+{
+    uint32_t ix = __asuint(x);
+    // Zero, negative, infinity and NaN. Subnormals are normal doubles.
+    if ((ix - 1U) >= 0x7f800000U - 1U) {
+        if ((ix << 1U) == 0) {
+            return (float)__math_divzero(1);
+        }
+        if (ix == 0x7f800000U) {
+            return x;
+        }
+        return (float)__math_invalid(x);
+    }
+    return (float)__logf_core(x);
+}
+
+float powf(float x, float y)
+{
+    uint32_t ix = __asuint(x), iy = __asuint(y);
+    // The special cases are handled by pow: x is not a positive finite
+    // number, or y is a zero, an infinity or a NaN.
+    if (((ix - 1U) >= 0x7f800000U - 1U) || ((2 * iy - 1) >= 2U * 0x7f800000U - 1)) {
+        return (float)pow(x, y);
+    }
+    double e = y * __logf_core(x);
+    if (e > EXPF_MAX + 0.5) {
+        return (float)__math_oflow(0);
+    }
+    if (e < EXPF_MIN - 0.5) {
+        return (float)__math_uflow(0);
+    }
+    return (float)__expf_core(e);
+}
+
+/// @brief Computes the sine on [-pi/4, pi/4], accurately enough for floats.
+/// @param x the argument.
+/// @return the result.
+static inline double __sinf_kernel(double x)
+{
+    double z = x * x;
+    double s = z * x;
+    return x + s * (-0.166666666416265235595 + z * 0.0083333293858894631756) +
+           s * z * z * (-0.000198393348360966317347 + z * 0.0000027183114939898219064);
+}
+
+/// @brief Computes the cosine on [-pi/4, pi/4], accurately enough for floats.
+/// @param x the argument.
+/// @return the result.
+static inline double __cosf_kernel(double x)
+{
+    double z = x * x;
+    double w = z * z;
+    return 1.0 + z * -0.499999997251031003120 + w * 0.0416666233237390631894 +
+           w * z * (-0.00138867637746099294692 + z * 0.0000243904487962774090654);
+}
+
+/// @brief Reduces the argument of the trigonometric functions.
+/// @param x the argument.
+/// @param y where the reduced argument is stored.
+/// @return the quadrant.
+static inline int __rem_pio2f(float x, double *y)
+{
+    double r[2];
+    int n = __rem_pio2(x, r);
+    // The reduced argument of a float only needs double precision.
+    *y    = r[0] + r[1];
+    return n;
+}
+
+float sinf(float x)
+{
+    double y;
+    uint32_t ax = __asuint(x) & 0x7fffffffU;
+    // |x| <= pi/4.
+    if (ax <= 0x3f490fdaU) {
+        // For |x| < 2^-12, sin(x) rounds to x.
+        return (ax < 0x39800000U) ? x : (float)__sinf_kernel(x);
+    }
+    if (ax >= 0x7f800000U) {
+        return (float)__math_invalid(x);
+    }
+    switch (__rem_pio2f(x, &y) & 3) {
+    case 0:
+        return (float)__sinf_kernel(y);
+    case 1:
+        return (float)__cosf_kernel(y);
+    case 2:
+        return (float)-__sinf_kernel(y);
+    default:
+        return (float)-__cosf_kernel(y);
+    }
+}
+
+float cosf(float x)
+{
+    double y;
+    uint32_t ax = __asuint(x) & 0x7fffffffU;
+    if (ax <= 0x3f490fdaU) {
+        // For |x| < 2^-12, cos(x) rounds to 1.
+        return (ax < 0x39800000U) ? 1.0F : (float)__cosf_kernel(x);
+    }
+    if (ax >= 0x7f800000U) {
+        return (float)__math_invalid(x);
+    }
+    switch (__rem_pio2f(x, &y) & 3) {
+    case 0:
+        return (float)__cosf_kernel(y);
+    case 1:
+        return (float)-__sinf_kernel(y);
+    case 2:
+        return (float)-__cosf_kernel(y);
+    default:
+        return (float)__sinf_kernel(y);
+    }
+}
+
+float tanf(float x)
+{
+    double y;
+    uint32_t ax = __asuint(x) & 0x7fffffffU;
+    if (ax <= 0x3f490fdaU) {
+        return (ax < 0x39800000U) ? x : (float)__tan_kernel(x, 0.0, 0);
+    }
+    if (ax >= 0x7f800000U) {
+        return (float)__math_invalid(x);
+    }
+    int n = __rem_pio2f(x, &y);
+    return (float)__tan_kernel(y, 0.0, n & 1);
+}
+
+float atanf(float x) { return (float)atan(x); }
+
+float atan2f(float y, float x) { return (float)atan2(y, x); }
@@ -0,0 +1,113 @@
+/// @file pow.c
+/// @brief Power function.
+/// @details The result is computed as e^(y * log(x)). The logarithm is kept
+/// with about 68 bits of precision, so that the product does not lose
+/// precision even when it is close to the overflow threshold. The error is
+/// below 0.55 ulp.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "math.h"
+#include "libm.h"
+
+/// @brief Checks if a value is an integer.
+/// @param iy the bits of the value.
+/// @return 0 if it is not an integer, 1 if it is an odd one, 2 if it is an
+/// even one.
+static inline int __checkint(uint64_t iy)
+{
+    int e = (int)((iy >> 52U) & 0x7ffU);
+    if (e < 0x3ff) {
+        return 0;
+    }
+    if (e > 0x3ff + 52) {
+        return 2;
+    }
+    if (iy & ((1ULL << (0x3ff + 52 - e)) - 1)) {
+        return 0;
+    }
+    if (iy & (1ULL << (0x3ff + 52 - e))) {
+        return 1;
+    }
+    return 2;
+}
+
+/// @brief Checks if a value is a zero, an infinity or a NaN.
+/// @param i the bits of the value.
+/// @return 1 if it is, 0 otherwise.
+static inline int __zeroinfnan(uint64_t i) { return 2 * i - 1 >= 2 * 0x7ff0000000000000ULL - 1; }
+
+double pow(double x, double y)
+{
+    uint32_t sign = 0;
+    uint64_t ix   = __asuint64(x);
+    uint64_t iy   = __asuint64(y);
+    uint32_t topx = __top12(x);
+    uint32_t topy = __top12(y) & 0x7ffU;
+    // Special cases: x is not a positive normal number, or |y| is smaller
+    // than 2^-65 or larger than 2^63, or it is not finite.
+    if ((topx - 0x001U >= 0x7ffU - 0x001U) || (topy - 0x3beU >= 0x43eU - 0x3beU)) {
+        if (__zeroinfnan(iy)) {
+            if ((2 * iy == 0) || (ix == 0x3ff0000000000000ULL)) {
+                return 1.0;
+            }
+            if ((2 * ix > 2 * 0x7ff0000000000000ULL) || (2 * iy > 2 * 0x7ff0000000000000ULL)) {
+                return x + y;
+            }
+            if (2 * ix == 2 * 0x3ff0000000000000ULL) {
+                return 1.0;
+            }
+            // Either |x| < 1 and y = inf, or |x| > 1 and y = -inf.
+            if ((2 * ix < 2 * 0x3ff0000000000000ULL) == !(iy >> 63U)) {
+                return 0.0;
+            }
+            return y * y;
+        }
+        if (__zeroinfnan(ix)) {
+            double x2 = x * x;
+            if ((ix >> 63U) && (__checkint(iy) == 1)) {
+                x2 = -x2;
+            }
+            if (iy >> 63U) {
+                return (x2 == 0) ? __math_divzero(__asuint64(x2) >> 63U) : 1.0 / x2;
+            }
+            return x2;
+        }
+        // Here x and y are finite and non-zero.
+        if (ix >> 63U) {
+            int yint = __checkint(iy);
+            if (yint == 0) {
+                return __math_invalid(x);
+            }
+            sign = (yint == 1);
+            ix &= 0x7fffffffffffffffULL;
+            topx &= 0x7ffU;
+        }
+        if (topy - 0x3beU >= 0x43eU - 0x3beU) {
+            if (ix == 0x3ff0000000000000ULL) {
+                return 1.0;
+            }
+            // Small |y|, the result is 1 + y * log(x), rounded.
+            if (topy < 0x3beU) {
+                return (ix > 0x3ff0000000000000ULL) ? 1.0 + y : 1.0 - y;
+            }
+            // Large |y|, the result overflows or underflows.
+            return ((ix > 0x3ff0000000000000ULL) == (topy == __top12(y))) ? __math_oflow(0) : __math_uflow(0);
+        }
+        if (topx == 0) {
+            // Subnormal x, normalize it.
+            ix = __asuint64(x * 0x1p52) & 0x7fffffffffffffffULL;
+            ix -= 52ULL << 52U;
+        }
+    }
+    double lo, hi = __log_core(ix, &lo);
+    // The product of the first 26 bits of y and of the logarithm is exact,
+    // the rest is a small correction.
+    double yhi    = __asdouble(iy & (~0ULL << 27U));
+    double ylo    = y - yhi;
+    double lhi    = __asdouble(__asuint64(hi) & (~0ULL << 27U));
+    double llo    = (hi - lhi) + lo;
+    double ehi    = yhi * lhi;
+    double elo    = ylo * lhi + y * llo;
+    return __exp_core(ehi, elo, sign);
+}
@@ -0,0 +1,299 @@
+/// @file trig.c
+/// @brief Sine, cosine and tangent.
+/// @details The argument is reduced to [-pi/4, pi/4] with respect to pi/2,
+/// with a three-part Cody-Waite reduction for |x| < 2^20, and with the bits
+/// of 2/pi from the table (Payne-Hanek) above it, so the reduction is exact
+/// for every double. The reduced argument is kept as the sum of two doubles,
+/// and the minimax kernels of fdlibm give results within 1 ulp.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "math.h"
+#include "libm.h"
+
+/// The value of 2/pi.
+#define INV_PIO2 0.6366197723675814
+/// The first 33 bits of pi/2.
+#define PIO2_1   1.5707963267341256
+/// The value of pi/2 - PIO2_1.
+#define PIO2_1T  6.077100506506192e-11
+/// The second 33 bits of pi/2.
+#define PIO2_2   6.077100506303966e-11
+/// The value of pi/2 - PIO2_1 - PIO2_2.
+#define PIO2_2T  2.0222662487959506e-21
+/// The third 33 bits of pi/2.
+#define PIO2_3   2.0222662487111665e-21
+/// The value of pi/2 - PIO2_1 - PIO2_2 - PIO2_3.
+#define PIO2_3T  8.4784276603689e-32
+/// The value of pi/2, rounded to double.
+#define PIO2_HI  1.5707963267948966
+/// The rounding error of PIO2_HI.
+#define PIO2_LO  6.123233995736766e-17
+/// The value of pi/4, rounded to double.
+#define PIO4_HI  0.7853981633974483
+/// The rounding error of PIO4_HI.
+#define PIO4_LO  3.061616997868383e-17
+/// Adding 1.5 * 2^52 rounds a value to an integer, found in the low bits.
+#define SHIFT    6755399441055744.0
+
+/// @brief Extracts 32 bits from a little-endian multi-word integer.
+/// @param p the words of the integer, followed by a zero word.
+/// @param bit the position of the least significant bit to extract.
+/// @return the bits.
+static inline uint32_t __get32(const uint32_t *p, int bit)
+{
+    int word = bit >> 5, shift = bit & 31;
+    return shift ? (p[word] >> shift) | (p[word + 1] << (32 - shift)) : p[word];
+}
+
+/// @brief Adds a value to the sum of two doubles, keeping the rounding error.
+/// @param hi the first part of the sum.
+/// @param lo the second part of the sum.
+/// @param b the value.
+static inline void __two_sum(double *hi, double *lo, double b)
+{
+    double s  = __narrow(*hi + b);
+    double bb = __narrow(s - *hi);
+    *lo += (*hi - (s - bb)) + (b - bb);
+    *hi = s;
+}
+
+/// @brief Reduces a large argument, by multiplying it with the bits of 2/pi.
+/// @param x the argument, with |x| >= 2^20.
+/// @param y where the reduced argument is stored.
+/// @return the quadrant of the argument.
+static int __rem_pio2_large(double x, double *y)
+{
+    uint64_t ix = __asuint64(x);
+    uint64_t m  = (ix & 0x000fffffffffffffULL) | 0x0010000000000000ULL;
+    // x = m * 2^e. The words of 2/pi before k0 give multiples of 4, which do
+    // not change the quadrant, and 7 words give enough precision for the
+    // worst cases, which are about 2^-61 away from a multiple of pi/2.
+    int e       = (int)((ix >> 52U) & 0x7ffU) - 0x3ff - 52;
+    int k0      = (e >= 34) ? (e - 34) / 32 + 1 : 0;
+    uint32_t ml[2] = { (uint32_t)m, (uint32_t)(m >> 32U) };
+    uint32_t p[10] = { 0 };
+    for (int a = 0; a < 2; ++a) {
+        uint64_t carry = 0;
+        for (int j = 0; j < 7; ++j) {
+            uint64_t t = (uint64_t)ml[a] * __two_over_pi[k0 + 6 - j] + p[a + j] + carry;
+            p[a + j]   = (uint32_t)t;
+            carry      = t >> 32U;
+        }
+        p[a + 7] = (uint32_t)carry;
+    }
+    // The units are at bit pos of the product, take the last two bits of the
+    // integer part, and 160 bits of the fraction.
+    int pos     = 32 * (k0 + 7) - e;
+    uint32_t n  = __get32(p, pos) & 3U;
+    uint32_t f[5];
+    for (int i = 0; i < 5; ++i) {
+        f[i] = __get32(p, pos - 32 * (i + 1));
+    }
+    int negative = 0;
+    if (f[0] & 0x80000000U) {
+        // Round to the nearest quadrant, the fraction becomes negative.
+        n        = (n + 1) & 3U;
+        negative = 1;
+        uint32_t carry = 1;
+        for (int i = 4; i >= 0; --i) {
+            f[i]  = ~f[i] + carry;
+            carry = carry && (f[i] == 0);
+        }
+    }
+    double hi = f[0] * 0x1p-32, lo = 0.0;
+    __two_sum(&hi, &lo, f[1] * 0x1p-64);
+    __two_sum(&hi, &lo, f[2] * 0x1p-96);
+    __two_sum(&hi, &lo, f[3] * 0x1p-128);
+    __two_sum(&hi, &lo, f[4] * 0x1p-160);
+    // Multiply by pi/2, tracking the rounding error of the main product.
+    double y0  = __narrow(hi * PIO2_HI);
+    double hh  = __asdouble(__asuint64(hi) & (~0ULL << 27U));
+    double hl  = hi - hh;
+    double ph  = __asdouble(__asuint64(PIO2_HI) & (~0ULL << 27U));
+    double pl  = PIO2_HI - ph;
+    double y1  = (((hh * ph - y0) + hh * pl + hl * ph) + hl * pl) + (lo * PIO2_HI + hi * PIO2_LO);
+    double sum = __narrow(y0 + y1);
+    y1         = y1 - (sum - y0);
+    y0         = sum;
+    if (negative ^ (int)(ix >> 63U)) {
+        y0 = -y0;
+        y1 = -y1;
+    }
+    y[0] = y0;
+    y[1] = y1;
+    return (ix >> 63U) ? -(int)n : (int)n;
+}
+
+int __rem_pio2(double x, double *y)
+{
+    uint32_t top = __top12(x) & 0x7ffU;
+    if (top >= 0x413U) {
+        return __rem_pio2_large(x, y);
+    }
+    double z    = __narrow(x * INV_PIO2 + SHIFT);
+    uint64_t ni = __asuint64(z);
+    double fn   = z - SHIFT;
+    // The products are exact, because |fn| < 2^20, and so is the difference.
+    double r    = x - fn * PIO2_1;
+    double w    = fn * PIO2_1T;
+    double y0   = __narrow(r - w);
+    // If too many bits cancelled, repeat with the following bits of pi/2.
+    if ((int)top - (int)(__top12(y0) & 0x7ffU) > 16) {
+        double t = r;
+        w        = fn * PIO2_2;
+        r        = __narrow(t - w);
+        w        = fn * PIO2_2T - ((t - r) - w);
+        y0       = __narrow(r - w);
+        if ((int)top - (int)(__top12(y0) & 0x7ffU) > 49) {
+            t  = r;
+            w  = fn * PIO2_3;
+            r  = __narrow(t - w);
+            w  = fn * PIO2_3T - ((t - r) - w);
+            y0 = __narrow(r - w);
+        }
+    }
+    y[0] = y0;
+    y[1] = (r - y0) - w;
+    return (int32_t)ni;
+}
+
+double __sin_kernel(double x, double y)
+{
+    const double s1 = -1.66666666666666324348e-01;
+    const double s2 = 8.33333333332248946124e-03;
+    const double s3 = -1.98412698298579493134e-04;
+    const double s4 = 2.75573137070700676789e-06;
+    const double s5 = -2.50507602534068634195e-08;
+    const double s6 = 1.58969099521155010221e-10;
+    double z        = x * x;
+    double v        = z * x;
+    double r        = s2 + z * (s3 + z * s4) + z * z * z * (s5 + z * s6);
+    return x - ((z * (0.5 * y - v * r) - y) - v * s1);
+}
+
+double __cos_kernel(double x, double y)
+{
+    const double c1 = 4.16666666666666019037e-02;
+    const double c2 = -1.38888888888741095749e-03;
+    const double c3 = 2.48015872894767294178e-05;
+    const double c4 = -2.75573143513906633035e-07;
+    const double c5 = 2.08757232129817482790e-09;
+    const double c6 = -1.13596475577881948265e-11;
+    double z        = x * x;
+    double w        = z * z;
+    double r        = z * (c1 + z * (c2 + z * c3)) + w * w * (c4 + z * (c5 + z * c6));
+    double hz       = 0.5 * z;
+    // 1 - hz is rounded, and its rounding error added back.
+    w               = __narrow(1.0 - hz);
+    return w + (((1.0 - w) - hz) + (z * r - x * y));
+}
+
+double __tan_kernel(double x, double y, int odd)
+{
+    static const double t[] = {
+        3.33333333333334091986e-01,  1.33333333333201242699e-01,  5.39682539762260521377e-02,
+        2.18694882948595424599e-02,  8.86323982359930005737e-03,  3.59207910759131235356e-03,
+        1.45620945432529025516e-03,  5.88041240820264096874e-04,  2.46463134818469906812e-04,
+        7.81794442939557092300e-05,  7.14072491382608190305e-05,  -1.85586374855275456654e-05,
+        2.59073051863633712884e-05,
+    };
+    double z, r, v, w, s, a, w0, a0;
+    int big = (__asuint64(x) & 0x7fffffffffffffffULL) >= 0x3fe5942800000000ULL;
+    int negative = (int)(__asuint64(x) >> 63U);
+    if (big) {
+        // For |x| >= 0.6744, use tan(x) = tan(pi/4 - (pi/4 - x)).
+        if (negative) {
+            x = -x;
+            y = -y;
+        }
+        x = (PIO4_HI - x) + (PIO4_LO - y);
+        y = 0.0;
+    }
+    z = x * x;
+    w = z * z;
+    // The odd and even terms are evaluated separately, to shorten the chain
+    // of dependencies.
+    r = t[1] + w * (t[3] + w * (t[5] + w * (t[7] + w * (t[9] + w * t[11]))));
+    v = z * (t[2] + w * (t[4] + w * (t[6] + w * (t[8] + w * (t[10] + w * t[12])))));
+    s = z * x;
+    r = y + z * (s * (r + v) + y) + s * t[0];
+    w = x + r;
+    if (big) {
+        s = 1 - 2 * odd;
+        v = s - 2.0 * (x + (r - w * w / (w + s)));
+        return negative ? -v : v;
+    }
+    if (!odd) {
+        return w;
+    }
+    // Compute -1/(x + r) accurately, the division alone has a 2 ulp error.
+    w  = __narrow(w);
+    w0 = __asdouble(__asuint64(w) & 0xffffffff00000000ULL);
+    v  = r - (w0 - x);
+    a  = __narrow(-1.0 / w);
+    a0 = __asdouble(__asuint64(a) & 0xffffffff00000000ULL);
+    return a0 + a * (1.0 + a0 * w0 + a0 * v);
+}
+
+double sin(double x)
+{
+    double y[2];
+    uint64_t ax = __asuint64(x) & 0x7fffffffffffffffULL;
+    // |x| <= pi/4.
+    if (ax <= 0x3fe921fb54442d18ULL) {
+        // For |x| < 2^-26, sin(x) rounds to x.
+        return (ax < 0x3e50000000000000ULL) ? x : __sin_kernel(x, 0.0);
+    }
+    if (ax >= 0x7ff0000000000000ULL) {
+        return __math_invalid(x);
+    }
+    switch (__rem_pio2(x, y) & 3) {
+    case 0:
+        return __sin_kernel(y[0], y[1]);
+    case 1:
+        return __cos_kernel(y[0], y[1]);
+    case 2:
+        return -__sin_kernel(y[0], y[1]);
+    default:
+        return -__cos_kernel(y[0], y[1]);
+    }
+}
+
+double cos(double x)
+{
+    double y[2];
+    uint64_t ax = __asuint64(x) & 0x7fffffffffffffffULL;
+    if (ax <= 0x3fe921fb54442d18ULL) {
+        // For |x| < 2^-27, cos(x) rounds to 1.
+        return (ax < 0x3e40000000000000ULL) ? 1.0 : __cos_kernel(x, 0.0);
+    }
+    if (ax >= 0x7ff0000000000000ULL) {
+        return __math_invalid(x);
+    }
+    switch (__rem_pio2(x, y) & 3) {
+    case 0:
+        return __cos_kernel(y[0], y[1]);
+    case 1:
+        return -__sin_kernel(y[0], y[1]);
+    case 2:
+        return -__cos_kernel(y[0], y[1]);
+    default:
+        return __sin_kernel(y[0], y[1]);
+    }
+}
+
+double tan(double x)
+{
+    double y[2];
+    uint64_t ax = __asuint64(x) & 0x7fffffffffffffffULL;
+    if (ax <= 0x3fe921fb54442d18ULL) {
+        // For |x| < 2^-27, tan(x) rounds to x.
+        return (ax < 0x3e40000000000000ULL) ? x : __tan_kernel(x, 0.0, 0);
+    }
+    if (ax >= 0x7ff0000000000000ULL) {
+        return __math_invalid(x);
+    }
+    int n = __rem_pio2(x, y);
+    return __tan_kernel(y[0], y[1], n & 1);
+}
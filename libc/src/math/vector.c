@@ -0,0 +1,416 @@
+/// @file vector.c
+/// @brief Batch versions of the math functions.
+/// @details When the processor supports SSE2, the batches are processed two
+/// elements at a time, with the same algorithms and tables of the scalar
+/// functions. Pairs which contain a special value, or an argument which needs
+/// the slow path of the scalar function, are handed to the scalar function, so
+/// the results are the same within 1 ulp.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "math.h"
+#include "libm.h"
+
+/// Two doubles, in an SSE2 register.
+typedef double v2df_t __attribute__((vector_size(16)));
+/// Two 64-bit integers, in an SSE2 register.
+typedef uint64_t v2du_t __attribute__((vector_size(16)));
+/// Two signed 64-bit integers, the result of comparisons.
+typedef int64_t v2di_t __attribute__((vector_size(16)));
+
+/// Functions which use the SSE2 instructions, also for scalar arithmetic.
+#define SSE2 __attribute__((target("sse2,fpmath=sse")))
+
+/// The value of N/ln2.
+#define INV_LN2_N 184.6649652337873
+/// The first 32 significant bits of ln2/N.
+#define LN2_HI_N  (0.6931471803691238 / LIBM_TABLE_SIZE)
+/// The rounding error of LN2_HI_N.
+#define LN2_LO_N  (1.9082149292705877e-10 / LIBM_TABLE_SIZE)
+/// The value of ln2.
+#define LN2       0.6931471805599453
+/// The value of ln2/N.
+#define LN2_N     (LN2 / LIBM_TABLE_SIZE)
+/// The value of ln2, as a multiple of 2^-42.
+#define LN2_HI    0.6931471805598903
+/// The rounding error of LN2_HI.
+#define LN2_LO    5.497923018708371e-14
+/// The bits of 0x1.6p-1, the start of the range of the logarithm table.
+#define LOG_OFF   0x3fe6000000000000ULL
+/// The value of 2/pi.
+#define INV_PIO2  0.6366197723675814
+/// The first 33 bits of pi/2.
+#define PIO2_1    1.5707963267341256
+/// The value of pi/2 - PIO2_1.
+#define PIO2_1T   6.077100506506192e-11
+/// Adding 1.5 * 2^52 rounds a value to an integer, found in the low bits.
+#define SHIFT     6755399441055744.0
+/// The bits of a double with an absolute value of 2^52.
+#define TWO52     0x4330000000000000ULL
+/// The mask of the sign bit of a double.
+#define SIGN_MASK 0x8000000000000000ULL
+/// Below this magnitude, the exponential is neither subnormal nor infinite.
+#define VEXP_MAX  708.0
+/// Below this magnitude, the single precision exponential is finite and
+/// non-zero.
+#define VEXPF_MAX 88.0
+/// Below this magnitude, one step of the reduction is enough.
+#define VTRIG_MAX 524288.0
+
+/// @brief Checks if the processor supports SSE2, the first time it is called.
+/// @return 1 if it does, 0 otherwise.
+static int __has_sse2(void)
+{
+    static int supported = -1;
+    if (supported < 0) {
+        uint32_t eax = 1, ebx, ecx, edx;
+        __asm__ __volatile__("cpuid"
+                             : "+a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx));
+        supported = (int)((edx >> 26U) & 1U);
+    }
+    return supported;
+}
+
+/// @brief Computes the exponential of two values, with |x| <= VEXP_MAX.
+/// @param x the arguments.
+/// @return the results.
+SSE2 static inline v2df_t __vexp_kernel(v2df_t x)
+{
+    v2df_t z  = x * INV_LN2_N + SHIFT;
+    v2du_t ki = (v2du_t)z;
+    v2df_t kd = z - SHIFT;
+    v2df_t r  = x - kd * LN2_HI_N - kd * LN2_LO_N;
+    v2df_t r2 = r * r;
+    v2df_t p  = r + r2 * (0.5 + r * (1.0 / 6)) + r2 * r2 * ((1.0 / 24) + r * (1.0 / 120));
+    const exp_entry_t *t0 = &__exp_table[ki[0] & (LIBM_TABLE_SIZE - 1)];
+    const exp_entry_t *t1 = &__exp_table[ki[1] & (LIBM_TABLE_SIZE - 1)];
+    v2df_t thi = { t0->hi, t1->hi };
+    v2df_t tlo = { t0->lo, t1->lo };
+    // The low bits of ki hold k in two's complement, so the biased exponent
+    // is (k + 1023 * N) / N, which is positive in this range.
+    v2du_t scale = ((ki - __asuint64(SHIFT) + (0x3ffULL << 7U)) >> 7U) << 52U;
+    return (thi + (tlo + thi * p)) * (v2df_t)scale;
+}
+
+/// @brief Computes the logarithm of two positive normal values.
+/// @param x the arguments.
+/// @return the results.
+SSE2 static inline v2df_t __vlog_kernel(v2df_t x)
+{
+    v2du_t ix  = (v2du_t)x;
+    v2du_t tmp = ix - LOG_OFF;
+    // The exponent k is the signed top 12 bits of tmp, converted to double
+    // by placing it, biased, in the mantissa of 2^52.
+    v2df_t kd  = (v2df_t)(((tmp >> 52U) ^ 0x800U) | TWO52) - (0x1p52 + 0x800);
+    v2du_t iz  = ix - (tmp & (0xfffULL << 52U));
+    const log_entry_t *t0 = &__log_table[(tmp[0] >> 45U) & (LIBM_TABLE_SIZE - 1)];
+    const log_entry_t *t1 = &__log_table[(tmp[1] >> 45U) & (LIBM_TABLE_SIZE - 1)];
+    v2df_t invc = { t0->invc, t1->invc };
+    v2df_t logc = { t0->logc, t1->logc };
+    v2df_t tail = { t0->tail, t1->tail };
+    // The same steps of __log_core, see log.c.
+    v2df_t zhi  = (v2df_t)((iz + (1ULL << 31U)) & (~0ULL << 32U));
+    v2df_t zlo  = (v2df_t)iz - zhi;
+    v2df_t rh0  = zhi * invc - 1.0;
+    v2df_t rl0  = zlo * invc;
+    v2df_t rhi  = rh0 + rl0;
+    v2df_t bb   = rhi - rh0;
+    v2df_t rlo  = (rh0 - (rhi - bb)) + (rl0 - bb);
+    v2df_t r    = rhi + rlo;
+    v2df_t w    = kd * LN2_HI + logc;
+    v2df_t hi   = w + rhi;
+    v2df_t lo   = (w - hi) + rhi;
+    v2df_t shi  = (v2df_t)((v2du_t)rhi & (~0ULL << 27U));
+    v2df_t slo  = (rhi - shi) + rlo;
+    v2df_t sq   = -0.5 * shi * shi;
+    v2df_t sum  = hi + sq;
+    lo += (hi - sum) + sq;
+    hi = sum;
+    v2df_t r2 = r * r;
+    v2df_t p  = r2 * r *
+               ((1.0 / 3) - r * (1.0 / 4) + r2 * ((1.0 / 5) - r * (1.0 / 6)) +
+                r2 * r2 * ((1.0 / 7) - r * (1.0 / 8) + r2 * ((1.0 / 9) - r * (1.0 / 10))));
+    return hi + (lo + (kd * LN2_LO + tail + rlo - 0.5 * slo * (shi + r) + p));
+}
+
+/// @brief Computes the exponential of two values, with |x| <= VEXPF_MAX, with
+/// the precision needed by floats.
+/// @param x the arguments.
+/// @return the results.
+SSE2 static inline v2df_t __vexpf_kernel(v2df_t x)
+{
+    v2df_t z  = x * INV_LN2_N + SHIFT;
+    v2du_t ki = (v2du_t)z;
+    v2df_t kd = z - SHIFT;
+    v2df_t r  = x - kd * LN2_N;
+    v2df_t r2 = r * r;
+    v2df_t p  = 1.0 + r + r2 * (0.5 + r * (1.0 / 6)) + r2 * r2 * (1.0 / 24);
+    v2df_t t  = { __exp_table[ki[0] & (LIBM_TABLE_SIZE - 1)].hi, __exp_table[ki[1] & (LIBM_TABLE_SIZE - 1)].hi };
+    v2du_t scale = ((ki - __asuint64(SHIFT) + (0x3ffULL << 7U)) >> 7U) << 52U;
+    return t * p * (v2df_t)scale;
+}
+
+/// @brief Computes the logarithm of two positive normal values, which come
+/// from floats, with the precision needed by floats.
+/// @param x the arguments.
+/// @return the results.
+SSE2 static inline v2df_t __vlogf_kernel(v2df_t x)
+{
+    v2du_t ix   = (v2du_t)x;
+    v2du_t tmp  = ix - LOG_OFF;
+    v2df_t kd   = (v2df_t)(((tmp >> 52U) ^ 0x800U) | TWO52) - (0x1p52 + 0x800);
+    v2df_t z    = (v2df_t)(ix - (tmp & (0xfffULL << 52U)));
+    const log_entry_t *t0 = &__log_table[(tmp[0] >> 45U) & (LIBM_TABLE_SIZE - 1)];
+    const log_entry_t *t1 = &__log_table[(tmp[1] >> 45U) & (LIBM_TABLE_SIZE - 1)];
+    v2df_t invc = { t0->invc, t1->invc };
+    v2df_t logc = { t0->logc, t1->logc };
+    // The same steps of logf, see mathf.c.
+    v2df_t r    = z * invc - 1.0;
+    v2df_t r2   = r * r;
+    v2df_t p    = r2 * (-0.5 + r * (1.0 / 3)) + r2 * r2 * (-0.25 + r * (0.2 - r * (1.0 / 6)));
+    return (kd * LN2 + logc) + (r + p);
+}
+
+/// @brief Computes the sine, or the cosine, of two values.
+/// @param x the arguments, with |x| < VTRIG_MAX.
+/// @param cosine 1 for the cosine, 0 for the sine.
+/// @param res where the results are stored.
+/// @return 0 if some argument needs the full reduction, 1 otherwise.
+SSE2 static inline int __vsincos_kernel(v2df_t x, uint64_t cosine, v2df_t *res)
+{
+    v2df_t z  = x * INV_PIO2 + SHIFT;
+    v2du_t ni = (v2du_t)z;
+    v2df_t fn = z - SHIFT;
+    v2df_t r  = x - fn * PIO2_1;
+    v2df_t w  = fn * PIO2_1T;
+    v2df_t y0 = r - w;
+    v2df_t ax = (v2df_t)((v2du_t)x & ~SIGN_MASK);
+    v2df_t ay = (v2df_t)((v2du_t)y0 & ~SIGN_MASK);
+    // The scalar reduction takes more steps if more than 16 bits cancelled.
+    v2di_t ok = (ay * 65536.0 >= ax);
+    if (!(ok[0] & ok[1])) {
+        return 0;
+    }
+    v2df_t y1 = (r - y0) - w;
+    // The sine and cosine kernels of trig.c.
+    v2df_t zz = y0 * y0;
+    v2df_t v  = zz * y0;
+    v2df_t ww = zz * zz;
+    v2df_t sr = 8.33333333332248946124e-03 + zz * (-1.98412698298579493134e-04 + zz * 2.75573137070700676789e-06) +
+                zz * ww * (-2.50507602534068634195e-08 + zz * 1.58969099521155010221e-10);
+    v2df_t s  = y0 - ((zz * (0.5 * y1 - v * sr) - y1) - v * -1.66666666666666324348e-01);
+    v2df_t cr = zz * (4.16666666666666019037e-02 + zz * (-1.38888888888741095749e-03 + zz * 2.48015872894767294178e-05)) +
+                ww * ww * (-2.75573143513906633035e-07 + zz * (2.08757232129817482790e-09 + zz * -1.13596475577881948265e-11));
+    v2df_t hz = 0.5 * zz;
+    v2df_t c1 = 1.0 - hz;
+    v2df_t c  = c1 + (((1.0 - c1) - hz) + (zz * cr - y0 * y1));
+    // Select the kernel and the sign from the quadrant, cos(x) = sin(x + pi/2).
+    v2du_t q    = ni + cosine;
+    v2du_t swap = -(q & 1U);
+    v2du_t sign = (q & 2U) << 62U;
+    *res        = (v2df_t)((((v2du_t)s & ~swap) | ((v2du_t)c & swap)) ^ sign);
+    return 1;
+}
+
+/// @brief Processes the pairs of a batch of exponentials.
+/// @param dst the results.
+/// @param src the arguments.
+/// @param count the number of elements.
+/// @return the number of elements processed.
+SSE2 static size_t __vexp_sse2(double *dst, const double *src, size_t count)
+{
+    size_t i;
+    for (i = 0; i + 2 <= count; i += 2) {
+        v2df_t x  = { src[i], src[i + 1] };
+        v2di_t ok = ((v2df_t)((v2du_t)x & ~SIGN_MASK) <= VEXP_MAX);
+        if (ok[0] & ok[1]) {
+            v2df_t y   = __vexp_kernel(x);
+            dst[i]     = y[0];
+            dst[i + 1] = y[1];
+        } else {
+            dst[i]     = exp(x[0]);
+            dst[i + 1] = exp(x[1]);
+        }
+    }
+    return i;
+}
+
+/// @brief Processes the pairs of a batch of logarithms.
+/// @param dst the results.
+/// @param src the arguments.
+/// @param count the number of elements.
+/// @return the number of elements processed.
+SSE2 static size_t __vlog_sse2(double *dst, const double *src, size_t count)
+{
+    size_t i;
+    for (i = 0; i + 2 <= count; i += 2) {
+        v2df_t x  = { src[i], src[i + 1] };
+        v2di_t ok = (x >= 0x1p-1022) & (x < INFINITY);
+        if (ok[0] & ok[1]) {
+            v2df_t y   = __vlog_kernel(x);
+            dst[i]     = y[0];
+            dst[i + 1] = y[1];
+        } else {
+            dst[i]     = log(x[0]);
+            dst[i + 1] = log(x[1]);
+        }
+    }
+    return i;
+}
+
+/// @brief Processes the pairs of a batch of sines or cosines.
+/// @param dst the results.
+/// @param src the arguments.
+/// @param count the number of elements.
+/// @param cosine 1 for the cosine, 0 for the sine.
+/// @return the number of elements processed.
+SSE2 static size_t __vsincos_sse2(double *dst, const double *src, size_t count, int cosine)
+{
+    size_t i;
+    for (i = 0; i + 2 <= count; i += 2) {
+        v2df_t y, x = { src[i], src[i + 1] };
+        v2di_t ok = ((v2df_t)((v2du_t)x & ~SIGN_MASK) < VTRIG_MAX);
+        if ((ok[0] & ok[1]) && __vsincos_kernel(x, (uint64_t)cosine, &y)) {
+            dst[i]     = y[0];
+            dst[i + 1] = y[1];
+        } else {
+            dst[i]     = cosine ? cos(x[0]) : sin(x[0]);
+            dst[i + 1] = cosine ? cos(x[1]) : sin(x[1]);
+        }
+    }
+    return i;
+}
+
+/// @brief Processes the pairs of a batch of single precision exponentials.
+/// @param dst the results.
+/// @param src the arguments.
+/// @param count the number of elements.
+/// @return the number of elements processed.
+SSE2 static size_t __vexpf_sse2(float *dst, const float *src, size_t count)
+{
+    size_t i;
+    for (i = 0; i + 2 <= count; i += 2) {
+        v2df_t x  = { src[i], src[i + 1] };
+        v2di_t ok = ((v2df_t)((v2du_t)x & ~SIGN_MASK) <= VEXPF_MAX);
+        if (ok[0] & ok[1]) {
+            v2df_t y   = __vexpf_kernel(x);
+            dst[i]     = (float)y[0];
+            dst[i + 1] = (float)y[1];
+        } else {
+            dst[i]     = expf((float)x[0]);
+            dst[i + 1] = expf((float)x[1]);
+        }
+    }
+    return i;
+}
+
+/// @brief Processes the pairs of a batch of single precision logarithms.
+/// @param dst the results.
+/// @param src the arguments.
+/// @param count the number of elements.
+/// @return the number of elements processed.
+SSE2 static size_t __vlogf_sse2(float *dst, const float *src, size_t count)
+{
+    size_t i;
+    for (i = 0; i + 2 <= count; i += 2) {
+        v2df_t x  = { src[i], src[i + 1] };
+        // Subnormal floats are normal doubles.
+        v2di_t ok = (x > 0.0) & (x < INFINITY);
+        if (ok[0] & ok[1]) {
+            v2df_t y   = __vlogf_kernel(x);
+            dst[i]     = (float)y[0];
+            dst[i + 1] = (float)y[1];
+        } else {
+            dst[i]     = logf((float)x[0]);
+            dst[i + 1] = logf((float)x[1]);
+        }
+    }
+    return i;
+}
+
+/// @brief Processes the pairs of a batch of single precision sines or cosines.
+/// @param dst the results.
+/// @param src the arguments.
+/// @param count the number of elements.
+/// @param cosine 1 for the cosine, 0 for the sine.
+/// @return the number of elements processed.
+SSE2 static size_t __vsincosf_sse2(float *dst, const float *src, size_t count, int cosine)
+{
+    size_t i;
+    for (i = 0; i + 2 <= count; i += 2) {
+        v2df_t y, x = { src[i], src[i + 1] };
+        v2di_t ok = ((v2df_t)((v2du_t)x & ~SIGN_MASK) < VTRIG_MAX);
+        if ((ok[0] & ok[1]) && __vsincos_kernel(x, (uint64_t)cosine, &y)) {
+            dst[i]     = (float)y[0];
+            dst[i + 1] = (float)y[1];
+        } else {
+            dst[i]     = cosine ? cosf((float)x[0]) : sinf((float)x[0]);
+            dst[i + 1] = cosine ? cosf((float)x[1]) : sinf((float)x[1]);
+        }
+    }
+    return i;
+}
+
+void vexp(double *dst, const double *src, size_t count)
+{
+    size_t i = __has_sse2() ? __vexp_sse2(dst, src, count) : 0;
+    for (; i < count; ++i) {
+        dst[i] = exp(src[i]);
+    }
+}
+
+void vlog(double *dst, const double *src, size_t count)
+{
+    size_t i = __has_sse2() ? __vlog_sse2(dst, src, count) : 0;
+    for (; i < count; ++i) {
+        dst[i] = log(src[i]);
+    }
+}
+
+void vsin(double *dst, const double *src, size_t count)
+{
+    size_t i = __has_sse2() ? __vsincos_sse2(dst, src, count, 0) : 0;
+    for (; i < count; ++i) {
+        dst[i] = sin(src[i]);
+    }
+}
+
+void vcos(double *dst, const double *src, size_t count)
+{
+    size_t i = __has_sse2() ? __vsincos_sse2(dst, src, count, 1) : 0;
+    for (; i < count; ++i) {
+        dst[i] = cos(src[i]);
+    }
+}
+
+void vexpf(float *dst, const float *src, size_t count)
+{
+    size_t i = __has_sse2() ? __vexpf_sse2(dst, src, count) : 0;
+    for (; i < count; ++i) {
+        dst[i] = expf(src[i]);
+    }
+}
+
+void vlogf(float *dst, const float *src, size_t count)
+{
+    size_t i = __has_sse2() ? __vlogf_sse2(dst, src, count) : 0;
+    for (; i < count; ++i) {
+        dst[i] = logf(src[i]);
+    }
+}
+
+void vsinf(float *dst, const float *src, size_t count)
+{
+    size_t i = __has_sse2() ? __vsincosf_sse2(dst, src, count, 0) : 0;
+    for (; i < count; ++i) {
+        dst[i] = sinf(src[i]);
+    }
+}
+
+void vcosf(float *dst, const float *src, size_t count)
+{
+    size_t i = __has_sse2() ? __vsincosf_sse2(dst, src, count, 1) : 0;
+    for (; i < count; ++i) {
+        dst[i] = cosf(src[i]);
+    }
+}
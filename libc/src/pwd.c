@@ -1,184 +1,214 @@
 /// @file pwd.c
-/// @brief
+/// @brief Functions to access the password database.
+/// @details The database is read once, and kept in memory together with two
+/// hash indices, by name and by user ID. It is read again only when
+/// `/etc/passwd` changes, so that programs resolving many owners (e.g., `ls
+/// -l` and `ps`) do not scan the file at every lookup.
 /// @copyright (c) 2014-2024 This file is distributed under the MIT License.
 /// See LICENSE.md for details.
 
 #include "pwd.h"
 #include "assert.h"
+#include "bits/dbfile.h"
 #include "errno.h"
-#include "fcntl.h"
-#include "readline.h"
+#include "hashmap.h"
 #include "stdio.h"
+#include "stdlib.h"
 #include "string.h"
-#include "unistd.h"
+
+/// The number of buckets of the indices, a divisor of HASHMAP_SIZE.
+#define PWD_BUCKETS 64
+
+/// @brief An entry of the database, linked in the chains of the indices.
+typedef struct pwd_record {
+    passwd_t pwd;  ///< The entry, its strings point inside the content of the file.
+    int next_name; ///< The next entry in the same bucket of the index by name, -1 if none.
+    int next_uid;  ///< The next entry in the same bucket of the index by user ID, -1 if none.
+} pwd_record_t;
+
+/// @brief The database in memory.
+static struct {
+    dbfile_t file;            ///< The content of the file, with the fields terminated in place.
+    pwd_record_t *records;    ///< The entries.
+    int count;                ///< The number of entries.
+    int by_name[PWD_BUCKETS]; ///< The first entry of each bucket of the index by name, -1 if empty.
+    int by_uid[PWD_BUCKETS];  ///< The first entry of each bucket of the index by user ID, -1 if empty.
+} pwd_cache = { .file = { .data = NULL }, .records = NULL, .count = 0 };
 
 /// @brief Parses the input buffer and fills pwd with its details.
 /// @param pwd the structure we need to fill.
-/// @param buf the buffer from which we extract the information.
-static inline void __parse_line(passwd_t *pwd, char *buf)
+/// @param buf the buffer from which we extract the information, it is modified.
+/// @return 1 if the entry is complete, 0 otherwise.
+static inline int __parse_line(passwd_t *pwd, char *buf)
 {
     assert(pwd && "Received null pwd!");
-    char *token;
-    char *ch;
-    // Parse the username.
-    if ((token = strtok(buf, ":")) != NULL) {
-        pwd->pw_name = token;
-    }
-    // Parse the password.
-    if ((token = strtok(NULL, ":")) != NULL) {
-        pwd->pw_passwd = token;
+    char *fields[7];
+    // Split the line at the colons, the fields can be empty.
+    for (int i = 0; i < 7; ++i) {
+        fields[i] = buf;
+        buf       = strchr(buf, ':');
+        if (buf) {
+            *buf++ = 0;
+        } else if (i < 6) {
+            return 0;
+        } else {
+            break;
+        }
     }
-    // Parse the user ID.
-    if ((token = strtok(NULL, ":")) != NULL) {
-        pwd->pw_uid = atoi(token);
+    pwd->pw_name   = fields[0];
+    pwd->pw_passwd = fields[1];
+    pwd->pw_uid    = atoi(fields[2]);
+    pwd->pw_gid    = atoi(fields[3]);
+    pwd->pw_gecos  = fields[4];
+    pwd->pw_dir    = fields[5];
+    pwd->pw_shell  = fields[6];
+    return 1;
+}
+
+/// @brief Frees the database in memory.
+static inline void __pwd_cache_free(void)
+{
+    dbfile_free(&pwd_cache.file);
+    free(pwd_cache.records);
+    pwd_cache.records = NULL;
+    pwd_cache.count   = 0;
+}
+
+/// @brief Reads the database, unless the one in memory is up to date.
+/// @return 1 on success, 0 on failure.
+static int __pwd_cache_load(void)
+{
+    int lines;
+    int ret = dbfile_load(&pwd_cache.file, "/etc/passwd", &lines);
+    if (ret < 0) {
+        __pwd_cache_free();
+        return 0;
     }
-    // Parse the group ID.
-    if ((token = strtok(NULL, ":")) != NULL) {
-        pwd->pw_gid = atoi(token);
+    if (ret == 0) {
+        return 1;
     }
-    // Parse the user information.
-    if ((token = strtok(NULL, ":")) != NULL) {
-        pwd->pw_gecos = token;
+    // The file has changed, the entries are parsed again.
+    free(pwd_cache.records);
+    pwd_record_t *records = malloc(sizeof(pwd_record_t) * lines);
+    pwd_cache.records = records;
+    pwd_cache.count   = 0;
+    if (!records) {
+        dbfile_free(&pwd_cache.file);
+        return 0;
     }
-    // Parse the dir.
-    if ((token = strtok(NULL, ":")) != NULL) {
-        pwd->pw_dir = token;
+    for (int i = 0; i < PWD_BUCKETS; ++i) {
+        pwd_cache.by_name[i] = pwd_cache.by_uid[i] = -1;
     }
-    // Parse the shell.
-    if ((token = strtok(NULL, ":")) != NULL) {
-        pwd->pw_shell = token;
-        // Find carriege return.
-        if ((ch = strchr(pwd->pw_shell, '\r'))) {
-            *ch = 0;
-        }
-        // Find newline.
-        if ((ch = strchr(pwd->pw_shell, '\n'))) {
-            *ch = 0;
+    // Parse the lines, and index them. The entries are inserted at the head of
+    // the chains, so we go backward to find the first entry of the file first.
+    char *it = pwd_cache.file.data, *line;
+    while ((line = dbfile_next_line(&it))) {
+        pwd_record_t *record = &records[pwd_cache.count];
+        if (__parse_line(&record->pwd, line)) {
+            ++pwd_cache.count;
         }
     }
+    for (int i = pwd_cache.count - 1; i >= 0; --i) {
+        unsigned name_bucket           = hash(records[i].pwd.pw_name) % PWD_BUCKETS;
+        unsigned uid_bucket            = (unsigned)records[i].pwd.pw_uid % PWD_BUCKETS;
+        records[i].next_name           = pwd_cache.by_name[name_bucket];
+        records[i].next_uid            = pwd_cache.by_uid[uid_bucket];
+        pwd_cache.by_name[name_bucket] = i;
+        pwd_cache.by_uid[uid_bucket]   = i;
+    }
+    return 1;
 }
 
-/// @brief Searches for the given entry inside the buffer.
-/// @param fd the file descriptor of the file.
-/// @param buffer the support buffer we use to read the file.
-/// @param buflen the length of the support buffer.
-/// @param name the username we are looking for.
+/// @brief Searches for the given entry inside the database.
+/// @param name the username we are looking for, or NULL to search by uid.
 /// @param uid the user-id of the user we are looking for.
-/// @return the buffer itself if we have found the entry, NULL otherwise.
-static inline char *__search_entry(int fd, char *buffer, int buflen, const char *name, uid_t uid)
+/// @return the entry, NULL if it is not there.
+static inline passwd_t *__search_entry(const char *name, uid_t uid)
 {
-    while (readline(fd, buffer, buflen, NULL) != 0) {
-        if (name != NULL) {
-            char *name_end = strchr(buffer, ':');
-            if (name_end) {
-                *name_end = '\0';
-                if (strlen(name) == strlen(buffer) && strncmp(buffer, name, strlen(name)) == 0) {
-                    *name_end = ':';
-                    return buffer;
-                }
-            }
-        } else {
-            // Name
-            char *ptr = strchr(buffer, ':');
-            if (ptr == NULL) {
-                continue;
-            }
-            // Password
-            ++ptr;
-            char *uid_start = strchr(ptr, ':');
-            if (uid_start == NULL) {
-                continue;
-            }
-            ++uid_start;
-            ptr = strchr(uid_start, ':');
-            if (ptr == NULL) {
-                continue;
+    if (!__pwd_cache_load()) {
+        return NULL;
+    }
+    if (name != NULL) {
+        for (int i = pwd_cache.by_name[hash(name) % PWD_BUCKETS]; i != -1; i = pwd_cache.records[i].next_name) {
+            if (strcmp(pwd_cache.records[i].pwd.pw_name, name) == 0) {
+                return &pwd_cache.records[i].pwd;
             }
-            *ptr          = '\0';
-            // Parse the uid.
-            int found_uid = atoi(uid_start);
-            // Check the uid.
-            if (found_uid == uid) {
-                *ptr = ':';
-                return buffer;
+        }
+    } else {
+        for (int i = pwd_cache.by_uid[(unsigned)uid % PWD_BUCKETS]; i != -1; i = pwd_cache.records[i].next_uid) {
+            if (pwd_cache.records[i].pwd.pw_uid == uid) {
+                return &pwd_cache.records[i].pwd;
             }
         }
     }
     return NULL;
 }
 
+/// @brief Copies the entry of the database inside the structure of the caller.
+/// @param entry the entry, NULL if not found.
+/// @param pwd the structure of the caller.
+/// @param buf the buffer where the strings are stored.
+/// @param buflen the length of the buffer.
+/// @param result where we place pwd, or NULL.
+/// @return 0 on success or if not found, ERANGE if the buffer is too small.
+static inline int __copy_entry(passwd_t *entry, passwd_t *pwd, char *buf, size_t buflen, passwd_t **result)
+{
+    *result = NULL;
+    if (entry == NULL) {
+        return 0;
+    }
+    pwd->pw_uid = entry->pw_uid;
+    pwd->pw_gid = entry->pw_gid;
+    if (!dbfile_copy_field(&pwd->pw_name, entry->pw_name, &buf, &buflen) ||
+        !dbfile_copy_field(&pwd->pw_passwd, entry->pw_passwd, &buf, &buflen) ||
+        !dbfile_copy_field(&pwd->pw_gecos, entry->pw_gecos, &buf, &buflen) ||
+        !dbfile_copy_field(&pwd->pw_dir, entry->pw_dir, &buf, &buflen) ||
+        !dbfile_copy_field(&pwd->pw_shell, entry->pw_shell, &buf, &buflen)) {
+        return ERANGE;
+    }
+    *result = pwd;
+    return 0;
+}
+
 passwd_t *getpwnam(const char *name)
 {
     if (name == NULL) {
         return NULL;
     }
     static passwd_t pwd;
-    static char buffer[BUFSIZ];
-    passwd_t *result;
-    if (!getpwnam_r(name, &pwd, buffer, BUFSIZ, &result)) {
+    passwd_t *entry = __search_entry(name, 0);
+    if (entry == NULL) {
+        errno = ENOENT;
         return NULL;
     }
+    // The caller gets its own copy of the pointers, the strings stay in the cache.
+    pwd = *entry;
     return &pwd;
 }
 
 passwd_t *getpwuid(uid_t uid)
 {
     static passwd_t pwd;
-    static char buffer[BUFSIZ];
-    passwd_t *result;
-    if (!getpwuid_r(uid, &pwd, buffer, BUFSIZ, &result)) {
+    passwd_t *entry = __search_entry(NULL, uid);
+    if (entry == NULL) {
+        errno = ENOENT;
         return NULL;
     }
+    // The caller gets its own copy of the pointers, the strings stay in the cache.
+    pwd = *entry;
     return &pwd;
 }
 
 int getpwnam_r(const char *name, passwd_t *pwd, char *buf, size_t buflen, passwd_t **result)
 {
     if (name == NULL) {
-        return 0;
-    }
-    int fd = open("/etc/passwd", O_RDONLY, 0);
-    if (fd == -1) {
-        perror("Cannot open `/etc/passwd`\n");
-        errno   = ENOENT;
         *result = NULL;
-        return 0;
-    }
-    char *entry = __search_entry(fd, buf, buflen, name, 0);
-    if (entry != NULL) {
-        // Close the file.
-        close(fd);
-        // Parse the line.
-        __parse_line(pwd, entry);
-        // Return success.
-        return 1;
+        return EINVAL;
     }
-    errno = ENOENT;
-    // Close the file.
-    close(fd);
-    // Return fail.
-    return 0;
+    return __copy_entry(__search_entry(name, 0), pwd, buf, buflen, result);
 }
 
 int getpwuid_r(uid_t uid, passwd_t *pwd, char *buf, size_t buflen, passwd_t **result)
 {
-    int fd = open("/etc/passwd", O_RDONLY, 0);
-    if (fd == -1) {
-        errno   = ENOENT;
-        *result = NULL;
-        return 0;
-    }
-    char *entry = __search_entry(fd, buf, buflen, NULL, uid);
-    if (entry != NULL) {
-        // Close the file.
-        close(fd);
-        // Parse the line.
-        __parse_line(pwd, entry);
-        // Return success.
-        return 1;
-    }
-    // Close the file.
-    close(fd);
-    // Return fail.
-    return 0;
+    return __copy_entry(__search_entry(NULL, uid), pwd, buf, buflen, result);
 }
@@ -23,6 +23,22 @@ int sched_getparam(pid_t pid, sched_param_t *param)
     __syscall_return(int, __res);
 }
 
+// _syscall3(int, sched_setscheduler, pid_t, pid, int, policy, const sched_param_t *, param)
+int sched_setscheduler(pid_t pid, int policy, const sched_param_t *param)
+{
+    long __res;
+    __inline_syscall_3(__res, sched_setscheduler, pid, policy, param);
+    __syscall_return(int, __res);
+}
+
+// _syscall1(int, sched_getscheduler, pid_t, pid)
+int sched_getscheduler(pid_t pid)
+{
+    long __res;
+    __inline_syscall_1(__res, sched_getscheduler, pid);
+    __syscall_return(int, __res);
+}
+
 // _syscall0(int, waitperiod)
 int waitperiod(void)
 {
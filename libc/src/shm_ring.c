@@ -0,0 +1,338 @@
+/// @file shm_ring.c
+/// @brief Lock-free ring buffers living in shared memory segments.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "shm_ring.h"
+#include "errno.h"
+#include "string.h"
+#include "sys/ipc.h"
+#include "sys/sem.h"
+#include "sys/shm.h"
+#include "time.h"
+
+/// Tells that the ring has been initialized ("RING").
+#define SHM_RING_MAGIC 0x474E4952
+
+/// The semaphore of the producers waiting for room.
+#define SHM_RING_SEM_SPACE 0
+/// The semaphore of the consumers waiting for elements.
+#define SHM_RING_SEM_ITEMS 1
+
+/// How many times we check an index before leaving the CPU.
+#define SHM_RING_SPINS 64
+
+/// @brief Waits for an index to be moved by another process.
+/// @param spins how many times we have been waiting so far, it is updated.
+static inline void __shm_ring_relax(unsigned *spins)
+{
+    if (++(*spins) < SHM_RING_SPINS) {
+        __asm__ __volatile__("pause" ::: "memory");
+        return;
+    }
+    // There is a single CPU, the other process moves the index only if we
+    // leave it: sleeping until the next tick lets it run.
+    const struct timespec req = {0, 0};
+    nanosleep(&req, NULL);
+    *spins = 0;
+}
+
+/// @brief Reserves positions on one side of the ring, by moving its head.
+/// @param ring the ring.
+/// @param side the side reserving the positions.
+/// @param other the other side, whose tail bounds the reservation.
+/// @param offset the capacity for the producers, 0 for the consumers.
+/// @param n the number of positions we want.
+/// @param all if set, either all the positions are reserved or none.
+/// @param head where the first reserved position is stored.
+/// @return the number of reserved positions.
+static inline unsigned __shm_ring_move_head(
+    shm_ring_t *ring,
+    shm_ring_side_t *side,
+    const shm_ring_side_t *other,
+    uint32_t offset,
+    unsigned n,
+    int all,
+    uint32_t *head)
+{
+    uint32_t available;
+    unsigned count;
+    *head = __atomic_load_n(&side->head, __ATOMIC_RELAXED);
+    do {
+        // The positions up to the tail of the other side are complete.
+        available = offset + __atomic_load_n(&other->tail, __ATOMIC_ACQUIRE) - *head;
+        count     = (n <= available) ? n : (all ? 0 : available);
+        if (count == 0) {
+            return 0;
+        }
+        // A single process per side owns the head.
+        if (!(ring->flags & SHM_RING_MPMC)) {
+            __atomic_store_n(&side->head, *head + count, __ATOMIC_RELAXED);
+            return count;
+        }
+    } while (!__atomic_compare_exchange_n(&side->head, head, *head + count, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return count;
+}
+
+/// @brief Publishes the positions reserved on one side, by moving its tail.
+/// @param ring the ring.
+/// @param side the side which reserved the positions.
+/// @param head the first reserved position.
+/// @param n the number of reserved positions.
+static inline void __shm_ring_update_tail(shm_ring_t *ring, shm_ring_side_t *side, uint32_t head, unsigned n)
+{
+    // Wait for the processes which reserved their positions before us.
+    if (ring->flags & SHM_RING_MPMC) {
+        for (unsigned spins = 0; __atomic_load_n(&side->tail, __ATOMIC_RELAXED) != head;) {
+            __shm_ring_relax(&spins);
+        }
+    }
+    // The copy of the elements is complete before the tail moves.
+    __atomic_store_n(&side->tail, head + n, __ATOMIC_RELEASE);
+}
+
+/// @brief Wakes up the processes waiting on one side of the ring.
+/// @param ring the ring.
+/// @param side the side of the waiting processes.
+/// @param sem the semaphore they are sleeping on.
+static inline void __shm_ring_wake(shm_ring_t *ring, shm_ring_side_t *side, unsigned short sem)
+{
+    if (!(ring->flags & SHM_RING_BLOCK)) {
+        return;
+    }
+    // Pairs with the increment in __shm_ring_wait: either the waiter sees the
+    // tail we have just moved, or we see the waiter.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&side->waiters, __ATOMIC_RELAXED) == 0) {
+        return;
+    }
+    unsigned waiters = __atomic_exchange_n(&side->waiters, 0, __ATOMIC_SEQ_CST);
+    if (waiters) {
+        struct sembuf op = {sem, (short)waiters, 0};
+        semop(ring->semid, &op, 1);
+    }
+}
+
+/// @brief Waits until the other side of the ring transfers some elements.
+/// @param ring the ring.
+/// @param side the side of the calling process.
+/// @param sem the semaphore the side sleeps on.
+/// @param ready returns how many elements the calling process can transfer.
+/// @return 0 on success, -1 on failure and errno is set to indicate the error.
+static int __shm_ring_wait(
+    shm_ring_t *ring,
+    shm_ring_side_t *side,
+    unsigned short sem,
+    unsigned (*ready)(const shm_ring_t *))
+{
+    unsigned spins = 0;
+    if (!(ring->flags & SHM_RING_BLOCK)) {
+        while (!ready(ring)) {
+            __shm_ring_relax(&spins);
+        }
+        return 0;
+    }
+    __atomic_add_fetch(&side->waiters, 1, __ATOMIC_SEQ_CST);
+    // Check again, the other side might have moved before seeing us. If so,
+    // a later wakeup finds the semaphore already raised, which is harmless.
+    if (ready(ring)) {
+        return 0;
+    }
+    struct sembuf op = {sem, -1, 0};
+    while (semop(ring->semid, &op, 1) < 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/// @brief Copies the elements inside the ring.
+/// @param ring the ring.
+/// @param pos the first position.
+/// @param elems the elements.
+/// @param n the number of elements.
+static inline void __shm_ring_copy_in(shm_ring_t *ring, uint32_t pos, const uint8_t *elems, unsigned n)
+{
+    uint32_t index = pos & ring->mask;
+    unsigned first = (n < ring->capacity - index) ? n : (ring->capacity - index);
+    memcpy(ring->data + index * ring->size, elems, first * ring->size);
+    memcpy(ring->data, elems + first * ring->size, (n - first) * ring->size);
+}
+
+/// @brief Copies the elements outside the ring.
+/// @param ring the ring.
+/// @param pos the first position.
+/// @param elems where the elements are stored.
+/// @param n the number of elements.
+static inline void __shm_ring_copy_out(const shm_ring_t *ring, uint32_t pos, uint8_t *elems, unsigned n)
+{
+    uint32_t index = pos & ring->mask;
+    unsigned first = (n < ring->capacity - index) ? n : (ring->capacity - index);
+    memcpy(elems, ring->data + index * ring->size, first * ring->size);
+    memcpy(elems + first * ring->size, ring->data, (n - first) * ring->size);
+}
+
+/// @brief Adds elements to the ring.
+/// @param ring the ring.
+/// @param elems the elements.
+/// @param n the number of elements.
+/// @param all if set, either all the elements are added or none.
+/// @return the number of elements added.
+static inline unsigned __shm_ring_enqueue(shm_ring_t *ring, const void *elems, unsigned n, int all)
+{
+    uint32_t head;
+    n = __shm_ring_move_head(ring, &ring->prod, &ring->cons, ring->capacity, n, all, &head);
+    if (n) {
+        __shm_ring_copy_in(ring, head, elems, n);
+        __shm_ring_update_tail(ring, &ring->prod, head, n);
+        __shm_ring_wake(ring, &ring->cons, SHM_RING_SEM_ITEMS);
+    }
+    return n;
+}
+
+/// @brief Removes elements from the ring.
+/// @param ring the ring.
+/// @param elems where the elements are stored.
+/// @param n the number of elements.
+/// @param all if set, either n elements are removed or none.
+/// @return the number of elements removed.
+static inline unsigned __shm_ring_dequeue(shm_ring_t *ring, void *elems, unsigned n, int all)
+{
+    uint32_t head;
+    n = __shm_ring_move_head(ring, &ring->cons, &ring->prod, 0, n, all, &head);
+    if (n) {
+        __shm_ring_copy_out(ring, head, elems, n);
+        __shm_ring_update_tail(ring, &ring->cons, head, n);
+        __shm_ring_wake(ring, &ring->prod, SHM_RING_SEM_SPACE);
+    }
+    return n;
+}
+
+shm_ring_t *shm_ring_create(key_t key, unsigned capacity, size_t size, int flags)
+{
+    if ((capacity == 0) || (capacity & (capacity - 1)) || (size == 0) ||
+        (flags & ~(SHM_RING_MPMC | SHM_RING_BLOCK))) {
+        errno = EINVAL;
+        return NULL;
+    }
+    int shmid = shmget(key, sizeof(shm_ring_t) + capacity * size, IPC_CREAT | IPC_EXCL | 0600);
+    if (shmid < 0) {
+        return NULL;
+    }
+    shm_ring_t *ring = shmat(shmid, NULL, 0);
+    if (ring == (shm_ring_t *)-1) {
+        shmctl(shmid, IPC_RMID, NULL);
+        return NULL;
+    }
+    memset(ring, 0, sizeof(shm_ring_t));
+    ring->flags    = flags;
+    ring->capacity = capacity;
+    ring->mask     = capacity - 1;
+    ring->size     = size;
+    ring->shmid    = shmid;
+    ring->semid    = -1;
+    if (flags & SHM_RING_BLOCK) {
+        union semun arg = {.val = 0};
+        ring->semid     = semget(IPC_PRIVATE, 2, IPC_CREAT | 0600);
+        if ((ring->semid < 0) || (semctl(ring->semid, SHM_RING_SEM_SPACE, SETVAL, &arg) < 0) ||
+            (semctl(ring->semid, SHM_RING_SEM_ITEMS, SETVAL, &arg) < 0)) {
+            int error = errno;
+            shm_ring_destroy(ring);
+            errno = error;
+            return NULL;
+        }
+    }
+    // The ring can be used once the magic is there.
+    __atomic_store_n(&ring->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+    return ring;
+}
+
+shm_ring_t *shm_ring_attach(key_t key)
+{
+    int shmid = shmget(key, 0, 0600);
+    if (shmid < 0) {
+        return NULL;
+    }
+    shm_ring_t *ring = shmat(shmid, NULL, 0);
+    if (ring == (shm_ring_t *)-1) {
+        return NULL;
+    }
+    if (__atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC) {
+        shmdt(ring);
+        errno = EINVAL;
+        return NULL;
+    }
+    return ring;
+}
+
+int shm_ring_detach(shm_ring_t *ring) { return (shmdt(ring) < 0) ? -1 : 0; }
+
+int shm_ring_destroy(shm_ring_t *ring)
+{
+    int shmid = ring->shmid, semid = ring->semid;
+    if (semid >= 0) {
+        semctl(semid, 0, IPC_RMID, NULL);
+    }
+    if (shmdt(ring) < 0) {
+        return -1;
+    }
+    return (shmctl(shmid, IPC_RMID, NULL) < 0) ? -1 : 0;
+}
+
+unsigned shm_ring_count(const shm_ring_t *ring)
+{
+    return __atomic_load_n(&ring->prod.tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->cons.head, __ATOMIC_RELAXED);
+}
+
+unsigned shm_ring_free_count(const shm_ring_t *ring)
+{
+    return ring->capacity + __atomic_load_n(&ring->cons.tail, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&ring->prod.head, __ATOMIC_RELAXED);
+}
+
+unsigned shm_ring_enqueue_bulk(shm_ring_t *ring, const void *elems, unsigned n)
+{
+    return __shm_ring_enqueue(ring, elems, n, 1);
+}
+
+unsigned shm_ring_enqueue_burst(shm_ring_t *ring, const void *elems, unsigned n)
+{
+    return __shm_ring_enqueue(ring, elems, n, 0);
+}
+
+int shm_ring_enqueue_wait(shm_ring_t *ring, const void *elems, unsigned n)
+{
+    const uint8_t *ptr = elems;
+    for (unsigned done = 0; done < n;) {
+        unsigned count = __shm_ring_enqueue(ring, ptr + done * ring->size, n - done, 0);
+        if ((count == 0) && (__shm_ring_wait(ring, &ring->prod, SHM_RING_SEM_SPACE, shm_ring_free_count) < 0)) {
+            return -1;
+        }
+        done += count;
+    }
+    return (int)n;
+}
+
+unsigned shm_ring_dequeue_bulk(shm_ring_t *ring, void *elems, unsigned n)
+{
+    return __shm_ring_dequeue(ring, elems, n, 1);
+}
+
+unsigned shm_ring_dequeue_burst(shm_ring_t *ring, void *elems, unsigned n)
+{
+    return __shm_ring_dequeue(ring, elems, n, 0);
+}
+
+int shm_ring_dequeue_wait(shm_ring_t *ring, void *elems, unsigned n)
+{
+    uint8_t *ptr = elems;
+    for (unsigned done = 0; done < n;) {
+        unsigned count = __shm_ring_dequeue(ring, ptr + done * ring->size, n - done, 0);
+        if ((count == 0) && (__shm_ring_wait(ring, &ring->cons, SHM_RING_SEM_ITEMS, shm_ring_count) < 0)) {
+            return -1;
+        }
+        done += count;
+    }
+    return (int)n;
+}
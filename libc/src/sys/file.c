@@ -0,0 +1,15 @@
+/// @file file.c
+/// @brief Advisory locks on whole files.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "sys/file.h"
+#include "errno.h"
+#include "system/syscall_types.h"
+
+int flock(int fd, int operation)
+{
+    int __res;
+    __inline_syscall_2(__res, flock, fd, operation);
+    __syscall_return(int, __res);
+}
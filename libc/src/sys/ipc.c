@@ -80,27 +80,15 @@ int msgctl(int msqid, int cmd, struct msqid_ds *buf)
 int msgsnd(int msqid, const void *msgp, size_t msgsz, int msgflg)
 {
     long __res;
-    do {
-        __inline_syscall_4(__res, msgsnd, msqid, msgp, msgsz, msgflg);
-        if (!(msgflg & IPC_NOWAIT) && (__res == -EAGAIN)) {
-            continue;
-        }
-        break;
-    } while (1);
+    __inline_syscall_4(__res, msgsnd, msqid, msgp, msgsz, msgflg);
     __syscall_return(int, __res);
 }
 
 ssize_t msgrcv(int msqid, void *msgp, size_t msgsz, long msgtyp, int msgflg)
 {
     long __res;
-    do {
-        __inline_syscall_5(__res, msgrcv, msqid, msgp, msgsz, msgtyp, msgflg);
-        if (!(msgflg & IPC_NOWAIT) && ((__res == -EAGAIN) || (__res == -ENOMSG))) {
-            continue;
-        }
-        break;
-    } while (1);
-    __syscall_return(int, __res);
+    __inline_syscall_5(__res, msgrcv, msqid, msgp, msgsz, msgtyp, msgflg);
+    __syscall_return(ssize_t, __res);
 }
 
 long semop(int semid, struct sembuf *sops, unsigned nsops)
@@ -126,23 +114,12 @@ long semop(int semid, struct sembuf *sops, unsigned nsops)
     for (size_t i = 0; i < nsops; i++) {
         // Get the operation.
         op = &sops[i];
-        // The process continues to try to perform the operation until it completes
-        // or receives an error.
-        while (1) {
-            // Calling the kernel-side function.
-            __inline_syscall_3(__res, semop, semid, op, 1);
-
-            // If we get an error, the operation has been taken care of we stop
-            // the loop. We also stop the loop if the operation is not allowed
-            // and the IPC_NOWAIT flag is 1
-            if ((__res != -EAGAIN) || (op->sem_flg & IPC_NOWAIT)) {
-                break;
-            }
-        }
-        // If the operation couldn't be performed and we had the IPC_NOWAIT set
-        // to 1 then we return.
-        if ((__res == -EAGAIN) && (op->sem_flg & IPC_NOWAIT)) {
-            errno = EAGAIN;
+        // Calling the kernel-side function, which sleeps until the operation
+        // can be performed, unless the IPC_NOWAIT flag is set.
+        __inline_syscall_3(__res, semop, semid, op, 1);
+        // If the operation couldn't be performed, we return.
+        if (__res < 0) {
+            errno = -__res;
             return -1;
         }
     }
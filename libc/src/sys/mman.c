@@ -8,6 +8,30 @@
 #include "system/syscall_types.h"
 #include "unistd.h"
 
+// _syscall3(int, madvise, void *, addr, size_t, length, int, advice)
+int madvise(void *addr, size_t length, int advice)
+{
+    long __res;
+    __inline_syscall_3(__res, madvise, addr, length, advice);
+    __syscall_return(int, __res);
+}
+
+// _syscall2(int, mlock, const void *, addr, size_t, length)
+int mlock(const void *addr, size_t length)
+{
+    long __res;
+    __inline_syscall_2(__res, mlock, addr, length);
+    __syscall_return(int, __res);
+}
+
+// _syscall2(int, munlock, const void *, addr, size_t, length)
+int munlock(const void *addr, size_t length)
+{
+    long __res;
+    __inline_syscall_2(__res, munlock, addr, length);
+    __syscall_return(int, __res);
+}
+
 #if 0
 
 // _syscall6(void *, mmap, void *, addr, size_t, length, int, prot, int, flags, int, fd, off_t, offset)
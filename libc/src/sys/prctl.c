@@ -0,0 +1,15 @@
+/// @file prctl.c
+/// @brief Operations on the calling process.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "sys/prctl.h"
+#include "errno.h"
+#include "system/syscall_types.h"
+
+int prctl(int option, unsigned long arg2)
+{
+    long __res;
+    __inline_syscall_2(__res, prctl, option, arg2);
+    __syscall_return(int, __res);
+}
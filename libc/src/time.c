@@ -6,6 +6,7 @@
 #include "time.h"
 #include "errno.h"
 #include "stdio.h"
+#include "stdlib.h"
 #include "string.h"
 #include "system/syscall_types.h"
 
@@ -39,6 +40,34 @@ time_t time(time_t *t)
     __syscall_return(time_t, __res);
 }
 
+int clock_gettime(clockid_t clockid, struct timespec *tp)
+{
+    long __res;
+    __inline_syscall_2(__res, clock_gettime, clockid, tp);
+    __syscall_return(int, __res);
+}
+
+int gettimeofday(struct timeval *tv, void *tz)
+{
+    long __res;
+    __inline_syscall_2(__res, gettimeofday, tv, tz);
+    __syscall_return(int, __res);
+}
+
+int settimeofday(const struct timeval *tv, const void *tz)
+{
+    long __res;
+    __inline_syscall_2(__res, settimeofday, tv, tz);
+    __syscall_return(int, __res);
+}
+
+int adjtime(const struct timeval *delta, struct timeval *olddelta)
+{
+    long __res;
+    __inline_syscall_2(__res, adjtime, delta, olddelta);
+    __syscall_return(int, __res);
+}
+
 time_t difftime(time_t time1, time_t time2) { return time1 - time2; }
 
 char *ctime(const time_t *timer)
@@ -105,7 +134,45 @@ static inline int day_of_week(unsigned int y, unsigned int m, unsigned int d)
     return ((h + 5) % 7) + 1;
 }
 
+long timezone = 0;
+
+void tzset(void)
+{
+    const char *tz = getenv("TZ");
+    long hours = 0, minutes = 0, sign = 1;
+    timezone   = 0;
+    if (tz == NULL) {
+        return;
+    }
+    // Skip the name of the timezone.
+    while ((*tz != '\0') && (*tz != '+') && (*tz != '-') && ((*tz < '0') || (*tz > '9'))) {
+        ++tz;
+    }
+    if ((*tz == '+') || (*tz == '-')) {
+        sign = (*tz == '-') ? -1 : 1;
+        ++tz;
+    }
+    while ((*tz >= '0') && (*tz <= '9')) {
+        hours = (hours * 10) + (*tz++ - '0');
+    }
+    if (*tz == ':') {
+        ++tz;
+        while ((*tz >= '0') && (*tz <= '9')) {
+            minutes = (minutes * 10) + (*tz++ - '0');
+        }
+    }
+    // The offset is the one to add to the local time to get UTC.
+    timezone = sign * ((hours * 3600) + (minutes * 60));
+}
+
 tm_t *localtime(const time_t *time)
+{
+    tzset();
+    time_t t = *time - (time_t)timezone;
+    return gmtime(&t);
+}
+
+tm_t *gmtime(const time_t *time)
 {
     static tm_t date;
     unsigned int a;
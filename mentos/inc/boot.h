@@ -7,6 +7,21 @@
 
 #include "multiboot.h"
 
+/// The maximum number of memory nodes (NUMA).
+#define MAX_NUMNODES 8
+/// The maximum number of memory ranges associated to the nodes.
+#define MAX_NUMA_RANGES 16
+
+/// @brief A range of physical memory, and the node it is local to.
+typedef struct boot_numa_range_t {
+    /// node of the range
+    unsigned int node;
+    /// range physical start
+    unsigned int phy_start;
+    /// range physical end
+    unsigned int phy_end;
+} boot_numa_range_t;
+
 /// @brief Mentos structure to communicate bootloader info to the kernel
 typedef struct boot_info_t {
     /// Boot magic number.
@@ -77,6 +92,22 @@ typedef struct boot_info_t {
     /// multiboot info
     multiboot_info_t *multiboot_header;
 
+    /*
+     * NUMA topology, from the ACPI SRAT and SLIT tables
+     * if the firmware does not provide them, there is a single node
+     * */
+
+    /// number of memory nodes, 0 if unknown
+    unsigned int numa_nodes;
+    /// node of the boot processor
+    unsigned int numa_cpu_node;
+    /// number of memory ranges
+    unsigned int numa_nr_ranges;
+    /// memory ranges and their nodes
+    boot_numa_range_t numa_ranges[MAX_NUMA_RANGES];
+    /// distances between the nodes, 10 is the distance of a node from itself
+    unsigned char numa_distance[MAX_NUMNODES][MAX_NUMNODES];
+
     /// stack suggested start address (also set by the bootloader)
     unsigned int stack_base;
 } boot_info_t;
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "kernel.h"
+#include "stddef.h"
 
 // TODO: see interrupt_handler_t in Linux, it is quite different.
 /// @brief      Interrupt handler definition.
@@ -64,6 +65,35 @@ int irq_uninstall_handler(unsigned i, interrupt_handler_t handler);
 /// @param f The interrupt stack frame.
 extern void irq_handler(pt_regs *f);
 
+/// @brief Deferred activities (bottom halves) for which we keep statistics.
+typedef enum softirq_t {
+    TIMER_SOFTIRQ, ///< Expiration of the dynamic timers.
+    NR_SOFTIRQS    ///< The number of deferred activities.
+} softirq_t;
+
+/// @brief Accounts one execution of a deferred activity.
+/// @param nr the deferred activity.
+/// @param cycles the CPU cycles it took.
+void softirq_account(softirq_t nr, uint64_t cycles);
+
+/// @brief Writes the statistics of the IRQ lines and of their handlers.
+/// @param buffer the buffer where we write.
+/// @param bufsize the size of the buffer.
+/// @return the number of characters we wrote.
+ssize_t irq_print_stats(char *buffer, size_t bufsize);
+
+/// @brief Writes the statistics of the exceptions and system calls.
+/// @param buffer the buffer where we write.
+/// @param bufsize the size of the buffer.
+/// @return the number of characters we wrote.
+ssize_t isr_print_stats(char *buffer, size_t bufsize);
+
+/// @brief Writes the statistics of the deferred activities.
+/// @param buffer the buffer where we write.
+/// @param bufsize the size of the buffer.
+/// @return the number of characters we wrote.
+ssize_t softirq_print_stats(char *buffer, size_t bufsize);
+
 //==== List of exceptions generated internally by the CPU ======================
 #define DIVIDE_ERROR        0  ///< DE Divide Error.
 #define DEBUG_EXC           1  ///< DB Debug.
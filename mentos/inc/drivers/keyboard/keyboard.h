@@ -40,6 +40,10 @@ int keyboard_peek_back(void);
 /// @return The read character.
 int keyboard_peek_front(void);
 
+/// @brief Puts the current process to sleep until a key is pressed.
+/// @return 0 on success, -EINTR if interrupted by a signal, -1 on failure.
+int keyboard_wait(void);
+
 /// @brief Initializes the keyboard drivers.
 /// @return 0 on success, 1 on error.
 int keyboard_initialize(void);
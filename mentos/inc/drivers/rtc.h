@@ -13,11 +13,8 @@
 
 #include "time.h"
 
-/// @brief Copies the global time inside the provided variable.
-/// @param time Pointer where we store the global time.
-extern void gettime(tm_t *time);
-
-/// @brief Initializes the Real Time Clock (RTC).
+/// @brief Initializes the Real Time Clock (RTC), by reading the time once
+/// and setting the wall clock kept by the timer.
 /// @return 0 on success, 1 on error.
 int rtc_initialize(void);
 
@@ -0,0 +1,73 @@
+/// @file locks.h
+/// @brief Advisory file locks: POSIX record locks (fcntl) and whole-file locks (flock).
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#pragma once
+
+#include "fcntl.h"
+#include "fs/vfs_types.h"
+#include "process/wait.h"
+
+/// @brief The lock was placed with fcntl.
+#define FL_POSIX 1
+/// @brief The lock was placed with flock.
+#define FL_FLOCK 2
+
+/// @brief A lock on a range of bytes of a file.
+typedef struct file_lock {
+    /// Link inside the locks of the file, sorted by starting offset.
+    list_head list;
+    /// The process owning the lock.
+    pid_t pid;
+    /// The type of lock, either F_RDLCK or F_WRLCK.
+    int type;
+    /// How the lock was placed, either FL_POSIX or FL_FLOCK.
+    int flags;
+    /// The first locked byte.
+    off_t start;
+    /// The last locked byte, OFFSET_MAX if the lock extends to the end of the file.
+    off_t end;
+} file_lock_t;
+
+/// @brief The locks of a file, allocated when the file is first locked.
+typedef struct file_lock_context {
+    /// The locks, sorted by starting offset.
+    list_head locks;
+    /// The processes waiting for a lock to be released.
+    wait_queue_head_t wait;
+    /// Link inside the list of all the lock contexts.
+    list_head list;
+} file_lock_context_t;
+
+/// @brief Handles the F_GETLK, F_SETLK and F_SETLKW commands of fcntl.
+/// @param file the file.
+/// @param flags_mask the flags the file descriptor was opened with.
+/// @param request the command.
+/// @param lock the lock description, provided by the user.
+/// @return 0 on success, -EAGAIN if the lock is held by another process
+/// (F_SETLKW sleeps before returning it, and the call must be repeated),
+/// -EDEADLK if waiting would cause a deadlock, or another negative error.
+long fcntl_lock(vfs_file_t *file, int flags_mask, unsigned int request, flock_t *lock);
+
+/// @brief Handles the flock system call.
+/// @param file the file.
+/// @param operation the operation (LOCK_SH, LOCK_EX, LOCK_UN, and LOCK_NB).
+/// @return 0 on success, -EAGAIN if the lock is held by another process
+/// (without LOCK_NB, it sleeps before returning it, and the call must be
+/// repeated), -EDEADLK if waiting would cause a deadlock, or another
+/// negative error.
+int flock_lock(vfs_file_t *file, int operation);
+
+/// @brief Releases the locks of the current process on a file, when it
+/// closes one of its descriptors.
+/// @param file the file.
+void locks_remove_file(vfs_file_t *file);
+
+/// @brief Releases all the locks of an exiting process, and stops its waits.
+/// @param pid the process.
+void locks_remove_task(pid_t pid);
+
+/// @brief Frees the lock context of a file which is being destroyed.
+/// @param file the file.
+void locks_free_context(vfs_file_t *file);
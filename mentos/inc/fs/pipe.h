@@ -14,8 +14,15 @@
 // #define PIPE_BUFFER_SIZE PAGE_SIZE
 #define PIPE_BUFFER_SIZE 64
 
-/// @brief The number of buffers.
-#define PIPE_NUM_BUFFERS 5
+/// @brief The maximum number of buffers of a pipe.
+#define PIPE_NUM_BUFFERS 16
+
+/// @brief The number of buffers of a new pipe, by default.
+#define PIPE_DEFAULT_BUFFERS 5
+
+/// @brief The capacity of new pipes in bytes, tunable through
+/// `/proc/sys/fs/pipe_size`. It is rounded down to whole buffers.
+extern int sysctl_fs_pipe_size;
 
 /// @brief Represents a single buffer within a pipe. This structure manages the
 /// data stored in the buffer, including its memory location, size, usage count,
@@ -47,7 +54,7 @@ typedef struct pipe_buffer {
 /// synchronization details.
 typedef struct pipe_inode_info {
     /// @brief Array of pipe buffers. Each buffer holds a portion of data for
-    /// the pipe. For the time beeing I'm setting a fixed number of buffers.
+    /// the pipe, only the first `numbuf` are used.
     pipe_buffer_t bufs[PIPE_NUM_BUFFERS];
 
     /// @brief Number of buffers allocated for the pipe. This value determines
@@ -131,6 +131,10 @@ typedef struct vfs_file {
     list_head siblings;
     /// Reference count for this file.
     int32_t refcount;
+    /// Private data of the file, its meaning depends on the file.
+    void *private_data;
+    /// The advisory locks of the file, NULL until it is first locked.
+    struct file_lock_context *flctx;
 } vfs_file_t;
 
 /// @brief A structure that represents an instance of a filesystem, i.e., a mounted filesystem.
@@ -0,0 +1,95 @@
+/// @file acpi.h
+/// @brief Layout of the ACPI tables describing the NUMA topology.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#pragma once
+
+#include "stdint.h"
+
+/// The signature of the Root System Description Pointer.
+#define ACPI_RSDP_SIGNATURE "RSD PTR "
+/// The signature of the System Resource Affinity Table.
+#define ACPI_SRAT_SIGNATURE "SRAT"
+/// The signature of the System Locality Information Table.
+#define ACPI_SLIT_SIGNATURE "SLIT"
+
+/// SRAT entry describing the node of a processor.
+#define ACPI_SRAT_PROCESSOR_AFFINITY 0
+/// SRAT entry describing the node of a range of memory.
+#define ACPI_SRAT_MEMORY_AFFINITY 1
+/// The entry of the SRAT is enabled.
+#define ACPI_SRAT_ENABLED 0x1
+
+/// The distance of a node from itself, in the SLIT.
+#define ACPI_LOCAL_DISTANCE 10
+/// The distance between two nodes, when the SLIT does not tell.
+#define ACPI_REMOTE_DISTANCE 20
+
+/// @brief Root System Description Pointer, found in the BIOS memory.
+typedef struct acpi_rsdp {
+    char signature[8];     ///< "RSD PTR ".
+    uint8_t checksum;      ///< The first 20 bytes sum to zero.
+    char oem_id[6];        ///< The OEM.
+    uint8_t revision;      ///< 0 for ACPI 1.0, 2 for the later versions.
+    uint32_t rsdt_address; ///< The physical address of the RSDT.
+} __attribute__((packed)) acpi_rsdp_t;
+
+/// @brief The header shared by all the System Description Tables.
+typedef struct acpi_sdt_header {
+    char signature[4];         ///< The table.
+    uint32_t length;           ///< The length of the table, including the header.
+    uint8_t revision;          ///< The revision of the table.
+    uint8_t checksum;          ///< The whole table sums to zero.
+    char oem_id[6];            ///< The OEM.
+    char oem_table_id[8];      ///< The table of the OEM.
+    uint32_t oem_revision;     ///< The revision of the table of the OEM.
+    uint32_t creator_id;       ///< The vendor of the tool which created the table.
+    uint32_t creator_revision; ///< The revision of the tool which created the table.
+} __attribute__((packed)) acpi_sdt_header_t;
+
+/// @brief System Resource Affinity Table, followed by its entries.
+typedef struct acpi_srat {
+    acpi_sdt_header_t header; ///< The header.
+    uint32_t reserved1;       ///< Must be 1.
+    uint32_t reserved2[2];    ///< Reserved.
+} __attribute__((packed)) acpi_srat_t;
+
+/// @brief The header shared by the entries of the SRAT.
+typedef struct acpi_srat_entry {
+    uint8_t type;   ///< The type of the entry.
+    uint8_t length; ///< The length of the entry.
+} __attribute__((packed)) acpi_srat_entry_t;
+
+/// @brief Entry of the SRAT associating a processor to a node.
+typedef struct acpi_srat_processor {
+    acpi_srat_entry_t header; ///< The header.
+    uint8_t proximity_lo;     ///< Bits 0-7 of the node.
+    uint8_t apic_id;          ///< The local APIC ID of the processor.
+    uint32_t flags;           ///< ACPI_SRAT_ENABLED if the entry is valid.
+    uint8_t sapic_eid;        ///< The local SAPIC EID of the processor.
+    uint8_t proximity_hi[3];  ///< Bits 8-31 of the node.
+    uint32_t clock_domain;    ///< The clock domain of the processor.
+} __attribute__((packed)) acpi_srat_processor_t;
+
+/// @brief Entry of the SRAT associating a range of memory to a node.
+typedef struct acpi_srat_memory {
+    acpi_srat_entry_t header;  ///< The header.
+    uint32_t proximity_domain; ///< The node.
+    uint16_t reserved1;        ///< Reserved.
+    uint32_t base_lo;          ///< Bits 0-31 of the first address.
+    uint32_t base_hi;          ///< Bits 32-63 of the first address.
+    uint32_t length_lo;        ///< Bits 0-31 of the length.
+    uint32_t length_hi;        ///< Bits 32-63 of the length.
+    uint32_t reserved2;        ///< Reserved.
+    uint32_t flags;            ///< ACPI_SRAT_ENABLED if the entry is valid.
+    uint32_t reserved3[2];     ///< Reserved.
+} __attribute__((packed)) acpi_srat_memory_t;
+
+/// @brief System Locality Information Table, followed by the matrix of the
+/// distances between the nodes, one byte each.
+typedef struct acpi_slit {
+    acpi_sdt_header_t header;   ///< The header.
+    uint32_t locality_count_lo; ///< Bits 0-31 of the number of nodes.
+    uint32_t locality_count_hi; ///< Bits 32-63 of the number of nodes.
+} __attribute__((packed)) acpi_slit_t;
@@ -93,6 +93,14 @@ uint32_t cpuid_get_byte(uint32_t reg, uint32_t position, uint32_t value);
 /// @return The brand string.
 char *cpuid_brand_index(pt_regs *f);
 
+/// @brief Checks if the CPU supports the Physical Address Extension (PAE).
+/// @return 1 if it is supported, 0 otherwise.
+int cpuid_has_pae(void);
+
+/// @brief Checks if the CPU supports the No-Execute (NX) bit of the page tables.
+/// @return 1 if it is supported, 0 otherwise.
+int cpuid_has_nx(void);
+
 /// @brief Brand string is contained in EAX, EBX, ECX and EDX.
 /// @param f Stack frame.
 /// @return The brand string.
@@ -99,6 +99,15 @@ int pic8259_irq_disable(uint32_t irq);
 /// @param irq The interrupt number.
 void pic8259_send_eoi(uint32_t irq);
 
+/// @brief     Checks if the given IRQ is a spurious one.
+/// @details   The PICs raise IRQ 7 (master) and IRQ 15 (slave) when a request
+///            disappears before being acknowledged. In that case the line is
+///            not set in the In-Service Register, and no EOI must be sent to
+///            the PIC that raised it (the master still needs one for IRQ 15).
+/// @param irq The interrupt number.
+/// @return 1 if the IRQ is spurious, 0 otherwise.
+int pic8259_irq_is_spurious(uint32_t irq);
+
 /// @brief  This Function return the number of current IRQ Request.
 /// @return Number of IRQ + 1 currently serving. If 0 there are no IRQ.
 //int pic8259_irq_get_current(void);
@@ -32,6 +32,13 @@
 /// Number of ticks per seconds.
 #define TICKS_PER_SECOND 1193
 
+/// The default timer slack of non real-time tasks, in nanoseconds.
+#define TIMER_SLACK_NS 5000000
+
+/// @brief The timer slack of the tasks which did not set their own, in
+/// nanoseconds, tunable through `/proc/sys/kernel/timer_slack_ns`.
+extern int sysctl_timer_slack_ns;
+
 /// @brief Handles the timer.
 /// @param reg The interrupt stack frame.
 /// @details
@@ -46,12 +53,26 @@ void timer_install(void);
 
 /// @brief Returns the number of seconds since the system started its execution.
 /// @return Value in seconds.
-uint64_t timer_get_seconds(void);
+unsigned long timer_get_seconds(void);
 
 /// @brief Returns the number of ticks since the system started its execution.
 /// @return Value in ticks.
 unsigned long timer_get_ticks(void);
 
+/// @brief Reads the monotonic clock, which counts the time since boot with
+/// the resolution of the PIT, and never goes back.
+/// @param ts where the time is stored.
+void timer_get_monotonic(timespec_t *ts);
+
+/// @brief Reads the wall clock, namely the monotonic clock plus the offset
+/// set through `timer_set_realtime`, slewed by adjtime.
+/// @param ts where the time since the Epoch is stored.
+void timer_get_realtime(timespec_t *ts);
+
+/// @brief Sets the wall clock, and cancels any pending adjustment.
+/// @param ts the time since the Epoch.
+void timer_set_realtime(const timespec_t *ts);
+
 /// @brief Allows to set the timer phase to the given frequency.
 /// @param hz The frequency to set.
 void timer_phase(uint32_t hz);
@@ -143,6 +164,12 @@ void add_timer(struct timer_list *timer);
 /// @param timer The timer to remove.
 void remove_timer(struct timer_list *timer);
 
+/// @brief Returns the timer slack of the task, namely how late its timers
+/// may expire so that they can share the tick of other timers.
+/// @param task The task.
+/// @return The slack in nanoseconds, 0 for real-time tasks which are exact.
+unsigned long timer_get_slack(task_struct *task);
+
 /// @brief Suspends the execution of the calling thread.
 /// @param req The amount of time we want to sleep.
 /// @param rem The remaining time we did not sleep.
@@ -181,6 +208,31 @@ int sys_getitimer(int which, struct itimerval *curr_value);
 /// @return Zero on success, or a negative value indicating the error.
 int sys_setitimer(int which, const struct itimerval *new_value, struct itimerval *old_value);
 
+/// @brief Retrieves the time of the given clock.
+/// @param clockid The clock (i.e., CLOCK_REALTIME, CLOCK_MONOTONIC).
+/// @param tp      Where the time is stored.
+/// @return Zero on success, or a negative value indicating the error.
+int sys_clock_gettime(clockid_t clockid, struct timespec *tp);
+
+/// @brief Retrieves the wall clock time, with microsecond resolution.
+/// @param tv Where the time is stored.
+/// @param tz Ignored, the timezone is handled by the C library.
+/// @return Zero on success, or a negative value indicating the error.
+int sys_gettimeofday(struct timeval *tv, void *tz);
+
+/// @brief Sets the wall clock time, only root can do it.
+/// @param tv The new time.
+/// @param tz Ignored, the timezone is handled by the C library.
+/// @return Zero on success, or a negative value indicating the error.
+int sys_settimeofday(const struct timeval *tv, const void *tz);
+
+/// @brief Gradually corrects the wall clock, by speeding it up or slowing it
+/// down until the given correction has been applied.
+/// @param delta    The correction, can be negative. NULL only reads the pending one.
+/// @param olddelta Where the correction still pending is stored, can be NULL.
+/// @return Zero on success, or a negative value indicating the error.
+int sys_adjtime(const struct timeval *delta, struct timeval *olddelta);
+
 /// @brief Update the profiling timer and generate SIGPROF if it has expired.
 /// @param proc The process for which we must update the profiling.
 void update_process_profiling_timer(task_struct *proc);
@@ -5,7 +5,9 @@
 
 #pragma once
 
+#include "klib/static_key.h"
 #include "os_root_path.h"
+#include "stddef.h"
 #include "sys/kernel_levels.h"
 
 #ifndef __DEBUG_LEVEL__
@@ -18,6 +20,40 @@
 #define __DEBUG_HEADER__ 0
 #endif
 
+/// @brief A `pr_debug` call site, which can be enabled at runtime through
+/// `/proc/dynamic_debug`. The sites are collected in the `__dyndbg` section.
+typedef struct dyndbg_site {
+    /// The file containing the call.
+    const char *file;
+    /// The function containing the call.
+    const char *function;
+    /// The format of the message.
+    const char *format;
+    /// The line of the call.
+    unsigned int line;
+    /// Enables the call.
+    static_key_t key;
+} dyndbg_site_t;
+
+/// @brief Applies a dynamic debug query, made of one or more commands
+/// separated by ';' or newlines. A command selects the sites through the
+/// `file <name>`, `func <name>`, `line <n>[-<m>]` and `format <text>`
+/// keywords, and ends with the flags to change: `+p` enables them, `-p`
+/// disables them (e.g., `file pipe.c func pipe_read +p`).
+/// @param query the query.
+/// @param nbyte the length of the query.
+/// @return the amount we consumed, -EINVAL if the query is malformed, -ENOENT
+/// if no site matches it.
+ssize_t dyndbg_query(const char *query, size_t nbyte);
+
+/// @brief Lists the dynamic debug sites, one per line, in the form
+/// `<file>:<line> [<function>] =<flags> "<format>"`.
+/// @param buffer the buffer where the list is placed.
+/// @param offset the offset of the list from which we start reading.
+/// @param nbyte the size of the buffer.
+/// @return the number of bytes we read.
+ssize_t dyndbg_read(char *buffer, off_t offset, size_t nbyte);
+
 /// @brief Sets the loglevel.
 /// @param level The new loglevel.
 void set_log_level(int level);
@@ -118,11 +154,22 @@ void dbg_printf(const char *file, const char *fun, int line, char *header, short
 #define pr_info(...)
 #endif
 
-/// Prints a debug message.
+/// Returns the format of a `pr_debug` call.
+#define __DYNDBG_FORMAT(format, ...) format
+
+/// Prints a debug message. If the file is built below the debug level, the
+/// call becomes a dynamic debug site, which costs a NOP until it is enabled.
 #if __DEBUG_LEVEL__ >= LOGLEVEL_DEBUG
 #define pr_debug(...) dbg_printf(__RELATIVE_PATH__, __func__, __LINE__, __DEBUG_HEADER__, LOGLEVEL_DEBUG, __VA_ARGS__)
 #else
-#define pr_debug(...)
+#define pr_debug(...)                                                                                                  \
+    do {                                                                                                               \
+        static dyndbg_site_t __dyndbg_site __attribute__((section("__dyndbg"), used, aligned(4))) = {                  \
+            __RELATIVE_PATH__, __func__, __DYNDBG_FORMAT(__VA_ARGS__, 0), __LINE__, STATIC_KEY_INIT_FALSE};            \
+        if (static_key_false(&__dyndbg_site.key)) {                                                                    \
+            dbg_printf(__RELATIVE_PATH__, __func__, __LINE__, __DEBUG_HEADER__, LOGLEVEL_DEBUG, __VA_ARGS__);          \
+        }                                                                                                              \
+    } while (0)
 #endif
 
 struct pt_regs;
@@ -22,3 +22,7 @@ int procfb_module_init(void);
 /// @brief Initializes the IPC information system.
 /// @return 0 on success, 1 on failure.
 int procipc_module_init(void);
+
+/// @brief Initializes the `/proc/sys` tunables.
+/// @return 0 on success, 1 on failure.
+int procsysctl_module_init(void);
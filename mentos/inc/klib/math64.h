@@ -0,0 +1,31 @@
+/// @file math64.h
+/// @brief 64-bit arithmetic helpers.
+/// @details The kernel is not linked against libgcc, so there is no 64-bit
+/// division, and it must be done with these helpers instead.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#pragma once
+
+#include "stddef.h"
+#include "stdint.h"
+
+/// @brief Divides a 64-bit value by a 32-bit one, with a single divl.
+/// @details The quotient must fit 32 bits, namely the upper half of the
+/// dividend must be smaller than the divisor, otherwise divl raises a divide
+/// error.
+/// @param dividend the dividend.
+/// @param divisor the divisor.
+/// @param remainder where the remainder is stored, can be NULL.
+/// @return the quotient.
+static inline uint32_t div_u64_u32(uint64_t dividend, uint32_t divisor, uint32_t *remainder)
+{
+    uint32_t quotient, rem;
+    __asm__("divl %4"
+            : "=a"(quotient), "=d"(rem)
+            : "a"((uint32_t)dividend), "d"((uint32_t)(dividend >> 32U)), "rm"(divisor));
+    if (remainder) {
+        *remainder = rem;
+    }
+    return quotient;
+}
@@ -0,0 +1,70 @@
+/// @file static_key.h
+/// @brief Static keys, branches patched in the code at runtime.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+/// @details
+/// A branch on a static key costs a single 5-byte NOP while the key is
+/// disabled. Enabling the key patches every branch on it into a jump to the
+/// unlikely code, so it is meant for conditions which almost never change
+/// (e.g., debugging output). Each branch records its address, the address of
+/// the unlikely code, and the key inside the `__jump_table` section.
+
+#pragma once
+
+#include "stdbool.h"
+#include "stdint.h"
+
+/// @brief A static key.
+typedef struct static_key {
+    /// Whether the branches on the key are taken.
+    bool_t enabled;
+} static_key_t;
+
+/// @brief Initializer of a disabled static key.
+#define STATIC_KEY_INIT_FALSE {false}
+
+/// @brief An entry of the `__jump_table` section, one per branch.
+typedef struct jump_entry {
+    /// The address of the patched instruction.
+    uint32_t code;
+    /// The address of the unlikely code.
+    uint32_t target;
+    /// The key of the branch.
+    static_key_t *key;
+} jump_entry_t;
+
+/// @brief Evaluates to true if the key is enabled. While it is disabled, the
+/// check costs a single NOP.
+/// @param key a pointer to a static key, it must be a link-time constant.
+#define static_key_false(key)                                                                                          \
+    __extension__({                                                                                                    \
+        __label__ __sk_yes, __sk_out;                                                                                  \
+        bool_t __sk_ret = false;                                                                                       \
+        __asm__ goto("1: .byte 0x0f, 0x1f, 0x44, 0x00, 0x00\n\t"                                                       \
+                     ".pushsection __jump_table, \"aw\"\n\t"                                                           \
+                     ".balign 4\n\t"                                                                                   \
+                     ".long 1b, %l[__sk_yes], %c0\n\t"                                                                 \
+                     ".popsection\n\t"                                                                                 \
+                     :                                                                                                 \
+                     : "i"(key)                                                                                        \
+                     :                                                                                                 \
+                     : __sk_yes);                                                                                      \
+        goto __sk_out;                                                                                                 \
+    __sk_yes:                                                                                                          \
+        __sk_ret = true;                                                                                               \
+    __sk_out:                                                                                                          \
+        __sk_ret;                                                                                                      \
+    })
+
+/// @brief Enables the key, and patches all its branches into jumps.
+/// @param key the key.
+void static_key_enable(static_key_t *key);
+
+/// @brief Disables the key, and patches all its branches back into NOPs.
+/// @param key the key.
+void static_key_disable(static_key_t *key);
+
+/// @brief Checks if the key is enabled.
+/// @param key the key.
+/// @return true if it is enabled, false otherwise.
+static inline bool_t static_key_enabled(static_key_t *key) { return key->enabled; }
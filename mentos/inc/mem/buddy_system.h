@@ -75,6 +75,11 @@ bb_page_t *bb_alloc_pages(bb_instance_t *instance, unsigned int order);
 /// @param page     The address of the first page descriptor of the block.
 void bb_free_pages(bb_instance_t *instance, bb_page_t *page);
 
+/// @brief Checks if the page is the first page of an allocated or free block.
+/// @param page The page to check.
+/// @return 1 if the page is the root of its block, 0 otherwise.
+int bb_page_is_root(bb_page_t *page);
+
 /// @brief Alloc a page using bb cache.
 /// @param instance Buddy system instance.
 /// @return An allocated page.
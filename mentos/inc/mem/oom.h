@@ -0,0 +1,66 @@
+/// @file oom.h
+/// @brief Out-of-memory handling and memory pressure notification.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#pragma once
+
+#include "mem/gfp.h"
+#include "process/process.h"
+
+/// @brief The lowest adjustment, the task is never selected by the OOM killer.
+#define OOM_SCORE_ADJ_MIN (-1000)
+/// @brief The highest adjustment, the task is always the preferred victim.
+#define OOM_SCORE_ADJ_MAX 1000
+
+/// @brief The memory pressure levels, reported by `/proc/mempressure`.
+typedef enum mempressure_level_t {
+    MEMPRESSURE_NONE,     ///< Plenty of free memory.
+    MEMPRESSURE_LOW,      ///< Less than a quarter of a zone is free.
+    MEMPRESSURE_MEDIUM,   ///< Less than an eighth of a zone is free.
+    MEMPRESSURE_CRITICAL, ///< Less than a sixteenth of a zone is free, or the OOM killer ran.
+} mempressure_level_t;
+
+/// @brief Handles a failed allocation of physical pages.
+/// @details First, it reclaims the free slabs, the areas released by vfree,
+/// and the pages released with MADV_FREE. If nothing can be reclaimed, it
+/// kills the task with the highest badness score, whose memory is released
+/// when it exits.
+/// @param gfp_mask the GFP mask of the failed allocation.
+/// @param order the order of the failed allocation.
+/// @return 1 if some memory was reclaimed and the allocation should be
+/// retried, 0 otherwise.
+int out_of_memory(gfp_t gfp_mask, unsigned int order);
+
+/// @brief Computes the badness of a task, namely its resident pages,
+/// adjusted through its `oom_score_adj`.
+/// @param task the task.
+/// @return the badness of the task, 0 if it cannot be killed.
+unsigned long oom_badness(task_struct *task);
+
+/// @brief Computes the badness of a task, normalized to the amount of
+/// physical memory, as shown in `/proc/<pid>/oom_score`.
+/// @param task the task.
+/// @return a score between 0 and 2000.
+unsigned int oom_score(task_struct *task);
+
+/// @brief Recomputes the memory pressure level, and wakes up the tasks
+/// waiting for it to change.
+void mempressure_update(void);
+
+/// @brief Returns the current memory pressure level.
+/// @return the level.
+mempressure_level_t mempressure_get_level(void);
+
+/// @brief Returns the name of the given memory pressure level.
+/// @param level the level.
+/// @return the name of the level.
+const char *mempressure_level_name(mempressure_level_t level);
+
+/// @brief Returns the number of changes of the memory pressure level.
+/// @return the number of changes, starting from 1.
+unsigned long mempressure_get_events(void);
+
+/// @brief Puts the current process to sleep until the memory pressure level changes.
+/// @return 0 on success, -EINTR if interrupted by a signal, -1 on failure.
+int mempressure_wait(void);
@@ -18,6 +18,8 @@
 #define PAGE_SIZE   (1UL << PAGE_SHIFT)
 /// Maximum number of physical page frame numbers (PFNs).
 #define MAX_PHY_PFN (1UL << (32UL - PAGE_SHIFT))
+/// Address of the last physical page which can be mapped by 32-bit page tables.
+#define MAX_PHY_ADDR ((MAX_PHY_PFN - 1UL) << PAGE_SHIFT)
 
 /// The start of the process area.
 #define PROCAREA_START_ADDR 0x00000000UL
@@ -28,6 +30,13 @@
 #define MAX_PAGE_TABLE_ENTRIES 1024
 /// For a page directory with 1024 entries.
 #define MAX_PAGE_DIR_ENTRIES   1024
+/// The number of bytes mapped by a whole page table.
+#define PAGE_TABLE_SPAN        (MAX_PAGE_TABLE_ENTRIES * PAGE_SIZE)
+
+/// @brief Returns the index of the page directory entry which maps the given page frame number.
+#define PGD_INDEX(pfn) ((pfn) / MAX_PAGE_TABLE_ENTRIES)
+/// @brief Returns the index of the page table entry which maps the given page frame number.
+#define PTE_INDEX(pfn) ((pfn) % MAX_PAGE_TABLE_ENTRIES)
 
 /// @brief An entry of a page directory.
 typedef struct page_dir_entry_t {
@@ -71,6 +80,14 @@ enum MEMMAP_FLAGS {
     MM_UPDADDR = 0x20, ///< Update address (used for special memory mappings).
 };
 
+/// @brief Hints on the usage of a virtual memory area, set by madvise and mlock.
+enum VM_HINTS {
+    VM_SEQ_READ  = 0x1, ///< Pages are accessed sequentially, fault-around ahead of the faulting page.
+    VM_RAND_READ = 0x2, ///< Pages are accessed randomly, do not fault-around.
+    VM_LOCKED    = 0x4, ///< Pages are populated, and never dropped.
+    VM_LAZYFREE  = 0x8, ///< Some pages can be dropped when the memory runs low.
+};
+
 /// @brief A page table.
 /// @details
 /// It contains 1024 entries which can be addressed by 10 bits (log_2(1024)).
@@ -103,6 +120,8 @@ typedef struct vm_area_struct_t {
     pgprot_t vm_page_prot;
     /// Flags indicating attributes of the memory area.
     unsigned short vm_flags;
+    /// Hints on the usage of the memory area (VM_HINTS).
+    unsigned short vm_hints;
 } vm_area_struct_t;
 
 /// @brief Memory Descriptor, used to store details about the memory of a user process.
@@ -143,21 +162,58 @@ typedef struct mm_struct_t {
     unsigned int total_vm;
 } mm_struct_t;
 
+/// @brief Page statistics of a virtual memory area, collected by walking its page tables.
+typedef struct vm_area_stats_t {
+    /// Number of pages spanned by the area.
+    uint32_t size;
+    /// Pages backed by a physical frame.
+    uint32_t resident;
+    /// Resident pages whose frame is referenced by more than one process.
+    uint32_t shared;
+    /// Resident pages still shared copy-on-write (i.e., read-only until written).
+    uint32_t cow;
+    /// Resident pages which have been written to.
+    uint32_t dirty;
+    /// Resident pages which have been accessed.
+    uint32_t referenced;
+} vm_area_stats_t;
+
+/// @name Pagemap entry
+/// @brief Layout of the 64-bit entries returned by mem_read_pagemap, one per
+/// virtual page. It follows the Linux `/proc/<pid>/pagemap` layout, where
+/// possible.
+/// @{
+#define PM_PFRAME_MASK ((1ULL << 55) - 1) ///< Bits 0-54, the page frame number (if present).
+#define PM_DIRTY       (1ULL << 55)       ///< The page has been written to.
+#define PM_EXCLUSIVE   (1ULL << 56)       ///< The frame is mapped only by this process.
+#define PM_COW         (1ULL << 57)       ///< The page is shared copy-on-write.
+#define PM_SHARED      (1ULL << 61)       ///< The frame is mapped by more than one process.
+#define PM_PRESENT     (1ULL << 63)       ///< The page is backed by a physical frame.
+/// @}
+
+/// @brief A pagemap entry.
+typedef uint64_t pagemap_entry_t;
+
 /// @brief Cache used to store page tables.
 extern kmem_cache_t *pgtbl_cache;
 
+/// @brief The number of pages populated ahead of a fault in sequential areas,
+/// tunable through `/proc/sys/vm/readahead_pages`.
+extern int sysctl_vm_readahead_pages;
+
 /// @brief Comparison function between virtual memory areas.
 /// @param vma0 Pointer to the first vm_area_struct's list_head.
 /// @param vma1 Pointer to the second vm_area_struct's list_head.
-/// @return 1 if vma0 starts after vma1 ends, 0 otherwise.
+/// @return 1 if vma0 starts after vma1, 0 otherwise.
 static inline int vm_area_compare(const list_head *vma0, const list_head *vma1)
 {
     // Retrieve the vm_area_struct from the list_head for vma0.
     vm_area_struct_t *_vma0 = list_entry(vma0, vm_area_struct_t, vm_list);
     // Retrieve the vm_area_struct from the list_head for vma1.
     vm_area_struct_t *_vma1 = list_entry(vma1, vm_area_struct_t, vm_list);
-    // Compare the start address of vma0 with the end address of vma1.
-    return _vma0->vm_start > _vma1->vm_end;
+    // Compare the start addresses, areas do not overlap so this also orders
+    // adjacent areas (where vma0 starts exactly where vma1 ends).
+    return _vma0->vm_start > _vma1->vm_start;
 }
 
 /// @brief Initializes the paging system, sets up memory caches, page
@@ -193,6 +249,19 @@ int paging_switch_directory_va(page_directory_t *dir);
 /// @param addr The address of the page table.
 void paging_flush_tlb_single(unsigned long addr);
 
+/// @brief Invalidates the whole TLB, global pages included.
+static inline void paging_flush_tlb_all(void)
+{
+    uintptr_t cr4 = get_cr4();
+    if (cr4 & CR4_PGE) {
+        // Global pages survive the reload of cr3, toggling PGE drops them.
+        set_cr4(bitmask_clear(cr4, CR4_PGE));
+        set_cr4(cr4);
+    } else {
+        set_cr3(get_cr3());
+    }
+}
+
 /// @brief Enables paging.
 static inline void paging_enable(void)
 {
@@ -271,6 +340,29 @@ int destroy_vm_area(mm_struct_t *mm, vm_area_struct_t *area);
 /// @return a pointer to the area if we found it, NULL otherwise.
 vm_area_struct_t *find_vm_area(mm_struct_t *mm, uint32_t vm_start);
 
+/// @brief Collects the page statistics of a virtual memory area.
+/// @details The page tables of the area are only walked, missing page tables
+/// are neither allocated nor modified.
+/// @param area the area to inspect.
+/// @param stats where the statistics are stored.
+/// @return 0 on success, -1 on failure.
+int vm_area_get_stats(vm_area_struct_t *area, vm_area_stats_t *stats);
+
+/// @brief Drops the pages of the area which were released with MADV_FREE,
+/// and which were not written since then.
+/// @param area the virtual memory area.
+/// @return the number of pages released.
+unsigned int vm_area_reclaim_lazyfree(vm_area_struct_t *area);
+
+/// @brief Reads the pagemap entries (see PM_PRESENT and the other PM_* bits)
+/// of a range of virtual pages.
+/// @param pgd the page directory to inspect.
+/// @param first_page the first virtual page number.
+/// @param entries where the entries are stored.
+/// @param count the number of pages to read.
+/// @return 0 on success, -1 on failure.
+int mem_read_pagemap(page_directory_t *pgd, uint32_t first_page, pagemap_entry_t *entries, size_t count);
+
 /// @brief Checks if the given virtual memory area range is valid.
 /// @param mm the memory descriptor which we use to check the range.
 /// @param vm_start the starting address of the area.
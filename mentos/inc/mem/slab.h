@@ -63,6 +63,10 @@ typedef struct kmem_cache_t {
 /// @return Returns 0 on success, or -1 if an error occurs.
 int kmem_cache_init(void);
 
+/// @brief The maximum number of objects added to a cache at once, when it
+/// runs out of free objects, tunable through `/proc/sys/vm/slab_refill_count`.
+extern int sysctl_vm_slab_refill_count;
+
 /// @brief Creates a new kmem_cache structure.
 /// @details This function allocates memory for a new cache and initializes it
 /// with the provided parameters. The cache is ready for use after this function
@@ -91,6 +95,17 @@ kmem_cache_t *kmem_cache_create(
 /// @return Returns 0 on success, or -1 if an error occurs.
 int kmem_cache_destroy(kmem_cache_t *cachep);
 
+/// @brief Releases the completely free slabs of the given cache.
+/// @param cachep Pointer to the cache to shrink.
+/// @return Returns the number of pages given back to the zone allocator.
+unsigned int kmem_cache_shrink(kmem_cache_t *cachep);
+
+/// @brief Releases the completely free slabs of all the caches.
+/// @details Free slabs are otherwise kept until the cache is destroyed, this
+/// is used to reclaim memory when the system is running out of it.
+/// @return Returns the number of pages given back to the zone allocator.
+unsigned int kmem_cache_reap(void);
+
 /// @brief Allocs a new object using the provided cache.
 /// @param file   File where the object is allocated.
 /// @param fun    Function where the object is allocated.
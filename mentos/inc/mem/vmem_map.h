@@ -9,18 +9,40 @@
 #include "mem/paging.h"
 #include "mem/zone_allocator.h"
 
-/// @brief Virtual mapping manager.
-typedef struct virt_map_page_manager_t {
-    /// The buddy system used to manage the pages.
-    bb_instance_t bb_instance;
-} virt_map_page_manager_t;
+/// @brief Maximum number of areas released by vfree which wait for the TLB purge.
+#define VMALLOC_LAZY_MAX_AREAS 32
+/// @brief Number of pages released by vfree above which we purge the TLB.
+#define VMALLOC_LAZY_MAX_PAGES 256
 
 /// @brief Virtual mapping.
 typedef struct virt_map_page_t {
     /// A buddy system page.
     bb_page_t bbpage;
+    /// The physical page mapped here by vmalloc, NULL for the other mappings.
+    page_t *page;
 } virt_map_page_t;
 
+/// @brief An area released by vfree, which waits for the TLB purge.
+typedef struct vmalloc_lazy_area_t {
+    /// The first virtual page of the area.
+    virt_map_page_t *vpage;
+    /// The physical page of the first virtual page. It is moved here, so that
+    /// the area no longer looks allocated to vfree.
+    page_t *page;
+} vmalloc_lazy_area_t;
+
+/// @brief Virtual mapping manager.
+typedef struct virt_map_page_manager_t {
+    /// The buddy system used to manage the pages.
+    bb_instance_t bb_instance;
+    /// The areas released by vfree, still reachable through stale TLB entries.
+    vmalloc_lazy_area_t lazy_areas[VMALLOC_LAZY_MAX_AREAS];
+    /// The number of areas waiting for the purge.
+    unsigned int lazy_count;
+    /// The number of pages waiting for the purge.
+    unsigned int lazy_pages;
+} virt_map_page_manager_t;
+
 /// @brief Initialize the virtual memory mapper.
 /// @return Returns 0 on success, or -1 if an error occurs.
 int virt_init(void);
@@ -60,4 +82,60 @@ int virt_unmap_pg(virt_map_page_t *page);
 /// @param src_mm The source memory struct
 /// @param src_vaddr The source memory address
 /// @param size The size in bytes of the copy
-void virt_memcpy(mm_struct_t *dst_mm, uint32_t dst_vaddr, mm_struct_t *src_mm, uint32_t src_vaddr, uint32_t size);
+/// @return Returns 0 on success, or -1 if the virtual mappings cannot be reserved.
+int virt_memcpy(mm_struct_t *dst_mm, uint32_t dst_vaddr, mm_struct_t *src_mm, uint32_t src_vaddr, uint32_t size);
+
+/// @brief Allocates memory which is virtually contiguous, but made of pages
+/// allocated one by one, so that it does not need contiguous physical memory.
+/// @param file the file where the allocation is performed.
+/// @param fun the function where the allocation is performed.
+/// @param line the line where the allocation is performed.
+/// @param size the size in bytes to allocate.
+/// @return Pointer to the allocated memory, or NULL on failure.
+void *pr_vmalloc(const char *file, const char *fun, int line, size_t size);
+
+/// @brief Frees memory allocated by vmalloc. The physical pages and the
+/// virtual range are released lazily, together with the TLB purge.
+/// @param file the file where the free is performed.
+/// @param fun the function where the free is performed.
+/// @param line the line where the free is performed.
+/// @param addr the address returned by vmalloc.
+void pr_vfree(const char *file, const char *fun, int line, void *addr);
+
+/// @brief Allocates memory from the slab for small sizes, and from vmalloc
+/// for the sizes which would need whole pages.
+/// @param file the file where the allocation is performed.
+/// @param fun the function where the allocation is performed.
+/// @param line the line where the allocation is performed.
+/// @param size the size in bytes to allocate.
+/// @return Pointer to the allocated memory, or NULL on failure.
+void *pr_kvmalloc(const char *file, const char *fun, int line, size_t size);
+
+/// @brief Frees memory allocated by kvmalloc.
+/// @param file the file where the free is performed.
+/// @param fun the function where the free is performed.
+/// @param line the line where the free is performed.
+/// @param addr the address returned by kvmalloc.
+void pr_kvfree(const char *file, const char *fun, int line, void *addr);
+
+/// @brief Checks if the address belongs to the virtual mapping area.
+/// @param addr the address to check.
+/// @return 1 if it belongs to the area, 0 otherwise.
+int is_vmalloc_addr(const void *addr);
+
+/// @brief Releases the areas freed by vfree: once the TLB forgets about
+/// them, their physical pages and their virtual range can be reused.
+/// @return the number of physical pages given back to the zone allocator.
+unsigned int vmalloc_purge_lazy(void);
+
+/// Wrapper that provides the filename, the function and line where the vmalloc is happening.
+#define vmalloc(...) pr_vmalloc(__RELATIVE_PATH__, __func__, __LINE__, __VA_ARGS__)
+
+/// Wrapper that provides the filename, the function and line where the vfree is happening.
+#define vfree(...) pr_vfree(__RELATIVE_PATH__, __func__, __LINE__, __VA_ARGS__)
+
+/// Wrapper that provides the filename, the function and line where the kvmalloc is happening.
+#define kvmalloc(...) pr_kvmalloc(__RELATIVE_PATH__, __func__, __LINE__, __VA_ARGS__)
+
+/// Wrapper that provides the filename, the function and line where the kvfree is happening.
+#define kvfree(...) pr_kvfree(__RELATIVE_PATH__, __func__, __LINE__, __VA_ARGS__)
@@ -90,8 +90,13 @@ typedef struct zone_t {
     bb_instance_t buddy_system;
 } zone_t;
 
+/// Requests the page frames from the node of the processor.
+#define NUMA_NO_NODE (-1)
+
 /// @brief Data structure to rapresent a memory node. In Uniform memory access
-/// (UMA) architectures there is only one node called contig_page_data.
+/// (UMA) architectures there is only one node called contig_page_data. In
+/// NUMA architectures there is one for each node described by the ACPI SRAT,
+/// and each node has its own zones, with their own buddy systems.
 typedef struct pg_data_t {
     /// Zones of the node.
     zone_t node_zones[__MAX_NR_ZONES];
@@ -109,6 +114,19 @@ typedef struct pg_data_t {
     int node_id;
     /// Next item in the memory node list.
     struct pg_data_t *node_next;
+    /// Distance from the other nodes, 10 is the distance from itself.
+    unsigned char node_distance[MAX_NUMNODES];
+    /// The nodes sorted by distance from this one, the order in which they
+    /// are tried when an allocation prefers this node.
+    int node_fallback[MAX_NUMNODES];
+    /// Allocations which preferred this node, and were satisfied by it.
+    unsigned long numa_hit;
+    /// Allocations which preferred another node, and were satisfied by this one.
+    unsigned long numa_miss;
+    /// Allocations which preferred this node, and were satisfied by another one.
+    unsigned long numa_foreign;
+    /// Interleaved allocations which were satisfied by the node they chose.
+    unsigned long interleave_hit;
 } pg_data_t;
 
 /// @brief Structure to represent a memory zone (LowMem or HighMem).
@@ -123,7 +141,10 @@ typedef struct memory_zone {
 /// @brief Structure to encapsulate system memory management data.
 typedef struct memory_info {
     page_t *mem_map;         ///< Pointer to the array of all physical memory blocks.
-    pg_data_t *page_data;    ///< Pointer to the contiguous memory node descriptor.
+    pg_data_t *page_data;    ///< Pointer to the array of memory node descriptors.
+    int nr_nodes;            ///< Number of memory nodes.
+    int local_node;          ///< Node of the processor, preferred by the allocations.
+    int interleave_node;     ///< Last node chosen by the interleaved allocations.
     uint32_t mem_size;       ///< Total size of available physical memory (bytes).
     uint32_t mem_map_num;    ///< Total number of memory frames (pages) available.
     uint32_t page_index_min; ///< Minimum page index.
@@ -174,9 +195,38 @@ page_t *pr_alloc_pages(const char *file, const char *func, int line, gfp_t gfp_m
 /// @return Returns 0 on success, or -1 if an error occurs.
 int pr_free_pages(const char *file, const char *func, int line, page_t *page);
 
+/// @brief Like pr_alloc_pages, but the page frames are taken from the given
+/// node, and only if it is out of memory from the nearest ones.
+/// @param file     The file name where the allocation is done.
+/// @param func     The function name where the allocation is done.
+/// @param line     The line number where the allocation is done.
+/// @param nid      The preferred node, or NUMA_NO_NODE for the local one.
+/// @param gfp_mask GFP_FLAGS to decide the zone allocation.
+/// @param order    The logarithm of the size of the page frame.
+/// @return Memory address of the first free page frame allocated, or NULL if
+/// allocation fails.
+page_t *pr_alloc_pages_node(const char *file, const char *func, int line, int nid, gfp_t gfp_mask, uint32_t order);
+
+/// @brief Like pr_alloc_pages, but each call prefers the node after the one
+/// of the previous call, to spread memory shared by many tasks across nodes.
+/// @param file     The file name where the allocation is done.
+/// @param func     The function name where the allocation is done.
+/// @param line     The line number where the allocation is done.
+/// @param gfp_mask GFP_FLAGS to decide the zone allocation.
+/// @param order    The logarithm of the size of the page frame.
+/// @return Memory address of the first free page frame allocated, or NULL if
+/// allocation fails.
+page_t *pr_alloc_pages_interleave(const char *file, const char *func, int line, gfp_t gfp_mask, uint32_t order);
+
 /// Wrapper that provides the filename, the function and line where the alloc is happening.
 #define alloc_pages(...) pr_alloc_pages(__RELATIVE_PATH__, __func__, __LINE__, __VA_ARGS__)
 
+/// Wrapper that provides the filename, the function and line where the alloc is happening.
+#define alloc_pages_node(...) pr_alloc_pages_node(__RELATIVE_PATH__, __func__, __LINE__, __VA_ARGS__)
+
+/// Wrapper that provides the filename, the function and line where the alloc is happening.
+#define alloc_pages_interleave(...) pr_alloc_pages_interleave(__RELATIVE_PATH__, __func__, __LINE__, __VA_ARGS__)
+
 /// Wrapper that provides the filename, the function and line where the free is happening.
 #define free_pages(...) pr_free_pages(__RELATIVE_PATH__, __func__, __LINE__, __VA_ARGS__)
 
@@ -237,14 +287,30 @@ unsigned long get_zone_cached_space(gfp_t gfp_mask);
 /// @return The number of characters written to the buffer, or a negative value if an error occurs.
 int get_zone_buddy_system_status(gfp_t gfp_mask, char *buffer, size_t bufsize);
 
+/// @brief Returns the node which contains a page frame.
+/// @param page A pointer to the page descriptor.
+/// @return The node, or -1 if the page is not part of any node.
+int page_to_nid(page_t *page);
+
+/// @brief Writes the memory and the allocation statistics of each node.
+/// @param buffer A pointer to the buffer where the formatted string will be written.
+/// @param bufsize The size of the provided buffer, in bytes.
+/// @return The number of characters written to the buffer.
+int numa_print_stats(char *buffer, size_t bufsize);
+
 /// @brief Checks if the specified address points to a page_t (or field) that
 /// belongs to lowmem.
 /// @param addr The address to check.
 /// @return 1 if it belongs to lowmem, 0 otherwise.
 static inline int is_lowmem_page_struct(void *addr)
 {
-    uint32_t start_lowm_map  = (uint32_t)memory.page_data->node_zones[ZONE_NORMAL].zone_mem_map;
-    uint32_t lowmem_map_size = sizeof(page_t) * memory.page_data->node_zones[ZONE_NORMAL].num_pages;
+    // The lowmem is split among the nodes, but its page descriptors are contiguous.
+    uint32_t lowmem_pages = 0;
+    for (int nid = 0; nid < memory.nr_nodes; ++nid) {
+        lowmem_pages += memory.page_data[nid].node_zones[ZONE_NORMAL].num_pages;
+    }
+    uint32_t start_lowm_map  = (uint32_t)(memory.mem_map + memory.page_index_min);
+    uint32_t lowmem_map_size = sizeof(page_t) * lowmem_pages;
     uint32_t map_index       = (uint32_t)addr - start_lowm_map;
     return map_index < lowmem_map_size;
 }
@@ -238,6 +238,11 @@ multiboot_memory_map_t *mmap_next_entry(multiboot_info_t *info, multiboot_memory
 /// @return The next entry of the given type.
 multiboot_memory_map_t *mmap_next_entry_of_type(multiboot_info_t *info, multiboot_memory_map_t *entry, uint32_t type);
 
+/// @brief Computes the amount of available memory which lies above 4 GiB.
+/// @param info The multiboot info from which we extract the memory map.
+/// @return The amount of memory, in KiB.
+uint32_t mmap_available_above_4g(multiboot_info_t *info);
+
 /// @brief Returns the type of the entry as string.
 /// @param entry The current entry.
 /// @return String representing the type of entry.
@@ -223,6 +223,15 @@ static inline void hlt(void) { __asm__ __volatile__("hlt"); }
 /// @brief Gives hint to processor that improves performance of spin-wait loops.
 static inline void pause(void) { __asm__ __volatile__("pause"); }
 
+/// @brief Reads the Time-Stamp Counter, which counts the CPU cycles since reset.
+/// @return the current value of the counter.
+static inline uint64_t rdtsc(void)
+{
+    uint32_t low, high;
+    __asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32U) | low;
+}
+
 // == Memory clobbers =========================================================
 // Memory clobber implies a fence, and it also impacts how the compiler treats
 // potential data aliases. A memory clobber says that the asm block modifies
@@ -3,6 +3,8 @@
 /// @copyright (c) 2014-2024 This file is distributed under the MIT License.
 /// See LICENSE.md for details.
 
+#pragma once
+
 // Priority of a process goes from 0..MAX_PRIO-1, valid RT
 // priority is 0..MAX_RT_PRIO-1, and SCHED_NORMAL/SCHED_BATCH
 // tasks are in the range MAX_RT_PRIO..MAX_PRIO-1. Priority
@@ -25,6 +27,8 @@
 
 /// @brief Maximum real-time priority.
 #define MAX_RT_PRIO 100
+/// @brief The highest priority a real-time task can ask for.
+#define MAX_USER_RT_PRIO (MAX_RT_PRIO - 1)
 
 /// @brief Maximum priority.
 #define MAX_PRIO (MAX_RT_PRIO + NICE_WIDTH)
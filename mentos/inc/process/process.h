@@ -9,6 +9,7 @@
 #include "devices/fpu.h"
 #include "drivers/keyboard/keyboard.h"
 #include "mem/paging.h"
+#include "process/wait.h"
 #include "stdbool.h"
 #include "system/signal.h"
 
@@ -18,6 +19,12 @@
 /// The default dimension of the stack of a process (1 MByte).
 #define DEFAULT_STACK_SIZE (1 * M)
 
+/// The order of the page frames holding the kernel stack of a task.
+#define TASK_KERNEL_STACK_ORDER 4
+/// The dimension of the kernel stack of a task (64 KByte), the kernel keeps
+/// buffers of PATH_MAX bytes on the stack.
+#define TASK_KERNEL_STACK_SIZE  (PAGE_SIZE << TASK_KERNEL_STACK_ORDER)
+
 /// @brief This structure is used to track the statistics of a process.
 /// @details
 /// While the other variables also play a role in
@@ -62,11 +69,22 @@ typedef struct sched_entity_t {
     time_t worst_case_exec;
     /// Processor utilization factor
     double utilization_factor;
+
+    /// The scheduling policy (SCHED_*).
+    int policy;
+    /// The real-time priority, from 1 (lowest) to 99 (highest), 0 for non real-time tasks.
+    int rt_priority;
+    /// Ticks left before a SCHED_RR task leaves the CPU to the tasks with its same priority.
+    time_t time_slice;
+    /// The scheduling class serving the task.
+    const struct sched_class_t *sched_class;
+    /// Link inside the queue of the scheduling class.
+    list_head class_list;
 } sched_entity_t;
 
 /// @brief Stores the status of CPU and FPU registers.
 typedef struct thread_struct_t {
-    /// Stored status of registers.
+    /// Stored status of the user registers, on the last entry in the kernel.
     pt_regs regs;
     /// Stored status of registers befor jumping into a signal handler.
     pt_regs signal_regs;
@@ -74,6 +92,10 @@ typedef struct thread_struct_t {
     bool_t fpu_enabled;
     /// Data structure used to save FPU registers.
     savefpu fpu_register;
+    /// The kernel stack of the task, used when it enters the kernel.
+    uintptr_t kernel_stack;
+    /// The kernel stack pointer, saved by switch_to while the task is not running.
+    uintptr_t esp;
 } thread_struct_t;
 
 /// @brief this is our task object. Every process in the system has this, and
@@ -109,12 +131,29 @@ typedef struct task_struct {
     list_head children;
     /// List of siblings, namely processes created by parent process.
     list_head sibling;
+    /// Queue of the waitpid calls of the process, woken up when one of its
+    /// children exits, stops or continues.
+    wait_queue_head_t wait_chldexit;
     /// The context of the processors.
     thread_struct_t thread;
     /// For scheduling algorithms.
     sched_entity_t se;
+    /// Adjustment of the OOM badness, from OOM_SCORE_ADJ_MIN to OOM_SCORE_ADJ_MAX.
+    int oom_score_adj;
     /// Exit code of the process. (parameter of _exit() system call).
     int exit_code;
+    /// Ticks spent running in user mode.
+    unsigned long utime;
+    /// Ticks spent running in kernel mode.
+    unsigned long stime;
+    /// User mode ticks of the children which have been waited for.
+    unsigned long cutime;
+    /// Kernel mode ticks of the children which have been waited for.
+    unsigned long cstime;
+    /// Context switches where the task left the CPU because it went to sleep.
+    unsigned long nvcsw;
+    /// Context switches where the task was preempted while still runnable.
+    unsigned long nivcsw;
     /// The name of the task (Added for debug purpose).
     char name[TASK_NAME_MAX_LENGTH];
     /// Task's segments.
@@ -144,6 +183,8 @@ typedef struct task_struct {
     unsigned long it_real_incr;
     /// Current value for the real timer (ITIMER_REAL).
     unsigned long it_real_value;
+    /// The tick at which the real timer is due, before the slack delays it.
+    unsigned long it_real_expires;
     /// Next value for the virtual timer (ITIMER_VIRTUAL).
     unsigned long it_virt_incr;
     /// Current value for the virtual timer (ITIMER_VIRTUAL).
@@ -152,6 +193,9 @@ typedef struct task_struct {
     unsigned long it_prof_incr;
     /// Current value for the profiling timer (ITIMER_PROF).
     unsigned long it_prof_value;
+    /// How late the timers of the task may expire, in nanoseconds, 0 to use
+    /// the default one (see PR_SET_TIMERSLACK).
+    unsigned long timer_slack_ns;
 
     /// Process-wise terminal options.
     termios_t termios;
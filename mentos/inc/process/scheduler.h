@@ -6,12 +6,51 @@
 #pragma once
 
 #include "list_head.h"
+#include "process/prio.h"
 #include "process/process.h"
 #include "stddef.h"
 
 /// @brief Define the maximum number of processes your OS will support.
 #define MAX_PROCESSES 256
 
+/// @name Scheduling policies
+/// @{
+#define SCHED_NORMAL   0 ///< Time-sharing, served by the fair class.
+#define SCHED_FIFO     1 ///< Fixed-priority real-time, without time slices.
+#define SCHED_RR       2 ///< Fixed-priority real-time, with time slices.
+#define SCHED_BATCH    3 ///< Time-sharing for CPU-bound jobs, served by the fair class.
+#define SCHED_IDLE     5 ///< Runs only when nothing else can run.
+#define SCHED_DEADLINE 6 ///< Periodic tasks, served by Earliest Deadline First.
+/// @}
+
+/// @brief Queue of the deadline class.
+typedef struct dl_runqueue_t {
+    /// The periodic tasks, admitted after their analysis.
+    list_head queue;
+} dl_runqueue_t;
+
+/// @brief Queue of the real-time class.
+typedef struct rt_runqueue_t {
+    /// One bit for each non-empty queue, bit 0 is the highest priority.
+    unsigned long bitmap[(MAX_RT_PRIO + 31) / 32];
+    /// One queue for each priority, the first is the highest priority.
+    list_head queue[MAX_RT_PRIO];
+} rt_runqueue_t;
+
+/// @brief Queue of the fair class.
+typedef struct fair_runqueue_t {
+    /// The tasks, sorted by increasing virtual runtime.
+    list_head queue;
+    /// The virtual runtime of the last picked task, it never decreases.
+    time_t min_vruntime;
+} fair_runqueue_t;
+
+/// @brief Queue of the idle class.
+typedef struct idle_runqueue_t {
+    /// The tasks, served round-robin.
+    list_head queue;
+} idle_runqueue_t;
+
 /// @brief Structure that contains information about live processes.
 typedef struct runqueue_t {
     /// Number of queued processes.
@@ -22,8 +61,55 @@ typedef struct runqueue_t {
     list_head queue;
     /// The current running process.
     task_struct *curr;
+    /// Queue of the deadline class.
+    dl_runqueue_t dl;
+    /// Queue of the real-time class.
+    rt_runqueue_t rt;
+    /// Queue of the fair class.
+    fair_runqueue_t fair;
+    /// Queue of the idle class.
+    idle_runqueue_t idle;
+    /// Set when a woken task must preempt the current one, it makes the next
+    /// return to user mode from an interrupt go through the scheduler.
+    bool_t need_resched;
 } runqueue_t;
 
+/// @brief The CPU time and scheduling statistics, reported by `/proc/stat`.
+typedef struct kernel_cpustat_t {
+    /// Ticks spent running processes in user mode.
+    unsigned long user;
+    /// Ticks spent running processes in kernel mode.
+    unsigned long system;
+    /// Ticks spent with no runnable process.
+    unsigned long idle;
+    /// Number of context switches.
+    unsigned long context_switches;
+    /// Number of created processes.
+    unsigned long forks;
+} kernel_cpustat_t;
+
+/// @brief A scheduling class. The classes are chained from the highest to the
+/// lowest priority, and a class runs only when the previous ones have nothing
+/// to run. Like `runqueue.queue`, the queues of the classes keep the sleeping
+/// tasks too, and the pick function skips them.
+typedef struct sched_class_t {
+    /// The name of the class.
+    const char *name;
+    /// The class with the next lower priority.
+    const struct sched_class_t *next;
+    /// @brief Adds the task to the queue of the class.
+    void (*enqueue_task)(runqueue_t *rq, task_struct *task);
+    /// @brief Removes the task from the queue of the class.
+    void (*dequeue_task)(runqueue_t *rq, task_struct *task);
+    /// @brief Returns the runnable task the class wants to run, or NULL.
+    task_struct *(*pick_next_task)(runqueue_t *rq);
+    /// @brief Accounts the time the current task has just spent running.
+    void (*task_tick)(runqueue_t *rq, task_struct *task);
+    /// @brief Checks if the woken task must preempt the current one, both
+    /// belonging to the class.
+    int (*check_preempt_curr)(runqueue_t *rq, task_struct *task);
+} sched_class_t;
+
 /// @brief Structure that describes scheduling parameters.
 typedef struct sched_param_t {
     /// Static execution priority.
@@ -41,6 +127,16 @@ typedef struct sched_param_t {
 /// @brief Global reference to the init process.
 extern task_struct *init_process;
 
+/// @brief The runqueue, holding the list of all the processes.
+extern runqueue_t runqueue;
+
+/// @brief The CPU time and scheduling statistics.
+extern kernel_cpustat_t kernel_cpustat;
+
+/// @brief The time slice of SCHED_RR tasks in milliseconds, tunable through
+/// `/proc/sys/kernel/sched_rr_timeslice_ms`.
+extern int sysctl_sched_rr_timeslice_ms;
+
 /// @brief Initialize the scheduler.
 void scheduler_initialize(void);
 
@@ -69,10 +165,28 @@ void scheduler_enqueue_task(task_struct *process);
 /// @param process Process that has to be activated.
 void scheduler_dequeue_task(task_struct *process);
 
-/// @brief The RR implementation of the scheduler.
+/// @brief Delivers the pending signals of the current process, then runs the
+/// scheduler. Called before returning to user mode.
 /// @param f The context of the process.
 void scheduler_run(pt_regs *f);
 
+/// @brief Gives the CPU to the next task. The current task is suspended until
+/// the scheduler picks it again, so this can be called in the middle of a
+/// system call, once the task has been put to sleep. If no task is runnable,
+/// it waits for an interrupt to wake one up.
+void schedule(void);
+
+/// @brief Charges a timer tick to the current process, either as user or as
+/// kernel time depending on the interrupted context, or to the idle time if
+/// no process is runnable.
+/// @param f The context interrupted by the timer.
+void scheduler_account_tick(pt_regs *f);
+
+/// @brief Runs the scheduler if a woken task must preempt the current one.
+/// Used on the return from interrupts which do not always reschedule.
+/// @param f The context of the process.
+void scheduler_preempt(pt_regs *f);
+
 /// @brief Values from pt_regs to task_struct process.
 /// @param f       The set of registers we are saving.
 /// @param process The process for which we are saving the CPU registers status.
@@ -89,22 +203,53 @@ void scheduler_restore_context(task_struct *process, pt_regs *f);
 void scheduler_enter_user_jmp(uintptr_t location, uintptr_t stack);
 
 /// @brief Picks the next task (in scheduler_algorithm.c).
-/// @param runqueue   Pointer to the runqueue.
+/// @param rq   Pointer to the runqueue.
 /// @return The next task to execute.
-task_struct *scheduler_pick_next_task(runqueue_t *runqueue);
+task_struct *scheduler_pick_next_task(runqueue_t *rq);
+
+/// @brief Adds the task to the class matching its policy (in scheduler_algorithm.c).
+/// @param rq   Pointer to the runqueue.
+/// @param task The task to add.
+void sched_class_enqueue(runqueue_t *rq, task_struct *task);
+
+/// @brief Removes the task from its class (in scheduler_algorithm.c).
+/// @param rq   Pointer to the runqueue.
+/// @param task The task to remove.
+void sched_class_dequeue(runqueue_t *rq, task_struct *task);
+
+/// @brief Called when a task wakes up, it sets `need_resched` if the task
+/// comes before the current one (in scheduler_algorithm.c).
+/// @param rq   Pointer to the runqueue.
+/// @param task The task which has just been woken up.
+void sched_class_check_preempt(runqueue_t *rq, task_struct *task);
 
 /// @brief Set new scheduling settings for the given process.
-/// @param pid   ID of the process we are manipulating.
-/// @param param New parameters.
-/// @return 1 on success, -1 on error.
+/// @param pid   ID of the process we are manipulating, 0 for the current one.
+/// @param param New parameters, setting `is_periodic` turns the process into
+/// a SCHED_DEADLINE one, clearing it turns a SCHED_DEADLINE process into a
+/// SCHED_NORMAL one.
+/// @return 0 on success, a negative errno value on error.
 int sys_sched_setparam(pid_t pid, const sched_param_t *param);
 
 /// @brief Gets the scheduling settings for the given process.
-/// @param pid   ID of the process we are manipulating.
+/// @param pid   ID of the process we are manipulating, 0 for the current one.
 /// @param param Where we store the parameters.
-/// @return 1 on success, -1 on error.
+/// @return 0 on success, a negative errno value on error.
 int sys_sched_getparam(pid_t pid, sched_param_t *param);
 
+/// @brief Sets the scheduling policy and parameters of the given process.
+/// @param pid    ID of the process we are manipulating, 0 for the current one.
+/// @param policy The new policy (SCHED_*).
+/// @param param  The new parameters, `sched_priority` must be within 1 and
+/// MAX_USER_RT_PRIO for SCHED_FIFO and SCHED_RR, and 0 for the other policies.
+/// @return 0 on success, a negative errno value on error.
+int sys_sched_setscheduler(pid_t pid, int policy, const sched_param_t *param);
+
+/// @brief Gets the scheduling policy of the given process.
+/// @param pid ID of the process we are manipulating, 0 for the current one.
+/// @return the policy on success, a negative errno value on error.
+int sys_sched_getscheduler(pid_t pid);
+
 /// @brief Puts the process on wait until its next period starts.
 /// @return 0 on success, a negative value on failure.
 int sys_waitperiod(void);
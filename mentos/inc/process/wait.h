@@ -123,3 +123,22 @@ int default_wake_function(wait_queue_entry_t *entry, unsigned mode, int sync);
 /// @return Pointer to the entry inside the wq representing the
 ///         sleeping process.
 wait_queue_entry_t *sleep_on(wait_queue_head_t *head);
+
+/// @brief Makes the current process, already in the wait queue, leave the CPU
+///        until it is woken up, or a signal is sent to it.
+/// @details The entry of the process is removed from the queue before returning.
+/// @param head Waitqueue where the process sleeps.
+/// @return 0 when woken up, -EINTR when interrupted by a signal, -1 on failure.
+int wait_on(wait_queue_head_t *head);
+
+/// @brief Puts the current process to sleep in the wait queue, until it is
+///        woken up, or a signal is sent to it.
+/// @param head Waitqueue where to sleep.
+/// @return 0 when woken up, -EINTR when interrupted by a signal, -1 on failure.
+int interruptible_sleep_on(wait_queue_head_t *head);
+
+/// @brief Wakes up all the tasks sleeping on the given wait queue, and
+///        removes their entries from it.
+/// @param head The head of the waiting queue.
+/// @return The number of tasks woken up.
+int wake_up_all(wait_queue_head_t *head);
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "stddef.h"
+
 /// @brief Initializes the resource registry and tracker.
 void resource_register_init(void);
 
@@ -42,3 +44,34 @@ void clear_resource_info(void *ptr);
 /// @param resource_id The ID of the resource to check. Use -1 to check all resources.
 /// @param printer A callback function to handle the formatted output for each resource.
 void print_resource_usage(int resource_id, const char *(*printer)(void *ptr));
+
+/// @brief Enables or disables the allocation profiler.
+/// @details While disabled, new allocations are not recorded, but the frees of
+/// the allocations recorded so far are still accounted.
+/// @param enable 1 to enable the profiler, 0 to disable it.
+void alloc_profiler_enable(int enable);
+
+/// @brief Checks if the allocation profiler is enabled.
+/// @return 1 if enabled, 0 otherwise.
+int alloc_profiler_enabled(void);
+
+/// @brief Drops all the allocation records and the statistics of all the sites.
+void alloc_profiler_reset(void);
+
+/// @brief Records an allocation, and accounts it to its allocation site.
+/// @param file The file where the allocation was requested.
+/// @param fun The function where the allocation was requested.
+/// @param line The line where the allocation was requested.
+/// @param ptr The allocated memory.
+/// @param size The amount of memory actually reserved for the allocation.
+void alloc_profiler_alloc(const char *file, const char *fun, int line, void *ptr, size_t size);
+
+/// @brief Removes the record of an allocation, and updates its allocation site.
+/// @param ptr The memory being freed.
+void alloc_profiler_free(void *ptr);
+
+/// @brief Prints the allocation sites, sorted by the amount of live memory.
+/// @param buffer The buffer where the report is written.
+/// @param bufsize The size of the buffer.
+/// @return The number of characters written.
+ssize_t alloc_profiler_print(char *buffer, size_t bufsize);
@@ -0,0 +1,66 @@
+/// @file sysctl.h
+/// @brief Kernel tunables, set from the command line or through `/proc/sys`.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#pragma once
+
+#include "stddef.h"
+
+/// @brief A kernel tunable, an integer value within a range.
+typedef struct sysctl_entry_t {
+    /// The path under `/proc/sys` (e.g., `kernel/printk`).
+    const char *path;
+    /// The variable holding the value, NULL if it is accessed through `get` and `set`.
+    int *data;
+    /// Returns the value, used when `data` is NULL.
+    int (*get)(void);
+    /// Sets the value, used when `data` is NULL.
+    void (*set)(int value);
+    /// The lowest accepted value.
+    int min;
+    /// The highest accepted value.
+    int max;
+} sysctl_entry_t;
+
+/// @brief Returns the tunable at the given position of the table.
+/// @param index the position.
+/// @return the tunable, NULL if the position is past the end of the table.
+sysctl_entry_t *sysctl_get_entry(size_t index);
+
+/// @brief Finds a tunable by path, the components can be separated either by
+/// '/' or by '.' (e.g., `vm/readahead_pages` or `vm.readahead_pages`).
+/// @param path the path of the tunable.
+/// @return the tunable, NULL if it does not exist.
+sysctl_entry_t *sysctl_find(const char *path);
+
+/// @brief Returns the value of a tunable.
+/// @param entry the tunable.
+/// @return the value.
+int sysctl_read(sysctl_entry_t *entry);
+
+/// @brief Parses a decimal number and sets the tunable to it.
+/// @param entry the tunable.
+/// @param buffer the number, optionally followed by blanks or a newline.
+/// @param nbyte the size of the buffer.
+/// @return the amount we consumed, or -EINVAL if the value is not a number
+/// or it is out of range.
+ssize_t sysctl_write(sysctl_entry_t *entry, const char *buffer, size_t nbyte);
+
+/// @brief Saves and parses the kernel command line passed by the bootloader.
+/// @details Options are separated by spaces. `loglevel=<n>` sets the log
+/// level, `sysctl.<path>=<value>` sets any tunable (e.g.,
+/// `sysctl.kernel.sched_rr_timeslice_ms=20`), and `dyndbg="<query>"` enables
+/// debug messages (e.g., `dyndbg="file pipe.c +p"`). Other options are left to
+/// the rest of the kernel, see `cmdline_has_option`.
+/// @param cmdline the command line, can be NULL.
+void cmdline_parse(const char *cmdline);
+
+/// @brief Returns the kernel command line.
+/// @return the command line, an empty string if there was none.
+const char *cmdline_get(void);
+
+/// @brief Checks if the kernel command line contains the given option.
+/// @param option the option (e.g., `runtests`).
+/// @return 1 if it is present, 0 otherwise.
+int cmdline_has_option(const char *option);
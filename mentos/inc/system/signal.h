@@ -259,6 +259,19 @@ int do_signal(struct pt_regs *f);
 /// @return 1 on success, 0 on failure.
 int signals_init(void);
 
+struct task_struct;
+
+/// @brief Checks if the task has pending signals which are not blocked.
+/// @param t The task to check.
+/// @return 1 if there are signals to deliver, 0 otherwise.
+int signal_pending(struct task_struct *t);
+
+/// @brief Checks if the task has pending signals which must interrupt a
+/// blocking system call: those which are neither blocked nor ignored.
+/// @param t The task to check.
+/// @return 1 if the call must return -EINTR, 0 otherwise.
+int signal_interrupt_pending(struct task_struct *t);
+
 /// @brief Send signal to one specific process.
 /// @param pid The PID of the process.
 /// @param sig The signal to be sent.
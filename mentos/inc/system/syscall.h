@@ -77,8 +77,11 @@ int sys_unlink(const char *path);
 /// @param pid     The pid to wait.
 /// @param status  If not NULL, store status information here.
 /// @param options Determines the wait behaviour.
-/// @return on success, returns the process ID of the terminated
-///         child; on error, -1 is returned.
+/// @return on success, returns the process ID of the terminated (or
+///         stopped, with WUNTRACED) child; 0 if there is none and WNOHANG is
+///         set; -EAGAIN if the caller has been put to sleep and has to repeat
+///         the call once woken up; -EINTR if a signal is pending; -ECHILD if
+///         there are no children to wait for.
 pid_t sys_waitpid(pid_t pid, int *status, int options);
 
 /// @brief Replaces the current process image with a new process image.
@@ -377,11 +380,37 @@ void *sys_mmap(void *addr, size_t length, int prot, int flags, int fd, off_t off
 /// @return 0 on success, -1 on falure and errno is set.
 int sys_munmap(void *addr, size_t length);
 
+/// @brief Gives advice about the use of memory.
+/// @param addr the starting address of the range, it must be page-aligned.
+/// @param length the length of the range.
+/// @param advice one of the MADV_* values.
+/// @return 0 on success, a negative errno value on failure.
+int sys_madvise(void *addr, size_t length, int advice);
+
+/// @brief Locks the pages of the range in memory, populating them.
+/// @param addr the starting address of the range.
+/// @param length the length of the range.
+/// @return 0 on success, a negative errno value on failure.
+int sys_mlock(const void *addr, size_t length);
+
+/// @brief Unlocks the pages of the range.
+/// @param addr the starting address of the range.
+/// @param length the length of the range.
+/// @return 0 on success, a negative errno value on failure.
+int sys_munlock(const void *addr, size_t length);
+
 /// @brief Returns system information in the structure pointed to by buf.
 /// @param buf Buffer where the info will be placed.
 /// @return 0 on success, a negative value on failure.
 int sys_uname(utsname_t *buf);
 
+/// @brief Performs an operation on the calling process.
+/// @param option the operation (PR_SET_TIMERSLACK or PR_GET_TIMERSLACK).
+/// @param arg2 the argument of the operation.
+/// @return the result of PR_GET_* operations, 0 for the other ones, a
+/// negative value on failure.
+int sys_prctl(int option, unsigned long arg2);
+
 /// @brief System call to create a new pipe.
 /// @param fds Array to store read and write file descriptors.
 /// @return 0 on success, or -1 on error.
@@ -400,3 +429,9 @@ long sys_ioctl(int fd, unsigned int request, unsigned long data);
 /// @param data Additional data required by certain `fcntl` commands (e.g., flags or pointer).
 /// @return Returns 0 on success; on error, returns a negative error code.
 long sys_fcntl(int fd, unsigned int request, unsigned long data);
+
+/// @brief Applies or removes an advisory lock on the whole file.
+/// @param fd The file descriptor of the file.
+/// @param operation One of LOCK_SH, LOCK_EX, or LOCK_UN, optionally with LOCK_NB.
+/// @return 0 on success, a negative error code on failure.
+int sys_flock(int fd, int operation);
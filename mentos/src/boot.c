@@ -6,6 +6,7 @@
 #include "boot.h"
 
 #include "elf/elf.h"
+#include "hardware/acpi.h"
 #include "link_access.h"
 #include "mem/paging.h"
 #include "sys/module.h"
@@ -39,7 +40,7 @@ static boot_info_t boot_info;
 /// @brief Boot page directory.
 static page_directory_t boot_pgdir;
 /// @brief Boot page tables.
-static page_table_t boot_pgtables[1024];
+static page_table_t boot_pgtables[MAX_PAGE_DIR_ENTRIES];
 
 /// @brief Use this to write to I/O ports to send bytes to devices.
 /// @param port The output port.
@@ -78,22 +79,208 @@ static inline uint32_t __align_rup(uint32_t addr, uint32_t value)
 /// @return the aligned address.
 static inline uint32_t __align_rdown(uint32_t addr, uint32_t value) { return addr - (addr % value); }
 
+/// @brief Sums the bytes of an ACPI structure, which is valid if they sum to zero.
+/// @param data the structure.
+/// @param length the length of the structure.
+/// @return the sum of the bytes.
+static inline uint8_t __acpi_checksum(const void *data, uint32_t length)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint8_t sum          = 0;
+    for (uint32_t i = 0; i < length; ++i) {
+        sum += bytes[i];
+    }
+    return sum;
+}
+
+/// @brief Checks the signature of an ACPI structure.
+/// @param signature the signature of the structure.
+/// @param expected the signature we are looking for.
+/// @param length the length of the signature.
+/// @return 1 if they match, 0 otherwise.
+static inline int __acpi_signature(const char *signature, const char *expected, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; ++i) {
+        if (signature[i] != expected[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/// @brief Searches the Root System Description Pointer inside a range of memory.
+/// @param start the first address of the range.
+/// @param end the first address after the range.
+/// @return the pointer, 0 if it is not there.
+static inline acpi_rsdp_t *__acpi_scan_rsdp(uint32_t start, uint32_t end)
+{
+    // The structure is aligned to 16 bytes.
+    for (uint32_t addr = start; (addr + sizeof(acpi_rsdp_t)) <= end; addr += 16) {
+        acpi_rsdp_t *rsdp = (acpi_rsdp_t *)addr;
+        if (__acpi_signature(rsdp->signature, ACPI_RSDP_SIGNATURE, 8) &&
+            (__acpi_checksum(rsdp, sizeof(acpi_rsdp_t)) == 0)) {
+            return rsdp;
+        }
+    }
+    return 0;
+}
+
+/// @brief Searches an ACPI System Description Table. Must be called before
+/// enabling paging, as the tables are read at their physical address.
+/// @param signature the signature of the table.
+/// @return the table, 0 if the firmware does not provide it.
+static acpi_sdt_header_t *__acpi_find_table(const char *signature)
+{
+    // The pointer is either in the first KiB of the Extended BIOS Data Area,
+    // whose segment is stored at 0x40E, or in the BIOS read-only memory.
+    uint32_t ebda     = (uint32_t)(*(uint16_t *)0x40E) << 4U;
+    acpi_rsdp_t *rsdp = ebda ? __acpi_scan_rsdp(ebda, ebda + 1024) : 0;
+    if (!rsdp) {
+        rsdp = __acpi_scan_rsdp(0xE0000, 0x100000);
+    }
+    if (!rsdp) {
+        return 0;
+    }
+    acpi_sdt_header_t *rsdt = (acpi_sdt_header_t *)rsdp->rsdt_address;
+    if (!__acpi_signature(rsdt->signature, "RSDT", 4) || __acpi_checksum(rsdt, rsdt->length)) {
+        return 0;
+    }
+    // The header of the RSDT is followed by the addresses of the other tables.
+    uint32_t *tables = (uint32_t *)(rsdt + 1);
+    uint32_t count   = (rsdt->length - sizeof(acpi_sdt_header_t)) / sizeof(uint32_t);
+    for (uint32_t i = 0; i < count; ++i) {
+        acpi_sdt_header_t *table = (acpi_sdt_header_t *)tables[i];
+        if (__acpi_signature(table->signature, signature, 4) && !__acpi_checksum(table, table->length)) {
+            return table;
+        }
+    }
+    return 0;
+}
+
+/// @brief Returns the local APIC ID of the processor we are running on.
+/// @return the ID.
+static inline uint32_t __get_apic_id(void)
+{
+    uint32_t eax = 1, ebx, ecx = 0, edx;
+    __asm__ __volatile__("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    return ebx >> 24U;
+}
+
+/// @brief Turns an ACPI proximity domain into a node, nodes are numbered in
+/// the order the domains appear in the SRAT.
+/// @param domains the domain of each node.
+/// @param domain the domain.
+/// @return the node, -1 if there are too many.
+static inline int __numa_node_of_domain(uint32_t *domains, uint32_t domain)
+{
+    for (unsigned int node = 0; node < boot_info.numa_nodes; ++node) {
+        if (domains[node] == domain) {
+            return node;
+        }
+    }
+    if (boot_info.numa_nodes == MAX_NUMNODES) {
+        return -1;
+    }
+    domains[boot_info.numa_nodes] = domain;
+    return boot_info.numa_nodes++;
+}
+
+/// @brief Reads the NUMA topology from the ACPI SRAT and SLIT tables.
+static void __setup_numa_topology(void)
+{
+    // The proximity domain of each node.
+    uint32_t domains[MAX_NUMNODES];
+    // The processor we are running on.
+    uint32_t apic_id = __get_apic_id();
+
+    boot_info.numa_nodes     = 0;
+    boot_info.numa_cpu_node  = 0;
+    boot_info.numa_nr_ranges = 0;
+
+    acpi_srat_t *srat = (acpi_srat_t *)__acpi_find_table(ACPI_SRAT_SIGNATURE);
+    if (!srat) {
+        __debug_puts("[bootloader] No NUMA topology provided by the firmware.\n");
+        return;
+    }
+    for (uint32_t offset = sizeof(acpi_srat_t); (offset + sizeof(acpi_srat_entry_t)) <= srat->header.length;) {
+        acpi_srat_entry_t *entry = (acpi_srat_entry_t *)((uint32_t)srat + offset);
+        if (entry->length == 0) {
+            break;
+        }
+        offset += entry->length;
+        if (entry->type == ACPI_SRAT_MEMORY_AFFINITY) {
+            acpi_srat_memory_t *affinity = (acpi_srat_memory_t *)entry;
+            // Without PAE, we can only address the first 4 GiB.
+            if (!(affinity->flags & ACPI_SRAT_ENABLED) || affinity->base_hi || (affinity->base_lo >= MAX_PHY_ADDR)) {
+                continue;
+            }
+            int node = __numa_node_of_domain(domains, affinity->proximity_domain);
+            if ((node < 0) || (boot_info.numa_nr_ranges == MAX_NUMA_RANGES)) {
+                continue;
+            }
+            boot_numa_range_t *range = &boot_info.numa_ranges[boot_info.numa_nr_ranges++];
+            range->node              = node;
+            range->phy_start         = affinity->base_lo;
+            // Clip the ranges which cross the 4 GiB limit.
+            if (affinity->length_hi || (affinity->length_lo > (MAX_PHY_ADDR - affinity->base_lo))) {
+                range->phy_end = MAX_PHY_ADDR;
+            } else {
+                range->phy_end = affinity->base_lo + affinity->length_lo;
+            }
+        } else if (entry->type == ACPI_SRAT_PROCESSOR_AFFINITY) {
+            acpi_srat_processor_t *processor = (acpi_srat_processor_t *)entry;
+            if (!(processor->flags & ACPI_SRAT_ENABLED) || (processor->apic_id != apic_id)) {
+                continue;
+            }
+            uint32_t domain = processor->proximity_lo | (processor->proximity_hi[0] << 8U) |
+                              (processor->proximity_hi[1] << 16U) | (processor->proximity_hi[2] << 24U);
+            int node = __numa_node_of_domain(domains, domain);
+            if (node >= 0) {
+                boot_info.numa_cpu_node = node;
+            }
+        }
+    }
+
+    // Without the SLIT, all the other nodes are equally far.
+    for (unsigned int i = 0; i < MAX_NUMNODES; ++i) {
+        for (unsigned int j = 0; j < MAX_NUMNODES; ++j) {
+            boot_info.numa_distance[i][j] = (i == j) ? ACPI_LOCAL_DISTANCE : ACPI_REMOTE_DISTANCE;
+        }
+    }
+    acpi_slit_t *slit = (acpi_slit_t *)__acpi_find_table(ACPI_SLIT_SIGNATURE);
+    if (slit && !slit->locality_count_hi && (slit->locality_count_lo <= 0xFF)) {
+        // The header is followed by the matrix of the distances, indexed by domain.
+        uint32_t count  = slit->locality_count_lo;
+        uint8_t *matrix  = (uint8_t *)(slit + 1);
+        if ((sizeof(acpi_slit_t) + (count * count)) <= slit->header.length) {
+            for (unsigned int i = 0; i < boot_info.numa_nodes; ++i) {
+                for (unsigned int j = 0; j < boot_info.numa_nodes; ++j) {
+                    if ((domains[i] < count) && (domains[j] < count)) {
+                        boot_info.numa_distance[i][j] = matrix[(domains[i] * count) + domains[j]];
+                    }
+                }
+            }
+        }
+    }
+    __debug_puts("[bootloader] NUMA topology read from the ACPI tables.\n");
+}
+
 /// @brief Prepares the page frames.
 /// @param pfn_virt_start The first virtual page frame.
 /// @param pfn_phys_start The first physical page frame.
 /// @param pfn_count The number of page frames.
 static void __setup_pages(uint32_t pfn_virt_start, uint32_t pfn_phys_start, uint32_t pfn_count)
 {
-    uint32_t base_pgtable = pfn_virt_start / 1024;
-    uint32_t base_pgentry = pfn_virt_start % 1024;
+    uint32_t base_pgtable = PGD_INDEX(pfn_virt_start);
+    uint32_t base_pgentry = PTE_INDEX(pfn_virt_start);
 
     uint32_t pg_offset = 0;
-    for (uint32_t i = base_pgtable; i < 1024 && pfn_count; i++) {
+    for (uint32_t i = base_pgtable; i < MAX_PAGE_DIR_ENTRIES && pfn_count; i++) {
         page_table_t *table = boot_pgtables + i;
 
         uint32_t pgentry_start = (i == base_pgtable) ? base_pgentry : 0;
 
-        for (uint32_t j = pgentry_start; j < 1024 && pfn_count; j++, pfn_count--) {
+        for (uint32_t j = pgentry_start; j < MAX_PAGE_TABLE_ENTRIES && pfn_count; j++, pfn_count--) {
             table->pages[j].frame   = pfn_phys_start + pg_offset++;
             table->pages[j].rw      = 1;
             table->pages[j].present = 1;
@@ -234,6 +421,9 @@ void boot_main(uint32_t magic, multiboot_info_t *header, uint32_t esp)
     boot_info.kernel_size          = kernel_virt_high - kernel_virt_low;
     boot_info.multiboot_header     = header;
 
+    // Read the NUMA topology, while we can still access the physical memory.
+    __setup_numa_topology();
+
     // Get the address after the modules.
     boot_info.module_end = __get_address_after_modules(header);
 
@@ -261,7 +451,8 @@ void boot_main(uint32_t magic, multiboot_info_t *header, uint32_t esp)
     boot_info.lowmem_virt_end   = boot_info.lowmem_virt_start + boot_info.lowmem_size;
 
     boot_info.highmem_phy_start = boot_info.lowmem_phy_end;
-    boot_info.highmem_phy_end   = header->mem_upper * 1024;
+    // Without PAE the memory is addressable only up to 4 GiB, do not wrap around.
+    boot_info.highmem_phy_end   = (header->mem_upper < (MAX_PHY_ADDR / 1024)) ? header->mem_upper * 1024 : MAX_PHY_ADDR;
     boot_info.stack_end         = boot_info.lowmem_virt_end;
 
     // Setup the page directory and page tables for the boot.
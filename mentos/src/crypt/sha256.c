@@ -9,6 +9,10 @@
 /// Algorithm specification can be found here:
 ///     http://csrc.nist.gov/publications/fips/fips180-2/fips180-2withchangenotice.pdf
 /// This implementation uses little endian byte order.
+///
+/// The kernel does not save the SSE registers of its own code, so it only
+/// has the unrolled scalar transform of the C library. The input is consumed
+/// a block at a time, straight from the buffer of the caller.
 
 // Setup the logging for this file (do this before any other include).
 #include "sys/kernel_levels.h"           // Include kernel log levels.
@@ -36,12 +40,12 @@
 /// @brief Chooses bits from y if x is set, otherwise from z.
 /// @param x, y, z Input values.
 /// @return Result of CH function.
-#define CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define CH(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
 
 /// @brief Majority function used in SHA-256.
 /// @param x, y, z Input values.
 /// @return Result of the majority function.
-#define MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define MAJ(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
 
 /// @brief First expansion function for the working variables.
 /// @param x Input value.
@@ -63,6 +67,30 @@
 /// @return Result of SIG1.
 #define SIG1(x) (ROTRIGHT(x, 17) ^ ROTRIGHT(x, 19) ^ ((x) >> 10))
 
+/// @brief Reads a big endian 32-bit word, the compiler turns it into bswap.
+/// @param p Pointer to the first byte.
+/// @return The word.
+#define LOAD_BE32(p)                                                                                                   \
+    (((uint32_t)(p)[0] << 24U) | ((uint32_t)(p)[1] << 16U) | ((uint32_t)(p)[2] << 8U) | (uint32_t)(p)[3])
+
+/// @brief Computes the next word of the message schedule, in a window of 16.
+/// @param w The window.
+/// @param i The index of the word.
+#define SCHEDULE(w, i)                                                                                                 \
+    ((w)[(i) & 15] += SIG1((w)[((i) - 2) & 15]) + (w)[((i) - 7) & 15] + SIG0((w)[((i) - 15) & 15]))
+
+/// @brief One round of the compression function. Instead of moving the
+/// working variables, the callers rotate the arguments.
+/// @param a, b, c, d, e, f, g, h The working variables.
+/// @param ki The round constant.
+/// @param wi The word of the message schedule.
+#define ROUND(a, b, c, d, e, f, g, h, ki, wi)                                                                          \
+    do {                                                                                                               \
+        uint32_t __t1 = (h) + EP1(e) + CH(e, f, g) + (ki) + (wi);                                                      \
+        (d) += __t1;                                                                                                   \
+        (h) = __t1 + EP0(a) + MAJ(a, b, c);                                                                            \
+    } while (0)
+
 /// Max data length for message scheduling expansion.
 #define SHA256_MAX_DATA_LENGTH (SHA256_BLOCK_SIZE * 2)
 
@@ -79,76 +107,96 @@ static const uint32_t k[SHA256_MAX_DATA_LENGTH] = {
     0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
     0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
 
-/// @brief Transforms the state of the SHA-256 context based on a block of input data.
-/// @param ctx Pointer to the SHA-256 context. Must not be NULL.
-/// @param data Input data block to process (64 bytes). Must not be NULL.
-static inline void __sha256_transform(SHA256_ctx_t *ctx, const uint8_t data[])
-{
-    // Error checks: Ensure the input parameters are not NULL.
-    if (!ctx) {
-        pr_err("SHA256 context is NULL.\n");
-        return;
-    }
-    if (!data) {
-        pr_err("Input data is NULL.\n");
-        return;
-    }
+/// @brief The initial hash values, the first 32 bits of the fractional parts
+/// of the square roots of the first 8 primes (2..19).
+static const uint32_t iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
 
-    uint32_t a, b, c, d, e, f, g, h, i, j, t1, t2;
-    uint32_t m[SHA256_MAX_DATA_LENGTH]; // Message schedule array.
+/// @brief Transforms the state with a sequence of blocks, in portable C.
+/// @param state The hash state.
+/// @param data The blocks.
+/// @param nblocks The number of blocks.
+static void __sha256_blocks(uint32_t state[8], const uint8_t *data, size_t nblocks)
+{
+    uint32_t a, b, c, d, e, f, g, h, i;
+    uint32_t w[16]; // Rolling window of the message schedule.
+
+    for (; nblocks; --nblocks, data += SHA256_MAX_DATA_LENGTH) {
+        a = state[0];
+        b = state[1];
+        c = state[2];
+        d = state[3];
+        e = state[4];
+        f = state[5];
+        g = state[6];
+        h = state[7];
+
+        // The first 16 rounds take the words straight from the input.
+        for (i = 0; i < 16; i += 8) {
+            ROUND(a, b, c, d, e, f, g, h, k[i + 0], w[i + 0] = LOAD_BE32(data + 4 * (i + 0)));
+            ROUND(h, a, b, c, d, e, f, g, k[i + 1], w[i + 1] = LOAD_BE32(data + 4 * (i + 1)));
+            ROUND(g, h, a, b, c, d, e, f, k[i + 2], w[i + 2] = LOAD_BE32(data + 4 * (i + 2)));
+            ROUND(f, g, h, a, b, c, d, e, k[i + 3], w[i + 3] = LOAD_BE32(data + 4 * (i + 3)));
+            ROUND(e, f, g, h, a, b, c, d, k[i + 4], w[i + 4] = LOAD_BE32(data + 4 * (i + 4)));
+            ROUND(d, e, f, g, h, a, b, c, k[i + 5], w[i + 5] = LOAD_BE32(data + 4 * (i + 5)));
+            ROUND(c, d, e, f, g, h, a, b, k[i + 6], w[i + 6] = LOAD_BE32(data + 4 * (i + 6)));
+            ROUND(b, c, d, e, f, g, h, a, k[i + 7], w[i + 7] = LOAD_BE32(data + 4 * (i + 7)));
+        }
+        // The other 48 extend the schedule in place.
+        for (; i < SHA256_MAX_DATA_LENGTH; i += 8) {
+            ROUND(a, b, c, d, e, f, g, h, k[i + 0], SCHEDULE(w, i + 0));
+            ROUND(h, a, b, c, d, e, f, g, k[i + 1], SCHEDULE(w, i + 1));
+            ROUND(g, h, a, b, c, d, e, f, k[i + 2], SCHEDULE(w, i + 2));
+            ROUND(f, g, h, a, b, c, d, e, k[i + 3], SCHEDULE(w, i + 3));
+            ROUND(e, f, g, h, a, b, c, d, k[i + 4], SCHEDULE(w, i + 4));
+            ROUND(d, e, f, g, h, a, b, c, k[i + 5], SCHEDULE(w, i + 5));
+            ROUND(c, d, e, f, g, h, a, b, k[i + 6], SCHEDULE(w, i + 6));
+            ROUND(b, c, d, e, f, g, h, a, k[i + 7], SCHEDULE(w, i + 7));
+        }
 
-    // Step 1: Prepare the message schedule (first 16 words are directly from
-    // the input data).
-    for (i = 0, j = 0; i < 16; ++i, j += 4) {
-        // Each 32-bit word is constructed from 4 consecutive 8-bit bytes from
-        // the input data.
-        m[i] = (uint32_t)(data[j] << 24) | (uint32_t)(data[j + 1] << 16) | (uint32_t)(data[j + 2] << 8) |
-               (uint32_t)(data[j + 3]);
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
     }
+}
 
-    // Step 2: Extend the first 16 words into the remaining 48 words of the
-    // message schedule. Each word is computed based on the previous words using
-    // the SIG1 and SIG0 functions.
-    for (; i < SHA256_MAX_DATA_LENGTH; ++i) {
-        m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
+/// @brief Pads the end of a message.
+/// @param tail Where the padded blocks are stored (128 bytes).
+/// @param rest The bytes of the message after the last full block.
+/// @param rest_length The number of these bytes, less than 64.
+/// @param bitlen The length of the whole message, in bits.
+/// @return The number of padded blocks, 1 or 2.
+static size_t __sha256_pad(uint8_t tail[], const uint8_t rest[], size_t rest_length, unsigned long long bitlen)
+{
+    // The length needs 8 bytes after the 0x80, otherwise it goes in a second block.
+    size_t nblocks = (rest_length < 56) ? 1 : 2;
+    size_t end     = nblocks * SHA256_MAX_DATA_LENGTH;
+
+    memmove(tail, rest, rest_length);
+    tail[rest_length] = 0x80;
+    memset(tail + rest_length + 1, 0, end - rest_length - 1);
+    for (size_t i = 1; i <= 8; ++i, bitlen >>= 8U) {
+        tail[end - i] = (uint8_t)bitlen;
     }
+    return nblocks;
+}
 
-    // Step 3: Initialize the working variables with the current state values.
-    a = ctx->state[0];
-    b = ctx->state[1];
-    c = ctx->state[2];
-    d = ctx->state[3];
-    e = ctx->state[4];
-    f = ctx->state[5];
-    g = ctx->state[6];
-    h = ctx->state[7];
-
-    // Step 4: Perform the main hash computation (64 rounds).
-    for (i = 0; i < SHA256_MAX_DATA_LENGTH; ++i) {
-        // Calculate the temporary values.
-        t1 = h + EP1(e) + CH(e, f, g) + k[i] + m[i];
-        t2 = EP0(a) + MAJ(a, b, c);
-
-        // Rotate the working variables for the next round.
-        h = g;
-        g = f;
-        f = e;
-        e = d + t1;
-        d = c;
-        c = b;
-        b = a;
-        a = t1 + t2;
+/// @brief Stores the hash state as the big endian digest.
+/// @param state The hash state.
+/// @param hash Where the digest is stored.
+static inline void __sha256_store(const uint32_t state[8], uint8_t hash[])
+{
+    for (uint32_t i = 0; i < 8; ++i) {
+        hash[4 * i]     = (uint8_t)(state[i] >> 24U);
+        hash[4 * i + 1] = (uint8_t)(state[i] >> 16U);
+        hash[4 * i + 2] = (uint8_t)(state[i] >> 8U);
+        hash[4 * i + 3] = (uint8_t)state[i];
     }
-
-    // Step 5: Add the resulting values back into the current state.
-    ctx->state[0] += a;
-    ctx->state[1] += b;
-    ctx->state[2] += c;
-    ctx->state[3] += d;
-    ctx->state[4] += e;
-    ctx->state[5] += f;
-    ctx->state[6] += g;
-    ctx->state[7] += h;
 }
 
 void sha256_bytes_to_hex(uint8_t *src, size_t src_length, char *out, size_t out_length)
@@ -186,14 +234,7 @@ void sha256_init(SHA256_ctx_t *ctx)
     ctx->bitlen = 0;
 
     // Initialize the state variables (hash values) to the SHA-256 initial constants.
-    ctx->state[0] = 0x6a09e667;
-    ctx->state[1] = 0xbb67ae85;
-    ctx->state[2] = 0x3c6ef372;
-    ctx->state[3] = 0xa54ff53a;
-    ctx->state[4] = 0x510e527f;
-    ctx->state[5] = 0x9b05688c;
-    ctx->state[6] = 0x1f83d9ab;
-    ctx->state[7] = 0x5be0cd19;
+    memcpy(ctx->state, iv, sizeof(iv));
 }
 
 void sha256_update(SHA256_ctx_t *ctx, const uint8_t data[], size_t len)
@@ -209,24 +250,34 @@ void sha256_update(SHA256_ctx_t *ctx, const uint8_t data[], size_t len)
         return; // Return early if the data is NULL to prevent errors.
     }
 
-    // Iterate over the input data, processing it in chunks.
-    for (uint32_t i = 0; i < len; ++i) {
-        // Add data to the context's buffer.
-        ctx->data[ctx->datalen] = data[i];
-        ctx->datalen++;
-
-        // If the buffer is full, process the data and reset the buffer.
-        if (ctx->datalen == SHA256_MAX_DATA_LENGTH) {
-            // Perform the SHA-256 transformation on the full data block.
-            __sha256_transform(ctx, ctx->data);
-
-            // Update the total length of the data processed so far in bits.
-            ctx->bitlen += 512;
-
-            // Reset the buffer length to 0 for the next chunk of data.
-            ctx->datalen = 0;
+    // Complete the block left in the buffer by the previous call.
+    if (ctx->datalen) {
+        size_t fill = SHA256_MAX_DATA_LENGTH - ctx->datalen;
+        if (len < fill) {
+            memcpy(ctx->data + ctx->datalen, data, len);
+            ctx->datalen += len;
+            return;
         }
+        memcpy(ctx->data + ctx->datalen, data, fill);
+        __sha256_blocks(ctx->state, ctx->data, 1);
+        ctx->bitlen += 512;
+        ctx->datalen = 0;
+        data += fill;
+        len -= fill;
     }
+
+    // Hash the full blocks straight from the input.
+    size_t nblocks = len / SHA256_MAX_DATA_LENGTH;
+    if (nblocks) {
+        __sha256_blocks(ctx->state, data, nblocks);
+        ctx->bitlen += 512ULL * nblocks;
+        data += nblocks * SHA256_MAX_DATA_LENGTH;
+        len -= nblocks * SHA256_MAX_DATA_LENGTH;
+    }
+
+    // Keep the rest for the next call.
+    memcpy(ctx->data, data, len);
+    ctx->datalen = (uint32_t)len;
 }
 
 void sha256_final(SHA256_ctx_t *ctx, uint8_t hash[])
@@ -241,69 +292,16 @@ void sha256_final(SHA256_ctx_t *ctx, uint8_t hash[])
         return; // Return early if the output buffer is NULL to prevent errors.
     }
 
-    // Get the current length of the data buffer.
-    uint32_t i = ctx->datalen;
-
-    // Step 1: Pad whatever data is left in the buffer.
-
-    // If there's enough space in the buffer (less than 56 bytes used), pad
-    // with 0x80 followed by zeros.
-    if (ctx->datalen < 56) {
-        // Append the padding byte (0x80).
-        ctx->data[i++] = 0x80;
-
-        // Pad the buffer with zeros until we reach 56 bytes.
-        while (i < 56) {
-            ctx->data[i++] = 0x00;
-        }
-    }
-    // If there's not enough space, pad the remaining buffer and process it.
-    else {
-        // Append the padding byte (0x80).
-        ctx->data[i++] = 0x80;
-
-        // Fill the rest of the buffer with zeros.
-        while (i < SHA256_MAX_DATA_LENGTH) {
-            ctx->data[i++] = 0x00;
-        }
-
-        // Process the full buffer.
-        __sha256_transform(ctx, ctx->data);
-
-        // Reset the buffer for the next padding.
-        memset(ctx->data, 0, 56);
-    }
+    uint8_t tail[2 * SHA256_MAX_DATA_LENGTH];
 
-    // Step 2: Append the total message length in bits and process the final block.
-
-    // Convert the total length from bytes to bits.
+    // Pad the data left in the buffer, and append the total length in bits.
     ctx->bitlen += ctx->datalen * 8;
+    size_t nblocks = __sha256_pad(tail, ctx->data, ctx->datalen, ctx->bitlen);
 
-    // Append the lower 8 bits of the length.
-    ctx->data[63] = ctx->bitlen;
-    ctx->data[62] = ctx->bitlen >> 8;
-    ctx->data[61] = ctx->bitlen >> 16;
-    ctx->data[60] = ctx->bitlen >> 24;
-    ctx->data[59] = ctx->bitlen >> 32;
-    ctx->data[58] = ctx->bitlen >> 40;
-    ctx->data[57] = ctx->bitlen >> 48;
-    ctx->data[56] = ctx->bitlen >> 56;
-
-    // Process the final block.
-    __sha256_transform(ctx, ctx->data);
-
-    // Step 3: Copy the final state (hash) to the output buffer.
+    // Process the final blocks.
+    __sha256_blocks(ctx->state, tail, nblocks);
 
     // SHA-256 uses big-endian byte order, so we reverse the byte order when
     // copying.
-    for (i = 0; i < 4; ++i) {
-        hash[i]      = (ctx->state[0] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 4]  = (ctx->state[1] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 8]  = (ctx->state[2] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 12] = (ctx->state[3] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 16] = (ctx->state[4] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 20] = (ctx->state[5] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 24] = (ctx->state[6] >> (24 - i * 8)) & 0x000000ff;
-        hash[i + 28] = (ctx->state[7] >> (24 - i * 8)) & 0x000000ff;
-    }
+    __sha256_store(ctx->state, hash);
 }
@@ -54,6 +54,8 @@ static const char *exception_messages[32] = {
 static interrupt_handler_t isr_routines[IDT_SIZE];
 /// @brief Descriptions of routines.
 static char *isr_routines_description[IDT_SIZE];
+/// @brief Number of times each routine was called.
+static unsigned long isr_routines_count[IDT_SIZE];
 
 /// @brief Default handler for exceptions.
 /// @param f CPU registers when calling this function.
@@ -103,6 +105,8 @@ void handle_gp_fault(pt_regs *frame)
 void isr_handler(pt_regs *f)
 {
     uint32_t isr_number = f->int_no;
+    // Count the exception (or system call).
+    ++isr_routines_count[isr_number];
     if (isr_number != 80) {
         //		pr_default("calling ISR %d\n", isr_number);
     }
@@ -140,3 +144,19 @@ int isr_uninstall_handler(unsigned i)
     isr_routines_description[i] = "NONE";
     return 0;
 }
+
+ssize_t isr_print_stats(char *buffer, size_t bufsize)
+{
+    int len = 0;
+    len += snprintf(buffer + len, bufsize - len, "%4s %10s  %s\n", "EXC", "COUNT", "DESCRIPTION");
+    for (unsigned i = 0; i < IDT_SIZE; ++i) {
+        // Show only the exceptions which were raised at least once.
+        if (isr_routines_count[i] == 0) {
+            continue;
+        }
+        len += snprintf(
+            buffer + len, bufsize - len, "%3u: %10lu  %s\n", i, isr_routines_count[i],
+            (i == SYSTEM_CALL) ? "System call" : (i < 32) ? exception_messages[i] : "no description");
+    }
+    return len;
+}
@@ -13,6 +13,7 @@
 #include "descriptor_tables/idt.h"
 #include "descriptor_tables/isr.h"
 #include "hardware/pic8259.h"
+#include "klib/math64.h"
 #include "process/scheduler.h"
 #include "stdio.h"
 #include "system/printk.h"
@@ -23,12 +24,38 @@ typedef struct irq_struct_t {
     interrupt_handler_t handler;
     /// Pointer to the description of the handler.
     char *description;
+    /// Number of times the handler was called.
+    unsigned long count;
+    /// Total CPU cycles spent inside the handler.
+    uint64_t cycles;
+    /// Maximum CPU cycles spent inside the handler by a single call.
+    uint32_t max_cycles;
     /// List handler.
     list_head siblings;
 } irq_struct_t;
 
+/// @brief Statistics of an IRQ line, or of a deferred activity.
+typedef struct irq_stat_t {
+    /// Number of times the line was raised.
+    unsigned long count;
+    /// Number of times the line was raised, but there was no handler.
+    unsigned long unhandled;
+    /// Number of spurious requests on the line.
+    unsigned long spurious;
+    /// Total CPU cycles spent serving the line.
+    uint64_t cycles;
+    /// Maximum CPU cycles spent serving the line in a single request.
+    uint32_t max_cycles;
+} irq_stat_t;
+
 /// For each IRQ, a chain of handlers.
 static list_head shared_interrupt_handlers[IRQ_NUM];
+/// For each IRQ, its statistics.
+static irq_stat_t irq_stats[IRQ_NUM];
+/// For each deferred activity, its statistics.
+static irq_stat_t softirq_stats[NR_SOFTIRQS];
+/// Names of the deferred activities.
+static const char *softirq_names[NR_SOFTIRQS] = {"TIMER"};
 /// Cache where we will store the data regarding an irq service.
 static kmem_cache_t *irq_cache;
 
@@ -42,6 +69,9 @@ static inline irq_struct_t *__irq_struct_alloc(void)
     // Initialize its fields.
     irq_struct->description = NULL;
     irq_struct->handler     = NULL;
+    irq_struct->count       = 0;
+    irq_struct->cycles      = 0;
+    irq_struct->max_cycles  = 0;
     list_head_init(&irq_struct->siblings);
     return irq_struct;
 }
@@ -107,27 +137,118 @@ int irq_uninstall_handler(unsigned i, interrupt_handler_t handler)
     return 0;
 }
 
+/// @brief Updates the cycle counters of a statistic.
+/// @param total the total number of cycles.
+/// @param max the maximum number of cycles.
+/// @param cycles the cycles we need to account.
+static inline void __irq_account_cycles(uint64_t *total, uint32_t *max, uint64_t cycles)
+{
+    *total += cycles;
+    if (cycles > *max) {
+        *max = (cycles > UINT32_MAX) ? UINT32_MAX : (uint32_t)cycles;
+    }
+}
+
 void irq_handler(pt_regs *f)
 {
     // Keep in mind,
     // because of irq mapping, the first PIC's irq line is shifted by 32.
     unsigned irq_line = f->int_no - 32;
     assert((irq_line < IRQ_NUM) && "Unidentified IRQ number.");
+    // Get the statistics of the line.
+    irq_stat_t *stat = &irq_stats[irq_line];
+    ++stat->count;
+    // Spurious requests must not be served, nor acknowledged.
+    if (pic8259_irq_is_spurious(irq_line)) {
+        ++stat->spurious;
+        return;
+    }
+    uint64_t line_start = rdtsc();
     // Actually, we may have several handlers for a same irq line.
     // The Kernel should provide the dev_id to each handler in order to
     // let it know if its own device generated the interrupt.
     // TODO: get dev_id
     if (list_head_empty(&shared_interrupt_handlers[irq_line])) {
+        ++stat->unhandled;
         pr_err("Thre are no handler for IRQ `%d`\n", irq_line);
     } else {
         list_for_each_decl (it, &shared_interrupt_handlers[irq_line]) {
             // Get the interrupt structure.
             irq_struct_t *irq_struct = list_entry(it, irq_struct_t, siblings);
             assert(irq_struct && "Something went wrong.");
-            // Call the interrupt function.
+            // Call the interrupt function, and measure it.
+            uint64_t handler_start = rdtsc();
             irq_struct->handler(f);
+            ++irq_struct->count;
+            __irq_account_cycles(&irq_struct->cycles, &irq_struct->max_cycles, rdtsc() - handler_start);
         }
     }
+    __irq_account_cycles(&stat->cycles, &stat->max_cycles, rdtsc() - line_start);
     // Send the end-of-interrupt to PIC.
     pic8259_send_eoi(irq_line);
+    // If the handlers woke up a task which must run before the current one,
+    // switch to it now rather than at the next tick.
+    scheduler_preempt(f);
+}
+
+void softirq_account(softirq_t nr, uint64_t cycles)
+{
+    if (nr < NR_SOFTIRQS) {
+        ++softirq_stats[nr].count;
+        __irq_account_cycles(&softirq_stats[nr].cycles, &softirq_stats[nr].max_cycles, cycles);
+    }
+}
+
+/// @brief Converts cycles to thousands of cycles.
+/// @details Only the lower 32 bits of the result are printed, and those can
+/// be computed with a single divl once the high part is reduced modulo 1000.
+/// @param cycles the number of cycles.
+/// @return the lower 32 bits of the number of thousands of cycles.
+static inline unsigned long __kcycles(uint64_t cycles)
+{
+    uint64_t high = (uint32_t)(cycles >> 32U) % 1000U;
+    return div_u64_u32((high << 32U) | (uint32_t)cycles, 1000U, NULL);
+}
+
+ssize_t irq_print_stats(char *buffer, size_t bufsize)
+{
+    int len = 0;
+    len += snprintf(
+        buffer + len, bufsize - len, "%4s %10s %10s %10s %14s %10s  %s\n", "IRQ", "COUNT", "UNHANDLED", "SPURIOUS",
+        "TOTAL(kcyc)", "MAX(cyc)", "HANDLERS");
+    for (unsigned i = 0; i < IRQ_NUM; ++i) {
+        irq_stat_t *stat = &irq_stats[i];
+        len += snprintf(
+            buffer + len, bufsize - len, "%3u: %10lu %10lu %10lu %14lu %10u ", i, stat->count, stat->unhandled,
+            stat->spurious, __kcycles(stat->cycles), stat->max_cycles);
+        list_for_each_decl (it, &shared_interrupt_handlers[i]) {
+            irq_struct_t *irq_struct = list_entry(it, irq_struct_t, siblings);
+            len += snprintf(buffer + len, bufsize - len, " %s", irq_struct->description);
+        }
+        len += snprintf(buffer + len, bufsize - len, "\n");
+        // When the line is shared, show the details of each handler.
+        if (shared_interrupt_handlers[i].next != shared_interrupt_handlers[i].prev) {
+            list_for_each_decl (it, &shared_interrupt_handlers[i]) {
+                irq_struct_t *irq_struct = list_entry(it, irq_struct_t, siblings);
+                len += snprintf(
+                    buffer + len, bufsize - len, "%4s %10lu %10s %10s %14lu %10u   %s\n", "", irq_struct->count, "-",
+                    "-", __kcycles(irq_struct->cycles), irq_struct->max_cycles,
+                    irq_struct->description);
+            }
+        }
+    }
+    return len;
+}
+
+ssize_t softirq_print_stats(char *buffer, size_t bufsize)
+{
+    int len = 0;
+    len += snprintf(
+        buffer + len, bufsize - len, "%8s %10s %14s %10s\n", "SOFTIRQ", "COUNT", "TOTAL(kcyc)", "MAX(cyc)");
+    for (unsigned i = 0; i < NR_SOFTIRQS; ++i) {
+        len += snprintf(
+            buffer + len, bufsize - len, "%7s: %10lu %14lu %10u\n", softirq_names[i], softirq_stats[i].count,
+            __kcycles(softirq_stats[i].cycles), softirq_stats[i].max_cycles);
+    }
+    return len;
 }
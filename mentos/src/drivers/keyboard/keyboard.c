@@ -20,6 +20,7 @@
 #include "io/port_io.h"
 #include "io/video.h"
 #include "process/scheduler.h"
+#include "process/wait.h"
 #include "ring_buffer.h"
 #include "string.h"
 #include "sys/bitops.h"
@@ -32,6 +33,9 @@ static uint32_t kflags  = 0;
 rb_keybuffer_t scancodes;
 /// Spinlock to protect access to the scancode buffer.
 spinlock_t scancodes_lock;
+/// The processes waiting for a keypress.
+static wait_queue_head_t keyboard_queue = {
+    .task_list = {.next = &keyboard_queue.task_list, .prev = &keyboard_queue.task_list}};
 
 #define KBD_LEFT_SHIFT    (1 << 0) ///< Flag which identifies the left shift.
 #define KBD_RIGHT_SHIFT   (1 << 1) ///< Flag which identifies the right shift.
@@ -386,6 +390,10 @@ void keyboard_isr(pt_regs *f)
             keyboard_push_front(keymap->normal);
         }
     }
+    // Wake up the readers, the interrupt handler switches to them if needed.
+    if (!rb_keybuffer_is_empty(&scancodes)) {
+        wake_up_all(&keyboard_queue);
+    }
     pic8259_send_eoi(IRQ_KEYBOARD);
 }
 
@@ -405,6 +413,8 @@ void keyboard_enable(void) { outportb(0x60, 0xF4); }
 
 void keyboard_disable(void) { outportb(0x60, 0xF5); }
 
+int keyboard_wait(void) { return interruptible_sleep_on(&keyboard_queue); }
+
 int keyboard_initialize(void)
 {
     // Initialize the ring-buffer for the scancodes.
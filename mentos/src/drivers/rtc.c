@@ -11,9 +11,8 @@
 #define __DEBUG_LEVEL__  LOGLEVEL_NOTICE ///< Set log level.
 #include "io/debug.h"                    // Include debugging functions.
 
-#include "descriptor_tables/isr.h"
 #include "drivers/rtc.h"
-#include "hardware/pic8259.h"
+#include "hardware/timer.h"
 #include "io/port_io.h"
 #include "kernel.h"
 #include "string.h"
@@ -21,12 +20,8 @@
 #define CMOS_ADDR 0x70 ///< Addess where we need to write the Address.
 #define CMOS_DATA 0x71 ///< Addess where we need to write the Data.
 
-/// Current global time.
-tm_t global_time;
-/// Previous global time.
-tm_t previous_global_time;
 /// Data type is BCD.
-int is_bcd;
+static int is_bcd;
 
 /// @brief Checks if the two time values are different.
 /// @param t0 the first time value.
@@ -91,92 +86,103 @@ static inline void write_register(unsigned char reg, unsigned char value)
 static inline unsigned char bcd2bin(unsigned char bcd) { return ((bcd >> 4U) * 10) + (bcd & 0x0FU); }
 
 /// @brief Reads the current datetime value from a real-time clock.
-static inline void rtc_read_datetime(void)
+/// @param time where the datetime is stored, the month goes from 1 to 12
+/// and the year is complete.
+static inline void rtc_read_datetime(tm_t *time)
 {
-    if (read_register(0x0CU) & 0x10U) {
-        if (is_bcd) {
-            global_time.tm_sec  = bcd2bin(read_register(0x00));
-            global_time.tm_min  = bcd2bin(read_register(0x02));
-            global_time.tm_hour = bcd2bin(read_register(0x04)) + 2;
-            global_time.tm_mon  = bcd2bin(read_register(0x08));
-            global_time.tm_year = bcd2bin(read_register(0x09)) + 2000;
-            global_time.tm_wday = bcd2bin(read_register(0x06));
-            global_time.tm_mday = bcd2bin(read_register(0x07));
-        } else {
-            global_time.tm_sec  = read_register(0x00);
-            global_time.tm_min  = read_register(0x02);
-            global_time.tm_hour = read_register(0x04) + 2;
-            global_time.tm_mon  = read_register(0x08);
-            global_time.tm_year = read_register(0x09) + 2000;
-            global_time.tm_wday = read_register(0x06);
-            global_time.tm_mday = read_register(0x07);
-        }
+    if (is_bcd) {
+        time->tm_sec  = bcd2bin(read_register(0x00));
+        time->tm_min  = bcd2bin(read_register(0x02));
+        time->tm_hour = bcd2bin(read_register(0x04));
+        time->tm_mon  = bcd2bin(read_register(0x08));
+        time->tm_year = bcd2bin(read_register(0x09)) + 2000;
+        time->tm_wday = bcd2bin(read_register(0x06));
+        time->tm_mday = bcd2bin(read_register(0x07));
+    } else {
+        time->tm_sec  = read_register(0x00);
+        time->tm_min  = read_register(0x02);
+        time->tm_hour = read_register(0x04);
+        time->tm_mon  = read_register(0x08);
+        time->tm_year = read_register(0x09) + 2000;
+        time->tm_wday = read_register(0x06);
+        time->tm_mday = read_register(0x07);
     }
 }
 
-/// @brief Updates the internal datetime value.
-static inline void rtc_update_datetime(void)
+/// @brief Reads a consistent datetime value, namely the same in two
+/// consecutive reads, outside of an update of the RTC.
+/// @param time where the datetime is stored.
+static inline void rtc_read_stable_datetime(tm_t *time)
 {
-    static unsigned int first_update = 1;
+    tm_t previous;
     // Wait until rtc is not updating.
     while (is_updating_rtc()) {
     }
-    // Read the values.
-    rtc_read_datetime();
-    if (first_update) {
-        do {
-            // Save the previous global time.
-            previous_global_time = global_time;
-            // Wait until rtc is not updating.
-            while (is_updating_rtc()) {
-            }
-            // Read the values.
-            rtc_read_datetime();
-        } while (!rtc_are_different(&previous_global_time, &global_time));
-        first_update = 0;
-    }
+    rtc_read_datetime(time);
+    do {
+        previous = *time;
+        // Wait until rtc is not updating.
+        while (is_updating_rtc()) {
+        }
+        rtc_read_datetime(time);
+    } while (rtc_are_different(&previous, time));
 }
 
-/// @brief Callback for RTC.
-/// @param f the current registers.
-static inline void rtc_handler_isr(pt_regs *f) { rtc_update_datetime(); }
-
-void gettime(tm_t *time)
+/// @brief Converts a datetime read from the RTC to seconds since the Epoch.
+/// @param time the datetime, the month goes from 1 to 12.
+/// @return the seconds since the Epoch.
+static inline time_t rtc_mktime(const tm_t *time)
 {
-    // Copy the update time.
-    memcpy(time, &global_time, sizeof(tm_t));
+    int year  = time->tm_year;
+    int month = time->tm_mon;
+    // January and February are counted as months 13 and 14 of the previous year.
+    if (month <= 2) {
+        month += 12;
+        year -= 1;
+    }
+    time_t t;
+    // Convert years to days
+    t = (365 * year) + (year / 4) - (year / 100) + (year / 400);
+    // Convert months to days
+    t += (30 * month) + (3 * (month + 1) / 5) + time->tm_mday;
+    // Unix time starts on January 1st, 1970
+    t -= 719561;
+    // Convert days to seconds
+    t *= 86400;
+    // Add hours, minutes and seconds
+    t += (3600 * time->tm_hour) + (60 * time->tm_min) + time->tm_sec;
+    return t;
 }
 
 int rtc_initialize(void)
 {
     unsigned char status;
+    tm_t boot_time, current_time;
+    timespec_t now;
 
     status = read_register(0x0B);
     status |= 0x02U;            // 24 hour clock
-    status |= 0x10U;            // update ended interrupts
+    status &= ~0x10U;           // no update ended interrupts
     status &= ~0x20U;           // no alarm interrupts
     status &= ~0x40U;           // no periodic interrupt
     is_bcd = !(status & 0x04U); // check if data type is BCD
     write_register(0x0B, status);
 
-    read_register(0x0C);
-
-    // Install the IRQ.
-    irq_install_handler(IRQ_REAL_TIME_CLOCK, rtc_handler_isr, "Real Time Clock (RTC)");
-    // Enable the IRQ.
-    pic8259_irq_enable(IRQ_REAL_TIME_CLOCK);
-    // Wait until rtc is ready.
-    rtc_update_datetime();
+    // The RTC is read only once, afterwards the wall clock is kept by the
+    // timer. Wait for the beginning of a second, so that the wall clock
+    // starts aligned with it.
+    rtc_read_stable_datetime(&boot_time);
+    do {
+        rtc_read_stable_datetime(&current_time);
+    } while (!rtc_are_different(&boot_time, &current_time));
+
+    now.tv_sec  = rtc_mktime(&current_time);
+    now.tv_nsec = 0;
+    timer_set_realtime(&now);
+    pr_debug("Wall clock set to %u seconds since the Epoch.\n", now.tv_sec);
     return 0;
 }
 
-int rtc_finalize(void)
-{
-    // Uninstall the IRQ.
-    irq_uninstall_handler(IRQ_REAL_TIME_CLOCK, rtc_handler_isr);
-    // Disable the IRQ.
-    pic8259_irq_disable(IRQ_REAL_TIME_CLOCK);
-    return 0;
-}
+int rtc_finalize(void) { return 0; }
 
 /// @}
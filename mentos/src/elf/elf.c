@@ -293,7 +293,7 @@ int elf_load_file(task_struct *task, vfs_file_t *file, uint32_t *entry)
         return false;
     }
     // Allocate the memory for the file.
-    char *buffer = kmalloc(stat_buf.st_size);
+    char *buffer = kvmalloc(stat_buf.st_size);
     if (buffer == NULL) {
         pr_err(
             "Failed to allocate %d bytes of memory for reading the file "
@@ -334,10 +334,10 @@ int elf_load_file(task_struct *task, vfs_file_t *file, uint32_t *entry)
     // Set the entry.
     (*entry) = header->entry;
 
-    kfree(buffer);
+    kvfree(buffer);
     return true;
 return_error_free_buffer:
-    kfree(buffer);
+    kvfree(buffer);
     return false;
 }
 
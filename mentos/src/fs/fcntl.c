@@ -4,6 +4,7 @@
 /// See LICENSE.md for details.
 
 #include "errno.h"
+#include "fs/locks.h"
 #include "fs/vfs.h"
 #include "process/scheduler.h"
 #include "system/syscall.h"
@@ -27,6 +28,20 @@ long sys_fcntl(int fd, unsigned int request, unsigned long data)
         return -ENOSYS;
     }
 
+    // The advisory locks are handled by the VFS, for all the filesystems.
+    if ((request == F_GETLK) || (request == F_SETLK) || (request == F_SETLKW)) {
+        return fcntl_lock(file, vfd->flags_mask, request, (flock_t *)data);
+    }
+
     // Perform the ioctl operation.
     return vfs_fcntl(file, request, data);
 }
+
+int sys_flock(int fd, int operation)
+{
+    task_struct *task = scheduler_get_current_process();
+    if ((fd < 0) || (fd >= task->max_fd) || (task->fd_list[fd].file_struct == NULL)) {
+        return -EBADF;
+    }
+    return flock_lock(task->fd_list[fd].file_struct, operation);
+}
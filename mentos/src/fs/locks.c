@@ -0,0 +1,432 @@
+/// @file locks.c
+/// @brief Advisory file locks: POSIX record locks (fcntl) and whole-file locks (flock).
+/// @details
+/// The locks of a file are kept in a list sorted by starting offset, so that
+/// looking for the locks overlapping a range stops at the first lock starting
+/// after it. A process never owns overlapping locks of the same kind: placing
+/// a lock replaces, splits, or merges the ones it already owns on the range.
+/// A process which has to wait for a lock records which process it waits for,
+/// so that a cycle of waits is detected, and reported with EDEADLK, before
+/// the last process goes to sleep.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+// Setup the logging for this file (do this before any other include).
+#include "sys/kernel_levels.h"           // Include kernel log levels.
+#define __DEBUG_HEADER__ "[LOCKS ]"      ///< Change header.
+#define __DEBUG_LEVEL__  LOGLEVEL_NOTICE ///< Set log level.
+#include "io/debug.h"                    // Include debugging functions.
+
+#include "fs/locks.h"
+
+#include "errno.h"
+#include "limits.h"
+#include "math.h"
+#include "mem/slab.h"
+#include "process/scheduler.h"
+#include "stdio.h"
+#include "sys/file.h"
+#include "system/signal.h"
+
+/// The highest offset, used as the end of the locks extending to the end of the file.
+#define OFFSET_MAX LONG_MAX
+/// The longest chain of waiting processes we follow when looking for a deadlock.
+#define MAX_DEADLK_DEPTH 64
+
+/// @brief A process waiting for a lock.
+typedef struct lock_waiter {
+    /// Link inside the list of waiters.
+    list_head list;
+    /// The waiting process.
+    pid_t pid;
+    /// The process holding the lock it waits for.
+    pid_t blocker;
+} lock_waiter_t;
+
+/// The lock contexts of all the files with locks or waiters.
+static list_head lock_contexts = {.next = &lock_contexts, .prev = &lock_contexts};
+/// The processes waiting for a lock.
+static list_head lock_waiters = {.next = &lock_waiters, .prev = &lock_waiters};
+
+/// @brief Returns the lock context of the file, allocating it if needed.
+/// @param file the file.
+/// @param create whether the context must be allocated if missing.
+/// @return the context, NULL if it is missing or cannot be allocated.
+static inline file_lock_context_t *__locks_get_context(vfs_file_t *file, int create)
+{
+    if (file->flctx || !create) {
+        return file->flctx;
+    }
+    file_lock_context_t *context = kmalloc(sizeof(file_lock_context_t));
+    if (!context) {
+        pr_err("Failed to allocate the lock context of `%s`.\n", file->name);
+        return NULL;
+    }
+    list_head_init(&context->locks);
+    wait_queue_head_init(&context->wait);
+    list_head_insert_before(&context->list, &lock_contexts);
+    file->flctx = context;
+    return context;
+}
+
+/// @brief Checks if two locks conflict.
+/// @param held the lock which is held.
+/// @param request the requested lock.
+/// @return 1 if they conflict, 0 otherwise.
+static inline int __locks_conflict(const file_lock_t *held, const file_lock_t *request)
+{
+    // Locks of the same process, or placed in different ways, never conflict.
+    if ((held->pid == request->pid) || (held->flags != request->flags)) {
+        return 0;
+    }
+    if ((held->end < request->start) || (held->start > request->end)) {
+        return 0;
+    }
+    return (held->type == F_WRLCK) || (request->type == F_WRLCK);
+}
+
+/// @brief Finds the first lock conflicting with the request.
+/// @param context the locks of the file.
+/// @param request the requested lock.
+/// @return the conflicting lock, NULL if there is none.
+static inline file_lock_t *__locks_find_conflict(file_lock_context_t *context, const file_lock_t *request)
+{
+    list_for_each_decl (it, &context->locks) {
+        file_lock_t *held = list_entry(it, file_lock_t, list);
+        // The locks are sorted, the following ones start after the range.
+        if (held->start > request->end) {
+            break;
+        }
+        if (__locks_conflict(held, request)) {
+            return held;
+        }
+    }
+    return NULL;
+}
+
+/// @brief Inserts a lock, keeping the list sorted by starting offset.
+/// @param context the locks of the file.
+/// @param lock the lock.
+static inline void __locks_insert(file_lock_context_t *context, file_lock_t *lock)
+{
+    list_head *position = &context->locks;
+    list_for_each_decl (it, &context->locks) {
+        if (list_entry(it, file_lock_t, list)->start > lock->start) {
+            position = it;
+            break;
+        }
+    }
+    list_head_insert_before(&lock->list, position);
+}
+
+/// @brief Returns the waiter record of a process.
+/// @param pid the process.
+/// @return the record, NULL if the process is not waiting.
+static inline lock_waiter_t *__locks_find_waiter(pid_t pid)
+{
+    list_for_each_decl (it, &lock_waiters) {
+        lock_waiter_t *waiter = list_entry(it, lock_waiter_t, list);
+        if (waiter->pid == pid) {
+            return waiter;
+        }
+    }
+    return NULL;
+}
+
+/// @brief Removes the waiter record of a process, if any.
+/// @param pid the process.
+static inline void __locks_stop_waiting(pid_t pid)
+{
+    lock_waiter_t *waiter = __locks_find_waiter(pid);
+    if (waiter) {
+        list_head_remove(&waiter->list);
+        kfree(waiter);
+    }
+}
+
+/// @brief Checks if waiting for the blocker would close a cycle of waits.
+/// @param pid the process which wants to wait.
+/// @param blocker the process holding the lock.
+/// @return 1 if it would cause a deadlock, 0 otherwise.
+static inline int __locks_would_deadlock(pid_t pid, pid_t blocker)
+{
+    for (int depth = 0; depth < MAX_DEADLK_DEPTH; ++depth) {
+        if (blocker == pid) {
+            return 1;
+        }
+        lock_waiter_t *waiter = __locks_find_waiter(blocker);
+        if (!waiter) {
+            return 0;
+        }
+        blocker = waiter->blocker;
+    }
+    return 0;
+}
+
+/// @brief Puts the current process to sleep until the locks of the file change.
+/// @param context the locks of the file.
+/// @param blocker the process holding the conflicting lock.
+/// @return 0 when woken up, -EDEADLK, -EINTR or -ENOLCK on failure.
+static inline int __locks_wait(file_lock_context_t *context, pid_t blocker)
+{
+    task_struct *current = scheduler_get_current_process();
+    if (signal_interrupt_pending(current)) {
+        __locks_stop_waiting(current->pid);
+        return -EINTR;
+    }
+    if (__locks_would_deadlock(current->pid, blocker)) {
+        __locks_stop_waiting(current->pid);
+        return -EDEADLK;
+    }
+    lock_waiter_t *waiter = __locks_find_waiter(current->pid);
+    if (!waiter) {
+        if (!(waiter = kmalloc(sizeof(lock_waiter_t)))) {
+            return -ENOLCK;
+        }
+        waiter->pid = current->pid;
+        list_head_insert_before(&waiter->list, &lock_waiters);
+    }
+    waiter->blocker = blocker;
+    if (interruptible_sleep_on(&context->wait) < 0) {
+        __locks_stop_waiting(current->pid);
+        return -EINTR;
+    }
+    return 0;
+}
+
+/// @brief Places the request, replacing the locks the process already owns
+/// on its range. An F_UNLCK request only removes them.
+/// @param context the locks of the file.
+/// @param request the request, it is not modified.
+/// @return 0 on success, -ENOLCK if we ran out of memory.
+static int __locks_apply(file_lock_context_t *context, const file_lock_t *request)
+{
+    // Allocate in advance the new lock, and the one we need if we split an
+    // existing lock in two, so that we do not fail half-way.
+    file_lock_t *lock  = kmalloc(sizeof(file_lock_t));
+    file_lock_t *split = kmalloc(sizeof(file_lock_t));
+    if (!lock || !split) {
+        if (lock) {
+            kfree(lock);
+        }
+        if (split) {
+            kfree(split);
+        }
+        return -ENOLCK;
+    }
+    *lock = *request;
+    list_for_each_safe_decl(it, store, &context->locks)
+    {
+        file_lock_t *held = list_entry(it, file_lock_t, list);
+        if ((held->pid != request->pid) || (held->flags != request->flags)) {
+            continue;
+        }
+        // Merge the adjacent or overlapping locks of the same type.
+        if ((held->type == request->type) && (request->type != F_UNLCK) &&
+            ((held->end == OFFSET_MAX) || (held->end + 1 >= lock->start)) &&
+            ((lock->end == OFFSET_MAX) || (lock->end + 1 >= held->start))) {
+            lock->start = min(lock->start, held->start);
+            lock->end   = max(lock->end, held->end);
+            list_head_remove(&held->list);
+            kfree(held);
+            continue;
+        }
+        // Leave the locks outside the range.
+        if ((held->end < request->start) || (held->start > request->end)) {
+            continue;
+        }
+        if ((held->start < request->start) && (held->end > request->end)) {
+            // The range is in the middle of the lock: split it in two.
+            *split       = *held;
+            split->start = request->end + 1;
+            held->end    = request->start - 1;
+            __locks_insert(context, split);
+            split = NULL;
+        } else if (held->start < request->start) {
+            held->end = request->start - 1;
+        } else if (held->end > request->end) {
+            // The lock starts later now, move it to keep the list sorted.
+            held->start = request->end + 1;
+            list_head_remove(&held->list);
+            __locks_insert(context, held);
+        } else {
+            list_head_remove(&held->list);
+            kfree(held);
+        }
+    }
+    if (request->type != F_UNLCK) {
+        __locks_insert(context, lock);
+    } else {
+        kfree(lock);
+    }
+    if (split) {
+        kfree(split);
+    }
+    // The waiters check again if they can get their lock.
+    wake_up_all(&context->wait);
+    return 0;
+}
+
+/// @brief Places a lock, or waits for it.
+/// @param file the file.
+/// @param request the lock.
+/// @param wait whether the process sleeps if the lock is held by another process.
+/// @return 0 on success, a negative error otherwise.
+static int __locks_set(vfs_file_t *file, const file_lock_t *request, int wait)
+{
+    file_lock_context_t *context = __locks_get_context(file, request->type != F_UNLCK);
+    if (!context) {
+        // Nothing to unlock, or no memory for the context.
+        return (request->type == F_UNLCK) ? 0 : -ENOLCK;
+    }
+    if (request->type != F_UNLCK) {
+        // Sleep until the locks which conflict with the request are released.
+        file_lock_t *conflict;
+        while ((conflict = __locks_find_conflict(context, request))) {
+            if (!wait) {
+                return -EAGAIN;
+            }
+            int ret = __locks_wait(context, conflict->pid);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+    }
+    __locks_stop_waiting(request->pid);
+    return __locks_apply(context, request);
+}
+
+long fcntl_lock(vfs_file_t *file, int flags_mask, unsigned int request, flock_t *lock)
+{
+    file_lock_t request_lock;
+    off_t base;
+    if (!lock) {
+        return -EFAULT;
+    }
+    // Compute the range, relative to the beginning of the file.
+    if (lock->l_whence == SEEK_SET) {
+        base = 0;
+    } else if (lock->l_whence == SEEK_CUR) {
+        base = (off_t)file->f_pos;
+    } else if (lock->l_whence == SEEK_END) {
+        base = (off_t)file->length;
+    } else {
+        return -EINVAL;
+    }
+    request_lock.start = base + lock->l_start;
+    if (lock->l_len > 0) {
+        request_lock.end = request_lock.start + lock->l_len - 1;
+    } else if (lock->l_len < 0) {
+        // A negative length locks the bytes before the start.
+        request_lock.end   = request_lock.start - 1;
+        request_lock.start = request_lock.start + lock->l_len;
+    } else {
+        request_lock.end = OFFSET_MAX;
+    }
+    if ((request_lock.start < 0) || (request_lock.end < request_lock.start)) {
+        return -EINVAL;
+    }
+    if ((lock->l_type != F_RDLCK) && (lock->l_type != F_WRLCK) && (lock->l_type != F_UNLCK)) {
+        return -EINVAL;
+    }
+    request_lock.pid   = scheduler_get_current_process()->pid;
+    request_lock.type  = lock->l_type;
+    request_lock.flags = FL_POSIX;
+
+    if (request == F_GETLK) {
+        file_lock_context_t *context = __locks_get_context(file, 0);
+        file_lock_t *conflict        = context ? __locks_find_conflict(context, &request_lock) : NULL;
+        if (!conflict) {
+            lock->l_type = F_UNLCK;
+            return 0;
+        }
+        lock->l_type   = conflict->type;
+        lock->l_whence = SEEK_SET;
+        lock->l_start  = conflict->start;
+        lock->l_len    = (conflict->end == OFFSET_MAX) ? 0 : (conflict->end - conflict->start + 1);
+        lock->l_pid    = conflict->pid;
+        return 0;
+    }
+    // The descriptor must allow the access the lock protects.
+    if ((lock->l_type == F_RDLCK) && ((flags_mask & O_ACCMODE) == O_WRONLY)) {
+        return -EBADF;
+    }
+    if ((lock->l_type == F_WRLCK) && ((flags_mask & O_ACCMODE) == O_RDONLY)) {
+        return -EBADF;
+    }
+    return __locks_set(file, &request_lock, request == F_SETLKW);
+}
+
+int flock_lock(vfs_file_t *file, int operation)
+{
+    file_lock_t request_lock;
+    switch (operation & ~LOCK_NB) {
+    case LOCK_SH:
+        request_lock.type = F_RDLCK;
+        break;
+    case LOCK_EX:
+        request_lock.type = F_WRLCK;
+        break;
+    case LOCK_UN:
+        request_lock.type = F_UNLCK;
+        break;
+    default:
+        return -EINVAL;
+    }
+    request_lock.pid   = scheduler_get_current_process()->pid;
+    request_lock.flags = FL_FLOCK;
+    request_lock.start = 0;
+    request_lock.end   = OFFSET_MAX;
+    return __locks_set(file, &request_lock, !(operation & LOCK_NB));
+}
+
+/// @brief Removes all the locks of a process from a file.
+/// @param context the locks of the file.
+/// @param pid the process.
+static inline void __locks_remove_pid(file_lock_context_t *context, pid_t pid)
+{
+    int removed = 0;
+    list_for_each_safe_decl(it, store, &context->locks)
+    {
+        file_lock_t *held = list_entry(it, file_lock_t, list);
+        if (held->pid == pid) {
+            list_head_remove(&held->list);
+            kfree(held);
+            removed = 1;
+        }
+    }
+    if (removed) {
+        wake_up_all(&context->wait);
+    }
+}
+
+void locks_remove_file(vfs_file_t *file)
+{
+    if (file->flctx) {
+        __locks_remove_pid(file->flctx, scheduler_get_current_process()->pid);
+    }
+}
+
+void locks_remove_task(pid_t pid)
+{
+    __locks_stop_waiting(pid);
+    list_for_each_decl (it, &lock_contexts) {
+        __locks_remove_pid(list_entry(it, file_lock_context_t, list), pid);
+    }
+}
+
+void locks_free_context(vfs_file_t *file)
+{
+    if (!file->flctx) {
+        return;
+    }
+    list_for_each_safe_decl(it, store, &file->flctx->locks)
+    {
+        file_lock_t *held = list_entry(it, file_lock_t, list);
+        list_head_remove(&held->list);
+        kfree(held);
+    }
+    list_head_remove(&file->flctx->list);
+    kfree(file->flctx);
+    file->flctx = NULL;
+}
@@ -5,6 +5,7 @@
 
 #include "errno.h"
 #include "fcntl.h"
+#include "fs/locks.h"
 #include "fs/vfs.h"
 #include "io/debug.h"
 #include "limits.h"
@@ -72,6 +73,9 @@ int sys_close(int fd)
     // Remove the reference to the file.
     task->fd_list[fd].file_struct = NULL;
 
+    // Closing any descriptor of the file releases the locks of the process.
+    locks_remove_file(file);
+
     // Call the close function.
     return vfs_close(file);
 }
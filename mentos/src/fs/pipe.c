@@ -23,7 +23,9 @@
 #include "fcntl.h"
 #include "fs/vfs.h"
 #include "list_head.h"
+#include "math.h"
 #include "mem/kheap.h"
+#include "process/scheduler.h"
 #include "stdio.h"
 #include "stdlib.h"
 #include "strerror.h"
@@ -32,6 +34,9 @@
 #include "system/syscall.h"
 #include "time.h"
 
+/// The capacity of new pipes in bytes.
+int sysctl_fs_pipe_size = PIPE_DEFAULT_BUFFERS * PIPE_BUFFER_SIZE;
+
 // ============================================================================
 // Virtual FileSystem (VFS) Operaions
 // ============================================================================
@@ -162,7 +167,7 @@ static inline pipe_inode_info_t *__pipe_inode_info_alloc(struct pipe_buf_operati
     mutex_unlock(&pipe_info->mutex);
 
     // Set the number of buffers.
-    pipe_info->numbuf = PIPE_NUM_BUFFERS;
+    pipe_info->numbuf = max(1, min(sysctl_fs_pipe_size / PIPE_BUFFER_SIZE, PIPE_NUM_BUFFERS));
 
     // Initialize each buffer in the buffer array.
     for (unsigned int i = 0; i < pipe_info->numbuf; ++i) {
@@ -212,8 +217,12 @@ static inline void __pipe_inode_info_dealloc(pipe_inode_info_t *pipe_info)
 
 /// @brief Converts a linear index to the corresponding buffer index within the buffer limit.
 /// @param index The linear index.
-/// @return The buffer index within [0, PIPE_NUM_BUFFERS - 1].
-static inline size_t pipe_linear_to_buffer_index(size_t index) { return (index / PIPE_BUFFER_SIZE) % PIPE_NUM_BUFFERS; }
+/// @param numbuf The number of buffers of the pipe.
+/// @return The buffer index within [0, numbuf - 1].
+static inline size_t pipe_linear_to_buffer_index(size_t index, size_t numbuf)
+{
+    return (index / PIPE_BUFFER_SIZE) % numbuf;
+}
 
 /// @brief Calculates the offset within the specified buffer from a linear index.
 /// @param index The linear index.
@@ -497,9 +506,12 @@ int pipe_read_wake_function(wait_queue_entry_t *wait, unsigned mode, int sync)
     // Validate that data is available in the pipe for reading.
     if ((pipe_info_has_data(pipe_info) > 0) || (pipe_info->writers == 0)) {
         // Check if the task is in an appropriate sleep state to be woken up.
-        if ((wait->task->state == TASK_UNINTERRUPTIBLE) || (wait->task->state == TASK_STOPPED)) {
+        if ((wait->task->state == TASK_INTERRUPTIBLE) || (wait->task->state == TASK_UNINTERRUPTIBLE) ||
+            (wait->task->state == TASK_STOPPED)) {
             // Set the task's state to the specified wake-up mode.
             wait->task->state = mode;
+            // Check if the task must preempt the current one.
+            sched_class_check_preempt(&runqueue, wait->task);
 
             // Signal that the task has been woken up.
             pr_debug("Data available or no more writers, waking up reader %d.\n", wait->task->pid);
@@ -533,10 +545,13 @@ int pipe_write_wake_function(wait_queue_entry_t *wait, unsigned mode, int sync)
 
     // Check if there is available space in the pipe for writing.
     if (pipe_info_has_space(pipe_info) > 0) {
-        // Only tasks in the state TASK_UNINTERRUPTIBLE or TASK_STOPPED can be woken up.
-        if ((wait->task->state == TASK_UNINTERRUPTIBLE) || (wait->task->state == TASK_STOPPED)) {
+        // Only sleeping or stopped tasks can be woken up.
+        if ((wait->task->state == TASK_INTERRUPTIBLE) || (wait->task->state == TASK_UNINTERRUPTIBLE) ||
+            (wait->task->state == TASK_STOPPED)) {
             // Set the wake-up mode for the task.
             wait->task->state = mode;
+            // Check if the task must preempt the current one.
+            sched_class_check_preempt(&runqueue, wait->task);
 
             // Signal that the task has been woken up.
             pr_debug("Space available, waking up writer %d.\n", wait->task->pid);
@@ -579,12 +594,14 @@ static void pipe_wake_up_tasks(wait_queue_head_t *wait_queue, const char *debug_
     }
 }
 
-/// @brief Puts the current process to sleep on the specified wait queue if blocking is needed.
+/// @brief Puts the current process to sleep on the specified wait queue, until
+/// the condition is met. The mutex of the pipe, held by the caller, is released
+/// while sleeping, and taken again before returning.
 /// @param pipe_info Pointer to the pipe information structure.
 /// @param wait_queue Pointer to the wait queue on which to put the process to sleep.
 /// @param wake_function Wake-up function associated with the wait queue entry.
 /// @param debug_msg Debug message describing the block context.
-/// @return 0 after scheduling the blocking behavior.
+/// @return 0 when woken up, -EINTR if interrupted by a signal.
 static int pipe_put_process_to_sleep(
     pipe_inode_info_t *pipe_info,
     wait_queue_head_t *wait_queue,
@@ -599,8 +616,12 @@ static int pipe_put_process_to_sleep(
     wait_queue_entry->func    = wake_function;
     wait_queue_entry->private = pipe_info;
 
-    // Indicate blocking behavior was scheduled.
-    return 0;
+    // The other end needs the mutex to wake us up.
+    mutex_unlock(&pipe_info->mutex);
+    pr_debug("%s: Process %d goes to sleep.\n", debug_msg, wait_queue_entry->task->pid);
+    int ret = wait_on(wait_queue);
+    mutex_lock(&pipe_info->mutex, scheduler_get_current_process()->pid);
+    return ret;
 }
 
 // ============================================================================
@@ -898,7 +919,8 @@ static int pipe_close(vfs_file_t *file)
 /// @param buffer Buffer where the data will be stored.
 /// @param offset Unused for pipes, but included for interface compatibility.
 /// @param nbyte Maximum number of bytes to read.
-/// @return Number of bytes read on success, 0 if no data available in non-blocking mode, or -1 on error.
+/// @return Number of bytes read on success, 0 if there are no writers left, -EAGAIN if no data is
+/// available in non-blocking mode, -EINTR if interrupted by a signal, or -1 on error.
 static ssize_t pipe_read(vfs_file_t *file, char *buffer, off_t offset, size_t nbyte)
 {
     // Validate input parameters.
@@ -925,50 +947,58 @@ static ssize_t pipe_read(vfs_file_t *file, char *buffer, off_t offset, size_t nb
     // Acquire the pipe mutex to ensure safe access.
     mutex_lock(&pipe_info->mutex, task->pid);
 
-    // Return 0 if there are no writers left.
-    if (pipe_info->writers == 0) {
-        pr_debug("No writers left.\n");
-        return 0;
+    // Wait until there is some data to read.
+    while (!pipe_info_has_data(pipe_info)) {
+        // Return 0 if there are no writers left.
+        if (pipe_info->writers == 0) {
+            pr_debug("No writers left.\n");
+            mutex_unlock(&pipe_info->mutex);
+            return 0;
+        }
+        // In non-blocking mode, the caller tries again later.
+        if (!pipe_is_blocking(file)) {
+            mutex_unlock(&pipe_info->mutex);
+            return -EAGAIN;
+        }
+        // Put the process to sleep until data is available.
+        int ret = pipe_put_process_to_sleep(pipe_info, &pipe_info->read_wait, pipe_read_wake_function, "pipe_read");
+        if (ret < 0) {
+            mutex_unlock(&pipe_info->mutex);
+            return ret;
+        }
     }
 
     ssize_t bytes_read = 0;
 
-    if (pipe_info_has_data(pipe_info)) {
-        // Loop to read data from the pipe until requested bytes are read or an error occurs.
-        while (bytes_read < nbyte) {
-            // Wrap read_index around when exceeding max buffer capacity.
-            pipe_info->read_index %= (pipe_info->numbuf * PIPE_BUFFER_SIZE);
+    // Loop to read data from the pipe until requested bytes are read or an error occurs.
+    while (bytes_read < nbyte) {
+        // Wrap read_index around when exceeding max buffer capacity.
+        pipe_info->read_index %= (pipe_info->numbuf * PIPE_BUFFER_SIZE);
 
-            // Calculate the buffer index for the current read position.
-            size_t buffer_index        = pipe_linear_to_buffer_index(pipe_info->read_index);
-            pipe_buffer_t *pipe_buffer = &pipe_info->bufs[buffer_index];
+        // Calculate the buffer index for the current read position.
+        size_t buffer_index        = pipe_linear_to_buffer_index(pipe_info->read_index, pipe_info->numbuf);
+        pipe_buffer_t *pipe_buffer = &pipe_info->bufs[buffer_index];
 
-            // Confirm that the buffer is ready to be read.
-            if (pipe_buffer_confirm(pipe_buffer) < 0) {
-                pr_err("Failed to confirm readiness of buffer %u for reading.\n", buffer_index);
-                break; // Stop if there’s no data to read.
-            }
-
-            // Calculate bytes to read in this iteration, considering the remaining requested bytes.
-            ssize_t bytes_to_read = pipe_buffer_read(pipe_buffer, buffer + bytes_read, nbyte - bytes_read);
-            if (bytes_to_read < 0) {
-                pr_err("Error reading from pipe buffer (error[%2d]: %s).\n", -bytes_to_read, strerror(-bytes_to_read));
-                bytes_read = -bytes_to_read;
-                break;
-            }
+        // Confirm that the buffer is ready to be read.
+        if (pipe_buffer_confirm(pipe_buffer) < 0) {
+            pr_err("Failed to confirm readiness of buffer %u for reading.\n", buffer_index);
+            break; // Stop if there’s no data to read.
+        }
 
-            // Update the total bytes read and the read index.
-            bytes_read            = bytes_read + bytes_to_read;
-            pipe_info->read_index = pipe_info->read_index + bytes_to_read;
+        // Calculate bytes to read in this iteration, considering the remaining requested bytes.
+        ssize_t bytes_to_read = pipe_buffer_read(pipe_buffer, buffer + bytes_read, nbyte - bytes_read);
+        if (bytes_to_read == -EAGAIN) {
+            break; // There is no more data, return what we have read.
         }
-    } else {
-        // If in blocking mode, put the process to sleep until data is available.
-        if (pipe_is_blocking(file)) {
-            pipe_put_process_to_sleep(pipe_info, &pipe_info->read_wait, pipe_read_wake_function, "pipe_read");
+        if (bytes_to_read < 0) {
+            pr_err("Error reading from pipe buffer (error[%2d]: %s).\n", -bytes_to_read, strerror(-bytes_to_read));
+            bytes_read = -bytes_to_read;
+            break;
         }
-        // TODO: We currently do not save kernel regs status, so we need a
-        // work-around when putting processes to sleep.
-        bytes_read = -EAGAIN;
+
+        // Update the total bytes read and the read index.
+        bytes_read            = bytes_read + bytes_to_read;
+        pipe_info->read_index = pipe_info->read_index + bytes_to_read;
     }
 
     // Release the mutex after reading.
@@ -987,7 +1017,8 @@ static ssize_t pipe_read(vfs_file_t *file, char *buffer, off_t offset, size_t nb
 /// @param buffer Buffer containing the data to write.
 /// @param offset Unused for pipes, but included for interface compatibility.
 /// @param nbyte Maximum number of bytes to write.
-/// @return Number of bytes written on success, or -1 on error.
+/// @return Number of bytes written on success, -EAGAIN if the pipe is full in non-blocking mode,
+/// -EINTR if interrupted by a signal, or -1 on error.
 static ssize_t pipe_write(vfs_file_t *file, const void *buffer, off_t offset, size_t nbyte)
 {
     // Validate input parameters.
@@ -1014,48 +1045,55 @@ static ssize_t pipe_write(vfs_file_t *file, const void *buffer, off_t offset, si
     // Acquire the pipe mutex to ensure safe access.
     mutex_lock(&pipe_info->mutex, task->pid);
 
+    // Wait until there is some space to write.
+    while (!pipe_info_has_space(pipe_info)) {
+        // In non-blocking mode, the caller tries again later.
+        if (!pipe_is_blocking(file)) {
+            mutex_unlock(&pipe_info->mutex);
+            return -EAGAIN;
+        }
+        // Put the process to sleep until space is available.
+        int ret = pipe_put_process_to_sleep(pipe_info, &pipe_info->write_wait, pipe_write_wake_function, "pipe_write");
+        if (ret < 0) {
+            mutex_unlock(&pipe_info->mutex);
+            return ret;
+        }
+    }
+
     ssize_t bytes_written = 0;
 
-    // Check if there is available space in the pipe for writing.
-    if (pipe_info_has_space(pipe_info)) {
-        // Loop to write data to the pipe buffer until the requested number of bytes is written.
-        while (bytes_written < nbyte) {
-            // Wrap around write_index when it exceeds the max buffer capacity.
-            pipe_info->write_index %= (pipe_info->numbuf * PIPE_BUFFER_SIZE);
-
-            // Get the buffer index for the current write position.
-            size_t buffer_index        = pipe_linear_to_buffer_index(pipe_info->write_index);
-            pipe_buffer_t *pipe_buffer = &pipe_info->bufs[buffer_index];
-
-            // Confirm the buffer is ready for writing.
-            if (pipe_buffer_confirm(pipe_buffer) < 0) {
-                pr_err("Failed to confirm readiness of buffer %u for writing.\n", buffer_index);
-                bytes_written = -1;
-                break;
-            }
+    // Loop to write data to the pipe buffer until the requested number of bytes is written.
+    while (bytes_written < nbyte) {
+        // Wrap around write_index when it exceeds the max buffer capacity.
+        pipe_info->write_index %= (pipe_info->numbuf * PIPE_BUFFER_SIZE);
 
-            // Attempt to write data into the pipe buffer.
-            ssize_t bytes_to_write =
-                pipe_buffer_write(pipe_buffer, (const char *)buffer + bytes_written, nbyte - bytes_written);
-            if (bytes_to_write < 0) {
-                // Other errors: Log and return immediately.
-                pr_err("Error writing to pipe buffer (error[%2d]: %s).\n", -bytes_to_write, strerror(-bytes_to_write));
-                bytes_written = -1;
-                break;
-            }
+        // Get the buffer index for the current write position.
+        size_t buffer_index        = pipe_linear_to_buffer_index(pipe_info->write_index, pipe_info->numbuf);
+        pipe_buffer_t *pipe_buffer = &pipe_info->bufs[buffer_index];
 
-            // Update the total bytes written and the write index.
-            bytes_written          = bytes_written + bytes_to_write;
-            pipe_info->write_index = pipe_info->write_index + bytes_to_write;
+        // Confirm the buffer is ready for writing.
+        if (pipe_buffer_confirm(pipe_buffer) < 0) {
+            pr_err("Failed to confirm readiness of buffer %u for writing.\n", buffer_index);
+            bytes_written = -1;
+            break;
         }
-    } else {
-        // Blocking behavior: Put the process to sleep until space is available.
-        if (pipe_is_blocking(file)) {
-            pipe_put_process_to_sleep(pipe_info, &pipe_info->write_wait, pipe_write_wake_function, "pipe_write");
+
+        // Attempt to write data into the pipe buffer.
+        ssize_t bytes_to_write =
+            pipe_buffer_write(pipe_buffer, (const char *)buffer + bytes_written, nbyte - bytes_written);
+        if (bytes_to_write == -EAGAIN) {
+            break; // The pipe is full, return what we have written.
+        }
+        if (bytes_to_write < 0) {
+            // Other errors: Log and return immediately.
+            pr_err("Error writing to pipe buffer (error[%2d]: %s).\n", -bytes_to_write, strerror(-bytes_to_write));
+            bytes_written = -1;
+            break;
         }
-        // TODO: We currently do not save kernel regs status, so we need a
-        // work-around when putting processes to sleep.
-        bytes_written = -EAGAIN;
+
+        // Update the total bytes written and the write index.
+        bytes_written          = bytes_written + bytes_to_write;
+        pipe_info->write_index = pipe_info->write_index + bytes_to_write;
     }
 
     // Release the mutex after the write operation is complete.
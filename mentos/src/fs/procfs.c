@@ -507,6 +507,8 @@ static vfs_file_t *procfs_open(const char *path, int flags, mode_t mode)
             errno = ENFILE;
             return NULL;
         }
+        // Keep the flags, some files can be read without blocking.
+        vfs_file->open_flags = flags;
         // Update file access.
         procfs_file->atime = sys_time(NULL);
         // Add the vfs_file to the list of associated files.
@@ -11,12 +11,14 @@
 
 #include "assert.h"
 #include "fcntl.h"
+#include "fs/locks.h"
 #include "fs/namei.h"
 #include "fs/pipe.h"
 #include "fs/procfs.h"
 #include "fs/vfs.h"
 #include "klib/spinlock.h"
 #include "libgen.h"
+#include "mem/vmem_map.h"
 #include "process/scheduler.h"
 #include "stdio.h"
 #include "strerror.h"
@@ -121,6 +123,9 @@ void pr_vfs_dealloc_file(const char *file, const char *fun, int line, vfs_file_t
     clear_resource_info(vfs_file);
 #endif
 
+    // Release the locks which are still placed on the file.
+    locks_free_context(vfs_file);
+
     // Free the VFS file back to the cache.
     kmem_cache_free(vfs_file);
 
@@ -718,7 +723,7 @@ int vfs_extend_task_fd_list(struct task_struct *task)
     // Set the max number of file descriptors.
     int new_max_fd    = (task->fd_list) ? task->max_fd * 2 + 1 : MAX_OPEN_FD;
     // Allocate the memory for the list.
-    void *new_fd_list = kmalloc(new_max_fd * sizeof(vfs_file_descriptor_t));
+    void *new_fd_list = kvmalloc(new_max_fd * sizeof(vfs_file_descriptor_t));
     // Check the new list.
     if (!new_fd_list) {
         pr_err("Failed to allocate memory for `fd_list`.\n");
@@ -726,13 +731,13 @@ int vfs_extend_task_fd_list(struct task_struct *task)
         return 0;
     }
     // Clear the memory of the new list.
-    memset(new_fd_list, 0, task->max_fd * sizeof(vfs_file_descriptor_t));
+    memset(new_fd_list, 0, new_max_fd * sizeof(vfs_file_descriptor_t));
     // Deal with pre-existing list.
     if (task->fd_list) {
         // Copy the old entries.
         memcpy(new_fd_list, task->fd_list, task->max_fd * sizeof(vfs_file_descriptor_t));
         // Free the memory of the old list.
-        kfree(task->fd_list);
+        kvfree(task->fd_list);
     }
     // Set the new maximum number of file descriptors.
     task->max_fd  = new_max_fd;
@@ -769,7 +774,7 @@ int vfs_dup_task(task_struct *task, task_struct *old_task)
     // Copy the maximum number of file descriptors.
     task->max_fd  = old_task->max_fd;
     // Allocate the memory for the new list.
-    task->fd_list = kmalloc(task->max_fd * sizeof(vfs_file_descriptor_t));
+    task->fd_list = kvmalloc(task->max_fd * sizeof(vfs_file_descriptor_t));
     // Copy the old list.
     memcpy(task->fd_list, old_task->fd_list, task->max_fd * sizeof(vfs_file_descriptor_t));
     // Increase the counters to the open files.
@@ -811,7 +816,7 @@ int vfs_destroy_task(task_struct *task)
     // Set the maximum file descriptors to 0.
     task->max_fd = 0;
     // Free the memory of the list.
-    kfree(task->fd_list);
+    kvfree(task->fd_list);
     // Remove the proc entry.
     if (procr_destroy_entry_pid(task)) {
         pr_err("Error while trying to remove proc entry for '%d': %s\n", task->pid, strerror(errno));
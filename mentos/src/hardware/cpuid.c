@@ -153,6 +153,28 @@ char *cpuid_brand_index(pt_regs *f)
     return indexes[bx];
 }
 
+int cpuid_has_pae(void)
+{
+    pt_regs ereg = {.eax = 1};
+    call_cpuid(&ereg);
+    // EAX=1, bit 6 of EDX.
+    return cpuid_get_byte(ereg.edx, 6, 1);
+}
+
+int cpuid_has_nx(void)
+{
+    pt_regs ereg = {.eax = 0x80000000};
+    call_cpuid(&ereg);
+    // Check that the extended function is available.
+    if (ereg.eax < 0x80000001) {
+        return 0;
+    }
+    ereg.eax = 0x80000001;
+    call_cpuid(&ereg);
+    // EAX=0x80000001, bit 20 of EDX.
+    return cpuid_get_byte(ereg.edx, 20, 1);
+}
+
 char *cpuid_brand_string(pt_regs *f)
 {
     char *temp = "";
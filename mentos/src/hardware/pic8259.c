@@ -145,6 +145,28 @@ void pic8259_send_eoi(uint32_t irq)
     outportb(MASTER_PORT_COMMAND, EOI);
 }
 
+int pic8259_irq_is_spurious(uint32_t irq)
+{
+    uint8_t isr;
+    if (irq == IRQ_LPT1) {
+        // Read the In-Service Register of the master.
+        outportb(MASTER_PORT_COMMAND, PIC_READ_ISR);
+        isr = inportb(MASTER_PORT_COMMAND);
+        return (isr & (1U << 7U)) == 0;
+    }
+    if (irq == IRQ_SECOND_HD) {
+        // Read the In-Service Register of the slave.
+        outportb(SLAVE_PORT_COMMAND, PIC_READ_ISR);
+        isr = inportb(SLAVE_PORT_COMMAND);
+        if ((isr & (1U << 7U)) == 0) {
+            // The master does not know the request was spurious.
+            outportb(MASTER_PORT_COMMAND, EOI);
+            return 1;
+        }
+    }
+    return 0;
+}
+
 /*
  * int pic8259_irq_get_current()
  * {
@@ -19,6 +19,7 @@
 #include "io/port_io.h"
 #include "io/video.h"
 #include "klib/irqflags.h"
+#include "klib/math64.h"
 #include "mem/kheap.h"
 #include "process/scheduler.h"
 #include "process/wait.h"
@@ -70,6 +71,20 @@
 #define PIT_CONFIGURATION 0x34u
 /// Mask used to set the divisor.
 #define PIT_MASK          0xFFu
+/// Command used to latch the counter of channel 0, before reading it.
+#define PIT_LATCH_COUNT   0x00u
+
+/// Number of nanoseconds in a second.
+#define NSEC_PER_SEC    1000000000U
+/// Number of microseconds in a second.
+#define USEC_PER_SEC    1000000U
+/// The rate at which adjtime slews the wall clock, in parts per million.
+#define ADJTIME_SLEW_PPM 500
+/// The largest correction accepted by adjtime, in seconds.
+#define ADJTIME_MAX_SEC  2145
+
+/// The timer slack of the tasks which did not set their own, in nanoseconds.
+int sysctl_timer_slack_ns = TIMER_SLACK_NS;
 
 /// The number of ticks since the system started its execution.
 static __volatile__ unsigned long timer_ticks = 0;
@@ -78,10 +93,84 @@ static tvec_base_t cpu_base                   = {0};
 /// Contains all process waiting for a sleep.
 static wait_queue_head_t sleep_queue;
 
+/// The value the PIT counts down from, at every tick.
+static uint32_t pit_reload                    = 0;
+/// Seconds of the monotonic clock, updated at every tick.
+static __volatile__ time_t clock_seconds      = 0;
+/// PIT cycles elapsed in the current second of the monotonic clock.
+static __volatile__ uint32_t clock_cycles     = 0;
+/// The last value returned by the monotonic clock, which never goes back.
+static timespec_t clock_last                  = {0, 0};
+/// The offset of the wall clock from the monotonic clock.
+static timespec_t wall_offset                 = {0, 0};
+/// The correction adjtime has still to apply to the wall clock, in nanoseconds.
+static int64_t adjtime_left                   = 0;
+/// The correction applied to the wall clock at every tick, in nanoseconds.
+static uint32_t adjtime_slew                  = 0;
+
+/// @brief Converts PIT cycles into nanoseconds.
+/// @param cycles the cycles, less than a second worth of them.
+/// @return the nanoseconds.
+static inline uint32_t __pit_cycles_to_ns(uint32_t cycles)
+{
+    return div_u64_u32((uint64_t)cycles * NSEC_PER_SEC, PIT_DIVISOR, NULL);
+}
+
+/// @brief Reads the counter of channel 0, which goes from `pit_reload` down
+/// to 1 during a tick.
+/// @return the value of the counter.
+static inline uint32_t __pit_read_count(void)
+{
+    outportb(PIT_COMREG, PIT_LATCH_COUNT);
+    uint32_t low  = inportb(PIT_DATAREG0);
+    uint32_t high = inportb(PIT_DATAREG0);
+    return (high << 8U) | low;
+}
+
+/// @brief Adds the given nanoseconds to a time value, and normalizes it.
+/// @param ts the time value.
+/// @param nsec the nanoseconds, they can be negative.
+static inline void __timespec_add_ns(timespec_t *ts, long nsec)
+{
+    ts->tv_nsec += nsec;
+    while (ts->tv_nsec >= (long)NSEC_PER_SEC) {
+        ts->tv_nsec -= NSEC_PER_SEC;
+        ++ts->tv_sec;
+    }
+    while (ts->tv_nsec < 0) {
+        ts->tv_nsec += NSEC_PER_SEC;
+        --ts->tv_sec;
+    }
+}
+
+/// @brief Advances the monotonic clock by one tick, and slews the wall clock
+/// if adjtime asked for a correction.
+static inline void __clock_tick(void)
+{
+    clock_cycles += pit_reload;
+    if (clock_cycles >= PIT_DIVISOR) {
+        clock_cycles -= PIT_DIVISOR;
+        ++clock_seconds;
+    }
+    if (adjtime_left > 0) {
+        long slew = (adjtime_left > adjtime_slew) ? (long)adjtime_slew : (long)adjtime_left;
+        __timespec_add_ns(&wall_offset, slew);
+        adjtime_left -= slew;
+    } else if (adjtime_left < 0) {
+        long slew = (-adjtime_left > adjtime_slew) ? (long)adjtime_slew : (long)-adjtime_left;
+        __timespec_add_ns(&wall_offset, -slew);
+        adjtime_left += slew;
+    }
+}
+
 void timer_phase(const uint32_t hz)
 {
     // Calculate our divisor.
     unsigned int divisor = PIT_DIVISOR / hz;
+    // The clock advances by the divisor at every tick.
+    pit_reload           = divisor;
+    // Slew the wall clock by a fraction of each tick.
+    adjtime_slew         = __pit_cycles_to_ns(divisor) / (USEC_PER_SEC / ADJTIME_SLEW_PPM);
     // Set our command byte 0x36.
     outportb(PIT_COMREG, PIT_CONFIGURATION);
     // Set low byte of divisor.
@@ -96,10 +185,17 @@ void timer_handler(pt_regs *reg)
     switch_fpu();
     // Check if a second has passed.
     ++timer_ticks;
-    // Update all timers
+    // Advance the clocks.
+    __clock_tick();
+    // Update all timers, and account the time it took.
+    uint64_t softirq_start = rdtsc();
     run_timer_softirq();
-    // Perform the schedule.
-    scheduler_run(reg);
+    softirq_account(TIMER_SOFTIRQ, rdtsc() - softirq_start);
+    // Account the tick, then ask for the schedule: the IRQ handler switches
+    // task once the PIC is acknowledged, since we might not come back here
+    // for a while.
+    scheduler_account_tick(reg);
+    runqueue.need_resched = true;
     // Update graphics.
     video_update();
     // Restore fpu state.
@@ -120,10 +216,58 @@ void timer_install(void)
     pic8259_irq_enable(IRQ_TIMER);
 }
 
-uint64_t timer_get_seconds(void) { return timer_ticks / TICKS_PER_SECOND; }
+unsigned long timer_get_seconds(void) { return timer_ticks / TICKS_PER_SECOND; }
 
 unsigned long timer_get_ticks(void) { return timer_ticks; }
 
+void timer_get_monotonic(timespec_t *ts)
+{
+    uint8_t flags   = irq_disable();
+    time_t seconds  = clock_seconds;
+    uint32_t cycles = clock_cycles;
+    // Add the cycles elapsed since the last tick.
+    uint32_t count  = __pit_read_count();
+    if ((count > 0) && (count <= pit_reload)) {
+        cycles += pit_reload - count;
+    }
+    if (cycles >= PIT_DIVISOR) {
+        cycles -= PIT_DIVISOR;
+        ++seconds;
+    }
+    ts->tv_sec  = seconds;
+    ts->tv_nsec = __pit_cycles_to_ns(cycles);
+    // The counter wraps around before the tick is served, in that case we
+    // would go back in time.
+    if ((ts->tv_sec < clock_last.tv_sec) ||
+        ((ts->tv_sec == clock_last.tv_sec) && (ts->tv_nsec < clock_last.tv_nsec))) {
+        *ts = clock_last;
+    } else {
+        clock_last = *ts;
+    }
+    irq_enable(flags);
+}
+
+void timer_get_realtime(timespec_t *ts)
+{
+    timer_get_monotonic(ts);
+    ts->tv_sec += wall_offset.tv_sec;
+    __timespec_add_ns(ts, wall_offset.tv_nsec);
+}
+
+void timer_set_realtime(const timespec_t *ts)
+{
+    timespec_t now;
+    timer_get_monotonic(&now);
+    uint8_t flags      = irq_disable();
+    // The wall clock is the monotonic one, plus the offset.
+    wall_offset.tv_sec  = ts->tv_sec - now.tv_sec;
+    wall_offset.tv_nsec = 0;
+    __timespec_add_ns(&wall_offset, ts->tv_nsec - now.tv_nsec);
+    // Setting the clock cancels any pending adjustment.
+    adjtime_left        = 0;
+    irq_enable(flags);
+}
+
 // ============================================================================
 // SUPPORT FUNCTIONS (tvec_base_t)
 // ============================================================================
@@ -339,6 +483,67 @@ void remove_timer(struct timer_list *timer)
     __print_vector_base(&cpu_base);
 }
 
+unsigned long timer_get_slack(task_struct *task)
+{
+    // Real-time tasks, periodic ones included, keep their exact expiries.
+    if ((task->se.policy == SCHED_FIFO) || (task->se.policy == SCHED_RR) || (task->se.policy == SCHED_DEADLINE) ||
+        task->se.is_periodic) {
+        return 0;
+    }
+    return task->timer_slack_ns ? task->timer_slack_ns : (unsigned long)sysctl_timer_slack_ns;
+}
+
+/// @brief Delays the expiry of a timer of the given task within the slack of
+/// the task, so that it lands on a tick shared with other timers.
+/// @details The expiry is rounded down to the coarsest multiple of a power of
+/// two lying between the exact expiry and the exact expiry plus the slack.
+/// Timers whose windows overlap thus end up on the same tick, and are handled
+/// by a single wakeup. The slack is at most a quarter of the timeout, so that
+/// short sleeps stay accurate.
+/// @param task the task arming the timer.
+/// @param expires the exact expiry, in ticks.
+/// @param timeout the timeout in ticks.
+/// @return the tick at which the timer must expire.
+static inline unsigned long __timer_apply_slack(task_struct *task, unsigned long expires, unsigned long timeout)
+{
+    unsigned long slack = timer_get_slack(task) / (NSEC_PER_SEC / TICKS_PER_SECOND);
+    slack                 = min(slack, timeout / 4);
+    if (slack == 0) {
+        return expires;
+    }
+    unsigned long limit = expires + slack;
+    // The highest bit in which the two ends of the window differ.
+    unsigned long mask  = 1;
+    while ((expires ^ limit) >> 1 >= mask) {
+        mask <<= 1;
+    }
+    // Clearing the bits below it stays within the window.
+    return limit & ~(mask - 1);
+}
+
+/// @brief Computes the expiry of a timer of the given task, which is due after
+/// the given timeout, delayed within the slack of the task.
+/// @param task the task arming the timer.
+/// @param timeout the timeout in ticks.
+/// @return the tick at which the timer must expire.
+static inline unsigned long __timer_expires(task_struct *task, unsigned long timeout)
+{
+    return __timer_apply_slack(task, timer_get_ticks() + timeout, timeout);
+}
+
+/// @brief Returns the ticks left before the real timer of the task is due,
+/// not counting the slack.
+/// @param task the task.
+/// @return the remaining ticks, 0 if there is no timer or it is already due.
+static inline unsigned long __real_timer_remaining(task_struct *task)
+{
+    unsigned long now = timer_get_ticks();
+    if (!task->real_timer || (task->it_real_expires <= now)) {
+        return 0;
+    }
+    return task->it_real_expires - now;
+}
+
 // ============================================================================
 // SUPPORT FUNCTIONS (sleep_data)
 // ============================================================================
@@ -602,10 +807,14 @@ static inline void real_timer_timeout(unsigned long task_ptr)
     sys_kill(task->pid, SIGALRM);
     // If the real incr is not 0 then restart.
     if (task->it_real_incr != 0) {
+        // The period starts from the exact expiry, so that the slack does not
+        // accumulate from one period to the next.
+        task->it_real_expires += task->it_real_incr;
+
         // Create new timer for process, the old one is going to be deleted.
         task->real_timer           = __timer_list_alloc();
         // Setup the timer.
-        task->real_timer->expires  = timer_get_ticks() + task->it_real_incr;
+        task->real_timer->expires  = __timer_apply_slack(task, task->it_real_expires, task->it_real_incr);
         task->real_timer->function = &real_timer_timeout;
         task->real_timer->data     = (unsigned long)task;
         // Add the timer.
@@ -635,7 +844,7 @@ int sys_nanosleep(const struct timespec *req, struct timespec *rem)
     sleep_data->remaining          = rem;
     sleep_data->wait_queue_entry   = sleep_on(&sleep_queue);
     // Setup the timer.
-    sleep_timer->expires           = timer_get_ticks() + __timespec_to_ticks(req);
+    sleep_timer->expires           = __timer_expires(scheduler_get_current_process(), __timespec_to_ticks(req));
     sleep_timer->function          = &sleep_timeout;
     sleep_timer->data              = (unsigned long)sleep_data;
     // Add the timer.
@@ -652,7 +861,7 @@ unsigned sys_alarm(int seconds)
         // First, we remove the timer.
         remove_timer(task->real_timer);
         // We compute the remaining time.
-        remaining_time = (task->real_timer->expires - timer_get_ticks()) / TICKS_PER_SECOND;
+        remaining_time = __real_timer_remaining(task) / TICKS_PER_SECOND;
         // Returns only the amount of seconds remaining.
         if (seconds == 0) {
             // Free the memory.
@@ -671,7 +880,8 @@ unsigned sys_alarm(int seconds)
     // Initialize the timer.
     init_timer(task->real_timer);
     // Setup the timer.
-    task->real_timer->expires  = timer_get_ticks() + TICKS_PER_SECOND * seconds;
+    task->it_real_expires      = timer_get_ticks() + TICKS_PER_SECOND * seconds;
+    task->real_timer->expires  = __timer_apply_slack(task, task->it_real_expires, TICKS_PER_SECOND * seconds);
     task->real_timer->function = &alarm_timeout;
     task->real_timer->data     = (unsigned long)task;
     // Add the timer.
@@ -685,7 +895,7 @@ int sys_getitimer(int which, struct itimerval *curr_value)
     // Transform the apropriate interval and store it in the given variable.
     if (which == ITIMER_REAL) {
         // Extract remaining time in dynamic timer.
-        task->it_real_value = task->real_timer->expires - timer_get_ticks();
+        task->it_real_value = __real_timer_remaining(task);
         __values_to_itimerval(task->it_real_incr, task->it_real_value, curr_value);
     } else if (which == ITIMER_VIRTUAL) {
         __values_to_itimerval(task->it_virt_incr, task->it_virt_value, curr_value);
@@ -733,7 +943,8 @@ int sys_setitimer(int which, const struct itimerval *new_value, struct itimerval
         // Initialize the timer.
         init_timer(task->real_timer);
         // Setup the timer.
-        task->real_timer->expires  = timer_get_ticks() + new_interval_ticks;
+        task->it_real_expires      = timer_get_ticks() + new_interval_ticks;
+        task->real_timer->expires  = __timer_apply_slack(task, task->it_real_expires, new_interval_ticks);
         task->real_timer->function = &real_timer_timeout;
         task->real_timer->data     = (unsigned long)task;
         // Add the timer.
@@ -760,3 +971,85 @@ void update_process_profiling_timer(task_struct *proc)
         }
     }
 }
+
+int sys_clock_gettime(clockid_t clockid, struct timespec *tp)
+{
+    if (tp == NULL) {
+        return -EFAULT;
+    }
+    switch (clockid) {
+    case CLOCK_REALTIME:
+        timer_get_realtime(tp);
+        return 0;
+    case CLOCK_MONOTONIC:
+        timer_get_monotonic(tp);
+        return 0;
+    default:
+        return -EINVAL;
+    }
+}
+
+int sys_gettimeofday(struct timeval *tv, void *tz)
+{
+    timespec_t now;
+    if (tv) {
+        timer_get_realtime(&now);
+        tv->tv_sec  = now.tv_sec;
+        tv->tv_usec = now.tv_nsec / 1000;
+    }
+    // The timezone is handled by the C library, the kernel clock is UTC.
+    (void)tz;
+    return 0;
+}
+
+int sys_settimeofday(const struct timeval *tv, const void *tz)
+{
+    timespec_t now;
+    (void)tz;
+    if (tv == NULL) {
+        return 0;
+    }
+    if (runqueue.curr->uid != 0) {
+        return -EPERM;
+    }
+    if (tv->tv_usec >= USEC_PER_SEC) {
+        return -EINVAL;
+    }
+    now.tv_sec  = tv->tv_sec;
+    now.tv_nsec = tv->tv_usec * 1000;
+    timer_set_realtime(&now);
+    return 0;
+}
+
+int sys_adjtime(const struct timeval *delta, struct timeval *olddelta)
+{
+    int64_t nsec = 0;
+    if (delta) {
+        if (runqueue.curr->uid != 0) {
+            return -EPERM;
+        }
+        // Negative corrections are stored in the unsigned fields.
+        int sec  = (int)delta->tv_sec;
+        int usec = (int)delta->tv_usec;
+        if ((sec > ADJTIME_MAX_SEC) || (sec < -ADJTIME_MAX_SEC) || (usec >= (int)USEC_PER_SEC) ||
+            (usec <= -(int)USEC_PER_SEC)) {
+            return -EINVAL;
+        }
+        nsec = (int64_t)sec * NSEC_PER_SEC + (int64_t)usec * 1000;
+    }
+    uint8_t flags = irq_disable();
+    int64_t left  = adjtime_left;
+    if (delta) {
+        adjtime_left = nsec;
+    }
+    irq_enable(flags);
+    if (olddelta) {
+        uint32_t rem;
+        uint64_t magnitude = (left < 0) ? (uint64_t)-left : (uint64_t)left;
+        int sec            = (int)div_u64_u32(magnitude, NSEC_PER_SEC, &rem);
+        int usec           = (int)(rem / 1000);
+        olddelta->tv_sec   = (time_t)((left < 0) ? -sec : sec);
+        olddelta->tv_usec  = (time_t)((left < 0) ? -usec : usec);
+    }
+    return 0;
+}
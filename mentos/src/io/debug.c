@@ -6,7 +6,10 @@
 #include "io/debug.h"
 #include "io/ansi_colors.h"
 #include "io/port_io.h"
+#include "ctype.h"
+#include "errno.h"
 #include "kernel.h"
+#include "limits.h"
 #include "math.h"
 #include "stdio.h"
 #include "string.h"
@@ -16,6 +19,27 @@
 #define SERIAL_COM1 (0x03F8)
 /// Determines the log level.
 static int max_log_level = LOGLEVEL_DEBUG;
+/// The maximum length of a dynamic debug query.
+#define DYNDBG_QUERY_MAX 256
+
+/// Start of the `__dyndbg` section, defined in kernel.lds.
+extern dyndbg_site_t __start___dyndbg[];
+/// End of the `__dyndbg` section, defined in kernel.lds.
+extern dyndbg_site_t __stop___dyndbg[];
+
+/// @brief The sites selected by a dynamic debug command.
+typedef struct dyndbg_filter {
+    /// The file, either its path or its name, NULL matches any file.
+    const char *file;
+    /// The function, NULL matches any function.
+    const char *function;
+    /// A part of the format, NULL matches any format.
+    const char *format;
+    /// The first line.
+    unsigned int first_line;
+    /// The last line.
+    unsigned int last_line;
+} dyndbg_filter_t;
 
 /// @brief Prints the correct header for the given debug level.
 /// @param file the file origin of the debug message.
@@ -127,6 +151,11 @@ void dbg_printf(const char *file, const char *fun, int line, char *header, short
     static char formatted[BUFSIZ];
     static short new_line = 1;
 
+    // Drop the messages above the current log level.
+    if ((log_level != LOGLEVEL_DEFAULT) && (log_level > max_log_level)) {
+        return;
+    }
+
     // Stage 1: FORMAT
     if (strlen(format) >= BUFSIZ) {
         return;
@@ -160,3 +189,161 @@ void dbg_printf(const char *file, const char *fun, int line, char *header, short
         }
     }
 }
+
+/// @brief Checks if the site is selected by the filter.
+/// @param site the site.
+/// @param filter the filter.
+/// @return 1 if it is selected, 0 otherwise.
+static inline int __dyndbg_match(dyndbg_site_t *site, dyndbg_filter_t *filter)
+{
+    if (filter->file) {
+        const char *name = strrchr(site->file, '/');
+        if (strcmp(site->file, filter->file) && (!name || strcmp(name + 1, filter->file))) {
+            return 0;
+        }
+    }
+    if (filter->function && strcmp(site->function, filter->function)) {
+        return 0;
+    }
+    if (filter->format && !strstr(site->format, filter->format)) {
+        return 0;
+    }
+    return (site->line >= filter->first_line) && (site->line <= filter->last_line);
+}
+
+/// @brief Parses a line, or a range of lines.
+/// @param value the string, in the form `<n>` or `<n>-<m>`.
+/// @param filter the filter where the lines are stored.
+/// @return 0 on success, -1 on failure.
+static inline int __dyndbg_parse_lines(const char *value, dyndbg_filter_t *filter)
+{
+    unsigned int *line = &filter->first_line;
+    *line              = 0;
+    if (!isdigit(*value)) {
+        return -1;
+    }
+    for (; *value; ++value) {
+        if (isdigit(*value)) {
+            *line = (*line * 10) + (*value - '0');
+        } else if ((*value == '-') && (line == &filter->first_line) && isdigit(value[1])) {
+            line  = &filter->last_line;
+            *line = 0;
+        } else {
+            return -1;
+        }
+    }
+    if (line == &filter->first_line) {
+        filter->last_line = filter->first_line;
+    }
+    return (filter->first_line <= filter->last_line) ? 0 : -1;
+}
+
+/// @brief Applies a single dynamic debug command.
+/// @param command the command, it is modified while parsing.
+/// @return 0 on success, -EINVAL if it is malformed, -ENOENT if no site matches it.
+static int __dyndbg_command(char *command)
+{
+    dyndbg_filter_t filter = {NULL, NULL, NULL, 0, UINT_MAX};
+    char *saveptr, *keyword, *value;
+    int enable = -1, matched = 0;
+    for (keyword = strtok_r(command, " \t", &saveptr); keyword; keyword = strtok_r(NULL, " \t", &saveptr)) {
+        // The flags close the command.
+        if ((keyword[0] == '+') || (keyword[0] == '-') || (keyword[0] == '=')) {
+            if (strtok_r(NULL, " \t", &saveptr)) {
+                return -EINVAL;
+            }
+            if (!strcmp(keyword, "+p") || !strcmp(keyword, "=p")) {
+                enable = 1;
+            } else if (!strcmp(keyword, "-p") || !strcmp(keyword, "=_") || !strcmp(keyword, "=")) {
+                enable = 0;
+            } else {
+                return -EINVAL;
+            }
+            break;
+        }
+        if (!(value = strtok_r(NULL, " \t", &saveptr))) {
+            return -EINVAL;
+        }
+        if (!strcmp(keyword, "file")) {
+            filter.file = value;
+        } else if (!strcmp(keyword, "func")) {
+            filter.function = value;
+        } else if (!strcmp(keyword, "format")) {
+            filter.format = value;
+        } else if (!strcmp(keyword, "line")) {
+            if (__dyndbg_parse_lines(value, &filter) < 0) {
+                return -EINVAL;
+            }
+        } else {
+            return -EINVAL;
+        }
+    }
+    if (enable < 0) {
+        return -EINVAL;
+    }
+    for (dyndbg_site_t *site = __start___dyndbg; site < __stop___dyndbg; ++site) {
+        if (!__dyndbg_match(site, &filter)) {
+            continue;
+        }
+        if (enable) {
+            static_key_enable(&site->key);
+        } else {
+            static_key_disable(&site->key);
+        }
+        ++matched;
+    }
+    return matched ? 0 : -ENOENT;
+}
+
+ssize_t dyndbg_query(const char *query, size_t nbyte)
+{
+    char buffer[DYNDBG_QUERY_MAX], *saveptr, *command;
+    int ret = -EINVAL;
+    if (nbyte >= DYNDBG_QUERY_MAX) {
+        return -EINVAL;
+    }
+    memcpy(buffer, query, nbyte);
+    buffer[nbyte] = 0;
+    for (command = strtok_r(buffer, ";\n", &saveptr); command; command = strtok_r(NULL, ";\n", &saveptr)) {
+        // Skip the empty commands.
+        if (strspn(command, " \t") == strlen(command)) {
+            continue;
+        }
+        if ((ret = __dyndbg_command(command)) < 0) {
+            pr_err("Failed to apply the dynamic debug command `%s`.\n", command);
+            return ret;
+        }
+    }
+    return (ret < 0) ? ret : (ssize_t)nbyte;
+}
+
+ssize_t dyndbg_read(char *buffer, off_t offset, size_t nbyte)
+{
+    char line[BUFSIZ];
+    size_t written = 0;
+    off_t position = 0;
+    for (dyndbg_site_t *site = __start___dyndbg; (site < __stop___dyndbg) && (written < nbyte); ++site) {
+        int length = snprintf(
+            line, sizeof(line), "%s:%u [%s] =%c \"", site->file, site->line, site->function,
+            static_key_enabled(&site->key) ? 'p' : '_');
+        length = min(length, (int)sizeof(line) - 4);
+        // Escape the newlines of the format, so that each site takes a line.
+        for (const char *it = site->format; *it && (length < (int)sizeof(line) - 4); ++it) {
+            if (*it == '\n') {
+                line[length++] = '\\';
+                line[length++] = 'n';
+            } else {
+                line[length++] = *it;
+            }
+        }
+        line[length++] = '"';
+        line[length++] = '\n';
+        // Copy the part of the line which falls inside the requested window.
+        for (int it = 0; (it < length) && (written < nbyte); ++it, ++position) {
+            if (position >= offset) {
+                buffer[written++] = line[it];
+            }
+        }
+    }
+    return (ssize_t)written;
+}
@@ -5,14 +5,23 @@
 
 #include "fs/procfs.h"
 
+#include "ctype.h"
 #include "errno.h"
 #include "io/debug.h"
 #include "libgen.h"
+#include "mem/oom.h"
 #include "process/prio.h"
 #include "process/process.h"
+#include "process/scheduler.h"
 #include "stdio.h"
 #include "string.h"
 
+/// The size of the buffer used to generate the content of the text files.
+#define PROCR_BUFFER_SIZE 4096
+
+/// The files inside each `/proc/<PID>` folder.
+static const char *procr_entry_names[] = {"cmdline", "stat", "maps", "smaps", "pagemap", "oom_score", "oom_score_adj"};
+
 /// @brief Returns the character identifying the process state.
 /// @param state the process state.
 /// @return a character describing the state.
@@ -61,6 +70,21 @@ static inline ssize_t __procr_do_cmdline(char *buffer, size_t bufsize, task_stru
     return 1;
 }
 
+/// @brief Counts the resident pages of a task.
+/// @param task the task.
+/// @return the number of resident pages.
+static inline unsigned long __procr_get_rss(task_struct *task)
+{
+    vm_area_stats_t stats;
+    unsigned long rss = 0;
+    list_for_each_decl (it, &task->mm->mmap_list) {
+        if (vm_area_get_stats(list_entry(it, vm_area_struct_t, vm_list), &stats) == 0) {
+            rss += stats.resident;
+        }
+    }
+    return rss;
+}
+
 /// @brief Returns the data for the `/proc/<PID>/stat` file.
 /// @param buffer the buffer where the data should be placed.
 /// @param bufsize the size of the buffer.
@@ -146,7 +170,7 @@ static inline ssize_t __procr_do_stat(char *buffer, size_t bufsize, task_struct
     //      for children have made.
     //
     strcat(buffer, " 0");
-    //(14) TODO: utime  %lu
+    //(14) utime  %lu
     //      Amount of time that this process has been scheduled in
     //      user mode, measured in clock ticks (divide by
     //      sysconf(_SC_CLK_TCK)).  This includes guest time,
@@ -155,27 +179,27 @@ static inline ssize_t __procr_do_stat(char *buffer, size_t bufsize, task_struct
     //      guest time field do not lose that time from their cal‐
     //      culations.
     //
-    strcat(buffer, " 0");
-    //(15) TODO: stime  %lu
+    sprintf(buffer, "%s %lu", buffer, task->utime);
+    //(15) stime  %lu
     //      Amount of time that this process has been scheduled in
     //      kernel mode, measured in clock ticks (divide by
     //      sysconf(_SC_CLK_TCK)).
     //
-    strcat(buffer, " 0");
-    //(16) TODO: cutime  %ld
+    sprintf(buffer, "%s %lu", buffer, task->stime);
+    //(16) cutime  %ld
     //      Amount of time that this process's waited-for children
     //      have been scheduled in user mode, measured in clock
     //      ticks (divide by sysconf(_SC_CLK_TCK)).  (See also
     //      times(2).)  This includes guest time, cguest_time (time
     //      spent running a virtual CPU, see below).
     //
-    strcat(buffer, " 0");
-    //(17) TODO: cstime  %ld
+    sprintf(buffer, "%s %lu", buffer, task->cutime);
+    //(17) cstime  %ld
     //      Amount of time that this process's waited-for children
     //      have been scheduled in kernel mode, measured in clock
     //      ticks (divide by sysconf(_SC_CLK_TCK)).
     //
-    strcat(buffer, " 0");
+    sprintf(buffer, "%s %lu", buffer, task->cstime);
     //(18) priority  %ld
     //      (Explanation for Linux 2.6) For processes running a
     //      real-time scheduling policy (policy below; see
@@ -197,12 +221,12 @@ static inline ssize_t __procr_do_stat(char *buffer, size_t bufsize, task_struct
     //      range 19 (low priority) to -20 (high priority).
     //
     sprintf(buffer, "%s %ld", buffer, PRIO_TO_NICE(task->se.prio));
-    //(20) TODO: num_threads  %ld
+    //(20) num_threads  %ld
     //      Number of threads in this process (since Linux 2.6).
     //      Before kernel 2.6, this field was hard coded to 0 as a
     //      placeholder for an earlier removed field.
     //
-    strcat(buffer, " 0");
+    strcat(buffer, " 1");
     //(21) TODO: itrealvalue  %ld
     //      The time in jiffies before the next SIGALRM is sent to
     //      the process due to an interval timer.  Since kernel
@@ -222,8 +246,8 @@ static inline ssize_t __procr_do_stat(char *buffer, size_t bufsize, task_struct
     //(23) vsize  %lu
     //      Virtual memory size in bytes.
     //
-    sprintf(buffer, "%s %lu", buffer, task->mm->total_vm);
-    //(24) TODO: rss  %ld
+    sprintf(buffer, "%s %lu", buffer, task->mm->total_vm * PAGE_SIZE);
+    //(24) rss  %ld
     //      Resident Set Size: number of pages the process has in
     //      real memory.  This is just the pages which count toward
     //      text, data, or stack space.  This does not include
@@ -231,7 +255,7 @@ static inline ssize_t __procr_do_stat(char *buffer, size_t bufsize, task_struct
     //      are swapped out.  This value is inaccurate; see
     //      /proc/[pid]/statm below.
     //
-    strcat(buffer, " 0");
+    sprintf(buffer, "%s %lu", buffer, __procr_get_rss(task));
     //(25) TODO: rsslim  %lu
     //      Current soft limit in bytes on the rss of the process;
     //      see the description of RLIMIT_RSS in getrlimit(2).
@@ -309,23 +333,19 @@ static inline ssize_t __procr_do_stat(char *buffer, size_t bufsize, task_struct
     //      CPU number last executed on.
     //
     strcat(buffer, " 0");
-    //(40) TODO: rt_priority  %u  (since Linux 2.5.19)
+    //(40) rt_priority  %u  (since Linux 2.5.19)
     //      Real-time scheduling priority, a number in the range 1
     //      to 99 for processes scheduled under a real-time policy,
     //      or 0, for non-real-time processes (see
     //      sched_setscheduler(2)).
     //
-    if (task->se.prio >= 100) {
-        strcat(buffer, " 0");
-    } else {
-        sprintf(buffer, "%s %u", buffer, task->se.prio);
-    }
-    //(41) TODO: policy  %u  (since Linux 2.5.19)
+    sprintf(buffer, "%s %u", buffer, task->se.rt_priority);
+    //(41) policy  %u  (since Linux 2.5.19)
     //      Scheduling policy (see sched_setscheduler(2)).  Decode
     //      using the SCHED_* constants in linux/sched.h.
     //      The format for this field was %lu before Linux 2.6.22.
     //
-    strcat(buffer, " 0");
+    sprintf(buffer, "%s %u", buffer, task->se.policy);
     //(42) TODO: delayacct_blkio_ticks  %llu  (since Linux 2.6.18)
     //      Aggregated block I/O delays, measured in clock ticks
     //      (centiseconds).
@@ -378,10 +398,205 @@ static inline ssize_t __procr_do_stat(char *buffer, size_t bufsize, task_struct
     //(52) exit_code  %d  (since Linux 3.5)  [PT]
     //      The thread's exit status in the form reported by
     //      waitpid(2).
-    sprintf(buffer, "%s %d\n", buffer, task->exit_code);
+    sprintf(buffer, "%s %d", buffer, task->exit_code);
+    //(53) nvcsw  %lu  (MentOS only)
+    //      The number of context switches where the process left
+    //      the CPU because it went to sleep.
+    sprintf(buffer, "%s %lu", buffer, task->nvcsw);
+    //(54) nivcsw  %lu  (MentOS only)
+    //      The number of context switches where the process was
+    //      preempted while it was still runnable.
+    sprintf(buffer, "%s %lu", buffer, task->nivcsw);
+    //(55) sum_exec_runtime  %lu  (MentOS only)
+    //      The time the process has run for, as accounted by the
+    //      scheduler, measured in clock ticks.
+    sprintf(buffer, "%s %lu\n", buffer, task->se.sum_exec_runtime);
     return 1;
 }
 
+/// @brief Returns the name shown for a memory area.
+/// @param mm the memory descriptor of the task.
+/// @param area the memory area.
+/// @return the name of the area, or an empty string.
+static inline const char *__procr_get_area_name(mm_struct_t *mm, vm_area_struct_t *area)
+{
+    if ((mm->start_stack >= area->vm_start) && (mm->start_stack < area->vm_end)) {
+        return "[stack]";
+    }
+    if (mm->start_brk && (mm->start_brk >= area->vm_start) && (mm->start_brk < area->vm_end)) {
+        return "[heap]";
+    }
+    return "";
+}
+
+/// @brief Writes the line describing a memory area, as shown by `maps` and `smaps`.
+/// @param buffer the buffer where the data should be placed.
+/// @param bufsize the size of the buffer.
+/// @param mm the memory descriptor of the task.
+/// @param area the memory area.
+/// @return size of the written data in buffer.
+static inline ssize_t __procr_print_area(char *buffer, size_t bufsize, mm_struct_t *mm, vm_area_struct_t *area)
+{
+    // All the user pages are readable and, without NX support, executable.
+    // Areas are never shared between processes, they are private.
+    return snprintf(
+        buffer, bufsize, "%08x-%08x r%cxp 00000000 00:00 0 %s\n", area->vm_start, area->vm_end,
+        (area->vm_flags & MM_RW) ? 'w' : '-', __procr_get_area_name(mm, area));
+}
+
+/// @brief Returns the data for the `/proc/<PID>/maps` file.
+/// @param buffer the buffer where the data should be placed.
+/// @param bufsize the size of the buffer.
+/// @param task the task associated with the `/proc/<PID>` folder.
+/// @return size of the written data in buffer.
+static inline ssize_t __procr_do_maps(char *buffer, size_t bufsize, task_struct *task)
+{
+    ssize_t written = 0;
+    if (task->mm) {
+        list_for_each_decl (it, &task->mm->mmap_list) {
+            vm_area_struct_t *area = list_entry(it, vm_area_struct_t, vm_list);
+            written += __procr_print_area(buffer + written, bufsize - written, task->mm, area);
+        }
+    }
+    return written;
+}
+
+/// @brief Returns the data for the `/proc/<PID>/smaps` file.
+/// @param buffer the buffer where the data should be placed.
+/// @param bufsize the size of the buffer.
+/// @param task the task associated with the `/proc/<PID>` folder.
+/// @return size of the written data in buffer.
+static inline ssize_t __procr_do_smaps(char *buffer, size_t bufsize, task_struct *task)
+{
+    // Sizes are shown in kB.
+    const unsigned int page_kb = PAGE_SIZE / 1024;
+    vm_area_stats_t stats;
+    ssize_t written = 0;
+    if (task->mm) {
+        list_for_each_decl (it, &task->mm->mmap_list) {
+            vm_area_struct_t *area = list_entry(it, vm_area_struct_t, vm_list);
+            if (vm_area_get_stats(area, &stats) < 0) {
+                continue;
+            }
+            written += __procr_print_area(buffer + written, bufsize - written, task->mm, area);
+            written += snprintf(
+                buffer + written, bufsize - written,
+                "Size:       %8u kB\n"
+                "Rss:        %8u kB\n"
+                "Shared:     %8u kB\n"
+                "Private:    %8u kB\n"
+                "Shared_Cow: %8u kB\n"
+                "Dirty:      %8u kB\n"
+                "Referenced: %8u kB\n"
+                "VmFlags:%s%s%s%s%s\n",
+                stats.size * page_kb, stats.resident * page_kb, stats.shared * page_kb,
+                (stats.resident - stats.shared) * page_kb, stats.cow * page_kb, stats.dirty * page_kb,
+                stats.referenced * page_kb, (area->vm_flags & MM_PRESENT) ? " pr" : "",
+                (area->vm_flags & MM_RW) ? " wr" : "", (area->vm_flags & MM_USER) ? " us" : "",
+                (area->vm_flags & MM_GLOBAL) ? " gl" : "", (area->vm_flags & MM_COW) ? " cw" : "");
+        }
+    }
+    return written;
+}
+
+/// @brief Returns the data for the `/proc/<PID>/oom_score` file, namely
+/// the badness used by the OOM killer to select its victim.
+/// @param buffer the buffer where the data should be placed.
+/// @param bufsize the size of the buffer.
+/// @param task the task associated with the `/proc/<PID>` folder.
+/// @return size of the written data in buffer.
+static inline ssize_t __procr_do_oom_score(char *buffer, size_t bufsize, task_struct *task)
+{
+    return snprintf(buffer, bufsize, "%u\n", oom_score(task));
+}
+
+/// @brief Returns the data for the `/proc/<PID>/oom_score_adj` file.
+/// @param buffer the buffer where the data should be placed.
+/// @param bufsize the size of the buffer.
+/// @param task the task associated with the `/proc/<PID>` folder.
+/// @return size of the written data in buffer.
+static inline ssize_t __procr_do_oom_score_adj(char *buffer, size_t bufsize, task_struct *task)
+{
+    return snprintf(buffer, bufsize, "%d\n", task->oom_score_adj);
+}
+
+/// @brief Sets the OOM adjustment of a task, from the `/proc/<PID>/oom_score_adj` file.
+/// @details The procfs files belong to root, and their mode is not checked when
+/// they are opened, so the writers are checked here: the superuser, and the
+/// owner of the task. Only the superuser can lower the adjustment, the owner can
+/// only make its processes more likely to be killed.
+/// @param task the task associated with the `/proc/<PID>` folder.
+/// @param buffer the written content, a decimal number.
+/// @param nbyte the size of the content.
+/// @return the amount we consumed, or a negative error value.
+static inline ssize_t __procr_write_oom_score_adj(task_struct *task, const char *buffer, size_t nbyte)
+{
+    size_t it = 0;
+    int negative = 0, value = 0, digits = 0;
+    if ((it < nbyte) && ((buffer[it] == '-') || (buffer[it] == '+'))) {
+        negative = (buffer[it++] == '-');
+    }
+    for (; (it < nbyte) && isdigit(buffer[it]) && (value <= OOM_SCORE_ADJ_MAX); ++it, ++digits) {
+        value = (value * 10) + (buffer[it] - '0');
+    }
+    // Allow a trailing newline (e.g., when using echo).
+    while ((it < nbyte) && ((buffer[it] == '\n') || (buffer[it] == ' ') || (buffer[it] == 0))) {
+        ++it;
+    }
+    if ((digits == 0) || (it < nbyte) || (value > OOM_SCORE_ADJ_MAX)) {
+        return -EINVAL;
+    }
+    value = negative ? -value : value;
+    task_struct *current = scheduler_get_current_process();
+    if (!current || ((current->uid != 0) && (current->uid != task->uid))) {
+        return -EACCES;
+    }
+    if ((value < task->oom_score_adj) && (current->uid != 0)) {
+        return -EACCES;
+    }
+    task->oom_score_adj = value;
+    return nbyte;
+}
+
+/// @brief Reads the binary `/proc/<PID>/pagemap` file.
+/// @details The file contains one 64-bit entry per virtual page of the user
+/// space (see PM_PRESENT and the other PM_* bits in paging.h), the entry of the
+/// page at address `addr` is at offset `(addr / PAGE_SIZE) * 8`. Both the
+/// offset and the size of the read must be multiples of 8. Like on Linux, the
+/// page frame numbers are only shown to root, other readers get zeroes.
+/// @param task the task associated with the `/proc/<PID>` folder.
+/// @param buffer buffer where the read content must be placed.
+/// @param offset offset from which we start reading from the file.
+/// @param nbyte the number of bytes to read.
+/// @return The number of bytes we read, or a negative error value.
+static inline ssize_t __procr_read_pagemap(task_struct *task, char *buffer, off_t offset, size_t nbyte)
+{
+    const uint32_t last_page = PROCAREA_END_ADDR / PAGE_SIZE;
+    if ((offset < 0) || (offset % sizeof(pagemap_entry_t)) || (nbyte % sizeof(pagemap_entry_t))) {
+        return -EINVAL;
+    }
+    if (!task->mm || !task->mm->pgd) {
+        return 0;
+    }
+    uint32_t first_page = offset / sizeof(pagemap_entry_t);
+    if (first_page >= last_page) {
+        return 0;
+    }
+    size_t count = min(nbyte / sizeof(pagemap_entry_t), last_page - first_page);
+    pagemap_entry_t *entries = (pagemap_entry_t *)buffer;
+    if (mem_read_pagemap(task->mm->pgd, first_page, entries, count) < 0) {
+        return -EFAULT;
+    }
+    // Physical addresses help attacks like Rowhammer, keep them for root.
+    task_struct *current = scheduler_get_current_process();
+    if (!current || (current->uid != 0)) {
+        for (size_t i = 0; i < count; ++i) {
+            entries[i] &= ~PM_PFRAME_MASK;
+        }
+    }
+    return count * sizeof(pagemap_entry_t);
+}
+
 /// @brief Performs a read of files inside the `/proc/<PID>/` folder.
 /// @param file is the `/proc/<PID>/` folder, thus, it should be a `proc_dir_entry_t` data.
 /// @param buffer buffer where the read content must be placed.
@@ -403,24 +618,92 @@ static inline ssize_t __procr_read(vfs_file_t *file, char *buffer, off_t offset,
     if (task == NULL) {
         return -EFAULT;
     }
+    // The pagemap is binary, and way bigger than the support buffer.
+    if (strcmp(entry->name, "pagemap") == 0) {
+        return __procr_read_pagemap(task, buffer, offset, nbyte);
+    }
     // Prepare a support buffer.
-    char support[BUFSIZ];
-    memset(support, 0, BUFSIZ);
+    char support[PROCR_BUFFER_SIZE];
+    memset(support, 0, PROCR_BUFFER_SIZE);
     // Call the specific function.
     if (strcmp(entry->name, "cmdline") == 0) {
-        __procr_do_cmdline(support, BUFSIZ, task);
+        __procr_do_cmdline(support, PROCR_BUFFER_SIZE, task);
     } else if (strcmp(entry->name, "stat") == 0) {
-        __procr_do_stat(support, BUFSIZ, task);
+        __procr_do_stat(support, PROCR_BUFFER_SIZE, task);
+    } else if (strcmp(entry->name, "maps") == 0) {
+        __procr_do_maps(support, PROCR_BUFFER_SIZE, task);
+    } else if (strcmp(entry->name, "smaps") == 0) {
+        __procr_do_smaps(support, PROCR_BUFFER_SIZE, task);
+    } else if (strcmp(entry->name, "oom_score") == 0) {
+        __procr_do_oom_score(support, PROCR_BUFFER_SIZE, task);
+    } else if (strcmp(entry->name, "oom_score_adj") == 0) {
+        __procr_do_oom_score_adj(support, PROCR_BUFFER_SIZE, task);
     }
     // Copmute the amounts of bytes we want (and can) read.
-    ssize_t bytes_to_read = max(0, min(strlen(support) - offset, nbyte));
-    // Perform the read.
-    if (bytes_to_read > 0) {
-        strcpy(buffer, support + offset);
+    size_t length = strlen(support);
+    if ((offset < 0) || ((size_t)offset >= length)) {
+        return 0;
     }
+    ssize_t bytes_to_read = min(length - offset, nbyte);
+    // Perform the read.
+    memcpy(buffer, support + offset, bytes_to_read);
     return bytes_to_read;
 }
 
+/// @brief Performs a write of files inside the `/proc/<PID>/` folder, only
+/// `oom_score_adj` accepts writes.
+/// @param file the file we are writing.
+/// @param buffer buffer containing the content to write.
+/// @param offset offset from which we start writing to the file.
+/// @param nbyte the number of bytes to write.
+/// @return The number of written bytes, or a negative error value.
+static ssize_t __procr_write(vfs_file_t *file, const void *buffer, off_t offset, size_t nbyte)
+{
+    if (file == NULL) {
+        return -EFAULT;
+    }
+    // Get the entry.
+    proc_dir_entry_t *entry = (proc_dir_entry_t *)file->device;
+    if (entry == NULL) {
+        return -EFAULT;
+    }
+    // Get the task.
+    task_struct *task = (task_struct *)entry->data;
+    if (task == NULL) {
+        return -EFAULT;
+    }
+    if (strcmp(entry->name, "oom_score_adj") == 0) {
+        return __procr_write_oom_score_adj(task, (const char *)buffer, nbyte);
+    }
+    return -EINVAL;
+}
+
+/// @brief Repositions the offset of files inside the `/proc/<PID>/` folder.
+/// @param file the file we are working with.
+/// @param offset the offest to use for the operation.
+/// @param whence the type of operation.
+/// @return the resulting offset, or a negative error value.
+static off_t __procr_lseek(vfs_file_t *file, off_t offset, int whence)
+{
+    if (file == NULL) {
+        return -EFAULT;
+    }
+    switch (whence) {
+    case SEEK_CUR:
+        offset += file->f_pos;
+        break;
+    case SEEK_SET:
+        break;
+    default:
+        return -EINVAL;
+    }
+    if (offset < 0) {
+        return -EINVAL;
+    }
+    file->f_pos = offset;
+    return offset;
+}
+
 /// Filesystem general operations.
 static vfs_sys_operations_t procr_sys_operations = {
     .mkdir_f   = NULL,
@@ -436,8 +719,8 @@ static vfs_file_operations_t procr_fs_operations = {
     .unlink_f   = NULL,
     .close_f    = NULL,
     .read_f     = __procr_read,
-    .write_f    = NULL,
-    .lseek_f    = NULL,
+    .write_f    = __procr_write,
+    .lseek_f    = __procr_lseek,
     .stat_f     = NULL,
     .ioctl_f    = NULL,
     .getdents_f = NULL,
@@ -458,25 +741,20 @@ int procr_create_entry_pid(task_struct *entry)
         }
         proc_dir->data = entry;
     }
-    {
-        // Create `/proc/[PID]/cmdline`.
-        if ((proc_entry = proc_create_entry("cmdline", proc_dir)) == NULL) {
-            pr_err("[task: %d] Cannot create proc entry `%s`.\n", entry->pid, path);
+    for (int i = 0; i < count_of(procr_entry_names); i++) {
+        // Create `/proc/[PID]/<name>`.
+        if ((proc_entry = proc_create_entry(procr_entry_names[i], proc_dir)) == NULL) {
+            pr_err("[task: %d] Cannot create proc entry `%s/%s`.\n", entry->pid, path, procr_entry_names[i]);
             return -ENOENT;
         }
         proc_entry->sys_operations = &procr_sys_operations;
         proc_entry->fs_operations  = &procr_fs_operations;
         proc_entry->data           = entry;
-    }
-    {
-        // Create `/proc/[PID]/stat`.
-        if ((proc_entry = proc_create_entry("stat", proc_dir)) == NULL) {
-            pr_err("[task: %d] Cannot create proc entry `%s`.\n", entry->pid, path);
+        // The OOM adjustment can be changed by writing to its file.
+        if (proc_entry_set_mask(proc_entry, strcmp(procr_entry_names[i], "oom_score_adj") ? 0444 : 0644) < 0) {
+            pr_err("[task: %d] Cannot set mask of `%s/%s`.\n", entry->pid, path, procr_entry_names[i]);
             return -ENOENT;
         }
-        proc_entry->sys_operations = &procr_sys_operations;
-        proc_entry->fs_operations  = &procr_fs_operations;
-        proc_entry->data           = entry;
     }
     return 0;
 }
@@ -492,15 +770,12 @@ int procr_destroy_entry_pid(task_struct *entry)
         pr_err("[task: %d] Cannot find proc root directory `%s`.\n", entry->pid, pid_str);
         return -ENOENT;
     }
-    // Destroy `/proc/[PID]/cmdline`.
-    if (proc_destroy_entry("cmdline", proc_dir)) {
-        pr_err("[task: %d] Cannot destroy proc cmdline.\n", entry->pid);
-        return -ENOENT;
-    }
-    // Destroy `/proc/[PID]/stat`.
-    if (proc_destroy_entry("stat", proc_dir)) {
-        pr_err("[task: %d] Cannot destroy proc stat.\n", entry->pid);
-        return -ENOENT;
+    for (int i = 0; i < count_of(procr_entry_names); i++) {
+        // Destroy `/proc/[PID]/<name>`.
+        if (proc_destroy_entry(procr_entry_names[i], proc_dir)) {
+            pr_err("[task: %d] Cannot destroy proc %s.\n", entry->pid, procr_entry_names[i]);
+            return -ENOENT;
+        }
     }
     // Destroy `/proc/[PID]`.
     if (proc_rmdir(pid_str, NULL)) {
@@ -0,0 +1,136 @@
+/// @file proc_sysctl.c
+/// @brief Contains callbacks for the `/proc/sys` tunables.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "errno.h"
+#include "fs/procfs.h"
+#include "io/debug.h"
+#include "process/scheduler.h"
+#include "stdio.h"
+#include "string.h"
+#include "sys/sysctl.h"
+
+/// @brief Returns the tunable associated with the given file.
+/// @param file the file.
+/// @return the tunable, NULL if the file is not a valid entry.
+static inline sysctl_entry_t *__procsysctl_get_entry(vfs_file_t *file)
+{
+    if (!file || !file->device) {
+        return NULL;
+    }
+    return (sysctl_entry_t *)((proc_dir_entry_t *)file->device)->data;
+}
+
+/// @brief Reads the value of a tunable.
+/// @param file The file.
+/// @param buf Buffer where the read content must be placed.
+/// @param offset Offset from which we start reading from the file.
+/// @param nbyte The number of bytes to read.
+/// @return The number of red bytes.
+static ssize_t __procsysctl_read(vfs_file_t *file, char *buf, off_t offset, size_t nbyte)
+{
+    sysctl_entry_t *entry = __procsysctl_get_entry(file);
+    if (entry == NULL) {
+        pr_err("The file is not a valid sysctl entry.\n");
+        return -EFAULT;
+    }
+    char buffer[16];
+    ssize_t length = snprintf(buffer, sizeof(buffer), "%d\n", sysctl_read(entry));
+    ssize_t it     = 0;
+    while ((it < nbyte) && (offset + it < length)) {
+        buf[it] = buffer[offset + it];
+        ++it;
+    }
+    return it;
+}
+
+/// @brief Sets the value of a tunable, only the superuser can do it.
+/// @param file The file.
+/// @param buf Buffer containing the new value, a decimal number.
+/// @param offset Offset from which we start writing to the file.
+/// @param nbyte The number of bytes to write.
+/// @return The number of written bytes, or a negative error value.
+static ssize_t __procsysctl_write(vfs_file_t *file, const void *buf, off_t offset, size_t nbyte)
+{
+    sysctl_entry_t *entry = __procsysctl_get_entry(file);
+    if (entry == NULL) {
+        pr_err("The file is not a valid sysctl entry.\n");
+        return -EFAULT;
+    }
+    task_struct *current = scheduler_get_current_process();
+    if (current && (current->uid != 0)) {
+        return -EACCES;
+    }
+    return sysctl_write(entry, (const char *)buf, nbyte);
+}
+
+/// Filesystem general operations.
+static vfs_sys_operations_t procsysctl_sys_operations = {
+    .mkdir_f   = NULL,
+    .rmdir_f   = NULL,
+    .stat_f    = NULL,
+    .creat_f   = NULL,
+    .symlink_f = NULL,
+};
+
+/// Filesystem file operations.
+static vfs_file_operations_t procsysctl_fs_operations = {
+    .open_f     = NULL,
+    .unlink_f   = NULL,
+    .close_f    = NULL,
+    .read_f     = __procsysctl_read,
+    .write_f    = __procsysctl_write,
+    .lseek_f    = NULL,
+    .stat_f     = NULL,
+    .ioctl_f    = NULL,
+    .getdents_f = NULL,
+    .readlink_f = NULL,
+};
+
+int procsysctl_module_init(void)
+{
+    proc_dir_entry_t *folder = NULL, *entry = NULL;
+    sysctl_entry_t *sysctl   = NULL;
+    char path[PATH_MAX], last[PATH_MAX] = {0};
+
+    // First, we need to create the `/proc/sys` folder.
+    if ((folder = proc_mkdir("sys", NULL)) == NULL) {
+        pr_err("Cannot create the `/proc/sys` directory.\n");
+        return 1;
+    }
+    if (proc_entry_set_mask(folder, 0555) < 0) {
+        pr_err("Cannot set mask of `/proc/sys` directory.\n");
+        return 1;
+    }
+    for (size_t i = 0; (sysctl = sysctl_get_entry(i)) != NULL; ++i) {
+        // Create the sub-directory (e.g., `/proc/sys/kernel`), the table
+        // keeps the tunables of the same directory together.
+        strcpy(path, sysctl->path);
+        *strchr(path, '/') = 0;
+        if (strcmp(path, last) != 0) {
+            strcpy(last, path);
+            if ((entry = proc_mkdir(path, folder)) == NULL) {
+                pr_err("Cannot create the `/proc/sys/%s` directory.\n", path);
+                return 1;
+            }
+            if (proc_entry_set_mask(entry, 0555) < 0) {
+                pr_err("Cannot set mask of `/proc/sys/%s` directory.\n", path);
+                return 1;
+            }
+        }
+        // Create the `/proc/sys/<path>` file.
+        if ((entry = proc_create_entry(sysctl->path, folder)) == NULL) {
+            pr_err("Cannot create the `/proc/sys/%s` file.\n", sysctl->path);
+            return 1;
+        }
+        entry->sys_operations = &procsysctl_sys_operations;
+        entry->fs_operations  = &procsysctl_fs_operations;
+        entry->data           = sysctl;
+        if (proc_entry_set_mask(entry, 0644) < 0) {
+            pr_err("Cannot set mask of `/proc/sys/%s` file.\n", sysctl->path);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -3,27 +3,51 @@
 /// @copyright (c) 2014-2024 This file is distributed under the MIT License.
 /// See LICENSE.md for details.
 
+#include "descriptor_tables/isr.h"
 #include "errno.h"
+#include "fcntl.h"
 #include "fs/procfs.h"
 #include "hardware/timer.h"
 #include "io/debug.h"
+#include "math.h"
+#include "mem/oom.h"
 #include "process/process.h"
+#include "process/scheduler.h"
+#include "resource_tracing.h"
 #include "stdio.h"
 #include "string.h"
+#include "sys/sysctl.h"
 #include "version.h"
 
 static ssize_t procs_do_uptime(char *buffer, size_t bufsize);
 
 static ssize_t procs_do_version(char *buffer, size_t bufsize);
 
+static ssize_t procs_do_cmdline(char *buffer, size_t bufsize);
+
 static ssize_t procs_do_mounts(char *buffer, size_t bufsize);
 
 static ssize_t procs_do_cpuinfo(char *buffer, size_t bufsize);
 
 static ssize_t procs_do_meminfo(char *buffer, size_t bufsize);
 
+static ssize_t procs_do_nodeinfo(char *buffer, size_t bufsize);
+
 static ssize_t procs_do_stat(char *buffer, size_t bufsize);
 
+static ssize_t procs_do_interrupts(char *buffer, size_t bufsize);
+
+static ssize_t procs_do_softirqs(char *buffer, size_t bufsize);
+
+static ssize_t procs_do_allocinfo(char *buffer, size_t bufsize);
+
+static ssize_t procs_write_allocinfo(const char *buffer, size_t nbyte);
+
+static ssize_t procs_read_mempressure(vfs_file_t *file, char *buf, size_t nbyte);
+
+/// The size of the buffer used to generate the content of the files.
+#define PROCS_BUFFER_SIZE 4096
+
 /// @brief Read function for the proc system.
 /// @param file The file.
 /// @param buf Buffer where the read content must be placed.
@@ -41,23 +65,41 @@ static ssize_t __procs_read(vfs_file_t *file, char *buf, off_t offset, size_t nb
         pr_err("The file is not a valid proc entry.\n");
         return -EFAULT;
     }
+    // The memory pressure is a stream of levels, the offset does not matter.
+    if (strcmp(entry->name, "mempressure") == 0) {
+        return procs_read_mempressure(file, buf, nbyte);
+    }
+    // The list of dynamic debug sites does not fit the buffer.
+    if (strcmp(entry->name, "dynamic_debug") == 0) {
+        return dyndbg_read(buf, offset, nbyte);
+    }
     // Prepare a buffer.
-    char buffer[BUFSIZ];
-    memset(buffer, 0, BUFSIZ);
+    char buffer[PROCS_BUFFER_SIZE];
+    memset(buffer, 0, PROCS_BUFFER_SIZE);
     // Call the specific function.
     int ret = 0;
     if (strcmp(entry->name, "uptime") == 0) {
-        ret = procs_do_uptime(buffer, BUFSIZ);
+        ret = procs_do_uptime(buffer, PROCS_BUFFER_SIZE);
     } else if (strcmp(entry->name, "version") == 0) {
-        ret = procs_do_version(buffer, BUFSIZ);
+        ret = procs_do_version(buffer, PROCS_BUFFER_SIZE);
+    } else if (strcmp(entry->name, "cmdline") == 0) {
+        ret = procs_do_cmdline(buffer, PROCS_BUFFER_SIZE);
     } else if (strcmp(entry->name, "mounts") == 0) {
-        ret = procs_do_mounts(buffer, BUFSIZ);
+        ret = procs_do_mounts(buffer, PROCS_BUFFER_SIZE);
     } else if (strcmp(entry->name, "cpuinfo") == 0) {
-        ret = procs_do_cpuinfo(buffer, BUFSIZ);
+        ret = procs_do_cpuinfo(buffer, PROCS_BUFFER_SIZE);
     } else if (strcmp(entry->name, "meminfo") == 0) {
-        ret = procs_do_meminfo(buffer, BUFSIZ);
+        ret = procs_do_meminfo(buffer, PROCS_BUFFER_SIZE);
+    } else if (strcmp(entry->name, "nodeinfo") == 0) {
+        ret = procs_do_nodeinfo(buffer, PROCS_BUFFER_SIZE);
     } else if (strcmp(entry->name, "stat") == 0) {
-        ret = procs_do_stat(buffer, BUFSIZ);
+        ret = procs_do_stat(buffer, PROCS_BUFFER_SIZE);
+    } else if (strcmp(entry->name, "interrupts") == 0) {
+        ret = procs_do_interrupts(buffer, PROCS_BUFFER_SIZE);
+    } else if (strcmp(entry->name, "softirqs") == 0) {
+        ret = procs_do_softirqs(buffer, PROCS_BUFFER_SIZE);
+    } else if (strcmp(entry->name, "allocinfo") == 0) {
+        ret = procs_do_allocinfo(buffer, PROCS_BUFFER_SIZE);
     }
     // Perform read.
     ssize_t it = 0;
@@ -75,6 +117,37 @@ static ssize_t __procs_read(vfs_file_t *file, char *buf, off_t offset, size_t nb
     return it;
 }
 
+/// @brief Write function for the proc system, only some files accept writes.
+/// @param file The file.
+/// @param buf Buffer containing the content to write.
+/// @param offset Offset from which we start writing to the file.
+/// @param nbyte The number of bytes to write.
+/// @return The number of written bytes, or a negative error value.
+static ssize_t __procs_write(vfs_file_t *file, const void *buf, off_t offset, size_t nbyte)
+{
+    if (!file) {
+        pr_err("We received a NULL file pointer.\n");
+        return -EFAULT;
+    }
+    proc_dir_entry_t *entry = (proc_dir_entry_t *)file->device;
+    if (entry == NULL) {
+        pr_err("The file is not a valid proc entry.\n");
+        return -EFAULT;
+    }
+    if (strcmp(entry->name, "allocinfo") == 0) {
+        return procs_write_allocinfo((const char *)buf, nbyte);
+    }
+    if (strcmp(entry->name, "dynamic_debug") == 0) {
+        // Enabling a site patches the kernel code.
+        task_struct *current = scheduler_get_current_process();
+        if (current && (current->uid != 0)) {
+            return -EACCES;
+        }
+        return dyndbg_query((const char *)buf, nbyte);
+    }
+    return -EINVAL;
+}
+
 /// Filesystem general operations.
 static vfs_sys_operations_t procs_sys_operations = {
     .mkdir_f   = NULL,
@@ -90,7 +163,7 @@ static vfs_file_operations_t procs_fs_operations = {
     .unlink_f   = NULL,
     .close_f    = NULL,
     .read_f     = __procs_read,
-    .write_f    = NULL,
+    .write_f    = __procs_write,
     .lseek_f    = NULL,
     .stat_f     = NULL,
     .ioctl_f    = NULL,
@@ -101,7 +174,9 @@ static vfs_file_operations_t procs_fs_operations = {
 int procs_module_init(void)
 {
     proc_dir_entry_t *system_entry;
-    char *entry_names[] = {"uptime", "version", "mounts", "cpuinfo", "meminfo", "stat"};
+    char *entry_names[] = {"uptime",    "version",     "cmdline",       "mounts",     "cpuinfo",
+                           "meminfo",   "nodeinfo",    "stat",          "interrupts", "softirqs",
+                           "allocinfo", "mempressure", "dynamic_debug"};
     for (int i = 0; i < count_of(entry_names); i++) {
         char *entry_name = entry_names[i];
         if ((system_entry = proc_create_entry(entry_name, NULL)) == NULL) {
@@ -112,7 +187,9 @@ int procs_module_init(void)
         // Set the specific operations.
         system_entry->sys_operations = &procs_sys_operations;
         system_entry->fs_operations  = &procs_fs_operations;
-        if (proc_entry_set_mask(system_entry, 0444) < 0) {
+        // The allocation profiler and the dynamic debug are controlled by writing to their files.
+        mode_t mask = (!strcmp(entry_name, "allocinfo") || !strcmp(entry_name, "dynamic_debug")) ? 0644 : 0444;
+        if (proc_entry_set_mask(system_entry, mask) < 0) {
             pr_err("Cannot set mask of `/proc/%s`.\n", entry_name);
             return 1;
         }
@@ -136,6 +213,12 @@ static ssize_t procs_do_version(char *buffer, size_t bufsize)
     return sprintf(buffer, "%s version %s (site: %s) (email: %s)", OS_NAME, OS_VERSION, OS_SITEURL, OS_REF_EMAIL);
 }
 
+/// @brief Write the kernel command line inside the buffer.
+/// @param buffer the buffer.
+/// @param bufsize the buffer size.
+/// @return the amount we wrote.
+static ssize_t procs_do_cmdline(char *buffer, size_t bufsize) { return snprintf(buffer, bufsize, "%s\n", cmdline_get()); }
+
 /// @brief Write the list of mount points inside the buffer.
 /// @param buffer the buffer.
 /// @param bufsize the buffer size.
@@ -176,8 +259,126 @@ static ssize_t procs_do_meminfo(char *buffer, size_t bufsize)
         kernel_buddy_status, user_buddy_status);
 }
 
-/// @brief Write the process statistics inside the buffer.
+/// @brief Write the memory and the allocation statistics of each NUMA node inside the buffer.
+/// @param buffer the buffer.
+/// @param bufsize the buffer size.
+/// @return the amount we wrote.
+static ssize_t procs_do_nodeinfo(char *buffer, size_t bufsize) { return numa_print_stats(buffer, bufsize); }
+
+/// @brief Write the CPU time and the process statistics inside the buffer.
+/// @param buffer the buffer.
+/// @param bufsize the buffer size.
+/// @return the amount we wrote.
+static ssize_t procs_do_stat(char *buffer, size_t bufsize)
+{
+    timespec_t now, uptime;
+    unsigned long running = 0, blocked = 0;
+    list_for_each_decl (it, &runqueue.queue) {
+        task_struct *task = list_entry(it, task_struct, run_list);
+        if (task->state == TASK_RUNNING) {
+            ++running;
+        } else if (task->state == TASK_UNINTERRUPTIBLE) {
+            ++blocked;
+        }
+    }
+    timer_get_realtime(&now);
+    timer_get_monotonic(&uptime);
+    // The times are in clock ticks, there is neither nice, nor I/O wait, nor
+    // interrupt time accounting, and there is a single CPU. The last lines give
+    // the units used by the files in `/proc` to userspace, since the clock
+    // frequency is not the usual 100 Hz.
+    return snprintf(
+        buffer, bufsize,
+        "cpu  %lu 0 %lu %lu 0 0 0 0 0 0\n"
+        "cpu0 %lu 0 %lu %lu 0 0 0 0 0 0\n"
+        "ctxt %lu\n"
+        "btime %lu\n"
+        "processes %lu\n"
+        "procs_running %lu\n"
+        "procs_blocked %lu\n"
+        "clk_tck %u\n"
+        "page_size %lu\n",
+        kernel_cpustat.user, kernel_cpustat.system, kernel_cpustat.idle, kernel_cpustat.user, kernel_cpustat.system,
+        kernel_cpustat.idle, kernel_cpustat.context_switches, (unsigned long)(now.tv_sec - uptime.tv_sec),
+        kernel_cpustat.forks, running, blocked, TICKS_PER_SECOND, PAGE_SIZE);
+}
+
+/// @brief Write the interrupts and exceptions statistics inside the buffer.
+/// @param buffer the buffer.
+/// @param bufsize the buffer size.
+/// @return the amount we wrote.
+static ssize_t procs_do_interrupts(char *buffer, size_t bufsize)
+{
+    ssize_t len = irq_print_stats(buffer, bufsize);
+    return len + isr_print_stats(buffer + len, bufsize - len);
+}
+
+/// @brief Write the deferred activities statistics inside the buffer.
 /// @param buffer the buffer.
 /// @param bufsize the buffer size.
 /// @return the amount we wrote.
-static ssize_t procs_do_stat(char *buffer, size_t bufsize) { return 0; }
+static ssize_t procs_do_softirqs(char *buffer, size_t bufsize) { return softirq_print_stats(buffer, bufsize); }
+
+/// @brief Writes the report of the allocation profiler.
+/// @param buffer the buffer.
+/// @param bufsize the buffer size.
+/// @return the amount we wrote.
+static ssize_t procs_do_allocinfo(char *buffer, size_t bufsize) { return alloc_profiler_print(buffer, bufsize); }
+
+/// @brief Controls the allocation profiler: "1" or "on" enables it, "0" or
+/// "off" disables it, "reset" clears all the statistics.
+/// @param buffer the written content.
+/// @param nbyte the size of the content.
+/// @return the amount we consumed, or a negative error value.
+static ssize_t procs_write_allocinfo(const char *buffer, size_t nbyte)
+{
+    char command[16];
+    size_t length = min(nbyte, sizeof(command) - 1);
+    memcpy(command, buffer, length);
+    // Drop the trailing newline (e.g., when using echo).
+    while ((length > 0) && ((command[length - 1] == '\n') || (command[length - 1] == ' '))) {
+        --length;
+    }
+    command[length] = 0;
+    if (!strcmp(command, "1") || !strcmp(command, "on")) {
+        alloc_profiler_enable(1);
+    } else if (!strcmp(command, "0") || !strcmp(command, "off")) {
+        alloc_profiler_enable(0);
+    } else if (!strcmp(command, "reset")) {
+        alloc_profiler_reset();
+    } else {
+        return -EINVAL;
+    }
+    return nbyte;
+}
+
+/// @brief Reads the memory pressure level (i.e., none, low, medium or
+/// critical). The first read returns the current level, the following ones
+/// wait for the level to change, so that a process can shed its caches before
+/// the kernel runs out of memory. Like pipes, a blocking read sleeps until the
+/// level changes, a non-blocking one returns -EAGAIN.
+/// @param file the file, it keeps the last change reported to its reader.
+/// @param buf the buffer where the level is placed.
+/// @param nbyte the size of the buffer.
+/// @return the amount we wrote, or a negative error value.
+static ssize_t procs_read_mempressure(vfs_file_t *file, char *buf, size_t nbyte)
+{
+    unsigned long events;
+    while ((unsigned long)file->private_data == (events = mempressure_get_events())) {
+        if (file->open_flags & O_NONBLOCK) {
+            return -EAGAIN;
+        }
+        int ret = mempressure_wait();
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    char level[16];
+    ssize_t length = snprintf(level, sizeof(level), "%s\n", mempressure_level_name(mempressure_get_level()));
+    if (nbyte < (size_t)length) {
+        return -EINVAL;
+    }
+    memcpy(buf, level, length);
+    file->private_data = (void *)events;
+    return length;
+}
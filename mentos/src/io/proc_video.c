@@ -70,9 +70,15 @@ static ssize_t procv_read(vfs_file_t *file, char *buf, off_t offset, size_t nbyt
     // Once we have dealt with canonical mode, get the character.
     int c = keyboard_pop_back();
 
-    // Check that it's a valid character.
-    if (c < 0) {
-        return 0; // No valid character received.
+    // Sleep until a key is pressed, instead of having the reader poll.
+    while (c < 0) {
+        if (file->flags & O_NONBLOCK) {
+            return 0; // No valid character received.
+        }
+        if (keyboard_wait() < 0) {
+            return -EINTR;
+        }
+        c = keyboard_pop_back();
     }
 
     // Keep only the character, not the scancode.
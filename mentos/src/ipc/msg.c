@@ -16,6 +16,7 @@
 #include "fcntl.h"
 #include "process/process.h"
 #include "process/scheduler.h"
+#include "process/wait.h"
 #include "stdio.h"
 #include "stdlib.h"
 #include "string.h"
@@ -44,6 +45,10 @@ typedef struct {
 /// @brief List of all current active Message queues.
 list_head msq_list;
 
+/// @brief The processes waiting to send or receive a message, on any queue. It
+/// is shared, since a message queue can be removed while processes sleep on it.
+static wait_queue_head_t msq_wait;
+
 // ============================================================================
 // MEMORY MANAGEMENT (Private)
 // ============================================================================
@@ -206,6 +211,48 @@ static inline void __msq_info_remove_message(msq_info_t *msq_info, struct msg *m
     message->msg_next = NULL;
 }
 
+/// @brief Searches for the message to receive.
+/// @param msq_info the message queue.
+/// @param msgtyp the type of the message, see msgrcv.
+/// @return the message, NULL if there is none.
+static inline struct msg *__msq_info_find_message(msq_info_t *msq_info, long msgtyp)
+{
+    struct msg *message = NULL;
+    // If msgtyp is 0, then the first message in the queue is read.
+    if (msgtyp == 0) {
+        // Get the first message.
+        message = msq_info->msg_first;
+    }
+    // If msgtyp is greater than 0, then the first message in the queue of type
+    // msgtyp is read.
+    else if (msgtyp > 0) {
+        for (struct msg *it = msq_info->msg_first; it; it = it->msg_next) {
+            if (it->msg_type == msgtyp) {
+                message = it;
+                break;
+            }
+        }
+    }
+    // If msgtyp is less than 0, then the first message in the queue with the
+    // lowest type less than or equal to the absolute value of msgtyp will be
+    // read.
+    else {
+        long lowest_type = LONG_MAX;
+        for (struct msg *it = msq_info->msg_first; it; it = it->msg_next) {
+            if ((it->msg_type < abs(msgtyp)) && (it->msg_type < lowest_type)) {
+                lowest_type = it->msg_type;
+            }
+        }
+        for (struct msg *it = msq_info->msg_first; it; it = it->msg_next) {
+            if (it->msg_type == lowest_type) {
+                message = it;
+                break;
+            }
+        }
+    }
+    return message;
+}
+
 // ============================================================================
 // SYSTEM FUNCTIONS
 // ============================================================================
@@ -215,6 +262,7 @@ static inline void __msq_info_remove_message(msq_info_t *msq_info, struct msg *m
 int msq_init(void)
 {
     list_head_init(&msq_list);
+    wait_queue_head_init(&msq_wait);
     return 0;
 }
 
@@ -311,10 +359,20 @@ int sys_msgsnd(int msqid, const void *msgp, size_t msgsz, int msgflg)
                "calling process does not have permission to access the set.\n");
         return -EACCES;
     }
-    // Check if the message can't be sent due to the msg_qbytes limit for the
-    // queue.
-    if (((msq_info->msqid.msg_cbytes + msgsz) >= msq_info->msqid.msg_qbytes)) {
-        return -EAGAIN;
+    // Wait while the message can't be sent due to the msg_qbytes limit for
+    // the queue.
+    while ((msq_info->msqid.msg_cbytes + msgsz) >= msq_info->msqid.msg_qbytes) {
+        if (msgflg & IPC_NOWAIT) {
+            return -EAGAIN;
+        }
+        int ret = interruptible_sleep_on(&msq_wait);
+        if (ret < 0) {
+            return ret;
+        }
+        // The queue might have been removed while we were sleeping.
+        if (!(msq_info = __list_find_msq_info_by_id(msqid))) {
+            return -EIDRM;
+        }
     }
     // Allocate the memory for the message.
     struct msg *message = (struct msg *)kmalloc(sizeof(struct msg));
@@ -357,6 +415,8 @@ int sys_msgsnd(int msqid, const void *msgp, size_t msgsz, int msgflg)
     for (struct msg *it = msq_info->msg_first; it; it = it->msg_next) {
         pr_debug("    type: %3ld, size: %3d, msg: `%s`\n", it->msg_type, it->msg_size, it->msg_ptr);
     }
+    // Wake up the receivers.
+    wake_up_all(&msq_wait);
     return 0;
 }
 
@@ -401,44 +461,21 @@ ssize_t sys_msgrcv(int msqid, void *msgp, size_t msgsz, long msgtyp, int msgflg)
                "set.\n");
         return -EACCES;
     }
-    // Prepare a structure for the message.
-    struct msg *message = NULL;
-    // If msgtyp is 0, then the first message in the queue is read.
-    if (msgtyp == 0) {
-        // Get the first message.
-        message = msq_info->msg_first;
-    }
-    // If msgtyp is greater than 0, then the first message in the queue of type
-    // msgtyp is read.
-    else if (msgtyp > 0) {
-        for (struct msg *it = msq_info->msg_first; it; it = it->msg_next) {
-            if (it->msg_type == msgtyp) {
-                message = it;
-                break;
-            }
+    // Wait until there is a message to read.
+    struct msg *message;
+    while (!(message = __msq_info_find_message(msq_info, msgtyp))) {
+        if (msgflg & IPC_NOWAIT) {
+            return -ENOMSG;
         }
-    }
-    // If msgtyp is less than 0, then the first message in the queue with the
-    // lowest type less than or equal to the absolute value of msgtyp will be
-    // read.
-    else {
-        long lowest_type = LONG_MAX;
-        for (struct msg *it = msq_info->msg_first; it; it = it->msg_next) {
-            if ((it->msg_type < abs(msgtyp)) && (it->msg_type < lowest_type)) {
-                lowest_type = it->msg_type;
-            }
+        int ret = interruptible_sleep_on(&msq_wait);
+        if (ret < 0) {
+            return ret;
         }
-        for (struct msg *it = msq_info->msg_first; it; it = it->msg_next) {
-            if (it->msg_type == lowest_type) {
-                message = it;
-                break;
-            }
+        // The queue might have been removed while we were sleeping.
+        if (!(msq_info = __list_find_msq_info_by_id(msqid))) {
+            return -EIDRM;
         }
     }
-    if (message == NULL) {
-        // pr_err("There are no messages to read.\n");
-        return -ENOMSG;
-    }
     // Check if the message is longer than msgsz.
     if (message->msg_size > msgsz) {
         // If we have the MSG_NOERROR flag, we return E2BIG and leave the
@@ -480,6 +517,8 @@ ssize_t sys_msgrcv(int msqid, void *msgp, size_t msgsz, long msgtyp, int msgflg)
     // Free the memory of the data structure.
     kfree(message);
 
+    // Wake up the senders.
+    wake_up_all(&msq_wait);
     return actual_size;
 }
 
@@ -516,6 +555,8 @@ int sys_msgctl(int msqid, int cmd, struct msqid_ds *buf)
         __list_remove_msq_info(msq_info);
         // Delete the info.
         __msq_info_dealloc(msq_info);
+        // Wake up the processes blocked on the queue.
+        wake_up_all(&msq_wait);
     } else if (cmd == IPC_STAT) {
         // Place a copy of the msqid_ds data structure in the buffer pointed to
         // by buf.
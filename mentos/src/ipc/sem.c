@@ -23,9 +23,8 @@
 /// version of the semop function both user and kernel side.
 /// The way it works is pretty straightforward, the user tries to perform an
 /// operation and based on the value of the semaphore the kernel returns certain
-/// values. If the operation cannot be performed then the user will stay in a
-/// while loop. The cycle ends with a positive return value (the operation has
-/// been taken care of) or in case of errors.
+/// values. If the operation cannot be performed then the process sleeps in the
+/// kernel, until another process changes the semaphores, or a signal arrives.
 /// For testing purposes -> you can try the t_semget and the t_sem1 tests. They
 /// both use semaphores and blocking / non blocking operations. t_sem1 is also
 /// an exercise that was assingned by Professor Drago in the OS course.
@@ -46,6 +45,7 @@
 #include "fcntl.h"
 #include "process/process.h"
 #include "process/scheduler.h"
+#include "process/wait.h"
 #include "stdio.h"
 #include "stdlib.h"
 #include "string.h"
@@ -68,6 +68,10 @@ typedef struct {
 /// @brief List of all current active semaphores.
 list_head semaphores_list;
 
+/// @brief The processes waiting for the value of a semaphore, in any set. It is
+/// shared, since a set can be removed while processes sleep on it.
+static wait_queue_head_t semaphores_wait;
+
 // ============================================================================
 // MEMORY MANAGEMENT (Private)
 // ============================================================================
@@ -185,6 +189,7 @@ static inline void __list_remove_sem_info(sem_info_t *sem_info)
 int sem_init(void)
 {
     list_head_init(&semaphores_list);
+    wait_queue_head_init(&semaphores_wait);
     return 0;
 }
 
@@ -291,21 +296,41 @@ long sys_semop(int semid, struct sembuf *sops, unsigned nsops)
                "process does not have permission to access the set.\n");
         return -EACCES;
     }
-    // Update semop time.
-    sem_info->semid.sem_otime = sys_time(NULL);
     // If the operation is negative then we need to check for possible blocking
-    // operation. If the value of the sem were to become negative then we return
-    // a special value.
-    if (((int)sem_info->sem_base[sops->sem_num].sem_val + (int)sops->sem_op) < 0) {
-        // The value would become negative, we cannot perform the operation.
-        return -EAGAIN;
+    // operation: we wait while the value of the sem would become negative. A
+    // zero operation waits for the value to become zero.
+    while (((sops->sem_op < 0) && (((int)sem_info->sem_base[sops->sem_num].sem_val + (int)sops->sem_op) < 0)) ||
+           ((sops->sem_op == 0) && (sem_info->sem_base[sops->sem_num].sem_val != 0))) {
+        // We cannot perform the operation now.
+        if (sops->sem_flg & IPC_NOWAIT) {
+            return -EAGAIN;
+        }
+        // Count the process among the waiting ones, while it sleeps.
+        unsigned short *count = (sops->sem_op < 0) ? &sem_info->sem_base[sops->sem_num].sem_ncnt
+                                                   : &sem_info->sem_base[sops->sem_num].sem_zcnt;
+        ++(*count);
+        int ret = interruptible_sleep_on(&semaphores_wait);
+        // The set might have been removed while we were sleeping.
+        if (!(sem_info = __list_find_sem_info_by_id(semid))) {
+            return -EIDRM;
+        }
+        --(*count);
+        if (ret < 0) {
+            return ret;
+        }
     }
+    // Update semop time.
+    sem_info->semid.sem_otime = sys_time(NULL);
     // Update the semaphore value.
     sem_info->sem_base[sops->sem_num].sem_val += sops->sem_op;
     // Update the pid of the process that did last op.
     sem_info->sem_base[sops->sem_num].sem_pid = sys_getpid();
     // Update the time.
     sem_info->semid.sem_ctime                 = sys_time(NULL);
+    // Wake up the processes waiting for the semaphores to change.
+    if (sops->sem_op != 0) {
+        wake_up_all(&semaphores_wait);
+    }
     return 0;
 }
 
@@ -337,6 +362,8 @@ long sys_semctl(int semid, int semnum, int cmd, union semun *arg)
         __list_remove_sem_info(sem_info);
         // Delete the set.
         __sem_info_dealloc(sem_info);
+        // Wake up the processes blocked on the set.
+        wake_up_all(&semaphores_wait);
     } else if (cmd == SETVAL) {
         // The value of the semnum-th semaphore in the set is initialized to the
         // value specified in arg.val.
@@ -366,6 +393,8 @@ long sys_semctl(int semid, int semnum, int cmd, union semun *arg)
         sem_info->sem_base[semnum].sem_val = arg->val;
         // Update the last change time.
         sem_info->semid.sem_ctime          = sys_time(NULL);
+        // Wake up the processes waiting for the new value.
+        wake_up_all(&semaphores_wait);
     } else if (cmd == SETALL) {
         // Initialize all semaphore in the set referred to by semid, using the
         // values supplied in the array pointed to by arg.array.
@@ -392,6 +421,8 @@ long sys_semctl(int semid, int semnum, int cmd, union semun *arg)
         }
         // Update the last change time.
         sem_info->semid.sem_ctime = sys_time(NULL);
+        // Wake up the processes waiting for the new values.
+        wake_up_all(&semaphores_wait);
     } else if (cmd == IPC_STAT) {
         // Place a copy of the semid_ds data structure in the buffer pointed to by
         // arg.buf.
@@ -75,8 +75,9 @@ static inline shm_info_t *__shm_info_alloc(key_t key, size_t size, int shmflg)
     shm_info->shmid.shm_nattch = 0;
     // Determine the order for memory allocation.
     uint32_t order             = find_nearest_order_greater(0, size);
-    // Allocate the shared memory pages.
-    shm_info->shm_location     = alloc_pages(GFP_KERNEL, order);
+    // Allocate the shared memory pages, spreading the segments across the
+    // nodes, as they are used by tasks which might run on any of them.
+    shm_info->shm_location     = alloc_pages_interleave(GFP_KERNEL, order);
     // Check if memory allocation for shm_location failed.
     if (!shm_info->shm_location) {
         pr_err("Failed to allocate shared memory pages.\n");
@@ -39,6 +39,7 @@
 #include "sys/msg.h"
 #include "sys/sem.h"
 #include "sys/shm.h"
+#include "sys/sysctl.h"
 #include "system/syscall.h"
 #include "version.h"
 
@@ -123,6 +124,10 @@ int kmain(boot_info_t *boot_informations)
     initial_esp = boot_info.stack_base;
     // Dump the multiboot structure.
     dump_multiboot(boot_info.multiboot_header);
+    // Apply the options of the command line, before they are needed.
+    if (bitmask_check(boot_info.multiboot_header->flags, MULTIBOOT_FLAG_CMDLINE)) {
+        cmdline_parse((const char *)boot_info.multiboot_header->cmdline);
+    }
 
     //==========================================================================
     pr_notice("Initialize resource registry...\n");
@@ -316,6 +321,16 @@ int kmain(boot_info_t *boot_informations)
     }
     print_ok();
 
+    //==========================================================================
+    pr_notice("Initialize sysctl procfs files...\n");
+    printf("Initialize sysctl procfs files...");
+    if (procsysctl_module_init()) {
+        print_fail();
+        pr_emerg("Failed to initialize `/proc/sys`!\n");
+        return 1;
+    }
+    print_ok();
+
     //==========================================================================
     pr_notice("Initialize IPC/SEM system...\n");
     printf("Initialize IPC/SEM system...");
@@ -421,10 +436,7 @@ int kmain(boot_info_t *boot_informations)
     print_ok();
 
     //==========================================================================
-    // TODO: fix the hardcoded check for the flags set by GRUB
-    runtests = boot_info.multiboot_header->flags == 0x1a67 &&
-               bitmask_check(boot_info.multiboot_header->flags, MULTIBOOT_FLAG_CMDLINE) &&
-               strcmp((char *)boot_info.multiboot_header->cmdline, "runtests") == 0;
+    runtests = cmdline_has_option("runtests");
 
     if (runtests) {
         pr_notice("Creating runtests process...\n");
@@ -0,0 +1,61 @@
+/// @file static_key.c
+/// @brief Static keys, branches patched in the code at runtime.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include "klib/static_key.h"
+
+#include "klib/irqflags.h"
+#include "string.h"
+
+/// The size of the patched instruction.
+#define JUMP_LABEL_SIZE 5
+/// The opcode of a near jump, with a 32-bit relative displacement.
+#define JUMP_LABEL_JMP  0xE9
+
+/// The 5-byte NOP emitted by `static_key_false`.
+static const uint8_t jump_label_nop[JUMP_LABEL_SIZE] = {0x0f, 0x1f, 0x44, 0x00, 0x00};
+
+/// Start of the `__jump_table` section, defined in kernel.lds.
+extern jump_entry_t __start___jump_table[];
+/// End of the `__jump_table` section, defined in kernel.lds.
+extern jump_entry_t __stop___jump_table[];
+
+/// @brief Patches all the branches on the given key.
+/// @param key the key.
+/// @param enable whether the branches must jump or not.
+static void __static_key_update(static_key_t *key, bool_t enable)
+{
+    uint8_t code[JUMP_LABEL_SIZE];
+    // Nothing can run the code while we are patching it.
+    uint8_t flags = irq_disable();
+    key->enabled  = enable;
+    for (jump_entry_t *entry = __start___jump_table; entry < __stop___jump_table; ++entry) {
+        if (entry->key != key) {
+            continue;
+        }
+        if (enable) {
+            int32_t displacement = (int32_t)(entry->target - (entry->code + JUMP_LABEL_SIZE));
+            code[0]              = JUMP_LABEL_JMP;
+            memcpy(&code[1], &displacement, sizeof(displacement));
+        } else {
+            memcpy(code, jump_label_nop, JUMP_LABEL_SIZE);
+        }
+        memcpy((void *)entry->code, code, JUMP_LABEL_SIZE);
+    }
+    irq_enable(flags);
+}
+
+void static_key_enable(static_key_t *key)
+{
+    if (!key->enabled) {
+        __static_key_update(key, true);
+    }
+}
+
+void static_key_disable(static_key_t *key)
+{
+    if (key->enabled) {
+        __static_key_update(key, false);
+    }
+}
@@ -4,7 +4,6 @@
 /// See LICENSE.md for details.
 
 #include "time.h"
-#include "drivers/rtc.h"
 #include "hardware/timer.h"
 #include "io/debug.h"
 #include "io/port_io.h"
@@ -20,28 +19,12 @@ static const char *str_months[] = {"January", "February", "March",     "April",
 
 time_t sys_time(time_t *time)
 {
-    tm_t curr_time;
-    gettime(&curr_time);
-    // January and February are counted as months 13 and 14 of the previous year.
-    if (curr_time.tm_mon <= 2) {
-        curr_time.tm_mon += 12;
-        curr_time.tm_year -= 1;
-    }
-    time_t t;
-    // Convert years to days
-    t = (365 * curr_time.tm_year) + (curr_time.tm_year / 4) - (curr_time.tm_year / 100) + (curr_time.tm_year / 400);
-    // Convert months to days
-    t += (30 * curr_time.tm_mon) + (3 * (curr_time.tm_mon + 1) / 5) + curr_time.tm_mday;
-    // Unix time starts on January 1st, 1970
-    t -= 719561;
-    // Convert days to seconds
-    t *= 86400;
-    // Add hours, minutes and seconds
-    t += (3600 * curr_time.tm_hour) + (60 * curr_time.tm_min) + curr_time.tm_sec;
+    timespec_t now;
+    timer_get_realtime(&now);
     if (time) {
-        (*time) = t;
+        (*time) = now.tv_sec;
     }
-    return t;
+    return now.tv_sec;
 }
 
 time_t difftime(time_t time1, time_t time2) { return time1 - time2; }
@@ -6,7 +6,6 @@
 #include "ctype.h"
 #include "fcvt.h"
 #include "io/video.h"
-#include "math.h"
 #include "stdarg.h"
 #include "stdbool.h"
 #include "stdint.h"
@@ -14,9 +13,6 @@
 #include "string.h"
 #include "sys/bitops.h"
 
-/// Size of the buffer used to call cvt functions.
-#define CVTBUFSIZE 500
-
 #define FLAGS_ZEROPAD   (1U << 0U) ///< Fill zeros before the number.
 #define FLAGS_LEFT      (1U << 1U) ///< Left align the value.
 #define FLAGS_PLUS      (1U << 2U) ///< Print the plus sign.
@@ -31,6 +27,11 @@ static char *_digits = "0123456789abcdefghijklmnopqrstuvwxyz";
 /// The list of uppercase digits.
 static char *_upper_digits = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
 
+/// The pairs of decimal digits, from "00" to "99".
+static const char _digit_pairs[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                                   "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                                   "8081828384858687888990919293949596979899";
+
 /// @brief Returns the index of the first non-integer character.
 /// @param s the string.
 /// @return the index of the first non-integer character.
@@ -43,130 +44,208 @@ static inline int skip_atoi(const char **s)
     return i;
 }
 
+/// @brief Writes a character, if there is room for it.
+/// @param str the output string.
+/// @param end the end of the buffer, NULL if unbounded.
+/// @param c the character.
+/// @return the position after the character.
+static inline char *put_char(char *str, char *end, char c)
+{
+    if (end == NULL || str < end) {
+        *str++ = c;
+    }
+    return str;
+}
+
+/// @brief Writes a character repeatedly, if there is room for it.
+/// @param str the output string.
+/// @param end the end of the buffer, NULL if unbounded.
+/// @param c the character.
+/// @param count how many times it is written.
+/// @return the position after the characters.
+static inline char *put_repeat(char *str, char *end, char c, int count)
+{
+    while (count-- > 0 && (end == NULL || str < end)) {
+        *str++ = c;
+    }
+    return str;
+}
+
+/// @brief Counts the digits of a number.
+/// @param num the number.
+/// @param base the base, between 2 and 36.
+/// @param shift the logarithm of the base, if it is a power of two, 0 otherwise.
+/// @return the number of digits, at least one.
+static inline int count_digits(unsigned long num, unsigned base, unsigned shift)
+{
+    int len = 1;
+    if (base == 10) {
+        // Divisions by a constant are turned into multiplications.
+        for (; num >= 100U; num /= 100U) {
+            len += 2;
+        }
+        return len + (num >= 10U);
+    }
+    if (shift) {
+        for (num >>= shift; num; num >>= shift) {
+            ++len;
+        }
+        return len;
+    }
+    for (num /= base; num; num /= base) {
+        ++len;
+    }
+    return len;
+}
+
+/// @brief Writes the digits of a number from the last one, dropping those
+/// which do not fit the buffer.
+/// @param str where the first digit goes.
+/// @param end the end of the buffer, NULL if unbounded.
+/// @param num the number.
+/// @param len the number of digits.
+/// @param base the base, between 2 and 36.
+/// @param shift the logarithm of the base, if it is a power of two, 0 otherwise.
+/// @param dig the list of digits.
+static inline void put_digits(
+    char *str, char *end, unsigned long num, int len, unsigned base, unsigned shift, const char *dig)
+{
+    char *ptr = str + len;
+    if (base == 10) {
+        // Two digits per division.
+        while (num >= 100U) {
+            const char *pair = &_digit_pairs[(num % 100U) * 2U];
+            num /= 100U;
+            ptr -= 2;
+            if (end == NULL || ptr + 1 < end) {
+                ptr[1] = pair[1];
+            }
+            if (end == NULL || ptr < end) {
+                ptr[0] = pair[0];
+            }
+        }
+        if (num >= 10U) {
+            const char *pair = &_digit_pairs[num * 2U];
+            ptr -= 2;
+            if (end == NULL || ptr + 1 < end) {
+                ptr[1] = pair[1];
+            }
+            if (end == NULL || ptr < end) {
+                ptr[0] = pair[0];
+            }
+        } else if (end == NULL || ptr - 1 < end) {
+            ptr[-1] = dig[num];
+        }
+        return;
+    }
+    while (ptr > str) {
+        --ptr;
+        if (shift) {
+            if (end == NULL || ptr < end) {
+                *ptr = dig[num & (base - 1U)];
+            }
+            num >>= shift;
+        } else {
+            if (end == NULL || ptr < end) {
+                *ptr = dig[num % base];
+            }
+            num /= base;
+        }
+    }
+}
+
 /// @brief Transforms the number into a string.
 /// @param str the output string.
 /// @param end the end of the buffer to prevent overflow.
 /// @param num the number to transform to string.
 /// @param base the base to use for number transformation (e.g., 10 for decimal, 16 for hex).
 /// @param size the minimum size of the output string (pads with '0' or spaces if necessary).
-/// @param precision the precision for number conversion (affects floating point numbers and zero padding).
+/// @param precision the minimum number of digits, -1 if not given.
 /// @param flags control flags (e.g., for padding, sign, and case sensitivity).
 /// @return the resulting string after number transformation.
-static char *number(char *str, char *end, long num, int base, int size, int32_t precision, unsigned flags)
+static char *number(char *str, char *end, unsigned long num, int base, int size, int32_t precision, unsigned flags)
 {
-    char tmp[66] = {0};     // Temporary buffer to hold the number in reverse order
-    char *dig    = _digits; // Default digits for base conversion (lowercase)
-
-    // Check for uppercase conversion flag.
-    if (bitmask_check(flags, FLAGS_UPPERCASE)) {
-        dig = _upper_digits; // Use uppercase digits if the flag is set
-    }
-
-    // Disable zero padding if left alignment is specified.
-    if (bitmask_check(flags, FLAGS_LEFT)) {
-        bitmask_clear_assign(flags, FLAGS_ZEROPAD);
-    }
+    const char *dig = bitmask_check(flags, FLAGS_UPPERCASE) ? _upper_digits : _digits;
+    char sign       = 0;
+    unsigned shift  = 0;
+    int len;
 
     // Error handling: base must be between 2 and 36.
     if (base < 2 || base > 36) {
-        return 0; // Return NULL if the base is invalid.
+        return str;
     }
 
-    // Set padding character based on the FLAGS_ZEROPAD flag (either '0' or ' ').
-    const int paddingc = bitmask_check(flags, FLAGS_ZEROPAD) ? '0' : ' ';
+    // Left alignment, and an explicit precision, disable the zero padding.
+    if (bitmask_check(flags, FLAGS_LEFT) || (precision >= 0)) {
+        bitmask_clear_assign(flags, FLAGS_ZEROPAD);
+    }
 
     // Set the sign (for signed numbers).
-    char sign = 0;
     if (bitmask_check(flags, FLAGS_SIGN)) {
-        if (num < 0) {
-            sign = '-';  // Negative sign for negative numbers
-            num  = -num; // Make number positive
-            size--;      // Reduce size for the sign
+        if ((long)num < 0) {
+            sign = '-';
+            num  = -num;
         } else if (bitmask_check(flags, FLAGS_PLUS)) {
-            sign = '+'; // Positive sign for positive numbers
-            size--;
+            sign = '+';
         } else if (bitmask_check(flags, FLAGS_SPACE)) {
-            sign = ' '; // Space for positive numbers
-            size--;
+            sign = ' ';
         }
     }
 
-    // Convert the number to unsigned for further processing.
-    uint32_t uns_num = (uint32_t)num;
+    // The digits of the powers of two are extracted with shifts.
+    if ((base & (base - 1)) == 0) {
+        shift = (unsigned)find_first_non_zero((unsigned long)base);
+    }
 
-    // Handle the FLAGS_HASH for octal (base 8) and hexadecimal (base 16).
+    // A zero with a precision of zero has no digits at all.
+    len = ((num == 0) && (precision == 0)) ? 0 : count_digits(num, (unsigned)base, shift);
+
+    // The octal prefix is a leading zero, the hexadecimal one is not used for zero.
     if (bitmask_check(flags, FLAGS_HASH)) {
-        if (base == 16) {
-            size -= 2; // Hexadecimal prefix "0x" or "0X" uses 2 characters.
-        } else if (base == 8) {
-            size--; // Octal prefix "0" uses 1 character.
+        if (base == 8) {
+            if ((precision <= len) && (num || !len)) {
+                precision = len + 1;
+            }
+        } else if ((base != 16) || (num == 0)) {
+            bitmask_clear_assign(flags, FLAGS_HASH);
         }
     }
-
-    // Convert the number to the target base.
-    int32_t i = 0;
-    if (uns_num == 0) {
-        tmp[i++] = '0'; // Handle zero case explicitly.
-    } else {
-        while (uns_num != 0) {
-            tmp[i++] = dig[((unsigned long)uns_num) % (unsigned)base]; // Convert to base
-            uns_num  = ((unsigned long)uns_num) / (unsigned)base;      // Divide by base
-        }
+    if (precision < len) {
+        precision = len;
     }
 
-    // Ensure precision is at least as large as the number's length.
-    if (i > precision) {
-        precision = i;
+    // Compute the padding, without the sign and the prefix.
+    size -= precision + (sign != 0);
+    if (bitmask_check(flags, FLAGS_HASH) && (base == 16)) {
+        size -= 2;
     }
 
-    // Adjust the size based on the precision.
-    size -= precision;
-
-    // Write padding spaces if right-aligned and no zero padding.
     if (!bitmask_check(flags, FLAGS_ZEROPAD | FLAGS_LEFT)) {
-        while (size-- > 0 && (end == NULL || str < end)) {
-            *str++ = ' ';
-        }
+        str = put_repeat(str, end, ' ', size);
     }
-
-    // Write the sign character if necessary.
-    if (sign && (end == NULL || str < end)) {
-        *str++ = sign;
+    if (sign) {
+        str = put_char(str, end, sign);
     }
-
-    // Write the prefix for octal and hexadecimal if the FLAGS_HASH is set.
-    if (bitmask_check(flags, FLAGS_HASH)) {
-        if (base == 8 && (end == NULL || str < end)) {
-            *str++ = '0'; // Octal prefix.
-        } else if (base == 16 && (str + 1) < end) {
-            *str++ = '0';         // Hexadecimal prefix "0x".
-            *str++ = _digits[33]; // 'x' or 'X' based on FLAGS_UPPERCASE.
-        }
+    if (bitmask_check(flags, FLAGS_HASH) && (base == 16)) {
+        str = put_char(str, end, '0');
+        str = put_char(str, end, dig[33]); // 'x' or 'X' based on FLAGS_UPPERCASE.
     }
-
-    // Write zero-padding if necessary.
-    if (!bitmask_check(flags, FLAGS_LEFT)) {
-        while (size-- > 0 && (end == NULL || str < end)) {
-            *str++ = paddingc; // Pad with '0' or ' '.
-        }
-    }
-
-    // Write any additional zeros required by the precision.
-    while (i < precision-- && (end == NULL || str < end)) {
-        *str++ = '0';
+    if (bitmask_check(flags, FLAGS_ZEROPAD)) {
+        str = put_repeat(str, end, '0', size);
     }
+    str = put_repeat(str, end, '0', precision - len);
 
-    // Write the number in reverse order (tmp array holds the reversed digits).
-    while (i-- > 0 && (end == NULL || str < end)) {
-        *str++ = tmp[i];
+    // Write the digits in place, from the last one.
+    if (len > 0) {
+        put_digits(str, end, num, len, (unsigned)base, shift, dig);
     }
+    str = (end != NULL && (end - str) < len) ? end : str + len;
 
     // If the number is left-aligned, pad remaining space with spaces.
-    while (size-- > 0 && (end == NULL || str < end)) {
-        *str++ = ' ';
+    if (bitmask_check(flags, FLAGS_LEFT)) {
+        str = put_repeat(str, end, ' ', size);
     }
-
-    return str; // Return the resulting string pointer.
+    return str;
 }
 
 /// @brief Converts a MAC address into a human-readable string format.
@@ -299,261 +378,11 @@ static char *iaddr(char *str, char *end, unsigned char *addr, int size, int prec
     return str; // Return the pointer to the end of the output string.
 }
 
-/// @brief Converts a floating-point number to a string with a specified format.
-/// @param value The floating-point value to be converted.
-/// @param buffer The output buffer to store the resulting string.
-/// @param bufsize The size of the output buffer.
-/// @param format The format specifier ('e', 'f', or 'g').
-/// @param precision The number of digits to be displayed after the decimal
-/// point.
-static void cfltcvt(double value, char *buffer, size_t bufsize, char format, int precision)
-{
-    int decpt, sign, exp, pos;
-    char cvtbuf[CVTBUFSIZE]; // Temporary buffer to store the digits.
-    char *digits = cvtbuf;   // Pointer to the digit buffer.
-    int capexp   = 0;        // Flag to check for uppercase exponent.
-    int magnitude;
-
-    char *end = buffer + bufsize - 1; // Pointer to the end of the buffer.
-
-    // Handle uppercase 'G' or 'E' format specifier.
-    // Convert them to lowercase 'g' or 'e' for uniform processing.
-    if (format == 'G' || format == 'E') {
-        capexp = 1;       // Set capexp to handle uppercase exponent.
-        format += 'a' - 'A'; // Convert to lowercase.
-    }
-
-    // Handle 'g' format: choose between 'e' or 'f' based on magnitude.
-    if (format == 'g') {
-        ecvtbuf(value, precision, &decpt, &sign, cvtbuf, CVTBUFSIZE);
-        magnitude = decpt - 1; // Calculate magnitude of the number.
-
-        // If magnitude is out of range for 'f', use scientific notation 'e'.
-        if (magnitude < -4 || magnitude > precision - 1) {
-            format = 'e';
-            precision -= 1; // Adjust precision for 'e' format.
-        } else {
-            format = 'f';
-            precision -= decpt; // Adjust precision for 'f' format.
-        }
-    }
-
-    // Handle scientific notation ('e' format).
-    if (format == 'e') {
-        // Convert the number to scientific format.
-        ecvtbuf(value, precision + 1, &decpt, &sign, cvtbuf, CVTBUFSIZE);
-
-        // Add the sign to the output buffer if necessary.
-        if (sign && buffer < end) {
-            *buffer++ = '-';
-        }
-
-        // Add the first digit.
-        if (buffer < end) {
-            *buffer++ = *digits;
-        }
-
-        // Add the decimal point and remaining digits.
-        if (precision > 0 && buffer < end) {
-            *buffer++ = '.';
-        }
-
-        // Copy the remaining digits.
-        for (int i = 1; i <= precision && buffer < end; i++) {
-            *buffer++ = digits[i];
-        }
-
-        // Add the exponent character ('e' or 'E').
-        if (buffer < end) {
-            *buffer++ = capexp ? 'E' : 'e';
-        }
-
-        // Calculate the exponent.
-        if (decpt == 0) {
-            exp = (value == 0.0) ? 0 : -1;
-        } else {
-            exp = decpt - 1;
-        }
-
-        // Add the sign of the exponent.
-        if (exp < 0 && buffer < end) {
-            *buffer++ = '-';
-            exp       = -exp;
-        } else if (buffer < end) {
-            *buffer++ = '+';
-        }
-
-        // Add the exponent digits (e.g., '01', '02').
-        for (int i = 2; i >= 0 && buffer < end; i--) {
-            buffer[i] = (char)((exp % 10) + '0');
-            exp /= 10;
-        }
-        buffer += 3;
-    }
-    // Handle fixed-point notation ('f' format).
-    else if (format == 'f') {
-        // Convert the number to fixed-point format.
-        fcvtbuf(value, precision, &decpt, &sign, cvtbuf, CVTBUFSIZE);
-
-        // Add the sign to the output buffer if necessary.
-        if (sign && buffer < end) {
-            *buffer++ = '-';
-        }
-
-        // If digits exist, process them.
-        if (*digits) {
-            // Handle the case where the decimal point is before the first
-            // digit.
-            if (decpt <= 0) {
-                if (buffer < end) {
-                    *buffer++ = '0';
-                }
-                if (buffer < end) {
-                    *buffer++ = '.';
-                }
-
-                // Add leading zeros before the first significant digit.
-                for (pos = 0; pos < -decpt && buffer < end; pos++) {
-                    *buffer++ = '0';
-                }
-
-                // Copy the digits.
-                while (*digits && buffer < end) {
-                    *buffer++ = *digits++;
-                }
-            }
-            // Handle normal case where decimal point is after some digits.
-            else {
-                pos = 0;
-                while (*digits && buffer < end) {
-                    if (pos++ == decpt && buffer < end) {
-                        *buffer++ = '.';
-                    }
-                    if (buffer < end) {
-                        *buffer++ = *digits++;
-                    }
-                }
-            }
-        }
-        // Handle case where the value is zero.
-        else {
-            if (buffer < end) {
-                *buffer++ = '0';
-            }
-            if (precision > 0 && buffer < end) {
-                *buffer++ = '.';
-                for (pos = 0; pos < precision && buffer < end; pos++) {
-                    *buffer++ = '0';
-                }
-            }
-        }
-    }
-
-    if (buffer < end) {
-        *buffer = '\0'; // Null-terminate the string.
-    } else {
-        *end = '\0'; // Ensure null-termination if buffer exceeded.
-    }
-}
-
-/// @brief Ensures that a decimal point is present in the given number string.
-/// @param buffer The string representation of a number.
-/// @param bufsize The size of the output buffer.
-static void forcdecpt(char *buffer, size_t bufsize)
-{
-    // Traverse the buffer to check if there is already a decimal point or an
-    // exponent ('e' or 'E').
-    char *end = buffer + bufsize - 1; // Pointer to the end of the buffer.
-    while (*buffer && buffer < end) {
-        if (*buffer == '.') {
-            return; // Decimal point found, no need to modify.
-        }
-        if (*buffer == 'e' || *buffer == 'E') {
-            break; // Reached exponent part of the number, stop checking.
-        }
-        buffer++; // Move to the next character.
-    }
-
-    // If an exponent ('e' or 'E') is found, shift the exponent part to make
-    // space for the decimal point.
-    if (*buffer && buffer < end) {
-        // Get the length of the exponent part.
-        long n = (long)strlen(buffer);
-
-        // Check if there is enough space to shift and add the decimal point.
-        if (buffer + n + 1 < end) {
-            // Shift the buffer contents one position to the right to make space for
-            // the decimal point.
-            while (n >= 0) {
-                buffer[n + 1] = buffer[n];
-                n--;
-            }
-
-            // Insert the decimal point.
-            *buffer = '.';
-        }
-    }
-    // If no exponent is found, append the decimal point at the end of the string.
-    else if (buffer < end) {
-        *buffer++ = '.';  // Add decimal point at the current end.
-        *buffer   = '\0'; // Null-terminate the string.
-    }
-}
-
-/// @brief Removes trailing zeros after the decimal point in a number string.
-/// @param buffer The string representation of a number.
-/// @param bufsize The size of the output buffer.
-static void cropzeros(char *buffer, size_t bufsize)
-{
-    char *stop;
-    char *end = buffer + bufsize - 1; // Pointer to the end of the buffer.
-
-    // Traverse until a decimal point is found or the end of the string is
-    // reached.
-    while (*buffer && *buffer != '.' && buffer < end) {
-        buffer++;
-    }
-
-    // If there is a decimal point, find the position of the exponent or the end
-    // of the number.
-    if (*buffer++ && buffer < end) { // Move past the decimal point.
-        // Continue until 'e', 'E', or end of string is found.
-        while (*buffer && *buffer != 'e' && *buffer != 'E' && buffer < end) {
-            buffer++;
-        }
-
-        // Store position of 'e', 'E', or end of the string, and backtrack one
-        // step.
-        stop = buffer--;
-
-        // Backtrack over trailing zeros.
-        while (*buffer == '0' && buffer > (buffer - bufsize)) {
-            buffer--;
-        }
-
-        // If a decimal point is found with no significant digits after,
-        // backtrack to remove it.
-        if (*buffer == '.') {
-            buffer--;
-        }
-
-        // Shift the string forward to overwrite any unnecessary characters
-        // (trailing zeros or decimal point).
-        while (buffer < end && (*++buffer = *stop++)) {
-        }
-
-        // Ensure null-termination if buffer exceeded.
-        if (buffer >= end) {
-            *end = '\0';
-        }
-    }
-}
-
 /// @brief Formats a floating-point number into a string with specified options.
 ///
-/// @details This function converts a floating-point number into a string
-/// representation based on the specified format, precision, and flags. It
-/// handles alignment, padding, and sign appropriately.
+/// @details The digits are produced exactly, and correctly rounded, by the
+/// cvt functions, and written straight to the output: only the length of the
+/// result is computed in advance, to pad it.
 ///
 /// @param str Pointer to the output string where the formatted number will be stored.
 /// @param end Pointer to the end of the buffer to prevent overflow.
@@ -566,102 +395,161 @@ static void cropzeros(char *buffer, size_t bufsize)
 /// @return Pointer to the next position in the output string after the formatted number.
 static char *flt(char *str, char *end, double num, int size, int precision, char format, unsigned flags)
 {
-    char workbuf[80];
-    char c, sign;
-    int n, i;
-
-    /// If the `FLAGS_LEFT` is set, clear the `FLAGS_ZEROPAD` flag.
-    /// Left alignment implies no zero padding.
+    union {
+        double d;
+        uint64_t u;
+    } bits        = { num };
+    int upper     = (format == 'E') || (format == 'F') || (format == 'G');
+    char style    = (char)(format | 0x20);
+    char sign     = 0;
+    int exp_len   = 0;
+    int exponent  = 0;
+    int point, len, zeros;
+    cvt_t cvt;
+
+    // Left alignment implies no zero padding.
     if (bitmask_check(flags, FLAGS_LEFT)) {
         bitmask_clear_assign(flags, FLAGS_ZEROPAD);
     }
 
-    /// Determine the padding character (`c`) and the sign of the number.
-    /// If `FLAGS_ZEROPAD` is set, the padding will be '0', otherwise it will be
-    /// a space (' ').
-    c    = bitmask_check(flags, FLAGS_ZEROPAD) ? '0' : ' ';
-    sign = 0;
+    // Take the sign from its bit, so that -0.0 is printed as such.
+    if (bits.u >> 63U) {
+        sign = '-';
+        bits.u &= ~(1ULL << 63U);
+    } else if (bitmask_check(flags, FLAGS_PLUS)) {
+        sign = '+';
+    } else if (bitmask_check(flags, FLAGS_SPACE)) {
+        sign = ' ';
+    }
 
-    /// Check the `FLAGS_SIGN` flag to determine if the sign should be added.
-    if (bitmask_check(flags, FLAGS_SIGN)) {
-        if (num < 0.0) {
-            /// If the number is negative, set `sign` to '-' and make the number
-            /// positive.
-            sign = '-';
-            num  = -num;
-            size--; // Reduce size for the sign character.
-        } else if (bitmask_check(flags, FLAGS_PLUS)) {
-            /// If `FLAGS_PLUS` is set, prepend a '+' to positive numbers.
-            sign = '+';
-            size--;
-        } else if (bitmask_check(flags, FLAGS_SPACE)) {
-            /// If `FLAGS_SPACE` is set, prepend a space to positive numbers.
-            sign = ' ';
-            size--;
+    // Infinity and NaN, padded with spaces.
+    if (((bits.u >> 52U) & 0x7ffU) == 0x7ffU) {
+        const char *text = (bits.u & ((1ULL << 52U) - 1U)) ? (upper ? "NAN" : "nan") : (upper ? "INF" : "inf");
+        size -= 3 + (sign != 0);
+        if (!bitmask_check(flags, FLAGS_LEFT)) {
+            str = put_repeat(str, end, ' ', size);
+        }
+        if (sign) {
+            str = put_char(str, end, sign);
+        }
+        for (int i = 0; i < 3; ++i) {
+            str = put_char(str, end, text[i]);
         }
+        if (bitmask_check(flags, FLAGS_LEFT)) {
+            str = put_repeat(str, end, ' ', size);
+        }
+        return str;
     }
 
-    /// Set the default precision if no precision is provided.
+    // Set the default precision if no precision is provided.
     if (precision < 0) {
-        precision = 6; // Default precision is 6 decimal places.
-    } else if (precision == 0 && format == 'g') {
-        precision = 1; // For format 'g', default precision is 1.
+        precision = 6;
     }
 
-    /// Convert the floating-point number `num` into a string `workbuf` using the
-    /// given format `format`.
-    cfltcvt(num, workbuf, sizeof(workbuf), format, precision);
-
-    /// If the `FLAGS_HASH` is set and precision is 0, force a decimal point in
-    /// the output.
-    if (bitmask_check(flags, FLAGS_HASH) && (precision == 0)) {
-        forcdecpt(workbuf, sizeof(workbuf));
+    if (style == 'g') {
+        // The style depends on the exponent after the rounding to the precision.
+        if (precision == 0) {
+            precision = 1;
+        }
+        cvt_init(&cvt, bits.d, precision, 0);
+        exponent = cvt.decpt - 1;
+        if ((exponent < precision) && (exponent >= -4)) {
+            // The same digits, with the decimal point in the middle.
+            style     = 'f';
+            precision = precision - 1 - exponent;
+            if (!bitmask_check(flags, FLAGS_HASH) && (precision > cvt.nonzero - cvt.decpt)) {
+                precision = (cvt.nonzero > cvt.decpt) ? cvt.nonzero - cvt.decpt : 0;
+            }
+        } else {
+            style     = 'e';
+            precision = precision - 1;
+            if (!bitmask_check(flags, FLAGS_HASH) && (precision > cvt.nonzero - 1)) {
+                precision = (cvt.nonzero > 1) ? cvt.nonzero - 1 : 0;
+            }
+        }
+    } else if (style == 'e') {
+        cvt_init(&cvt, bits.d, precision + 1, 0);
+    } else {
+        cvt_init(&cvt, bits.d, precision, 1);
     }
 
-    /// For format 'g', remove trailing zeros unless `FLAGS_HASH` is set.
-    if ((format == 'g') && !bitmask_check(flags, FLAGS_HASH)) {
-        cropzeros(workbuf, sizeof(workbuf));
+    // Compute the length of the number, to pad it.
+    point = (precision > 0) || bitmask_check(flags, FLAGS_HASH);
+    if (style == 'e') {
+        exponent = cvt.decpt - 1;
+        // The exponent has at least two digits, and at most three.
+        exp_len = ((exponent >= 100) || (exponent <= -100)) ? 3 : 2;
+        len = 1 + point + precision + 2 + exp_len;
+    } else {
+        len = ((cvt.decpt > 0) ? cvt.decpt : 1) + point + precision;
     }
+    size -= len + (sign != 0);
 
-    /// Calculate the length of the resulting string `workbuf`.
-    n = strnlen(workbuf, 80);
-
-    /// Adjust size to account for the length of the output string.
-    size -= n;
-
-    /// Add padding spaces before the number if neither `FLAGS_ZEROPAD` nor `FLAGS_LEFT` are set.
     if (!bitmask_check(flags, FLAGS_ZEROPAD | FLAGS_LEFT)) {
-        while (size-- > 0 && (end == NULL || str < end)) {
-            *str++ = ' ';
-        }
+        str = put_repeat(str, end, ' ', size);
     }
-
-    /// Add the sign character (if any) before the number.
-    if (sign && (end == NULL || str < end)) {
-        *str++ = sign;
+    if (sign) {
+        str = put_char(str, end, sign);
     }
-
-    /// Add padding characters (either '0' or spaces) before the number if `FLAGS_ZEROPAD` is set.
-    if (!bitmask_check(flags, FLAGS_LEFT)) {
-        while (size-- > 0 && (end == NULL || str < end)) {
-            *str++ = c;
-        }
+    if (bitmask_check(flags, FLAGS_ZEROPAD)) {
+        str = put_repeat(str, end, '0', size);
     }
 
-    /// Copy the formatted number string to the output `str`.
-    for (i = 0; i < n && (end == NULL || str < end); i++) {
-        *str++ = workbuf[i];
+    if (style == 'e') {
+        str = put_char(str, end, cvt_digit(&cvt));
+        if (point) {
+            str = put_char(str, end, '.');
+        }
+        for (int i = 0; i < precision && (end == NULL || str < end); ++i) {
+            *str++ = cvt_digit(&cvt);
+        }
+        str = put_char(str, end, upper ? 'E' : 'e');
+        str = put_char(str, end, (exponent < 0) ? '-' : '+');
+        if (exponent < 0) {
+            exponent = -exponent;
+        }
+        if (exp_len > 2) {
+            str = put_char(str, end, (char)('0' + exponent / 100));
+        }
+        str = put_char(str, end, (char)('0' + (exponent / 10) % 10));
+        str = put_char(str, end, (char)('0' + exponent % 10));
+    } else {
+        // The integer part, then the zeros between the point and the first digit.
+        if (cvt.decpt > 0) {
+            for (int i = 0; i < cvt.decpt && (end == NULL || str < end); ++i) {
+                *str++ = cvt_digit(&cvt);
+            }
+        } else {
+            str = put_char(str, end, '0');
+        }
+        if (point) {
+            str = put_char(str, end, '.');
+        }
+        zeros = (cvt.decpt < 0) ? -cvt.decpt : 0;
+        if (zeros > precision) {
+            zeros = precision;
+        }
+        str = put_repeat(str, end, '0', zeros);
+        for (int i = zeros; i < precision && (end == NULL || str < end); ++i) {
+            *str++ = cvt_digit(&cvt);
+        }
     }
 
-    /// Add padding spaces after the number if `FLAGS_LEFT` is set (left-aligned output).
-    while (size-- > 0 && (end == NULL || str < end)) {
-        *str++ = ' ';
+    // Add padding spaces after the number if `FLAGS_LEFT` is set (left-aligned output).
+    if (bitmask_check(flags, FLAGS_LEFT)) {
+        str = put_repeat(str, end, ' ', size);
     }
-
-    return str; /// Return the resulting string after formatting the number.
+    return str;
 }
 
-int vsprintf(char *str, const char *format, va_list args)
+/// @brief Formats the arguments, as described by the format string.
+/// @param str the output string.
+/// @param end the end of the buffer, NULL if unbounded; the characters past
+/// it are dropped, and no temporary buffer is ever used.
+/// @param format the format string.
+/// @param args the arguments.
+/// @return the position after the last character written.
+static char *vformat(char *str, char *end, const char *format, va_list args)
 {
     int base;       // Base for number formatting.
     char *tmp;      // Pointer to current position in the output buffer.
@@ -669,12 +557,7 @@ int vsprintf(char *str, const char *format, va_list args)
     unsigned flags; // Flags for number formatting.
     char qualifier; // Character qualifier for integer fields ('h', 'l', or 'L').
 
-    // Check for null input buffer or format string.
-    if (str == NULL || format == NULL) {
-        return -1; // Error: null pointer provided.
-    }
-
-    for (tmp = str; *format; format++) {
+    for (tmp = str; *format && (end == NULL || tmp < end); format++) {
         if (*format != '%') {
             *tmp++ = *format; // Directly copy non-format characters.
             continue;
@@ -736,10 +619,10 @@ int vsprintf(char *str, const char *format, va_list args)
             }
         }
 
-        // Get the conversion qualifier.
+        // Get the conversion qualifier, size_t has the size of a long.
         qualifier = -1;
-        if (*format == 'h' || *format == 'l' || *format == 'L') {
-            qualifier = *format;
+        if (*format == 'h' || *format == 'l' || *format == 'L' || *format == 'z') {
+            qualifier = (*format == 'z') ? 'l' : *format;
             format++;
         }
 
@@ -750,15 +633,13 @@ int vsprintf(char *str, const char *format, va_list args)
         case 'c':
             // Handle left padding.
             if (!bitmask_check(flags, FLAGS_LEFT)) {
-                while (--field_width > 0) {
-                    *tmp++ = ' ';
-                }
+                tmp = put_repeat(tmp, end, ' ', field_width - 1);
             }
             // Add the character.
-            *tmp++ = va_arg(args, char);
+            tmp = put_char(tmp, end, (char)va_arg(args, int));
             // Handle right padding.
-            while (--field_width > 0) {
-                *tmp++ = ' ';
+            if (bitmask_check(flags, FLAGS_LEFT)) {
+                tmp = put_repeat(tmp, end, ' ', field_width - 1);
             }
             continue;
 
@@ -772,29 +653,28 @@ int vsprintf(char *str, const char *format, va_list args)
             int32_t len = (int32_t)strnlen(s, (uint32_t)precision);
             // Handle left padding.
             if (!bitmask_check(flags, FLAGS_LEFT)) {
-                while (len < field_width--) {
-                    *tmp++ = ' ';
-                }
+                tmp = put_repeat(tmp, end, ' ', field_width - len);
             }
             // Add the string.
-            for (int32_t it = 0; it < len; ++it) {
-                *tmp++ = *s++;
+            if (end != NULL && len > end - tmp) {
+                len = (int32_t)(end - tmp);
             }
+            memcpy(tmp, s, (size_t)len);
+            tmp += len;
             // Handle right padding.
-            while (len < field_width--) {
-                *tmp++ = ' ';
+            if (bitmask_check(flags, FLAGS_LEFT)) {
+                tmp = put_repeat(tmp, end, ' ', field_width - len);
             }
             continue;
 
         case 'p':
-
             // Handle pointer formatting.
             if (field_width == -1) {
                 field_width = 2 * sizeof(void *);
                 // Zero pad for pointers.
                 bitmask_set_assign(flags, FLAGS_ZEROPAD);
             }
-            tmp = number(tmp, NULL, (unsigned long)va_arg(args, void *), 16, field_width, precision, flags);
+            tmp = number(tmp, end, (unsigned long)va_arg(args, void *), 16, field_width, precision, flags);
             continue;
 
         case 'n':
@@ -811,14 +691,13 @@ int vsprintf(char *str, const char *format, va_list args)
         case 'A':
             // Handle hexadecimal formatting with uppercase.
             bitmask_set_assign(flags, FLAGS_UPPERCASE);
-            break;
-
+            // Fall through.
         case 'a':
             // Handle address formatting (either Ethernet or IP).
             if (qualifier == 'l') {
-                tmp = eaddr(tmp, NULL, va_arg(args, unsigned char *), field_width, precision, flags);
+                tmp = eaddr(tmp, end, va_arg(args, unsigned char *), field_width, precision, flags);
             } else {
-                tmp = iaddr(tmp, NULL, va_arg(args, unsigned char *), field_width, precision, flags);
+                tmp = iaddr(tmp, end, va_arg(args, unsigned char *), field_width, precision, flags);
             }
             continue;
 
@@ -830,8 +709,7 @@ int vsprintf(char *str, const char *format, va_list args)
         case 'X':
             // Handle hexadecimal formatting with uppercase.
             bitmask_set_assign(flags, FLAGS_UPPERCASE);
-            break;
-
+            // Fall through.
         case 'x':
             // Handle hexadecimal formatting.
             base = 16;
@@ -841,26 +719,27 @@ int vsprintf(char *str, const char *format, va_list args)
         case 'i':
             // Handle signed integer formatting.
             bitmask_set_assign(flags, FLAGS_SIGN);
-
+            // Fall through.
         case 'u':
             // Handle unsigned integer formatting.
             break;
 
         case 'E':
+        case 'F':
         case 'G':
         case 'e':
         case 'f':
         case 'g':
             // Handle floating-point formatting.
-            tmp = flt(tmp, NULL, va_arg(args, double), field_width, precision, *format, bitmask_set(flags, FLAGS_SIGN));
+            tmp = flt(tmp, end, va_arg(args, double), field_width, precision, *format, flags);
             continue;
 
         default:
             if (*format != '%') {
-                *tmp++ = '%'; // Output '%' if not a format specifier.
+                tmp = put_char(tmp, end, '%'); // Output '%' if not a format specifier.
             }
             if (*format) {
-                *tmp++ = *format; // Output the current character.
+                tmp = put_char(tmp, end, *format); // Output the current character.
             } else {
                 --format; // Handle the case of trailing '%'.
             }
@@ -870,256 +749,50 @@ int vsprintf(char *str, const char *format, va_list args)
         // Process the integer value.
         if (bitmask_check(flags, FLAGS_SIGN)) {
             long num = (qualifier == 'l')   ? va_arg(args, long)
-                       : (qualifier == 'h') ? va_arg(args, short)
+                       : (qualifier == 'h') ? (short)va_arg(args, int)
                                             : va_arg(args, int);
             // Add the number.
-            tmp      = number(tmp, NULL, num, base, field_width, precision, flags);
+            tmp      = number(tmp, end, (unsigned long)num, base, field_width, precision, flags);
         } else {
             unsigned long num = (qualifier == 'l')   ? va_arg(args, unsigned long)
-                                : (qualifier == 'h') ? va_arg(args, unsigned short)
+                                : (qualifier == 'h') ? (unsigned short)va_arg(args, unsigned int)
                                                      : va_arg(args, unsigned int);
             // Add the number.
-            tmp               = number(tmp, NULL, num, base, field_width, precision, flags);
+            tmp               = number(tmp, end, num, base, field_width, precision, flags);
         }
     }
+    return tmp;
+}
 
+int vsprintf(char *str, const char *format, va_list args)
+{
+    char *tmp;
+
+    // Check for null input buffer or format string.
+    if (str == NULL || format == NULL) {
+        return -1; // Error: null pointer provided.
+    }
+
+    tmp  = vformat(str, NULL, format, args);
     *tmp = '\0';             // Null-terminate the output string.
     return (int)(tmp - str); // Return the number of characters written.
 }
 
 int vsnprintf(char *str, size_t bufsize, const char *format, va_list args)
 {
-    int base;       // Base for number formatting.
-    char *tmp;      // Pointer to current position in the output buffer.
-    char *s;        // Pointer for string formatting.
-    unsigned flags; // Flags for number formatting.
-    char qualifier; // Character qualifier for integer fields ('h', 'l', or 'L').
+    char *tmp;
 
     // Check for null input buffer or format string.
     if (str == NULL || format == NULL) {
         return -1; // Error: null pointer provided.
     }
-
-    char *end = str + bufsize - 1; // Reserve space for null-terminator.
-
-    for (tmp = str; *format && tmp < end; format++) {
-        if (*format != '%') {
-            if (tmp < end) {
-                *tmp++ = *format; // Directly copy non-format characters.
-            }
-            continue;
-        }
-
-        // Reset flags for each new format specifier.
-        flags = 0;
-
-    repeat:
-
-        // Process format flags (skips first '%').
-        format++;
-
-        switch (*format) {
-        case '-':
-            bitmask_set_assign(flags, FLAGS_LEFT);
-            goto repeat;
-        case '+':
-            bitmask_set_assign(flags, FLAGS_PLUS);
-            goto repeat;
-        case ' ':
-            bitmask_set_assign(flags, FLAGS_SPACE);
-            goto repeat;
-        case '#':
-            bitmask_set_assign(flags, FLAGS_HASH);
-            goto repeat;
-        case '0':
-            bitmask_set_assign(flags, FLAGS_ZEROPAD);
-            goto repeat;
-        }
-
-        // Get the width of the output field.
-        int32_t field_width = -1;
-
-        if (isdigit(*format)) {
-            field_width = skip_atoi(&format);
-        } else if (*format == '*') {
-            format++;
-            field_width = va_arg(args, int32_t);
-            if (field_width < 0) {
-                field_width = -field_width;
-                bitmask_set_assign(flags, FLAGS_LEFT);
-            }
-        }
-
-        // Get the precision, thus the minimum number of digits for integers;
-        // max number of chars for from string.
-        int32_t precision = -1;
-        if (*format == '.') {
-            ++format;
-            if (isdigit(*format)) {
-                precision = skip_atoi(&format);
-            } else if (*format == '*') {
-                ++format;
-                precision = va_arg(args, int);
-            }
-            if (precision < 0) {
-                precision = 0;
-            }
-        }
-
-        // Get the conversion qualifier.
-        qualifier = -1;
-        if (*format == 'h' || *format == 'l' || *format == 'L') {
-            qualifier = *format;
-            format++;
-        }
-
-        // Default base for integer conversion.
-        base = 10;
-
-        switch (*format) {
-        case 'c':
-            // Handle left padding.
-            if (!bitmask_check(flags, FLAGS_LEFT)) {
-                while (--field_width > 0 && tmp < end) {
-                    *tmp++ = ' ';
-                }
-            }
-            // Add the character.
-            if (tmp < end) {
-                *tmp++ = va_arg(args, int);
-            }
-            // Handle right padding.
-            while (--field_width > 0 && tmp < end) {
-                *tmp++ = ' ';
-            }
-            continue;
-
-        case 's':
-            // Handle string formatting.
-            s = va_arg(args, char *);
-            if (!s) {
-                s = "<NULL>";
-            }
-            // Get the length of the string.
-            int32_t len = (int32_t)strnlen(s, (uint32_t)precision);
-            // Handle left padding.
-            if (!bitmask_check(flags, FLAGS_LEFT)) {
-                while (len < field_width-- && tmp < end) {
-                    *tmp++ = ' ';
-                }
-            }
-            // Add the string.
-            for (int32_t it = 0; it < len && tmp < end; ++it) {
-                *tmp++ = *s++;
-            }
-            // Handle right padding.
-            while (len < field_width-- && tmp < end) {
-                *tmp++ = ' ';
-            }
-            continue;
-
-        case 'p':
-            // Handle pointer formatting.
-            if (field_width == -1) {
-                field_width = 2 * sizeof(void *);
-                // Zero pad for pointers.
-                bitmask_set_assign(flags, FLAGS_ZEROPAD);
-            }
-            tmp = number(tmp, end, (unsigned long)va_arg(args, void *), 16, field_width, precision, flags);
-            continue;
-
-        case 'n':
-            // Handle writing the number of characters written.
-            if (qualifier == 'l') {
-                long *ip = va_arg(args, long *);
-                *ip      = (tmp - str);
-            } else {
-                int *ip = va_arg(args, int *);
-                *ip     = (tmp - str);
-            }
-            continue;
-
-        case 'A':
-            // Handle hexadecimal formatting with uppercase.
-            bitmask_set_assign(flags, FLAGS_UPPERCASE);
-            break;
-
-        case 'a':
-            // Handle address formatting (either Ethernet or IP).
-            if (qualifier == 'l') {
-                tmp = eaddr(tmp, end, va_arg(args, unsigned char *), field_width, precision, flags);
-            } else {
-                tmp = iaddr(tmp, end, va_arg(args, unsigned char *), field_width, precision, flags);
-            }
-            continue;
-
-        case 'o':
-            // Integer number formats.
-            base = 8;
-            break;
-
-        case 'X':
-            // Handle hexadecimal formatting with uppercase.
-            bitmask_set_assign(flags, FLAGS_UPPERCASE);
-            // Fall through.
-        case 'x':
-            // Handle hexadecimal formatting.
-            base = 16;
-            break;
-
-        case 'd':
-        case 'i':
-            // Handle signed integer formatting.
-            bitmask_set_assign(flags, FLAGS_SIGN);
-            // Fall through.
-        case 'u':
-            // Handle unsigned integer formatting.
-            break;
-
-        case 'E':
-        case 'G':
-        case 'e':
-        case 'f':
-        case 'g':
-            // Handle floating-point formatting.
-            tmp = flt(tmp, end, va_arg(args, double), field_width, precision, *format, bitmask_set(flags, FLAGS_SIGN));
-            continue;
-
-        default:
-            if (*format != '%') {
-                if (tmp < end) {
-                    *tmp++ = '%'; // Output '%' if not a format specifier.
-                }
-            }
-            if (*format && tmp < end) {
-                *tmp++ = *format; // Output the current character.
-            } else {
-                --format; // Handle the case of trailing '%'.
-            }
-            continue;
-        }
-
-        // Process the integer value.
-        if (bitmask_check(flags, FLAGS_SIGN)) {
-            long num = (qualifier == 'l')   ? va_arg(args, long)
-                       : (qualifier == 'h') ? va_arg(args, short)
-                                            : va_arg(args, int);
-            // Add the number.
-            tmp      = number(tmp, end, num, base, field_width, precision, flags);
-        } else {
-            unsigned long num = (qualifier == 'l')   ? va_arg(args, unsigned long)
-                                : (qualifier == 'h') ? va_arg(args, unsigned short)
-                                                     : va_arg(args, unsigned int);
-            // Add the number.
-            tmp               = number(tmp, end, num, base, field_width, precision, flags);
-        }
+    if (bufsize == 0) {
+        return 0; // There is not even room for the null-terminator.
     }
 
-    if (tmp < end) {
-        *tmp = '\0'; // Null-terminate the output string.
-    } else {
-        *end = '\0'; // Ensure null-termination if buffer exceeded.
-    }
+    // Reserve space for null-terminator.
+    tmp  = vformat(str, str + bufsize - 1, format, args);
+    *tmp = '\0';             // Null-terminate the output string.
     return (int)(tmp - str); // Return the number of characters written.
 }
 
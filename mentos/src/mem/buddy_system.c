@@ -348,6 +348,8 @@ void bb_free_pages(bb_instance_t *instance, bb_page_t *page)
 #endif
 }
 
+int bb_page_is_root(bb_page_t *page) { return page && __bb_test_flag(page, ROOT_PAGE); }
+
 int buddy_system_init(
     bb_instance_t *instance,
     const char *name,
@@ -0,0 +1,251 @@
+/// @file oom.c
+/// @brief Out-of-memory handling and memory pressure notification.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+// Setup the logging for this file (do this before any other include).
+#include "sys/kernel_levels.h"           // Include kernel log levels.
+#define __DEBUG_HEADER__ "[OOM   ]"      ///< Change header.
+#define __DEBUG_LEVEL__  LOGLEVEL_NOTICE ///< Set log level.
+#include "io/debug.h"                    // Include debugging functions.
+
+#include "mem/oom.h"
+
+#include "mem/slab.h"
+#include "mem/vmem_map.h"
+#include "mem/zone_allocator.h"
+#include "process/scheduler.h"
+#include "process/wait.h"
+#include "system/signal.h"
+
+/// The current memory pressure level.
+static mempressure_level_t mempressure_level = MEMPRESSURE_NONE;
+/// The number of changes of the level, it starts from 1 so that 0 can mean "never read".
+static unsigned long mempressure_events = 1;
+/// The tasks waiting for the level to change.
+static wait_queue_head_t mempressure_queue = {
+    .task_list = {.next = &mempressure_queue.task_list, .prev = &mempressure_queue.task_list}};
+/// Prevents the OOM killer from running again while it is handling a failure.
+static int oom_in_progress = 0;
+/// The pid of the last task killed by the OOM killer.
+static pid_t oom_victim_pid = 0;
+
+/// @brief Returns the number of page frames of all the zones.
+/// @return the total number of page frames.
+static inline unsigned long __oom_total_pages(void)
+{
+    unsigned long total = 0;
+    if (memory.page_data) {
+        for (int nid = 0; nid < memory.nr_nodes; ++nid) {
+            for (int i = 0; i < memory.page_data[nid].nr_zones; ++i) {
+                total += memory.page_data[nid].node_zones[i].num_pages;
+            }
+        }
+    }
+    return total;
+}
+
+/// @brief Computes the memory pressure level of a zone.
+/// @param zone the zone.
+/// @return the level.
+static inline mempressure_level_t __mempressure_zone_level(const zone_t *zone)
+{
+    if (zone->num_pages == 0) {
+        return MEMPRESSURE_NONE;
+    }
+    if (zone->free_pages <= (zone->num_pages / 16)) {
+        return MEMPRESSURE_CRITICAL;
+    }
+    if (zone->free_pages <= (zone->num_pages / 8)) {
+        return MEMPRESSURE_MEDIUM;
+    }
+    if (zone->free_pages <= (zone->num_pages / 4)) {
+        return MEMPRESSURE_LOW;
+    }
+    return MEMPRESSURE_NONE;
+}
+
+/// @brief Sets the memory pressure level, and wakes up the waiting tasks if it changed.
+/// @param level the new level.
+static inline void __mempressure_set_level(mempressure_level_t level)
+{
+    if (level == mempressure_level) {
+        return;
+    }
+    mempressure_level = level;
+    ++mempressure_events;
+    list_for_each_safe_decl(it, store, &mempressure_queue.task_list)
+    {
+        wait_queue_entry_t *entry = list_entry(it, wait_queue_entry_t, task_list);
+        if (entry->func(entry, TASK_RUNNING, 0)) {
+            remove_wait_queue(&mempressure_queue, entry);
+            wait_queue_entry_dealloc(entry);
+        }
+    }
+}
+
+void mempressure_update(void)
+{
+    mempressure_level_t level = MEMPRESSURE_NONE;
+    if (!memory.page_data) {
+        return;
+    }
+    // The pressure of the system is the one of its most used zone.
+    for (int nid = 0; nid < memory.nr_nodes; ++nid) {
+        for (int i = 0; i < memory.page_data[nid].nr_zones; ++i) {
+            mempressure_level_t zone_level = __mempressure_zone_level(&memory.page_data[nid].node_zones[i]);
+            if (zone_level > level) {
+                level = zone_level;
+            }
+        }
+    }
+    __mempressure_set_level(level);
+}
+
+mempressure_level_t mempressure_get_level(void) { return mempressure_level; }
+
+const char *mempressure_level_name(mempressure_level_t level)
+{
+    static const char *names[] = {"none", "low", "medium", "critical"};
+    if ((level < MEMPRESSURE_NONE) || (level > MEMPRESSURE_CRITICAL)) {
+        return "unknown";
+    }
+    return names[level];
+}
+
+unsigned long mempressure_get_events(void) { return mempressure_events; }
+
+int mempressure_wait(void) { return interruptible_sleep_on(&mempressure_queue); }
+
+/// @brief Drops the pages released with MADV_FREE which were not written since then.
+/// @return the number of pages released.
+static inline unsigned int __oom_reclaim_lazyfree(void)
+{
+    unsigned int released = 0;
+    // There are no processes yet.
+    if (!scheduler_get_current_process()) {
+        return 0;
+    }
+    list_for_each_decl (it, &runqueue.queue) {
+        task_struct *task = list_entry(it, task_struct, run_list);
+        if (!task->mm) {
+            continue;
+        }
+        list_for_each_decl (it_area, &task->mm->mmap_list) {
+            released += vm_area_reclaim_lazyfree(list_entry(it_area, vm_area_struct_t, vm_list));
+        }
+    }
+    return released;
+}
+
+/// @brief Counts the resident pages of a task.
+/// @param task the task.
+/// @return the number of resident pages.
+static inline unsigned long __oom_task_rss(task_struct *task)
+{
+    vm_area_stats_t stats;
+    unsigned long rss = 0;
+    list_for_each_decl (it, &task->mm->mmap_list) {
+        vm_area_struct_t *area = list_entry(it, vm_area_struct_t, vm_list);
+        if (vm_area_get_stats(area, &stats) == 0) {
+            rss += stats.resident;
+        }
+    }
+    return rss;
+}
+
+unsigned long oom_badness(task_struct *task)
+{
+    // The init process, kernel tasks and exiting tasks are never selected.
+    if (!task || (task == init_process) || !task->mm || (task->state & (EXIT_ZOMBIE | EXIT_DEAD))) {
+        return 0;
+    }
+    if (task->oom_score_adj == OOM_SCORE_ADJ_MIN) {
+        return 0;
+    }
+    long points = (long)__oom_task_rss(task);
+    // The adjustment is a fraction of the memory, in thousandths.
+    points += (long)task->oom_score_adj * (long)__oom_total_pages() / 1000;
+    // A killable task always has a positive score.
+    return (points > 0) ? (unsigned long)points : 1;
+}
+
+unsigned int oom_score(task_struct *task)
+{
+    unsigned long total = __oom_total_pages();
+    if (total == 0) {
+        return 0;
+    }
+    unsigned long score = oom_badness(task) * 1000 / total;
+    return (score > 2000) ? 2000 : score;
+}
+
+/// @brief Selects the task with the highest badness.
+/// @return the victim, NULL if no task can be killed.
+static inline task_struct *__oom_select_victim(void)
+{
+    task_struct *victim  = NULL;
+    unsigned long points = 0;
+    // There are no processes yet.
+    if (!scheduler_get_current_process()) {
+        return NULL;
+    }
+    list_for_each_decl (it, &runqueue.queue) {
+        task_struct *task     = list_entry(it, task_struct, run_list);
+        unsigned long badness = oom_badness(task);
+        if (badness > points) {
+            victim = task;
+            points = badness;
+        }
+    }
+    return victim;
+}
+
+/// @brief Checks if the last victim is still releasing its memory.
+/// @return 1 if it is still alive, 0 otherwise.
+static inline int __oom_victim_is_exiting(void)
+{
+    if (oom_victim_pid == 0) {
+        return 0;
+    }
+    task_struct *task = scheduler_get_running_process(oom_victim_pid);
+    if (task && !(task->state & (EXIT_ZOMBIE | EXIT_DEAD))) {
+        return 1;
+    }
+    oom_victim_pid = 0;
+    return 0;
+}
+
+int out_of_memory(gfp_t gfp_mask, unsigned int order)
+{
+    // Killing a task allocates memory too, do not recurse.
+    if (oom_in_progress) {
+        return 0;
+    }
+    oom_in_progress = 1;
+    // Reclaim the memory which is not really in use.
+    unsigned int reclaimed = kmem_cache_reap() + vmalloc_purge_lazy() + __oom_reclaim_lazyfree();
+    if (reclaimed > 0) {
+        pr_notice("Reclaimed %u pages for an allocation of order %u.\n", reclaimed, order);
+        oom_in_progress = 0;
+        return 1;
+    }
+    __mempressure_set_level(MEMPRESSURE_CRITICAL);
+    // Give the previous victim the time to exit.
+    if (__oom_victim_is_exiting()) {
+        oom_in_progress = 0;
+        return 0;
+    }
+    task_struct *victim = __oom_select_victim();
+    if (victim) {
+        pr_err(
+            "Out of memory (gfp_mask: 0x%x, order: %u): killing process %d (%s), score %u, adj %d.\n", gfp_mask,
+            order, victim->pid, victim->name, oom_score(victim), victim->oom_score_adj);
+        oom_victim_pid = victim->pid;
+        sys_kill(victim->pid, SIGKILL);
+    } else {
+        pr_emerg("Out of memory (gfp_mask: 0x%x, order: %u): no process can be killed.\n", gfp_mask, order);
+    }
+    oom_in_progress = 0;
+    return 0;
+}
@@ -11,10 +11,13 @@
 
 #include "assert.h"
 #include "descriptor_tables/isr.h"
+#include "errno.h"
 #include "fs/vfs.h"
+#include "hardware/cpuid.h"
 #include "list_head.h"
 #include "list_head_algorithm.h"
 #include "mem/kheap.h"
+#include "mem/oom.h"
 #include "mem/paging.h"
 #include "mem/vmem_map.h"
 #include "mem/zone_allocator.h"
@@ -36,6 +39,16 @@ kmem_cache_t *pgtbl_cache;
 /// The mm_struct of the kernel.
 static mm_struct_t *main_mm;
 
+/// The number of pages populated around a demand-zero fault, by default.
+#define FAULT_AROUND_PAGES     4
+/// The number of pages populated ahead of a demand-zero fault, in sequential areas, by default.
+#define FAULT_AROUND_SEQ_PAGES 16
+/// Software bit of the page table entries, it marks the pages released with MADV_FREE.
+#define PTE_LAZYFREE           0x2
+
+/// The number of pages populated ahead of a demand-zero fault, in sequential areas.
+int sysctl_vm_readahead_pages = FAULT_AROUND_SEQ_PAGES;
+
 /// @brief Structure for iterating page directory entries.
 typedef struct page_iterator_s {
     /// Pointer to the entry.
@@ -48,6 +61,8 @@ typedef struct page_iterator_s {
     uint32_t last_pfn;
     /// Contains MEMMAP_FLAGS flags.
     uint32_t flags;
+    /// If set, missing page tables are skipped instead of being allocated.
+    int walk_only;
 } page_iterator_t;
 
 /// @brief Structure for iterating page table entries.
@@ -150,6 +165,10 @@ vm_area_struct_t *create_vm_area(mm_struct_t *mm, uint32_t vm_start, size_t size
     // Find the nearest order for the given memory size.
     order = find_nearest_order_greater(vm_start, size);
 
+    // Keep the flags requested for the area, they are shown in `/proc/<pid>/maps`.
+    segment->vm_flags = pgflags;
+    segment->vm_hints = 0;
+
     if (pgflags & MM_COW) {
         // If the area is copy-on-write, clear the present and update address
         // flags.
@@ -187,13 +206,11 @@ vm_area_struct_t *create_vm_area(mm_struct_t *mm, uint32_t vm_start, size_t size
     segment->vm_end   = vm_end;
     segment->vm_mm    = mm;
 
-    // Insert the new segment into the memory descriptor's list of vm_area_structs.
-    list_head_insert_after(&segment->vm_list, &mm->mmap_list);
+    // Insert the new segment into the memory descriptor's list of
+    // vm_area_structs, keeping the list sorted by address.
+    list_head_insert_sorted(&segment->vm_list, &mm->mmap_list, vm_area_compare);
     mm->mmap_cache = segment;
 
-    // Sort the mmap_list to maintain order.
-    list_head_sort(&mm->mmap_list, vm_area_compare);
-
     // Update memory descriptor info.
     mm->map_count++;
     mm->total_vm += (1U << order);
@@ -226,6 +243,8 @@ uint32_t clone_vm_area(mm_struct_t *mm, vm_area_struct_t *area, int cow, uint32_
 
     // Update the memory descriptor for the new segment.
     new_segment->vm_mm = mm;
+    // Memory locks are not inherited, and the content of the area is copied.
+    new_segment->vm_hints &= ~(VM_LOCKED | VM_LAZYFREE);
 
     // Calculate the size and the nearest order for the new segment's memory allocation.
     uint32_t size  = new_segment->vm_end - new_segment->vm_start;
@@ -255,7 +274,14 @@ uint32_t clone_vm_area(mm_struct_t *mm, vm_area_struct_t *area, int cow, uint32_
         }
 
         // Copy virtual memory from source area into destination area using a virtual mapping.
-        virt_memcpy(mm, area->vm_start, area->vm_mm, area->vm_start, size);
+        if (virt_memcpy(mm, area->vm_start, area->vm_mm, area->vm_start, size) < 0) {
+            pr_crit("Failed to copy the content of the vm_area\n");
+            // Free the allocated pages on failure.
+            free_pages(dst_page);
+            // Free the newly allocated segment.
+            kmem_cache_free(new_segment);
+            return -1;
+        }
     } else {
         // If copy-on-write, set the original pages as read-only.
         if (mem_upd_vm_area(area->vm_mm->pgd, area->vm_start, 0, size, MM_COW | MM_PRESENT | MM_USER) < 0) {
@@ -276,8 +302,10 @@ uint32_t clone_vm_area(mm_struct_t *mm, vm_area_struct_t *area, int cow, uint32_
         }
     }
 
-    // Update memory descriptor list of vm_area_struct.
-    list_head_insert_after(&new_segment->vm_list, &mm->mmap_list);
+    // Update memory descriptor list of vm_area_struct, keeping it sorted. When
+    // cloning a whole process image the areas arrive in order, so each
+    // insertion is just an append.
+    list_head_insert_sorted(&new_segment->vm_list, &mm->mmap_list, vm_area_compare);
     mm->mmap_cache = new_segment;
 
     // Update memory descriptor info.
@@ -557,6 +585,14 @@ int paging_init(boot_info_t *info)
     // Enable paging.
     paging_enable();
 
+    // The page tables are the 2-level 32-bit ones, report the memory they cannot reach.
+    uint32_t above_4g = mmap_available_above_4g(info->multiboot_header);
+    if (above_4g) {
+        pr_warning(
+            "%u MB of memory above 4 GB are not addressable without PAE (PAE: %s, NX: %s).\n", above_4g / K,
+            cpuid_has_pae() ? "supported" : "missing", cpuid_has_nx() ? "supported" : "missing");
+    }
+
     return 0;
 }
 
@@ -628,8 +664,8 @@ static void __page_fault_panic(pt_regs *f, uint32_t addr)
     kernel_panic("Page fault!");
 
     // Make directory accessible
-    //    main_mm->pgd->entries[addr/(1024*4096)].user = 1;
-    //    main_directory->entries[addr/(1024*4096)]. = 1;
+    //    main_mm->pgd->entries[addr/PAGE_TABLE_SPAN].user = 1;
+    //    main_directory->entries[addr/PAGE_TABLE_SPAN]. = 1;
 
     __asm__ __volatile__("cli");
 }
@@ -657,6 +693,8 @@ static int __page_handle_cow(page_table_entry_t *entry)
             page_t *page = alloc_pages(GFP_HIGHUSER, 0);
             if (!page) {
                 pr_crit("Failed to allocate a new page.\n");
+                // Leave the page as it was, a later access might succeed.
+                entry->kernel_cow = 1;
                 return 1;
             }
 
@@ -664,6 +702,8 @@ static int __page_handle_cow(page_table_entry_t *entry)
             uint32_t vaddr = virt_map_physical_pages(page, 1);
             if (!vaddr) {
                 pr_crit("Failed to map the physical page to virtual address.\n");
+                free_pages(page);
+                entry->kernel_cow = 1;
                 return 1;
             }
 
@@ -760,6 +800,23 @@ static page_table_t *__mem_pg_entry_alloc(page_dir_entry_t *entry, uint32_t flag
     return lowmem_addr;
 }
 
+/// @brief Returns the page table of a page directory entry, without allocating it.
+/// @param entry The page directory entry.
+/// @return A pointer to the page table, or NULL if it is not present.
+static inline page_table_t *__mem_pg_entry_get(page_dir_entry_t *entry)
+{
+    if (!entry || !entry->present) {
+        return NULL;
+    }
+    // Retrieve the page of the table from its physical address.
+    page_t *page = get_page_from_physical_address(((uint32_t)entry->frame) << 12U);
+    if (!page) {
+        return NULL;
+    }
+    // Page tables live in low memory.
+    return (page_table_t *)get_virtual_address_from_page(page);
+}
+
 /// @brief Sets the frame attribute of a page directory entry based on the page table's physical address.
 /// @param entry The page directory entry to modify.
 /// @param table The page table whose frame is being set in the directory entry.
@@ -799,6 +856,11 @@ static inline int __set_pg_entry_frame(page_dir_entry_t *entry, page_table_t *ta
     return 0;
 }
 
+/// @brief Populates the demand-zero pages around a faulting address, the
+/// size of the window depends on the hints of the area.
+/// @param addr the faulting address.
+static void __page_fault_around(uint32_t addr);
+
 void page_fault_handler(pt_regs *f)
 {
     // Here you will find the `Demand Paging` mechanism.
@@ -849,7 +911,7 @@ void page_fault_handler(pt_regs *f)
     }
 
     // Get the directory entry that corresponds to the faulting address.
-    page_dir_entry_t *direntry = &lowmem_dir->entries[faulting_addr / (1024U * PAGE_SIZE)];
+    page_dir_entry_t *direntry = &lowmem_dir->entries[PGD_INDEX(faulting_addr / PAGE_SIZE)];
 
     // Panic only if page is in kernel memory, else abort process with SIGSEGV.
     if (!direntry->present) {
@@ -891,7 +953,7 @@ void page_fault_handler(pt_regs *f)
     }
 
     // Get the entry inside the table that caused the fault.
-    uint32_t table_index = (faulting_addr / PAGE_SIZE) % 1024U;
+    uint32_t table_index = PTE_INDEX(faulting_addr / PAGE_SIZE);
 
     // Get the corresponding page table entry.
     page_table_entry_t *entry = &lowmem_table->pages[table_index];
@@ -950,6 +1012,8 @@ void page_fault_handler(pt_regs *f)
             pr_crit("Continuing with page fault handling, triggering panic.\n");
             __page_fault_panic(f, faulting_addr);
         }
+        // Populate the neighbouring pages too, instead of faulting on each of them.
+        __page_fault_around(faulting_addr);
     }
 
     // Invalidate the TLB entry for the faulting address.
@@ -973,10 +1037,10 @@ __pg_iter_init(page_iterator_t *iter, page_directory_t *pgd, uint32_t addr_start
     uint32_t end_pfn = (addr_start + size + PAGE_SIZE - 1) / PAGE_SIZE;
 
     // Determine the base page table index from the starting PFN.
-    uint32_t base_pgt = start_pfn / 1024;
+    uint32_t base_pgt = PGD_INDEX(start_pfn);
 
     // Ensure that the base page table index is within valid range.
-    if (base_pgt >= MAX_PAGE_TABLE_ENTRIES) {
+    if (base_pgt >= MAX_PAGE_DIR_ENTRIES) {
         pr_crit("Base page table index %u is out of bounds.\n", base_pgt);
         return -1;
     }
@@ -985,9 +1049,10 @@ __pg_iter_init(page_iterator_t *iter, page_directory_t *pgd, uint32_t addr_start
     iter->entry = pgd->entries + base_pgt;
 
     // Set the page frame numbers for the iterator.
-    iter->pfn      = start_pfn;
-    iter->last_pfn = end_pfn;
-    iter->flags    = flags;
+    iter->pfn       = start_pfn;
+    iter->last_pfn  = end_pfn;
+    iter->flags     = flags;
+    iter->walk_only = 0;
 
     // Allocate memory for the page table entry associated with the iterator.
     iter->table = __mem_pg_entry_alloc(iter->entry, flags);
@@ -1003,6 +1068,38 @@ __pg_iter_init(page_iterator_t *iter, page_directory_t *pgd, uint32_t addr_start
     return 0;
 }
 
+/// @brief Initialize a page iterator which only walks the existing page tables.
+/// @param iter       The iterator to initialize.
+/// @param pgd        The page directory to iterate.
+/// @param addr_start The starting address.
+/// @param size       The total amount we want to iterate.
+/// @return 0 on success, -1 on error.
+static int __pg_iter_init_walk(page_iterator_t *iter, page_directory_t *pgd, uint32_t addr_start, uint32_t size)
+{
+    // Calculate the starting and ending page frame numbers (PFN).
+    uint32_t start_pfn = addr_start / PAGE_SIZE;
+    uint32_t end_pfn   = (addr_start + size + PAGE_SIZE - 1) / PAGE_SIZE;
+
+    // Determine the base page table index from the starting PFN.
+    uint32_t base_pgt = PGD_INDEX(start_pfn);
+
+    // Ensure that the base page table index is within valid range.
+    if (base_pgt >= MAX_PAGE_DIR_ENTRIES) {
+        pr_crit("Base page table index %u is out of bounds.\n", base_pgt);
+        return -1;
+    }
+
+    iter->entry     = pgd->entries + base_pgt;
+    iter->pfn       = start_pfn;
+    iter->last_pfn  = end_pfn;
+    iter->flags     = 0;
+    iter->walk_only = 1;
+    // The page table might be missing, in that case the iterator returns NULL entries.
+    iter->table     = __mem_pg_entry_get(iter->entry);
+
+    return 0;
+}
+
 /// @brief Checks if the iterator has a next entry.
 /// @param iter The iterator to check.
 /// @return Returns 1 if the iterator can continue the iteration; otherwise, returns 0.
@@ -1030,18 +1127,27 @@ static pg_iter_entry_t __pg_iter_next(page_iterator_t *iter)
         return (pg_iter_entry_t){0};
     }
 
-    // Initialize the result entry with the current page frame number (pfn).
-    pg_iter_entry_t result = {.entry = &iter->table->pages[iter->pfn % 1024], .pfn = iter->pfn};
+    // Initialize the result entry with the current page frame number (pfn),
+    // when walking there might be no page table for it.
+    pg_iter_entry_t result = {.entry = NULL, .pfn = iter->pfn};
+    if (iter->table) {
+        result.entry = &iter->table->pages[PTE_INDEX(iter->pfn)];
+    }
 
     // Move to the next page frame number.
     iter->pfn++;
 
     // Check if we have wrapped around to a new page.
-    if (iter->pfn % 1024 == 0) {
+    if (PTE_INDEX(iter->pfn) == 0) {
         // Check if we haven't reached the end of the last page.
         if (iter->pfn != iter->last_pfn) {
             // Ensure that the new entry address is valid and page-aligned.
             if (((uint32_t)++iter->entry) % 4096 != 0) {
+                // When walking, just move to the next page table (if any).
+                if (iter->walk_only) {
+                    iter->table = __mem_pg_entry_get(iter->entry);
+                    return result;
+                }
                 // Attempt to allocate memory for a new page entry.
                 iter->table = __mem_pg_entry_alloc(iter->entry, iter->flags);
                 if (!iter->table) {
@@ -1069,8 +1175,8 @@ page_t *mem_virtual_to_page(page_directory_t *pgd, uint32_t virt_start, size_t *
 
     // Calculate the page frame number and page table index from the virtual address.
     uint32_t virt_pfn        = virt_start / PAGE_SIZE;
-    uint32_t virt_pgt        = virt_pfn / 1024; // Page table index.
-    uint32_t virt_pgt_offset = virt_pfn % 1024; // Offset within the page table.
+    uint32_t virt_pgt        = PGD_INDEX(virt_pfn); // Page table index.
+    uint32_t virt_pgt_offset = PTE_INDEX(virt_pfn); // Offset within the page table.
 
     // Get the physical page for the page directory entry.
     page_t *pgd_page = memory.mem_map + pgd->entries[virt_pgt].frame;
@@ -1101,6 +1207,82 @@ page_t *mem_virtual_to_page(page_directory_t *pgd, uint32_t virt_start, size_t *
     return page;
 }
 
+int vm_area_get_stats(vm_area_struct_t *area, vm_area_stats_t *stats)
+{
+    // Check for null pointers.
+    if (!area || !stats) {
+        pr_crit("Invalid arguments.\n");
+        return -1;
+    }
+    if (!area->vm_mm || !area->vm_mm->pgd) {
+        pr_crit("The area has no page directory.\n");
+        return -1;
+    }
+
+    // Walk the page tables of the area.
+    page_iterator_t iter;
+    if (__pg_iter_init_walk(&iter, area->vm_mm->pgd, area->vm_start, area->vm_end - area->vm_start) < 0) {
+        pr_crit("Failed to initialize the page iterator.\n");
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(vm_area_stats_t));
+    while (__pg_iter_has_next(&iter)) {
+        pg_iter_entry_t it = __pg_iter_next(&iter);
+        stats->size++;
+        // Skip the pages which are not backed by a frame.
+        if (!it.entry || !it.entry->present) {
+            continue;
+        }
+        stats->resident++;
+        stats->dirty += it.entry->dirty;
+        stats->referenced += it.entry->accessed;
+        // Read-only copy-on-write pages are still shared with the parent (or the children).
+        if (it.entry->kernel_cow && !it.entry->rw) {
+            stats->cow++;
+        }
+        page_t *page = get_page_from_physical_address(((uint32_t)it.entry->frame) << 12U);
+        if (page && (page_count(page) > 1)) {
+            stats->shared++;
+        }
+    }
+    return 0;
+}
+
+int mem_read_pagemap(page_directory_t *pgd, uint32_t first_page, pagemap_entry_t *entries, size_t count)
+{
+    // Check for null pointers.
+    if (!pgd || !entries) {
+        pr_crit("Invalid arguments.\n");
+        return -1;
+    }
+
+    // Walk the page tables of the range.
+    page_iterator_t iter;
+    if (__pg_iter_init_walk(&iter, pgd, first_page * PAGE_SIZE, count * PAGE_SIZE) < 0) {
+        pr_crit("Failed to initialize the page iterator.\n");
+        return -1;
+    }
+
+    while (__pg_iter_has_next(&iter) && count--) {
+        pg_iter_entry_t it    = __pg_iter_next(&iter);
+        pagemap_entry_t value = 0;
+        if (it.entry && it.entry->present) {
+            value = PM_PRESENT | (it.entry->frame & PM_PFRAME_MASK);
+            if (it.entry->dirty) {
+                value |= PM_DIRTY;
+            }
+            if (it.entry->kernel_cow && !it.entry->rw) {
+                value |= PM_COW;
+            }
+            page_t *page = get_page_from_physical_address(((uint32_t)it.entry->frame) << 12U);
+            value |= (page && (page_count(page) > 1)) ? PM_SHARED : PM_EXCLUSIVE;
+        }
+        *entries++ = value;
+    }
+    return 0;
+}
+
 int mem_upd_vm_area(page_directory_t *pgd, uint32_t virt_start, uint32_t phy_start, size_t size, uint32_t flags)
 {
     // Check for null pointer to the page directory to avoid dereferencing.
@@ -1313,7 +1495,8 @@ mm_struct_t *clone_process_image(mm_struct_t *mmp)
     mm->map_count = 0;
     mm->total_vm  = 0;
 
-    // Clone each memory area from the source process to the new process.
+    // Clone each memory area from the source process to the new process. We
+    // visit them in address order, so the sorted insertion never has to scan.
     list_head *it;
     list_for_each (it, &mmp->mmap_list) {
         vm_area = list_entry(it, vm_area_struct_t, vm_list);
@@ -1400,7 +1583,7 @@ int destroy_process_image(mm_struct_t *mm)
     }
 
     // Free all the page tables.
-    for (int i = 0; i < 1024; i++) {
+    for (int i = 0; i < MAX_PAGE_DIR_ENTRIES; i++) {
         page_dir_entry_t *entry = &mm->pgd->entries[i];
         // Check if the page table entry is present and not global.
         if (entry->present && !entry->global) {
@@ -1542,3 +1725,360 @@ int sys_munmap(void *addr, size_t length)
         addr, length);
     return 1;
 }
+
+/// @brief Finds the area which contains the given address.
+/// @param mm the memory descriptor.
+/// @param addr the address.
+/// @return the area, NULL if the address is not mapped.
+static vm_area_struct_t *__find_vm_area_containing(mm_struct_t *mm, uint32_t addr)
+{
+    // Faults tend to hit the same area over and over.
+    if (mm->mmap_cache && (addr >= mm->mmap_cache->vm_start) && (addr < mm->mmap_cache->vm_end)) {
+        return mm->mmap_cache;
+    }
+    list_for_each_decl (it, &mm->mmap_list) {
+        vm_area_struct_t *area = list_entry(it, vm_area_struct_t, vm_list);
+        if ((addr >= area->vm_start) && (addr < area->vm_end)) {
+            mm->mmap_cache = area;
+            return area;
+        }
+    }
+    return NULL;
+}
+
+/// @brief Checks that the range is entirely mapped.
+/// @param mm the memory descriptor.
+/// @param start the first address of the range.
+/// @param end the end of the range, exclusive.
+/// @param forbidden the hints that the areas of the range must not have.
+/// @return 0 on success, -ENOMEM if part of the range is not mapped,
+/// -EINVAL if an area has one of the forbidden hints.
+static int __vm_range_check(mm_struct_t *mm, uint32_t start, uint32_t end, unsigned short forbidden)
+{
+    // The areas are sorted by address, so the holes are found in one pass.
+    uint32_t covered = start;
+    list_for_each_decl (it, &mm->mmap_list) {
+        vm_area_struct_t *area = list_entry(it, vm_area_struct_t, vm_list);
+        if (area->vm_end <= covered) {
+            continue;
+        }
+        if (area->vm_start > covered) {
+            break;
+        }
+        if (area->vm_hints & forbidden) {
+            return -EINVAL;
+        }
+        covered = area->vm_end;
+        if (covered >= end) {
+            return 0;
+        }
+    }
+    return -ENOMEM;
+}
+
+/// @brief Allocates the demand-zero pages of the range which are not present yet.
+/// @param pgd the page directory.
+/// @param start the first address of the range.
+/// @param end the end of the range, exclusive.
+/// @return the number of pages allocated, -1 on failure.
+static int __vm_populate(page_directory_t *pgd, uint32_t start, uint32_t end)
+{
+    page_iterator_t iter;
+    int populated = 0;
+    if (__pg_iter_init_walk(&iter, pgd, start, end - start) < 0) {
+        pr_crit("Failed to initialize the page iterator.\n");
+        return -1;
+    }
+    while (__pg_iter_has_next(&iter)) {
+        pg_iter_entry_t it = __pg_iter_next(&iter);
+        if (!it.entry || it.entry->present || !it.entry->kernel_cow) {
+            continue;
+        }
+        if (__page_handle_cow(it.entry)) {
+            return -1;
+        }
+        ++populated;
+    }
+    return populated;
+}
+
+/// @brief Returns the frame mapped by the entry, if it was allocated on its
+/// own by a demand-zero fault and it is not shared.
+/// @param entry the page table entry.
+/// @return the page, NULL if it cannot be released on its own.
+static page_t *__pte_exclusive_page(page_table_entry_t *entry)
+{
+    if (!entry->present) {
+        return NULL;
+    }
+    page_t *page = get_page_from_physical_address(((uint32_t)entry->frame) << 12U);
+    // The pages of a larger block are released together with their area.
+    if (!page || (page_count(page) != 1) || (page->bbpage.order != 0) || !bb_page_is_root(&page->bbpage)) {
+        return NULL;
+    }
+    return page;
+}
+
+/// @brief Releases the frame of the entry, which becomes a demand-zero page again.
+/// @param entry the page table entry.
+/// @param page the frame of the entry.
+/// @param addr the virtual address of the page.
+static inline void __pte_drop(page_table_entry_t *entry, page_t *page, uint32_t addr)
+{
+    free_pages(page);
+    entry->frame      = 0;
+    entry->present    = 0;
+    entry->dirty      = 0;
+    entry->accessed   = 0;
+    entry->kernel_cow = 1;
+    entry->available &= ~PTE_LAZYFREE;
+    paging_flush_tlb_single(addr);
+}
+
+static void __page_fault_around(uint32_t addr)
+{
+    uint32_t start, end;
+    task_struct *task = scheduler_get_current_process();
+    if (!task || !task->mm || !is_current_pgd(task->mm->pgd)) {
+        return;
+    }
+    // Do not allocate memory which might never be used when it is running low.
+    if (mempressure_get_level() >= MEMPRESSURE_MEDIUM) {
+        return;
+    }
+    vm_area_struct_t *area = __find_vm_area_containing(task->mm, addr);
+    if (!area || (area->vm_hints & VM_RAND_READ)) {
+        return;
+    }
+    if (area->vm_hints & VM_SEQ_READ) {
+        // Sequential accesses move forward, populate the pages ahead.
+        start = (addr & ~(PAGE_SIZE - 1)) + PAGE_SIZE;
+        end   = start + (sysctl_vm_readahead_pages - 1) * PAGE_SIZE;
+    } else {
+        // Otherwise, populate the aligned window containing the faulting page.
+        start = addr & ~(FAULT_AROUND_PAGES * PAGE_SIZE - 1);
+        end   = start + FAULT_AROUND_PAGES * PAGE_SIZE;
+    }
+    start = max(start, area->vm_start);
+    end   = min(end, area->vm_end);
+    if (start < end) {
+        __vm_populate(task->mm->pgd, start, end);
+    }
+}
+
+/// @brief Releases the pages of the range, the next access finds them zeroed.
+/// @param area the virtual memory area.
+/// @param start the first address of the range.
+/// @param end the end of the range, exclusive.
+/// @return 0 on success, a negative errno value on failure.
+static int __vm_area_dontneed(vm_area_struct_t *area, uint32_t start, uint32_t end)
+{
+    page_iterator_t iter;
+    if (__pg_iter_init_walk(&iter, area->vm_mm->pgd, start, end - start) < 0) {
+        pr_crit("Failed to initialize the page iterator.\n");
+        return -EINVAL;
+    }
+    while (__pg_iter_has_next(&iter)) {
+        pg_iter_entry_t it = __pg_iter_next(&iter);
+        if (!it.entry || !it.entry->present) {
+            continue;
+        }
+        page_t *page = __pte_exclusive_page(it.entry);
+        if (page) {
+            __pte_drop(it.entry, page, it.pfn * PAGE_SIZE);
+            continue;
+        }
+        // The frame belongs to a larger block, which is released together
+        // with the area, so just clear it. Shared frames are left alone.
+        page = get_page_from_physical_address(((uint32_t)it.entry->frame) << 12U);
+        if (page && (page_count(page) == 1)) {
+            uint32_t vaddr = virt_map_physical_pages(page, 1);
+            if (!vaddr) {
+                pr_crit("Failed to map the physical page to virtual address.\n");
+                return -ENOMEM;
+            }
+            memset((void *)vaddr, 0, PAGE_SIZE);
+            virt_unmap(vaddr);
+        }
+    }
+    return 0;
+}
+
+/// @brief Marks the pages of the range as releasable, they are dropped when
+/// the memory runs low, unless they are written again before.
+/// @param area the virtual memory area.
+/// @param start the first address of the range.
+/// @param end the end of the range, exclusive.
+/// @return 0 on success, a negative errno value on failure.
+static int __vm_area_lazyfree(vm_area_struct_t *area, uint32_t start, uint32_t end)
+{
+    page_iterator_t iter;
+    if (__pg_iter_init_walk(&iter, area->vm_mm->pgd, start, end - start) < 0) {
+        pr_crit("Failed to initialize the page iterator.\n");
+        return -EINVAL;
+    }
+    while (__pg_iter_has_next(&iter)) {
+        pg_iter_entry_t it = __pg_iter_next(&iter);
+        if (!it.entry || !__pte_exclusive_page(it.entry)) {
+            continue;
+        }
+        // The processor sets the dirty bit again if the page is written.
+        it.entry->dirty = 0;
+        it.entry->available |= PTE_LAZYFREE;
+        paging_flush_tlb_single(it.pfn * PAGE_SIZE);
+        area->vm_hints |= VM_LAZYFREE;
+    }
+    return 0;
+}
+
+unsigned int vm_area_reclaim_lazyfree(vm_area_struct_t *area)
+{
+    page_iterator_t iter;
+    unsigned int released = 0;
+    if (!area || !(area->vm_hints & VM_LAZYFREE)) {
+        return 0;
+    }
+    area->vm_hints &= ~VM_LAZYFREE;
+    if (__pg_iter_init_walk(&iter, area->vm_mm->pgd, area->vm_start, area->vm_end - area->vm_start) < 0) {
+        pr_crit("Failed to initialize the page iterator.\n");
+        return 0;
+    }
+    while (__pg_iter_has_next(&iter)) {
+        pg_iter_entry_t it = __pg_iter_next(&iter);
+        if (!it.entry || !it.entry->present || !(it.entry->available & PTE_LAZYFREE)) {
+            continue;
+        }
+        it.entry->available &= ~PTE_LAZYFREE;
+        // The pages written after the advice, or locked since then, are kept.
+        if (it.entry->dirty || (area->vm_hints & VM_LOCKED)) {
+            continue;
+        }
+        page_t *page = __pte_exclusive_page(it.entry);
+        if (page) {
+            __pte_drop(it.entry, page, it.pfn * PAGE_SIZE);
+            ++released;
+        }
+    }
+    return released;
+}
+
+/// @brief Applies the advice to the part of an area inside the range.
+/// @param area the virtual memory area.
+/// @param start the first address of the range.
+/// @param end the end of the range, exclusive.
+/// @param advice the advice.
+/// @return 0 on success, a negative errno value on failure.
+static int __vm_area_advise(vm_area_struct_t *area, uint32_t start, uint32_t end, int advice)
+{
+    // Areas are never split, so the access pattern applies to the whole area.
+    switch (advice) {
+    case MADV_NORMAL:
+        area->vm_hints &= ~(VM_SEQ_READ | VM_RAND_READ);
+        return 0;
+    case MADV_RANDOM:
+        area->vm_hints = (area->vm_hints & ~VM_SEQ_READ) | VM_RAND_READ;
+        return 0;
+    case MADV_SEQUENTIAL:
+        area->vm_hints = (area->vm_hints & ~VM_RAND_READ) | VM_SEQ_READ;
+        return 0;
+    case MADV_WILLNEED:
+        return (__vm_populate(area->vm_mm->pgd, start, end) < 0) ? -EAGAIN : 0;
+    case MADV_DONTNEED:
+        return __vm_area_dontneed(area, start, end);
+    case MADV_FREE:
+        return __vm_area_lazyfree(area, start, end);
+    default:
+        return -EINVAL;
+    }
+}
+
+int sys_madvise(void *addr, size_t length, int advice)
+{
+    uint32_t start = (uintptr_t)addr;
+    uint32_t end   = start + ((length + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1));
+    int ret;
+
+    // Get the current task.
+    task_struct *task = scheduler_get_current_process();
+
+    if ((start & (PAGE_SIZE - 1)) || (end < start)) {
+        return -EINVAL;
+    }
+    if ((advice != MADV_NORMAL) && (advice != MADV_RANDOM) && (advice != MADV_SEQUENTIAL) &&
+        (advice != MADV_WILLNEED) && (advice != MADV_DONTNEED) && (advice != MADV_FREE)) {
+        return -EINVAL;
+    }
+    if (start == end) {
+        return 0;
+    }
+    // Locked pages cannot be released.
+    ret = __vm_range_check(
+        task->mm, start, end, ((advice == MADV_DONTNEED) || (advice == MADV_FREE)) ? VM_LOCKED : 0);
+    if (ret < 0) {
+        return ret;
+    }
+    list_for_each_decl (it, &task->mm->mmap_list) {
+        vm_area_struct_t *area = list_entry(it, vm_area_struct_t, vm_list);
+        if (area->vm_end <= start) {
+            continue;
+        }
+        if (area->vm_start >= end) {
+            break;
+        }
+        ret = __vm_area_advise(area, max(start, area->vm_start), min(end, area->vm_end), advice);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+/// @brief Locks or unlocks the areas containing the given range.
+/// @param addr the starting address of the range.
+/// @param length the length of the range.
+/// @param lock 1 to lock the pages, 0 to unlock them.
+/// @return 0 on success, a negative errno value on failure.
+static int __vm_range_lock(const void *addr, size_t length, int lock)
+{
+    // The range is extended to whole pages.
+    uint32_t start = (uintptr_t)addr & ~(PAGE_SIZE - 1);
+    uint32_t end   = ((uintptr_t)addr + length + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+    int ret;
+
+    // Get the current task.
+    task_struct *task = scheduler_get_current_process();
+
+    if (end < start) {
+        return -EINVAL;
+    }
+    if (start == end) {
+        return 0;
+    }
+    ret = __vm_range_check(task->mm, start, end, 0);
+    if (ret < 0) {
+        return ret;
+    }
+    list_for_each_decl (it, &task->mm->mmap_list) {
+        vm_area_struct_t *area = list_entry(it, vm_area_struct_t, vm_list);
+        if (area->vm_end <= start) {
+            continue;
+        }
+        if (area->vm_start >= end) {
+            break;
+        }
+        if (!lock) {
+            area->vm_hints &= ~VM_LOCKED;
+            continue;
+        }
+        // A locked page never faults, so populate the range right away.
+        area->vm_hints |= VM_LOCKED;
+        if (__vm_populate(task->mm->pgd, max(start, area->vm_start), min(end, area->vm_end)) < 0) {
+            return -EAGAIN;
+        }
+    }
+    return 0;
+}
+
+int sys_mlock(const void *addr, size_t length) { return __vm_range_lock(addr, length, 1); }
+
+int sys_munlock(const void *addr, size_t length) { return __vm_range_lock(addr, length, 0); }
@@ -45,7 +45,7 @@ typedef struct kmem_obj {
 /// @details The starting number of objects in a newly allocated slab cache.
 #define KMEM_START_OBJ_COUNT 8
 
-/// @brief Maximum number of objects to refill in a slab cache at once.
+/// @brief Maximum number of objects to refill in a slab cache at once, by default.
 /// @details This defines the upper limit on how many objects to replenish in
 /// the slab when it runs out of free objects.
 #define KMEM_MAX_REFILL_OBJ_COUNT 64
@@ -69,6 +69,9 @@ static kmem_cache_t kmem_cache;
 /// @brief Array of slab caches for different orders of kmalloc.
 static kmem_cache_t *malloc_blocks[MAX_KMALLOC_CACHE_ORDER];
 
+/// @brief Maximum number of objects to refill in a slab cache at once.
+int sysctl_vm_slab_refill_count = KMEM_MAX_REFILL_OBJ_COUNT;
+
 /// @brief Allocates and initializes a new slab page for a memory cache.
 /// @param cachep Pointer to the memory cache (`kmem_cache_t`) for which a new
 /// slab page is being allocated.
@@ -448,7 +451,7 @@ int kmem_cache_init(void)
     list_head_init(&kmem_caches_list);
 
 #ifdef ENABLE_KMEM_TRACE
-    ENABLE_EXT2_TRACE = register_resource("kmem");
+    resource_id = register_resource("kmem");
 #endif
 
     // Create a cache to store metadata about kmem_cache_t structures.
@@ -592,6 +595,35 @@ int kmem_cache_destroy(kmem_cache_t *cachep)
     return 0;
 }
 
+unsigned int kmem_cache_shrink(kmem_cache_t *cachep)
+{
+    unsigned int released = 0;
+    // Validate input parameter.
+    if (!cachep) {
+        pr_crit("Cannot shrink a NULL cache pointer.\n");
+        return 0;
+    }
+    while (!list_head_empty(&cachep->slabs_free)) {
+        page_t *slab_page = list_entry(list_head_pop(&cachep->slabs_free), page_t, slabs);
+        if (__kmem_cache_free_slab(cachep, slab_page) < 0) {
+            pr_crit("Failed to release a free slab of cache `%s`.\n", cachep->name);
+            break;
+        }
+        released += 1U << cachep->gfp_order;
+    }
+    return released;
+}
+
+unsigned int kmem_cache_reap(void)
+{
+    unsigned int released = 0;
+    list_for_each_decl (it, &kmem_caches_list) {
+        released += kmem_cache_shrink(list_entry(it, kmem_cache_t, cache_list));
+    }
+    pr_debug("Reaped %u pages from the caches.\n", released);
+    return released;
+}
+
 void *pr_kmem_cache_alloc(const char *file, const char *fun, int line, kmem_cache_t *cachep, gfp_t flags)
 {
     // Check for null cache pointer
@@ -610,7 +642,7 @@ void *pr_kmem_cache_alloc(const char *file, const char *fun, int line, kmem_cach
             }
 
             // Attempt to refill the cache, limiting the number of objects.
-            if (__kmem_cache_refill(cachep, min(cachep->total_num, KMEM_MAX_REFILL_OBJ_COUNT), flags) < 0) {
+            if (__kmem_cache_refill(cachep, min(cachep->total_num, (unsigned int)sysctl_vm_slab_refill_count), flags) < 0) {
                 pr_crit("Failed to refill cache `%s`\n", cachep->name);
                 return NULL;
             }
@@ -660,6 +692,9 @@ void *pr_kmem_cache_alloc(const char *file, const char *fun, int line, kmem_cach
     pr_notice("kmem_cache_alloc 0x%p in %-20s at %s:%d\n", ptr, cachep->name, file, line);
 #endif
 
+    // Account the object to the allocation site, if the profiler is active.
+    alloc_profiler_alloc(file, fun, line, ptr, cachep->aligned_object_size);
+
     return ptr; // Return pointer to the allocated object.
 }
 
@@ -671,6 +706,9 @@ int pr_kmem_cache_free(const char *file, const char *fun, int line, void *addr)
         return 1;
     }
 
+    // Remove the object from the allocation profiler.
+    alloc_profiler_free(addr);
+
     // Get the slab page corresponding to the given pointer.
     page_t *slab_page = get_page_from_virtual_address((uint32_t)addr);
 
@@ -753,8 +791,10 @@ void *pr_kmalloc(const char *file, const char *fun, int line, unsigned int size)
         if (!ptr) {
             pr_crit("Failed to allocate raw pages for order %u at %s:%d\n", order, file, line);
         }
+        alloc_profiler_alloc(file, fun, line, ptr, PAGE_SIZE << (order - 12));
     } else {
-        ptr = kmem_cache_alloc(malloc_blocks[order], GFP_KERNEL);
+        // Pass our caller along, so that the object is accounted to it.
+        ptr = pr_kmem_cache_alloc(file, fun, line, malloc_blocks[order], GFP_KERNEL);
         if (!ptr) {
             pr_crit(
                 "Failed to allocate from kmalloc cache order %u for size %u at "
@@ -790,7 +830,7 @@ void pr_kfree(const char *file, const char *fun, int line, void *ptr)
 
     // If the address belongs to a cache, free it using kmem_cache_free.
     if (page->container.slab_main_page) {
-        if (kmem_cache_free(ptr) < 0) {
+        if (pr_kmem_cache_free(file, fun, line, ptr) < 0) {
             pr_crit(
                 "Failed to free memory from kmem_cache for address 0x%p at "
                 "%s:%d\n",
@@ -798,6 +838,7 @@ void pr_kfree(const char *file, const char *fun, int line, void *ptr)
         }
     } else {
         // Otherwise, free the raw pages.
+        alloc_profiler_free(ptr);
         if (free_pages_lowmem((uint32_t)ptr) < 0) {
             pr_crit("Failed to free raw pages for address 0x%p at %s:%d\n", ptr, file, line);
         }
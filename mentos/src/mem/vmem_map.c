@@ -9,9 +9,10 @@
 #define __DEBUG_LEVEL__  LOGLEVEL_NOTICE ///< Set log level.
 #include "io/debug.h"                    // Include debugging functions.
 
+#include "mem/slab.h"
 #include "mem/vmem_map.h"
+#include "resource_tracing.h"
 #include "string.h"
-#include "system/panic.h"
 
 /// Virtual addresses manager.
 static virt_map_page_manager_t virt_default_mapping;
@@ -61,12 +62,11 @@ int virt_init(void)
     // Divide by PAGE_SIZE to calculate the starting page frame number.
     uint32_t start_virt_pfn = VIRTUAL_MAPPING_BASE / PAGE_SIZE;
 
-    // Calculate the page table index (1024 entries per page table in a 32-bit
-    // system).
-    uint32_t start_virt_pgt = start_virt_pfn / 1024;
+    // Calculate the page table index.
+    uint32_t start_virt_pgt = PGD_INDEX(start_virt_pfn);
 
     // Calculate the table index for the specific page inside the page table.
-    uint32_t start_virt_tbl_idx = start_virt_pfn % 1024;
+    uint32_t start_virt_tbl_idx = PTE_INDEX(start_virt_pfn);
 
     // Initialize the number of pages to allocate based on
     // VIRTUAL_MEMORY_PAGES_COUNT.
@@ -76,7 +76,7 @@ int virt_init(void)
     // shared across all page directories of processes.
     page_dir_entry_t *entry;
     page_table_t *table;
-    for (uint32_t i = start_virt_pgt; i < 1024 && (pfn_num > 0); i++) {
+    for (uint32_t i = start_virt_pgt; i < MAX_PAGE_DIR_ENTRIES && (pfn_num > 0); i++) {
         // Get the page directory entry for the current page table index.
         entry = main_pgd->entries + i;
 
@@ -101,7 +101,7 @@ int virt_init(void)
         uint32_t start_page = (i == start_virt_pgt) ? start_virt_tbl_idx : 0;
 
         // Initialize the pages within the page table.
-        for (uint32_t j = start_page; j < 1024 && (pfn_num > 0); j++, pfn_num--) {
+        for (uint32_t j = start_page; j < MAX_PAGE_TABLE_ENTRIES && (pfn_num > 0); j++, pfn_num--) {
             table->pages[j].frame   = 0; // No frame allocated
             table->pages[j].rw      = 0; // Read-only
             table->pages[j].present = 0; // Not present
@@ -127,6 +127,45 @@ int virt_init(void)
     return 0;
 }
 
+/// @brief Frees the physical pages of a vmalloc area, and its virtual range.
+/// @param vpage the first virtual page of the area.
+/// @param first the physical page of the first virtual page, which might have
+/// been moved out of it.
+/// @return the number of physical pages given back to the zone allocator.
+static unsigned int __vmalloc_release(virt_map_page_t *vpage, page_t *first)
+{
+    unsigned int released = 0;
+    vpage->page           = first;
+    // Free the physical pages, the area might be larger than what was mapped.
+    for (uint32_t j = 0; j < (1U << vpage->bbpage.order); ++j) {
+        if (vpage[j].page) {
+            free_pages(vpage[j].page);
+            vpage[j].page = NULL;
+            ++released;
+        }
+    }
+    // Give back the virtual range.
+    bb_free_pages(&virt_default_mapping.bb_instance, &vpage->bbpage);
+    return released;
+}
+
+unsigned int vmalloc_purge_lazy(void)
+{
+    unsigned int released = 0;
+    if (virt_default_mapping.lazy_count == 0) {
+        return 0;
+    }
+    // A single flush for all the areas, instead of one for each page.
+    paging_flush_tlb_all();
+    for (unsigned int i = 0; i < virt_default_mapping.lazy_count; ++i) {
+        vmalloc_lazy_area_t *area = &virt_default_mapping.lazy_areas[i];
+        released += __vmalloc_release(area->vpage, area->page);
+    }
+    virt_default_mapping.lazy_count = 0;
+    virt_default_mapping.lazy_pages = 0;
+    return released;
+}
+
 /// @brief Allocates a virtual page, given the page frame count.
 /// @param pfn_count the page frame count.
 /// @return pointer to the virtual page.
@@ -137,6 +176,11 @@ static virt_map_page_t *_alloc_virt_pages(uint32_t pfn_count)
 
     // Allocate pages from the buddy system.
     bb_page_t *bbpage = bb_alloc_pages(&virt_default_mapping.bb_instance, order);
+    // Some of the virtual space might be waiting for the purge.
+    if (!bbpage && virt_default_mapping.lazy_count) {
+        vmalloc_purge_lazy();
+        bbpage = bb_alloc_pages(&virt_default_mapping.bb_instance, order);
+    }
     // Error handling: failed to allocate pages from the buddy system.
     if (!bbpage) {
         pr_crit("Failed to allocate pages from the buddy system\n");
@@ -297,7 +341,7 @@ int virt_unmap_pg(virt_map_page_t *page)
 }
 
 // FIXME: Check if this function should support unaligned page-boundaries copy
-void virt_memcpy(mm_struct_t *dst_mm, uint32_t dst_vaddr, mm_struct_t *src_mm, uint32_t src_vaddr, uint32_t size)
+int virt_memcpy(mm_struct_t *dst_mm, uint32_t dst_vaddr, mm_struct_t *src_mm, uint32_t src_vaddr, uint32_t size)
 {
     // Buffer size for copying.
     const uint32_t VMEM_BUFFER_SIZE = 65536;
@@ -305,13 +349,21 @@ void virt_memcpy(mm_struct_t *dst_mm, uint32_t dst_vaddr, mm_struct_t *src_mm, u
     // Determine the buffer size to use for copying.
     uint32_t buffer_size = min(VMEM_BUFFER_SIZE, size);
 
-    // Allocate virtual pages for the source and destination.
-    virt_map_page_t *src_vpage = virt_map_alloc(size);
-    virt_map_page_t *dst_vpage = virt_map_alloc(size);
+    // Allocate virtual pages for the source and destination, we only map one
+    // buffer at a time.
+    virt_map_page_t *src_vpage = virt_map_alloc(buffer_size);
+    virt_map_page_t *dst_vpage = virt_map_alloc(buffer_size);
 
     // Error handling: ensure both source and destination virtual pages are allocated.
     if (!src_vpage || !dst_vpage) {
-        kernel_panic("Cannot copy virtual memory address, unable to reserve vmem!");
+        pr_crit("Cannot copy virtual memory address, unable to reserve vmem!\n");
+        if (src_vpage) {
+            virt_unmap_pg(src_vpage);
+        }
+        if (dst_vpage) {
+            virt_unmap_pg(dst_vpage);
+        }
+        return -1;
     }
 
     // Loop to copy memory in chunks.
@@ -341,4 +393,133 @@ void virt_memcpy(mm_struct_t *dst_mm, uint32_t dst_vaddr, mm_struct_t *src_mm, u
     // Unmap the allocated virtual pages.
     virt_unmap_pg(src_vpage);
     virt_unmap_pg(dst_vpage);
+    return 0;
+}
+
+int is_vmalloc_addr(const void *addr)
+{
+    return ((uint32_t)addr >= VIRTUAL_MAPPING_BASE) && ((uint32_t)addr < VIRTUAL_MAPPING_BASE + VIRTUAL_MEMORY_SIZE);
+}
+
+void *pr_vmalloc(const char *file, const char *fun, int line, size_t size)
+{
+    if (size == 0) {
+        return NULL;
+    }
+    // Calculate the number of pages required to cover the given size.
+    uint32_t pages_count = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+
+    // Get the main page directory, the mapping is shared by all processes.
+    page_directory_t *main_pgd = paging_get_main_directory();
+    if (!main_pgd) {
+        pr_crit("Failed to get the main page directory\n");
+        return NULL;
+    }
+
+    // Reserve the virtual range.
+    virt_map_page_t *vpage = _alloc_virt_pages(pages_count);
+    if (!vpage) {
+        pr_crit("Failed to reserve %u virtual pages at %s:%d\n", pages_count, file, line);
+        return NULL;
+    }
+    uint32_t vaddr = VIRT_PAGE_TO_ADDRESS(vpage);
+
+    // Back each virtual page with its own physical page, taken from the high
+    // memory zone since we map it ourselves.
+    for (uint32_t i = 0; i < pages_count; ++i) {
+        page_t *page = alloc_pages(GFP_HIGHUSER, 0);
+        // The pages waiting for the purge might be what we are missing.
+        if (!page && virt_default_mapping.lazy_count) {
+            vmalloc_purge_lazy();
+            page = alloc_pages(GFP_HIGHUSER, 0);
+        }
+        if (!page) {
+            pr_crit("Failed to allocate page %u of %u at %s:%d\n", i, pages_count, file, line);
+            // Release what we have mapped so far. It is not known to the
+            // allocation profiler yet, so we do not go through vfree.
+            if (i > 0) {
+                mem_upd_vm_area(main_pgd, vaddr, 0, i * PAGE_SIZE, MM_GLOBAL);
+                paging_flush_tlb_all();
+            }
+            __vmalloc_release(vpage, vpage->page);
+            return NULL;
+        }
+        vpage[i].page = page;
+        mem_upd_vm_area(
+            main_pgd, vaddr + i * PAGE_SIZE, get_physical_address_from_page(page), PAGE_SIZE,
+            MM_PRESENT | MM_RW | MM_GLOBAL | MM_UPDADDR);
+    }
+    alloc_profiler_alloc(file, fun, line, (void *)vaddr, pages_count * PAGE_SIZE);
+    return (void *)vaddr;
+}
+
+void pr_vfree(const char *file, const char *fun, int line, void *addr)
+{
+    if (!addr) {
+        return;
+    }
+    // Check that the address was returned by vmalloc.
+    if (!is_vmalloc_addr(addr) || ((uint32_t)addr & (PAGE_SIZE - 1))) {
+        pr_crit("Attempt to vfree the invalid address 0x%p at %s:%d\n", addr, file, line);
+        return;
+    }
+    virt_map_page_t *vpage = VIRT_ADDRESS_TO_PAGE((uint32_t)addr);
+    if (!vpage->page) {
+        pr_crit(
+            "Attempt to vfree 0x%p, which is not allocated by vmalloc or already freed, at %s:%d\n", addr, file, line);
+        return;
+    }
+    alloc_profiler_free(addr);
+
+    // Get the main page directory.
+    page_directory_t *main_pgd = paging_get_main_directory();
+    if (!main_pgd) {
+        pr_crit("Failed to get the main page directory\n");
+        return;
+    }
+    uint32_t pages_count = 1U << vpage->bbpage.order;
+
+    // Remove the mappings, but do not flush the TLB now. Until the purge,
+    // neither the virtual range nor the physical pages are reused, so stale
+    // entries cannot reach anybody else's memory.
+    mem_upd_vm_area(main_pgd, (uint32_t)addr, 0, pages_count * PAGE_SIZE, MM_GLOBAL);
+
+    if (virt_default_mapping.lazy_count == VMALLOC_LAZY_MAX_AREAS) {
+        vmalloc_purge_lazy();
+    }
+    // Move the first physical page into the lazy list, so that a second vfree
+    // of the same address is rejected, instead of queueing the area twice.
+    vmalloc_lazy_area_t *area = &virt_default_mapping.lazy_areas[virt_default_mapping.lazy_count++];
+    area->vpage               = vpage;
+    area->page                = vpage->page;
+    vpage->page               = NULL;
+
+    virt_default_mapping.lazy_pages += pages_count;
+    if (virt_default_mapping.lazy_pages >= VMALLOC_LAZY_MAX_PAGES) {
+        vmalloc_purge_lazy();
+    }
+}
+
+void *pr_kvmalloc(const char *file, const char *fun, int line, size_t size)
+{
+    // Small buffers fit a slab object, without wasting a whole page.
+    if (size < PAGE_SIZE) {
+        return pr_kmalloc(file, fun, line, size);
+    }
+    // Larger ones do not need physically contiguous memory, nor the rounding
+    // to the next power of two.
+    void *ptr = pr_vmalloc(file, fun, line, size);
+    if (!ptr) {
+        ptr = pr_kmalloc(file, fun, line, size);
+    }
+    return ptr;
+}
+
+void pr_kvfree(const char *file, const char *fun, int line, void *addr)
+{
+    if (is_vmalloc_addr(addr)) {
+        pr_vfree(file, fun, line, addr);
+    } else {
+        pr_kfree(file, fun, line, addr);
+    }
 }
@@ -10,11 +10,14 @@
 #include "io/debug.h"                    // Include debugging functions.
 
 #include "assert.h"
+#include "hardware/acpi.h"
 #include "kernel.h"
 #include "list_head.h"
 #include "mem/buddy_system.h"
+#include "mem/oom.h"
 #include "mem/paging.h"
 #include "mem/zone_allocator.h"
+#include "stdio.h"
 #include "string.h"
 
 /// @brief Aligns the given address down to the nearest page boundary.
@@ -216,9 +219,10 @@ page_t *get_page_from_physical_address(uint32_t paddr)
 
 /// @brief Get the zone that contains a page frame.
 /// @param page A pointer to the page descriptor.
+/// @param nid Where we store the node of the zone, it can be NULL.
 /// @return A pointer to the zone containing the page, or NULL if the page is
 /// not within any zone.
-static zone_t *get_zone_from_page(page_t *page)
+static zone_t *get_zone_from_page(page_t *page, int *nid)
 {
     // Validate the input parameter.
     if (!page) {
@@ -226,10 +230,10 @@ static zone_t *get_zone_from_page(page_t *page)
         return NULL;
     }
 
-    // Iterate over all the zones in the contiguous page data structure.
-    for (int zone_index = 0; zone_index < memory.page_data->nr_zones; zone_index++) {
+    // Iterate over all the zones of all the nodes.
+    for (int index = 0; index < (memory.nr_nodes * __MAX_NR_ZONES); index++) {
         // Get the zone at the given index.
-        zone_t *zone = &memory.page_data->node_zones[zone_index];
+        zone_t *zone = &memory.page_data[index / __MAX_NR_ZONES].node_zones[index % __MAX_NR_ZONES];
 
         // Get the first and last page of the zone. You might be inclide to
         // multiply by the sizeof(page_t), but that is wrong.
@@ -241,6 +245,9 @@ static zone_t *get_zone_from_page(page_t *page)
 
         // Return the zone if the page is within its range.
         if ((page >= first_page) && (page < last_page)) {
+            if (nid) {
+                *nid = index / __MAX_NR_ZONES;
+            }
             return zone;
         }
     }
@@ -251,16 +258,16 @@ static zone_t *get_zone_from_page(page_t *page)
     return NULL;
 }
 
-/// @brief Get a zone from the specified GFP mask.
+/// @brief Get the type of zone from the specified GFP mask.
 /// @param gfp_mask GFP flags indicating the type of memory allocation request.
-/// @return A pointer to the requested zone, or NULL if the gfp_mask is not
-/// recognized.
-static zone_t *get_zone_from_flags(gfp_t gfp_mask)
+/// @return The index of the zone inside each node, or -1 if the gfp_mask is
+/// not recognized.
+static int get_zone_index_from_flags(gfp_t gfp_mask)
 {
     // Ensure that page_data is initialized and valid.
     if (!memory.page_data) {
         pr_crit("page_data is NULL.\n");
-        return NULL;
+        return -1;
     }
 
     // Determine the appropriate zone based on the given GFP mask.
@@ -271,41 +278,48 @@ static zone_t *get_zone_from_flags(gfp_t gfp_mask)
     case GFP_NOIO:
     case GFP_NOWAIT:
         // Return the normal memory zone.
-        return &memory.page_data->node_zones[ZONE_NORMAL];
+        return ZONE_NORMAL;
 
     case GFP_HIGHUSER:
         // Return the high memory zone.
-        return &memory.page_data->node_zones[ZONE_HIGHMEM];
+        return ZONE_HIGHMEM;
 
     default:
-        // If the gfp_mask does not match any recognized flags, log an error and return NULL.
+        // If the gfp_mask does not match any recognized flags, log an error and return -1.
         pr_crit("Unrecognized gfp_mask: %u.\n", gfp_mask);
-        return NULL;
+        return -1;
     }
 }
 
-/// @brief Checks if the specified memory zone is clean (i.e., all pages are free).
+/// @brief Checks if the specified memory zones are clean (i.e., all pages are free).
 /// @param gfp_mask GFP flags indicating the type of memory.
 /// @return 1 if the memory is clean (all pages are free), 0 if there is an error or the memory is not clean.
 static inline int is_memory_clean(gfp_t gfp_mask)
 {
-    // Get the zone corresponding to the given GFP mask.
-    zone_t *zone = get_zone_from_flags(gfp_mask);
+    // Get the type of zone corresponding to the given GFP mask.
+    int zone_index = get_zone_index_from_flags(gfp_mask);
     // Ensure the zone is valid.
-    if (!zone) {
+    if (zone_index < 0) {
         pr_emerg("Failed to get zone from GFP mask.\n");
         return 0;
     }
-    // Check if the total size of the zone matches the free space in the buddy system.
-    unsigned long free_space = buddy_system_get_free_space(&zone->buddy_system);
-    if (zone->total_size != free_space) {
-        pr_crit("Memory zone check failed for zone '%s'.\n", zone->name);
-        pr_crit("Expected free space %lu bytes, but found %lu bytes.\n", zone->total_size, free_space);
-        pr_crit("Buddy system state for zone '%s':\n", zone->name);
-        char buddy_status[512] = {0};
-        buddy_system_to_string(&zone->buddy_system, buddy_status, sizeof(buddy_status));
-        pr_crit("    %s\n", buddy_status);
-        return 0;
+    // Check the zone of each node.
+    for (int nid = 0; nid < memory.nr_nodes; ++nid) {
+        zone_t *zone = &memory.page_data[nid].node_zones[zone_index];
+        if (zone->num_pages == 0) {
+            continue;
+        }
+        // Check if the total size of the zone matches the free space in the buddy system.
+        unsigned long free_space = buddy_system_get_free_space(&zone->buddy_system);
+        if (zone->total_size != free_space) {
+            pr_crit("Memory zone check failed for zone '%s' of node %d.\n", zone->name, nid);
+            pr_crit("Expected free space %lu bytes, but found %lu bytes.\n", zone->total_size, free_space);
+            pr_crit("Buddy system state for zone '%s':\n", zone->name);
+            char buddy_status[512] = {0};
+            buddy_system_to_string(&zone->buddy_system, buddy_status, sizeof(buddy_status));
+            pr_crit("    %s\n", buddy_status);
+            return 0;
+        }
     }
     return 1;
 }
@@ -314,16 +328,6 @@ static inline int is_memory_clean(gfp_t gfp_mask)
 /// @return 1 on success, 0 on failure.
 static int pmm_check(void)
 {
-    zone_t *zone_normal = get_zone_from_flags(GFP_KERNEL);
-    if (!zone_normal) {
-        pr_crit("Failed to retrieve the zone_normal.\n");
-        return 0;
-    }
-    zone_t *zone_highmem = get_zone_from_flags(GFP_HIGHUSER);
-    if (!zone_highmem) {
-        pr_crit("Failed to retrieve the zone_highmem.\n");
-        return 0;
-    }
     // Verify memory state.
     if (!is_memory_clean(GFP_KERNEL)) {
         pr_err("Memory not clean.\n");
@@ -336,10 +340,13 @@ static int pmm_check(void)
 
     char buddy_status[512] = {0};
     pr_notice("Zones status before testing:\n");
-    buddy_system_to_string(&zone_normal->buddy_system, buddy_status, sizeof(buddy_status));
-    pr_notice("    %s\n", buddy_status);
-    buddy_system_to_string(&zone_highmem->buddy_system, buddy_status, sizeof(buddy_status));
-    pr_notice("    %s\n", buddy_status);
+    for (int index = 0; index < (memory.nr_nodes * __MAX_NR_ZONES); index++) {
+        zone_t *zone = &memory.page_data[index / __MAX_NR_ZONES].node_zones[index % __MAX_NR_ZONES];
+        if (zone->num_pages > 0) {
+            buddy_system_to_string(&zone->buddy_system, buddy_status, sizeof(buddy_status));
+            pr_notice("    %s\n", buddy_status);
+        }
+    }
 
     pr_notice("\tStep 1: Testing allocation in kernel-space...\n");
     {
@@ -429,21 +436,50 @@ static int pmm_check(void)
             return 0;
         }
     }
+    pr_notice("\tStep 5: Testing allocation on each node...\n");
+    {
+        for (int nid = 0; nid < memory.nr_nodes; nid++) {
+            // Allocate a single page with GFP_KERNEL, preferring the node.
+            page_t *page = alloc_pages_node(nid, GFP_KERNEL, 0);
+            if (!page) {
+                pr_err("Page allocation failed.\n");
+                return 0;
+            }
+            // A node with lowmem must provide the page itself.
+            if ((memory.page_data[nid].node_zones[ZONE_NORMAL].num_pages > 0) && (page_to_nid(page) != nid)) {
+                pr_err("Page allocated from node %d instead of node %d.\n", page_to_nid(page), nid);
+                free_pages(page);
+                return 0;
+            }
+            // Free the allocated page.
+            if (free_pages(page) < 0) {
+                pr_err("Page deallocation failed.\n");
+                return 0;
+            }
+        }
+        // Verify memory state after deallocation.
+        if (!is_memory_clean(GFP_KERNEL)) {
+            pr_err("Test failed: Memory not clean.\n");
+            return 0;
+        }
+    }
     return 1;
 }
 
 /// @brief Initializes the memory attributes for a specified zone.
+/// @param pgdat The node of the zone.
 /// @param name The zone's name.
 /// @param zone_index The zone's index, which must be valid within the number of zones.
 /// @param adr_from The lowest address of the zone (inclusive).
-/// @param adr_to The highest address of the zone (exclusive).
+/// @param adr_to The highest address of the zone (exclusive), equal to
+/// adr_from if the node has no memory in this zone.
 /// @return 1 on success, 0 on error.
-static int zone_init(char *name, int zone_index, uint32_t adr_from, uint32_t adr_to)
+static int zone_init(pg_data_t *pgdat, char *name, int zone_index, uint32_t adr_from, uint32_t adr_to)
 {
-    // Ensure that the provided addresses are valid: adr_from must be less than adr_to.
-    if (adr_from >= adr_to) {
+    // Ensure that the provided addresses are valid: adr_from must not be greater than adr_to.
+    if (adr_from > adr_to) {
         pr_crit(
-            "Invalid block addresses: adr_from (%u) must be less than adr_to "
+            "Invalid block addresses: adr_from (%u) must not be greater than adr_to "
             "(%u).\n",
             adr_from, adr_to);
         return 0;
@@ -462,13 +498,13 @@ static int zone_init(char *name, int zone_index, uint32_t adr_from, uint32_t adr
     }
 
     // Ensure that the zone_index is within the valid range.
-    if ((zone_index < 0) || (zone_index >= memory.page_data->nr_zones)) {
-        pr_crit("The zone_index (%d) is out of bounds (max: %d).\n", zone_index, memory.page_data->nr_zones - 1);
+    if ((zone_index < 0) || (zone_index >= pgdat->nr_zones)) {
+        pr_crit("The zone_index (%d) is out of bounds (max: %d).\n", zone_index, pgdat->nr_zones - 1);
         return 0;
     }
 
     // Take the zone_t structure that corresponds to the zone_index.
-    zone_t *zone = &memory.page_data->node_zones[zone_index];
+    zone_t *zone = &pgdat->node_zones[zone_index];
 
     // Ensure that the zone was retrieved successfully.
     if (!zone) {
@@ -490,6 +526,11 @@ static int zone_init(char *name, int zone_index, uint32_t adr_from, uint32_t adr
     zone->zone_start_pfn = first_page_frame;                  // Set the starting page frame number.
     zone->total_size     = adr_to - adr_from;                 // Save the total size of the zone in bytes.
 
+    // The node has no memory in this zone, there is nothing to manage.
+    if (num_page_frames == 0) {
+        return 1;
+    }
+
     // Clear the page structures in the memory map.
     memset(zone->zone_mem_map, 0, zone->num_pages * sizeof(page_t));
 
@@ -600,7 +641,75 @@ ssize_t pmmngr_initialize_pages(const boot_info_t *boot_info, size_t offset)
     return (ssize_t)mem_usage;
 }
 
-/// @brief Initializes the contiguous page data node.
+/// @brief Computes the physical memory of each node, and the order in which
+/// the allocations preferring it try the other nodes.
+/// @param boot_info Boot information.
+static void __initialize_nodes(const boot_info_t *boot_info)
+{
+    uint32_t node_start[MAX_NUMNODES];
+    // Each node starts with its first range of memory.
+    for (int nid = 0; nid < memory.nr_nodes; ++nid) {
+        node_start[nid] = (memory.nr_nodes > 1) ? memory.mem_size : 0;
+        for (unsigned int i = 0; (memory.nr_nodes > 1) && (i < boot_info->numa_nr_ranges); ++i) {
+            const boot_numa_range_t *range = &boot_info->numa_ranges[i];
+            if ((range->node == nid) && (range->phy_start < node_start[nid])) {
+                node_start[nid] = range->phy_start;
+            }
+        }
+    }
+    for (int nid = 0; nid < memory.nr_nodes; ++nid) {
+        pg_data_t *pgdat = &memory.page_data[nid];
+        // Each node ends where the next one starts, the first one also takes
+        // the memory below it. A node without memory has an empty range.
+        uint32_t start = node_start[nid], end = memory.mem_size;
+        int first      = 1;
+        for (int other = 0; other < memory.nr_nodes; ++other) {
+            if ((node_start[other] < start) || ((node_start[other] == start) && (other < nid))) {
+                first = 0;
+            }
+            if ((node_start[other] > start) && (node_start[other] < end)) {
+                end = node_start[other];
+            }
+            if ((node_start[other] == start) && (other < nid)) {
+                end = start;
+            }
+        }
+        if (first) {
+            start = 0;
+        }
+        start = min(MIN_PAGE_ALIGN(start), MIN_PAGE_ALIGN(end));
+        end   = MIN_PAGE_ALIGN(end);
+
+        pgdat->nr_zones         = __MAX_NR_ZONES;                      // Number of memory zones.
+        pgdat->node_id          = nid;                                 // Node ID.
+        pgdat->node_start_paddr = start;                               // Physical address of the first page.
+        pgdat->node_start_mapnr = start / PAGE_SIZE;                   // Start index in mem_map.
+        pgdat->node_size        = (end - start) / PAGE_SIZE;           // Total number of pages.
+        pgdat->node_mem_map     = memory.mem_map + (start / PAGE_SIZE); // Corresponding to mem_map.
+        pgdat->node_next        = (nid + 1 < memory.nr_nodes) ? (pgdat + 1) : NULL;
+
+        // Without the SLIT, all the other nodes are equally far.
+        for (int other = 0; other < memory.nr_nodes; ++other) {
+            pgdat->node_distance[other] = (memory.nr_nodes > 1) ? boot_info->numa_distance[nid][other]
+                                                                 : ACPI_LOCAL_DISTANCE;
+        }
+        // Sort the nodes by distance, the node itself comes first.
+        for (int i = 0; i < memory.nr_nodes; ++i) {
+            int other = (i == 0) ? nid : ((i <= nid) ? (i - 1) : i);
+            int j     = i;
+            while ((j > 1) && (pgdat->node_distance[pgdat->node_fallback[j - 1]] > pgdat->node_distance[other])) {
+                pgdat->node_fallback[j] = pgdat->node_fallback[j - 1];
+                --j;
+            }
+            pgdat->node_fallback[j] = other;
+        }
+    }
+    // The allocations prefer the node of the processor.
+    memory.local_node      = (boot_info->numa_cpu_node < memory.nr_nodes) ? boot_info->numa_cpu_node : 0;
+    memory.interleave_node = memory.nr_nodes - 1;
+}
+
+/// @brief Initializes the page data of the nodes.
 /// @param boot_info Boot information.
 /// @param offset Virtual memory offset from the base address.
 /// @return int Returns the amount of memory used on success, or -1 on error.
@@ -612,36 +721,53 @@ ssize_t pmmngr_initialize_page_data(const boot_info_t *boot_info, size_t offset)
         return -1;
     }
 
-    pr_debug("Initializing page_data node...\n");
+    pr_debug("Initializing page_data nodes...\n");
+
+    // One node, unless the firmware describes more (see the ACPI SRAT).
+    memory.nr_nodes = 1;
+    if ((boot_info->numa_nodes > 1) && (boot_info->numa_nodes <= MAX_NUMNODES)) {
+        memory.nr_nodes = boot_info->numa_nodes;
+    }
 
     // Calculate the virtual start address for page_data.
     uintptr_t virt_start = boot_info->lowmem_virt_start + offset;
     // Compute the memory usage.
-    size_t mem_usage     = sizeof(pg_data_t);
+    size_t mem_usage     = sizeof(pg_data_t) * memory.nr_nodes;
     // Get the pointer to where we want to place the structure.
     memory.page_data     = (pg_data_t *)virt_start;
 
-    // Initialize the page_data fields.
-    memory.page_data->nr_zones         = __MAX_NR_ZONES;     // Number of memory zones.
-    memory.page_data->node_id          = 0;                  // Node ID (0 for UMA systems).
-    memory.page_data->node_mem_map     = memory.mem_map;     // Corresponding to mem_map.
-    memory.page_data->node_next        = NULL;               // No next node in UMA.
-    memory.page_data->node_size        = memory.mem_map_num; // Total number of pages.
-    memory.page_data->node_start_mapnr = 0;                  // Start index in mem_map.
-    memory.page_data->node_start_paddr = 0x0;                // Physical address of the first page.
-
     // Ensure the memory usage does not exceed LowMem.
-
     if (virt_start + mem_usage > boot_info->lowmem_virt_end) {
         pr_crit("Insufficient LowMem to allocate page_data\n");
         return -1;
     }
 
-    pr_debug("page_data node initialized: %p\n", memory.page_data);
+    // Initialize the page_data fields.
+    memset(memory.page_data, 0, mem_usage);
+    __initialize_nodes(boot_info);
+
+    pr_debug("page_data nodes initialized: %p (%d nodes)\n", memory.page_data, memory.nr_nodes);
 
     return (ssize_t)mem_usage;
 }
 
+/// @brief Clamps an address inside a memory zone, where the nodes split it.
+/// The address is rounded down so that the part of the zone before it is
+/// made of blocks of the largest order, as the buddy system requires.
+/// @param mem_zone The memory zone.
+/// @param addr The address.
+/// @return The address where the zone is split.
+static inline uint32_t __zone_split_address(const memory_zone_t *mem_zone, uint32_t addr)
+{
+    if (addr <= mem_zone->start_addr) {
+        return mem_zone->start_addr;
+    }
+    if (addr >= mem_zone->end_addr) {
+        return mem_zone->end_addr;
+    }
+    return mem_zone->start_addr + MIN_ORDER_ALIGN(addr - mem_zone->start_addr);
+}
+
 int pmmngr_init(boot_info_t *boot_info)
 {
     // Place the pages in memory.
@@ -682,11 +808,21 @@ int pmmngr_init(boot_info_t *boot_info)
     // Calculate the maximum page index (end of HighMem).
     memory.page_index_max = (memory.high_mem.end_addr / PAGE_SIZE) - 1;
 
-    if (!zone_init("Normal", ZONE_NORMAL, memory.low_mem.start_addr, memory.low_mem.end_addr)) {
-        return 0;
-    }
-    if (!zone_init("HighMem", ZONE_HIGHMEM, memory.high_mem.start_addr, memory.high_mem.end_addr)) {
-        return 0;
+    // Each node takes the part of the zones inside its memory.
+    for (int nid = 0; nid < memory.nr_nodes; ++nid) {
+        pg_data_t *pgdat    = &memory.page_data[nid];
+        uint32_t node_start = pgdat->node_start_paddr;
+        uint32_t node_end   = node_start + (pgdat->node_size * PAGE_SIZE);
+        if (!zone_init(
+                pgdat, "Normal", ZONE_NORMAL, __zone_split_address(&memory.low_mem, node_start),
+                __zone_split_address(&memory.low_mem, node_end))) {
+            return 0;
+        }
+        if (!zone_init(
+                pgdat, "HighMem", ZONE_HIGHMEM, __zone_split_address(&memory.high_mem, node_start),
+                __zone_split_address(&memory.high_mem, node_end))) {
+            return 0;
+        }
     }
 
     __print_memory_info(LOGLEVEL_NOTICE, &memory);
@@ -694,22 +830,80 @@ int pmmngr_init(boot_info_t *boot_info)
     return pmm_check();
 }
 
+/// @brief Allocates the page frames from the zone of the given node, or from
+/// the same zone of the nearest nodes.
+/// @param nid The preferred node.
+/// @param zone_index The type of zone.
+/// @param order The logarithm of the size of the page frame.
+/// @param zone Where we store the zone which provided the page frames.
+/// @return The buddy system page of the first page frame, or NULL.
+static inline bb_page_t *__alloc_pages_fallback(int nid, int zone_index, uint32_t order, zone_t **zone)
+{
+    pg_data_t *preferred = &memory.page_data[nid];
+    for (int i = 0; i < memory.nr_nodes; ++i) {
+        pg_data_t *pgdat = &memory.page_data[preferred->node_fallback[i]];
+        *zone            = &pgdat->node_zones[zone_index];
+        if ((*zone)->num_pages == 0) {
+            continue;
+        }
+        bb_page_t *bbpage = bb_alloc_pages(&(*zone)->buddy_system, order);
+        if (bbpage) {
+            // Keep track of how well the allocations match the preferred node.
+            if (pgdat == preferred) {
+                ++pgdat->numa_hit;
+            } else {
+                ++pgdat->numa_miss;
+                ++preferred->numa_foreign;
+            }
+            return bbpage;
+        }
+    }
+    return NULL;
+}
+
 page_t *pr_alloc_pages(const char *file, const char *func, int line, gfp_t gfp_mask, uint32_t order)
+{
+    return pr_alloc_pages_node(file, func, line, NUMA_NO_NODE, gfp_mask, order);
+}
+
+page_t *pr_alloc_pages_interleave(const char *file, const char *func, int line, gfp_t gfp_mask, uint32_t order)
+{
+    // Prefer the node after the one of the previous interleaved allocation.
+    int nid                = (memory.interleave_node + 1) % memory.nr_nodes;
+    memory.interleave_node = nid;
+    page_t *page           = pr_alloc_pages_node(file, func, line, nid, gfp_mask, order);
+    if (page && (page_to_nid(page) == nid)) {
+        ++memory.page_data[nid].interleave_hit;
+    }
+    return page;
+}
+
+page_t *pr_alloc_pages_node(const char *file, const char *func, int line, int nid, gfp_t gfp_mask, uint32_t order)
 {
     // Calculate the block size based on the order.
     uint32_t block_size = 1UL << order;
 
-    // Get the zone corresponding to the given GFP mask.
-    zone_t *zone = get_zone_from_flags(gfp_mask);
+    // Get the type of zone corresponding to the given GFP mask.
+    int zone_index = get_zone_index_from_flags(gfp_mask);
 
     // Ensure the zone is valid.
-    if (!zone) {
+    if (zone_index < 0) {
         pr_emerg("Failed to get zone from GFP mask.\n");
         return NULL; // Return NULL to indicate failure.
     }
 
-    // Allocate a page from the buddy system of the zone.
-    bb_page_t *bbpage = bb_alloc_pages(&zone->buddy_system, order);
+    // By default, prefer the node of the processor.
+    if ((nid < 0) || (nid >= memory.nr_nodes)) {
+        nid = memory.local_node;
+    }
+
+    // Allocate a page from the buddy system of the zone, if we run out of
+    // memory retry as long as the OOM handling manages to reclaim something.
+    zone_t *zone;
+    bb_page_t *bbpage = __alloc_pages_fallback(nid, zone_index, order, &zone);
+    while (!bbpage && out_of_memory(gfp_mask, order)) {
+        bbpage = __alloc_pages_fallback(nid, zone_index, order, &zone);
+    }
 
     // Ensure the allocation was successful.
     if (!bbpage) {
@@ -734,6 +928,9 @@ page_t *pr_alloc_pages(const char *file, const char *func, int line, gfp_t gfp_m
     // Decrement the number of free pages in the zone.
     zone->free_pages -= block_size;
 
+    // Notify the change of the memory pressure, if any.
+    mempressure_update();
+
 #ifdef ENABLE_PAGE_TRACE
     pr_notice("BS-A: (page: %p order: %d)\n", page, order);
 #endif
@@ -744,7 +941,7 @@ page_t *pr_alloc_pages(const char *file, const char *func, int line, gfp_t gfp_m
 int pr_free_pages(const char *file, const char *func, int line, page_t *page)
 {
     // Get the zone that contains the given page.
-    zone_t *zone = get_zone_from_page(page);
+    zone_t *zone = get_zone_from_page(page, NULL);
 
     // Ensure the zone retrieval was successful.
     if (!zone) {
@@ -773,6 +970,9 @@ int pr_free_pages(const char *file, const char *func, int line, page_t *page)
     // Increment the number of free pages in the zone.
     zone->free_pages += block_size;
 
+    // Notify the change of the memory pressure, if any.
+    mempressure_update();
+
 #ifdef ENABLE_PAGE_TRACE
     pr_notice("BS-F: (page: %p order: %d)\n", page, order);
 #endif
@@ -845,61 +1045,113 @@ int free_pages_lowmem(uint32_t vaddr)
     return 0;
 }
 
-unsigned long get_zone_total_space(gfp_t gfp_mask)
+/// @brief Sums a quantity over the zones of all the nodes corresponding to the given GFP mask.
+/// @param gfp_mask The GFP mask specifying the allocation constraints.
+/// @param space The function returning the quantity for a buddy system.
+/// @return The sum, or 0 if the zones cannot be retrieved.
+static inline unsigned long __get_zones_space(gfp_t gfp_mask, unsigned long (*space)(const bb_instance_t *))
 {
-    // Get the zone corresponding to the given GFP mask.
-    zone_t *zone = get_zone_from_flags(gfp_mask);
+    // Get the type of zone corresponding to the given GFP mask.
+    int zone_index = get_zone_index_from_flags(gfp_mask);
 
     // Ensure the zone retrieval was successful.
-    if (!zone) {
+    if (zone_index < 0) {
         pr_emerg("Cannot retrieve the correct zone for GFP mask: 0x%x.\n", gfp_mask);
         return 0; // Return 0 to indicate failure.
     }
 
-    // Return the total space of the zone.
-    return buddy_system_get_total_space(&zone->buddy_system);
+    unsigned long total = 0;
+    for (int nid = 0; nid < memory.nr_nodes; ++nid) {
+        zone_t *zone = &memory.page_data[nid].node_zones[zone_index];
+        if (zone->num_pages > 0) {
+            total += space(&zone->buddy_system);
+        }
+    }
+    return total;
 }
 
-unsigned long get_zone_free_space(gfp_t gfp_mask)
+unsigned long get_zone_total_space(gfp_t gfp_mask)
 {
-    // Get the zone corresponding to the given GFP mask.
-    zone_t *zone = get_zone_from_flags(gfp_mask);
-
-    // Ensure the zone retrieval was successful.
-    if (!zone) {
-        pr_emerg("Cannot retrieve the correct zone for GFP mask: 0x%x.\n", gfp_mask);
-        return 0; // Return 0 to indicate failure.
-    }
+    // Return the total space of the zones.
+    return __get_zones_space(gfp_mask, buddy_system_get_total_space);
+}
 
-    // Return the free space of the zone.
-    return buddy_system_get_free_space(&zone->buddy_system);
+unsigned long get_zone_free_space(gfp_t gfp_mask)
+{
+    // Return the free space of the zones.
+    return __get_zones_space(gfp_mask, buddy_system_get_free_space);
 }
 
 unsigned long get_zone_cached_space(gfp_t gfp_mask)
 {
-    // Get the zone corresponding to the given GFP mask.
-    zone_t *zone = get_zone_from_flags(gfp_mask);
+    // Return the cached space of the zones.
+    return __get_zones_space(gfp_mask, buddy_system_get_cached_space);
+}
+
+int get_zone_buddy_system_status(gfp_t gfp_mask, char *buffer, size_t bufsize)
+{
+    // Get the type of zone corresponding to the given GFP mask.
+    int zone_index = get_zone_index_from_flags(gfp_mask);
 
     // Ensure the zone retrieval was successful.
-    if (!zone) {
+    if (zone_index < 0) {
         pr_emerg("Cannot retrieve the correct zone for GFP mask: 0x%x.\n", gfp_mask);
         return 0; // Return 0 to indicate failure.
     }
 
-    // Return the cached space of the zone.
-    return buddy_system_get_cached_space(&zone->buddy_system);
+    // With more nodes, the status of each one is prefixed by its number.
+    int written = 0;
+    for (int nid = 0; (nid < memory.nr_nodes) && (written < (int)bufsize); ++nid) {
+        zone_t *zone = &memory.page_data[nid].node_zones[zone_index];
+        if (zone->num_pages == 0) {
+            continue;
+        }
+        if (memory.nr_nodes > 1) {
+            written += snprintf(buffer + written, bufsize - written, "%s[node %d] ", written ? " " : "", nid);
+        }
+        if (written < (int)bufsize) {
+            written += buddy_system_to_string(&zone->buddy_system, buffer + written, bufsize - written);
+        }
+    }
+    return written;
 }
 
-int get_zone_buddy_system_status(gfp_t gfp_mask, char *buffer, size_t bufsize)
+int page_to_nid(page_t *page)
 {
-    // Get the zone corresponding to the given GFP mask.
-    zone_t *zone = get_zone_from_flags(gfp_mask);
+    int nid = -1;
+    get_zone_from_page(page, &nid);
+    return nid;
+}
 
-    // Ensure the zone retrieval was successful.
-    if (!zone) {
-        pr_emerg("Cannot retrieve the correct zone for GFP mask: 0x%x.\n", gfp_mask);
-        return 0; // Return 0 to indicate failure.
+int numa_print_stats(char *buffer, size_t bufsize)
+{
+    int written = 0;
+    for (int nid = 0; (nid < memory.nr_nodes) && (written < (int)bufsize); ++nid) {
+        pg_data_t *pgdat = &memory.page_data[nid];
+        zone_t *normal   = &pgdat->node_zones[ZONE_NORMAL];
+        zone_t *highmem  = &pgdat->node_zones[ZONE_HIGHMEM];
+        written += snprintf(
+            buffer + written, bufsize - written,
+            "Node %d%s\n"
+            "    Memory         : 0x%08lx to 0x%08lx\n"
+            "    Normal         : %8lu Kb total, %8lu Kb free\n"
+            "    HighMem        : %8lu Kb total, %8lu Kb free\n"
+            "    numa_hit       : %lu\n"
+            "    numa_miss      : %lu\n"
+            "    numa_foreign   : %lu\n"
+            "    interleave_hit : %lu\n"
+            "    Distances      :",
+            nid, (nid == memory.local_node) ? " (local)" : "", pgdat->node_start_paddr,
+            pgdat->node_start_paddr + (pgdat->node_size * PAGE_SIZE), (normal->num_pages * PAGE_SIZE) / K,
+            (normal->free_pages * PAGE_SIZE) / K, (highmem->num_pages * PAGE_SIZE) / K,
+            (highmem->free_pages * PAGE_SIZE) / K, pgdat->numa_hit, pgdat->numa_miss, pgdat->numa_foreign,
+            pgdat->interleave_hit);
+        for (int other = 0; (other < memory.nr_nodes) && (written < (int)bufsize); ++other) {
+            written += snprintf(buffer + written, bufsize - written, " %3u", pgdat->node_distance[other]);
+        }
+        if (written < (int)bufsize) {
+            written += snprintf(buffer + written, bufsize - written, "\n");
+        }
     }
-
-    return buddy_system_to_string(&zone->buddy_system, buffer, bufsize);
+    return min(written, (int)bufsize - 1);
 }
@@ -49,6 +49,24 @@ multiboot_memory_map_t *mmap_next_entry_of_type(multiboot_info_t *info, multiboo
     return entry;
 }
 
+uint32_t mmap_available_above_4g(multiboot_info_t *info)
+{
+    const uint64_t limit = 1ULL << 32U;
+    uint64_t total       = 0;
+    if (!mmap_first_entry(info)) {
+        return 0;
+    }
+    for (multiboot_memory_map_t *entry = mmap_first_entry_of_type(info, MULTIBOOT_MEMORY_AVAILABLE); entry;
+         entry = mmap_next_entry_of_type(info, entry, MULTIBOOT_MEMORY_AVAILABLE)) {
+        uint64_t base   = ((uint64_t)entry->base_addr_high << 32U) | entry->base_addr_low;
+        uint64_t length = ((uint64_t)entry->length_high << 32U) | entry->length_low;
+        if ((base + length) > limit) {
+            total += (base + length) - ((base > limit) ? base : limit);
+        }
+    }
+    return (uint32_t)(total >> 10U);
+}
+
 char *mmap_type_name(multiboot_memory_map_t *entry)
 {
     if (entry->type == MULTIBOOT_MEMORY_AVAILABLE) {
@@ -18,6 +18,7 @@
 #include "hardware/timer.h"
 #include "klib/stack_helper.h"
 #include "libgen.h"
+#include "mem/zone_allocator.h"
 #include "process/pid_manager.h"
 #include "process/prio.h"
 #include "process/process.h"
@@ -31,6 +32,10 @@
 /// Cache for creating the task structs.
 static kmem_cache_t *task_struct_cache;
 
+/// @brief The first instructions executed by a new task (in switch.S), which
+/// return to user mode with the registers placed on its kernel stack.
+extern void ret_from_fork(void);
+
 /// @brief Counts the number of arguments.
 /// @param args the array of arguments, it must be NULL terminated.
 /// @return the number of arguments.
@@ -230,6 +235,12 @@ close_and_return:
 /// @return pointer to the newly allocated task.
 static inline task_struct *__alloc_task(task_struct *source, task_struct *parent, const char *name)
 {
+    // Allocate the kernel stack first, so that there is nothing to undo if it fails.
+    uint32_t kernel_stack = alloc_pages_lowmem(GFP_KERNEL, TASK_KERNEL_STACK_ORDER);
+    if (!kernel_stack) {
+        pr_err("Failed to allocate the kernel stack of `%s`.\n", name);
+        return NULL;
+    }
     // Create a new task_struct.
     task_struct *proc = kmem_cache_alloc(task_struct_cache, GFP_KERNEL);
     // Clear the memory.
@@ -252,6 +263,8 @@ static inline task_struct *__alloc_task(task_struct *source, task_struct *parent
     list_head_init(&proc->children);
     // Initialize the sibling list_head.
     list_head_init(&proc->sibling);
+    // Initialize the queue used to wait for the children.
+    wait_queue_head_init(&proc->wait_chldexit);
     // If we have a parent, set the sibling child relation.
     if (parent) {
         // Set the new_process as child of current.
@@ -260,6 +273,9 @@ static inline task_struct *__alloc_task(task_struct *source, task_struct *parent
     if (source) {
         memcpy(&proc->thread, &source->thread, sizeof(thread_struct_t));
     }
+    // The kernel stack is the only part of the thread which is not copied.
+    proc->thread.kernel_stack   = kernel_stack;
+    proc->thread.esp            = 0;
     // Set the statistics of the process.
     proc->uid                   = 0;
     proc->ruid                  = 0;
@@ -282,8 +298,28 @@ static inline task_struct *__alloc_task(task_struct *source, task_struct *parent
     proc->se.next_period        = 0;
     proc->se.worst_case_exec    = 0;
     proc->se.utilization_factor = 0;
+    // Inherit the policy of the source, but the periodic parameters are its own.
+    if (source && (source->se.policy != SCHED_DEADLINE)) {
+        proc->se.policy      = source->se.policy;
+        proc->se.rt_priority = source->se.rt_priority;
+    } else {
+        proc->se.policy      = SCHED_NORMAL;
+        proc->se.rt_priority = 0;
+    }
+    proc->se.sched_class = NULL;
+    list_head_init(&proc->se.class_list);
+    // The OOM adjustment is inherited too.
+    proc->oom_score_adj = source ? source->oom_score_adj : 0;
     // Initialize the exit code of the process.
     proc->exit_code             = 0;
+    // Reset the accounting of the CPU time and of the context switches.
+    proc->utime  = 0;
+    proc->stime  = 0;
+    proc->cutime = 0;
+    proc->cstime = 0;
+    proc->nvcsw  = 0;
+    proc->nivcsw = 0;
+    ++kernel_cpustat.forks;
     // Copy the name.
     if (name) {
         strcpy(proc->name, name);
@@ -316,7 +352,9 @@ static inline task_struct *__alloc_task(task_struct *source, task_struct *parent
     sigemptyset(&proc->pending.signal);
 
     // Initalize real_timer for intervals
-    proc->real_timer = NULL;
+    proc->real_timer     = NULL;
+    // The timer slack is inherited.
+    proc->timer_slack_ns = source ? source->timer_slack_ns : 0;
 
     // Set the default terminal options.
     proc->termios = (termios_t){
@@ -327,6 +365,25 @@ static inline task_struct *__alloc_task(task_struct *source, task_struct *parent
     return proc;
 }
 
+/// @brief Prepares the kernel stack of a new task, so that the first switch to
+/// it returns to user mode with the registers stored in its thread.
+/// @param task the new task.
+static inline void __prepare_kernel_stack(task_struct *task)
+{
+    // The registers go where the interrupt handlers leave them, at the top.
+    pt_regs *frame   = (pt_regs *)(task->thread.kernel_stack + TASK_KERNEL_STACK_SIZE - sizeof(pt_regs));
+    *frame           = task->thread.regs;
+    // Below them, what switch_to pops: the registers it saves (ebp, ebx, esi
+    // and edi), and its return address.
+    uintptr_t *esp   = (uintptr_t *)frame;
+    *(--esp)         = (uintptr_t)ret_from_fork;
+    *(--esp)         = 0;
+    *(--esp)         = 0;
+    *(--esp)         = 0;
+    *(--esp)         = 0;
+    task->thread.esp = (uintptr_t)esp;
+}
+
 int init_tasking(void)
 {
     if ((task_struct_cache = KMEM_CREATE(task_struct)) == NULL) {
@@ -341,6 +398,9 @@ int process_create_init(const char *path)
 
     // Allocate the memory for the process.
     init_process = __alloc_task(NULL, NULL, "init");
+    if (init_process == NULL) {
+        return 1;
+    }
 
     // Active the current process.
     scheduler_enqueue_task(init_process);
@@ -504,13 +564,18 @@ pid_t sys_fork(pt_regs *f)
     // to the ones of the child process, except for eax.
     scheduler_store_context(f, current);
     // Allocate the memory for the process.
-    task_struct *proc        = __alloc_task(current, current, current->name);
+    task_struct *proc = __alloc_task(current, current, current->name);
+    if (proc == NULL) {
+        return -ENOMEM;
+    }
     // Copy the father's stack, memory, heap etc... to the child process
     proc->mm                 = clone_process_image(current->mm);
     // Set the eax as 0, to indicate the child process
     proc->thread.regs.eax    = 0;
     // Enable the interrupts.
     proc->thread.regs.eflags = proc->thread.regs.eflags | EFLAG_IF;
+    // The child starts by returning to user mode with these registers.
+    __prepare_kernel_stack(proc);
 
     // Copy session and group id of the parent into the child
     proc->sid  = current->sid;
@@ -12,6 +12,7 @@
 #include "assert.h"
 #include "descriptor_tables/tss.h"
 #include "errno.h"
+#include "fs/locks.h"
 #include "fs/vfs.h"
 #include "hardware/timer.h"
 #include "process/pid_manager.h"
@@ -28,9 +29,19 @@
 /// @param stack    The stack to use.
 extern void enter_userspace(uintptr_t location, uintptr_t stack);
 
+/// @brief          Assembly function (in switch.S) saving the callee-saved
+///                 registers and the stack pointer of the current task, and
+///                 resuming the next task where it was suspended.
+/// @param prev_esp Where the kernel stack pointer of the current task is saved.
+/// @param next_esp The kernel stack pointer of the next task.
+extern void switch_to(uintptr_t *prev_esp, uintptr_t next_esp);
+
 /// The list of processes.
 runqueue_t runqueue;
 
+/// The CPU time and scheduling statistics.
+kernel_cpustat_t kernel_cpustat;
+
 // Definition of the global init process pointer
 task_struct *init_process = NULL;
 
@@ -38,12 +49,21 @@ void scheduler_initialize(void)
 {
     // Initialize the runqueue list of tasks.
     list_head_init(&runqueue.queue);
+    // Initialize the queues of the scheduling classes.
+    list_head_init(&runqueue.dl.queue);
+    for (int i = 0; i < MAX_RT_PRIO; ++i) {
+        list_head_init(&runqueue.rt.queue[i]);
+    }
+    list_head_init(&runqueue.fair.queue);
+    list_head_init(&runqueue.idle.queue);
     // Initialize the PID manager.
     pid_manager_init();
     // Reset the current task.
-    runqueue.curr       = NULL;
+    runqueue.curr         = NULL;
     // Reset the number of active tasks.
-    runqueue.num_active = 0;
+    runqueue.num_active   = 0;
+    // Nothing to preempt yet.
+    runqueue.need_resched = false;
 }
 
 task_struct *scheduler_get_current_process(void) { return runqueue.curr; }
@@ -95,6 +115,8 @@ void scheduler_enqueue_task(task_struct *process)
     }
     // Add the new process at the end.
     list_head_insert_before(&process->run_list, &runqueue.queue);
+    // Add the process to the class serving its policy.
+    sched_class_enqueue(&runqueue, process);
     // Increment the number of active processes.
     ++runqueue.num_active;
 
@@ -108,6 +130,8 @@ void scheduler_dequeue_task(task_struct *process)
     assert(process && "Received a NULL process.");
     // Delete the process from the list of running processes.
     list_head_remove(&process->run_list);
+    // Remove the process from its scheduling class.
+    sched_class_dequeue(&runqueue, process);
     // Decrement the number of active processes.
     --runqueue.num_active;
     if (process->se.is_periodic) {
@@ -119,58 +143,118 @@ void scheduler_dequeue_task(task_struct *process)
 #endif
 }
 
-void scheduler_run(pt_regs *f)
+/// @brief Returns the top of the kernel stack of the task, where the CPU
+/// places the registers when the task enters the kernel from user mode.
+/// @param task the task.
+/// @return the top of the stack.
+static inline uintptr_t __kernel_stack_top(task_struct *task)
+{
+    return task->thread.kernel_stack + TASK_KERNEL_STACK_SIZE;
+}
+
+/// @brief Moves the CPU from the current task to the next one. The current
+/// task is suspended inside this function, and it returns when the task is
+/// scheduled again.
+/// @param next the next task.
+static inline void __switch_task(task_struct *next)
+{
+    task_struct *prev = runqueue.curr;
+    // A task leaving the CPU while runnable has been preempted.
+    if (prev->state == TASK_RUNNING) {
+        ++prev->nivcsw;
+    } else {
+        ++prev->nvcsw;
+    }
+    ++kernel_cpustat.context_switches;
+    // Save the FPU state of the current task.
+    switch_fpu();
+    // The next task enters the kernel on its own stack.
+    runqueue.curr = next;
+    tss_set_stack(0x10, __kernel_stack_top(next));
+    // Switch to process page directory, the kernel stacks are mapped in all of them.
+    paging_switch_directory_va(next->mm->pgd);
+    // Switch the kernel stack, we come back here when we are scheduled again.
+    switch_to(&prev->thread.esp, next->thread.esp);
+    // Restore the FPU state of the task, which is now running again.
+    unswitch_fpu();
+}
+
+void schedule(void)
 {
     // Check if there is a running process.
     if (runqueue.curr == NULL) {
         return;
     }
+    // A task which has exited leaves the queues, and it never runs again.
+    if (runqueue.curr->state == EXIT_ZOMBIE) {
+        scheduler_dequeue_task(runqueue.curr);
+    }
+    for (;;) {
+        // We are going through the scheduler, the request has been served.
+        runqueue.need_resched = false;
+        // Pointer to the next process to be executed.
+        task_struct *next     = scheduler_pick_next_task(&runqueue);
+        if (next->state == TASK_RUNNING) {
+            if (next != runqueue.curr) {
+                __switch_task(next);
+            }
+            return;
+        }
+        // The current task is sleeping, and nothing else is runnable: wait,
+        // with the interrupts enabled, for an interrupt to wake up a task.
+        sti();
+        hlt();
+        cli();
+    }
+}
 
-    task_struct *next = NULL;
+void scheduler_run(pt_regs *f)
+{
+    // Check if there is a running process.
+    if (runqueue.curr == NULL) {
+        return;
+    }
 
     // Update the context of the current process.
     scheduler_store_context(f, runqueue.curr);
 
     // We check the existence of pending signals every time we finish
-    // handling an interrupt or an exception.
-    if (!do_signal(f)) {
-#if 1
-        if (runqueue.curr->state == EXIT_ZOMBIE) {
-            //==== Handle Zombies =================================================
-            //pr_debug("Handle zombie %d\n", runqueue.curr->pid);
-            // get the next process after the current one
-            list_head *nNode = runqueue.curr->run_list.next;
-            // check if we reached the head of list_head
-            if (nNode == &runqueue.queue) {
-                nNode = nNode->next;
-            }
-            // get the task_struct
-            next = list_entry(nNode, task_struct, run_list);
-            // Remove the zombie task.
-            scheduler_dequeue_task(runqueue.curr);
-            assert(next && "No valid task selected after removing ZOMBIE.");
-            //=====================================================================
-        } else {
-#endif
-            //==== Scheduling =====================================================
-            // If we are currently executing a periodic process, and this process
-            //  has yet to complete, keep executing it.
-#ifdef SCHEDULER_EDF
-            if (runqueue.curr->se.is_periodic)
-                if (!runqueue.curr->se.executed)
-                    return;
-#endif
-            // Pointer to the next process to be executed.
-            next = scheduler_pick_next_task(&runqueue);
-            //=====================================================================
-        }
-        // Check if the next and current processes are different.
-        if (next != runqueue.curr) {
-            // Copy into Kernel stack the next process's context.
-            scheduler_restore_context(next, f);
-        }
+    // handling an interrupt or an exception. If a handler must run, the
+    // process returns to user mode right away, unless the signal killed it.
+    if (do_signal(f) && (runqueue.curr->state != EXIT_ZOMBIE)) {
+        runqueue.need_resched = false;
+        return;
+    }
+    schedule();
+}
+
+void scheduler_account_tick(pt_regs *f)
+{
+    task_struct *current = runqueue.curr;
+    // The CPU idles in the scheduler, on behalf of a sleeping task, when
+    // nothing else can run.
+    if ((current == NULL) || (current->state != TASK_RUNNING)) {
+        ++kernel_cpustat.idle;
+    } else if ((f->cs & 3) == 3) {
+        ++current->utime;
+        ++kernel_cpustat.user;
+    } else {
+        ++current->stime;
+        ++kernel_cpustat.system;
+    }
+}
+
+void scheduler_preempt(pt_regs *f)
+{
+    // The kernel is not preemptible, we switch task only when going back to
+    // user mode.
+    if (runqueue.need_resched && ((f->cs & 3) == 3)) {
+        // Save current process fpu state.
+        switch_fpu();
+        scheduler_run(f);
+        // Restore fpu state.
+        unswitch_fpu();
     }
-    //==========================================================================
 }
 
 void scheduler_store_context(pt_regs *f, task_struct *process)
@@ -192,8 +276,8 @@ void scheduler_restore_context(task_struct *process, pt_regs *f)
 
 void scheduler_enter_user_jmp(uintptr_t location, uintptr_t stack)
 {
-    // Reset stack pointer for kernel.
-    tss_set_stack(0x10, initial_esp);
+    // The process enters the kernel on its own stack.
+    tss_set_stack(0x10, __kernel_stack_top(runqueue.curr));
 
     // update start execution time.
     runqueue.curr->se.start_runtime = timer_get_ticks();
@@ -504,33 +588,15 @@ int sys_nice(int increment)
     return actualNice;
 }
 
-pid_t sys_waitpid(pid_t pid, int *status, int options)
+/// @brief Looks for a child which has exited, or stopped, and collects it.
+/// @param pid the child we wait for, -1 for any child.
+/// @param status where the status of the child is stored.
+/// @param options WUNTRACED to report the stopped children.
+/// @return the pid of the child, 0 if none changed state, -ECHILD if there is
+/// no such child.
+static inline pid_t __waitpid_collect(pid_t pid, int *status, int options)
 {
-    // Ensure there is a running process in the runqueue.
-    assert(runqueue.curr && "There is no currently running process.");
-
-    // Validate the PID argument.
-    // PIDs < -1 (process groups) and 0 (current process group) are not supported.
-    if (pid < -1 || pid == 0) {
-        return -ESRCH;
-    }
-
-    // A process cannot wait for itself.
-    if (pid == runqueue.curr->pid) {
-        return -ECHILD;
-    }
-
-    // Validate the `options` argument.
-    // Supported options are WNOHANG and WUNTRACED; any other value is invalid
-    if ((options != 0) && !bit_check(options, WNOHANG) && !bit_check(options, WUNTRACED)) {
-        return -EINVAL;
-    }
-
-    // Check if the current process has any children.
-    if (list_head_empty(&runqueue.curr->children)) {
-        return -ECHILD;
-    }
-
+    int found = 0;
     // Iterate through the children of the current process.
     list_for_each_safe_decl(it, store, &runqueue.curr->children)
     {
@@ -540,13 +606,23 @@ pid_t sys_waitpid(pid_t pid, int *status, int options)
             continue;
         }
 
-        // If the child is not in a zombie state, keep searching.
-        if (child->state != EXIT_ZOMBIE) {
+        // If a specific PID is provided, skip children with different PIDs.
+        if ((pid > 1) && (child->pid != pid)) {
             continue;
         }
+        found = 1;
 
-        // If a specific PID is provided, skip children with different PIDs.
-        if ((pid > 1) && (child->pid != pid)) {
+        // Report the stopped children only once, if requested.
+        if ((options & WUNTRACED) && (child->state == TASK_STOPPED) && (child->exit_code != 0)) {
+            if (status != NULL) {
+                *status = (child->exit_code << 8) | 0x7f;
+            }
+            child->exit_code = 0;
+            return child->pid;
+        }
+
+        // If the child is not in a zombie state, keep searching.
+        if (child->state != EXIT_ZOMBIE) {
             continue;
         }
 
@@ -556,12 +632,17 @@ pid_t sys_waitpid(pid_t pid, int *status, int options)
             *status = child->exit_code;
         }
 
+        // Account the CPU time of the child, and of its own children.
+        runqueue.curr->cutime += child->utime + child->cutime;
+        runqueue.curr->cstime += child->stime + child->cstime;
+
         // Clean up the child process's resources.
-        pid_manager_mark_free(child->pid); // Free the PID.
-        vfs_destroy_task(child);           // Finalize VFS structures.
-        list_head_remove(&child->sibling); // Remove from parent's child list.
-        scheduler_dequeue_task(child);     // Remove from the scheduler.
-        kmem_cache_free(child);            // Free the `task_struct`.
+        pid_manager_mark_free(child->pid);             // Free the PID.
+        vfs_destroy_task(child);                       // Finalize VFS structures.
+        list_head_remove(&child->sibling);             // Remove from parent's child list.
+        scheduler_dequeue_task(child);                 // Remove from the scheduler.
+        free_pages_lowmem(child->thread.kernel_stack); // Free the kernel stack.
+        kmem_cache_free(child);                        // Free the `task_struct`.
 
         pr_debug("Process %d cleaned up child process %d.\n", runqueue.curr->pid, child_pid);
 
@@ -569,8 +650,47 @@ pid_t sys_waitpid(pid_t pid, int *status, int options)
         return child_pid;
     }
 
-    // No eligible child process was found.
-    return 0;
+    return found ? 0 : -ECHILD;
+}
+
+pid_t sys_waitpid(pid_t pid, int *status, int options)
+{
+    // Ensure there is a running process in the runqueue.
+    assert(runqueue.curr && "There is no currently running process.");
+
+    // Validate the PID argument.
+    // PIDs < -1 (process groups) and 0 (current process group) are not supported.
+    if (pid < -1 || pid == 0) {
+        return -ESRCH;
+    }
+
+    // A process cannot wait for itself.
+    if (pid == runqueue.curr->pid) {
+        return -ECHILD;
+    }
+
+    // Validate the `options` argument.
+    // Supported options are WNOHANG and WUNTRACED; any other value is invalid
+    if (options & ~(WNOHANG | WUNTRACED)) {
+        return -EINVAL;
+    }
+
+    for (;;) {
+        pid_t child_pid = __waitpid_collect(pid, status, options);
+        if (child_pid != 0) {
+            return child_pid;
+        }
+        // No eligible child process was found.
+        if (options & WNOHANG) {
+            return 0;
+        }
+        // Sleep until one of the children exits, stops or continues, or a
+        // signal arrives, which interrupts the wait.
+        int ret = interruptible_sleep_on(&runqueue.curr->wait_chldexit);
+        if (ret < 0) {
+            return ret;
+        }
+    }
 }
 
 void do_exit(int exit_code)
@@ -583,12 +703,16 @@ void do_exit(int exit_code)
         kernel_panic("Init process cannot call sys_exit!");
     }
 
+    // Release the file locks of the process, and wake up who waits for them.
+    locks_remove_task(runqueue.curr->pid);
     // Set the termination code of the process.
     runqueue.curr->exit_code = exit_code;
     // Set the state of the process to zombie.
     runqueue.curr->state     = EXIT_ZOMBIE;
     // Send a SIGCHLD to the parent process.
     if (runqueue.curr->parent) {
+        // Wake up the parent, if it is waiting for us.
+        wake_up_all(&runqueue.curr->parent->wait_chldexit);
         int ret = sys_kill(runqueue.curr->parent->pid, SIGCHLD);
         if (ret == -1) {
             pr_err(
@@ -610,6 +734,8 @@ void do_exit(int exit_code)
         pr_debug("}\n");
         // Plug the list of children.
         list_head_append(&init_process->children, &runqueue.curr->children);
+        // Some of them might be zombies already.
+        wake_up_all(&init_process->wait_chldexit);
         // Print the list of children.
         pr_debug("New list of init children (%d): {\n", init_process->pid);
         list_for_each_decl (it, &init_process->children) {
@@ -626,100 +752,134 @@ void do_exit(int exit_code)
 
 void sys_exit(int exit_code) { do_exit(exit_code << 8); }
 
-int sys_sched_setparam(pid_t pid, const sched_param_t *param)
+/// @brief Returns the process with the given pid.
+/// @param pid the pid of the process, 0 for the current process.
+/// @return the process, NULL if it does not exist.
+static inline task_struct *__scheduler_find_task(pid_t pid)
 {
-    list_head *it;
-    // Iter over the runqueue to find the task
-    list_for_each (it, &runqueue.queue) {
-        task_struct *entry = list_entry(it, task_struct, run_list);
-        if (entry->pid == pid) {
-            if (!entry->se.is_periodic && param->is_periodic) {
-                runqueue.num_periodic++;
-            } else if (entry->se.is_periodic && !param->is_periodic) {
-                runqueue.num_periodic--;
-            }
-            // Sets the parameters from param to the "se" struct parameters.
-            entry->se.prio        = param->sched_priority;
-            entry->se.period      = param->period;
-            entry->se.arrivaltime = param->arrivaltime;
-            entry->se.is_periodic = param->is_periodic;
-            entry->se.deadline    = timer_get_ticks() + param->deadline;
-            entry->se.next_period = timer_get_ticks();
-
-            entry->se.is_under_analysis = true;
-            entry->se.executed          = false;
-            return 1;
+    return (pid == 0) ? runqueue.curr : scheduler_get_running_process(pid);
+}
+
+/// @brief Changes the policy of the process, and moves it to the matching class.
+/// @param task   the process.
+/// @param policy the new policy.
+/// @param param  the new parameters.
+/// @return 0 on success, a negative errno value on error.
+static int __scheduler_setscheduler(task_struct *task, int policy, const sched_param_t *param)
+{
+    if (param == NULL) {
+        return -EINVAL;
+    }
+    // Check the parameters against the policy.
+    switch (policy) {
+    case SCHED_FIFO:
+    case SCHED_RR:
+        if ((param->sched_priority < 1) || (param->sched_priority > MAX_USER_RT_PRIO)) {
+            return -EINVAL;
+        }
+        break;
+    case SCHED_NORMAL:
+    case SCHED_BATCH:
+    case SCHED_IDLE:
+        if (param->sched_priority != 0) {
+            return -EINVAL;
         }
+        break;
+    case SCHED_DEADLINE:
+        if (param->period == 0) {
+            return -EINVAL;
+        }
+        break;
+    default:
+        return -EINVAL;
+    }
+    // Only the superuser can give a real-time policy to a process.
+    if ((policy == SCHED_FIFO || policy == SCHED_RR || policy == SCHED_DEADLINE) && (runqueue.curr->uid != 0)) {
+        return -EPERM;
+    }
+    // Remove the process from its current class, before touching what the
+    // class uses to place it.
+    sched_class_dequeue(&runqueue, task);
+    if (policy == SCHED_DEADLINE) {
+        if (!task->se.is_periodic) {
+            runqueue.num_periodic++;
+        }
+        // Sets the parameters from param to the "se" struct parameters.
+        task->se.period            = param->period;
+        task->se.arrivaltime       = param->arrivaltime;
+        task->se.is_periodic       = true;
+        task->se.deadline          = timer_get_ticks() + param->deadline;
+        task->se.next_period       = timer_get_ticks();
+        // The process runs as an aperiodic one until `waitperiod` admits it.
+        task->se.is_under_analysis = true;
+        task->se.executed          = false;
+    } else if (task->se.is_periodic) {
+        runqueue.num_periodic--;
+        task->se.is_periodic       = false;
+        task->se.is_under_analysis = false;
     }
-    return -1;
+    task->se.policy      = policy;
+    task->se.rt_priority = (policy == SCHED_FIFO || policy == SCHED_RR) ? param->sched_priority : 0;
+    // Add the process to the class serving its new policy.
+    sched_class_enqueue(&runqueue, task);
+    return 0;
 }
 
-int sys_sched_getparam(pid_t pid, sched_param_t *param)
+int sys_sched_setparam(pid_t pid, const sched_param_t *param)
 {
-    list_head *it;
-    // Iter over the runqueue to find the task
-    list_for_each (it, &runqueue.queue) {
-        task_struct *entry = list_entry(it, task_struct, run_list);
-        if (entry->pid == pid) {
-            //Sets the parameters from the "se" struct to param
-            param->sched_priority = entry->se.prio;
-            param->period         = entry->se.period;
-            param->deadline       = entry->se.deadline;
-            param->arrivaltime    = entry->se.arrivaltime;
-            return 1;
-        }
+    task_struct *task = __scheduler_find_task(pid);
+    if (task == NULL) {
+        return -ESRCH;
+    }
+    if (param == NULL) {
+        return -EINVAL;
     }
-    return -1;
+    // The periodic flag moves the process in and out of the deadline policy.
+    int policy = task->se.policy;
+    if (param->is_periodic) {
+        policy = SCHED_DEADLINE;
+    } else if (policy == SCHED_DEADLINE) {
+        policy = SCHED_NORMAL;
+    }
+    return __scheduler_setscheduler(task, policy, param);
 }
 
-/// @brief Performs the response time analysis for the current list of periodic
-/// processes.
-/// @return 1 if scheduling periodic processes is feasible, 0 otherwise.
-static int __response_time_analysis(void)
+int sys_sched_getparam(pid_t pid, sched_param_t *param)
 {
-    task_struct *entry, *previous;
-    time_t r, previous_r = 0;
-    list_for_each_decl (it, &runqueue.queue) {
-        // Get the curent entry in the list.
-        entry = list_entry(it, task_struct, run_list);
-        // If the process is not periodic we skip it.
-        if (!entry->se.is_periodic) {
-            continue;
-        }
-        // Put r equal to worst case exec because is the first point in time
-        // that the task could possibly complete.
-        r = entry->se.worst_case_exec, previous_r = 0;
-        // The analysis can be completed either missing the deadline or reaching
-        // a fixed point.
-        while ((r < entry->se.deadline) && (r != previous_r)) {
-            // Save the previous response time.
-            previous_r = r;
-            // Initialize response time.
-            r          = entry->se.worst_case_exec;
-            list_for_each_decl (it2, &runqueue.queue) {
-                previous = list_entry(it2, task_struct, run_list);
-                // Check the interferences of higher priority processes.
-                if (previous->se.is_periodic && (previous->se.period < entry->se.period)) {
-                    pr_debug(
-                        "%d += (%.2f / %.2f) * %d\n", r, (double)previous_r, (double)previous->se.period,
-                        previous->se.worst_case_exec);
-
-                    // Update the response time.
-                    r += (int)ceil((double)previous_r / (double)previous->se.period) * previous->se.worst_case_exec;
-
-                    pr_debug("Response Time Analysis -> [%s] vs [%s] R = %d\n\n", entry->name, previous->name, r);
-                }
-            }
-        }
-        // Feasibility of scheduler is guaranteed if and only if response time
-        // analysis is lower than deadline.
-        if (r > entry->se.deadline) {
-            return 1;
-        }
+    task_struct *task = __scheduler_find_task(pid);
+    if (task == NULL) {
+        return -ESRCH;
     }
+    if (param == NULL) {
+        return -EINVAL;
+    }
+    // Sets the parameters from the "se" struct to param.
+    param->sched_priority = task->se.rt_priority;
+    param->period         = task->se.period;
+    param->deadline       = task->se.deadline;
+    param->arrivaltime    = task->se.arrivaltime;
+    param->is_periodic    = task->se.is_periodic;
     return 0;
 }
 
+int sys_sched_setscheduler(pid_t pid, int policy, const sched_param_t *param)
+{
+    task_struct *task = __scheduler_find_task(pid);
+    if (task == NULL) {
+        return -ESRCH;
+    }
+    return __scheduler_setscheduler(task, policy, param);
+}
+
+int sys_sched_getscheduler(pid_t pid)
+{
+    task_struct *task = __scheduler_find_task(pid);
+    if (task == NULL) {
+        return -ESRCH;
+    }
+    return task->se.policy;
+}
+
 /// @brief Computes the total utilization factor.
 /// @return the utilization factor.
 static inline double __compute_utilization_factor(void)
@@ -768,44 +928,28 @@ int sys_waitperiod(void)
         current->se.worst_case_exec = current->se.sum_exec_runtime;
         // This will keep track if the process can be scheduled.
         bool_t is_not_schedulable   = false;
-#if defined(SCHEDULER_EDF)
         // Compute the total utilization factor.
-        double u = __compute_utilization_factor();
+        double u                    = __compute_utilization_factor();
         // If the utilization factor is above 1, the process cannot be placed
-        // with the other periodic processes.
+        // with the other periodic processes by the deadline class.
         if (u > 1) {
             is_not_schedulable = true;
         }
         pr_warning("Utilization factor is : %.2f\n", u);
-#elif defined(SCHEDULER_RM)
-        // Compute the total utilization factor.
-        double u    = __compute_utilization_factor();
-        // Calculating Least Upper Bound of utilization factor. For large amount
-        // of processes ulub asymptotically should reach ln(2).
-        double ulub = (runqueue.num_periodic * (pow(2, (1.0 / runqueue.num_periodic)) - 1));
-        // If the sum of utilization factor is bounded between ulub and 1 we
-        // need to calculate the response time analysis for each process.
-        if (u > 1) {
-            is_not_schedulable = true;
-        } else if (u <= ulub) {
-            is_not_schedulable = false;
-        } else {
-            is_not_schedulable = __response_time_analysis();
-        }
-        pr_warning("Utilization factor is : %.2f, Least Upper Bound: %.2f\n", u, ulub);
-#endif
         // If it is not schedulable, we need to tell it to the process.
         if (is_not_schedulable) {
             return -ENOTSCHEDULABLE;
         }
         // Otherwise, it is schedulable and thus it is not under analysis
-        // anymore.
+        // anymore, from now on it is served by the deadline class.
+        sched_class_dequeue(&runqueue, current);
         current->se.is_under_analysis = false;
+        sched_class_enqueue(&runqueue, current);
         // The task has been executed as non-periodic process so that his
         // deadline is not been updated by the scheduling algorithm of periodic
         // tasks. We need to update it manually.
-        current->se.next_period       = current_time;
-        current->se.deadline          = current_time + current->se.period;
+        current->se.next_period = current_time;
+        current->se.deadline    = current_time + current->se.period;
     }
     // If the current time is ahead of the deadline, we need to print a warning.
     if (current_time > current->se.deadline) {
@@ -1,5 +1,5 @@
 /// @file scheduler_algorithm.c
-/// @brief Round Robin algorithm.
+/// @brief Scheduling classes: deadline, real-time, fair and idle.
 /// @copyright (c) 2014-2024 This file is distributed under the MIT License.
 /// See LICENSE.md for details.
 
@@ -12,376 +12,455 @@
 #include "assert.h"
 #include "hardware/timer.h"
 #include "list_head.h"
+#include "list_head_algorithm.h"
+#include "math.h"
 #include "process/prio.h"
 #include "process/scheduler.h"
 #include "process/scheduler_feedback.h"
 #include "process/wait.h"
+#include "sys/bitops.h"
+
+/// @brief The length of the time slice of SCHED_RR tasks, in milliseconds, by default.
+#define RR_TIMESLICE_MS 100
+
+/// @brief The scale of the virtual runtime, a tick of a nice 0 task adds
+/// `1 << VRUNTIME_SHIFT` to its virtual runtime. It keeps the weighting
+/// meaningful even for tasks with a large weight.
+#define VRUNTIME_SHIFT 10
+
+/// The length of the time slice of SCHED_RR tasks, in milliseconds.
+int sysctl_sched_rr_timeslice_ms = RR_TIMESLICE_MS;
+
+/// Forward declaration of the classes, from the highest to the lowest priority.
+extern const sched_class_t dl_sched_class, rt_sched_class, fair_sched_class, idle_sched_class;
 
 /// @brief Updates task execution statistics.
 /// @param task the task to update.
 static void __update_task_statistics(task_struct *task);
 
-/// @brief Checks if the given task is actually a periodic task.
-/// @param task the task to check.
-/// @return true if the task is periodic, false otherwise.
-static inline bool_t __is_periodic_task(task_struct *task)
+/// @brief Returns the task which owns the given link of a class queue.
+/// @param list the link.
+/// @return the task.
+static inline task_struct *__class_entry(list_head *list)
 {
-    // Check if the task is a periodic one and it is not under analysis.
-    return task->se.is_periodic && !task->se.is_under_analysis;
+    return list_entry(list_entry(list, sched_entity_t, class_list), task_struct, se);
 }
 
-/// @brief Employs time-sharing, giving each job a time-slot, and is also
-/// preemptive since the scheduler forces the task out of the CPU once
-/// the time-slot expires.
-/// @param runqueue list of all processes.
-/// @param skip_periodic tells the algorithm that periodic processes in the list
-/// should be skipped.
-/// @return the next task on success, NULL on failure.
-static inline task_struct *__scheduler_rr(runqueue_t *runqueue, bool_t skip_periodic)
+/// @brief Compares two virtual runtimes, taking care of their wrap around.
+/// @param a the first virtual runtime.
+/// @param b the second virtual runtime.
+/// @return a value greater than zero if `a` comes after `b`.
+static inline int __vruntime_compare(time_t a, time_t b) { return (int)(a - b); }
+
+// ============================================================================
+// Deadline class.
+
+/// @brief Adds the task to the deadline queue.
+/// @param rq the runqueue.
+/// @param task the task.
+static void __dl_enqueue_task(runqueue_t *rq, task_struct *task)
 {
-    // If there is just one task, return it; no need to do anything.
-    if (list_head_size(&runqueue->curr->run_list) <= 1) {
-        return runqueue->curr;
-    }
-    // This will hold a given entry, while iterating the list of tasks.
-    task_struct *entry = NULL;
-    // Search for the next task (we do not start from the head, so INSIDE, skip the head).
-    list_for_each_decl (it, &runqueue->curr->run_list) {
-        // Check if we reached the head of list_head, and skip it.
-        if (it == &runqueue->queue) {
-            continue;
-        }
+    list_head_insert_before(&task->se.class_list, &rq->dl.queue);
+}
+
+/// @brief Removes the task from the deadline queue.
+/// @param rq the runqueue.
+/// @param task the task.
+static void __dl_dequeue_task(runqueue_t *rq, task_struct *task) { list_head_remove(&task->se.class_list); }
+
+/// @brief Executes the task with the earliest absolute DEADLINE among all the
+/// ready tasks. When a task was executed, and its period is starting again, it
+/// must be set as 'executable again', and its deadline and next_period must be
+/// updated.
+/// @param rq the runqueue.
+/// @return the next task, NULL if there are no periodic tasks to execute.
+static task_struct *__dl_pick_next_task(runqueue_t *rq)
+{
+    // This will hold the pointer to the next task to schedule.
+    task_struct *next = NULL;
+    // The current time.
+    time_t now        = timer_get_ticks();
+    // Iter over the queue to find the task with the earliest absolute deadline.
+    list_for_each_decl (it, &rq->dl.queue) {
         // Get the current entry.
-        entry = list_entry(it, task_struct, run_list);
+        task_struct *entry = __class_entry(it);
         // We consider only runnable processes.
         if (entry->state != TASK_RUNNING) {
             continue;
         }
-        // If entry is a periodic task, and we were asked to skip periodic tasks, skip it.
-        if (__is_periodic_task(entry) && skip_periodic) {
-            continue;
+        // If the period for the entry is starting again and it has already
+        // executed, set it as 'executable again'. Deadline and next_period
+        // are propagated.
+        if (entry->se.executed && (entry->se.next_period <= now)) {
+            entry->se.executed = false;
+            entry->se.deadline += entry->se.period;
+            entry->se.next_period += entry->se.period;
+            pr_debug(
+                "[%9d] Activating task '%16s' [period:%d], deadline:%5d; next_period:%5d, WCET:%6d\t\n", now,
+                entry->name, entry->se.period, entry->se.deadline, entry->se.next_period,
+                entry->se.worst_case_exec);
+        }
+        // Select the task if it has the minimum absolute deadline.
+        if (!entry->se.executed && (!next || (entry->se.deadline < next->se.deadline))) {
+            next = entry;
         }
-        // We have our next entry.
-        return entry;
     }
+    return next;
+}
 
-    return NULL;
+/// @brief A woken deadline task preempts the current one if its absolute
+/// deadline comes first.
+/// @param rq the runqueue.
+/// @param task the woken task.
+/// @return 1 if the task must preempt the current one, 0 otherwise.
+static int __dl_check_preempt_curr(runqueue_t *rq, task_struct *task)
+{
+    return !task->se.executed && (task->se.deadline < rq->curr->se.deadline);
 }
 
-/// @brief Is a non-preemptive algorithm, where each task is assigned a
-/// priority. Processes with highest priority are executed first, while
-/// processes with same priority are executed on first-come/first-served basis.
-/// Priority can be decided based on memory requirements, time requirements or
-/// any other resource requirement.
-/// @param runqueue list of all processes.
-/// @param skip_periodic tells the algorithm if there are periodic processes in
-/// the list, and in that case it needs to skip them.
-/// @return the next task on success, NULL on failure.
-/// @details
-/// When implementing this algorithm, beware of the following pitfal. If you
-/// have the following runqueue (reports task position in the runqueue, priority
-/// and name):
-///      Position | Priority | Name
-///          1    |    120   | init
-///          2    |    120   | shell
-///          3    |    122   | echo
-///          4    |    128   | ps
-/// If you pick the first task every time (i.e., init), and use its prio (i.e.,
-/// 120), what would happen if inside the for-loop when you check "if the entry
-/// has a lower priority", you use a lesser-than sign?
-/// First, it will check against init itself, so 120 < 120 is false.
-/// Then, it will check against shell, again, 120 < 120 is false.
-/// As such, shell or the other processes will never be selected. There are
-/// different ways of solving this problem, each of which requires changes only
-/// inside this same function. Good luck.
-static inline task_struct *__scheduler_priority(runqueue_t *runqueue, bool_t skip_periodic)
+/// @brief The deadline class, serving the admitted SCHED_DEADLINE tasks.
+const sched_class_t dl_sched_class = {
+    .name               = "deadline",
+    .next               = &rt_sched_class,
+    .enqueue_task       = __dl_enqueue_task,
+    .dequeue_task       = __dl_dequeue_task,
+    .pick_next_task     = __dl_pick_next_task,
+    .task_tick          = NULL,
+    .check_preempt_curr = __dl_check_preempt_curr,
+};
+
+// ============================================================================
+// Real-time class.
+
+/// @brief Returns the index of the queue of the given real-time task.
+/// @param task the task.
+/// @return the index, 0 is the highest priority.
+static inline int __rt_index(task_struct *task) { return MAX_USER_RT_PRIO - task->se.rt_priority; }
+
+/// @brief Adds the task at the end of the queue of its priority.
+/// @param rq the runqueue.
+/// @param task the task.
+static void __rt_enqueue_task(runqueue_t *rq, task_struct *task)
 {
-#ifdef SCHEDULER_PRIORITY
-    // Get the first element of the list.
-    task_struct *next  = list_entry(runqueue->queue.next, struct task_struct, run_list);
-    // This will hold a given entry, while iterating the list of tasks.
-    task_struct *entry = NULL;
-    // Get the  static priority of the first element of the list we just extracted.
-    time_t min         = /*...*/;
-
-    // Search for the task with the smallest static priority.
-    list_for_each_decl (it, &runqueue->queue) {
-        // Check if we reached the head of list_head, and skip it.
-        if (it == &runqueue->queue)
-            continue;
-        // Get the current entry.
-        entry = list_entry(it, task_struct, run_list);
-        // We consider only runnable processes
-        if (entry->state != TASK_RUNNING)
-            continue;
-        // If entry is a periodic task, and we were asked to skip periodic tasks, skip it.
-        if (__is_periodic_task(entry) && skip_periodic)
-            continue;
-        // Check if the entry has a lower priority.
-        if (/*...*/) {
-            // Chose the `entry` as the `next` task.
-            /*...*/
+    int index = __rt_index(task);
+    list_head_insert_before(&task->se.class_list, &rq->rt.queue[index]);
+    bit_set_assign(rq->rt.bitmap[index / 32], index % 32);
+    task->se.time_slice = max(1, sysctl_sched_rr_timeslice_ms * TICKS_PER_SECOND / 1000);
+}
+
+/// @brief Removes the task from the queue of its priority.
+/// @param rq the runqueue.
+/// @param task the task.
+static void __rt_dequeue_task(runqueue_t *rq, task_struct *task)
+{
+    int index = __rt_index(task);
+    list_head_remove(&task->se.class_list);
+    if (list_head_empty(&rq->rt.queue[index])) {
+        bit_clear_assign(rq->rt.bitmap[index / 32], index % 32);
+    }
+}
+
+/// @brief Returns the first runnable task of the highest priority queue
+/// containing one.
+/// @param rq the runqueue.
+/// @return the next task, NULL if there are no real-time tasks to execute.
+static task_struct *__rt_pick_next_task(runqueue_t *rq)
+{
+    for (size_t word = 0; word < count_of(rq->rt.bitmap); ++word) {
+        // Visit the non-empty queues, from the highest priority.
+        for (unsigned long bits = rq->rt.bitmap[word]; bits; bits = bit_clear(bits, find_first_non_zero(bits))) {
+            int index = word * 32 + find_first_non_zero(bits);
+            list_for_each_decl (it, &rq->rt.queue[index]) {
+                task_struct *entry = __class_entry(it);
+                if (entry->state == TASK_RUNNING) {
+                    return entry;
+                }
+            }
         }
     }
-    return next;
-#else
-    return __scheduler_rr(runqueue, skip_periodic);
-#endif
+    return NULL;
+}
+
+/// @brief Consumes the time slice of SCHED_RR tasks, once it expires the task
+/// goes behind the other tasks with its same priority.
+/// @param rq the runqueue.
+/// @param task the task which has just run.
+static void __rt_task_tick(runqueue_t *rq, task_struct *task)
+{
+    if (task->se.policy != SCHED_RR) {
+        return;
+    }
+    if (task->se.time_slice > task->se.exec_runtime) {
+        task->se.time_slice -= task->se.exec_runtime;
+        return;
+    }
+    __rt_dequeue_task(rq, task);
+    __rt_enqueue_task(rq, task);
+}
+
+/// @brief A woken real-time task preempts the current one if it has a higher
+/// priority.
+/// @param rq the runqueue.
+/// @param task the woken task.
+/// @return 1 if the task must preempt the current one, 0 otherwise.
+static int __rt_check_preempt_curr(runqueue_t *rq, task_struct *task)
+{
+    return task->se.rt_priority > rq->curr->se.rt_priority;
 }
 
+/// @brief The real-time class, serving SCHED_FIFO and SCHED_RR tasks.
+const sched_class_t rt_sched_class = {
+    .name               = "rt",
+    .next               = &fair_sched_class,
+    .enqueue_task       = __rt_enqueue_task,
+    .dequeue_task       = __rt_dequeue_task,
+    .pick_next_task     = __rt_pick_next_task,
+    .task_tick          = __rt_task_tick,
+    .check_preempt_curr = __rt_check_preempt_curr,
+};
+
+// ============================================================================
+// Fair class.
+
+/// @brief Weights a runtime with the priority of the task.
+/// @param task the task.
+/// @param runtime the runtime, in ticks.
+/// @return the virtual runtime, the lower the priority, the faster it grows.
+static inline time_t __fair_weight_runtime(task_struct *task, time_t runtime)
+{
+    return runtime * ((NICE_0_LOAD << VRUNTIME_SHIFT) / GET_WEIGHT(task->se.prio));
+}
+
+/// @brief Compares the virtual runtime of two tasks of the fair queue.
+/// @param a the first entry.
+/// @param b the second entry.
+/// @return 1 if `a` has a greater virtual runtime than `b`, 0 otherwise.
+static int __fair_compare(const list_head *a, const list_head *b)
+{
+    return __vruntime_compare(__class_entry((list_head *)a)->se.vruntime, __class_entry((list_head *)b)->se.vruntime) >
+           0;
+}
+
+/// @brief Adds the task to the fair queue, sorted by virtual runtime. A task
+/// cannot be behind the virtual runtime of the queue, otherwise a new task
+/// would monopolize the CPU until it catches up.
+/// @param rq the runqueue.
+/// @param task the task.
+static void __fair_enqueue_task(runqueue_t *rq, task_struct *task)
+{
+    if (__vruntime_compare(task->se.vruntime, rq->fair.min_vruntime) < 0) {
+        task->se.vruntime = rq->fair.min_vruntime;
+    }
+    list_head_insert_sorted(&task->se.class_list, &rq->fair.queue, __fair_compare);
+}
+
+/// @brief Removes the task from the fair queue.
+/// @param rq the runqueue.
+/// @param task the task.
+static void __fair_dequeue_task(runqueue_t *rq, task_struct *task) { list_head_remove(&task->se.class_list); }
+
 /// @brief It aims at giving a fair share of CPU time to processes, and achieves
 /// that by associating a virtual runtime to each of them. It always tries to
 /// run the task with the smallest vruntime (i.e., the task which executed least
-/// so far). It always tries to split up CPU time between runnable tasks as
-/// close to "ideal multitasking hardware" as possible.
-/// @param runqueue list of all processes.
-/// @param skip_periodic tells the algorithm if there are periodic processes in
-/// the list, and in that case it needs to skip them.
-/// @return the next task on success, NULL on failure.
-static inline task_struct *__scheduler_cfs(runqueue_t *runqueue, bool_t skip_periodic)
+/// so far), which is the first runnable task of the sorted queue.
+/// @param rq the runqueue.
+/// @return the next task, NULL if there are no fair tasks to execute.
+static task_struct *__fair_pick_next_task(runqueue_t *rq)
 {
-#ifdef SCHEDULER_CFS
-    // Get the first element of the list.
-    task_struct *next  = list_entry(runqueue->queue.next, struct task_struct, run_list);
-    // This will hold a given entry, while iterating the list of tasks.
-    task_struct *entry = NULL;
-    // Get the virtual runtime of the first element of the list we just extracted.
-    time_t min         = /*...*/;
-
-    // Search for the task with the smallest vruntime value.
-    list_for_each_decl (it, &runqueue->queue) {
-        // Check if we reached the head of list_head, and skip it.
-        if (it == &runqueue->queue)
-            continue;
-        // Get the current entry.
-        entry = list_entry(it, task_struct, run_list);
-        // We consider only runnable processes
-        if (entry->state != TASK_RUNNING)
-            continue;
-        // If entry is a periodic task, and we were asked to skip periodic tasks, skip it.
-        if (__is_periodic_task(entry) && skip_periodic)
+    list_for_each_decl (it, &rq->fair.queue) {
+        task_struct *entry = __class_entry(it);
+        if (entry->state != TASK_RUNNING) {
             continue;
+        }
+        // A task which has been sleeping for a while does not get back all the
+        // time it has not used, it just starts from the current minimum.
+        if (__vruntime_compare(entry->se.vruntime, rq->fair.min_vruntime) < 0) {
+            entry->se.vruntime = rq->fair.min_vruntime;
+        }
+        rq->fair.min_vruntime = entry->se.vruntime;
+        return entry;
+    }
+    return NULL;
+}
+
+/// @brief Weights the time the task has just run with its priority, and
+/// moves it to its new position in the queue.
+/// @param rq the runqueue.
+/// @param task the task which has just run.
+static void __fair_task_tick(runqueue_t *rq, task_struct *task)
+{
+    // The lower the priority, the faster the virtual runtime grows.
+    task->se.vruntime += __fair_weight_runtime(task, task->se.exec_runtime);
+    list_head_remove(&task->se.class_list);
+    list_head_insert_sorted(&task->se.class_list, &rq->fair.queue, __fair_compare);
+}
 
-        // Check if the element in the list has a smaller vruntime value.
-        /* ... */
+/// @brief A woken fair task preempts the current one if it has run less,
+/// counting the time the current task has run since it was picked.
+/// SCHED_BATCH tasks never preempt.
+/// @param rq the runqueue.
+/// @param task the woken task.
+/// @return 1 if the task must preempt the current one, 0 otherwise.
+static int __fair_check_preempt_curr(runqueue_t *rq, task_struct *task)
+{
+    task_struct *curr = rq->curr;
+    if (task->se.policy == SCHED_BATCH) {
+        return 0;
     }
+    time_t curr_vruntime = curr->se.vruntime + __fair_weight_runtime(curr, timer_get_ticks() - curr->se.exec_start);
+    return __vruntime_compare(task->se.vruntime, curr_vruntime) < 0;
+}
 
-    return next;
-#else
-    return __scheduler_rr(runqueue, skip_periodic);
-#endif
+/// @brief The fair class, serving SCHED_NORMAL and SCHED_BATCH tasks, and the
+/// SCHED_DEADLINE tasks still under analysis.
+const sched_class_t fair_sched_class = {
+    .name               = "fair",
+    .next               = &idle_sched_class,
+    .enqueue_task       = __fair_enqueue_task,
+    .dequeue_task       = __fair_dequeue_task,
+    .pick_next_task     = __fair_pick_next_task,
+    .task_tick          = __fair_task_tick,
+    .check_preempt_curr = __fair_check_preempt_curr,
+};
+
+// ============================================================================
+// Idle class.
+
+/// @brief Adds the task at the end of the idle queue.
+/// @param rq the runqueue.
+/// @param task the task.
+static void __idle_enqueue_task(runqueue_t *rq, task_struct *task)
+{
+    list_head_insert_before(&task->se.class_list, &rq->idle.queue);
 }
 
-/// @brief Executes the task with the earliest absolute deadline among all the
-/// ready tasks.
-/// @param runqueue list of all processes.
-/// @return the next task on success, NULL on failure.
-static inline task_struct *__scheduler_aedf(runqueue_t *runqueue)
+/// @brief Removes the task from the idle queue.
+/// @param rq the runqueue.
+/// @param task the task.
+static void __idle_dequeue_task(runqueue_t *rq, task_struct *task) { list_head_remove(&task->se.class_list); }
+
+/// @brief Returns the first runnable task of the idle queue.
+/// @param rq the runqueue.
+/// @return the next task, NULL if there are no idle tasks to execute.
+static task_struct *__idle_pick_next_task(runqueue_t *rq)
 {
-#ifdef SCHEDULER_AEDF
-    // This will hold the pointer to the next task to schedule.
-    task_struct *next  = list_entry(runqueue->queue.next, struct task_struct, run_list);
-    // This will hold a given entry, while iterating the list of tasks.
-    task_struct *entry = NULL;
-    // Initialize the nearest "next deadline".
-    time_t min         = UINT_MAX;
-
-    // Iter over the runqueue to find the task with the earliest absolute deadline.
-    list_for_each_decl (it, &runqueue->queue) {
-        // Check if we reached the head of list_head, and skip it.
-        if (it == &runqueue->queue)
-            continue;
-        // Get the current entry.
-        entry = list_entry(it, task_struct, run_list);
-        // We consider only runnable processes
-        if (entry->state != TASK_RUNNING)
-            continue;
-        // If entry is not a periodic task, skip it.
-        if (!__is_periodic_task(entry))
-            continue;
-        // If the entry has passed its deadline, we output a warning but it
-        // might still be selected as next task.
-        if (/*...*/) {
-            pr_warning(
-                "Process %d passed its deadline %d < %d \n", entry->pid,
-                /*...*/,
-                /*...*/);
+    list_for_each_decl (it, &rq->idle.queue) {
+        task_struct *entry = __class_entry(it);
+        if (entry->state == TASK_RUNNING) {
+            return entry;
         }
-        // Now, select the task if it has the minimum absolute deadline.
-        if (/*...*/ < /*...*/) {
-            // Set it as next task.
-            next = entry;
-            // Update the minimum absolute deadline.
-            min  = /*...*/;
-        }
-    }
-    if (next) {
-        pr_debug(
-            "[%9d] Activating task '%16s', deadline: %5d \t\n", next->pid, next->name,
-            /*...*/);
-        return next;
     }
-#endif
-    // If there are no tasks with deadline != 0 to execute, just pick another
-    // task by using Round-Robin.
-    return __scheduler_rr(runqueue, false);
+    return NULL;
 }
 
-/// @brief Executes the task with the earliest absolute DEADLINE among all the
-/// ready tasks. When a task was executed, and its period is starting again, it
-/// must be set as 'executable again', and its deadline and next_period must be
-/// updated.
-/// @param runqueue list of all processes.
-/// @return the next task on success, NULL on failure.
-static inline task_struct *__scheduler_edf(runqueue_t *runqueue)
+/// @brief Moves the task which has just run at the end of the idle queue.
+/// @param rq the runqueue.
+/// @param task the task which has just run.
+static void __idle_task_tick(runqueue_t *rq, task_struct *task)
 {
-#ifdef SCHEDULER_EDF
-    // This will hold the pointer to the next task to schedule.
-    task_struct *next  = NULL;
-    // This will hold a given entry, while iterating the list of tasks.
-    task_struct *entry = NULL;
-    // Initialize the nearest "next deadline".
-    time_t min         = UINT_MAX;
-
-    // Iter over the runqueue to find the task with the earliest absolute deadline.
-    list_for_each_decl (it, &runqueue->queue) {
-        // Check if we reached the head of list_head, and skip it.
-        if (it == &runqueue->queue)
-            continue;
-        // Get the current entry.
-        entry = list_entry(it, task_struct, run_list);
-        // We consider only runnable processes
-        if (entry->state != TASK_RUNNING)
-            continue;
-        // If entry is not a periodic task, skip it.
-        if (!__is_periodic_task(entry))
-            continue;
+    list_head_remove(&task->se.class_list);
+    list_head_insert_before(&task->se.class_list, &rq->idle.queue);
+}
 
-        if (entry->se.executed) {
-            // If the period for the entry is starting again and it has already
-            //  executed, set it as 'executable again'. Deadline and next_period
-            //  are propagated.
-            if (/*...*/ <= /*...*/) {
-                entry->se.executed = /*...*/;
-                entry->se.deadline += /*...*/;
-                entry->se.next_period += /*...*/;
-                pr_debug(
-                    "[%9d] Activating task '%16s' [period:%d], deadline:%5d; "
-                    "next_period:%5d, WCET:%6d\t\n",
-                    timer_get_ticks(), entry->name,
-                    /*...*/,
-                    /*...*/,
-                    /*...*/,
-                    /*...*/);
-            } else {
-                // If the deadline of the process is less than the minimum value, pick it.
-                if (/*...*/ < /*...*/) {
-                    // Set it as next task.
-                    next = entry;
-                    // Update the minimum value.
-                    min  = /*...*/;
-                }
-            }
-        }
+/// @brief The idle class, serving SCHED_IDLE tasks. Its tasks are served
+/// round-robin, they never preempt each other.
+const sched_class_t idle_sched_class = {
+    .name               = "idle",
+    .next               = NULL,
+    .enqueue_task       = __idle_enqueue_task,
+    .dequeue_task       = __idle_dequeue_task,
+    .pick_next_task     = __idle_pick_next_task,
+    .task_tick          = __idle_task_tick,
+    .check_preempt_curr = NULL,
+};
+
+// ============================================================================
+
+/// @brief Returns the class which serves the given task.
+/// @param task the task.
+/// @return the class.
+static inline const sched_class_t *__select_class(task_struct *task)
+{
+    switch (task->se.policy) {
+    case SCHED_DEADLINE:
+        // While under analysis, the task runs as an aperiodic one.
+        return task->se.is_under_analysis ? &fair_sched_class : &dl_sched_class;
+    case SCHED_FIFO:
+    case SCHED_RR:
+        return &rt_sched_class;
+    case SCHED_IDLE:
+        return &idle_sched_class;
+    default:
+        return &fair_sched_class;
     }
-    if (next)
-        return next;
-#endif
-    // If there are no periodic task to execute, just pick an aperiodic task by
-    // using Round-Robin.
-    return __scheduler_rr(runqueue, false);
 }
 
-/// @brief Executes the task with the earliest next PERIOD among all the ready
-/// tasks.
-/// @details When a task was executed, and its period is starting again, it must
-/// be set as 'executable again', and its deadline and next_period must be
-/// updated.
-/// @param runqueue list of all processes.
-/// @return the next task on success, NULL on failure.
-static inline task_struct *__scheduler_rm(runqueue_t *runqueue)
+void sched_class_enqueue(runqueue_t *rq, task_struct *task)
 {
-#ifdef SCHEDULER_RM
-    // This will hold the pointer to the next task to schedule.
-    task_struct *next  = NULL;
-    // This will hold a given entry, while iterating the list of tasks.
-    task_struct *entry = NULL;
-    // Initialize the nearest "next deadline".
-    time_t min         = UINT_MAX;
-
-    // Iter over the runqueue to find the task with the earliest absolute deadline.
-    list_for_each_decl (it, &runqueue->queue) {
-        // Check if we reached the head of list_head, and skip it.
-        if (it == &runqueue->queue)
-            continue;
-        // Get the current entry.
-        entry = list_entry(it, task_struct, run_list);
-        // We consider only runnable processes
-        if (entry->state != TASK_RUNNING)
-            continue;
-        // If entry is not a periodic task, skip it.
-        if (!__is_periodic_task(entry))
-            continue;
+    assert(task && "Received a NULL task.");
+    task->se.sched_class = __select_class(task);
+    task->se.sched_class->enqueue_task(rq, task);
+}
 
-        if (entry->se.executed) {
-            // If the period for the entry is starting again and it has already
-            //  executed, set it as 'executable again'. Deadline and next_period
-            //  are propagated.
-            if (/*...*/ <= /*...*/) {
-                entry->se.executed = /*...*/;
-                entry->se.deadline += /*...*/;
-                entry->se.next_period += /*...*/;
-                pr_debug(
-                    "[%9d] Activating task '%16s' [period:%d], deadline:%5d; "
-                    "next_period:%5d, WCET:%6d\t\n",
-                    timer_get_ticks(), entry->name,
-                    /*...*/,
-                    /*...*/,
-                    /*...*/,
-                    /*...*/);
-            } else {
-                // If the next period of the process is less than the minimum value, pick it.
-                if (/*...*/ < /*...*/) {
-                    // Set it as next task.
-                    next = entry;
-                    // Update the minimum value.
-                    min  = /*...*/;
-                }
-            }
+void sched_class_dequeue(runqueue_t *rq, task_struct *task)
+{
+    assert(task && "Received a NULL task.");
+    // Zombies are removed when they stop running, and again when reaped.
+    if (task->se.sched_class) {
+        task->se.sched_class->dequeue_task(rq, task);
+        task->se.sched_class = NULL;
+    }
+}
+
+void sched_class_check_preempt(runqueue_t *rq, task_struct *task)
+{
+    assert(task && "Received a NULL task.");
+    task_struct *curr = rq->curr;
+    if (!curr || (task == curr) || !task->se.sched_class) {
+        return;
+    }
+    // If the current task is not runnable anymore, anything is better.
+    if ((curr->state != TASK_RUNNING) || !curr->se.sched_class) {
+        rq->need_resched = true;
+        return;
+    }
+    // Within the same class, the class decides.
+    if (task->se.sched_class == curr->se.sched_class) {
+        if (task->se.sched_class->check_preempt_curr && task->se.sched_class->check_preempt_curr(rq, task)) {
+            rq->need_resched = true;
+        }
+        return;
+    }
+    // Otherwise, the task preempts the current one if its class comes first.
+    for (const sched_class_t *class = task->se.sched_class->next; class; class = class->next) {
+        if (class == curr->se.sched_class) {
+            rq->need_resched = true;
+            return;
         }
     }
-    if (next)
-        return next;
-#endif
-    // If there are no periodic task to execute, just pick an aperiodic task by
-    // using Round-Robin.
-    return __scheduler_rr(runqueue, false);
 }
 
-task_struct *scheduler_pick_next_task(runqueue_t *runqueue)
+task_struct *scheduler_pick_next_task(runqueue_t *rq)
 {
     // Update task statistics.
-    __update_task_statistics(runqueue->curr);
+    __update_task_statistics(rq->curr);
+    // Let the class of the current task account the time it has just run.
+    if (rq->curr->se.sched_class && rq->curr->se.sched_class->task_tick) {
+        rq->curr->se.sched_class->task_tick(rq, rq->curr);
+    }
 
     // Pointer to the next task to schedule.
     task_struct *next = NULL;
-#if defined(SCHEDULER_RR)
-    next = __scheduler_rr(runqueue, false);
-#elif defined(SCHEDULER_PRIORITY)
-    next = __scheduler_priority(runqueue, false);
-#elif defined(SCHEDULER_CFS)
-    next = __scheduler_cfs(runqueue, false);
-#elif defined(SCHEDULER_EDF)
-    next = __scheduler_edf(runqueue);
-#elif defined(SCHEDULER_RM)
-    next = __scheduler_rm(runqueue);
-#elif defined(SCHEDULER_AEDF)
-    next = __scheduler_aedf(runqueue);
-#else
-#error "You should enable a scheduling algorithm!"
-#endif
+    // Ask the classes, from the highest priority one.
+    for (const sched_class_t *class = &dl_sched_class; class && !next; class = class->next) {
+        next = class->pick_next_task(rq);
+    }
+    // If there is nothing to run, keep running the current task.
+    if (next == NULL) {
+        next = rq->curr;
+    }
 
-    assert(next && "No valid task selected by the scheduling algorithm.");
+    assert(next && "No valid task selected by the scheduling classes.");
 
     // Update the last context switch time of the next task.
     next->se.exec_start = timer_get_ticks();
@@ -397,8 +476,6 @@ task_struct *scheduler_pick_next_task(runqueue_t *runqueue)
 
 static void __update_task_statistics(task_struct *task)
 {
-    // See `prio.h` for more support functions.
-#if defined(SCHEDULER_CFS) || defined(SCHEDULER_EDF) || defined(SCHEDULER_RM) || defined(SCHEDULER_AEDF)
     assert(task && "Current task is not valid.");
 
     // While periodic task is under analysis is executed with aperiodic
@@ -413,22 +490,4 @@ static void __update_task_statistics(task_struct *task)
 
     // Set the sum_exec_runtime.
     task->se.sum_exec_runtime += task->se.exec_runtime;
-
-    // If the task is not a periodic task we have to update the virtual runtime.
-    if (!task->se.is_periodic) {
-        // Get the weight of the current task.
-        time_t weight = GET_WEIGHT((task)->se.prio); /* ... */
-        ;
-        // If the weight is different from the default load, compute it.
-        if (weight != NICE_0_LOAD) {
-            // Get the multiplicative factor for its delta_exec.
-            double factor = ((double)NICE_0_LOAD / (double)weight); /* ... */
-            ;
-            // Weight the delta_exec with the multiplicative factor.
-            task->se.exec_runtime = ((int)(((double)task->se.exec_runtime) * factor)); /* ... */
-        }
-        // Update vruntime of the current task.
-        task->se.vruntime += task->se.exec_runtime;
-    }
-#endif
 }
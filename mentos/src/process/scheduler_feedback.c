@@ -8,6 +8,7 @@
 #include "fcntl.h"
 #include "fs/vfs.h"
 #include "hardware/timer.h"
+#include "process/scheduler.h"
 #include "stdio.h"
 #include "strerror.h"
 #include "string.h"
@@ -23,23 +24,6 @@
 /// @brief How often the feedback is shown.
 #define LOG_INTERVAL_SEC 0.5
 
-/// @brief The name of the scheduling policy.
-#if defined(SCHEDULER_RR)
-#define POLICY_NAME "RR   "
-#elif defined(SCHEDULER_PRIORITY)
-#define POLICY_NAME "PRIO "
-#elif defined(SCHEDULER_CFS)
-#define POLICY_NAME "CFS  "
-#elif defined(SCHEDULER_EDF)
-#define POLICY_NAME "EDF  "
-#elif defined(SCHEDULER_RM)
-#define POLICY_NAME "RM   "
-#elif defined(SCHEDULER_AEDF)
-#define POLICY_NAME "AEDF "
-#else
-#error "You should enable a scheduling algorithm!"
-#endif
-
 /// @brief If uncommented, it writes the logging on file.
 // #define WRITE_ON_FILE
 
@@ -82,7 +66,7 @@ static inline int __scheduler_feedback_deadline_check(void) { return (next_log <
 /// @brief Logs the scheduling statistics either on file or on the terminal.
 static inline void __scheduler_feedback_log(void)
 {
-    pr_info("Scheduling Statistics (%s)\n", POLICY_NAME);
+    pr_info("Scheduling Statistics\n");
 #ifdef WRITE_ON_FILE
     // Open the feedback file.
     if (feedback == NULL) {
@@ -101,10 +85,13 @@ static inline void __scheduler_feedback_log(void)
     for (size_t i = 0; i < PID_MAX_LIMIT; ++i) {
         if (arr_stats[i].task) {
             float tcpu = ((float)arr_stats[i].occur * 100.0) / total_occurrences;
-            pr_info("[%3d] | %-18s | -> TCPU: %.2f%% \n", arr_stats[i].task->pid, arr_stats[i].task->name, tcpu);
+            pr_info(
+                "[%3d] | %-18s | %-8s | -> TCPU: %.2f%% \n", arr_stats[i].task->pid, arr_stats[i].task->name,
+                arr_stats[i].task->se.sched_class->name, tcpu);
 #ifdef WRITE_ON_FILE
             written = sprintf(
-                buffer, "[%3d] | %-18s | -> TCPU: %.2f%% \n", arr_stats[i].task->pid, arr_stats[i].task->name, tcpu);
+                buffer, "[%3d] | %-18s | %-8s | -> TCPU: %.2f%% \n", arr_stats[i].task->pid, arr_stats[i].task->name,
+                arr_stats[i].task->se.sched_class->name, tcpu);
             vfs_write(feedback, buffer, offset, written);
             offset += written;
 #endif
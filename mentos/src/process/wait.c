@@ -12,9 +12,11 @@
 #include "process/wait.h"
 
 #include "assert.h"
+#include "errno.h"
 #include "mem/slab.h"
 #include "process/scheduler.h"
 #include "string.h"
+#include "system/signal.h"
 
 /// @brief Adds the entry to the wait queue.
 /// @param head the wait queue.
@@ -66,6 +68,9 @@ int default_wake_function(wait_queue_entry_t *entry, unsigned mode, int sync)
         // Set the task state to the specified mode.
         entry->task->state = mode;
 
+        // Check if the task must preempt the current one.
+        sched_class_check_preempt(&runqueue, entry->task);
+
         // Optionally handle sync-specific operations here if needed.
         // For now, sync is unused.
 
@@ -186,6 +191,15 @@ wait_queue_entry_t *sleep_on(wait_queue_head_t *head)
     // Set the task state to uninterruptible to indicate it is sleeping.
     sleeping_task->state = TASK_UNINTERRUPTIBLE;
 
+    // A task woken up by a signal is still in the queue, and might come back
+    // here: reuse its entry.
+    list_for_each_decl (it, &head->task_list) {
+        wait_queue_entry_t *entry = list_entry(it, wait_queue_entry_t, task_list);
+        if (entry->task == sleeping_task) {
+            return entry;
+        }
+    }
+
     // Allocate memory for a new wait queue entry.
     wait_queue_entry_t *entry = wait_queue_entry_alloc();
     if (!entry) {
@@ -203,3 +217,64 @@ wait_queue_entry_t *sleep_on(wait_queue_head_t *head)
 
     return entry;
 }
+
+int wait_on(wait_queue_head_t *head)
+{
+    // Validate input parameters.
+    if (!head) {
+        pr_err("Wait queue head is NULL.\n");
+        return -1;
+    }
+    task_struct *sleeping_task = scheduler_get_current_process();
+    // Leave the CPU, unless a signal already arrived. Either way, the task
+    // runs again once it is woken up, or a signal is sent to it.
+    if (!signal_interrupt_pending(sleeping_task)) {
+        sleeping_task->state = TASK_INTERRUPTIBLE;
+        schedule();
+    }
+    sleeping_task->state = TASK_RUNNING;
+    // If the entry is still in the queue, we were not woken up by it.
+    int interrupted = 0;
+    list_for_each_safe_decl(it, store, &head->task_list)
+    {
+        wait_queue_entry_t *entry = list_entry(it, wait_queue_entry_t, task_list);
+        if (entry->task == sleeping_task) {
+            remove_wait_queue(head, entry);
+            wait_queue_entry_dealloc(entry);
+            interrupted = 1;
+        }
+    }
+    return (interrupted && signal_interrupt_pending(sleeping_task)) ? -EINTR : 0;
+}
+
+int interruptible_sleep_on(wait_queue_head_t *head)
+{
+    if (!sleep_on(head)) {
+        pr_err("Failed to put the process to sleep.\n");
+        return -1;
+    }
+    return wait_on(head);
+}
+
+int wake_up_all(wait_queue_head_t *head)
+{
+    // Validate input parameters.
+    if (!head) {
+        pr_err("Wait queue head is NULL.\n");
+        return 0;
+    }
+
+    int woken = 0;
+    list_for_each_safe_decl(it, store, &head->task_list)
+    {
+        wait_queue_entry_t *entry = list_entry(it, wait_queue_entry_t, task_list);
+        // Execute the entry's wakeup test function.
+        if (entry->func(entry, TASK_RUNNING, 0)) {
+            // Remove the entry from the list, and free its memory.
+            remove_wait_queue(head, entry);
+            wait_queue_entry_dealloc(entry);
+            ++woken;
+        }
+    }
+    return woken;
+}
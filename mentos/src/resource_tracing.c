@@ -11,8 +11,15 @@
 #define __DEBUG_LEVEL__  LOGLEVEL_NOTICE ///< Set log level.
 #include "io/debug.h"                    // Include debugging functions.
 
+#include "stdio.h"
+#include "string.h"
+
 #define MAX_TRACKED_RESOURCES    1024 ///< Maximum number of tracked resources.
 #define MAX_REGISTERED_RESOURCES 128  ///< Maximum number of registered resources.
+#define MAX_ALLOC_RECORDS        4096 ///< Maximum number of allocations recorded by the profiler.
+#define MAX_ALLOC_SITES          512  ///< Maximum number of allocation sites known by the profiler.
+#define POINTER_HASH_BUCKETS     1024 ///< Number of buckets of the tables indexed by pointer (power of two).
+#define ALLOC_SITE_BUCKETS       1024 ///< Number of slots of the allocation sites table (power of two).
 
 static struct {
     int id;           ///< The id of the resource.
@@ -21,14 +28,87 @@ static struct {
 /// @brief The resource registry.
 resource_registry[MAX_REGISTERED_RESOURCES];
 
+/// @brief A tracked resource, chained inside the buckets of the tracker.
+typedef struct resource_info {
+    int resource_id;            ///< The id of the resource.
+    const char *file;           ///< The file where the resource was registered.
+    int line;                   ///< The line where the resource was registered.
+    void *ptr;                  ///< The pointer to the resource.
+    struct resource_info *next; ///< The next entry in the bucket, or in the free list.
+} resource_info_t;
+
 static struct {
-    int resource_id;  ///< The id of the resource.
-    const char *file; ///< The file where the resource was registered.
-    int line;         ///< The line where the resource was registered.
-    void *ptr;        ///< The pointer to the resource.
+    /// @brief The pool of entries.
+    resource_info_t entries[MAX_TRACKED_RESOURCES];
+    /// @brief The hash table, indexed by pointer.
+    resource_info_t *buckets[POINTER_HASH_BUCKETS];
+    /// @brief The list of unused entries.
+    resource_info_t *free_list;
 }
 /// @brief The resource tracker.
-resource_tracker[MAX_TRACKED_RESOURCES];
+resource_tracker;
+
+/// @brief Statistics of a place of the kernel which allocates memory.
+typedef struct alloc_site {
+    const char *file;        ///< The file of the allocation site.
+    const char *fun;         ///< The function of the allocation site.
+    int line;                ///< The line of the allocation site.
+    unsigned int live_bytes; ///< The memory currently held by the site.
+    unsigned int live_count; ///< The number of allocations currently held by the site.
+    unsigned int peak_bytes; ///< The maximum value reached by live_bytes.
+    unsigned int allocs;     ///< The total number of allocations.
+    unsigned int frees;      ///< The total number of frees.
+} alloc_site_t;
+
+/// @brief An allocation recorded by the profiler, chained inside its buckets.
+typedef struct alloc_record {
+    void *ptr;                 ///< The allocated memory.
+    unsigned int size;         ///< The size of the allocation.
+    alloc_site_t *site;        ///< The site which performed the allocation.
+    struct alloc_record *next; ///< The next record in the bucket, or in the free list.
+} alloc_record_t;
+
+static struct {
+    /// @brief If new allocations should be recorded.
+    int enabled;
+    /// @brief The pool of records, used up to `records_used` before relying on the free list.
+    alloc_record_t records[MAX_ALLOC_RECORDS];
+    /// @brief The hash table of records, indexed by pointer.
+    alloc_record_t *buckets[POINTER_HASH_BUCKETS];
+    /// @brief The list of released records.
+    alloc_record_t *free_list;
+    /// @brief The number of records taken from the pool.
+    unsigned int records_used;
+    /// @brief The number of records currently in use.
+    unsigned int records_live;
+    /// @brief The allocation sites.
+    alloc_site_t sites[MAX_ALLOC_SITES];
+    /// @brief The number of allocation sites.
+    unsigned int sites_count;
+    /// @brief Open addressing table of the sites, holds the index of the site plus one (0 means empty).
+    unsigned short site_slots[ALLOC_SITE_BUCKETS];
+    /// @brief Allocations which were not recorded, because we ran out of records or sites.
+    unsigned int dropped;
+}
+/// @brief The allocation profiler. Everything is statically allocated, since
+/// it is called by the allocator itself.
+alloc_profiler = {
+#ifdef ENABLE_ALLOC_PROFILER
+    .enabled = 1,
+#else
+    .enabled = 0,
+#endif
+};
+
+/// @brief Computes the bucket of a pointer.
+/// @param ptr The pointer.
+/// @return The index of the bucket.
+static inline unsigned int __pointer_hash(void *ptr)
+{
+    // Allocations are at least 16 bytes aligned, drop the low bits before the
+    // multiplicative hashing.
+    return ((((unsigned int)ptr) >> 4U) * 2654435761U) >> 22U;
+}
 
 void resource_register_init(void)
 {
@@ -36,11 +116,14 @@ void resource_register_init(void)
         resource_registry[i].id   = -1;
         resource_registry[i].name = 0;
     }
+    for (unsigned i = 0; i < POINTER_HASH_BUCKETS; ++i) {
+        resource_tracker.buckets[i] = 0;
+    }
+    resource_tracker.free_list = 0;
     for (unsigned i = 0; i < MAX_TRACKED_RESOURCES; ++i) {
-        resource_tracker[i].resource_id = 0;
-        resource_tracker[i].file        = 0;
-        resource_tracker[i].line        = 0;
-        resource_tracker[i].ptr         = 0;
+        resource_tracker.entries[i].ptr  = 0;
+        resource_tracker.entries[i].next = resource_tracker.free_list;
+        resource_tracker.free_list       = &resource_tracker.entries[i];
     }
 }
 
@@ -94,25 +177,36 @@ void print_resource_registry(void)
 
 void store_resource_info(int resource_id, const char *file, int line, void *ptr)
 {
-    for (unsigned i = 0; i < MAX_TRACKED_RESOURCES; ++i) {
-        if (resource_tracker[i].ptr == 0) {
-            resource_tracker[i].resource_id = resource_id;
-            resource_tracker[i].file        = file;
-            resource_tracker[i].line        = line;
-            resource_tracker[i].ptr         = ptr;
-            return;
-        }
+    resource_info_t *info = resource_tracker.free_list;
+    if (!info) {
+        pr_warning("Cannot track 0x%p from %s:%d, too many tracked resources.\n", ptr, file, line);
+        return;
     }
+    resource_tracker.free_list = info->next;
+    info->resource_id          = resource_id;
+    info->file                 = file;
+    info->line                 = line;
+    info->ptr                  = ptr;
+    // Place it at the head of its bucket.
+    unsigned int bucket              = __pointer_hash(ptr);
+    info->next                       = resource_tracker.buckets[bucket];
+    resource_tracker.buckets[bucket] = info;
 }
 
 void clear_resource_info(void *ptr)
 {
-    for (unsigned i = 0; i < MAX_TRACKED_RESOURCES; ++i) {
-        if (resource_tracker[i].ptr == ptr) {
-            resource_tracker[i].resource_id = -1;
-            resource_tracker[i].file        = 0;
-            resource_tracker[i].line        = -1;
-            resource_tracker[i].ptr         = 0;
+    resource_info_t **it = &resource_tracker.buckets[__pointer_hash(ptr)];
+    for (; *it; it = &(*it)->next) {
+        if ((*it)->ptr == ptr) {
+            resource_info_t *info = *it;
+            // Unlink the entry, and give it back to the free list.
+            *it                        = info->next;
+            info->resource_id          = -1;
+            info->file                 = 0;
+            info->line                 = -1;
+            info->ptr                  = 0;
+            info->next                 = resource_tracker.free_list;
+            resource_tracker.free_list = info;
             return;
         }
     }
@@ -122,16 +216,182 @@ void print_resource_usage(int resource_id, const char *(*printer)(void *ptr))
 {
     pr_notice("Checking resource usage (resource_id=%d, name: %s):\n", resource_id, get_resource_name(resource_id));
     for (unsigned i = 0; i < MAX_TRACKED_RESOURCES; ++i) {
-        if (resource_tracker[i].ptr && (resource_id == -1 || (resource_tracker[i].resource_id == resource_id))) {
+        resource_info_t *info = &resource_tracker.entries[i];
+        if (info->ptr && (resource_id == -1 || (info->resource_id == resource_id))) {
             if (printer) {
-                pr_notice(
-                    "    %s:%d, %s\n", resource_tracker[i].file, resource_tracker[i].line,
-                    printer(resource_tracker[i].ptr));
+                pr_notice("    %s:%d, %s\n", info->file, info->line, printer(info->ptr));
             } else {
-                pr_notice(
-                    "    ptr=0x%p, consumed at %s:%d\n", resource_tracker[i].ptr, resource_tracker[i].file,
-                    resource_tracker[i].line);
+                pr_notice("    ptr=0x%p, consumed at %s:%d\n", info->ptr, info->file, info->line);
+            }
+        }
+    }
+}
+
+void alloc_profiler_enable(int enable)
+{
+    alloc_profiler.enabled = (enable != 0);
+    pr_notice("Allocation profiler %s.\n", alloc_profiler.enabled ? "enabled" : "disabled");
+}
+
+int alloc_profiler_enabled(void) { return alloc_profiler.enabled; }
+
+void alloc_profiler_reset(void)
+{
+    memset(alloc_profiler.buckets, 0, sizeof(alloc_profiler.buckets));
+    memset(alloc_profiler.sites, 0, sizeof(alloc_profiler.sites));
+    memset(alloc_profiler.site_slots, 0, sizeof(alloc_profiler.site_slots));
+    alloc_profiler.free_list    = 0;
+    alloc_profiler.records_used = 0;
+    alloc_profiler.records_live = 0;
+    alloc_profiler.sites_count  = 0;
+    alloc_profiler.dropped      = 0;
+}
+
+/// @brief Searches the allocation site, and creates it if it is not there.
+/// @param file The file of the allocation site.
+/// @param fun The function of the allocation site.
+/// @param line The line of the allocation site.
+/// @return The allocation site, or NULL if there is no more space for new sites.
+static alloc_site_t *__alloc_profiler_get_site(const char *file, const char *fun, int line)
+{
+    // Sites are mostly told apart by their line, mix it with the function name.
+    unsigned int hash = (unsigned int)line * 2654435761U;
+    for (const char *c = fun; *c; ++c) {
+        hash = (hash ^ (unsigned char)*c) * 16777619U;
+    }
+    for (unsigned int probe = 0; probe < ALLOC_SITE_BUCKETS; ++probe) {
+        unsigned short *slot = &alloc_profiler.site_slots[(hash + probe) & (ALLOC_SITE_BUCKETS - 1)];
+        if (*slot == 0) {
+            // Not found, add a new site in the empty slot.
+            if (alloc_profiler.sites_count == MAX_ALLOC_SITES) {
+                return NULL;
             }
+            alloc_site_t *site = &alloc_profiler.sites[alloc_profiler.sites_count++];
+            site->file         = file;
+            site->fun          = fun;
+            site->line         = line;
+            *slot              = alloc_profiler.sites_count;
+            return site;
+        }
+        alloc_site_t *site = &alloc_profiler.sites[*slot - 1];
+        // The same strings usually come with the same pointers, compare the content only if needed.
+        if ((site->line == line) && ((site->fun == fun) || !strcmp(site->fun, fun)) &&
+            ((site->file == file) || !strcmp(site->file, file))) {
+            return site;
+        }
+    }
+    return NULL;
+}
+
+void alloc_profiler_alloc(const char *file, const char *fun, int line, void *ptr, size_t size)
+{
+    if (!alloc_profiler.enabled || !ptr) {
+        return;
+    }
+    // If the pointer is still recorded, we missed its free (e.g., it was freed
+    // through a path we do not see), drop the old record first.
+    alloc_profiler_free(ptr);
+    // Get a record.
+    alloc_record_t *record = alloc_profiler.free_list;
+    if (record) {
+        alloc_profiler.free_list = record->next;
+    } else if (alloc_profiler.records_used < MAX_ALLOC_RECORDS) {
+        record = &alloc_profiler.records[alloc_profiler.records_used++];
+    } else {
+        ++alloc_profiler.dropped;
+        return;
+    }
+    // Get the site.
+    alloc_site_t *site = __alloc_profiler_get_site(file, fun, line);
+    if (!site) {
+        record->next             = alloc_profiler.free_list;
+        alloc_profiler.free_list = record;
+        ++alloc_profiler.dropped;
+        return;
+    }
+    // Update the statistics of the site.
+    site->live_bytes += size;
+    site->live_count += 1;
+    site->allocs += 1;
+    if (site->live_bytes > site->peak_bytes) {
+        site->peak_bytes = site->live_bytes;
+    }
+    // Fill the record, and place it at the head of its bucket.
+    unsigned int bucket            = __pointer_hash(ptr);
+    record->ptr                    = ptr;
+    record->size                   = size;
+    record->site                   = site;
+    record->next                   = alloc_profiler.buckets[bucket];
+    alloc_profiler.buckets[bucket] = record;
+    ++alloc_profiler.records_live;
+}
+
+void alloc_profiler_free(void *ptr)
+{
+    // Fast path, taken when the profiler has never been enabled.
+    if (alloc_profiler.records_live == 0) {
+        return;
+    }
+    alloc_record_t **it = &alloc_profiler.buckets[__pointer_hash(ptr)];
+    for (; *it; it = &(*it)->next) {
+        if ((*it)->ptr == ptr) {
+            alloc_record_t *record = *it;
+            // Update the statistics of the site.
+            record->site->live_bytes -= record->size;
+            record->site->live_count -= 1;
+            record->site->frees += 1;
+            // Unlink the record, and give it back to the free list.
+            *it                      = record->next;
+            record->ptr              = NULL;
+            record->next             = alloc_profiler.free_list;
+            alloc_profiler.free_list = record;
+            --alloc_profiler.records_live;
+            return;
+        }
+    }
+}
+
+ssize_t alloc_profiler_print(char *buffer, size_t bufsize)
+{
+    static unsigned short order[MAX_ALLOC_SITES];
+    unsigned int count = alloc_profiler.sites_count;
+    ssize_t written;
+    int ret;
+
+    // Sort the sites by live bytes, then by peak. There are few sites, and
+    // they are only sorted when reading the report.
+    for (unsigned int i = 0; i < count; ++i) {
+        alloc_site_t *site = &alloc_profiler.sites[i];
+        unsigned int j     = i;
+        for (; j > 0; --j) {
+            alloc_site_t *other = &alloc_profiler.sites[order[j - 1]];
+            if ((other->live_bytes > site->live_bytes) ||
+                ((other->live_bytes == site->live_bytes) && (other->peak_bytes >= site->peak_bytes))) {
+                break;
+            }
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+
+    written = snprintf(
+        buffer, bufsize, "# profiler: %s, sites: %u/%u, records: %u/%u, dropped: %u\n",
+        alloc_profiler.enabled ? "on" : "off", count, MAX_ALLOC_SITES, alloc_profiler.records_live, MAX_ALLOC_RECORDS,
+        alloc_profiler.dropped);
+    written += snprintf(
+        buffer + written, bufsize - written, "# %10s %8s %10s %8s %8s  %s\n", "live", "objects", "peak", "allocs",
+        "frees", "site");
+    for (unsigned int i = 0; i < count; ++i) {
+        alloc_site_t *site = &alloc_profiler.sites[order[i]];
+        ret                = snprintf(
+            buffer + written, bufsize - written, "  %10u %8u %10u %8u %8u  %s:%d %s\n", site->live_bytes,
+            site->live_count, site->peak_bytes, site->allocs, site->frees, site->file, site->line, site->fun);
+        // Stop when the buffer is full, the most relevant sites come first.
+        if ((ret <= 0) || ((written + ret) >= (ssize_t)bufsize - 1)) {
+            buffer[written] = 0;
+            break;
         }
+        written += ret;
     }
+    return written;
 }
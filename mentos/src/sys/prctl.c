@@ -0,0 +1,36 @@
+/// @file prctl.c
+/// @brief Operations on the calling process.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+// Setup the logging for this file (do this before any other include).
+#include "sys/kernel_levels.h"           // Include kernel log levels.
+#define __DEBUG_HEADER__ "[PRCTL ]"      ///< Change header.
+#define __DEBUG_LEVEL__  LOGLEVEL_NOTICE ///< Set log level.
+#include "io/debug.h"                    // Include debugging functions.
+
+#include "sys/prctl.h"
+
+#include "errno.h"
+#include "hardware/timer.h"
+#include "limits.h"
+#include "process/scheduler.h"
+
+int sys_prctl(int option, unsigned long arg2)
+{
+    task_struct *task = scheduler_get_current_process();
+    switch (option) {
+    case PR_SET_TIMERSLACK:
+        // The slack is returned as an int, keep it positive.
+        if (arg2 > INT_MAX) {
+            return -EINVAL;
+        }
+        task->timer_slack_ns = arg2;
+        pr_debug("Timer slack of process %d set to %u ns.\n", task->pid, arg2);
+        return 0;
+    case PR_GET_TIMERSLACK:
+        return (int)timer_get_slack(task);
+    default:
+        return -EINVAL;
+    }
+}
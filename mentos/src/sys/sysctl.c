@@ -0,0 +1,172 @@
+/// @file sysctl.c
+/// @brief Kernel tunables, set from the command line or through `/proc/sys`.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+// Setup the logging for this file (do this before any other include).
+#include "sys/kernel_levels.h"           // Include kernel log levels.
+#define __DEBUG_HEADER__ "[SYSCTL]"      ///< Change header.
+#define __DEBUG_LEVEL__  LOGLEVEL_NOTICE ///< Set log level.
+#include "io/debug.h"                    // Include debugging functions.
+
+#include "sys/sysctl.h"
+
+#include "ctype.h"
+#include "errno.h"
+#include "fs/pipe.h"
+#include "hardware/timer.h"
+#include "mem/paging.h"
+#include "mem/slab.h"
+#include "process/scheduler.h"
+#include "string.h"
+
+/// The maximum length of the kernel command line we keep.
+#define CMDLINE_MAX 256
+
+/// The kernel command line.
+static char cmdline[CMDLINE_MAX] = {0};
+
+/// The table of tunables.
+static sysctl_entry_t sysctl_table[] = {
+    {"kernel/printk", NULL, get_log_level, set_log_level, LOGLEVEL_EMERG, LOGLEVEL_DEBUG},
+    {"kernel/sched_rr_timeslice_ms", &sysctl_sched_rr_timeslice_ms, NULL, NULL, 1, 10000},
+    {"kernel/timer_slack_ns", &sysctl_timer_slack_ns, NULL, NULL, 0, 100000000},
+    {"vm/readahead_pages", &sysctl_vm_readahead_pages, NULL, NULL, 1, 256},
+    {"vm/slab_refill_count", &sysctl_vm_slab_refill_count, NULL, NULL, 1, 1024},
+    {"fs/pipe_size", &sysctl_fs_pipe_size, NULL, NULL, PIPE_BUFFER_SIZE, PIPE_NUM_BUFFERS * PIPE_BUFFER_SIZE},
+};
+
+sysctl_entry_t *sysctl_get_entry(size_t index)
+{
+    if (index >= count_of(sysctl_table)) {
+        return NULL;
+    }
+    return &sysctl_table[index];
+}
+
+/// @brief Compares the path of a tunable with the given one, where '.' can
+/// be used in place of '/'.
+/// @param path the path of the tunable.
+/// @param name the path to compare, it ends at the first '=' or blank.
+/// @return 1 if they match, 0 otherwise.
+static inline int __sysctl_path_match(const char *path, const char *name)
+{
+    for (; *path; ++path, ++name) {
+        if ((*path != *name) && !((*path == '/') && (*name == '.'))) {
+            return 0;
+        }
+    }
+    return (*name == 0) || (*name == '=') || (*name == ' ');
+}
+
+sysctl_entry_t *sysctl_find(const char *path)
+{
+    for (size_t i = 0; i < count_of(sysctl_table); ++i) {
+        if (__sysctl_path_match(sysctl_table[i].path, path)) {
+            return &sysctl_table[i];
+        }
+    }
+    return NULL;
+}
+
+int sysctl_read(sysctl_entry_t *entry) { return entry->data ? *entry->data : entry->get(); }
+
+ssize_t sysctl_write(sysctl_entry_t *entry, const char *buffer, size_t nbyte)
+{
+    size_t it = 0;
+    int negative = 0, value = 0, digits = 0;
+    if ((it < nbyte) && ((buffer[it] == '-') || (buffer[it] == '+'))) {
+        negative = (buffer[it++] == '-');
+    }
+    for (; (it < nbyte) && isdigit(buffer[it]) && (value <= entry->max); ++it, ++digits) {
+        value = (value * 10) + (buffer[it] - '0');
+    }
+    // Allow a trailing newline (e.g., when using echo).
+    while ((it < nbyte) && ((buffer[it] == '\n') || (buffer[it] == ' ') || (buffer[it] == 0))) {
+        ++it;
+    }
+    value = negative ? -value : value;
+    if ((digits == 0) || (it < nbyte) || (value < entry->min) || (value > entry->max)) {
+        return -EINVAL;
+    }
+    if (entry->data) {
+        *entry->data = value;
+    } else {
+        entry->set(value);
+    }
+    pr_debug("Set `%s` to %d.\n", entry->path, value);
+    return nbyte;
+}
+
+/// @brief Applies an option of the command line.
+/// @param option the option, it ends at the first blank.
+static inline void __cmdline_apply(const char *option)
+{
+    sysctl_entry_t *entry = NULL;
+    const char *value     = strchr(option, '=');
+    // The dynamic debug query is quoted, since it contains blanks.
+    if (!strncmp(option, "dyndbg=\"", 8)) {
+        const char *end = strchr(option + 8, '"');
+        if (!end || (dyndbg_query(option + 8, end - (option + 8)) < 0)) {
+            pr_warning("Invalid dynamic debug query on the command line.\n");
+        }
+        return;
+    }
+    if (!strncmp(option, "loglevel=", 9)) {
+        entry = sysctl_find("kernel/printk");
+    } else if (!strncmp(option, "sysctl.", 7)) {
+        entry = sysctl_find(option + 7);
+    }
+    if (!entry || !value) {
+        return;
+    }
+    ++value;
+    size_t length = 0;
+    while (value[length] && (value[length] != ' ')) {
+        ++length;
+    }
+    if (sysctl_write(entry, value, length) < 0) {
+        pr_warning("Invalid value for `%s` on the command line.\n", entry->path);
+    }
+}
+
+void cmdline_parse(const char *line)
+{
+    if (!line) {
+        return;
+    }
+    strncpy(cmdline, line, CMDLINE_MAX - 1);
+    cmdline[CMDLINE_MAX - 1] = 0;
+    for (const char *it = cmdline; *it;) {
+        // Skip the blanks.
+        while (*it == ' ') {
+            ++it;
+        }
+        if (*it) {
+            __cmdline_apply(it);
+        }
+        // Move to the next option, the quoted blanks are part of the option.
+        for (int quoted = 0; *it && (quoted || (*it != ' ')); ++it) {
+            quoted ^= (*it == '"');
+        }
+    }
+}
+
+const char *cmdline_get(void) { return cmdline; }
+
+int cmdline_has_option(const char *option)
+{
+    size_t length = strlen(option);
+    for (const char *it = cmdline; *it;) {
+        while (*it == ' ') {
+            ++it;
+        }
+        if (!strncmp(it, option, length) && ((it[length] == 0) || (it[length] == ' ') || (it[length] == '='))) {
+            return 1;
+        }
+        for (int quoted = 0; *it && (quoted || (*it != ' ')); ++it) {
+            quoted ^= (*it == '"');
+        }
+    }
+    return 0;
+}
@@ -102,6 +102,33 @@ static int __sig_is_ignored(struct task_struct *t, int sig)
     //        here I'm also accepting as not-ignored a SIG_IGN which is a SIGCHLD.
 }
 
+/// @brief Checks if the signal is going to be discarded once delivered,
+/// because it is ignored either explicitly or by default.
+/// @param t   The task to which the signal belongs.
+/// @param sig The signal.
+/// @return 1 if the signal is discarded, 0 otherwise.
+static inline int __sig_is_discarded(struct task_struct *t, int sig)
+{
+    // Get the signal handler.
+    sighandler_t handler = __get_handler(t, sig);
+    if (handler == SIG_IGN) {
+        return 1;
+    }
+    // The signals whose default action is "ignore", see do_signal().
+    return (handler == SIG_DFL) && ((sig == SIGCONT) || (sig == SIGCHLD) || (sig == SIGURG) || (sig == SIGWINCH));
+}
+
+/// @brief Checks if the signal must interrupt the task, when it is sleeping
+/// in a system call. Signals which are going to be discarded do not.
+/// @param t   The task to which the signal belongs.
+/// @param sig The signal.
+/// @return 1 if the task must be woken up, 0 otherwise.
+static inline int __sig_interrupts_task(struct task_struct *t, int sig)
+{
+    // Blocked signals stay pending, and are handled once unblocked.
+    return !sigismember(&t->blocked, sig) && !__sig_is_discarded(t, sig);
+}
+
 /// @brief Allocate a new signal queue record.
 /// @param t     The task to which the signal belongs.
 /// @param sig   The signal to set.
@@ -166,6 +193,12 @@ static int __send_signal(int sig, siginfo_t *info, struct task_struct *t)
     }
     // Set that there is a signal pending.
     sigaddset(&t->pending.signal, sig);
+    // Interrupt the task, if it is sleeping in a system call: it finds out
+    // the signal when it runs again, and returns -EINTR.
+    if ((t->state == TASK_INTERRUPTIBLE) && __sig_interrupts_task(t, sig)) {
+        t->state = TASK_RUNNING;
+        sched_class_check_preempt(&runqueue, t);
+    }
     pr_debug(
         "Added pending signal (%2d:%s) to task (%2d:%s), pending `%d, %d`.\n", sig, strsignal(sig), t->pid, t->name,
         t->pending.signal.sig[0], t->pending.signal.sig[1]);
@@ -378,6 +411,8 @@ static int __notify_parent(struct task_struct *current, int signr)
     info.si_addr            = NULL;
     info.si_status          = 0;
     info.si_band            = 0;
+    // Wake up the parent even if the signal is ignored, it might be waiting for us.
+    wake_up_all(&current->parent->wait_chldexit);
     return __send_signal(signr, &info, current->parent);
 }
 
@@ -421,6 +456,9 @@ int stop_wake_function(wait_queue_entry_t *entry, unsigned mode, int sync)
         // Set the task state to the specified mode.
         entry->task->state = mode;
 
+        // Check if the task must preempt the current one.
+        sched_class_check_preempt(&runqueue, entry->task);
+
         // Optionally handle sync-specific operations here if needed.
         // For now, sync is unused.
 
@@ -433,9 +471,8 @@ int stop_wake_function(wait_queue_entry_t *entry, unsigned mode, int sync)
 
 /// @brief We do not consider group stopping because for now we don't have thread groups.
 /// @param current the current process.
-/// @param f the stack frame.
 /// @param signr signal number.
-static void __do_signal_stop(struct task_struct *current, struct pt_regs *f, int signr)
+static void __do_signal_stop(struct task_struct *current, int signr)
 {
     // The do_signal( ) function also sends a SIGCHLD signal to
     // the parent process of current, unless the parent has set
@@ -451,9 +488,11 @@ static void __do_signal_stop(struct task_struct *current, struct pt_regs *f, int
     entry->task->state        = TASK_STOPPED;
     entry->task->exit_code    = signr;
     entry->func               = stop_wake_function;
+    // Let the parent report the stop, if it is waiting with WUNTRACED.
+    wake_up_all(&current->parent->wait_chldexit);
 
-    // Call the scheduler.
-    scheduler_run(f);
+    // Leave the CPU, until a SIGCONT wakes us up.
+    schedule();
 }
 
 int do_signal(struct pt_regs *f)
@@ -552,7 +591,7 @@ int do_signal(struct pt_regs *f)
 
             case SIGSTOP:
                 __unlock_task_sighand(current_process);
-                __do_signal_stop(current_process, f, signr);
+                __do_signal_stop(current_process, signr);
                 __lock_task_sighand(current_process);
 
                 continue;
@@ -605,6 +644,22 @@ int do_signal(struct pt_regs *f)
     return 0;
 }
 
+int signal_pending(struct task_struct *t)
+{
+    return ((t->pending.signal.sig[0] & ~t->blocked.sig[0]) != 0) ||
+           ((t->pending.signal.sig[1] & ~t->blocked.sig[1]) != 0);
+}
+
+int signal_interrupt_pending(struct task_struct *t)
+{
+    for (int sig = 1; sig < NSIG; ++sig) {
+        if (sigismember(&t->pending.signal, sig) && __sig_interrupts_task(t, sig)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 int signals_init(void)
 {
     sigqueue_cachep = KMEM_CREATE(sigqueue_t);
@@ -664,6 +719,10 @@ void handle_stop_signal(int sig, siginfo_t *info, struct task_struct *p)
                     // Free its memory.
                     wait_queue_entry_dealloc(entry);
                     pr_debug("Restored process (%d) from stop.\n", p->pid);
+                    // Let the parent know that the child is running again.
+                    if (p->parent) {
+                        wake_up_all(&p->parent->wait_chldexit);
+                    }
                 } else {
                     pr_err("Failed to restore process (%d) from stop.\n", p->pid);
                 }
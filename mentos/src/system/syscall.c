@@ -49,81 +49,92 @@ static inline int sys_ni_syscall(void) { return -ENOSYS; }
 void syscall_init(void)
 {
     // Initialize the list of system calls.
-    sys_call_table[__NR_exit]           = (SystemCall)sys_exit;
-    sys_call_table[__NR_fork]           = (SystemCall)sys_fork;
-    sys_call_table[__NR_read]           = (SystemCall)sys_read;
-    sys_call_table[__NR_write]          = (SystemCall)sys_write;
-    sys_call_table[__NR_open]           = (SystemCall)sys_open;
-    sys_call_table[__NR_close]          = (SystemCall)sys_close;
-    sys_call_table[__NR_waitpid]        = (SystemCall)sys_waitpid;
-    sys_call_table[__NR_creat]          = (SystemCall)sys_creat;
-    sys_call_table[__NR_unlink]         = (SystemCall)sys_unlink;
-    sys_call_table[__NR_execve]         = (SystemCall)sys_execve;
-    sys_call_table[__NR_chdir]          = (SystemCall)sys_chdir;
-    sys_call_table[__NR_time]           = (SystemCall)sys_time;
-    sys_call_table[__NR_chmod]          = (SystemCall)sys_chmod;
-    sys_call_table[__NR_lchown]         = (SystemCall)sys_lchown;
-    sys_call_table[__NR_stat]           = (SystemCall)sys_stat;
-    sys_call_table[__NR_lseek]          = (SystemCall)sys_lseek;
-    sys_call_table[__NR_getpid]         = (SystemCall)sys_getpid;
-    sys_call_table[__NR_setuid]         = (SystemCall)sys_setuid;
-    sys_call_table[__NR_getuid]         = (SystemCall)sys_getuid;
-    sys_call_table[__NR_alarm]          = (SystemCall)sys_alarm;
-    sys_call_table[__NR_fstat]          = (SystemCall)sys_fstat;
-    sys_call_table[__NR_nice]           = (SystemCall)sys_nice;
-    sys_call_table[__NR_kill]           = (SystemCall)sys_kill;
-    sys_call_table[__NR_mkdir]          = (SystemCall)sys_mkdir;
-    sys_call_table[__NR_rmdir]          = (SystemCall)sys_rmdir;
-    sys_call_table[__NR_dup]            = (SystemCall)sys_dup;
-    sys_call_table[__NR_pipe]           = (SystemCall)sys_pipe;
-    sys_call_table[__NR_brk]            = (SystemCall)sys_brk;
-    sys_call_table[__NR_setgid]         = (SystemCall)sys_setgid;
-    sys_call_table[__NR_getgid]         = (SystemCall)sys_getgid;
-    sys_call_table[__NR_signal]         = (SystemCall)sys_signal;
-    sys_call_table[__NR_geteuid]        = (SystemCall)sys_geteuid;
-    sys_call_table[__NR_getegid]        = (SystemCall)sys_getegid;
-    sys_call_table[__NR_ioctl]          = (SystemCall)sys_ioctl;
-    sys_call_table[__NR_fcntl]          = (SystemCall)sys_fcntl;
-    sys_call_table[__NR_setpgid]        = (SystemCall)sys_setpgid;
-    sys_call_table[__NR_getppid]        = (SystemCall)sys_getppid;
-    sys_call_table[__NR_setsid]         = (SystemCall)sys_setsid;
-    sys_call_table[__NR_sigaction]      = (SystemCall)sys_sigaction;
-    sys_call_table[__NR_setreuid]       = (SystemCall)sys_setreuid;
-    sys_call_table[__NR_setregid]       = (SystemCall)sys_setregid;
-    sys_call_table[__NR_symlink]        = (SystemCall)sys_symlink;
-    sys_call_table[__NR_readlink]       = (SystemCall)sys_readlink;
-    sys_call_table[__NR_reboot]         = (SystemCall)sys_reboot;
-    sys_call_table[__NR_mmap]           = (SystemCall)sys_mmap;
-    sys_call_table[__NR_munmap]         = (SystemCall)sys_munmap;
-    sys_call_table[__NR_syslog]         = (SystemCall)sys_syslog;
-    sys_call_table[__NR_fchmod]         = (SystemCall)sys_fchmod;
-    sys_call_table[__NR_fchown]         = (SystemCall)sys_fchown;
-    sys_call_table[__NR_setitimer]      = (SystemCall)sys_setitimer;
-    sys_call_table[__NR_getitimer]      = (SystemCall)sys_getitimer;
-    sys_call_table[__NR_uname]          = (SystemCall)sys_uname;
-    sys_call_table[__NR_sigreturn]      = (SystemCall)sys_sigreturn;
-    sys_call_table[__NR_sigprocmask]    = (SystemCall)sys_sigprocmask;
-    sys_call_table[__NR_getpgid]        = (SystemCall)sys_getpgid;
-    sys_call_table[__NR_fchdir]         = (SystemCall)sys_fchdir;
-    sys_call_table[__NR_getdents]       = (SystemCall)sys_getdents;
-    sys_call_table[__NR_getsid]         = (SystemCall)sys_getsid;
-    sys_call_table[__NR_sched_setparam] = (SystemCall)sys_sched_setparam;
-    sys_call_table[__NR_sched_getparam] = (SystemCall)sys_sched_getparam;
-    sys_call_table[__NR_nanosleep]      = (SystemCall)sys_nanosleep;
-    sys_call_table[__NR_chown]          = (SystemCall)sys_chown;
-    sys_call_table[__NR_getcwd]         = (SystemCall)sys_getcwd;
-    sys_call_table[__NR_waitperiod]     = (SystemCall)sys_waitperiod;
-    sys_call_table[__NR_msgctl]         = (SystemCall)sys_msgctl;
-    sys_call_table[__NR_msgget]         = (SystemCall)sys_msgget;
-    sys_call_table[__NR_msgrcv]         = (SystemCall)sys_msgrcv;
-    sys_call_table[__NR_msgsnd]         = (SystemCall)sys_msgsnd;
-    sys_call_table[__NR_semctl]         = (SystemCall)sys_semctl;
-    sys_call_table[__NR_semget]         = (SystemCall)sys_semget;
-    sys_call_table[__NR_semop]          = (SystemCall)sys_semop;
-    sys_call_table[__NR_shmat]          = (SystemCall)sys_shmat;
-    sys_call_table[__NR_shmctl]         = (SystemCall)sys_shmctl;
-    sys_call_table[__NR_shmdt]          = (SystemCall)sys_shmdt;
-    sys_call_table[__NR_shmget]         = (SystemCall)sys_shmget;
+    sys_call_table[__NR_exit]               = (SystemCall)sys_exit;
+    sys_call_table[__NR_fork]               = (SystemCall)sys_fork;
+    sys_call_table[__NR_read]               = (SystemCall)sys_read;
+    sys_call_table[__NR_write]              = (SystemCall)sys_write;
+    sys_call_table[__NR_open]               = (SystemCall)sys_open;
+    sys_call_table[__NR_close]              = (SystemCall)sys_close;
+    sys_call_table[__NR_waitpid]            = (SystemCall)sys_waitpid;
+    sys_call_table[__NR_creat]              = (SystemCall)sys_creat;
+    sys_call_table[__NR_unlink]             = (SystemCall)sys_unlink;
+    sys_call_table[__NR_execve]             = (SystemCall)sys_execve;
+    sys_call_table[__NR_chdir]              = (SystemCall)sys_chdir;
+    sys_call_table[__NR_time]               = (SystemCall)sys_time;
+    sys_call_table[__NR_chmod]              = (SystemCall)sys_chmod;
+    sys_call_table[__NR_lchown]             = (SystemCall)sys_lchown;
+    sys_call_table[__NR_stat]               = (SystemCall)sys_stat;
+    sys_call_table[__NR_lseek]              = (SystemCall)sys_lseek;
+    sys_call_table[__NR_getpid]             = (SystemCall)sys_getpid;
+    sys_call_table[__NR_setuid]             = (SystemCall)sys_setuid;
+    sys_call_table[__NR_getuid]             = (SystemCall)sys_getuid;
+    sys_call_table[__NR_alarm]              = (SystemCall)sys_alarm;
+    sys_call_table[__NR_fstat]              = (SystemCall)sys_fstat;
+    sys_call_table[__NR_nice]               = (SystemCall)sys_nice;
+    sys_call_table[__NR_kill]               = (SystemCall)sys_kill;
+    sys_call_table[__NR_mkdir]              = (SystemCall)sys_mkdir;
+    sys_call_table[__NR_rmdir]              = (SystemCall)sys_rmdir;
+    sys_call_table[__NR_dup]                = (SystemCall)sys_dup;
+    sys_call_table[__NR_pipe]               = (SystemCall)sys_pipe;
+    sys_call_table[__NR_brk]                = (SystemCall)sys_brk;
+    sys_call_table[__NR_setgid]             = (SystemCall)sys_setgid;
+    sys_call_table[__NR_getgid]             = (SystemCall)sys_getgid;
+    sys_call_table[__NR_signal]             = (SystemCall)sys_signal;
+    sys_call_table[__NR_geteuid]            = (SystemCall)sys_geteuid;
+    sys_call_table[__NR_getegid]            = (SystemCall)sys_getegid;
+    sys_call_table[__NR_ioctl]              = (SystemCall)sys_ioctl;
+    sys_call_table[__NR_fcntl]              = (SystemCall)sys_fcntl;
+    sys_call_table[__NR_setpgid]            = (SystemCall)sys_setpgid;
+    sys_call_table[__NR_getppid]            = (SystemCall)sys_getppid;
+    sys_call_table[__NR_setsid]             = (SystemCall)sys_setsid;
+    sys_call_table[__NR_sigaction]          = (SystemCall)sys_sigaction;
+    sys_call_table[__NR_setreuid]           = (SystemCall)sys_setreuid;
+    sys_call_table[__NR_setregid]           = (SystemCall)sys_setregid;
+    sys_call_table[__NR_gettimeofday]       = (SystemCall)sys_gettimeofday;
+    sys_call_table[__NR_settimeofday]       = (SystemCall)sys_settimeofday;
+    sys_call_table[__NR_symlink]            = (SystemCall)sys_symlink;
+    sys_call_table[__NR_readlink]           = (SystemCall)sys_readlink;
+    sys_call_table[__NR_reboot]             = (SystemCall)sys_reboot;
+    sys_call_table[__NR_mmap]               = (SystemCall)sys_mmap;
+    sys_call_table[__NR_munmap]             = (SystemCall)sys_munmap;
+    sys_call_table[__NR_syslog]             = (SystemCall)sys_syslog;
+    sys_call_table[__NR_fchmod]             = (SystemCall)sys_fchmod;
+    sys_call_table[__NR_fchown]             = (SystemCall)sys_fchown;
+    sys_call_table[__NR_setitimer]          = (SystemCall)sys_setitimer;
+    sys_call_table[__NR_getitimer]          = (SystemCall)sys_getitimer;
+    sys_call_table[__NR_uname]              = (SystemCall)sys_uname;
+    sys_call_table[__NR_sigreturn]          = (SystemCall)sys_sigreturn;
+    sys_call_table[__NR_sigprocmask]        = (SystemCall)sys_sigprocmask;
+    sys_call_table[__NR_getpgid]            = (SystemCall)sys_getpgid;
+    sys_call_table[__NR_fchdir]             = (SystemCall)sys_fchdir;
+    sys_call_table[__NR_getdents]           = (SystemCall)sys_getdents;
+    sys_call_table[__NR_flock]              = (SystemCall)sys_flock;
+    sys_call_table[__NR_getsid]             = (SystemCall)sys_getsid;
+    sys_call_table[__NR_mlock]              = (SystemCall)sys_mlock;
+    sys_call_table[__NR_munlock]            = (SystemCall)sys_munlock;
+    sys_call_table[__NR_sched_setparam]     = (SystemCall)sys_sched_setparam;
+    sys_call_table[__NR_sched_getparam]     = (SystemCall)sys_sched_getparam;
+    sys_call_table[__NR_sched_setscheduler] = (SystemCall)sys_sched_setscheduler;
+    sys_call_table[__NR_sched_getscheduler] = (SystemCall)sys_sched_getscheduler;
+    sys_call_table[__NR_nanosleep]          = (SystemCall)sys_nanosleep;
+    sys_call_table[__NR_chown]              = (SystemCall)sys_chown;
+    sys_call_table[__NR_getcwd]             = (SystemCall)sys_getcwd;
+    sys_call_table[__NR_madvise]            = (SystemCall)sys_madvise;
+    sys_call_table[__NR_clock_gettime]      = (SystemCall)sys_clock_gettime;
+    sys_call_table[__NR_waitperiod]         = (SystemCall)sys_waitperiod;
+    sys_call_table[__NR_msgctl]             = (SystemCall)sys_msgctl;
+    sys_call_table[__NR_msgget]             = (SystemCall)sys_msgget;
+    sys_call_table[__NR_msgrcv]             = (SystemCall)sys_msgrcv;
+    sys_call_table[__NR_msgsnd]             = (SystemCall)sys_msgsnd;
+    sys_call_table[__NR_semctl]             = (SystemCall)sys_semctl;
+    sys_call_table[__NR_semget]             = (SystemCall)sys_semget;
+    sys_call_table[__NR_semop]              = (SystemCall)sys_semop;
+    sys_call_table[__NR_shmat]              = (SystemCall)sys_shmat;
+    sys_call_table[__NR_shmctl]             = (SystemCall)sys_shmctl;
+    sys_call_table[__NR_shmdt]              = (SystemCall)sys_shmdt;
+    sys_call_table[__NR_shmget]             = (SystemCall)sys_shmget;
+    sys_call_table[__NR_adjtime]            = (SystemCall)sys_adjtime;
+    sys_call_table[__NR_prctl]              = (SystemCall)sys_prctl;
 
     isr_install_handler(SYSTEM_CALL, &syscall_handler, "syscall_handler");
 }
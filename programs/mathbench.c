@@ -0,0 +1,392 @@
+/// @file mathbench.c
+/// @brief Measure the accuracy and the throughput of the math functions.
+/// @details The accuracy is measured against references computed in extended
+/// precision, with the x87 unit, and reported as the largest error in units
+/// in the last place (ulp) of the result.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/// The default number of arguments of each test.
+#define DEFAULT_COUNT 4096
+/// The number of times the arguments are processed, when timing.
+#define ROUNDS        8
+
+/// The value of 1/ln2.
+#define INV_LN2  0xb8aa3b295c17f0bcp-63L
+/// The value of ln2, split in two parts. The first one has 32 bits.
+#define LN2_HI   0x1.62e42feep-1L
+/// The remaining part of ln2.
+#define LN2_LO   0xd1cf79abc9e3b398p-96L
+/// The value of 2/pi.
+#define INV_PIO2 0xa2f9836e4e44152ap-64L
+/// The value of pi/2, split in three parts. The first two have 33 bits.
+#define PIO2_1   0x1.921fb544p0L
+/// The second part of pi/2.
+#define PIO2_2   0x1.0b4611a6p-34L
+/// The third part of pi/2.
+#define PIO2_3   0x98cc51701b839a25p-132L
+
+/// @brief A double precision function of one argument, and its reference.
+typedef struct bench_func {
+    const char *name;                          ///< The name of the function.
+    double (*func)(double);                    ///< The function.
+    long double (*ref)(long double);           ///< The reference.
+    void (*batch)(double *, const double *, size_t); ///< The batch version.
+    double min;                                ///< The start of the range.
+    double max;                                ///< The end of the range.
+} bench_func_t;
+
+/// @brief A single precision function of one argument, and its reference.
+typedef struct bench_funcf {
+    const char *name;                              ///< The name of the function.
+    float (*func)(float);                          ///< The function.
+    long double (*ref)(long double);               ///< The reference.
+    void (*batch)(float *, const float *, size_t); ///< The batch version.
+    double min;                                    ///< The start of the range.
+    double max;                                    ///< The end of the range.
+} bench_funcf_t;
+
+/// The state of the random number generator.
+static uint32_t seed = 2463534242U;
+
+/// @brief Returns a random number in a range.
+/// @param min the start of the range.
+/// @param max the end of the range.
+/// @return the number.
+static inline double __random(double min, double max)
+{
+    seed ^= seed << 13U;
+    seed ^= seed >> 17U;
+    seed ^= seed << 5U;
+    return min + (max - min) * (seed * (1.0 / 4294967296.0));
+}
+
+/// @brief Returns the current time, in nanoseconds.
+/// @return the time.
+static inline double __now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/// @brief Multiplies a value by a power of two.
+/// @param x the value.
+/// @param n the exponent, an integer.
+/// @return the result.
+static inline long double __scale(long double x, long double n)
+{
+    long double r;
+    __asm__("fscale" : "=t"(r) : "0"(x), "u"(n));
+    return r;
+}
+
+/// @brief Rounds a value to the nearest integer.
+/// @param x the value.
+/// @return the result.
+static inline long double __rint(long double x)
+{
+    long double r;
+    __asm__("frndint" : "=t"(r) : "0"(x));
+    return r;
+}
+
+/// @brief The reference exponential.
+/// @param x the argument.
+/// @return the result.
+static long double __ref_exp(long double x)
+{
+    long double n = __rint(x * INV_LN2);
+    // Both products are exact, or much more precise than needed.
+    long double r = (x - n * LN2_HI) - n * LN2_LO;
+    long double sum = 1.0L, term = 1.0L;
+    for (int i = 1; i < 24; ++i) {
+        term *= r / i;
+        sum += term;
+    }
+    return __scale(sum, n);
+}
+
+/// @brief The reference natural logarithm.
+/// @param x the argument.
+/// @return the result.
+static long double __ref_log(long double x)
+{
+    long double r;
+    // ln(x) = ln2 * log2(x).
+    __asm__("fldln2\n\tfxch\n\tfyl2x" : "=t"(r) : "0"(x));
+    return r;
+}
+
+/// @brief Reduces an argument of the trigonometric functions, |x| < 2^20.
+/// @param x the argument.
+/// @param r where the reduced argument is stored.
+/// @return the quadrant.
+static int __ref_reduce(long double x, long double *r)
+{
+    long double n = __rint(x * INV_PIO2);
+    *r            = ((x - n * PIO2_1) - n * PIO2_2) - n * PIO2_3;
+    return (int)n & 3;
+}
+
+/// @brief The Taylor series of the sine, or the cosine.
+/// @param r the reduced argument.
+/// @param cosine 1 for the cosine, 0 for the sine.
+/// @return the result.
+static long double __ref_series(long double r, int cosine)
+{
+    long double term = cosine ? 1.0L : r, sum = term;
+    for (int i = 2 - cosine; i < 40; i += 2) {
+        term *= -(r * r) / (i * (i + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+/// @brief The reference sine.
+/// @param x the argument.
+/// @return the result.
+static long double __ref_sin(long double x)
+{
+    long double r;
+    int n = __ref_reduce(x, &r);
+    long double s = __ref_series(r, n & 1);
+    return (n & 2) ? -s : s;
+}
+
+/// @brief The reference cosine.
+/// @param x the argument.
+/// @return the result.
+static long double __ref_cos(long double x)
+{
+    long double r;
+    int n = __ref_reduce(x, &r) + 1;
+    long double s = __ref_series(r, n & 1);
+    return (n & 2) ? -s : s;
+}
+
+/// @brief The reference tangent.
+/// @param x the argument.
+/// @return the result.
+static long double __ref_tan(long double x) { return __ref_sin(x) / __ref_cos(x); }
+
+/// @brief The reference arc tangent of y/x.
+/// @param y the numerator.
+/// @param x the denominator.
+/// @return the result.
+static long double __ref_atan2(long double y, long double x)
+{
+    long double r;
+    __asm__("fpatan" : "=t"(r) : "0"(x), "u"(y) : "st(1)");
+    return r;
+}
+
+/// @brief The reference power.
+/// @param x the base, positive.
+/// @param y the exponent.
+/// @return the result.
+static long double __ref_pow(long double x, long double y) { return __ref_exp(y * __ref_log(x)); }
+
+/// @brief Computes the error of a result.
+/// @param value the result.
+/// @param ref the reference.
+/// @param bits the bits of precision of the result.
+/// @return the error, in ulp.
+static double __ulp_error(long double value, long double ref, int bits)
+{
+    long double err = value - ref, ulp;
+    if (err < 0) {
+        err = -err;
+    }
+    if (ref < 0) {
+        ref = -ref;
+    }
+    // The ulp of a value in [2^e, 2^(e+1)) is 2^(e - bits + 1).
+    long double scale = 1.0L;
+    while (ref >= 2.0L * scale) {
+        scale *= 2.0L;
+    }
+    while ((ref < scale) && (scale > 0x1p-1020L)) {
+        scale *= 0.5L;
+    }
+    ulp = scale * __scale(1.0L, 1 - bits);
+    return (double)(err / ulp);
+}
+
+/// @brief Prints a result line.
+/// @param name the name of the function.
+/// @param min the start of the range.
+/// @param max the end of the range.
+/// @param error the largest error, in ulp.
+/// @param scalar the time of a call, in nanoseconds.
+/// @param batch the time of an element of the batch version, 0 if there is none.
+static void __report(const char *name, double min, double max, double error, double scalar, double batch)
+{
+    printf("%-6s [%8.2f, %8.2f] %6.3f ulp %8.1f ns", name, min, max, error, scalar);
+    if (batch > 0) {
+        printf(" %8.1f ns (%.1fx)", batch, scalar / batch);
+    }
+    putchar('\n');
+}
+
+/// @brief Tests a double precision function.
+/// @param f the function.
+/// @param src the buffer of the arguments.
+/// @param dst the buffer of the results.
+/// @param count the number of arguments.
+static void __bench(const bench_func_t *f, double *src, double *dst, size_t count)
+{
+    double error = 0, start, scalar, batch = 0;
+    for (size_t i = 0; i < count; ++i) {
+        src[i] = __random(f->min, f->max);
+    }
+    start = __now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < count; ++i) {
+            dst[i] = f->func(src[i]);
+        }
+    }
+    scalar = (__now() - start) / (ROUNDS * count);
+    for (size_t i = 0; i < count; ++i) {
+        double e = __ulp_error(dst[i], f->ref(src[i]), 53);
+        error    = (e > error) ? e : error;
+    }
+    if (f->batch) {
+        start = __now();
+        for (int round = 0; round < ROUNDS; ++round) {
+            f->batch(dst, src, count);
+        }
+        batch = (__now() - start) / (ROUNDS * count);
+    }
+    __report(f->name, f->min, f->max, error, scalar, batch);
+}
+
+/// @brief Tests a single precision function.
+/// @param f the function.
+/// @param src the buffer of the arguments.
+/// @param dst the buffer of the results.
+/// @param count the number of arguments.
+static void __benchf(const bench_funcf_t *f, float *src, float *dst, size_t count)
+{
+    double error = 0, start, scalar, batch = 0;
+    for (size_t i = 0; i < count; ++i) {
+        src[i] = (float)__random(f->min, f->max);
+    }
+    start = __now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < count; ++i) {
+            dst[i] = f->func(src[i]);
+        }
+    }
+    scalar = (__now() - start) / (ROUNDS * count);
+    for (size_t i = 0; i < count; ++i) {
+        double e = __ulp_error(dst[i], f->ref(src[i]), 24);
+        error    = (e > error) ? e : error;
+    }
+    if (f->batch) {
+        start = __now();
+        for (int round = 0; round < ROUNDS; ++round) {
+            f->batch(dst, src, count);
+        }
+        batch = (__now() - start) / (ROUNDS * count);
+    }
+    __report(f->name, f->min, f->max, error, scalar, batch);
+}
+
+/// @brief Tests a double precision function of two arguments.
+/// @param name the name of the function.
+/// @param func the function.
+/// @param ref the reference.
+/// @param xmin the start of the range of the first argument.
+/// @param xmax the end of the range of the first argument.
+/// @param ymin the start of the range of the second argument.
+/// @param ymax the end of the range of the second argument.
+/// @param src the buffer of the arguments, twice the count.
+/// @param dst the buffer of the results.
+/// @param count the number of pairs of arguments.
+static void __bench2(
+    const char *name, double (*func)(double, double), long double (*ref)(long double, long double), double xmin,
+    double xmax, double ymin, double ymax, double *src, double *dst, size_t count)
+{
+    double error = 0, start, scalar;
+    for (size_t i = 0; i < count; ++i) {
+        src[2 * i]     = __random(xmin, xmax);
+        src[2 * i + 1] = __random(ymin, ymax);
+    }
+    start = __now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < count; ++i) {
+            dst[i] = func(src[2 * i], src[2 * i + 1]);
+        }
+    }
+    scalar = (__now() - start) / (ROUNDS * count);
+    for (size_t i = 0; i < count; ++i) {
+        double e = __ulp_error(dst[i], ref(src[2 * i], src[2 * i + 1]), 53);
+        error    = (e > error) ? e : error;
+    }
+    __report(name, xmin, xmax, error, scalar, 0);
+}
+
+int main(int argc, char **argv)
+{
+    const bench_func_t funcs[] = {
+        { "exp", exp, __ref_exp, vexp, -700.0, 700.0 },
+        { "log", log, __ref_log, vlog, 0.01, 1000.0 },
+        { "sin", sin, __ref_sin, vsin, -10.0, 10.0 },
+        { "cos", cos, __ref_cos, vcos, -10.0, 10.0 },
+        { "tan", tan, __ref_tan, NULL, -10.0, 10.0 },
+    };
+    const bench_funcf_t funcsf[] = {
+        { "expf", expf, __ref_exp, vexpf, -80.0, 80.0 },
+        { "logf", logf, __ref_log, vlogf, 0.01, 1000.0 },
+        { "sinf", sinf, __ref_sin, vsinf, -10.0, 10.0 },
+        { "cosf", cosf, __ref_cos, vcosf, -10.0, 10.0 },
+    };
+    size_t count = DEFAULT_COUNT;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
+            printf("Measure the accuracy and the throughput of the math functions.\n");
+            printf("Usage:\n");
+            printf("    mathbench [-n COUNT]\n");
+            return EXIT_SUCCESS;
+        }
+        if (!strcmp(argv[i], "-n") && (i + 1 < argc)) {
+            count = (size_t)atoi(argv[++i]);
+        } else {
+            printf("mathbench: invalid option `%s`, see `mathbench --help`.\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (count == 0) {
+        printf("mathbench: the count must be positive.\n");
+        return EXIT_FAILURE;
+    }
+    double *src = malloc(2 * count * sizeof(double));
+    double *dst = malloc(count * sizeof(double));
+    if (!src || !dst) {
+        printf("mathbench: cannot allocate the buffers.\n");
+        free(src);
+        free(dst);
+        return EXIT_FAILURE;
+    }
+    printf("%-6s %-20s %10s %11s %11s\n", "FUNC", "RANGE", "MAX ERROR", "SCALAR", "BATCH");
+    for (size_t i = 0; i < sizeof(funcs) / sizeof(funcs[0]); ++i) {
+        __bench(&funcs[i], src, dst, count);
+    }
+    __bench2("pow", pow, __ref_pow, 0.5, 2.0, -50.0, 50.0, src, dst, count);
+    __bench2("atan2", atan2, __ref_atan2, -10.0, 10.0, -10.0, 10.0, src, dst, count);
+    // The float buffers fit in the double ones.
+    for (size_t i = 0; i < sizeof(funcsf) / sizeof(funcsf[0]); ++i) {
+        __benchf(&funcsf[i], (float *)src, (float *)dst, count);
+    }
+    free(src);
+    free(dst);
+    return EXIT_SUCCESS;
+}
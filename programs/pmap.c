@@ -0,0 +1,202 @@
+/// @file pmap.c
+/// @brief Report the memory map of a process.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// The size of the buffer used to read the smaps file.
+#define SMAPS_BUFFER_SIZE 4096
+
+/// @brief Information about a memory area, as read from `/proc/<pid>/smaps`.
+typedef struct area_info {
+    unsigned long start;  ///< The start of the area.
+    unsigned long end;    ///< The end of the area.
+    char mode[5];         ///< The permissions of the area.
+    char name[32];        ///< The name of the area.
+    unsigned long rss;    ///< The resident memory, in kB.
+    unsigned long shared; ///< The shared memory, in kB.
+    unsigned long cow;    ///< The memory shared copy-on-write, in kB.
+    unsigned long dirty;  ///< The dirty memory, in kB.
+} area_info_t;
+
+/// @brief Parses an hexadecimal number.
+/// @param str the string to parse.
+/// @param endptr where we store the pointer to the first character after the number.
+/// @return the parsed number.
+static inline unsigned long __parse_hex(const char *str, const char **endptr)
+{
+    unsigned long value = 0;
+    for (;; ++str) {
+        if ((*str >= '0') && (*str <= '9')) {
+            value = (value << 4U) | (*str - '0');
+        } else if ((*str >= 'a') && (*str <= 'f')) {
+            value = (value << 4U) | (*str - 'a' + 10);
+        } else {
+            break;
+        }
+    }
+    *endptr = str;
+    return value;
+}
+
+/// @brief Parses the line describing an area (e.g., `08048000-08056000 rwxp 00000000 00:00 0 [heap]`).
+/// @param line the line to parse.
+/// @param area where we store the information.
+/// @return 1 if the line describes an area, 0 otherwise.
+static inline int __parse_area(const char *line, area_info_t *area)
+{
+    const char *it;
+    memset(area, 0, sizeof(area_info_t));
+    area->start = __parse_hex(line, &it);
+    if ((it == line) || (*it != '-')) {
+        return 0;
+    }
+    area->end = __parse_hex(it + 1, &it);
+    if (*it++ != ' ') {
+        return 0;
+    }
+    strncpy(area->mode, it, 4);
+    // The name is the sixth field, it might be missing.
+    for (int field = 0; (field < 4) && (it = strchr(it, ' ')); ++field) {
+        ++it;
+    }
+    if (it) {
+        strncpy(area->name, it, sizeof(area->name) - 1);
+    }
+    return 1;
+}
+
+/// @brief Parses a `Key: value kB` line, and stores the value in the matching field.
+/// @param line the line to parse.
+/// @param area the area the line belongs to.
+static inline void __parse_field(const char *line, area_info_t *area)
+{
+    const char *value = strchr(line, ':');
+    if (!value) {
+        return;
+    }
+    unsigned long kb = strtol(value + 1, NULL, 10);
+    if (!strncmp(line, "Rss:", 4)) {
+        area->rss = kb;
+    } else if (!strncmp(line, "Shared:", 7)) {
+        area->shared = kb;
+    } else if (!strncmp(line, "Shared_Cow:", 11)) {
+        area->cow = kb;
+    } else if (!strncmp(line, "Dirty:", 6)) {
+        area->dirty = kb;
+    }
+}
+
+/// @brief Prints the information about an area, and adds it to the total.
+/// @param area the area.
+/// @param total the total of all the areas.
+/// @param extended if we should print the extended format.
+static inline void __print_area(area_info_t *area, area_info_t *total, int extended)
+{
+    unsigned long size = (area->end - area->start) / 1024;
+    if (extended) {
+        printf(
+            "%08lx %8lu %8lu %8lu %8lu %8lu %s %s\n", area->start, size, area->rss, area->shared, area->cow,
+            area->dirty, area->mode, area->name);
+    } else {
+        printf("%08lx %8luK %s %s\n", area->start, size, area->mode, area->name);
+    }
+    // The total size is kept in `end`.
+    total->end += size;
+    total->rss += area->rss;
+    total->shared += area->shared;
+    total->cow += area->cow;
+    total->dirty += area->dirty;
+}
+
+/// @brief Prints the memory map of a process.
+/// @param pid the process.
+/// @param extended if we should print the extended format.
+/// @return 0 on success, 1 on failure.
+static int __pmap(const char *pid, int extended)
+{
+    char path[PATH_MAX];
+    char buffer[SMAPS_BUFFER_SIZE];
+    ssize_t length = 0, ret;
+    area_info_t area, next, total;
+    int has_area = 0;
+
+    // Read the whole smaps file.
+    snprintf(path, PATH_MAX, "/proc/%s/smaps", pid);
+    int fd = open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("pmap: cannot open %s\n", path);
+        return 1;
+    }
+    while (length < SMAPS_BUFFER_SIZE - 1) {
+        if ((ret = read(fd, buffer + length, SMAPS_BUFFER_SIZE - 1 - length)) <= 0) {
+            break;
+        }
+        length += ret;
+    }
+    buffer[length] = 0;
+    close(fd);
+
+    printf("%s:\n", pid);
+    if (extended) {
+        printf(
+            "%-8s %8s %8s %8s %8s %8s %s %s\n", "Address", "Kbytes", "RSS", "Shared", "Cow", "Dirty", "Mode",
+            "Mapping");
+    }
+    memset(&total, 0, sizeof(area_info_t));
+    // Parse it line by line, each area is followed by its statistics.
+    for (char *saveptr, *line = strtok_r(buffer, "\n", &saveptr); line; line = strtok_r(NULL, "\n", &saveptr)) {
+        if (__parse_area(line, &next)) {
+            if (has_area) {
+                __print_area(&area, &total, extended);
+            }
+            area     = next;
+            has_area = 1;
+        } else if (has_area) {
+            __parse_field(line, &area);
+        }
+    }
+    if (has_area) {
+        __print_area(&area, &total, extended);
+    }
+    if (extended) {
+        printf(
+            "-------- -------- -------- -------- -------- --------\n"
+            "total kB %8lu %8lu %8lu %8lu %8lu\n",
+            total.end, total.rss, total.shared, total.cow, total.dirty);
+    } else {
+        printf(" total   %8luK\n", total.end);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int extended = 0, first = 1, status = 0;
+    if (argc > 1) {
+        if (!strcmp(argv[1], "--help") || !strcmp(argv[1], "-h")) {
+            printf("Report the memory map of a process.\n");
+            printf("Usage:\n");
+            printf("    pmap [-x] PID...\n");
+            return EXIT_SUCCESS;
+        }
+        if (!strcmp(argv[1], "-x")) {
+            extended = 1;
+            first    = 2;
+        }
+    }
+    if (first >= argc) {
+        printf("pmap: missing PID, see `pmap --help`.\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = first; i < argc; ++i) {
+        status |= __pmap(argv[i], extended);
+    }
+    return status ? EXIT_FAILURE : EXIT_SUCCESS;
+}
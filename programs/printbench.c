@@ -0,0 +1,126 @@
+/// @file printbench.c
+/// @brief Measure the speed of the formatting functions of the C library.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <fcvt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/// The default number of values formatted by each test.
+#define DEFAULT_COUNT 100000
+/// The number of different values, a power of two.
+#define VALUES        1024
+
+/// The integers formatted by the tests.
+static int ints[VALUES];
+/// The floating point numbers formatted by the tests.
+static double doubles[VALUES];
+/// The strings formatted by the tests.
+static const char *strings[] = { "", "a", "MentOS", "formatting benchmark", "/usr/share/man/printbench.man" };
+
+/// @brief Returns the current time, in nanoseconds.
+/// @return the time.
+static inline double __now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/// @brief Formats a value with snprintf, by kind.
+/// @param buffer the output buffer.
+/// @param size the size of the buffer.
+/// @param format the format, with a single conversion.
+/// @param i the index of the value.
+/// @return the number of characters written.
+static inline int __format(char *buffer, size_t size, const char *format, unsigned i)
+{
+    switch (format[strlen(format) - 1]) {
+    case 's':
+        return snprintf(buffer, size, format, strings[i % (sizeof(strings) / sizeof(strings[0]))]);
+    case 'e':
+    case 'f':
+    case 'g':
+        return snprintf(buffer, size, format, doubles[i]);
+    default:
+        return snprintf(buffer, size, format, ints[i]);
+    }
+}
+
+/// @brief Measures the formatting of a conversion.
+/// @param format the format, with a single conversion.
+/// @param count the number of values to format.
+/// @return the number of characters written, so that the work is not optimized away.
+static unsigned long __bench(const char *format, unsigned count)
+{
+    char buffer[64];
+    unsigned long total = 0;
+    double start        = __now();
+    for (unsigned i = 0; i < count; ++i) {
+        total += (unsigned long)__format(buffer, sizeof(buffer), format, i & (VALUES - 1));
+    }
+    double elapsed = __now() - start;
+    printf("%-8s %12.0f numbers/s %8.1f chars/number\n", format, (elapsed > 0) ? count * 1e9 / elapsed : 0,
+           (double)total / count);
+    return total;
+}
+
+/// @brief Measures the shortest conversion of doubles.
+/// @param count the number of values to convert.
+/// @return the number of digits produced.
+static unsigned long __bench_shortest(unsigned count)
+{
+    char buffer[32];
+    int decpt, sign;
+    unsigned long total = 0;
+    double start        = __now();
+    for (unsigned i = 0; i < count; ++i) {
+        total += (unsigned long)scvtbuf(doubles[i & (VALUES - 1)], &decpt, &sign, buffer, sizeof(buffer));
+    }
+    double elapsed = __now() - start;
+    printf("%-8s %12.0f numbers/s %8.1f chars/number\n", "scvtbuf", (elapsed > 0) ? count * 1e9 / elapsed : 0,
+           (double)total / count);
+    return total;
+}
+
+int main(int argc, char **argv)
+{
+    const char *formats[] = { "%d", "%x", "%f", "%s", "%.3f", "%e", "%g", "%.17g" };
+    unsigned count        = DEFAULT_COUNT;
+    unsigned seed         = 12345;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
+            printf("Measure the speed of the formatting functions.\n");
+            printf("Usage:\n");
+            printf("    printbench [-n COUNT]\n");
+            return EXIT_SUCCESS;
+        }
+        if (!strcmp(argv[i], "-n") && (i + 1 < argc)) {
+            count = (unsigned)atoi(argv[++i]);
+        } else {
+            printf("printbench: invalid option `%s`, see `printbench --help`.\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (count == 0) {
+        printf("printbench: the count must be positive.\n");
+        return EXIT_FAILURE;
+    }
+    // Values of all magnitudes, from a linear congruential generator.
+    for (unsigned i = 0; i < VALUES; ++i) {
+        seed       = seed * 1103515245U + 12345U;
+        ints[i]    = (int)seed >> (seed & 31U);
+        doubles[i] = (double)ints[i] / (double)(1U << ((seed >> 8U) & 15U));
+    }
+    printf("%u values per format\n", count);
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i) {
+        __bench(formats[i], count);
+    }
+    __bench_shortest(count);
+    return EXIT_SUCCESS;
+}
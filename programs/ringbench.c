@@ -0,0 +1,280 @@
+/// @file ringbench.c
+/// @brief Measure the throughput of the shared memory rings, against pipes
+/// and message queues.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <shm_ring.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strerror.h>
+#include <sys/ipc.h>
+#include <sys/msg.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/// The default size of the messages, in bytes.
+#define DEFAULT_SIZE  64
+/// The default number of messages.
+#define DEFAULT_COUNT 20000
+/// The default number of messages transferred at once through the rings.
+#define DEFAULT_BATCH 32
+/// The largest message, it must fit a message queue.
+#define MAX_SIZE      4096
+/// The room for the elements of each ring, in bytes.
+#define RING_BYTES    65536
+
+/// @brief A message of the message queue.
+typedef struct bench_msg {
+    long mtype;           ///< The type of the message, always 1.
+    char mtext[MAX_SIZE]; ///< The content.
+} bench_msg_t;
+
+/// @brief The parameters of the benchmark.
+typedef struct bench {
+    size_t size;  ///< The size of the messages.
+    size_t count; ///< The number of messages.
+    size_t batch; ///< The number of messages transferred at once through the rings.
+} bench_t;
+
+/// @brief Returns the current time, in nanoseconds.
+/// @return the time.
+static inline double __now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/// @brief Writes the sequence number of a message in its first bytes.
+/// @param message the message.
+/// @param size the size of the message.
+/// @param seq the sequence number.
+static inline void __stamp(char *message, size_t size, unsigned seq)
+{
+    memset(message, 0, size);
+    memcpy(message, &seq, (size < sizeof(seq)) ? size : sizeof(seq));
+}
+
+/// @brief Checks the sequence number in the first bytes of a message.
+/// @param message the message.
+/// @param size the size of the message.
+/// @param seq the expected sequence number.
+/// @return 1 if it matches, 0 otherwise.
+static inline int __check(const char *message, size_t size, unsigned seq)
+{
+    unsigned found = 0;
+    memcpy(&found, message, (size < sizeof(seq)) ? size : sizeof(seq));
+    if (size < sizeof(seq)) {
+        seq &= (1U << (size * 8)) - 1;
+    }
+    return found == seq;
+}
+
+/// @brief Waits for the producer, and reports the result.
+/// @param name the name of the transport.
+/// @param bench the parameters.
+/// @param pid the producer.
+/// @param elapsed the time the consumer took, in nanoseconds, negative on failure.
+/// @return 0 on success, 1 on failure.
+static int __report(const char *name, const bench_t *bench, pid_t pid, double elapsed)
+{
+    int status;
+    // The producer might be waiting for room in a transport we abandoned.
+    if ((elapsed < 0) && (pid > 0)) {
+        kill(pid, SIGKILL);
+    }
+    if ((waitpid(pid, &status, 0) != pid) || (WEXITSTATUS(status) != EXIT_SUCCESS) || (elapsed < 0)) {
+        printf("%-10s failed\n", name);
+        return 1;
+    }
+    double seconds = (elapsed > 0) ? (elapsed / 1e9) : 1e-9;
+    printf("%-10s %10.0f msg/s %10.1f MiB/s %8.1f ms\n", name, bench->count / seconds,
+           (bench->count * bench->size) / seconds / (1024 * 1024), elapsed / 1e6);
+    return 0;
+}
+
+/// @brief Streams the messages through a pipe, one system call each.
+/// @param bench the parameters.
+/// @return 0 on success, 1 on failure.
+static int __bench_pipe(const bench_t *bench)
+{
+    char message[MAX_SIZE];
+    int fds[2];
+    if (pipe(fds) < 0) {
+        printf("ringbench: cannot create the pipe: %s\n", strerror(errno));
+        return 1;
+    }
+    double start = __now();
+    pid_t pid    = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        for (unsigned seq = 0; seq < bench->count; ++seq) {
+            __stamp(message, bench->size, seq);
+            if (write(fds[1], message, bench->size) != (ssize_t)bench->size) {
+                exit(EXIT_FAILURE);
+            }
+        }
+        exit(EXIT_SUCCESS);
+    }
+    close(fds[1]);
+    double elapsed = -1;
+    unsigned seq   = 0;
+    for (; (pid > 0) && (seq < bench->count); ++seq) {
+        // A message can be split across reads.
+        size_t length = 0;
+        ssize_t ret   = 0;
+        while ((length < bench->size) && ((ret = read(fds[0], message + length, bench->size - length)) > 0)) {
+            length += ret;
+        }
+        if ((length < bench->size) || !__check(message, bench->size, seq)) {
+            break;
+        }
+    }
+    if (seq == bench->count) {
+        elapsed = __now() - start;
+    }
+    close(fds[0]);
+    return __report("pipe", bench, pid, elapsed);
+}
+
+/// @brief Streams the messages through a message queue, one system call each.
+/// @param bench the parameters.
+/// @return 0 on success, 1 on failure.
+static int __bench_msg(const bench_t *bench)
+{
+    static bench_msg_t message;
+    int msqid = msgget(IPC_PRIVATE, IPC_CREAT | 0600);
+    if (msqid < 0) {
+        printf("ringbench: cannot create the message queue: %s\n", strerror(errno));
+        return 1;
+    }
+    double start = __now();
+    pid_t pid    = fork();
+    if (pid == 0) {
+        message.mtype = 1;
+        for (unsigned seq = 0; seq < bench->count; ++seq) {
+            __stamp(message.mtext, bench->size, seq);
+            if (msgsnd(msqid, &message, bench->size, 0) < 0) {
+                exit(EXIT_FAILURE);
+            }
+        }
+        exit(EXIT_SUCCESS);
+    }
+    double elapsed = -1;
+    unsigned seq   = 0;
+    for (; (pid > 0) && (seq < bench->count); ++seq) {
+        if ((msgrcv(msqid, &message, bench->size, 0, 0) < 0) || !__check(message.mtext, bench->size, seq)) {
+            break;
+        }
+    }
+    if (seq == bench->count) {
+        elapsed = __now() - start;
+    }
+    int ret = __report("msgsnd", bench, pid, elapsed);
+    msgctl(msqid, IPC_RMID, NULL);
+    return ret;
+}
+
+/// @brief Streams the messages through a ring, in batches.
+/// @param bench the parameters.
+/// @param name the name of the ring.
+/// @param flags the flags of the ring.
+/// @return 0 on success, 1 on failure.
+static int __bench_ring(const bench_t *bench, const char *name, int flags)
+{
+    key_t key         = ftok("/home", 'b');
+    // The largest power of two elements fitting the ring.
+    unsigned capacity = 1;
+    while ((capacity * 2 * bench->size) <= RING_BYTES) {
+        capacity *= 2;
+    }
+    char *messages   = malloc(bench->batch * bench->size);
+    shm_ring_t *ring = messages ? shm_ring_create(key, capacity, bench->size, flags) : NULL;
+    if (!ring) {
+        printf("ringbench: cannot create the ring: %s\n", strerror(errno));
+        free(messages);
+        return 1;
+    }
+    double start = __now();
+    pid_t pid    = fork();
+    if (pid == 0) {
+        // The mapping of the segment is not inherited.
+        if (!(ring = shm_ring_attach(key))) {
+            exit(EXIT_FAILURE);
+        }
+        for (unsigned seq = 0; seq < bench->count;) {
+            unsigned n = 0;
+            for (; (n < bench->batch) && (seq < bench->count); ++n, ++seq) {
+                __stamp(messages + n * bench->size, bench->size, seq);
+            }
+            if (shm_ring_enqueue_wait(ring, messages, n) < 0) {
+                exit(EXIT_FAILURE);
+            }
+        }
+        shm_ring_detach(ring);
+        exit(EXIT_SUCCESS);
+    }
+    double elapsed = -1;
+    unsigned seq   = 0;
+    while ((pid > 0) && (seq < bench->count)) {
+        unsigned n = (bench->count - seq < bench->batch) ? (bench->count - seq) : bench->batch;
+        if (shm_ring_dequeue_wait(ring, messages, n) < 0) {
+            break;
+        }
+        unsigned i = 0;
+        while ((i < n) && __check(messages + i * bench->size, bench->size, seq)) {
+            ++i;
+            ++seq;
+        }
+        if (i < n) {
+            break;
+        }
+    }
+    if (seq == bench->count) {
+        elapsed = __now() - start;
+    }
+    int ret = __report(name, bench, pid, elapsed);
+    shm_ring_destroy(ring);
+    free(messages);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    bench_t bench = {DEFAULT_SIZE, DEFAULT_COUNT, DEFAULT_BATCH};
+    int failures  = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
+            printf("Measure the throughput of the shared memory rings, against pipes and message queues.\n");
+            printf("Usage:\n");
+            printf("    ringbench [-s SIZE] [-n COUNT] [-b BATCH]\n");
+            return EXIT_SUCCESS;
+        }
+        if (!strcmp(argv[i], "-s") && (i + 1 < argc)) {
+            bench.size = (size_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-n") && (i + 1 < argc)) {
+            bench.count = (size_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-b") && (i + 1 < argc)) {
+            bench.batch = (size_t)atoi(argv[++i]);
+        } else {
+            printf("ringbench: invalid option `%s`, see `ringbench --help`.\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((bench.size == 0) || (bench.size > MAX_SIZE) || (bench.count == 0) || (bench.batch == 0)) {
+        printf("ringbench: the size must be within 1 and %d, the count and the batch positive.\n", MAX_SIZE);
+        return EXIT_FAILURE;
+    }
+    printf("%u messages of %u bytes, %u per batch on the rings\n", (unsigned)bench.count, (unsigned)bench.size,
+           (unsigned)bench.batch);
+    failures += __bench_pipe(&bench);
+    failures += __bench_msg(&bench);
+    failures += __bench_ring(&bench, "ring", SHM_RING_BLOCK);
+    failures += __bench_ring(&bench, "ring-mpmc", SHM_RING_MPMC | SHM_RING_BLOCK);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
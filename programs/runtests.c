@@ -23,13 +23,17 @@
 static char *all_tests[] = {
     "t_abort",
     "t_alarm",
+    "t_allocinfo",
     // "t_big_write",
     "t_chdir",
+    "t_clock",
     "t_creat",
     "t_dup",
+    "t_dyndbg",
     "t_environ",
     "t_exit",
     "t_exec",
+    "t_flock",
     "t_fork",
     "t_gid",
     "t_grp",
@@ -38,21 +42,32 @@ static char *all_tests[] = {
     "t_itimer",
     "t_kill",
     "t_list",
+    "t_list_head",
+    "t_madvise",
+    "t_math",
     "t_mem",
     "t_mkdir",
     "t_msgget",
     "t_ndtree",
+    "t_nodeinfo",
+    "t_oom",
     // "t_periodic1",
     // "t_periodic2",
     // "t_periodic3",
     "t_pipe_blocking",
     "t_pipe_non_blocking",
+    "t_printf",
+    "t_procmaps",
+    "t_procstat",
     "t_pwd",
     "t_schedfb",
     "t_semflg",
     "t_semget",
     "t_semop",
+    "t_setscheduler",
+    "t_sha256",
     "t_shm",
+    "t_shm_ring",
     "t_shmget",
     "t_sigaction",
     "t_sigfpe",
@@ -62,8 +77,12 @@ static char *all_tests[] = {
     "t_sleep",
     "t_spwd",
     "t_stopcont",
+    "t_sysctl",
     "t_syslog",
     "t_time",
+    "t_timerslack",
+    "t_vmalloc",
+    "t_waitpid",
     "t_write_read",
 };
 
@@ -0,0 +1,146 @@
+/// @file shabench.c
+/// @brief Measure the throughput of the SHA-256 implementations.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <crypt/sha256.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/// The default size of the messages, in bytes.
+#define DEFAULT_SIZE  4096
+/// The default number of messages.
+#define DEFAULT_COUNT 256
+/// The number of times the messages are hashed, when timing.
+#define ROUNDS        4
+
+/// @brief Returns the current time, in nanoseconds.
+/// @return the time.
+static inline double __now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/// @brief Converts a time into a throughput.
+/// @param bytes the number of bytes hashed.
+/// @param ns the time, in nanoseconds.
+/// @return the throughput, in MiB/s.
+static inline double __throughput(double bytes, double ns) { return (ns > 0) ? (bytes * 1e9 / ns) / (1024 * 1024) : 0; }
+
+/// @brief Measures an implementation.
+/// @param impl the implementation.
+/// @param data the messages.
+/// @param len the lengths of the messages.
+/// @param hash the buffers of the digests.
+/// @param count the number of messages.
+/// @param reference the digest of the messages, from the generic implementation.
+/// @return 0 on success, 1 if the digests differ.
+static int __bench(
+    sha256_impl_t impl, const uint8_t *const data[], const size_t len[], uint8_t *const hash[], size_t count,
+    uint8_t reference[])
+{
+    SHA256_ctx_t ctx;
+    uint8_t digest[SHA256_BLOCK_SIZE];
+    double start, stream, multi, bytes = (double)len[0] * count * ROUNDS;
+
+    if (sha256_set_impl(impl) < 0) {
+        printf("%-8s not supported by the processor\n", sha256_impl_name(impl));
+        return 0;
+    }
+    start = __now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < count; ++i) {
+            sha256_init(&ctx);
+            sha256_update(&ctx, data[i], len[i]);
+            sha256_final(&ctx, digest);
+        }
+    }
+    stream = __now() - start;
+    start  = __now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        sha256_multi(data, len, hash, count);
+    }
+    multi = __now() - start;
+    printf("%-8s %10.1f MiB/s %10.1f MiB/s\n", sha256_impl_name(impl), __throughput(bytes, stream),
+           __throughput(bytes, multi));
+    if (memcmp(digest, reference, SHA256_BLOCK_SIZE) || memcmp(hash[count - 1], reference, SHA256_BLOCK_SIZE)) {
+        printf("shabench: the digests of `%s` are wrong.\n", sha256_impl_name(impl));
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const sha256_impl_t impls[] = { SHA256_IMPL_GENERIC, SHA256_IMPL_SSE2, SHA256_IMPL_SHANI };
+    uint8_t reference[SHA256_BLOCK_SIZE];
+    SHA256_ctx_t ctx;
+    size_t size = DEFAULT_SIZE, count = DEFAULT_COUNT;
+    int failures = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
+            printf("Measure the throughput of the SHA-256 implementations.\n");
+            printf("Usage:\n");
+            printf("    shabench [-s SIZE] [-n COUNT]\n");
+            return EXIT_SUCCESS;
+        }
+        if (!strcmp(argv[i], "-s") && (i + 1 < argc)) {
+            size = (size_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-n") && (i + 1 < argc)) {
+            count = (size_t)atoi(argv[++i]);
+        } else {
+            printf("shabench: invalid option `%s`, see `shabench --help`.\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (count == 0) {
+        printf("shabench: the count must be positive.\n");
+        return EXIT_FAILURE;
+    }
+    // All the messages are the same, so they can share the buffer.
+    uint8_t *buffer      = malloc(size + 1);
+    const uint8_t **data = malloc(count * sizeof(uint8_t *));
+    size_t *len          = malloc(count * sizeof(size_t));
+    uint8_t **hash       = malloc(count * sizeof(uint8_t *));
+    uint8_t *digests     = malloc(count * SHA256_BLOCK_SIZE);
+    if (!buffer || !data || !len || !hash || !digests) {
+        printf("shabench: cannot allocate the buffers.\n");
+        free(buffer);
+        free(data);
+        free(len);
+        free(hash);
+        free(digests);
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        buffer[i] = (uint8_t)(i * 131 + 7);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        data[i] = buffer;
+        len[i]  = size;
+        hash[i] = digests + i * SHA256_BLOCK_SIZE;
+    }
+    sha256_set_impl(SHA256_IMPL_GENERIC);
+    sha256_init(&ctx);
+    sha256_update(&ctx, buffer, size);
+    sha256_final(&ctx, reference);
+    printf("%u messages of %u bytes\n", (unsigned)count, (unsigned)size);
+    printf("%-8s %16s %16s\n", "IMPL", "STREAM", "MULTI-BUFFER");
+    for (size_t i = 0; i < sizeof(impls) / sizeof(impls[0]); ++i) {
+        failures += __bench(impls[i], data, len, hash, count, reference);
+    }
+    sha256_set_impl(SHA256_IMPL_AUTO);
+    printf("Selected: %s\n", sha256_impl_name(sha256_get_impl()));
+    free(buffer);
+    free(data);
+    free(len);
+    free(hash);
+    free(digests);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
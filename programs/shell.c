@@ -1248,7 +1248,8 @@ static int __execute_command(rb_history_entry_t *entry)
         }
         if (blocking) {
             // Parent process: Wait for the child process to finish.
-            waitpid(cpid, &_status, 0);
+            while ((waitpid(cpid, &_status, 0) < 0) && (errno == EINTR)) {
+            }
             // Handle different exit statuses of the child process.
             if (WIFSIGNALED(_status)) {
                 printf(
@@ -0,0 +1,103 @@
+/// @file t_allocinfo.c
+/// @brief Tests the allocation profiler exposed through /proc/allocinfo.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// @brief Writes a command to /proc/allocinfo.
+/// @param command the command to write.
+/// @return 0 on success, -1 on failure.
+static int allocinfo_write(const char *command)
+{
+    int fd = open("/proc/allocinfo", O_WRONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open /proc/allocinfo: %s\n", strerror(errno));
+        return -1;
+    }
+    ssize_t ret = write(fd, command, strlen(command));
+    close(fd);
+    if (ret != (ssize_t)strlen(command)) {
+        printf("Failed to write `%s` to /proc/allocinfo: %s\n", command, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/// @brief Reads the beginning of /proc/allocinfo.
+/// @param buffer where the content is placed.
+/// @param size the size of the buffer.
+/// @return 0 on success, -1 on failure.
+static int allocinfo_read(char *buffer, size_t size)
+{
+    int fd = open("/proc/allocinfo", O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open /proc/allocinfo: %s\n", strerror(errno));
+        return -1;
+    }
+    memset(buffer, 0, size);
+    ssize_t ret = read(fd, buffer, size - 1);
+    close(fd);
+    if (ret <= 0) {
+        printf("Failed to read /proc/allocinfo: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    char buffer[1024];
+
+    // Start from a clean state.
+    if ((allocinfo_write("reset\n") < 0) || (allocinfo_write("on\n") < 0)) {
+        return EXIT_FAILURE;
+    }
+    // Creating a process allocates plenty of kernel memory.
+    pid_t pid = fork();
+    if (pid == 0) {
+        exit(EXIT_SUCCESS);
+    }
+    if ((pid < 0) || (waitpid(pid, NULL, 0) != pid)) {
+        printf("Failed to create the child process: %s\n", strerror(errno));
+        allocinfo_write("off\n");
+        return EXIT_FAILURE;
+    }
+    if (allocinfo_read(buffer, sizeof(buffer)) < 0) {
+        allocinfo_write("off\n");
+        return EXIT_FAILURE;
+    }
+    if (strncmp(buffer, "# profiler: on", 14) != 0) {
+        printf("Unexpected header:\n%s\n", buffer);
+        allocinfo_write("off\n");
+        return EXIT_FAILURE;
+    }
+    // The header is followed by the column names, then by the sites.
+    char *sites = strchr(buffer, '\n');
+    if (!sites || !(sites = strchr(sites + 1, '\n')) || (sites[1] == 0)) {
+        printf("No allocation site was recorded:\n%s\n", buffer);
+        allocinfo_write("off\n");
+        return EXIT_FAILURE;
+    }
+    // Unknown commands must be rejected.
+    if (allocinfo_write("maybe\n") == 0) {
+        printf("An invalid command was accepted.\n");
+        allocinfo_write("off\n");
+        return EXIT_FAILURE;
+    }
+    if ((allocinfo_write("off\n") < 0) || (allocinfo_read(buffer, sizeof(buffer)) < 0)) {
+        return EXIT_FAILURE;
+    }
+    if (strncmp(buffer, "# profiler: off", 15) != 0) {
+        printf("The profiler was not disabled:\n%s\n", buffer);
+        return EXIT_FAILURE;
+    }
+    allocinfo_write("reset\n");
+    return EXIT_SUCCESS;
+}
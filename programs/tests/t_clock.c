@@ -0,0 +1,97 @@
+/// @file t_clock.c
+/// @brief Tests the monotonic and wall clocks, and the timezone handling.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <string.h>
+#include <time.h>
+
+/// @brief Computes the difference between two time values, in nanoseconds.
+/// @param t0 the earlier time value.
+/// @param t1 the later time value.
+/// @return the difference.
+static long long elapsed_ns(const timespec_t *t0, const timespec_t *t1)
+{
+    return ((long long)t1->tv_sec - (long long)t0->tv_sec) * 1000000000LL + (t1->tv_nsec - t0->tv_nsec);
+}
+
+int main(void)
+{
+    timespec_t t0, t1, req = {0, 50000000};
+    timeval_t tv;
+
+    // Invalid clocks are rejected.
+    if ((clock_gettime(42, &t0) != -1) || (errno != EINVAL)) {
+        printf("An invalid clock was accepted.\n");
+        return EXIT_FAILURE;
+    }
+
+    // The monotonic clock never goes back, and has sub-tick resolution.
+    if (clock_gettime(CLOCK_MONOTONIC, &t0) < 0) {
+        printf("Failed to read the monotonic clock: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < 1000; ++i) {
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        if (elapsed_ns(&t0, &t1) < 0) {
+            printf("The monotonic clock went back.\n");
+            return EXIT_FAILURE;
+        }
+        if ((t1.tv_nsec < 0) || (t1.tv_nsec >= 1000000000)) {
+            printf("The monotonic clock is not normalized.\n");
+            return EXIT_FAILURE;
+        }
+        t0 = t1;
+    }
+    nanosleep(&req, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (elapsed_ns(&t0, &t1) < req.tv_nsec) {
+        printf("The monotonic clock did not advance while sleeping.\n");
+        return EXIT_FAILURE;
+    }
+
+    // The wall clock agrees with time and gettimeofday.
+    if (clock_gettime(CLOCK_REALTIME, &t0) < 0) {
+        printf("Failed to read the wall clock: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if ((gettimeofday(&tv, NULL) < 0) || (tv.tv_usec >= 1000000)) {
+        printf("Failed to read the time of day: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    time_t now = time(NULL);
+    if ((tv.tv_sec < t0.tv_sec) || (now < tv.tv_sec) || ((now - t0.tv_sec) > 1)) {
+        printf("The clocks disagree: %u, %u, %u.\n", t0.tv_sec, tv.tv_sec, now);
+        return EXIT_FAILURE;
+    }
+
+    // Invalid times are rejected, and there is no pending adjustment.
+    tv.tv_usec = 1000000;
+    if (settimeofday(&tv, NULL) != -1) {
+        printf("An invalid time was accepted.\n");
+        return EXIT_FAILURE;
+    }
+    if (adjtime(NULL, &tv) < 0) {
+        printf("Failed to read the pending adjustment: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    // The timezone is applied by the C library.
+    setenv("TZ", "CET-1", 1);
+    tm_t local = *localtime(&now);
+    tm_t utc   = *gmtime(&now);
+    if ((timezone != -3600) || (((local.tm_hour - utc.tm_hour + 24) % 24) != 1)) {
+        printf("The timezone was not applied: %ld.\n", timezone);
+        return EXIT_FAILURE;
+    }
+    unsetenv("TZ");
+    local = *localtime(&now);
+    if ((timezone != 0) || (local.tm_hour != utc.tm_hour)) {
+        printf("UTC is not the default timezone.\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+/// @file t_dyndbg.c
+/// @brief Tests the dynamic debug control file.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <string.h>
+#include <unistd.h>
+
+/// The dynamic debug control file.
+#define DYNDBG_PATH "/proc/dynamic_debug"
+/// The sites we toggle, the ones of the procfs initialization.
+#define DYNDBG_SITE "file proc_system.c func procs_module_init"
+
+/// @brief Writes a query to the control file.
+/// @param query the query.
+/// @return 0 on success, -1 on failure.
+static int write_query(const char *query)
+{
+    int fd = open(DYNDBG_PATH, O_WRONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open %s: %s\n", DYNDBG_PATH, strerror(errno));
+        return -1;
+    }
+    ssize_t ret = write(fd, query, strlen(query));
+    close(fd);
+    return (ret == (ssize_t)strlen(query)) ? 0 : -1;
+}
+
+/// @brief Counts the sites of the given function, with the given flags.
+/// @param function the function.
+/// @param flags the flags, either "=p" or "=_".
+/// @return the number of sites, -1 on failure.
+static int count_sites(const char *function, const char *flags)
+{
+    char buffer[512], pattern[128];
+    size_t length = 0;
+    ssize_t ret;
+    int count = 0;
+    snprintf(pattern, sizeof(pattern), "[%s] %s ", function, flags);
+    int fd = open(DYNDBG_PATH, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open %s: %s\n", DYNDBG_PATH, strerror(errno));
+        return -1;
+    }
+    while ((ret = read(fd, buffer + length, sizeof(buffer) - length - 1)) > 0) {
+        length += ret;
+        buffer[length] = 0;
+        // Check the complete lines, and keep the last partial one.
+        char *line = buffer, *end;
+        while ((end = strchr(line, '\n'))) {
+            *end = 0;
+            if (strstr(line, pattern)) {
+                ++count;
+            }
+            line = end + 1;
+        }
+        length = strlen(line);
+        memmove(buffer, line, length + 1);
+        if (length == sizeof(buffer) - 1) {
+            length = 0;
+        }
+    }
+    close(fd);
+    return (ret < 0) ? -1 : count;
+}
+
+int main(void)
+{
+    // Malformed queries are rejected, and so are the ones matching nothing.
+    if ((write_query("file proc_system.c +x") == 0) || (errno != EINVAL) ||
+        (write_query("file proc_system.c func") == 0) || (errno != EINVAL) ||
+        (write_query("line 10-5 +p") == 0) || (errno != EINVAL)) {
+        printf("A malformed query was accepted.\n");
+        return EXIT_FAILURE;
+    }
+    if ((write_query("file no_such_file.c +p") == 0) || (errno != ENOENT)) {
+        printf("A query matching no site was accepted.\n");
+        return EXIT_FAILURE;
+    }
+
+    // The sites start disabled.
+    int disabled = count_sites("procs_module_init", "=_");
+    if (disabled <= 0) {
+        printf("Cannot find the sites of procs_module_init.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Enabling them is reported by the control file.
+    if (write_query(DYNDBG_SITE " +p\n") < 0) {
+        printf("Failed to enable the sites: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (count_sites("procs_module_init", "=p") != disabled) {
+        printf("The sites were not enabled.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Several commands can be applied at once.
+    if (write_query(DYNDBG_SITE " -p; " DYNDBG_SITE " line 1-100000 =_\n") < 0) {
+        printf("Failed to disable the sites: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (count_sites("procs_module_init", "=_") != disabled) {
+        printf("The sites were not disabled.\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,193 @@
+/// @file t_flock.c
+/// @brief Tests the advisory file locks, placed with `fcntl` and `flock`.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/// The file we lock.
+#define FLOCK_PATH "/home/user/t_flock.txt"
+
+/// @brief Places a record lock on the file.
+/// @param fd the file descriptor.
+/// @param request either F_SETLK or F_SETLKW.
+/// @param type the type of lock.
+/// @param start the first byte.
+/// @param len the number of bytes.
+/// @return the result of fcntl.
+static int set_lock(int fd, int request, short type, off_t start, off_t len)
+{
+    flock_t lock = { .l_type = type, .l_whence = SEEK_SET, .l_start = start, .l_len = len };
+    return fcntl(fd, request, (unsigned long)&lock);
+}
+
+/// @brief Sleeps for the given number of milliseconds.
+/// @param ms the milliseconds.
+static void sleep_ms(long ms)
+{
+    timespec_t req = { 0, ms * 1000000 };
+    nanosleep(&req, NULL);
+}
+
+/// @brief Waits for a child and checks that it succeeded.
+/// @param pid the child.
+/// @return 0 if the child succeeded, -1 otherwise.
+static int wait_child(pid_t pid)
+{
+    int status;
+    if ((pid < 0) || (waitpid(pid, &status, 0) != pid)) {
+        printf("Failed to wait for the child: %s\n", strerror(errno));
+        return -1;
+    }
+    return (WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS)) ? 0 : -1;
+}
+
+/// @brief Checks that the locks of the parent are seen by a child.
+/// @param fd the file descriptor.
+/// @param parent the pid of the parent.
+/// @return EXIT_SUCCESS or EXIT_FAILURE, the exit status of the child.
+static int child_conflicts(int fd, pid_t parent)
+{
+    if ((set_lock(fd, F_SETLK, F_WRLCK, 0, 10) == 0) || (errno != EAGAIN)) {
+        printf("A conflicting lock was granted.\n");
+        return EXIT_FAILURE;
+    }
+    if (set_lock(fd, F_SETLK, F_WRLCK, 10, 10) < 0) {
+        printf("A disjoint lock was refused: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    flock_t lock = { .l_type = F_WRLCK, .l_whence = SEEK_SET, .l_start = 5, .l_len = 1 };
+    if ((fcntl(fd, F_GETLK, (unsigned long)&lock) < 0) || (lock.l_type != F_WRLCK) || (lock.l_pid != parent)) {
+        printf("F_GETLK did not report the lock of the parent.\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/// @brief Waits for a lock held by the parent, after locking a range the
+/// parent will ask for.
+/// @param fd the file descriptor.
+/// @return EXIT_SUCCESS or EXIT_FAILURE, the exit status of the child.
+static int child_waits(int fd)
+{
+    if (set_lock(fd, F_SETLK, F_WRLCK, 10, 10) < 0) {
+        printf("Failed to lock the second range: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (set_lock(fd, F_SETLKW, F_WRLCK, 0, 10) < 0) {
+        printf("Failed to wait for the first range: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/// @brief Checks the whole-file locks of the parent from a child.
+/// @param fd the file descriptor.
+/// @param operation the lock the child tries to take.
+/// @param expected the expected result.
+/// @return EXIT_SUCCESS or EXIT_FAILURE, the exit status of the child.
+static int child_flock(int fd, int operation, int expected)
+{
+    int ret = flock(fd, operation | LOCK_NB);
+    if ((ret == 0) != (expected == 0)) {
+        printf("flock returned %d, expected %d.\n", ret, expected);
+        return EXIT_FAILURE;
+    }
+    if ((ret < 0) && (errno != EWOULDBLOCK)) {
+        printf("flock failed with an unexpected error: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(void)
+{
+    pid_t pid, parent = getpid();
+    int fd = open(FLOCK_PATH, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        printf("Failed to open %s: %s\n", FLOCK_PATH, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    int result = EXIT_FAILURE;
+
+    // A record lock is seen by the other processes.
+    if (set_lock(fd, F_SETLK, F_WRLCK, 0, 10) < 0) {
+        printf("Failed to lock the first range: %s\n", strerror(errno));
+        goto cleanup;
+    }
+    if ((pid = fork()) == 0) {
+        exit(child_conflicts(fd, parent));
+    }
+    if (wait_child(pid) < 0) {
+        goto cleanup;
+    }
+
+    // A waiter wakes up when the lock is released, and waiting on it in turn
+    // would be a deadlock.
+    if ((pid = fork()) == 0) {
+        exit(child_waits(fd));
+    }
+    sleep_ms(100);
+    if ((set_lock(fd, F_SETLKW, F_WRLCK, 10, 10) == 0) || (errno != EDEADLK)) {
+        printf("The deadlock was not detected.\n");
+        goto cleanup;
+    }
+    if ((set_lock(fd, F_SETLK, F_UNLCK, 0, 10) < 0) || (wait_child(pid) < 0)) {
+        printf("The waiter did not get the lock.\n");
+        goto cleanup;
+    }
+
+    // The locks of an exited process are released.
+    if (set_lock(fd, F_SETLK, F_WRLCK, 0, 0) < 0) {
+        printf("The locks of the child were not released: %s\n", strerror(errno));
+        goto cleanup;
+    }
+    if (set_lock(fd, F_SETLK, F_UNLCK, 0, 0) < 0) {
+        printf("Failed to unlock the file: %s\n", strerror(errno));
+        goto cleanup;
+    }
+
+    // Whole-file locks: exclusive ones exclude the others, shared ones do not.
+    if (flock(fd, LOCK_EX) < 0) {
+        printf("Failed to lock the file: %s\n", strerror(errno));
+        goto cleanup;
+    }
+    if ((pid = fork()) == 0) {
+        exit(child_flock(fd, LOCK_SH, -1));
+    }
+    if (wait_child(pid) < 0) {
+        goto cleanup;
+    }
+    if (flock(fd, LOCK_SH) < 0) {
+        printf("Failed to convert the lock: %s\n", strerror(errno));
+        goto cleanup;
+    }
+    if ((pid = fork()) == 0) {
+        exit(child_flock(fd, LOCK_SH, 0));
+    }
+    if (wait_child(pid) < 0) {
+        goto cleanup;
+    }
+    if (flock(fd, LOCK_UN) < 0) {
+        printf("Failed to unlock the file: %s\n", strerror(errno));
+        goto cleanup;
+    }
+    result = EXIT_SUCCESS;
+
+cleanup:
+    close(fd);
+    if (unlink(FLOCK_PATH) < 0) {
+        printf("Failed to remove %s: %s\n", FLOCK_PATH, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    return result;
+}
@@ -0,0 +1,112 @@
+/// @file t_list_head.c
+/// @brief This program tests the list_head algorithms.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "list_head.h"
+#include "list_head_algorithm.h"
+
+/// Number of entries used by the tests.
+#define NUM_ENTRIES 257
+
+/// @brief An entry of the lists we test.
+typedef struct entry {
+    int key;        ///< The key used for sorting.
+    int order;      ///< The insertion order, used to check stability.
+    list_head list; ///< The list link.
+} entry_t;
+
+static entry_t entries[NUM_ENTRIES];
+static entry_t others[NUM_ENTRIES];
+
+static int entry_compare(const list_head *a, const list_head *b)
+{
+    return list_entry(a, entry_t, list)->key > list_entry(b, entry_t, list)->key;
+}
+
+/// @brief Checks that the list is sorted, and that equal keys kept their insertion order.
+static int check_sorted_stable(list_head *head, unsigned expected_size)
+{
+    entry_t *prev = NULL, *curr;
+    if (list_head_size(head) != expected_size) {
+        printf("Error: expected %u entries, found %u\n", expected_size, list_head_size(head));
+        return 0;
+    }
+    list_for_each_decl (it, head) {
+        curr = list_entry(it, entry_t, list);
+        if (it->next->prev != it) {
+            printf("Error: broken links at key %d\n", curr->key);
+            return 0;
+        }
+        if (prev && ((prev->key > curr->key) || ((prev->key == curr->key) && (prev->order > curr->order)))) {
+            printf("Error: (%d, %d) comes before (%d, %d)\n", prev->key, prev->order, curr->key, curr->order);
+            return 0;
+        }
+        prev = curr;
+    }
+    return 1;
+}
+
+int main(void)
+{
+    list_head list, other;
+    list_head_init(&list);
+    list_head_init(&other);
+
+    // Sorting an empty list, or a list with a single entry, is a no-op.
+    list_head_sort(&list, entry_compare);
+    if (!list_head_empty(&list)) {
+        printf("Error: sorting an empty list failed\n");
+        return 1;
+    }
+
+    // Sort a list with many duplicated keys.
+    srand(42);
+    for (int i = 0; i < NUM_ENTRIES; ++i) {
+        entries[i].key   = rand() % 32;
+        entries[i].order = i;
+        list_head_insert_before(&entries[i].list, &list);
+    }
+    list_head_sort(&list, entry_compare);
+    if (!check_sorted_stable(&list, NUM_ENTRIES) || !list_head_is_sorted(&list, entry_compare)) {
+        printf("Error: list_head_sort failed\n");
+        return 1;
+    }
+
+    // Sorted insertion must keep the list sorted, and be stable.
+    for (int i = 0; i < NUM_ENTRIES; ++i) {
+        others[i].key   = rand() % 32;
+        others[i].order = NUM_ENTRIES + i;
+        list_head_insert_sorted(&others[i].list, &other, entry_compare);
+    }
+    if (!check_sorted_stable(&other, NUM_ENTRIES)) {
+        printf("Error: list_head_insert_sorted failed\n");
+        return 1;
+    }
+
+    // Merge the two sorted lists, entries of the main list come first on ties.
+    list_head_merge(&list, &other, entry_compare);
+    if (!list_head_empty(&other) || !check_sorted_stable(&list, 2 * NUM_ENTRIES)) {
+        printf("Error: list_head_merge failed\n");
+        return 1;
+    }
+
+    // Splice everything back into the other list.
+    list_head_splice_tail(&list, &other);
+    if (!list_head_empty(&list) || !check_sorted_stable(&other, 2 * NUM_ENTRIES)) {
+        printf("Error: list_head_splice_tail failed\n");
+        return 1;
+    }
+
+    // Merging into an empty list moves all the entries.
+    list_head_merge(&list, &other, entry_compare);
+    if (!list_head_empty(&other) || !check_sorted_stable(&list, 2 * NUM_ENTRIES)) {
+        printf("Error: list_head_merge on an empty list failed\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+/// @file t_madvise.c
+/// @brief Tests the madvise, mlock and munlock system calls.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/// The size of a page.
+#define PAGE_SIZE 4096
+/// The number of pages of the buffer.
+#define NUM_PAGES 8
+/// The bit of a pagemap entry telling that the page is present.
+#define PM_PRESENT (1ULL << 63)
+
+/// A buffer made of whole pages.
+static char buffer[NUM_PAGES * PAGE_SIZE] __attribute__((aligned(PAGE_SIZE)));
+
+/// @brief Checks if the given page of the buffer is resident.
+/// @param index the index of the page.
+/// @return 1 if it is present, 0 if it is not, -1 on failure.
+static int is_present(int index)
+{
+    char path[PATH_MAX];
+    uint64_t entry = 0;
+    snprintf(path, PATH_MAX, "/proc/%d/pagemap", getpid());
+    int fd = open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    off_t offset = ((uintptr_t)(buffer + index * PAGE_SIZE) / PAGE_SIZE) * sizeof(uint64_t);
+    if ((lseek(fd, offset, SEEK_SET) != offset) || (read(fd, &entry, sizeof(entry)) != sizeof(entry))) {
+        printf("Failed to read %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    close(fd);
+    return (entry & PM_PRESENT) != 0;
+}
+
+int main(void)
+{
+    // Invalid arguments are rejected.
+    if ((madvise(buffer + 1, PAGE_SIZE, MADV_DONTNEED) != -1) || (errno != EINVAL)) {
+        printf("An unaligned address was accepted.\n");
+        return EXIT_FAILURE;
+    }
+    if ((madvise(buffer, PAGE_SIZE, 42) != -1) || (errno != EINVAL)) {
+        printf("An invalid advice was accepted.\n");
+        return EXIT_FAILURE;
+    }
+    if ((madvise((void *)PAGE_SIZE, PAGE_SIZE, MADV_WILLNEED) != -1) || (errno != ENOMEM)) {
+        printf("An unmapped range was accepted.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Dropped pages are zeroed, and they are populated again on demand.
+    memset(buffer, 0xAA, sizeof(buffer));
+    if (madvise(buffer, sizeof(buffer), MADV_DONTNEED) < 0) {
+        printf("Failed to drop the pages: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (is_present(0) != 0) {
+        printf("A dropped page is still present.\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < (int)sizeof(buffer); ++i) {
+        if (buffer[i] != 0) {
+            printf("A dropped page was not zeroed at offset %d.\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Random accesses only populate the faulting page.
+    if ((madvise(buffer, sizeof(buffer), MADV_RANDOM) < 0) || (madvise(buffer, sizeof(buffer), MADV_DONTNEED) < 0)) {
+        printf("Failed to advise random accesses: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    buffer[0] = 1;
+    if ((is_present(0) != 1) || (is_present(1) != 0)) {
+        printf("Random accesses populated the neighbouring pages.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Sequential accesses populate the pages ahead.
+    if ((madvise(buffer, sizeof(buffer), MADV_SEQUENTIAL) < 0) ||
+        (madvise(buffer, sizeof(buffer), MADV_DONTNEED) < 0)) {
+        printf("Failed to advise sequential accesses: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    buffer[0] = 1;
+    if ((is_present(1) != 1) || (is_present(NUM_PAGES - 1) != 1)) {
+        printf("Sequential accesses did not populate the pages ahead.\n");
+        return EXIT_FAILURE;
+    }
+    madvise(buffer, sizeof(buffer), MADV_NORMAL);
+
+    // Pages which will be needed are populated right away.
+    if ((madvise(buffer, sizeof(buffer), MADV_DONTNEED) < 0) || (madvise(buffer, sizeof(buffer), MADV_WILLNEED) < 0)) {
+        printf("Failed to prefetch the pages: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < NUM_PAGES; ++i) {
+        if (is_present(i) != 1) {
+            printf("Page %d was not prefetched.\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Lazily freed pages keep their content until the memory runs low.
+    memset(buffer, 0x55, sizeof(buffer));
+    if (madvise(buffer, sizeof(buffer), MADV_FREE) < 0) {
+        printf("Failed to free the pages: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if ((buffer[0] != 0x55) && (buffer[0] != 0)) {
+        printf("A lazily freed page has unexpected content.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Locked pages are resident, and cannot be dropped.
+    if ((madvise(buffer, sizeof(buffer), MADV_DONTNEED) < 0) || (mlock(buffer, sizeof(buffer)) < 0)) {
+        printf("Failed to lock the pages: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (is_present(NUM_PAGES - 1) != 1) {
+        printf("A locked page is not present.\n");
+        return EXIT_FAILURE;
+    }
+    if ((madvise(buffer, sizeof(buffer), MADV_DONTNEED) != -1) || (errno != EINVAL)) {
+        printf("Locked pages were dropped.\n");
+        return EXIT_FAILURE;
+    }
+    if ((munlock(buffer, sizeof(buffer)) < 0) || (madvise(buffer, sizeof(buffer), MADV_DONTNEED) < 0)) {
+        printf("Failed to unlock the pages: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,201 @@
+/// @file t_math.c
+/// @brief Tests the math functions: known values, special cases, errno, and
+/// the agreement of the batch functions with the scalar ones.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/// The number of elements of the batches.
+#define BATCH_SIZE 257
+
+/// @brief Computes the distance between two doubles, in ulp.
+/// @param a the first value.
+/// @param b the second value.
+/// @return the number of doubles between them, or -1 if only one is a NaN.
+static int64_t ulp_diff(double a, double b)
+{
+    union {
+        double f;
+        int64_t i;
+    } ua = { a }, ub = { b };
+    if (isnan(a) || isnan(b)) {
+        return (isnan(a) && isnan(b)) ? 0 : -1;
+    }
+    // Map the doubles to integers with the same ordering.
+    if (ua.i < 0) {
+        ua.i = INT64_MIN - ua.i;
+    }
+    if (ub.i < 0) {
+        ub.i = INT64_MIN - ub.i;
+    }
+    return (ua.i > ub.i) ? ua.i - ub.i : ub.i - ua.i;
+}
+
+/// @brief Checks that a result is within 1 ulp of the expected value.
+/// @param name the name of the test.
+/// @param value the result.
+/// @param expected the expected value.
+/// @return 0 on success, 1 on failure.
+static int check(const char *name, double value, double expected)
+{
+    int64_t diff = ulp_diff(value, expected);
+    if ((diff < 0) || (diff > 1)) {
+        printf("%s: got %.17g, expected %.17g.\n", name, value, expected);
+        return 1;
+    }
+    return 0;
+}
+
+/// @brief Checks that a result is exactly the expected value, and the errno.
+/// @param name the name of the test.
+/// @param value the result.
+/// @param expected the expected value.
+/// @param expected_errno the expected errno, 0 if it must not change.
+/// @return 0 on success, 1 on failure.
+static int check_errno(const char *name, double value, double expected, int expected_errno)
+{
+    if (ulp_diff(value, expected) != 0) {
+        printf("%s: got %g, expected %g.\n", name, value, expected);
+        return 1;
+    }
+    if (errno != expected_errno) {
+        printf("%s: errno is %d, expected %d.\n", name, errno, expected_errno);
+        return 1;
+    }
+    return 0;
+}
+
+/// @brief Checks a batch function against the scalar one.
+/// @param name the name of the function.
+/// @param batch the batch function.
+/// @param scalar the scalar function.
+/// @param min the start of the range of the arguments.
+/// @param max the end of the range of the arguments.
+/// @return 0 on success, 1 on failure.
+static int check_batch(
+    const char *name, void (*batch)(double *, const double *, size_t), double (*scalar)(double), double min,
+    double max)
+{
+    double src[BATCH_SIZE], dst[BATCH_SIZE];
+    for (int i = 0; i < BATCH_SIZE; ++i) {
+        src[i] = min + (max - min) * i / (BATCH_SIZE - 1);
+    }
+    // Special values, to exercise the scalar fallback.
+    src[10]  = INFINITY;
+    src[11]  = -INFINITY;
+    src[20]  = NAN;
+    src[100] = 0.0;
+    batch(dst, src, BATCH_SIZE);
+    for (int i = 0; i < BATCH_SIZE; ++i) {
+        int64_t diff = ulp_diff(dst[i], scalar(src[i]));
+        if ((diff < 0) || (diff > 1)) {
+            printf("%s(%.17g): got %.17g, expected %.17g.\n", name, src[i], dst[i], scalar(src[i]));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/// @brief Checks a single precision batch function against the scalar one.
+/// @param name the name of the function.
+/// @param batch the batch function.
+/// @param scalar the scalar function.
+/// @param min the start of the range of the arguments.
+/// @param max the end of the range of the arguments.
+/// @return 0 on success, 1 on failure.
+static int check_batchf(
+    const char *name, void (*batch)(float *, const float *, size_t), float (*scalar)(float), float min, float max)
+{
+    float src[BATCH_SIZE], dst[BATCH_SIZE];
+    for (int i = 0; i < BATCH_SIZE; ++i) {
+        src[i] = min + (max - min) * i / (BATCH_SIZE - 1);
+    }
+    src[10] = INFINITY;
+    src[20] = NAN;
+    batch(dst, src, BATCH_SIZE);
+    for (int i = 0; i < BATCH_SIZE; ++i) {
+        float expected = scalar(src[i]);
+        // One float ulp, relative to the expected value.
+        if (isnan(expected) ? !isnan(dst[i]) : (fabs(dst[i] - expected) > fabs(expected) * 0x1p-23)) {
+            printf("%s(%g): got %g, expected %g.\n", name, src[i], dst[i], expected);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    // Known values, correctly rounded.
+    failures += check("exp(1)", exp(1.0), 0x1.5bf0a8b145769p+1);
+    failures += check("exp(0)", exp(0.0), 1.0);
+    failures += check("exp2(10)", exp2(10.0), 1024.0);
+    failures += check("log(2)", log(2.0), 0x1.62e42fefa39efp-1);
+    failures += check("log(1)", log(1.0), 0.0);
+    failures += check("log2(8)", log2(8.0), 3.0);
+    failures += check("log10(1000)", log10(1000.0), 3.0);
+    failures += check("pow(2, 10)", pow(2.0, 10.0), 1024.0);
+    failures += check("pow(-2, 3)", pow(-2.0, 3.0), -8.0);
+    failures += check("pow(4, 0.5)", pow(4.0, 0.5), 2.0);
+    failures += check("sin(pi)", sin(M_PI), 0x1.1a62633145c07p-53);
+    failures += check("sin(1e22)", sin(1e22), -0x1.b453ab76bf397p-1);
+    failures += check("cos(1e22)", cos(1e22), 0x1.0be2cef01c8f4p-1);
+    failures += check("tan(1)", tan(1.0), 0x1.8eb245cbee3a6p+0);
+    failures += check("atan2(1, 1)", atan2(1.0, 1.0), 0x1.921fb54442d18p-1);
+    failures += check("atan2(0, -1)", atan2(0.0, -1.0), 0x1.921fb54442d18p+1);
+    failures += check("sqrt(2)", sqrt(2.0), 0x1.6a09e667f3bcdp+0);
+    failures += check("expf(1)", expf(1.0F), 0x1.5bf0a8p+1);
+    failures += check("logf(2)", logf(2.0F), 0x1.62e430p-1);
+    failures += check("powf(2, 0.5)", powf(2.0F, 0.5F), 0x1.6a09e6p+0);
+
+    // Rounding functions.
+    failures += check("round(2.5)", round(2.5), 3.0);
+    failures += check("round(-2.5)", round(-2.5), -3.0);
+    failures += check("round(0.49999999999999994)", round(0.49999999999999994), 0.0);
+    failures += check("floor(-1.5)", floor(-1.5), -2.0);
+    failures += check("ceil(-1.5)", ceil(-1.5), -1.0);
+
+    // Special values and errno.
+    errno = 0;
+    failures += check_errno("exp(-inf)", exp(-INFINITY), 0.0, 0);
+    failures += check_errno("exp(inf)", exp(INFINITY), INFINITY, 0);
+    failures += check_errno("exp(1000)", exp(1000.0), INFINITY, ERANGE);
+    errno = 0;
+    failures += check_errno("exp(-1000)", exp(-1000.0), 0.0, ERANGE);
+    errno = 0;
+    failures += check_errno("log(0)", log(0.0), -INFINITY, ERANGE);
+    errno = 0;
+    failures += check_errno("log(-1)", log(-1.0), NAN, EDOM);
+    errno = 0;
+    failures += check_errno("sqrt(-1)", sqrt(-1.0), NAN, EDOM);
+    errno = 0;
+    failures += check_errno("sin(inf)", sin(INFINITY), NAN, EDOM);
+    errno = 0;
+    failures += check_errno("pow(-8, 1/3)", pow(-8.0, 1.0 / 3.0), NAN, EDOM);
+    errno = 0;
+    failures += check_errno("pow(0, -1)", pow(0.0, -1.0), INFINITY, ERANGE);
+    errno = 0;
+    failures += check_errno("pow(nan, 0)", pow(NAN, 0.0), 1.0, 0);
+    failures += check_errno("pow(1, nan)", pow(1.0, NAN), 1.0, 0);
+    failures += check_errno("pow(-1, inf)", pow(-1.0, INFINITY), 1.0, 0);
+    failures += check_errno("atan2(-0, -1)", atan2(-0.0, -1.0), -0x1.921fb54442d18p+1, 0);
+
+    // The batch functions agree with the scalar ones.
+    failures += check_batch("vexp", vexp, exp, -745.0, 745.0);
+    failures += check_batch("vlog", vlog, log, -1.0, 1e300);
+    failures += check_batch("vsin", vsin, sin, -1e6, 1e6);
+    failures += check_batch("vcos", vcos, cos, -10.0, 10.0);
+    failures += check_batchf("vexpf", vexpf, expf, -110.0F, 100.0F);
+    failures += check_batchf("vlogf", vlogf, logf, -1.0F, 1e30F);
+    failures += check_batchf("vsinf", vsinf, sinf, -1e4F, 1e4F);
+    failures += check_batchf("vcosf", vcosf, cosf, -10.0F, 10.0F);
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+/// @file t_nodeinfo.c
+/// @brief Tests the allocation statistics of the NUMA nodes in `/proc/nodeinfo`.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <string.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// @brief Sums a statistic over all the nodes.
+/// @param key the name of the statistic.
+/// @param nodes where we store the number of nodes, it can be NULL.
+/// @return the sum, -1 on failure.
+static long read_nodes_field(const char *key, int *nodes)
+{
+    char buffer[4096];
+    int fd = open("/proc/nodeinfo", O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open /proc/nodeinfo: %s\n", strerror(errno));
+        return -1;
+    }
+    memset(buffer, 0, sizeof(buffer));
+    ssize_t ret = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (ret <= 0) {
+        printf("Failed to read /proc/nodeinfo: %s\n", strerror(errno));
+        return -1;
+    }
+    long sum      = 0;
+    int count     = 0;
+    size_t length = strlen(key);
+    for (char *saveptr, *line = strtok_r(buffer, "\n", &saveptr); line; line = strtok_r(NULL, "\n", &saveptr)) {
+        if (!strncmp(line, "Node ", 5)) {
+            ++count;
+            continue;
+        }
+        // The statistics are indented, and followed by a colon.
+        line += strspn(line, " ");
+        if (!strncmp(line, key, length) && (line[length] == ' ')) {
+            sum += strtol(strchr(line, ':') + 1, NULL, 10);
+        }
+    }
+    if (count == 0) {
+        printf("There are no nodes in /proc/nodeinfo.\n");
+        return -1;
+    }
+    if (nodes) {
+        *nodes = count;
+    }
+    return sum;
+}
+
+/// @brief Returns the number of allocations served by any node.
+/// @return the number, -1 on failure.
+static long read_allocations(void)
+{
+    long hit = read_nodes_field("numa_hit", NULL), miss = read_nodes_field("numa_miss", NULL);
+    return ((hit < 0) || (miss < 0)) ? -1 : (hit + miss);
+}
+
+int main(void)
+{
+    int status, nodes;
+
+    // Every allocation is served by exactly one node.
+    if ((read_nodes_field("numa_foreign", &nodes) != read_nodes_field("numa_miss", NULL))) {
+        printf("The allocations served by another node do not match.\n");
+        return EXIT_FAILURE;
+    }
+    printf("Found %d memory nodes.\n", nodes);
+
+    // Creating a process allocates its page tables and its stacks.
+    long allocations = read_allocations();
+    pid_t pid        = fork();
+    if (pid == 0) {
+        exit(EXIT_SUCCESS);
+    }
+    if ((pid < 0) || (waitpid(pid, &status, 0) != pid)) {
+        printf("Failed to create the child process: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if ((allocations < 0) || (read_allocations() <= allocations)) {
+        printf("The allocations of the process creation were not accounted.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Shared memory segments are interleaved across the nodes.
+    allocations = read_allocations();
+    int shmid   = shmget(IPC_PRIVATE, 4096, IPC_CREAT | 0600);
+    if (shmid < 0) {
+        printf("Failed to create the shared memory segment: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    shmctl(shmid, IPC_RMID, NULL);
+    if (read_allocations() <= allocations) {
+        printf("The allocation of the shared memory segment was not accounted.\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+/// @file t_oom.c
+/// @brief Tests the OOM adjustment of processes and the memory pressure file.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// @brief Writes a value to the /proc/<pid>/oom_score_adj file of the calling process.
+/// @param value the value to write.
+/// @return 0 on success, -1 on failure.
+static int write_oom_score_adj(const char *value)
+{
+    char path[PATH_MAX];
+    snprintf(path, PATH_MAX, "/proc/%d/oom_score_adj", getpid());
+    int fd = open(path, O_WRONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    ssize_t ret = write(fd, value, strlen(value));
+    close(fd);
+    return (ret == (ssize_t)strlen(value)) ? 0 : -1;
+}
+
+/// @brief Reads a number from a file of the /proc/<pid> folder of the calling process.
+/// @param name the name of the file.
+/// @param value where the number is stored.
+/// @return 0 on success, -1 on failure.
+static int read_proc_value(const char *name, int *value)
+{
+    char path[PATH_MAX], buffer[32];
+    snprintf(path, PATH_MAX, "/proc/%d/%s", getpid(), name);
+    int fd = open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    memset(buffer, 0, sizeof(buffer));
+    ssize_t ret = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (ret <= 0) {
+        printf("Failed to read %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    *value = atoi(buffer);
+    return 0;
+}
+
+/// @brief Checks the memory pressure file.
+/// @return 0 on success, -1 on failure.
+static int check_mempressure(void)
+{
+    char level[32];
+    int fd = open("/proc/mempressure", O_RDONLY | O_NONBLOCK, 0);
+    if (fd < 0) {
+        printf("Failed to open /proc/mempressure: %s\n", strerror(errno));
+        return -1;
+    }
+    // The first read returns the current level.
+    memset(level, 0, sizeof(level));
+    if (read(fd, level, sizeof(level) - 1) <= 0) {
+        printf("Failed to read /proc/mempressure: %s\n", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    if (strcmp(level, "none\n") && strcmp(level, "low\n") && strcmp(level, "medium\n") && strcmp(level, "critical\n")) {
+        printf("Unexpected memory pressure level `%s`.\n", level);
+        close(fd);
+        return -1;
+    }
+    // The following ones wait for the level to change, unless it already did.
+    if ((read(fd, level, sizeof(level) - 1) < 0) && (errno != EAGAIN)) {
+        printf("Unexpected error while waiting for the memory pressure: %s\n", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    close(fd);
+    return 0;
+}
+
+int main(void)
+{
+    int value, status;
+
+    // Processes start with no adjustment, and can be killed.
+    if ((read_proc_value("oom_score_adj", &value) < 0) || (value != 0)) {
+        printf("Unexpected initial adjustment.\n");
+        return EXIT_FAILURE;
+    }
+    if (read_proc_value("oom_score", &value) < 0) {
+        return EXIT_FAILURE;
+    }
+
+    // Values outside the range, or which are not numbers, are rejected.
+    if ((write_oom_score_adj("1001\n") == 0) || (write_oom_score_adj("-1001\n") == 0) ||
+        (write_oom_score_adj("abc\n") == 0)) {
+        printf("An invalid adjustment was accepted.\n");
+        return EXIT_FAILURE;
+    }
+
+    // The highest adjustment makes the process the preferred victim.
+    if (write_oom_score_adj("1000\n") < 0) {
+        printf("Failed to set the adjustment: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if ((read_proc_value("oom_score", &value) < 0) || (value < 1000)) {
+        printf("The score does not reflect the adjustment: %d.\n", value);
+        return EXIT_FAILURE;
+    }
+
+    // The adjustment is inherited by the children.
+    pid_t pid = fork();
+    if (pid == 0) {
+        exit(((read_proc_value("oom_score_adj", &value) < 0) || (value != 1000)) ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+    if ((pid < 0) || (waitpid(pid, &status, 0) != pid)) {
+        printf("Failed to create the child process: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (WEXITSTATUS(status) != EXIT_SUCCESS) {
+        printf("The child did not inherit the adjustment.\n");
+        return EXIT_FAILURE;
+    }
+
+    // The lowest adjustment makes the process unkillable.
+    if (write_oom_score_adj("-1000\n") < 0) {
+        printf("Failed to set the adjustment: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if ((read_proc_value("oom_score", &value) < 0) || (value != 0)) {
+        printf("An unkillable process has score %d.\n", value);
+        return EXIT_FAILURE;
+    }
+    if (write_oom_score_adj("0\n") < 0) {
+        return EXIT_FAILURE;
+    }
+    return (check_mempressure() < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -43,7 +43,7 @@ int main(void)
             bytes_read = read(fds[0], read_msg, sizeof(read_msg));
             if (bytes_read > 0) {
                 printf("Child read message: '%s' (%ld bytes)\n", read_msg, bytes_read);
-            } else if ((bytes_read == -1) && (errno != EAGAIN)) {
+            } else if (bytes_read == -1) {
                 fprintf(stderr, "Error occurred during read in child process\n");
                 error_code = 1;
                 break;
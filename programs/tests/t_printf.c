@@ -0,0 +1,170 @@
+/// @file t_printf.c
+/// @brief Tests the formatting functions: the integer and floating point
+/// conversions with their flags, the rounding of the digits, the truncation
+/// done by snprintf, and the shortest conversion of doubles.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <fcvt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief A conversion of an integer.
+typedef struct int_case {
+    const char *format;   ///< The format.
+    int value;            ///< The value.
+    const char *expected; ///< The expected output.
+} int_case_t;
+
+/// @brief A conversion of a double.
+typedef struct double_case {
+    const char *format;   ///< The format.
+    double value;         ///< The value.
+    const char *expected; ///< The expected output.
+} double_case_t;
+
+/// The conversions of integers.
+static const int_case_t int_cases[] = {
+    { "%d", 0, "0" },
+    { "%d", -2147483647 - 1, "-2147483648" },
+    { "%d", 2147483647, "2147483647" },
+    { "%5d", 42, "   42" },
+    { "%-5d|", 42, "42   |" },
+    { "%05d", -42, "-0042" },
+    { "%+d", 7, "+7" },
+    { "% d", 7, " 7" },
+    { "%.0d", 0, "" },
+    { "%.5d", -12, "-00012" },
+    { "%8.3d", 5, "     005" },
+    { "%u", (int)4294967295U, "4294967295" },
+    { "%x", (int)3735928559U, "deadbeef" },
+    { "%X", (int)3735928559U, "DEADBEEF" },
+    { "%#x", (int)255U, "0xff" },
+    { "%#X", (int)255U, "0XFF" },
+    { "%#x", (int)0U, "0" },
+    { "%#o", (int)8U, "010" },
+    { "%#o", (int)0U, "0" },
+    { "%o", (int)511U, "777" },
+    { "%hd", 65535, "-1" },
+    { "%hu", (int)65537U, "1" },
+    { "%c", 'A', "A" },
+    { "%3c", 'A', "  A" },
+    { "%-3c|", 'A', "A  |" },
+};
+
+/// The conversions of doubles.
+static const double_case_t double_cases[] = {
+    { "%f", 0.0, "0.000000" },
+    { "%f", -0.0, "-0.000000" },
+    { "%f", 1.5, "1.500000" },
+    { "%.0f", 0.5, "0" },
+    { "%.0f", 1.5, "2" },
+    { "%.0f", 2.5, "2" },
+    { "%.2f", 1.005, "1.00" },
+    { "%.3f", 0.0005, "0.001" },
+    { "%.1f", 9.96, "10.0" },
+    { "%10.3f", -3.14159, "    -3.142" },
+    { "%-10.2f|", 2.5, "2.50      |" },
+    { "%010.2f", -2.5, "-000002.50" },
+    { "%+.1f", 3.0, "+3.0" },
+    { "%#.0f", 3.0, "3." },
+    { "%f", 1e20, "100000000000000000000.000000" },
+    { "%.20f", 0.1, "0.10000000000000000555" },
+    { "%e", 0.0, "0.000000e+00" },
+    { "%e", 123456.789, "1.234568e+05" },
+    { "%.2e", 9.999, "1.00e+01" },
+    { "%E", 1e-300, "1.000000E-300" },
+    { "%.0e", 5e10, "5e+10" },
+    { "%g", 0.0, "0" },
+    { "%g", 100000.0, "100000" },
+    { "%g", 1000000.0, "1e+06" },
+    { "%g", 0.0001, "0.0001" },
+    { "%g", 0.00001234, "1.234e-05" },
+    { "%.3g", 3.14159, "3.14" },
+    { "%G", 1e-10, "1E-10" },
+    { "%#g", 1.5, "1.50000" },
+    { "%.17g", 0.1, "0.10000000000000001" },
+    { "%g", 1.7976931348623157e308, "1.79769e+308" },
+    { "%g", 4.9406564584124654e-324, "4.94066e-324" },
+    { "%.10f", 4.9406564584124654e-324, "0.0000000000" },
+    { "%f", INFINITY, "inf" },
+    { "%E", -INFINITY, "-INF" },
+    { "%5f", NAN, "  nan" },
+    { "%.40f", 1.0/3.0, "0.3333333333333333148296162562473909929395" },
+};
+
+/// @brief Checks the output of a conversion.
+/// @param format the format.
+/// @param output the output.
+/// @param length the value returned by the conversion.
+/// @param expected the expected output.
+/// @return 0 on success, 1 on failure.
+static int check(const char *format, const char *output, int length, const char *expected)
+{
+    if (strcmp(output, expected) || (length != (int)strlen(expected))) {
+        printf("`%s`: got \"%s\" (%d), expected \"%s\".\n", format, output, length, expected);
+        return 1;
+    }
+    return 0;
+}
+
+/// @brief Checks that snprintf truncates the output, and returns its length.
+/// @return 0 on success, 1 on failure.
+static int check_truncation(void)
+{
+    char buffer[8];
+    int failures = 0;
+
+    failures += check("%d (5)", buffer, snprintf(buffer, 5, "%d", 123456789), "1234");
+    failures += check("%.3f (6)", buffer, snprintf(buffer, 6, "%.3f", -3.14159), "-3.14");
+    failures += check("%8s (4)", buffer, snprintf(buffer, 4, "%8s", "abc"), "   ");
+    memset(buffer, '#', sizeof(buffer));
+    failures += check("%e (1)", buffer, snprintf(buffer, 1, "%e", 1.0), "");
+    if (buffer[1] != '#') {
+        printf("snprintf wrote past the end of the buffer.\n");
+        failures++;
+    }
+    return failures;
+}
+
+/// @brief Checks that the shortest digits of some doubles read back as them.
+/// @return 0 on success, 1 on failure.
+static int check_shortest(void)
+{
+    const double values[] = { 0.1, 1.0 / 3.0, 5e-324, 1.7976931348623157e308, 123.456, 1e22, 9007199254740993.0 };
+    const char *digits[]  = { "1", "3333333333333333", "5", "17976931348623157", "123456", "1", "9007199254740992" };
+    const int decpts[]    = { 0, 0, -323, 309, 3, 23, 16 };
+    char buffer[32];
+    int decpt, sign, failures = 0;
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        int length = scvtbuf(values[i], &decpt, &sign, buffer, sizeof(buffer));
+        if (strcmp(buffer, digits[i]) || (length != (int)strlen(digits[i])) || (decpt != decpts[i]) || sign) {
+            printf("scvtbuf(%.17g): got %s, %d, expected %s, %d.\n", values[i], buffer, decpt, digits[i], decpts[i]);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int main(void)
+{
+    char buffer[128];
+    int failures = 0;
+
+    for (size_t i = 0; i < sizeof(int_cases) / sizeof(int_cases[0]); ++i) {
+        const int_case_t *c = &int_cases[i];
+        failures += check(c->format, buffer, snprintf(buffer, sizeof(buffer), c->format, c->value), c->expected);
+        failures += check(c->format, buffer, sprintf(buffer, c->format, c->value), c->expected);
+    }
+    for (size_t i = 0; i < sizeof(double_cases) / sizeof(double_cases[0]); ++i) {
+        const double_case_t *c = &double_cases[i];
+        failures += check(c->format, buffer, snprintf(buffer, sizeof(buffer), c->format, c->value), c->expected);
+        failures += check(c->format, buffer, sprintf(buffer, c->format, c->value), c->expected);
+    }
+    failures += check_truncation();
+    failures += check_shortest();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
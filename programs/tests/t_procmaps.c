@@ -0,0 +1,99 @@
+/// @file t_procmaps.c
+/// @brief Tests the /proc/<pid>/maps, smaps and pagemap files.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <string.h>
+#include <unistd.h>
+
+/// The size of a page.
+#define PAGE_SIZE 4096
+/// The bit of a pagemap entry telling that the page is present.
+#define PM_PRESENT (1ULL << 63)
+
+/// @brief Reads the beginning of a file of the /proc/<pid> folder.
+/// @param name the name of the file.
+/// @param buffer where the content is placed.
+/// @param size the size of the buffer.
+/// @return 0 on success, -1 on failure.
+static int read_proc_file(const char *name, char *buffer, size_t size)
+{
+    char path[PATH_MAX];
+    snprintf(path, PATH_MAX, "/proc/%d/%s", getpid(), name);
+    int fd = open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    memset(buffer, 0, size);
+    ssize_t ret = read(fd, buffer, size - 1);
+    close(fd);
+    if (ret <= 0) {
+        printf("Failed to read %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    char buffer[2048];
+    char path[PATH_MAX];
+    uint64_t entry = 0;
+    // A variable on the stack, which is surely resident.
+    volatile int on_stack = 42;
+
+    // Every process has a stack.
+    if (read_proc_file("maps", buffer, sizeof(buffer)) < 0) {
+        return EXIT_FAILURE;
+    }
+    if (!strstr(buffer, "[stack]")) {
+        printf("The stack is missing from maps:\n%s\n", buffer);
+        return EXIT_FAILURE;
+    }
+
+    // Each area comes with its statistics.
+    if (read_proc_file("smaps", buffer, sizeof(buffer)) < 0) {
+        return EXIT_FAILURE;
+    }
+    if (!strstr(buffer, "[stack]") || !strstr(buffer, "Rss:")) {
+        printf("Unexpected smaps content:\n%s\n", buffer);
+        return EXIT_FAILURE;
+    }
+
+    // The page containing the variable must be present.
+    snprintf(path, PATH_MAX, "/proc/%d/pagemap", getpid());
+    int fd = open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open %s: %s\n", path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    off_t offset = ((uintptr_t)&on_stack / PAGE_SIZE) * sizeof(entry);
+    if (lseek(fd, offset, SEEK_SET) != offset) {
+        printf("Failed to seek %s: %s\n", path, strerror(errno));
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    if (read(fd, &entry, sizeof(entry)) != sizeof(entry)) {
+        printf("Failed to read %s: %s\n", path, strerror(errno));
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    // Reads which are not made of whole entries are rejected.
+    if (read(fd, &entry, 3) >= 0) {
+        printf("A partial read of %s succeeded.\n", path);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    close(fd);
+    if (!(entry & PM_PRESENT)) {
+        printf("The page of the stack at %p is not present.\n", (void *)&on_stack);
+        return EXIT_FAILURE;
+    }
+    return on_stack == 42 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,119 @@
+/// @file t_procstat.c
+/// @brief Tests the CPU time and context switch counters of `/proc/stat` and
+/// `/proc/<pid>/stat`.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/// @brief Reads a file.
+/// @param path the path of the file.
+/// @param buffer the buffer where the content is placed.
+/// @param size the size of the buffer.
+/// @return 0 on success, -1 on failure.
+static int read_file(const char *path, char *buffer, size_t size)
+{
+    int fd = open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    memset(buffer, 0, size);
+    ssize_t ret = read(fd, buffer, size - 1);
+    close(fd);
+    if (ret <= 0) {
+        printf("Failed to read %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/// @brief Reads a field of the `/proc/<pid>/stat` file of the calling process.
+/// @param index the index of the field, starting from 1.
+/// @return the value of the field, -1 on failure.
+static long read_task_field(int index)
+{
+    char path[PATH_MAX], buffer[1024];
+    snprintf(path, PATH_MAX, "/proc/%d/stat", getpid());
+    if (read_file(path, buffer, sizeof(buffer)) < 0) {
+        return -1;
+    }
+    // The fields after the name start from the third one.
+    char *saveptr, *field = strrchr(buffer, ')');
+    if (!field) {
+        return -1;
+    }
+    field = strtok_r(field + 1, " \n", &saveptr);
+    for (int i = 3; field && (i < index); ++i) {
+        field = strtok_r(NULL, " \n", &saveptr);
+    }
+    return field ? strtol(field, NULL, 10) : -1;
+}
+
+/// @brief Reads a line of the `/proc/stat` file.
+/// @param key the key of the line.
+/// @return the first value of the line, -1 on failure.
+static long read_system_field(const char *key)
+{
+    char buffer[512];
+    if (read_file("/proc/stat", buffer, sizeof(buffer)) < 0) {
+        return -1;
+    }
+    size_t length = strlen(key);
+    for (char *saveptr, *line = strtok_r(buffer, "\n", &saveptr); line; line = strtok_r(NULL, "\n", &saveptr)) {
+        if (!strncmp(line, key, length) && (line[length] == ' ')) {
+            return strtol(line + length, NULL, 10);
+        }
+    }
+    printf("Cannot find `%s` in /proc/stat.\n", key);
+    return -1;
+}
+
+int main(void)
+{
+    int status;
+
+    // Running in user mode is accounted as user time.
+    long utime = read_task_field(14);
+    if ((utime < 0) || (read_system_field("cpu") < 0)) {
+        return EXIT_FAILURE;
+    }
+    for (time_t start = time(NULL); time(NULL) - start < 2;) {}
+    if (read_task_field(14) <= utime) {
+        printf("The user time did not increase while running.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Sleeping is a voluntary context switch.
+    long nvcsw = read_task_field(53);
+    timespec_t req = {0, 100000000};
+    nanosleep(&req, NULL);
+    if ((nvcsw < 0) || (read_task_field(53) <= nvcsw)) {
+        printf("Sleeping was not counted as a voluntary context switch.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Creating a process is counted, and so is the switch to it.
+    long processes = read_system_field("processes");
+    long ctxt      = read_system_field("ctxt");
+    pid_t pid      = fork();
+    if (pid == 0) {
+        exit(EXIT_SUCCESS);
+    }
+    if ((pid < 0) || (waitpid(pid, &status, 0) != pid)) {
+        printf("Failed to create the child process: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if ((read_system_field("processes") <= processes) || (read_system_field("ctxt") <= ctxt)) {
+        printf("The process creation was not accounted.\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
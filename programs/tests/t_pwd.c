@@ -7,6 +7,7 @@
 /// See LICENSE.md for details.
 
 #include <err.h>
+#include <errno.h>
 #include <pwd.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -56,6 +57,34 @@ static void __test_getpwuid(void)
     }
 }
 
+/// @brief Test `getpwnam_r` against `getpwuid`, and with a buffer too small.
+/// @details The reentrant functions copy the strings inside the buffer of the
+/// caller, and must fail with ERANGE when it cannot hold them.
+static void __test_getpwnam_r(void)
+{
+    passwd_t pwd, *result;
+    char buffer[BUFSIZ];
+
+    // Look up root by name, and compare it with the lookup by UID.
+    if (getpwnam_r("root", &pwd, buffer, BUFSIZ, &result) != 0 || result != &pwd) {
+        errx(EXIT_FAILURE, "Reentrant password entry for root user not found");
+    }
+    passwd_t *by_uid = getpwuid(pwd.pw_uid);
+    if (by_uid == NULL || strcmp(by_uid->pw_name, pwd.pw_name) != 0 || strcmp(by_uid->pw_dir, pwd.pw_dir) != 0) {
+        errx(EXIT_FAILURE, "Password entries for root user by name and UID differ");
+    }
+
+    // A missing user is not an error, but there is no result.
+    if (getpwnam_r("r", &pwd, buffer, BUFSIZ, &result) != 0 || result != NULL) {
+        errx(EXIT_FAILURE, "Reentrant password entry for non-existent user \"r\" found");
+    }
+
+    // The strings of the entry do not fit in a few bytes.
+    if (getpwnam_r("root", &pwd, buffer, 4, &result) != ERANGE || result != NULL) {
+        errx(EXIT_FAILURE, "Reentrant password entry did not fail with a small buffer");
+    }
+}
+
 /// @brief Main function that runs the tests for `getpwnam` and `getpwuid`.
 /// @return Returns EXIT_SUCCESS if all tests pass, otherwise exits with failure.
 int main(int argc, char *argv[])
@@ -66,6 +95,9 @@ int main(int argc, char *argv[])
     // Run the test for `getpwuid` function
     __test_getpwuid();
 
+    // Run the test for `getpwnam_r` function
+    __test_getpwnam_r();
+
     // If both tests pass, return success
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,89 @@
+/// @file t_setscheduler.c
+/// @brief Tests the runtime selection of the scheduling policy.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// @brief Checks the policy and the real-time priority of the calling process.
+/// @param policy the expected policy.
+/// @param priority the expected real-time priority.
+/// @return 0 if they match, -1 otherwise.
+static int check_policy(int policy, int priority)
+{
+    sched_param_t param;
+    int current = sched_getscheduler(0);
+    if (current != policy) {
+        printf("Expected policy %d, found %d.\n", policy, current);
+        return -1;
+    }
+    if (sched_getparam(0, &param) < 0) {
+        printf("Failed to get the scheduling parameters: %s\n", strerror(errno));
+        return -1;
+    }
+    if (param.sched_priority != priority) {
+        printf("Expected priority %d, found %d.\n", priority, param.sched_priority);
+        return -1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    sched_param_t param = {0};
+    int status;
+
+    // Processes start with the default policy.
+    if (check_policy(SCHED_NORMAL, 0) < 0) {
+        return EXIT_FAILURE;
+    }
+
+    // Invalid policies and priorities are rejected.
+    if ((sched_setscheduler(0, 42, &param) != -1) || (errno != EINVAL)) {
+        printf("An invalid policy was accepted.\n");
+        return EXIT_FAILURE;
+    }
+    param.sched_priority = 0;
+    if ((sched_setscheduler(0, SCHED_FIFO, &param) != -1) || (errno != EINVAL)) {
+        printf("A real-time policy with priority 0 was accepted.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Become a round-robin real-time process.
+    param.sched_priority = 10;
+    if (sched_setscheduler(0, SCHED_RR, &param) < 0) {
+        printf("Failed to set SCHED_RR: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (check_policy(SCHED_RR, 10) < 0) {
+        return EXIT_FAILURE;
+    }
+
+    // The child inherits the policy, and shares the CPU with us thanks to
+    // the time slices of SCHED_RR.
+    pid_t pid = fork();
+    if (pid == 0) {
+        exit(check_policy(SCHED_RR, 10) < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+    if ((pid < 0) || (waitpid(pid, &status, 0) != pid)) {
+        printf("Failed to create the child process: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (WEXITSTATUS(status) != EXIT_SUCCESS) {
+        printf("The child did not inherit the policy.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Go back to the default policy.
+    param.sched_priority = 0;
+    if (sched_setscheduler(0, SCHED_NORMAL, &param) < 0) {
+        printf("Failed to set SCHED_NORMAL: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    return (check_policy(SCHED_NORMAL, 0) < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
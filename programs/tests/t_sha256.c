@@ -0,0 +1,119 @@
+/// @file t_sha256.c
+/// @brief Tests the SHA-256 implementations: the vectors of the standard, the
+/// input split in pieces, and the agreement of the multi-buffer hashing with
+/// the hashing of a single stream.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <crypt/sha256.h>
+
+/// The number of messages hashed together.
+#define MULTI_COUNT 9
+
+/// @brief A test vector.
+typedef struct test_vector {
+    const char *input;    ///< The message.
+    unsigned repeat;      ///< How many times the message is repeated.
+    const char *expected; ///< The digest, in hexadecimal.
+} test_vector_t;
+
+/// The vectors of the standard, and one longer than a block.
+static const test_vector_t vectors[] = {
+    { "", 1, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+    { "abc", 1, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+    { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+    { "a", 1000000, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+};
+
+/// @brief Hashes a vector, feeding it in pieces of the given size.
+/// @param v the vector.
+/// @param piece the size of the pieces, 0 to feed each repetition at once.
+/// @return 0 on success, 1 on failure.
+static int check_vector(const test_vector_t *v, size_t piece)
+{
+    uint8_t hash[SHA256_BLOCK_SIZE];
+    char output[SHA256_BLOCK_SIZE * 2 + 1];
+    size_t len = strlen(v->input);
+    SHA256_ctx_t ctx;
+
+    sha256_init(&ctx);
+    for (unsigned i = 0; i < v->repeat; ++i) {
+        for (size_t off = 0; off < len;) {
+            size_t n = (piece && (piece < len - off)) ? piece : len - off;
+            sha256_update(&ctx, (const uint8_t *)v->input + off, n);
+            off += n;
+        }
+    }
+    sha256_final(&ctx, hash);
+    sha256_bytes_to_hex(hash, SHA256_BLOCK_SIZE, output, sizeof(output));
+    if (strcmp(output, v->expected) != 0) {
+        printf("%s: sha256(\"%.16s\" x %u) in pieces of %u is %s.\n", sha256_impl_name(sha256_get_impl()), v->input,
+               v->repeat, (unsigned)piece, output);
+        return 1;
+    }
+    return 0;
+}
+
+/// @brief Checks that the multi-buffer hashing agrees with the single stream,
+/// with messages of different lengths around the block size.
+/// @param buffer the data of the messages.
+/// @return 0 on success, 1 on failure.
+static int check_multi(const uint8_t *buffer)
+{
+    const uint8_t *data[MULTI_COUNT];
+    size_t len[MULTI_COUNT] = { 0, 55, 56, 64, 119, 1000, 3, 128, 4000 };
+    uint8_t digests[MULTI_COUNT][SHA256_BLOCK_SIZE], expected[SHA256_BLOCK_SIZE];
+    uint8_t *hash[MULTI_COUNT];
+    SHA256_ctx_t ctx;
+
+    for (size_t i = 0; i < MULTI_COUNT; ++i) {
+        data[i] = buffer + i;
+        hash[i] = digests[i];
+    }
+    sha256_multi(data, len, hash, MULTI_COUNT);
+    for (size_t i = 0; i < MULTI_COUNT; ++i) {
+        sha256_init(&ctx);
+        sha256_update(&ctx, data[i], len[i]);
+        sha256_final(&ctx, expected);
+        if (memcmp(hash[i], expected, SHA256_BLOCK_SIZE) != 0) {
+            printf("%s: the multi-buffer digest of message %u is wrong.\n", sha256_impl_name(sha256_get_impl()),
+                   (unsigned)i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    const sha256_impl_t impls[] = { SHA256_IMPL_GENERIC, SHA256_IMPL_SSE2, SHA256_IMPL_SHANI };
+    static uint8_t buffer[4096 + MULTI_COUNT];
+    int failures = 0;
+
+    for (size_t i = 0; i < sizeof(buffer); ++i) {
+        buffer[i] = (uint8_t)(i * 131 + 7);
+    }
+    for (size_t i = 0; i < sizeof(impls) / sizeof(impls[0]); ++i) {
+        // The processor may not support all of them.
+        if (sha256_set_impl(impls[i]) < 0) {
+            continue;
+        }
+        for (size_t j = 0; j < sizeof(vectors) / sizeof(vectors[0]); ++j) {
+            failures += check_vector(&vectors[j], 0);
+            failures += check_vector(&vectors[j], 1);
+            failures += check_vector(&vectors[j], 7);
+        }
+        failures += check_multi(buffer);
+    }
+    if (sha256_set_impl(SHA256_IMPL_GENERIC) < 0) {
+        printf("The generic implementation must always be supported.\n");
+        failures++;
+    }
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+/// @file t_shm_ring.c
+/// @brief Tests the lock-free ring buffers in shared memory.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <shm_ring.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <sys/ipc.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// The number of values sent by each producer.
+#define COUNT 10000
+
+/// @brief Sends the values from 1 to COUNT through the ring.
+/// @param key the key of the ring.
+/// @return EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+static int producer(key_t key)
+{
+    unsigned values[37];
+    shm_ring_t *ring = shm_ring_attach(key);
+    if (!ring) {
+        printf("Failed to attach the ring: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    // Send the values in batches of uneven size, so that they wrap around.
+    for (unsigned value = 1, n; value <= COUNT; value += n) {
+        for (n = 0; (n < 37) && (value + n <= COUNT); ++n) {
+            values[n] = value + n;
+        }
+        if (shm_ring_enqueue_wait(ring, values, n) < 0) {
+            printf("Failed to send the values: %s\n", strerror(errno));
+            return EXIT_FAILURE;
+        }
+    }
+    shm_ring_detach(ring);
+    return EXIT_SUCCESS;
+}
+
+/// @brief Checks that bulk operations are all-or-nothing, while burst ones
+/// transfer as much as possible.
+/// @param key the key of the ring.
+/// @return 0 on success, -1 on failure.
+static int test_batches(key_t key)
+{
+    unsigned values[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    shm_ring_t *ring   = shm_ring_create(key, 8, sizeof(unsigned), 0);
+    if (!ring) {
+        printf("Failed to create the ring: %s\n", strerror(errno));
+        return -1;
+    }
+    int ret = -1;
+    if (shm_ring_enqueue_bulk(ring, values, 9) != 0) {
+        printf("A bulk enqueue larger than the ring succeeded.\n");
+    } else if ((shm_ring_enqueue_burst(ring, values, 9) != 8) || (shm_ring_count(ring) != 8) ||
+               (shm_ring_free_count(ring) != 0)) {
+        printf("A burst enqueue did not fill the ring.\n");
+    } else if (shm_ring_dequeue_bulk(ring, values, 9) != 0) {
+        printf("A bulk dequeue larger than the content succeeded.\n");
+    } else if ((shm_ring_dequeue_burst(ring, values, 9) != 8) || (values[0] != 1) || (values[7] != 8)) {
+        printf("A burst dequeue did not empty the ring in order.\n");
+    } else {
+        ret = 0;
+    }
+    shm_ring_destroy(ring);
+    return ret;
+}
+
+/// @brief Streams values from the given number of producers to the calling
+/// process, and checks them.
+/// @param key the key of the ring.
+/// @param flags the flags of the ring.
+/// @param producers the number of producers.
+/// @return 0 on success, -1 on failure.
+static int test_stream(key_t key, int flags, int producers)
+{
+    unsigned values[16];
+    int status;
+    unsigned expected = 0;
+    unsigned long sum = 0;
+    int ret           = 0;
+    shm_ring_t *ring  = shm_ring_create(key, 64, sizeof(unsigned), flags);
+    if (!ring) {
+        printf("Failed to create the ring: %s\n", strerror(errno));
+        return -1;
+    }
+    for (int i = 0; i < producers; ++i) {
+        if (fork() == 0) {
+            exit(producer(key));
+        }
+    }
+    for (unsigned received = 0; received < (unsigned)(COUNT * producers); received += 16) {
+        if (shm_ring_dequeue_wait(ring, values, 16) < 0) {
+            printf("Failed to receive the values: %s\n", strerror(errno));
+            ret = -1;
+            break;
+        }
+        for (int i = 0; i < 16; ++i) {
+            // With a single producer, the values arrive in order.
+            if ((producers == 1) && (values[i] != ++expected)) {
+                printf("Received %u instead of %u.\n", values[i], expected);
+                ret = -1;
+            }
+            sum += values[i];
+        }
+    }
+    for (int i = 0; i < producers; ++i) {
+        if ((wait(&status) < 0) || (WEXITSTATUS(status) != EXIT_SUCCESS)) {
+            ret = -1;
+        }
+    }
+    if ((ret == 0) && (sum != (unsigned long)producers * COUNT * (COUNT + 1) / 2)) {
+        printf("The values received do not add up.\n");
+        ret = -1;
+    }
+    shm_ring_destroy(ring);
+    return ret;
+}
+
+int main(void)
+{
+    key_t key = ftok("/home", 'r');
+    if (key < 0) {
+        printf("Failed to generate the key: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    // The capacity must be a power of two.
+    if ((shm_ring_create(key, 12, sizeof(unsigned), 0) != NULL) || (errno != EINVAL)) {
+        printf("A ring with an invalid capacity was created.\n");
+        return EXIT_FAILURE;
+    }
+    if (test_batches(key) < 0) {
+        return EXIT_FAILURE;
+    }
+    // One producer, polling and sleeping on the semaphores.
+    if ((test_stream(key, 0, 1) < 0) || (test_stream(key, SHM_RING_BLOCK, 1) < 0)) {
+        return EXIT_FAILURE;
+    }
+    // Multiple producers.
+    if (test_stream(key, SHM_RING_MPMC | SHM_RING_BLOCK, 3) < 0) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
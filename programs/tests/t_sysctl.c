@@ -0,0 +1,120 @@
+/// @file t_sysctl.c
+/// @brief Tests the `/proc/sys` tunables.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <string.h>
+#include <unistd.h>
+
+/// @brief Reads the value of a tunable.
+/// @param path the path of the tunable.
+/// @param value where the value is stored.
+/// @return 0 on success, -1 on failure.
+static int read_tunable(const char *path, int *value)
+{
+    char buffer[32];
+    int fd = open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    memset(buffer, 0, sizeof(buffer));
+    ssize_t ret = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (ret <= 0) {
+        printf("Failed to read %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    *value = atoi(buffer);
+    return 0;
+}
+
+/// @brief Writes the value of a tunable.
+/// @param path the path of the tunable.
+/// @param value the value to write.
+/// @return 0 on success, -1 on failure.
+static int write_tunable(const char *path, const char *value)
+{
+    int fd = open(path, O_WRONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    ssize_t ret = write(fd, value, strlen(value));
+    close(fd);
+    return (ret == (ssize_t)strlen(value)) ? 0 : -1;
+}
+
+/// @brief Checks that a pipe holds the given amount of bytes.
+/// @param size the expected capacity.
+/// @return 0 on success, -1 on failure.
+static int check_pipe_size(int size)
+{
+    char buffer[32];
+    int fds[2], written = 0;
+    ssize_t ret;
+    if (pipe(fds) < 0) {
+        printf("Failed to create the pipe: %s\n", strerror(errno));
+        return -1;
+    }
+    fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    memset(buffer, 'x', sizeof(buffer));
+    while ((ret = write(fds[1], buffer, sizeof(buffer))) > 0) {
+        written += ret;
+    }
+    close(fds[0]);
+    close(fds[1]);
+    if (written != size) {
+        printf("The pipe holds %d bytes instead of %d.\n", written, size);
+        return -1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    char buffer[32];
+    int value, timeslice, pipe_size;
+
+    // The tunables can be read.
+    if ((read_tunable("/proc/sys/kernel/sched_rr_timeslice_ms", &timeslice) < 0) ||
+        (read_tunable("/proc/sys/kernel/printk", &value) < 0) ||
+        (read_tunable("/proc/sys/vm/readahead_pages", &value) < 0) ||
+        (read_tunable("/proc/sys/vm/slab_refill_count", &value) < 0) ||
+        (read_tunable("/proc/sys/fs/pipe_size", &pipe_size) < 0)) {
+        return EXIT_FAILURE;
+    }
+
+    // Values outside the range, or which are not numbers, are rejected.
+    if ((write_tunable("/proc/sys/kernel/sched_rr_timeslice_ms", "0\n") == 0) ||
+        (write_tunable("/proc/sys/kernel/sched_rr_timeslice_ms", "abc\n") == 0) ||
+        (write_tunable("/proc/sys/kernel/printk", "8\n") == 0)) {
+        printf("An invalid value was accepted.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Valid values are applied.
+    if ((write_tunable("/proc/sys/kernel/sched_rr_timeslice_ms", "20\n") < 0) ||
+        (read_tunable("/proc/sys/kernel/sched_rr_timeslice_ms", &value) < 0) || (value != 20)) {
+        printf("Failed to set the time slice: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (check_pipe_size(pipe_size) < 0) {
+        return EXIT_FAILURE;
+    }
+    if ((write_tunable("/proc/sys/fs/pipe_size", "128\n") < 0) || (check_pipe_size(128) < 0)) {
+        printf("Failed to set the pipe size.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Restore the previous values.
+    snprintf(buffer, sizeof(buffer), "%d\n", timeslice);
+    write_tunable("/proc/sys/kernel/sched_rr_timeslice_ms", buffer);
+    snprintf(buffer, sizeof(buffer), "%d\n", pipe_size);
+    write_tunable("/proc/sys/fs/pipe_size", buffer);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+/// @file t_timerslack.c
+/// @brief Tests the timer slack set through prctl.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/// @brief Sleeps for the given time, and measures how long it took.
+/// @param msec the time to sleep, in milliseconds.
+/// @return the time we slept, in milliseconds, -1 on failure.
+static long measure_sleep(long msec)
+{
+    timespec_t start, end, req = {.tv_sec = 0, .tv_nsec = msec * 1000000};
+    if ((clock_gettime(CLOCK_MONOTONIC, &start) < 0) || (nanosleep(&req, NULL) < 0) ||
+        (clock_gettime(CLOCK_MONOTONIC, &end) < 0)) {
+        printf("Failed to sleep: %s\n", strerror(errno));
+        return -1;
+    }
+    return (end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000;
+}
+
+int main(void)
+{
+    sched_param_t param = {0};
+    int status;
+
+    // Processes start with the default slack.
+    int slack = prctl(PR_GET_TIMERSLACK, 0);
+    if (slack <= 0) {
+        printf("Expected a default slack, found %d.\n", slack);
+        return EXIT_FAILURE;
+    }
+    if ((prctl(42, 0) != -1) || (errno != EINVAL)) {
+        printf("An invalid option was accepted.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Set our own slack, which is inherited by the children.
+    if ((prctl(PR_SET_TIMERSLACK, 2000000) < 0) || (prctl(PR_GET_TIMERSLACK, 0) != 2000000)) {
+        printf("Failed to set the slack: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        exit((prctl(PR_GET_TIMERSLACK, 0) == 2000000) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    if ((pid < 0) || (waitpid(pid, &status, 0) != pid) || (WEXITSTATUS(status) != EXIT_SUCCESS)) {
+        printf("The child did not inherit the slack.\n");
+        return EXIT_FAILURE;
+    }
+
+    // The slack can delay a sleep, but never shorten it.
+    long elapsed = measure_sleep(100);
+    if ((elapsed < 99) || (elapsed > 150)) {
+        printf("Slept for %ld ms instead of 100 ms.\n", elapsed);
+        return EXIT_FAILURE;
+    }
+
+    // Setting it to zero restores the default.
+    if ((prctl(PR_SET_TIMERSLACK, 0) < 0) || (prctl(PR_GET_TIMERSLACK, 0) != slack)) {
+        printf("Failed to restore the default slack.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Real-time processes have no slack.
+    param.sched_priority = 10;
+    if (sched_setscheduler(0, SCHED_FIFO, &param) < 0) {
+        printf("Failed to set SCHED_FIFO: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (prctl(PR_GET_TIMERSLACK, 0) != 0) {
+        printf("A real-time process has a slack.\n");
+        return EXIT_FAILURE;
+    }
+    param.sched_priority = 0;
+    if (sched_setscheduler(0, SCHED_NORMAL, &param) < 0) {
+        printf("Failed to set SCHED_NORMAL: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    return (prctl(PR_GET_TIMERSLACK, 0) == slack) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,117 @@
+/// @file t_vmalloc.c
+/// @brief Tests vmalloc, vfree and the lazy purge of the freed areas.
+/// @details The kernel reads each executable in a buffer allocated with
+/// kvmalloc, which comes from vmalloc for files larger than a page. We run
+/// more programs than the areas which can wait for the purge, so that vfree
+/// has to flush the TLB and release them, then we check through
+/// /proc/allocinfo that every buffer has been released.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// The number of programs we run, more than twice the areas which can wait
+/// for the purge (VMALLOC_LAZY_MAX_AREAS).
+#define RUNS 80
+
+/// @brief Writes a command to /proc/allocinfo.
+/// @param command the command to write.
+/// @return 0 on success, -1 on failure.
+static int allocinfo_write(const char *command)
+{
+    int fd = open("/proc/allocinfo", O_WRONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open /proc/allocinfo: %s\n", strerror(errno));
+        return -1;
+    }
+    ssize_t ret = write(fd, command, strlen(command));
+    close(fd);
+    if (ret != (ssize_t)strlen(command)) {
+        printf("Failed to write `%s` to /proc/allocinfo: %s\n", command, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/// @brief Finds the allocation site of the buffers of the executables.
+/// @param live where the live bytes of the site are placed.
+/// @param allocs where the number of allocations of the site is placed.
+/// @param frees where the number of releases of the site is placed.
+/// @return 0 on success, -1 on failure.
+static int allocinfo_elf_site(unsigned *live, unsigned *allocs, unsigned *frees)
+{
+    static char buffer[4096];
+    int fd = open("/proc/allocinfo", O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Failed to open /proc/allocinfo: %s\n", strerror(errno));
+        return -1;
+    }
+    memset(buffer, 0, sizeof(buffer));
+    ssize_t ret = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (ret <= 0) {
+        printf("Failed to read /proc/allocinfo: %s\n", strerror(errno));
+        return -1;
+    }
+    // Each site is `live objects peak allocs frees file:line function`.
+    unsigned objects, peak;
+    for (char *line = buffer, *next; line && *line; line = next) {
+        if ((next = strchr(line, '\n'))) {
+            *next++ = 0;
+        }
+        if (strstr(line, "elf.c:") && (sscanf(line, "%u %u %u %u %u", live, &objects, &peak, allocs, frees) == 5)) {
+            return 0;
+        }
+    }
+    printf("The buffers of the executables were not recorded.\n");
+    return -1;
+}
+
+int main(int argc, char *argv[])
+{
+    // The program we run is ourselves, which exits right away.
+    if ((argc > 1) && (strcmp(argv[1], "child") == 0)) {
+        return EXIT_SUCCESS;
+    }
+    if ((allocinfo_write("reset\n") < 0) || (allocinfo_write("on\n") < 0)) {
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < RUNS; ++i) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            execl("/bin/tests/t_vmalloc", "t_vmalloc", "child", NULL);
+            printf("Failed to exec: %s\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        int status;
+        if ((pid < 0) || (waitpid(pid, &status, 0) != pid)) {
+            printf("Failed to run the child %d: %s\n", i, strerror(errno));
+            allocinfo_write("off\n");
+            return EXIT_FAILURE;
+        }
+        if (!WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS)) {
+            printf("The child %d failed.\n", i);
+            allocinfo_write("off\n");
+            return EXIT_FAILURE;
+        }
+    }
+    unsigned live, allocs, frees;
+    int ret = allocinfo_elf_site(&live, &allocs, &frees);
+    allocinfo_write("off\n");
+    allocinfo_write("reset\n");
+    if (ret < 0) {
+        return EXIT_FAILURE;
+    }
+    // Every buffer must have been released, and none twice.
+    if ((allocs < RUNS) || (allocs != frees) || (live != 0)) {
+        printf("Buffers of the executables: %u allocated, %u freed, %u bytes live.\n", allocs, frees, live);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/// @file t_waitpid.c
+/// @brief Tests the blocking and non-blocking waitpid.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strerror.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/// @brief Sleeps for the given amount of milliseconds.
+/// @param ms the milliseconds.
+static void sleep_ms(long ms)
+{
+    timespec_t req = {ms / 1000, (ms % 1000) * 1000000};
+    nanosleep(&req, NULL);
+}
+
+int main(void)
+{
+    int status;
+    pid_t pid;
+
+    // There is nothing to wait for.
+    if ((waitpid(-1, &status, 0) != -1) || (errno != ECHILD)) {
+        printf("Waiting without children did not fail with ECHILD.\n");
+        return EXIT_FAILURE;
+    }
+
+    // A running child is not reported with WNOHANG, and the blocking call
+    // returns once it exits.
+    pid = fork();
+    if (pid == 0) {
+        sleep_ms(200);
+        exit(42);
+    }
+    if (pid < 0) {
+        printf("Failed to fork: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if ((waitpid(pid, &status, 42) != -1) || (errno != EINVAL)) {
+        printf("Invalid options were accepted.\n");
+        return EXIT_FAILURE;
+    }
+    if (waitpid(pid, &status, WNOHANG) != 0) {
+        printf("A running child was reported with WNOHANG.\n");
+        return EXIT_FAILURE;
+    }
+    if (waitpid(pid, &status, 0) != pid) {
+        printf("Failed to wait for the child: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (!WIFEXITED(status) || (WEXITSTATUS(status) != 42)) {
+        printf("Unexpected exit status %d.\n", WEXITSTATUS(status));
+        return EXIT_FAILURE;
+    }
+
+    // The exit of another child does not interrupt the wait: it sends a
+    // SIGCHLD, which is ignored by default.
+    pid_t other = fork();
+    if (other == 0) {
+        exit(1);
+    }
+    pid = fork();
+    if (pid == 0) {
+        sleep_ms(200);
+        exit(2);
+    }
+    if ((other < 0) || (pid < 0)) {
+        printf("Failed to fork: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (waitpid(pid, &status, 0) != pid) {
+        printf("Failed to wait for the last child to exit: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (!WIFEXITED(status) || (WEXITSTATUS(status) != 2)) {
+        printf("Unexpected exit status %d.\n", WEXITSTATUS(status));
+        return EXIT_FAILURE;
+    }
+    if (waitpid(other, &status, 0) != other) {
+        printf("Failed to wait for the first child to exit: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    // A stopped child is reported with WUNTRACED.
+    pid = fork();
+    if (pid == 0) {
+        while (1) {
+            sleep_ms(50);
+        }
+    }
+    if (pid < 0) {
+        printf("Failed to fork: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    kill(pid, SIGSTOP);
+    if (waitpid(pid, &status, WUNTRACED) != pid) {
+        printf("Failed to wait for the stopped child: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (!WIFSTOPPED(status) || (WSTOPSIG(status) != SIGSTOP)) {
+        printf("The child was not reported as stopped.\n");
+        return EXIT_FAILURE;
+    }
+    kill(pid, SIGCONT);
+    kill(pid, SIGKILL);
+    if (waitpid(pid, &status, 0) != pid) {
+        printf("Failed to wait for the killed child: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
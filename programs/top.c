@@ -0,0 +1,293 @@
+/// @file top.c
+/// @brief Display the processes sorted by their CPU usage, updated periodically.
+/// @copyright (c) 2014-2024 This file is distributed under the MIT License.
+/// See LICENSE.md for details.
+
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/// The maximum number of processes we keep track of.
+#define MAX_TASKS 128
+
+/// @brief A sample of the statistics of a process, from `/proc/<pid>/stat`.
+typedef struct task_sample {
+    pid_t pid;            ///< The pid of the process.
+    char name[32];        ///< The name of the process.
+    char state;           ///< The state of the process.
+    unsigned long time;   ///< The user and kernel ticks of the process.
+    unsigned long vsize;  ///< The virtual memory size, in bytes.
+    unsigned long rss;    ///< The resident pages.
+    unsigned long nvcsw;  ///< The voluntary context switches.
+    unsigned long nivcsw; ///< The involuntary context switches.
+    unsigned long delta;  ///< The ticks since the previous sample.
+} task_sample_t;
+
+/// @brief A sample of the CPU times, from the first line of `/proc/stat`.
+typedef struct cpu_sample {
+    unsigned long user;   ///< The ticks spent in user mode.
+    unsigned long system; ///< The ticks spent in kernel mode.
+    unsigned long idle;   ///< The ticks spent idle.
+} cpu_sample_t;
+
+/// The frequency of the kernel clock, the unit of the times in `/proc`.
+static unsigned long clk_tck;
+/// The size of a page, the unit of the resident memory in `/proc`.
+static unsigned long page_size;
+
+/// The current and the previous samples of the processes.
+static task_sample_t samples[2][MAX_TASKS];
+/// The number of processes in each sample.
+static int num_samples[2];
+
+/// @brief Reads a small file.
+/// @param path the path of the file.
+/// @param buffer the buffer where the content is placed.
+/// @param size the size of the buffer.
+/// @return 0 on success, -1 on failure.
+static inline int __read_file(const char *path, char *buffer, size_t size)
+{
+    int fd = open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t length = read(fd, buffer, size - 1);
+    close(fd);
+    if (length <= 0) {
+        return -1;
+    }
+    buffer[length] = 0;
+    return 0;
+}
+
+/// @brief Reads the units of the values in `/proc` from `/proc/stat`, the
+/// frequency of the kernel clock and the size of a page.
+/// @return 0 on success, -1 on failure.
+static inline int __read_units(void)
+{
+    char buffer[512];
+    char *it;
+    if (__read_file("/proc/stat", buffer, sizeof(buffer)) < 0) {
+        return -1;
+    }
+    if ((it = strstr(buffer, "\nclk_tck "))) {
+        clk_tck = strtol(it + 9, NULL, 10);
+    }
+    if ((it = strstr(buffer, "\npage_size "))) {
+        page_size = strtol(it + 11, NULL, 10);
+    }
+    return (clk_tck && page_size) ? 0 : -1;
+}
+
+/// @brief Reads the CPU times.
+/// @param cpu where the times are stored.
+/// @return 0 on success, -1 on failure.
+static inline int __read_cpu(cpu_sample_t *cpu)
+{
+    char buffer[512];
+    char *it;
+    if ((__read_file("/proc/stat", buffer, sizeof(buffer)) < 0) || strncmp(buffer, "cpu ", 4)) {
+        return -1;
+    }
+    // cpu user nice system idle ...
+    cpu->user = strtol(buffer + 4, &it, 10);
+    strtol(it, &it, 10);
+    cpu->system = strtol(it, &it, 10);
+    cpu->idle   = strtol(it, &it, 10);
+    return 0;
+}
+
+/// @brief Reads the statistics of a process.
+/// @param pid the pid of the process, as a string.
+/// @param task where the statistics are stored.
+/// @return 0 on success, -1 on failure.
+static inline int __read_task(const char *pid, task_sample_t *task)
+{
+    char path[PATH_MAX], buffer[1024];
+    char *it, *saveptr, *field;
+    snprintf(path, PATH_MAX, "/proc/%s/stat", pid);
+    if (__read_file(path, buffer, sizeof(buffer)) < 0) {
+        return -1;
+    }
+    memset(task, 0, sizeof(task_sample_t));
+    // The name is between parentheses, the other fields follow it.
+    task->pid = atoi(buffer);
+    char *name = strchr(buffer, '(');
+    if (!name || !(it = strrchr(buffer, ')'))) {
+        return -1;
+    }
+    *it = 0;
+    strncpy(task->name, name + 1, sizeof(task->name) - 1);
+    field = strtok_r(it + 1, " \n", &saveptr);
+    for (int index = 3; field; ++index, field = strtok_r(NULL, " \n", &saveptr)) {
+        unsigned long value = strtol(field, NULL, 10);
+        if (index == 3) {
+            task->state = field[0];
+        } else if ((index == 14) || (index == 15)) {
+            task->time += value;
+        } else if (index == 23) {
+            task->vsize = value;
+        } else if (index == 24) {
+            task->rss = value;
+        } else if (index == 53) {
+            task->nvcsw = value;
+        } else if (index == 54) {
+            task->nivcsw = value;
+        }
+    }
+    return 0;
+}
+
+/// @brief Takes a sample of all the processes.
+/// @param current the index of the sample to fill.
+/// @return the number of processes.
+static inline int __sample_tasks(int current)
+{
+    dirent_t dent;
+    int previous = !current, count = 0;
+    int fd = open("/proc", O_RDONLY | O_DIRECTORY, 0);
+    if (fd < 0) {
+        return 0;
+    }
+    while ((count < MAX_TASKS) && (getdents(fd, &dent, sizeof(dirent_t)) > 0)) {
+        if ((dent.d_type != DT_DIR) || !isdigit(dent.d_name[0])) {
+            continue;
+        }
+        task_sample_t *task = &samples[current][count];
+        if (__read_task(dent.d_name, task) < 0) {
+            continue;
+        }
+        // The usage is the difference with the previous sample of the process.
+        task->delta = task->time;
+        for (int i = 0; i < num_samples[previous]; ++i) {
+            if ((samples[previous][i].pid == task->pid) && (samples[previous][i].time <= task->time)) {
+                task->delta = task->time - samples[previous][i].time;
+                break;
+            }
+        }
+        ++count;
+    }
+    close(fd);
+    num_samples[current] = count;
+    return count;
+}
+
+/// @brief Sorts the processes by decreasing CPU usage, or resident memory.
+/// @param tasks the processes.
+/// @param count the number of processes.
+/// @param by_memory if the processes are sorted by memory.
+static inline void __sort_tasks(task_sample_t *tasks, int count, int by_memory)
+{
+    // There are few processes, an insertion sort is enough.
+    for (int i = 1; i < count; ++i) {
+        task_sample_t task = tasks[i];
+        unsigned long key  = by_memory ? task.rss : task.delta;
+        int j              = i - 1;
+        for (; (j >= 0) && ((by_memory ? tasks[j].rss : tasks[j].delta) < key); --j) {
+            tasks[j + 1] = tasks[j];
+        }
+        tasks[j + 1] = task;
+    }
+}
+
+/// @brief Prints a percentage with one decimal digit.
+/// @param part the part.
+/// @param total the total.
+static inline void __print_percent(unsigned long part, unsigned long total)
+{
+    unsigned long permille = total ? (part * 1000UL) / total : 0;
+    printf("%3lu.%lu", permille / 10, permille % 10);
+}
+
+/// @brief Prints a sample.
+/// @param current the index of the sample.
+/// @param cpu the CPU times since the previous sample.
+/// @param by_memory if the processes are sorted by memory.
+static inline void __print_sample(int current, cpu_sample_t *cpu, int by_memory)
+{
+    int count = num_samples[current], running = 0;
+    task_sample_t *tasks = samples[current];
+    unsigned long total  = cpu->user + cpu->system + cpu->idle;
+    for (int i = 0; i < count; ++i) {
+        running += (tasks[i].state == 'R');
+    }
+    __sort_tasks(tasks, count, by_memory);
+    // Move to the top-left corner, and clear the screen.
+    printf("\033[H\033[J");
+    printf("Tasks: %d total, %d running\n", count, running);
+    printf("Cpu(s): ");
+    __print_percent(cpu->user, total);
+    printf(" us, ");
+    __print_percent(cpu->system, total);
+    printf(" sy, ");
+    __print_percent(cpu->idle, total);
+    printf(" id\n\n");
+    printf("%5s %1s %5s %8s %8s %7s %7s %9s %s\n", "PID", "S", "%CPU", "VIRT", "RES", "VCSW", "IVCSW", "TIME", "COMMAND");
+    for (int i = 0; i < count; ++i) {
+        unsigned long seconds = tasks[i].time / clk_tck;
+        printf("%5d %c ", tasks[i].pid, tasks[i].state);
+        __print_percent(tasks[i].delta, total);
+        printf(
+            " %7luK %7luK %7lu %7lu %3lu:%02lu.%02lu %s\n", tasks[i].vsize / 1024, tasks[i].rss * (page_size / 1024),
+            tasks[i].nvcsw, tasks[i].nivcsw, seconds / 60, seconds % 60, (tasks[i].time % clk_tck) * 100 / clk_tck,
+            tasks[i].name);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int delay = 1, iterations = -1, by_memory = 0, current = 0;
+    cpu_sample_t before, after, cpu;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
+            printf("Display the processes sorted by their CPU usage.\n");
+            printf("Usage:\n");
+            printf("    top [-d SECONDS] [-n ITERATIONS] [-m]\n");
+            return EXIT_SUCCESS;
+        }
+        if (!strcmp(argv[i], "-d") && (i + 1 < argc)) {
+            delay = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-n") && (i + 1 < argc)) {
+            iterations = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-m")) {
+            by_memory = 1;
+        } else {
+            printf("top: invalid option `%s`, see `top --help`.\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (delay <= 0) {
+        printf("top: the delay must be positive.\n");
+        return EXIT_FAILURE;
+    }
+    if ((__read_units() < 0) || (__read_cpu(&before) < 0)) {
+        printf("top: cannot read /proc/stat.\n");
+        return EXIT_FAILURE;
+    }
+    // The first sample is only the reference for the following ones.
+    __sample_tasks(current);
+    while (iterations != 0) {
+        timespec_t req = {delay, 0};
+        nanosleep(&req, NULL);
+        current = !current;
+        __sample_tasks(current);
+        if (__read_cpu(&after) < 0) {
+            printf("top: cannot read /proc/stat.\n");
+            return EXIT_FAILURE;
+        }
+        cpu.user   = after.user - before.user;
+        cpu.system = after.system - before.system;
+        cpu.idle   = after.idle - before.idle;
+        before     = after;
+        __print_sample(current, &cpu, by_memory);
+        if (iterations > 0) {
+            --iterations;
+        }
+    }
+    return EXIT_SUCCESS;
+}